@@ -63,6 +63,122 @@ WRError WRCompilationContext::compile( const char* source,
 									   int* outLen,
 									   WRstr* errorMsg,
 									   const uint8_t compilerOptionFlags )
+{
+	m_guessTypes = false;
+	m_hoistLoops = true;
+
+	if ( !(compilerOptionFlags & WR_OPTIMIZE) || (compilerOptionFlags & WR_EMBED_DEBUG_CODE) )
+	{
+		return compilePass( source, size, out, outLen, errorMsg, compilerOptionFlags );
+	}
+
+	// a local is only known to be constant once a whole pass has seen
+	// every use of it, and folding with what one pass learned can turn
+	// up more, so compile again until a pass learns nothing new.
+	//
+	// Types go the other way: the first pass guesses one for every
+	// local and emits nothing from it, each pass after that emits
+	// typed code for the guesses still standing and checks them
+	// again. Only a pass that broke none of them can be kept
+	//
+	// What can be moved out of a loop is only known once the whole
+	// loop has been seen, so each pass sets aside as many locals to
+	// move things into as the one before it found a use for
+	bool typed = true;
+	for( int pass=1; ; ++pass )
+	{
+		WRCompilationContext comp;
+		comp.m_knownLocals = m_knownLocals;
+		comp.m_guessTypes = (pass == 1);
+		comp.m_hoistLoops = m_hoistLoops;
+		comp.m_lastLoopFacts = m_lastLoopFacts;
+		comp.m_lastLoopStores = m_lastLoopStores;
+
+		WRError err = comp.compilePass( source, size, out, outLen, errorMsg, compilerOptionFlags );
+		if ( err != WR_ERR_None )
+		{
+			return err;
+		}
+
+		unsigned int knew = 0;
+		bool broken = false;
+		for( unsigned int k=0; k<m_knownLocals.count(); ++k )
+		{
+			KnownLocal& K = m_knownLocals[k];
+			knew += K.constant ? 1 : 0;
+
+			for( unsigned int l=0; K.type != -1 && l<comp.m_localUses.count(); ++l )
+			{
+				if ( comp.m_localUses[l].hash == K.hash && comp.m_localUses[l].unit == K.unit )
+				{
+					broken = broken || (comp.m_localUses[l].type != K.type);
+					break;
+				}
+			}
+		}
+
+		unsigned int known = 0;
+		bool guessed = false;
+		for( unsigned int l=0; l<comp.m_localUses.count(); ++l )
+		{
+			known += comp.m_localUses[l].constant ? 1 : 0;
+			guessed = guessed || (pass == 1 && comp.m_localUses[l].type != -1);
+		}
+
+		bool unsettled = false;
+		for( unsigned int f=0; f<comp.m_loopFacts.count(); ++f )
+		{
+			unsettled = unsettled || (comp.m_loopFacts[f].hoists != comp.m_loopFacts[f].slots);
+		}
+
+		if ( !broken
+			 && !comp.m_hoistRefused
+			 && ((known <= knew && !guessed && !unsettled) || pass >= c_optimizerPasses) )
+		{
+			return err;
+		}
+
+		g_free( *out );
+
+		// one that moved something it should not have has to be done
+		// over without moving anything
+		m_hoistLoops = m_hoistLoops && !comp.m_hoistRefused;
+		m_lastLoopFacts = comp.m_loopFacts;
+		m_lastLoopStores = comp.m_loopStores;
+
+		// out of passes with the types still moving, settle for none
+		typed = typed && pass < c_optimizerPasses;
+		
+		WRarray<KnownLocal> assumed;
+		assumed = m_knownLocals;
+		m_knownLocals.clear();
+		for( unsigned int l=0; l<comp.m_localUses.count(); ++l )
+		{
+			KnownLocal& L = comp.m_localUses[l];
+
+			bool stands = typed && L.type != -1 && pass == 1;
+			for( unsigned int a=0; typed && !stands && L.type != -1 && a<assumed.count(); ++a )
+			{
+				stands = assumed[a].hash == L.hash && assumed[a].unit == L.unit && assumed[a].type == L.type;
+			}
+
+			if ( L.constant || stands )
+			{
+				KnownLocal& K = m_knownLocals.append();
+				K = L;
+				K.type = stands ? L.type : -1;
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+WRError WRCompilationContext::compilePass( const char* source,
+										   const int size,
+										   unsigned char** out,
+										   int* outLen,
+										   WRstr* errorMsg,
+										   const uint8_t compilerOptionFlags )
 {
 	m_source = source;
 	m_sourceLen = size;
@@ -89,6 +205,24 @@ WRError WRCompilationContext::compile( const char* source,
 	m_embedSourceCode = compilerOptionFlags & WR_EMBED_SOURCE_CODE;
 	m_embedGlobalSymbols = compilerOptionFlags & WR_INCLUDE_GLOBALS;
 	m_needVar = !(compilerOptionFlags & WR_NON_STRICT_VAR);
+	m_inlineFunctions = (compilerOptionFlags & WR_INLINE_FUNCTIONS) && !m_addDebugSymbols;
+	m_optimize = (compilerOptionFlags & WR_OPTIMIZE) && !m_addDebugSymbols;
+	m_straightLine = false;
+	m_unconditional = false;
+	m_localsNoted = false;
+	m_statement = 0;
+	m_block = -1;
+	m_blockParents.clear();
+	m_localSpans.clear();
+	m_loopSpans.clear();
+	m_hoisting = false;
+	m_hoistRefused = false;
+	m_hoistSlots = 0;
+	m_loopFacts.clear();
+	m_loopStores.clear();
+	m_loopReads.clear();
+	m_loops.clear();
+	m_hoisted.clear();
 
 	do
 	{
@@ -148,6 +282,30 @@ WRError WRCompilationContext::compile( const char* source,
 
 	pushOpcode( m_units[0].bytecode, O_Stop );
 
+	// what was moved out of a loop is only safe if the loop turned out
+	// not to store what it read, and nothing can reach its locals by name
+	// or jump into it past the code that sets them
+	for( unsigned int f=0; f<m_loopFacts.count(); ++f )
+	{
+		const int u = m_loopFacts[f].unit;
+		if ( localsAreMembers(u) || m_units[u].bytecode.gotoSource.count() )
+		{
+			m_hoistRefused = m_hoistRefused || m_loopFacts[f].slots;
+			m_loopFacts[f].hoists = 0;
+		}
+	}
+
+	for( unsigned int r=0; r<m_loopReads.count(); ++r )
+	{
+		for( unsigned int w=0; w<m_loopStores.count(); ++w )
+		{
+			m_hoistRefused = m_hoistRefused
+							 || (m_loopStores[w].unit == m_loopReads[r].unit
+								 && m_loopStores[w].first == m_loopReads[r].first
+								 && m_loopStores[w].hash == m_loopReads[r].hash);
+		}
+	}
+
 	link( out, outLen, compilerOptionFlags );
 	if ( m_err )
 	{
@@ -420,11 +578,36 @@ void WRCompilationContext::addRelativeJumpSource( WRBytecode& bytecode, WROpcode
 
 		default: break;
 	}
+
+	if ( opcode == O_BZ )
+	{
+		offset = typedCompare( bytecode, offset );
+	}
 	
 	bytecode.jumpOffsetTargets[relativeJumpTarget].references.append() = offset;
 	pushData( bytecode, "\t\t", 2 );
 }
 
+//------------------------------------------------------------------------------
+// how far past its sub-opcode a wide jump keeps its 16-bit vector
+static int wr_wideJumpOffset( const unsigned char sub )
+{
+	if ( sub == W_NextKeyValueOrJump )
+	{
+		return 8;
+	}
+	else if ( sub == W_NextValueOrJump )
+	{
+		return 6;
+	}
+	else if ( sub >= W_IntLICompareLTBZ && sub <= W_IntLICompareNEBZ )
+	{
+		return 4;
+	}
+
+	return 3; // W_IntLLCompare*BZ, W_IntLCountLTBZ, W_IncLocalLLCompareLT
+}
+
 //------------------------------------------------------------------------------
 void WRCompilationContext::resolveRelativeJumps( WRBytecode& bytecode )
 {
@@ -520,6 +703,13 @@ void WRCompilationContext::resolveRelativeJumps( WRBytecode& bytecode )
 					break;
 				}
 
+				case O_Wide:
+				{
+					no8version = true;
+					diff -= wr_wideJumpOffset( bytecode.all[offset] );
+					break;
+				}
+
 				default:
 					break;
 			}
@@ -737,6 +927,12 @@ void WRCompilationContext::resolveRelativeJumps( WRBytecode& bytecode )
 						offset += 2;
 						break;
 					}
+
+					case O_Wide:
+					{
+						offset += wr_wideJumpOffset( bytecode.all[offset] );
+						break;
+					}
 						
 					default:
 					{
@@ -751,6 +947,62 @@ void WRCompilationContext::resolveRelativeJumps( WRBytecode& bytecode )
 	}
 }
 
+//------------------------------------------------------------------------------
+static void wr_trimReferences( WRarray<int>& references, const int mark )
+{
+	for( int r=references.count() - 1; r>=0; --r )
+	{
+		if ( references[r] >= mark )
+		{
+			references.remove( r, 1 );
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// throw away everything added to 'bytecode' since it was 'mark' bytes
+// long and had 'targets' jump targets, because it can never run.
+// Refused when a goto label in there means it still could
+bool WRCompilationContext::discardBytecode( WRBytecode& bytecode, unsigned int mark, unsigned int targets )
+{
+	for( unsigned int j=targets; j<bytecode.jumpOffsetTargets.count(); ++j )
+	{
+		if ( bytecode.jumpOffsetTargets[j].gotoHash )
+		{
+			return false;
+		}
+	}
+
+	bytecode.all.shave( bytecode.all.size() - mark );
+	bytecode.invalidateOpcodeCache();
+
+	for( unsigned int j=0; j<bytecode.jumpOffsetTargets.count(); ++j )
+	{
+		wr_trimReferences( bytecode.jumpOffsetTargets[j].references, mark );
+	}
+	for( unsigned int n=0; n<bytecode.localSpace.count(); ++n )
+	{
+		wr_trimReferences( bytecode.localSpace[n].references, mark );
+	}
+	for( unsigned int n=0; n<bytecode.functionSpace.count(); ++n )
+	{
+		wr_trimReferences( bytecode.functionSpace[n].references, mark );
+	}
+	for( unsigned int n=0; n<bytecode.unitObjectSpace.count(); ++n )
+	{
+		wr_trimReferences( bytecode.unitObjectSpace[n].references, mark );
+	}
+	for( int g=bytecode.gotoSource.count() - 1; g>=0; --g )
+	{
+		if ( bytecode.gotoSource[g].offset >= (int)mark )
+		{
+			bytecode.gotoSource.remove( g, 1 );
+		}
+	}
+
+	return true;
+}
+
 //------------------------------------------------------------------------------
 void WRCompilationContext::pushLiteral( WRBytecode& bytecode, WRExpressionContext& context )
 {
@@ -830,6 +1082,108 @@ bool WRCompilationContext::isNamedEnumMember( WRstr const& token )
 	return false;
 }
 
+//------------------------------------------------------------------------------
+void WRCompilationContext::pushLoad( WRBytecode& bytecode, const bool global, const unsigned int index )
+{
+	if ( index < 256 )
+	{
+		pushOpcode( bytecode, global ? O_LoadFromGlobal : O_LoadFromLocal );
+		unsigned char c = index;
+		pushData( bytecode, &c, 1 );
+	}
+	else
+	{
+		// past 255 the index needs two bytes; link() sees the
+		// counts and marks the whole image wide
+		unsigned char data[3];
+		data[0] = global ? W_LoadFromGlobal : W_LoadFromLocal;
+		wr_pack16( index, data + 1 );
+		pushOpcode( bytecode, O_Wide );
+		pushData( bytecode, data, 3 );
+	}
+}
+
+//------------------------------------------------------------------------------
+// is this bytecode nothing but one load? if so report it as the
+// narrow opcode and its index
+bool WRCompilationContext::singleLoad( WRBytecode& bytecode, unsigned int* load )
+{
+	unsigned int a = 0;
+	unsigned int o = 0;
+	if ( bytecode.opcodes.size() == 2 && bytecode.all.size() > 3 && bytecode.all[0] == O_DebugInfo )
+	{
+		a = 3;
+		o = 1;
+	}
+	
+	if ( bytecode.opcodes.size() != o + 1 )
+	{
+		return false;
+	}
+
+	if ( bytecode.all.size() == a + 2
+		 && (bytecode.all[a] == O_LoadFromLocal || bytecode.all[a] == O_LoadFromGlobal) )
+	{
+		load[0] = bytecode.all[a];
+		load[1] = (unsigned char)bytecode.all[a + 1];
+		return true;
+	}
+
+	if ( bytecode.all.size() == a + 4
+		 && bytecode.all[a] == O_Wide
+		 && (bytecode.all[a + 1] == W_LoadFromLocal || bytecode.all[a + 1] == W_LoadFromGlobal) )
+	{
+		load[0] = (bytecode.all[a + 1] == W_LoadFromLocal) ? O_LoadFromLocal : O_LoadFromGlobal;
+		load[1] = bytecode.all[a + 2] | ((unsigned int)bytecode.all[a + 3] << 8);
+		return true;
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// is this bytecode nothing but a numeric literal? if so report its value
+bool WRCompilationContext::literalValue( WRBytecode& bytecode, WRValue& value )
+{
+	if ( bytecode.jumpOffsetTargets.count() )
+	{
+		return false;
+	}
+
+	const unsigned char* code = bytecode.all;
+	const unsigned int size = bytecode.all.size();
+
+	if ( size == 1 && code[0] == O_LiteralZero )
+	{
+		value.p2 = INIT_AS_INT;
+		value.i = 0;
+	}
+	else if ( size == 2 && code[0] == O_LiteralInt8 )
+	{
+		value.p2 = INIT_AS_INT;
+		value.i = (int8_t)code[1];
+	}
+	else if ( size == 3 && code[0] == O_LiteralInt16 )
+	{
+		value.p2 = INIT_AS_INT;
+		value.i = (int16_t)((uint16_t)code[1] | ((uint16_t)code[2] << 8));
+	}
+	else if ( size == 5 && (code[0] == O_LiteralInt32 || code[0] == O_LiteralFloat) )
+	{
+		value.p2 = (code[0] == O_LiteralInt32) ? INIT_AS_INT : INIT_AS_FLOAT;
+		value.ui = (uint32_t)code[1]
+				   | ((uint32_t)code[2] << 8)
+				   | ((uint32_t)code[3] << 16)
+				   | ((uint32_t)code[4] << 24);
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
 //------------------------------------------------------------------------------
 int WRCompilationContext::addLocalSpaceLoad( WRBytecode& bytecode, WRstr& token, bool addOnly, bool varSeen, bool allowFunctionNameHashLiteral )
 {
@@ -875,9 +1229,7 @@ int WRCompilationContext::addLocalSpaceLoad( WRBytecode& bytecode, WRstr& token,
 				{
 					if (m_units[0].bytecode.localSpace[j].hash == ghash)
 					{
-						pushOpcode(bytecode, O_LoadFromGlobal);
-						unsigned char c = j;
-						pushData(bytecode, &c, 1);
+						pushLoad( bytecode, true, j );
 						return j;
 					}
 				}
@@ -904,9 +1256,25 @@ int WRCompilationContext::addLocalSpaceLoad( WRBytecode& bytecode, WRstr& token,
 	
 	if ( !addOnly )
 	{
-		pushOpcode( bytecode, O_LoadFromLocal );
-		unsigned char c = i;
-		pushData( bytecode, &c, 1 );
+		if ( m_optimize )
+		{
+			LocalSpan& S = localSpan( hash );
+			if ( S.first == m_statement )
+			{
+				++S.loads;
+			}
+			else
+			{
+				// named again further on, it only stays scoped if
+				// that is somewhere inside the block it started in
+				S.last = m_statement;
+				int b = m_block;
+				for( ; b != -1 && b != S.block; b = m_blockParents[b] );
+				S.scoped = S.scoped && b == S.block;
+			}
+		}
+
+		pushLoad( bytecode, false, i );
 	}
 	
 	return i;
@@ -956,9 +1324,7 @@ int WRCompilationContext::addGlobalSpaceLoad( WRBytecode& bytecode, WRstr& token
 
 	if ( !addOnly )
 	{
-		pushOpcode( bytecode, O_LoadFromGlobal );
-		unsigned char c = i;
-		pushData( bytecode, &c, 1 );
+		pushLoad( bytecode, true, i );
 	}
 
 	return i;
@@ -967,6 +1333,11 @@ int WRCompilationContext::addGlobalSpaceLoad( WRBytecode& bytecode, WRstr& token
 //------------------------------------------------------------------------------
 void WRCompilationContext::loadExpressionContext( WRExpression& expression, int depth, int operation )
 {
+	if ( m_optimize && expression.context[depth].stackPosition == -1 )
+	{
+		expression.context[depth].resultType = contextType( expression, depth );
+	}
+
 	if ( operation > 0
 		 && expression.context[operation].operation
 		 && expression.context[operation].operation->opcode == O_HASH_PLACEHOLDER
@@ -998,6 +1369,27 @@ void WRCompilationContext::loadExpressionContext( WRExpression& expression, int
 			case EXTYPE_LABEL_AND_NULL:
 			case EXTYPE_LABEL:
 			{
+				if ( !m_localsNoted
+					 && !expression.context[depth].global
+					 && tracksLocals(expression) )
+				{
+					// on its own it is only read, or for a bare 'var'
+					// declaration set to 0. Anywhere else it could be
+					// handed out as a reference
+					WRLocalUse use = LOCAL_OTHER;
+					if ( expression.valueOnly && expression.context.count() == 1 )
+					{
+						use = (expression.context[depth].type == EXTYPE_LABEL) ? LOCAL_READ
+							  : (expression.context[depth].blankSeen ? LOCAL_OTHER : LOCAL_STORE);
+					}
+					
+					noteLocal( wr_hashStr(expression.context[depth].token), use, 0, WR_INT );
+					if ( use == LOCAL_STORE )
+					{
+						overwriteLocal( wr_hashStr(expression.context[depth].token) );
+					}
+				}
+
 					if ( expression.context[depth].global )
 					{
 						addGlobalSpaceLoad( expression.bytecode,
@@ -1071,7 +1463,31 @@ void WRExpression::swapWithTop( int stackPosition, bool addOpcodes )
 
 	assert( (currentTop != (unsigned int)-1) && (swapWith != (unsigned int)-1) );
 
-	if ( addOpcodes )
+	const unsigned int size = bytecode.all.size();
+	const unsigned int cached = bytecode.opcodes.size();
+	if ( addOpcodes
+		 && stackPosition == 1
+		 && cached >= 2
+		 && bytecode.opcodes[cached - 2] == O_LocalIndexHash
+		 && bytecode.opcodes[cached - 1] == O_LocalIndexHash
+		 && size >= 12
+		 && bytecode.all[size - 12] == O_LocalIndexHash
+		 && bytecode.all[size - 6] == O_LocalIndexHash )
+	{
+		// 'a.x op= b.y' looks both members up and swaps them, which is
+		// the same twelve bytes as one wide instruction that does it all:
+		// [LIH][a][hash] [LIH][b][hash] -> [O_Wide][sub][a][hash] [b][hash]
+		for( unsigned int i = size - 6; i > size - 11; --i )
+		{
+			bytecode.all[i] = bytecode.all[i - 1];
+		}
+		bytecode.all[size - 11] = W_LLIndexHashPair;
+		bytecode.all[size - 12] = O_Wide;
+
+		bytecode.opcodes.shave( 2 );
+		bytecode.opcodes += O_Wide;
+	}
+	else if ( addOpcodes )
 	{
 		unsigned char pos = stackPosition + 1;
 		WRCompilationContext::pushOpcode( bytecode, O_StackSwap );
@@ -1082,66 +1498,1171 @@ void WRExpression::swapWithTop( int stackPosition, bool addOpcodes )
 }
 
 //------------------------------------------------------------------------------
-void WRCompilationContext::resolveExpression( WRExpression& expression )
+// move context 'first' to the top and 'second' just below it with one
+// SwapTwoToTop, which swaps the top with A and then the slot below the
+// top with B
+void WRExpression::swapTwoToTop( const int first, const int second )
 {
-	if ( expression.context.count() == 1 ) // single expression is trivial to resolve, load it!
+	const int f = context[first].stackPosition;
+	const int s = context[second].stackPosition ? context[second].stackPosition : f; // where second is after the first swap
+
+	WRCompilationContext::pushOpcode( bytecode, O_SwapTwoToTop );
+	unsigned char pos = f + 1;
+	WRCompilationContext::pushData( bytecode, &pos, 1 );
+	pos = s + 1;
+	WRCompilationContext::pushData( bytecode, &pos, 1 );
+
+	swapWithTop( f, false );
+
+	// slot 1 <-> slot s by way of the top
+	swapWithTop( 1, false );
+	swapWithTop( s, false );
+	swapWithTop( 1, false );
+}
+
+//------------------------------------------------------------------------------
+// operations that only read their operands and cannot do anything
+// else, so literal operands can be worked out ahead of time
+static bool wr_isPureOperation( const int opcode )
+{
+	switch( opcode )
 	{
-		loadExpressionContext( expression, 0, 0 );
-		return;
-	}
+		case O_CompareEQ:
+		case O_CompareNE:
+		case O_CompareGE:
+		case O_CompareLE:
+		case O_CompareGT:
+		case O_CompareLT:
+		case O_LogicalAnd:
+		case O_LogicalOr:
+		case O_LogicalNot:
+		case O_BitwiseNOT:
+		case O_Negate:
+		case O_BinaryAddition:
+		case O_BinarySubtraction:
+		case O_BinaryMultiplication:
+		case O_BinaryDivision:
+		case O_BinaryMod:
+		case O_BinaryOr:
+		case O_BinaryAnd:
+		case O_BinaryXOR:
+		case O_BinaryRightShift:
+		case O_BinaryLeftShift:
+		case O_ToInt:
+		case O_ToFloat:
+			return true;
 
-	unsigned int resolves = 1;
-	unsigned int startedWith = expression.context.count();
+		default:
+			return false;
+	}
+}
 
-	for( int p=0; p<c_highestPrecedence && expression.context.count() > 1; ++p )
+//------------------------------------------------------------------------------
+// 'a <opcode> b', or '<opcode> b' when 'a' is null, worked out the
+// way the VM would. Anything the VM would do differently depending
+// on how it was built (dividing by zero, shifting too far, comparing
+// floats) is left for it to do
+static bool wr_foldOperation( const int opcode, const WRValue* a, const WRValue& b, WRValue& result )
+{
+	if ( !a )
 	{
-		// left to right operations
-		for( int o=0; (unsigned int)o < expression.context.count(); ++o )
+		if ( b.type == WR_INT )
 		{
-			if ( (expression.context[o].type != EXTYPE_OPERATION)
-				 || expression.context[o].operation->precedence > p
-				 || !expression.context[o].operation->leftToRight )
+			result.p2 = INIT_AS_INT;
+			switch( opcode )
 			{
-				continue;
+				case O_Negate: result.i = wr_isub_wrap( 0, b.i ); return true;
+				case O_BitwiseNOT: result.i = ~b.i; return true;
+				case O_LogicalNot: result.i = !b.i; return true;
+				case O_ToInt: result.i = b.i; return true;
+				case O_ToFloat: result.p2 = INIT_AS_FLOAT; result.f = (float)b.i; return true;
+				default: return false;
 			}
+		}
 
-			resolves += resolveExpressionEx( expression, o, p );
-			if (m_err)
+		switch( opcode )
+		{
+			case O_Negate: result.p2 = INIT_AS_FLOAT; result.f = -b.f; return true;
+			case O_ToFloat: result = b; return true;
+			case O_ToInt:
 			{
-				return;
+				if ( !(b.f >= -2147483648.f && b.f < 2147483648.f) )
+				{
+					return false;
+				}
+				result.p2 = INIT_AS_INT;
+				result.i = (int32_t)b.f;
+				return true;
 			}
-			o = (unsigned int)-1;
+			default: return false;
 		}
+	}
 
-		// right to left operations
-		for( int o = expression.context.count() - 1; o >= 0; --o )
+	if ( a->type == WR_INT && b.type == WR_INT )
+	{
+		const int32_t minInt = (int32_t)0x80000000;
+		result.p2 = INIT_AS_INT;
+		switch( opcode )
 		{
-			if ( (expression.context[o].type != EXTYPE_OPERATION)
-				 || expression.context[o].operation->precedence > p
-				 || expression.context[o].operation->leftToRight )
+			case O_BinaryAddition: result.i = wr_iadd_wrap( a->i, b.i ); return true;
+			case O_BinarySubtraction: result.i = wr_isub_wrap( a->i, b.i ); return true;
+			case O_BinaryMultiplication: result.i = wr_imul_wrap( a->i, b.i ); return true;
+			case O_BinaryDivision:
+			case O_BinaryMod:
 			{
-				continue;
+				if ( !b.i || (b.i == -1 && a->i == minInt) )
+				{
+					return false;
+				}
+				result.i = (opcode == O_BinaryDivision) ? (a->i / b.i) : (a->i % b.i);
+				return true;
 			}
-
-			resolves += resolveExpressionEx( expression, o, p );
-			if (m_err)
+			case O_BinaryOr: result.i = a->i | b.i; return true;
+			case O_BinaryAnd: result.i = a->i & b.i; return true;
+			case O_BinaryXOR: result.i = a->i ^ b.i; return true;
+			case O_BinaryRightShift:
+			case O_BinaryLeftShift:
 			{
-				return;
+				if ( (uint32_t)b.i > 31 )
+				{
+					return false;
+				}
+				result.i = (opcode == O_BinaryRightShift) ? (a->i >> b.i) : (int32_t)((uint32_t)a->i << b.i);
+				return true;
 			}
-			o = expression.context.count();
+			case O_CompareEQ: result.i = a->i == b.i; return true;
+			case O_CompareNE: result.i = a->i != b.i; return true;
+			case O_CompareGE: result.i = a->i >= b.i; return true;
+			case O_CompareLE: result.i = a->i <= b.i; return true;
+			case O_CompareGT: result.i = a->i > b.i; return true;
+			case O_CompareLT: result.i = a->i < b.i; return true;
+			case O_LogicalAnd: result.i = a->i && b.i; return true;
+			case O_LogicalOr: result.i = a->i || b.i; return true;
+			default: return false;
 		}
 	}
 
-	if ( startedWith && (resolves != startedWith) )
+	// otherwise the int side is promoted, as the VM does
+	const float f1 = (a->type == WR_INT) ? (float)a->i : a->f;
+	const float f2 = (b.type == WR_INT) ? (float)b.i : b.f;
+	result.p2 = INIT_AS_FLOAT;
+	switch( opcode )
 	{
-		m_err = WR_ERR_bad_expression;
-		return;
+		case O_BinaryAddition: result.f = f1 + f2; return true;
+		case O_BinarySubtraction: result.f = f1 - f2; return true;
+		case O_BinaryMultiplication: result.f = f1 * f2; return true;
+		case O_BinaryDivision:
+		{
+			if ( f2 == 0.f )
+			{
+				return false;
+			}
+			result.f = f1 / f2;
+			return true;
+		}
+		default: return false;
 	}
 }
 
 //------------------------------------------------------------------------------
-unsigned int WRCompilationContext::resolveExpressionEx( WRExpression& expression, int o, int p )
+static bool wr_isNumericLiteral( WRExpressionContext& context )
 {
+	return context.type == EXTYPE_LITERAL
+		   && context.stackPosition == -1
+		   && (context.value.type == WR_INT || context.value.type == WR_FLOAT);
+}
+
+//------------------------------------------------------------------------------
+bool WRCompilationContext::tracksLocals( WRExpression& expression )
+{
+	return m_optimize
+		   && m_unitTop != 0
+		   && !expression.bytecode.isStructSpace
+		   && !m_units[m_unitTop].bytecode.isStructSpace
+		   && !m_units[m_unitTop].parentUnitIndex;
+}
+
+//------------------------------------------------------------------------------
+// a local is constant if the first thing that happens to it is a
+// 'var' declaration that assigns it a literal, in code that runs
+// exactly once per call, and everything after that only reads it.
+//
+// It has a type if the first thing that happens to it settles one,
+// and every store after that keeps it. Every local starts out as the
+// int 0, so reading it first makes it an int; a float has to be
+// stored by a statement every call runs, with no goto ahead of it
+// that could skip it
+void WRCompilationContext::noteLocal( const uint32_t hash, WRLocalUse use, const WRValue* value, const int type )
+{
+	for( unsigned int h=0; h<m_hoisted.count(); ++h )
+	{
+		if ( m_hoisted[h].hash == hash && m_hoisted[h].unit == m_unitTop )
+		{
+			return; // only ever set by the code moved out of its loop
+		}
+	}
+
+	for( unsigned int l=0; use != LOCAL_READ && l<m_loops.count(); ++l )
+	{
+		unsigned int w = 0;
+		for( ; w<m_loopStores.count(); ++w )
+		{
+			if ( m_loopStores[w].hash == hash && m_loopStores[w].first == m_loops[l].first && m_loopStores[w].unit == m_unitTop )
+			{
+				break;
+			}
+		}
+
+		if ( w >= m_loopStores.count() )
+		{
+			LoopLocal& W = m_loopStores.append();
+			W.unit = m_unitTop;
+			W.first = m_loops[l].first;
+			W.hash = hash;
+		}
+	}
+
+	LocalSpan& S = localSpan( hash );
+	if ( S.first == m_statement )
+	{
+		++S.notes;
+	}
+
+	unsigned int l = 0;
+	for( ; l<m_localUses.count(); ++l )
+	{
+		if ( m_localUses[l].hash == hash && m_localUses[l].unit == m_unitTop )
+		{
+			if ( use != LOCAL_READ )
+			{
+				m_localUses[l].constant = false;
+			}
+
+			if ( use == LOCAL_OTHER || (use == LOCAL_STORE && type != m_localUses[l].type) )
+			{
+				m_localUses[l].type = -1;
+			}
+			return;
+		}
+	}
+
+	KnownLocal& L = m_localUses.append();
+	L.unit = m_unitTop;
+	L.hash = hash;
+	L.constant = value && (use == LOCAL_STORE) && m_straightLine;
+	if ( value )
+	{
+		L.value = *value;
+	}
+
+	if ( use == LOCAL_READ )
+	{
+		L.type = WR_INT;
+	}
+	else if ( use == LOCAL_STORE
+			  && (type == WR_INT
+				  || (type == WR_FLOAT && m_unconditional && !m_units[m_unitTop].bytecode.gotoSource.count())) )
+	{
+		L.type = type;
+	}
+}
+
+//------------------------------------------------------------------------------
+bool WRCompilationContext::knownLocal( WRstr const& token, WRValue& value )
+{
+	uint32_t hash = wr_hashStr( token );
+	for( unsigned int l=0; l<m_knownLocals.count(); ++l )
+	{
+		if ( m_knownLocals[l].hash == hash && m_knownLocals[l].unit == m_unitTop )
+		{
+			value = m_knownLocals[l].value;
+			return m_knownLocals[l].constant;
+		}
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// the span of a local of this unit, started at this statement if
+// nothing has named it yet
+LocalSpan& WRCompilationContext::localSpan( const uint32_t hash )
+{
+	for( unsigned int l=0; l<m_localSpans.count(); ++l )
+	{
+		if ( m_localSpans[l].hash == hash && m_localSpans[l].unit == m_unitTop )
+		{
+			return m_localSpans[l];
+		}
+	}
+
+	LocalSpan& S = m_localSpans.append();
+	S.unit = m_unitTop;
+	S.hash = hash;
+	S.first = m_statement;
+	S.last = m_statement;
+	S.block = m_block;
+	S.loads = 0;
+	S.notes = 0;
+	S.writes = 0;
+	S.scoped = true;
+	S.pinned = false;
+	return S;
+}
+
+//------------------------------------------------------------------------------
+// the local has just been noted as stored to with no regard for what
+// it held, which is the only way it can start a span part way through
+// a unit
+void WRCompilationContext::overwriteLocal( const uint32_t hash )
+{
+	LocalSpan& S = localSpan( hash );
+	if ( S.first == m_statement )
+	{
+		++S.writes;
+	}
+}
+
+//------------------------------------------------------------------------------
+// start a block inside the current one, returning the current one
+// for the caller to put back when it ends
+int WRCompilationContext::openBlock()
+{
+	const int block = m_block;
+	m_block = m_blockParents.count();
+	m_blockParents.append() = block;
+	return block;
+}
+
+//------------------------------------------------------------------------------
+void WRCompilationContext::addLoopSpan( const int first )
+{
+	if ( m_optimize )
+	{
+		LoopSpan& L = m_loopSpans.append();
+		L.unit = m_unitTop;
+		L.first = first;
+		L.last = m_statement;
+	}
+}
+
+//------------------------------------------------------------------------------
+// start a loop at statement 'first', with 'code' to collect what is
+// moved ahead of it. As many locals as the last pass found a use for
+// are set aside for it now, so every expression inside it already has
+// them in its space
+void WRCompilationContext::openLoop( const int first, WRBytecode& code )
+{
+	if ( !m_optimize )
+	{
+		return;
+	}
+
+	LoopHoist& L = m_loops.append();
+	L.first = first;
+	L.slots = 0;
+	L.base = m_hoistSlots;
+	L.used = 0;
+	L.hoists = 0;
+	L.entry = -1;
+	L.code = &code;
+
+	for( unsigned int f=0; m_hoistLoops && !m_guessTypes && f<m_lastLoopFacts.count(); ++f )
+	{
+		if ( m_lastLoopFacts[f].unit == m_unitTop && m_lastLoopFacts[f].first == first )
+		{
+			L.slots = m_lastLoopFacts[f].hoists;
+			break;
+		}
+	}
+
+	for( int s=0; s<L.slots; ++s )
+	{
+		WRstr token;
+		token.format( "@hoist:%d", m_hoistSlots++ );
+		addLocalSpaceLoad( m_units[m_unitTop].bytecode, token, true, true );
+	}
+}
+
+//------------------------------------------------------------------------------
+// the loop opened last is about to test its condition for the first
+// time, anything moved out of it has to be run first
+void WRCompilationContext::enterLoop()
+{
+	if ( m_optimize && m_loops.tail()->slots )
+	{
+		m_loops.tail()->entry = addRelativeJumpTarget( m_units[m_unitTop].bytecode );
+		addRelativeJumpSource( m_units[m_unitTop].bytecode, O_RelativeJump, m_loops.tail()->entry );
+	}
+}
+
+//------------------------------------------------------------------------------
+// the loop opened last has just emitted the jump back to its top; what
+// was moved out of it goes after that, and jumps to 'back' when done
+void WRCompilationContext::closeLoop( const int back )
+{
+	if ( !m_optimize )
+	{
+		return;
+	}
+
+	LoopHoist& L = *m_loops.tail();
+	WRBytecode& bytecode = m_units[m_unitTop].bytecode;
+	if ( L.entry != -1 )
+	{
+		setRelativeJumpTarget( bytecode, L.entry );
+		bytecode.invalidateOpcodeCache();
+		appendBytecode( bytecode, *L.code );
+		addRelativeJumpSource( bytecode, O_RelativeJump, back );
+	}
+
+	LoopFacts& F = m_loopFacts.append();
+	F.unit = m_unitTop;
+	F.first = L.first;
+	F.slots = L.slots;
+	F.hoists = L.hoists;
+
+	m_loops.pop();
+}
+
+//------------------------------------------------------------------------------
+// the type a local of this unit is taken to hold: while guessing,
+// whatever it has held so far (so one nothing has touched yet is
+// still the int 0), otherwise whatever the last pass settled on
+int WRCompilationContext::localType( const uint32_t hash )
+{
+	for( unsigned int h=0; h<m_hoisted.count(); ++h )
+	{
+		if ( m_hoisted[h].hash == hash && m_hoisted[h].unit == m_unitTop )
+		{
+			return m_hoisted[h].type;
+		}
+	}
+
+	WRarray<KnownLocal>& locals = m_guessTypes ? m_localUses : m_knownLocals;
+	for( unsigned int l=0; l<locals.count(); ++l )
+	{
+		if ( locals[l].hash == hash && locals[l].unit == m_unitTop )
+		{
+			return locals[l].type;
+		}
+	}
+
+	return m_guessTypes ? WR_INT : -1;
+}
+
+//------------------------------------------------------------------------------
+// WR_INT or WR_FLOAT if that is all context 'index' can be, otherwise -1
+int WRCompilationContext::contextType( WRExpression& expression, const int index )
+{
+	if ( index < 0 || index >= (int)expression.context.count() )
+	{
+		return -1;
+	}
+
+	WRExpressionContext& context = expression.context[index];
+	if ( context.stackPosition != -1 || context.type == EXTYPE_BYTECODE_RESULT )
+	{
+		return context.resultType;
+	}
+	else if ( context.type == EXTYPE_LITERAL )
+	{
+		return (context.value.type == WR_INT || context.value.type == WR_FLOAT) ? context.value.type : -1;
+	}
+	else if ( context.type == EXTYPE_LABEL && !context.global && tracksLocals(expression) )
+	{
+		// a name this unit has not given a slot yet could still turn
+		// out to be a global
+		const uint32_t hash = wr_hashStr( context.token );
+		for( unsigned int i=0; i<expression.bytecode.localSpace.count(); ++i )
+		{
+			if ( expression.bytecode.localSpace[i].hash == hash )
+			{
+				return localType( hash );
+			}
+		}
+	}
+
+	return -1;
+}
+
+//------------------------------------------------------------------------------
+static int wr_arithmeticType( const int left, const int right )
+{
+	if ( left == WR_INT && right == WR_INT )
+	{
+		return WR_INT;
+	}
+
+	return ((left == WR_INT || left == WR_FLOAT) && (right == WR_INT || right == WR_FLOAT)) ? WR_FLOAT : -1;
+}
+
+//------------------------------------------------------------------------------
+// the type operation 'o' leaves behind, as far as its operands say
+int WRCompilationContext::operationType( WRExpression& expression, const int o )
+{
+	const WROperation* operation = expression.context[o].operation;
+	const int left = (operation->type == WR_OPER_PRE) ? -1 : contextType( expression, o - 1 );
+	const int right = (operation->type == WR_OPER_POST) ? -1 : contextType( expression, o + 1 );
+
+	switch( operation->opcode )
+	{
+		case O_CompareEQ:
+		case O_CompareNE:
+		case O_CompareGE:
+		case O_CompareLE:
+		case O_CompareGT:
+		case O_CompareLT:
+		case O_LogicalAnd:
+		case O_LogicalOr:
+		case O_LogicalNot:
+		case O_ToInt:
+			return WR_INT;
+
+		case O_ToFloat:
+			return WR_FLOAT;
+
+		case O_CountOf:
+			return WR_INT;
+
+		case O_Negate:
+		case O_PreIncrement:
+		case O_PreDecrement:
+			return right;
+
+		case O_PostIncrement:
+		case O_PostDecrement:
+			return left;
+
+		case O_BitwiseNOT:
+			return (right == WR_INT) ? WR_INT : -1;
+
+		case O_Assign:
+			return right;
+
+		case O_BinaryAddition:
+		case O_BinarySubtraction:
+		case O_BinaryMultiplication:
+		case O_BinaryDivision:
+		case O_AddAssign:
+		case O_SubtractAssign:
+		case O_MultiplyAssign:
+		case O_DivideAssign:
+			return wr_arithmeticType( left, right );
+
+		case O_BinaryMod:
+		case O_BinaryOr:
+		case O_BinaryAnd:
+		case O_BinaryXOR:
+		case O_BinaryRightShift:
+		case O_BinaryLeftShift:
+		case O_ModAssign:
+		case O_ORAssign:
+		case O_ANDAssign:
+		case O_XORAssign:
+		case O_RightShiftAssign:
+		case O_LeftShiftAssign:
+			return (left == WR_INT && right == WR_INT) ? WR_INT : -1;
+
+		default:
+			return -1;
+	}
+}
+
+//------------------------------------------------------------------------------
+static bool wr_isTrackedLocal( WRExpressionContext& context, const bool track )
+{
+	return track
+		   && context.type == EXTYPE_LABEL
+		   && context.stackPosition == -1
+		   && !context.global;
+}
+
+//------------------------------------------------------------------------------
+// WR_OPTIMIZE looks at operation 'o' before it is resolved, noting
+// what it does to any locals and swapping in the value of any known
+// to be constant. When that leaves nothing but literals the work is
+// done here and the result left as a literal; returns how many
+// contexts that resolved, or 0 if the operation still needs code
+unsigned int WRCompilationContext::optimizeOperation( WRExpression& expression, int o )
+{
+	const WROperation* operation = expression.context[o].operation;
+	const int count = expression.context.count();
+
+	int a = o - 1; // left operand
+	int b = o + 1; // right operand
+	if ( operation->type == WR_OPER_PRE )
+	{
+		a = -1;
+	}
+	else if ( operation->type == WR_OPER_POST )
+	{
+		b = -1;
+	}
+
+	if ( (b != -1 && b >= count) || (operation->type != WR_OPER_PRE && a < 0) )
+	{
+		return 0; // let the usual path report it
+	}
+
+	const bool pure = wr_isPureOperation( operation->opcode );
+	const bool assign = operation->opcode == O_Assign;
+	const bool compound = operation->opcode == O_AddAssign
+						  || operation->opcode == O_SubtractAssign
+						  || operation->opcode == O_MultiplyAssign
+						  || operation->opcode == O_DivideAssign
+						  || operation->opcode == O_ModAssign
+						  || operation->opcode == O_ORAssign
+						  || operation->opcode == O_ANDAssign
+						  || operation->opcode == O_XORAssign
+						  || operation->opcode == O_RightShiftAssign
+						  || operation->opcode == O_LeftShiftAssign;
+	const bool step = operation->opcode == O_PreIncrement
+					  || operation->opcode == O_PreDecrement
+					  || operation->opcode == O_PostIncrement
+					  || operation->opcode == O_PostDecrement;
+	const bool track = tracksLocals( expression );
+	WRValue value;
+
+	m_localsNoted = pure || assign || compound || step;
+
+	if ( !m_localsNoted )
+	{
+		return 0;
+	}
+
+	// a store leaves a reference to what it stored on the stack, so
+	// it only counts as one if nothing can hold on to that
+	const WRLocalUse store = expression.valueOnly ? LOCAL_STORE : LOCAL_OTHER;
+
+	if ( step )
+	{
+		const int operand = (a == -1) ? b : a;
+		if ( wr_isTrackedLocal(expression.context[operand], track) )
+		{
+			noteLocal( wr_hashStr(expression.context[operand].token), store, 0, contextType(expression, operand) );
+		}
+		return 0;
+	}
+
+	// a compare between two different types converts the local it
+	// was handed in place, so it only reads one when the other side is
+	// known to be the same type
+	const bool compare = operation->opcode == O_CompareEQ
+						 || operation->opcode == O_CompareNE
+						 || operation->opcode == O_CompareGE
+						 || operation->opcode == O_CompareLE
+						 || operation->opcode == O_CompareGT
+						 || operation->opcode == O_CompareLT;
+
+	// an assignment only reads what it assigns
+	const int reads[2] = { pure ? a : -1, compound ? -1 : b };
+	for( int r=0; r<2; ++r )
+	{
+		if ( reads[r] == -1 )
+		{
+			continue;
+		}
+
+		WRExpressionContext& context = expression.context[reads[r]];
+		if ( wr_isTrackedLocal(context, track) )
+		{
+			const int type = compare ? contextType( expression, reads[r] ) : -1;
+			noteLocal( wr_hashStr(context.token),
+					   (!compare || (type != -1 && type == contextType(expression, r ? a : b))) ? LOCAL_READ : LOCAL_OTHER );
+
+			if ( knownLocal(context.token, value) )
+			{
+				context.type = EXTYPE_LITERAL;
+				context.value = value;
+			}
+		}
+	}
+
+	if ( compound )
+	{
+		WRExpressionContext& target = expression.context[a];
+		WRExpressionContext& source = expression.context[b];
+		const bool local = wr_isTrackedLocal( target, track );
+		const int type = local ? operationType( expression, o ) : -1;
+
+		if ( wr_isTrackedLocal(source, track) )
+		{
+			// when the two sides differ the compound forms convert
+			// what they were handed in place, so the source is only
+			// read if it matches the local it is applied to
+			const int sourceType = contextType( expression, b );
+			noteLocal( wr_hashStr(source.token),
+					   (local && sourceType != -1 && sourceType == contextType(expression, a)) ? LOCAL_READ : LOCAL_OTHER );
+
+			if ( knownLocal(source.token, value) )
+			{
+				source.type = EXTYPE_LITERAL;
+				source.value = value;
+			}
+		}
+
+		if ( local )
+		{
+			noteLocal( wr_hashStr(target.token), store, 0, type );
+		}
+		return 0;
+	}
+
+	if ( assign )
+	{
+		WRExpressionContext& target = expression.context[a];
+		if ( !wr_isTrackedLocal(target, track) )
+		{
+			return 0;
+		}
+
+		// the store itself stays even once every read has been
+		// replaced: any function can be instanced with 'new', and
+		// then its locals are the members
+		const bool literal = store == LOCAL_STORE && target.varSeen && wr_isNumericLiteral( expression.context[b] );
+		noteLocal( wr_hashStr(target.token), store, literal ? &expression.context[b].value : 0, contextType(expression, b) );
+		overwriteLocal( wr_hashStr(target.token) );
+		return 0;
+	}
+
+	if ( a == -1 )
+	{
+		if ( wr_isNumericLiteral(expression.context[b])
+			 && wr_foldOperation(operation->opcode, 0, expression.context[b].value, value) )
+		{
+			expression.context[b].value = value;
+			expression.context.remove( o, 1 );
+			m_localsNoted = false;
+			return 1;
+		}
+	}
+	else if ( wr_isNumericLiteral(expression.context[a])
+			  && wr_isNumericLiteral(expression.context[b])
+			  && wr_foldOperation(operation->opcode, &expression.context[a].value, expression.context[b].value, value) )
+	{
+		expression.context[a].value = value;
+		expression.context.remove( o, 2 );
+		m_localsNoted = false;
+		return 2;
+	}
+
+	return hoistOperation( expression, o );
+}
+
+//------------------------------------------------------------------------------
+// an operation on nothing but numbers, in a loop that never stores to
+// the locals it reads, gives the same answer every time around. Work
+// it out once into a local set aside in the outermost loop that
+// allows it, before that loop starts, and read that instead. Returns
+// how many contexts that resolved, like optimizeOperation()
+unsigned int WRCompilationContext::hoistOperation( WRExpression& expression, const int o )
+{
+	if ( m_hoisting || m_guessTypes || !m_hoistLoops || !m_loops.count() || !tracksLocals(expression) )
+	{
+		return 0;
+	}
+
+	// division and shifts have rules for what they are handed that
+	// could trip on a path that never ran them
+	switch( expression.context[o].operation->opcode )
+	{
+		case O_BinaryAddition:
+		case O_BinarySubtraction:
+		case O_BinaryMultiplication:
+		case O_BinaryOr:
+		case O_BinaryAnd:
+		case O_BinaryXOR:
+			break;
+
+		default:
+			return 0;
+	}
+
+	const int type = operationType( expression, o );
+	if ( type == -1 )
+	{
+		return 0;
+	}
+
+	WRarray<WRNamespaceLookup>& space = m_units[m_unitTop].bytecode.localSpace;
+	int loop = 0;
+	int labels = 0;
+	uint32_t reads[2];
+	for( int side=-1; side<=1; side += 2 )
+	{
+		WRExpressionContext& context = expression.context[o + side];
+		if ( wr_isNumericLiteral(context) )
+		{
+			continue;
+		}
+
+		if ( !wr_isTrackedLocal(context, true) || contextType(expression, o + side) == -1 )
+		{
+			return 0;
+		}
+
+		const uint32_t hash = wr_hashStr( context.token );
+		unsigned int i = 0;
+		for( ; i<space.count() && space[i].hash != hash; ++i );
+		if ( i >= space.count() )
+		{
+			return 0;
+		}
+
+		// one moved already can only be read once its own loop has set it
+		for( unsigned int h=0; h<m_hoisted.count(); ++h )
+		{
+			if ( m_hoisted[h].hash == hash && m_hoisted[h].unit == m_unitTop && m_hoisted[h].loop > loop )
+			{
+				loop = m_hoisted[h].loop;
+			}
+		}
+
+		// and not past the innermost loop that stores to it
+		for( int l=m_loops.count() - 1; l >= loop; --l )
+		{
+			unsigned int w = 0;
+			for( ; w<m_lastLoopStores.count(); ++w )
+			{
+				if ( m_lastLoopStores[w].hash == hash && m_lastLoopStores[w].first == m_loops[l].first && m_lastLoopStores[w].unit == m_unitTop )
+				{
+					break;
+				}
+			}
+
+			if ( w < m_lastLoopStores.count() )
+			{
+				loop = l + 1;
+				break;
+			}
+		}
+
+		reads[labels++] = hash;
+	}
+
+	if ( !labels || loop >= (int)m_loops.count() )
+	{
+		return 0;
+	}
+
+	++m_loops[loop].hoists;
+	if ( m_loops[loop].used >= m_loops[loop].slots )
+	{
+		return 0; // the next pass will have room for it
+	}
+
+	WRstr token;
+	token.format( "@hoist:%d", m_loops[loop].base + m_loops[loop].used++ );
+	const uint32_t hash = wr_hashStr( token );
+
+	HoistedLocal& H = m_hoisted.append();
+	H.unit = m_unitTop;
+	H.hash = hash;
+	H.type = type;
+	H.loop = loop;
+
+	for( int r=0; r<labels; ++r )
+	{
+		LoopLocal& R = m_loopReads.append();
+		R.unit = m_unitTop;
+		R.first = m_loops[loop].first;
+		R.hash = reads[r];
+	}
+
+	// <hoist> = <a> <op> <b>;
+	WRExpression hoist( space, false );
+	hoist.valueOnly = true;
+	hoist.context[0].type = EXTYPE_LABEL;
+	hoist.context[0].token = token;
+	hoist.context[0].varSeen = true;
+	operatorFound( "=", hoist.context, 1 );
+	hoist.context[2] = expression.context[o - 1];
+	hoist.context[3] = expression.context[o];
+	hoist.context[4] = expression.context[o + 1];
+
+	m_hoisting = true;
+	resolveExpression( hoist );
+	pushOpcode( hoist.bytecode, O_PopOne );
+	m_hoisting = false;
+
+	appendBytecode( *m_loops[loop].code, hoist.bytecode );
+	localSpan( hash ).pinned = true;
+
+	WRExpressionContext& result = expression.context[o - 1];
+	result.reset();
+	result.type = EXTYPE_LABEL;
+	result.token = token;
+	result.varSeen = true;
+	expression.context.remove( o, 2 );
+	m_localsNoted = false;
+	return 2;
+}
+
+//------------------------------------------------------------------------------
+// the type the last pass proved local 'slot' of this unit holds, or -1
+int WRCompilationContext::slotType( WRBytecode& bytecode, const int slot )
+{
+	if ( !m_optimize || m_guessTypes || slot >= (int)bytecode.localSpace.count() )
+	{
+		return -1;
+	}
+
+	return localType( bytecode.localSpace[slot].hash );
+}
+
+//------------------------------------------------------------------------------
+// 'offset' is where addRelativeJumpSource() is about to point the jump
+// that was just fused onto the end of 'bytecode'. When that compares
+// two int locals, or an int local with a small literal, swap in the
+// wide form that skips the type dispatch, and return where its jump
+// vector goes instead
+int WRCompilationContext::typedCompare( WRBytecode& bytecode, const int offset )
+{
+	const int size = bytecode.all.size();
+	const int cached = bytecode.opcodes.size();
+	if ( offset < 1 || cached < 1 )
+	{
+		return offset;
+	}
+
+	const unsigned char op = bytecode.all[offset - 1];
+
+	if ( op >= O_LLCompareLTBZ && op <= O_LLCompareNEBZ && offset == size - 2 )
+	{
+		if ( slotType(bytecode, bytecode.all[size - 2]) != WR_INT
+			 || slotType(bytecode, bytecode.all[size - 1]) != WR_INT )
+		{
+			return offset;
+		}
+
+		// [op][l][l] -> [O_Wide][sub][l][l]
+		bytecode.all += bytecode.all[size - 1];
+		bytecode.all[size - 1] = bytecode.all[size - 2];
+		bytecode.all[size - 2] = W_IntLLCompareLTBZ + (op - O_LLCompareLTBZ);
+		bytecode.all[size - 3] = O_Wide;
+		bytecode.opcodes[cached - 1] = O_Wide;
+		return offset;
+	}
+
+	// 'i < a._count' can not keep the count from one time to the next,
+	// anything that indexes 'a' can grow it, but it can skip loading
+	// it onto the stack to be compared
+	if ( op == O_CompareBLT
+		 && offset == size
+		 && size >= 6
+		 && cached >= 4
+		 && bytecode.opcodes[cached - 4] == O_LoadFromLocal
+		 && bytecode.opcodes[cached - 3] == O_CountOf
+		 && bytecode.opcodes[cached - 2] == O_LoadFromLocal
+		 && bytecode.all[size - 6] == O_LoadFromLocal
+		 && bytecode.all[size - 4] == O_CountOf
+		 && bytecode.all[size - 3] == O_LoadFromLocal
+		 && slotType(bytecode, bytecode.all[size - 2]) == WR_INT )
+	{
+		// [load a][count][load i][op] -> [O_Wide][sub][i][a]
+		const unsigned char array = bytecode.all[size - 5];
+		const unsigned char index = bytecode.all[size - 2];
+		bytecode.all.shave( 6 );
+		bytecode.all += O_Wide;
+		bytecode.all += (unsigned char)W_IntLCountLTBZ;
+		bytecode.all += index;
+		bytecode.all += array;
+
+		bytecode.opcodes.shave( 4 );
+		bytecode.opcodes += O_Wide;
+		return size - 5;
+	}
+
+	int sub;
+	switch( op )
+	{
+		case O_LSCompareLTBZ: sub = W_IntLICompareLTBZ; break;
+		case O_LSCompareLEBZ: sub = W_IntLICompareLEBZ; break;
+		case O_LSCompareGTBZ: sub = W_IntLICompareGTBZ; break;
+		case O_LSCompareGEBZ: sub = W_IntLICompareGEBZ; break;
+		case O_LSCompareEQBZ: sub = W_IntLICompareEQBZ; break;
+		case O_LSCompareNEBZ: sub = W_IntLICompareNEBZ; break;
+		default: return offset;
+	}
+
+	if ( offset != size - 1 || cached < 2 )
+	{
+		return offset;
+	}
+
+	// the literal the compare pops sits right in front of it
+	const unsigned char literal = bytecode.opcodes[cached - 2];
+	int16_t value;
+	int start;
+	if ( literal == O_LiteralZero )
+	{
+		start = size - 3;
+		value = 0;
+	}
+	else if ( literal == O_LiteralInt8 )
+	{
+		start = size - 4;
+		value = (int8_t)bytecode.all[size - 3];
+	}
+	else if ( literal == O_LiteralInt16 )
+	{
+		start = size - 5;
+		value = READ_16_FROM_PC( bytecode.all.p_str(size - 4) );
+	}
+	else
+	{
+		return offset;
+	}
+
+	const unsigned char slot = bytecode.all[size - 1];
+	if ( start < 0
+		 || bytecode.all[start] != literal
+		 || slotType(bytecode, slot) != WR_INT )
+	{
+		return offset;
+	}
+
+	// [literal][op][l] -> [O_Wide][sub][l][imm16]
+	unsigned char data[2];
+	bytecode.all.shave( size - start );
+	bytecode.all += O_Wide;
+	bytecode.all += (unsigned char)sub;
+	bytecode.all += slot;
+	pushData( bytecode, wr_pack16(value, data), 2 );
+
+	bytecode.opcodes.shave( 2 );
+	bytecode.opcodes += O_Wide;
+	return start + 1;
+}
+
+//------------------------------------------------------------------------------
+// the operation resolved since 'mark' fused into one LL arithmetic
+// instruction; when both locals are the same known type swap in the
+// wide form for it
+void WRCompilationContext::typedOperation( WRBytecode& bytecode, const unsigned int mark )
+{
+	if ( bytecode.all.size() != mark + 3 )
+	{
+		return;
+	}
+
+	const int type = slotType( bytecode, bytecode.all[mark + 1] );
+	if ( type == -1 || type != slotType(bytecode, bytecode.all[mark + 2]) )
+	{
+		return;
+	}
+
+	int sub = -1;
+	switch( bytecode.all[mark] )
+	{
+		case O_LLBinaryAddition: sub = (type == WR_INT) ? W_IntLLAddition : W_FloatLLAddition; break;
+		case O_LLBinarySubtraction: sub = (type == WR_INT) ? W_IntLLSubtraction : W_FloatLLSubtraction; break;
+		case O_LLBinaryMultiplication: sub = (type == WR_INT) ? W_IntLLMultiplication : W_FloatLLMultiplication; break;
+		case O_LLBinaryDivision: sub = (type == WR_FLOAT) ? W_FloatLLDivision : -1; break; // int division has its own rules for 0
+		default: break;
+	}
+
+	if ( sub == -1 )
+	{
+		return;
+	}
+
+	// [op][l][l] -> [O_Wide][sub][l][l]
+	bytecode.all += bytecode.all[mark + 2];
+	bytecode.all[mark + 2] = bytecode.all[mark + 1];
+	bytecode.all[mark + 1] = (unsigned char)sub;
+	bytecode.all[mark] = O_Wide;
+	bytecode.invalidateOpcodeCache();
+}
+
+//------------------------------------------------------------------------------
+void WRCompilationContext::resolveExpression( WRExpression& expression )
+{
+	if ( expression.context.count() == 1 ) // single expression is trivial to resolve, load it!
+	{
+		loadExpressionContext( expression, 0, 0 );
+		return;
+	}
+
+	unsigned int resolves = 1;
+	unsigned int startedWith = expression.context.count();
+
+	for( int p=0; p<c_highestPrecedence && expression.context.count() > 1; ++p )
+	{
+		// left to right operations
+		for( int o=0; (unsigned int)o < expression.context.count(); ++o )
+		{
+			if ( (expression.context[o].type != EXTYPE_OPERATION)
+				 || expression.context[o].operation->precedence > p
+				 || !expression.context[o].operation->leftToRight )
+			{
+				continue;
+			}
+
+			resolves += resolveExpressionEx( expression, o, p );
+			if (m_err)
+			{
+				return;
+			}
+			o = (unsigned int)-1;
+		}
+
+		// right to left operations
+		for( int o = expression.context.count() - 1; o >= 0; --o )
+		{
+			if ( (expression.context[o].type != EXTYPE_OPERATION)
+				 || expression.context[o].operation->precedence > p
+				 || expression.context[o].operation->leftToRight )
+			{
+				continue;
+			}
+
+			resolves += resolveExpressionEx( expression, o, p );
+			if (m_err)
+			{
+				return;
+			}
+			o = expression.context.count();
+		}
+	}
+
+	if ( startedWith && (resolves != startedWith) )
+	{
+		m_err = WR_ERR_bad_expression;
+		return;
+	}
+
+	if ( expression.context.count() == 1 && expression.context[0].stackPosition == -1 )
+	{
+		loadExpressionContext( expression, 0, 0 ); // everything folded into one literal
+	}
+}
+
+//------------------------------------------------------------------------------
+unsigned int WRCompilationContext::resolveExpressionEx( WRExpression& expression, int o, int p )
+{
+	int type = -1;
+	unsigned int mark = 0;
+	bool locals = false;
+	if ( m_optimize )
+	{
+		unsigned int resolved = optimizeOperation( expression, o );
+		if ( resolved )
+		{
+			return resolved;
+		}
+
+		type = operationType( expression, o );
+		mark = expression.bytecode.all.size();
+		locals = expression.context[o].operation->type != WR_OPER_PRE
+				 && expression.context[o].operation->type != WR_OPER_POST
+				 && wr_isTrackedLocal( expression.context[o - 1], tracksLocals(expression) )
+				 && wr_isTrackedLocal( expression.context[o + 1], tracksLocals(expression) );
+	}
+
+	const WROpcode opcode = expression.context[o].operation->opcode;
+	const int result = (expression.context[o].operation->type == WR_OPER_PRE) ? o : o - 1; // where what it leaves ends up
 	unsigned int ret = 0;
 	switch( expression.context[o].operation->type )
 	{
@@ -1149,400 +2670,1240 @@ unsigned int WRCompilationContext::resolveExpressionEx( WRExpression& expression
 		{
 			ret = 1;
 
-			if ( expression.context[o + 1].stackPosition == -1 )
+			if ( expression.context[o + 1].stackPosition == -1 )
+			{
+				loadExpressionContext( expression, o + 1, 0 ); // load argument
+			}
+			else if ( expression.context[o + 1].stackPosition != 0 )
+			{
+				expression.swapWithTop( expression.context[o + 1].stackPosition );
+			}
+
+			appendBytecode( expression.bytecode, expression.context[o].bytecode );  // apply operator
+			expression.context.remove( o, 1 ); // knock off operator
+			expression.pushToStack(o);
+			break;
+		}
+
+		case WR_OPER_BINARY_COMMUTE:
+		{
+			// for operations like + and * the operands can be in any
+			// order, so don't go to any great lengths to shift the stack
+			// around for them
+
+			ret = 2;
+
+			if( o == 0 )
+			{
+				m_err = WR_ERR_bad_expression;
+				return 0;
+			}
+
+			int second = o + 1; // push first
+			int first = o - 1;  // push second
+			// so
+			// 1 - first
+			// [oper]
+			// 0 - second
+
+			if ( expression.context[second].stackPosition == -1 )
+			{
+				if ( expression.context[first].stackPosition == -1 )
+				{
+					loadExpressionContext( expression, first, o ); 
+				}
+				else if ( expression.context[first].stackPosition != 0 )
+				{
+					// otherwise swap first to the top and load the second
+					expression.swapWithTop( expression.context[first].stackPosition );
+				}
+
+				loadExpressionContext( expression, second, o );
+			}
+			else if ( expression.context[first].stackPosition == -1 )
+			{
+				if ( expression.context[second].stackPosition != 0 )
+				{
+					expression.swapWithTop( expression.context[second].stackPosition );
+				}
+
+				// just load the second to top
+				loadExpressionContext( expression, first, o );
+			}
+			else if ( expression.context[second].stackPosition == 1 )
+			{
+				expression.swapWithTop( expression.context[first].stackPosition );
+			}
+			else if ( expression.context[first].stackPosition == 1 )
+			{
+				expression.swapWithTop( expression.context[second].stackPosition );
+			}
+			else
+			{
+				// first and second are both loaded but neither
+				// is in the correct position
+
+				expression.swapTwoToTop( first, second );
+			}
+
+			appendBytecode( expression.bytecode, expression.context[o].bytecode ); // apply operator
+
+			expression.context.remove( o - 1, 2 ); // knock off operator and arg
+			expression.pushToStack(o - 1);
+
+			break;
+		}
+
+		case WR_OPER_BINARY:
+		{
+			ret = 2;
+
+			if( o == 0 )
+			{
+				m_err = WR_ERR_bad_expression;
+				return 0;
+			}
+
+			int second = o + 1; // push first
+			int first = o - 1;  // push second
+			bool useAlt = false;
+			// so
+			// 1 - first
+			// [oper]
+			// 0 - second
+
+			if ( expression.context[second].stackPosition == -1 )
+			{
+				if ( expression.context[first].stackPosition == -1 )
+				{
+					loadExpressionContext( expression, second, o ); // nope, grab 'em
+					loadExpressionContext( expression, first, o ); 
+				}
+				else
+				{
+					// first is in the stack somewhere, we need
+					// to swap it to the top, then load, then
+					// swap top values
+					expression.swapWithTop( expression.context[first].stackPosition );
+
+					loadExpressionContext( expression, second, o );
+
+					if ( expression.context[o].operation->alt == O_LAST )
+					{
+						expression.swapWithTop( 1 );
+					}
+					else // otherwise top shuffle is NOT required because we have an equal-but-opposite operation
+					{
+						useAlt = true;
+					}
+				}
+			}
+			else if ( expression.context[first].stackPosition == -1 )
+			{
+				// perfect, swap up the second, then load the
+				// first
+
+				expression.swapWithTop( expression.context[second].stackPosition );
+
+				loadExpressionContext( expression, first, o );
+			}
+			else if ( expression.context[second].stackPosition == 1 )
+			{
+				// second is already where its supposed to be,
+				// swap first to top if it's not there already
+				if ( expression.context[first].stackPosition != 0 )
+				{
+					expression.swapWithTop( expression.context[first].stackPosition );
+				}
+			}
+			else if ( expression.context[second].stackPosition == 0 )
+			{
+				// second is on top of the stack, swap with
+				// next level down then swap first up
+
+
+				if ( expression.context[first].stackPosition == 1 )
+				{
+					// lucky! a simple single-swap will put them in the
+					// right order (turns out this is common)
+					expression.swapWithTop( 1 );
+				}
+				else
+				{
+					// can still do it in one opcode
+					
+					expression.swapTwoToTop( first, second );
+				}
+			}
+			else
+			{
+				// first and second are both loaded but neither is in the correct position
+
+				expression.swapTwoToTop( first, second );
+			}
+
+			if ( useAlt )
+			{
+				pushOpcode( expression.bytecode, expression.context[o].operation->alt );
+			}
+			else
+			{
+				appendBytecode( expression.bytecode, expression.context[o].bytecode ); // apply operator
+			}
+
+			expression.context.remove( o - 1, 2 ); // knock off operator and arg
+			expression.pushToStack(o - 1);
+
+			break;
+		}
+
+		case WR_OPER_POST:
+		{
+			ret = 1;
+
+			if( o == 0 )
 			{
-				loadExpressionContext( expression, o + 1, 0 ); // load argument
+				m_err = WR_ERR_bad_expression;
+				return 0;
 			}
-			else if ( expression.context[o + 1].stackPosition != 0 )
+
+			if ( expression.context[o - 1].stackPosition == -1 )
 			{
-				expression.swapWithTop( expression.context[o + 1].stackPosition );
+				loadExpressionContext( expression, o - 1, o ); // load argument
+			}
+			else if ( expression.context[o - 1].stackPosition != 0 )
+			{
+				expression.swapWithTop( expression.context[o - 1].stackPosition );
 			}
 
-			appendBytecode( expression.bytecode, expression.context[o].bytecode );  // apply operator
+			appendBytecode( expression.bytecode, expression.context[o].bytecode );
 			expression.context.remove( o, 1 ); // knock off operator
-			expression.pushToStack(o);
+			expression.pushToStack( o - 1 );
+
 			break;
 		}
+	}
+	
+	m_localsNoted = false;
 
-		case WR_OPER_BINARY_COMMUTE:
+	if ( m_optimize && ret )
+	{
+		expression.context[result].resultType = type;
+
+		if ( locals
+			 && (opcode == O_BinaryAddition
+				 || opcode == O_BinarySubtraction
+				 || opcode == O_BinaryMultiplication
+				 || opcode == O_BinaryDivision) )
 		{
-			// for operations like + and * the operands can be in any
-			// order, so don't go to any great lengths to shift the stack
-			// around for them
+			typedOperation( expression.bytecode, mark );
+		}
+	}
 
-			ret = 2;
+	return ret;
+}
 
-			if( o == 0 )
+//------------------------------------------------------------------------------
+bool WRCompilationContext::operatorFound( WRstr const& token, WRarray<WRExpressionContext>& context, int depth )
+{
+	for( int i=0; c_operations[i].token; i++ )
+	{
+		if ( token == c_operations[i].token )
+		{
+			if ( c_operations[i].type == WR_OPER_PRE
+				 && depth > 0
+				 && (context[depth-1].type != EXTYPE_OPERATION 
+					 || (context[depth - 1].type == EXTYPE_OPERATION &&
+						 (context[depth - 1].operation->type != WR_OPER_BINARY && context[depth - 1].operation->type != WR_OPER_BINARY_COMMUTE))) )
 			{
-				m_err = WR_ERR_bad_expression;
+				continue;
+			}
+			
+			context[depth].operation = c_operations + i;
+			context[depth].type = EXTYPE_OPERATION;
+
+			pushOpcode( context[depth].bytecode, c_operations[i].opcode );
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool WRCompilationContext::parseCallFunction( WRExpression& expression, WRstr functionName, int depth, bool parseArguments, bool construct )
+{
+	WRstr prefix = expression.context[depth].prefix;
+
+	expression.context[depth].type = EXTYPE_BYTECODE_RESULT;
+	
+	unsigned char argsPushed = 0;
+	bool argsAreLocals = true;
+	bool argsAreLiterals = true;
+	WRValue literalArgs[2];
+	literalArgs[0].init();
+	literalArgs[1].init();
+
+	if ( parseArguments )
+	{
+		WRstr& token2 = expression.context[depth].token;
+		WRValue& value2 = expression.context[depth].value;
+
+		for(;;)
+		{
+			if ( !getToken(expression.context[depth]) )
+			{
+				m_err = WR_ERR_unexpected_EOF;
 				return 0;
 			}
 
-			int second = o + 1; // push first
-			int first = o - 1;  // push second
-			// so
-			// 1 - first
-			// [oper]
-			// 0 - second
+			if ( !m_quoted && token2 == ")" )
+			{
+				break;
+			}
 
-			if ( expression.context[second].stackPosition == -1 )
+			++argsPushed;
+
+				WRExpression nex( expression.bytecode.localSpace, expression.bytecode.isStructSpace );
+				nex.allowFunctionNameHashLiteral = true;
+				nex.context[0].token = token2;
+				nex.context[0].value = value2;
+			m_loadedToken = token2;
+			m_loadedValue = value2;
+			m_loadedQuoted = m_quoted;
+			
+			char end = parseExpression( nex );
+
+			if ( nex.bytecode.opcodes.size() > 0 )
 			{
-				if ( expression.context[first].stackPosition == -1 )
-				{
-					loadExpressionContext( expression, first, o ); 
-				}
-				else if ( expression.context[first].stackPosition != 0 )
+				uint8_t op = nex.bytecode.opcodes[nex.bytecode.opcodes.size() - 1];
+				if ( op == O_Index
+					 || op == O_IndexSkipLoad
+					 || op == O_IndexLiteral8
+					 || op == O_IndexLiteral16
+					 || op == O_IndexLocalLiteral8
+					 || op == O_IndexGlobalLiteral8
+					 || op == O_IndexLocalLiteral16
+					 || op == O_IndexGlobalLiteral16
+					 || (op == O_Wide
+						 && nex.bytecode.all.size() >= 4
+						 && nex.bytecode.all[nex.bytecode.all.size() - 4] == O_Wide
+						 && nex.bytecode.all[nex.bytecode.all.size() - 3] == W_LLIndex) )
 				{
-					// otherwise swap first to the top and load the second
-					expression.swapWithTop( expression.context[first].stackPosition );
+					nex.bytecode.opcodes += O_Dereference;
+					nex.bytecode.all += O_Dereference;
 				}
+			}
+			
+			argsAreLocals = argsAreLocals
+							&& nex.bytecode.all.size() == 2
+							&& nex.bytecode.all[0] == O_LoadFromLocal;
+
+			argsAreLiterals = argsAreLiterals
+							  && m_optimize
+							  && argsPushed <= 2
+							  && literalValue( nex.bytecode, literalArgs[argsPushed - 1] );
+			
+			appendBytecode( expression.context[depth].bytecode, nex.bytecode );
 
-				loadExpressionContext( expression, second, o );
+			if ( end == ')' )
+			{
+				break;
 			}
-			else if ( expression.context[first].stackPosition == -1 )
+			else if ( end != ',' )
 			{
-				if ( expression.context[second].stackPosition != 0 )
-				{
-					expression.swapWithTop( expression.context[second].stackPosition );
-				}
+				m_err = WR_ERR_unexpected_token;
+				return 0;
+			}
+		}
+	}
 
-				// just load the second to top
-				loadExpressionContext( expression, first, o );
+	pushDebug( WRD_LineNumber, expression.context[depth].bytecode, getSourcePosition() );
+	pushDebug( WRD_FunctionCall, expression.context[depth].bytecode, WRD_ExternalFunction );
+
+	if ( prefix.size() )
+	{
+		prefix += "::";
+		prefix += functionName;
+
+		WR_LIB_CALLBACK pure;
+		if ( m_optimize
+			 && argsAreLiterals
+			 && argsPushed
+			 && (pure = wr_pureMathFunction(wr_hashStr(prefix))) )
+		{
+			// nothing but literals going into a function of only its
+			// arguments, so the answer is known now
+			WRValue stack[3];
+			stack[0] = literalArgs[0];
+			stack[1] = literalArgs[1];
+			stack[argsPushed].init();
+			pure( stack + argsPushed, argsPushed, 0 );
+
+			if ( stack[argsPushed].type == WR_INT || stack[argsPushed].type == WR_FLOAT )
+			{
+				expression.context[depth].type = EXTYPE_LITERAL;
+				expression.context[depth].value = stack[argsPushed];
+				expression.context[depth].bytecode.all.clear();
+				expression.context[depth].bytecode.invalidateOpcodeCache();
+				return true;
 			}
-			else if ( expression.context[second].stackPosition == 1 )
+		}
+
+		unsigned char buf[4];
+		wr_pack32( wr_hashStr(prefix), buf );
+
+		pushOpcode( expression.context[depth].bytecode, O_CallLibFunction );
+		pushData( expression.context[depth].bytecode, &argsPushed, 1 ); // arg #
+		pushData( expression.context[depth].bytecode, buf, 4 ); // hash id
+
+		// normal lib will copy down the result, otherwise
+		// ignore it, it will be AFTER args
+	}
+	else
+	{
+		// push the number of args
+		uint32_t hash = wr_hashStr( functionName );
+
+		// 'new' runs it against the table it makes, it has to be called
+		if ( m_inlineFunctions && !construct && inlineCallFunction(expression, depth, hash, argsPushed, argsAreLocals) )
+		{
+			return true;
+		}
+
+		unsigned int i=0;
+		for( ; i<expression.context[depth].bytecode.functionSpace.count(); ++i )
+		{
+			if ( expression.context[depth].bytecode.functionSpace[i].hash == hash )
 			{
-				expression.swapWithTop( expression.context[first].stackPosition );
+				break;
 			}
-			else if ( expression.context[first].stackPosition == 1 )
+		}
+
+		expression.context[depth].bytecode.functionSpace[i].references.append() = getBytecodePosition( expression.context[depth].bytecode );
+		expression.context[depth].bytecode.functionSpace[i].hash = hash;
+
+		static const uint32_t c_yieldHash = wr_hashStr("yield");
+		if ( hash == c_yieldHash )
+		{
+			pushOpcode( expression.context[depth].bytecode, O_Yield );
+			pushData( expression.context[depth].bytecode, &argsPushed, 1 );
+		}
+		else
+		{
+			pushOpcode( expression.context[depth].bytecode, O_FUNCTION_CALL_PLACEHOLDER );
+			pushData( expression.context[depth].bytecode, &argsPushed, 1 );
+			pushData( expression.context[depth].bytecode, "XXXX", 4 ); // TBD opcode plus index, OR hash if index was not found
+		}
+		
+		// hash will copydown result same as lib, unless
+		// copy/pop which case does nothing
+
+		// normal call does nothing special, to preserve
+		// the return value a call to copy-down must be
+		// inserted
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// how long the instruction at 'code' is when inlineCallFunction() can
+// move it into another frame, and the offsets of any locals it names
+// (0 for none). 'store' is set when the first local is overwritten
+// rather than assigned through. Anything else returns 0
+static int wr_inlineInstructionSize( const unsigned char* code, int* local1, int* local2, bool* store )
+{
+	*local1 = 0;
+	*local2 = 0;
+	*store = false;
+	
+	switch( code[0] )
+	{
+		case O_LiteralZero:
+		case O_AssignToHashTableAndPop:
+		case O_Remove:
+		case O_HashEntryExists:
+		case O_PopOne:
+		case O_Dereference:
+		case O_Index:
+		case O_IndexSkipLoad:
+		case O_CountOf:
+		case O_HashOf:
+		case O_BinaryRightShiftSkipLoad:
+		case O_BinaryLeftShiftSkipLoad:
+		case O_BinaryAndSkipLoad:
+		case O_BinaryOrSkipLoad:
+		case O_BinaryXORSkipLoad:
+		case O_BinaryModSkipLoad:
+		case O_BinaryMultiplication:
+		case O_BinarySubtraction:
+		case O_BinaryDivision:
+		case O_BinaryRightShift:
+		case O_BinaryLeftShift:
+		case O_BinaryMod:
+		case O_BinaryOr:
+		case O_BinaryXOR:
+		case O_BinaryAnd:
+		case O_BinaryAddition:
+		case O_BitwiseNOT:
+		case O_LogicalAnd:
+		case O_LogicalOr:
+		case O_CompareLE:
+		case O_CompareGE:
+		case O_CompareGT:
+		case O_CompareLT:
+		case O_CompareEQ:
+		case O_CompareNE:
+		case O_PostIncrement:
+		case O_PostDecrement:
+		case O_PreIncrement:
+		case O_PreDecrement:
+		case O_PreIncrementAndPop:
+		case O_PreDecrementAndPop:
+		case O_Assign:
+		case O_AssignAndPop:
+		case O_SubtractAssign:
+		case O_AddAssign:
+		case O_ModAssign:
+		case O_MultiplyAssign:
+		case O_DivideAssign:
+		case O_ORAssign:
+		case O_ANDAssign:
+		case O_XORAssign:
+		case O_RightShiftAssign:
+		case O_LeftShiftAssign:
+		case O_SubtractAssignAndPop:
+		case O_AddAssignAndPop:
+		case O_ModAssignAndPop:
+		case O_MultiplyAssignAndPop:
+		case O_DivideAssignAndPop:
+		case O_ORAssignAndPop:
+		case O_ANDAssignAndPop:
+		case O_XORAssignAndPop:
+		case O_RightShiftAssignAndPop:
+		case O_LeftShiftAssignAndPop:
+		case O_LogicalNot:
+		case O_Negate:
+		case O_ToInt:
+		case O_ToFloat:
+			return 1;
+
+		case O_LiteralInt8:
+		case O_IndexLiteral8:
+		case O_StackSwap:
+		case O_LoadFromGlobal:
+		case O_AssignToGlobalAndPop:
+		case O_IncGlobal:
+		case O_DecGlobal:
+		case O_BinaryAdditionAndStoreGlobal:
+		case O_BinarySubtractionAndStoreGlobal:
+		case O_BinaryMultiplicationAndStoreGlobal:
+		case O_BinaryDivisionAndStoreGlobal:
+		case O_GSCompareEQ:
+		case O_GSCompareNE:
+		case O_GSCompareGE:
+		case O_GSCompareLE:
+		case O_GSCompareGT:
+		case O_GSCompareLT:
+			return 2;
+
+		case O_AssignToLocalAndPop:
+		case O_IncLocal:
+		case O_DecLocal:
+		case O_BinaryAdditionAndStoreLocal:
+		case O_BinarySubtractionAndStoreLocal:
+		case O_BinaryMultiplicationAndStoreLocal:
+		case O_BinaryDivisionAndStoreLocal:
+			*store = true;
+		case O_LoadFromLocal:
+		case O_LSCompareEQ:
+		case O_LSCompareNE:
+		case O_LSCompareGE:
+		case O_LSCompareLE:
+		case O_LSCompareGT:
+		case O_LSCompareLT:
+			*local1 = 1;
+			return 2;
+
+		// 8-bit jumps keep the width of the 16-bit ones they replaced
+		case O_LiteralInt16:
+		case O_IndexLiteral16:
+		case O_RelativeJump:
+		case O_RelativeJump8:
+		case O_BZ:
+		case O_BZ8:
+		case O_CompareBEQ:
+		case O_CompareBNE:
+		case O_CompareBGE:
+		case O_CompareBLE:
+		case O_CompareBGT:
+		case O_CompareBLT:
+		case O_CompareBEQ8:
+		case O_CompareBNE8:
+		case O_CompareBGE8:
+		case O_CompareBLE8:
+		case O_CompareBGT8:
+		case O_CompareBLT8:
+		case O_BLA:
+		case O_BLA8:
+		case O_BLO:
+		case O_BLO8:
+		case O_LiteralInt8ToGlobal:
+		case O_IndexGlobalLiteral8:
+		case O_SwapTwoToTop:
+		case O_GGValues:
+		case O_GGCompareGT:
+		case O_GGCompareGE:
+		case O_GGCompareLT:
+		case O_GGCompareLE:
+		case O_GGCompareEQ:
+		case O_GGCompareNE:
+		case O_GGBinaryMultiplication:
+		case O_GGBinaryAddition:
+		case O_GGBinarySubtraction:
+		case O_GGBinaryDivision:
+			return 3;
+
+		case O_LiteralInt8ToLocal:
+			*store = true;
+		case O_IndexLocalLiteral8:
+		case O_LGValues:
+		case O_GLBinaryMultiplication:
+		case O_GLBinaryAddition:
+		case O_GLBinarySubtraction:
+		case O_GLBinaryDivision:
+			*local1 = 1;
+			return 3;
+
+		case O_GLValues:
+		case O_LGBinarySubtraction:
+		case O_LGBinaryDivision:
+			*local1 = 2;
+			return 3;
+
+		case O_LLValues:
+		case O_LLCompareGT:
+		case O_LLCompareGE:
+		case O_LLCompareLT:
+		case O_LLCompareLE:
+		case O_LLCompareEQ:
+		case O_LLCompareNE:
+		case O_LLBinaryMultiplication:
+		case O_LLBinaryAddition:
+		case O_LLBinarySubtraction:
+		case O_LLBinaryDivision:
+			*local1 = 1;
+			*local2 = 2;
+			return 3;
+
+		case O_LiteralInt16ToGlobal:
+		case O_IndexGlobalLiteral16:
+		case O_GSCompareEQBZ:
+		case O_GSCompareNEBZ:
+		case O_GSCompareGEBZ:
+		case O_GSCompareLEBZ:
+		case O_GSCompareGTBZ:
+		case O_GSCompareLTBZ:
+		case O_GSCompareEQBZ8:
+		case O_GSCompareNEBZ8:
+		case O_GSCompareGEBZ8:
+		case O_GSCompareLEBZ8:
+		case O_GSCompareGTBZ8:
+		case O_GSCompareLTBZ8:
+		case O_GlobalBZ:
+		case O_GlobalBZ8:
+			return 4;
+
+		case O_LiteralInt16ToLocal:
+			*store = true;
+		case O_IndexLocalLiteral16:
+		case O_LSCompareEQBZ:
+		case O_LSCompareNEBZ:
+		case O_LSCompareGEBZ:
+		case O_LSCompareLEBZ:
+		case O_LSCompareGTBZ:
+		case O_LSCompareLTBZ:
+		case O_LSCompareEQBZ8:
+		case O_LSCompareNEBZ8:
+		case O_LSCompareGEBZ8:
+		case O_LSCompareLEBZ8:
+		case O_LSCompareGTBZ8:
+		case O_LSCompareLTBZ8:
+		case O_LocalBZ:
+		case O_LocalBZ8:
+			*local1 = 1;
+			return 4;
+
+		case O_LiteralInt32:
+		case O_LiteralFloat:
+		case O_LoadLibConstant:
+		case O_StackIndexHash:
+		case O_GGCompareLTBZ:
+		case O_GGCompareLEBZ:
+		case O_GGCompareGTBZ:
+		case O_GGCompareGEBZ:
+		case O_GGCompareEQBZ:
+		case O_GGCompareNEBZ:
+		case O_GGCompareLTBZ8:
+		case O_GGCompareLEBZ8:
+		case O_GGCompareGTBZ8:
+		case O_GGCompareGEBZ8:
+		case O_GGCompareEQBZ8:
+		case O_GGCompareNEBZ8:
+			return 5;
+
+		case O_LLCompareLTBZ:
+		case O_LLCompareLEBZ:
+		case O_LLCompareGTBZ:
+		case O_LLCompareGEBZ:
+		case O_LLCompareEQBZ:
+		case O_LLCompareNEBZ:
+		case O_LLCompareLTBZ8:
+		case O_LLCompareLEBZ8:
+		case O_LLCompareGTBZ8:
+		case O_LLCompareGEBZ8:
+		case O_LLCompareEQBZ8:
+		case O_LLCompareNEBZ8:
+			*local1 = 1;
+			*local2 = 2;
+			return 5;
+
+		case O_LiteralInt32ToGlobal:
+		case O_LiteralFloatToGlobal:
+		case O_GlobalIndexHash:
+		case O_CallLibFunction:
+		case O_CallLibFunctionAndPop:
+			return 6;
+
+		case O_LiteralInt32ToLocal:
+		case O_LiteralFloatToLocal:
+			*store = true;
+		case O_LocalIndexHash:
+			*local1 = 1;
+			return 6;
+
+		case O_LiteralString:
+			return 3 + (int)(uint16_t)READ_16_FROM_PC(code + 1);
+
+		case O_Wide:
+		{
+			switch( code[1] )
 			{
-				expression.swapWithTop( expression.context[second].stackPosition );
+				case W_IncLocalLLCompareLT:
+					*store = true;
+					*local1 = 3;
+					*local2 = 2;
+					return 6;
+
+				case W_LLIndex:
+					*local1 = 2;
+					*local2 = 3;
+					return 4;
+
+				case W_LLIndexHashPair:
+					*local1 = 2;
+					*local2 = 7;
+					return 12;
+
+				default:
+					return 0;
 			}
-			else
-			{
-				// first and second are both loaded but neither
-				// is in the correct position
+		}
 
-				WRCompilationContext::pushOpcode( expression.bytecode, O_SwapTwoToTop );
-				unsigned char pos = expression.context[first].stackPosition + 1;
-				WRCompilationContext::pushData( expression.bytecode, &pos, 1 );
-				pos = expression.context[second].stackPosition + 1;
-				WRCompilationContext::pushData( expression.bytecode, &pos, 1 );
+		default:
+			return 0;
+	}
+}
 
-				expression.swapWithTop( expression.context[second].stackPosition, false );
-				expression.swapWithTop( 1, false );
-				expression.swapWithTop( expression.context[first].stackPosition, false );
-			}
+//------------------------------------------------------------------------------
+// the arguments have been pushed for a call to 'hash'; if it names a
+// small function that does nothing but work on its own frame, copy its
+// body in here with its locals moved into this frame instead of
+// making the call
+bool WRCompilationContext::inlineCallFunction( WRExpression& expression,
+											   int depth,
+											   uint32_t hash,
+											   unsigned char argsPushed,
+											   bool argsAreLocals )
+{
+	if ( m_unitTop == 0 || expression.bytecode.isStructSpace )
+	{
+		return false;
+	}
 
-			appendBytecode( expression.bytecode, expression.context[o].bytecode ); // apply operator
+	// same resolution link() will use
+	unsigned int u = 1;
+	for( ; u<m_units.count() && m_units[u].hash != hash; ++u );
 
-			expression.context.remove( o - 1, 2 ); // knock off operator and arg
-			expression.pushToStack(o - 1);
+	if ( u >= m_units.count() || (int)u == m_unitTop )
+	{
+		return false;
+	}
 
-			break;
-		}
+	WRUnitContext& callee = m_units[u];
+	const unsigned int locals = callee.bytecode.localSpace.count();
+	const unsigned int end = callee.bytecode.all.size() - 1;
+	
+	if ( localsAreMembers(u)
+		 || callee.bytecode.all.size() == 0
+		 || end > WRENCH_INLINE_MAX_BYTES
+		 || locals > 255
+		 || callee.bytecode.functionSpace.count()
+		 || callee.bytecode.unitObjectSpace.count()
+		 || callee.bytecode.gotoSource.count() )
+	{
+		return false;
+	}
 
-		case WR_OPER_BINARY:
-		{
-			ret = 2;
+	// everything must be movable, with the only return at the very
+	// end so the body can fall out the bottom
+	const unsigned char* code = callee.bytecode.all;
+	if ( code[end] != O_Return && code[end] != O_ReturnZero )
+	{
+		return false;
+	}
 
-			if( o == 0 )
-			{
-				m_err = WR_ERR_bad_expression;
-				return 0;
-			}
+	int local1;
+	int local2;
+	bool store;
+	bool paramStored = false;
+	unsigned int a = 0;
+	while( a < end )
+	{
+		int size = wr_inlineInstructionSize( code + a, &local1, &local2, &store );
+		if ( !size
+			 || a + size > end
+			 || (local1 && code[a + local1] >= locals)
+			 || (local2 && code[a + local2] >= locals) )
+		{
+			return false;
+		}
 
-			int second = o + 1; // push first
-			int first = o - 1;  // push second
-			bool useAlt = false;
-			// so
-			// 1 - first
-			// [oper]
-			// 0 - second
+		paramStored = paramStored || (store && code[a + local1] < callee.arguments);
+		a += size;
+	}
 
-			if ( expression.context[second].stackPosition == -1 )
-			{
-				if ( expression.context[first].stackPosition == -1 )
-				{
-					loadExpressionContext( expression, second, o ); // nope, grab 'em
-					loadExpressionContext( expression, first, o ); 
-				}
-				else
-				{
-					// first is in the stack somewhere, we need
-					// to swap it to the top, then load, then
-					// swap top values
-					expression.swapWithTop( expression.context[first].stackPosition );
+	WRBytecode& bytecode = expression.context[depth].bytecode;
 
-					loadExpressionContext( expression, second, o );
+	// arguments that are plain locals the callee only reads can be
+	// used where they are, the loads that pushed them go away
+	const bool alias = argsAreLocals
+					   && !paramStored
+					   && bytecode.all.size() == (unsigned int)argsPushed * 2;
 
-					if ( expression.context[o].operation->alt == O_LAST )
-					{
-						expression.swapWithTop( 1 );
-					}
-					else // otherwise top shuffle is NOT required because we have an equal-but-opposite operation
-					{
-						useAlt = true;
-					}
-				}
-			}
-			else if ( expression.context[first].stackPosition == -1 )
-			{
-				// perfect, swap up the second, then load the
-				// first
+	unsigned char slot[256];
+	unsigned int bound = (argsPushed < callee.arguments) ? argsPushed : callee.arguments;
+	unsigned int first = 0;
+	if ( alias )
+	{
+		for( ; first<bound; ++first )
+		{
+			slot[first] = bytecode.all[first*2 + 1];
+		}
+	}
 
-				expression.swapWithTop( expression.context[second].stackPosition );
+	// the rest live in slots this frame sets aside, shared by every
+	// inlined body since none of them can be running at once. Pick up
+	// anything the arguments declared first so the indexes line up
+	WRarray<WRNamespaceLookup>& space = expression.bytecode.localSpace;
+	for( unsigned int n=0; n<bytecode.localSpace.count(); ++n )
+	{
+		unsigned int m = 0;
+		for( ; m<space.count() && space[m].hash != bytecode.localSpace[n].hash; ++m );
+		if ( m >= space.count() )
+		{
+			WRNamespaceLookup& L = space.append();
+			L.hash = bytecode.localSpace[n].hash;
+			L.label = bytecode.localSpace[n].label;
+		}
+	}
 
-				loadExpressionContext( expression, first, o );
-			}
-			else if ( expression.context[second].stackPosition == 1 )
-			{
-				// second is already where its supposed to be,
-				// swap first to top if it's not there already
-				if ( expression.context[first].stackPosition != 0 )
-				{
-					expression.swapWithTop( expression.context[first].stackPosition );
-				}
-			}
-			else if ( expression.context[second].stackPosition == 0 )
-			{
-				// second is on top of the stack, swap with
-				// next level down then swap first up
+	WRstr label;
+	for( unsigned int l=first; l<locals; ++l )
+	{
+		label.format( "@inline%d", l );
+		uint32_t h = wr_hashStr( label );
 
+		unsigned int m = 0;
+		for( ; m<space.count() && space[m].hash != h; ++m );
+		if ( m > 255 )
+		{
+			return false;
+		}
+		
+		if ( m >= space.count() )
+		{
+			WRNamespaceLookup& L = space.append();
+			L.hash = h;
+			L.label = label;
+		}
+		
+		slot[l] = (unsigned char)m;
+	}
 
-				if ( expression.context[first].stackPosition == 1 )
-				{
-					// lucky! a simple single-swap will put them in the
-					// right order (turns out this is common)
-					expression.swapWithTop( 1 );
-				}
-				else
-				{
-					// can still do it in one opcode
-					
-					WRCompilationContext::pushOpcode( expression.bytecode, O_SwapTwoToTop );
-					unsigned char pos = expression.context[first].stackPosition + 1;
-					WRCompilationContext::pushData( expression.bytecode, &pos, 1 );
-					pos = 2;
-					WRCompilationContext::pushData( expression.bytecode, &pos, 1 );
-					
-					expression.swapWithTop( 1, false );
-					expression.swapWithTop( expression.context[first].stackPosition, false );
-				}
-			}
-			else
-			{
-				// first and second are both loaded but neither is in the correct position
+	unsigned char data[3];
+	if ( alias )
+	{
+		bytecode.all.shave( argsPushed * 2 );
+		bytecode.invalidateOpcodeCache();
+	}
+	else
+	{
+		for( ; argsPushed > callee.arguments; --argsPushed )
+		{
+			pushOpcode( bytecode, O_PopOne );
+		}
 
-				WRCompilationContext::pushOpcode( expression.bytecode, O_SwapTwoToTop );
-				unsigned char pos = expression.context[first].stackPosition + 1;
-				WRCompilationContext::pushData( expression.bytecode, &pos, 1 );
-				pos = expression.context[second].stackPosition + 1;
-				WRCompilationContext::pushData( expression.bytecode, &pos, 1 );
+		// exactly what the call would have left in its argument slots
+		for( int p=argsPushed - 1; p>=0; --p )
+		{
+			data[0] = W_PopToLocal;
+			wr_pack16( slot[p], data + 1 );
+			pushOpcode( bytecode, O_Wide );
+			pushData( bytecode, data, 3 );
+		}
+	}
 
-				expression.swapWithTop( expression.context[second].stackPosition, false );
-				expression.swapWithTop( 1, false );
-				expression.swapWithTop( expression.context[first].stackPosition, false );
-			}
+	// and the call would have started everything else at zero
+	for( unsigned int l=bound; l<locals; ++l )
+	{
+		data[0] = slot[l];
+		data[1] = 0;
+		pushOpcode( bytecode, O_LiteralInt8ToLocal );
+		pushData( bytecode, data, 2 );
+	}
 
-			if ( useAlt )
+	if ( end )
+	{
+		unsigned int base = bytecode.all.size();
+		bytecode.all.append( code, end );
+		for( a=0; a<end; )
+		{
+			int size = wr_inlineInstructionSize( code + a, &local1, &local2, &store );
+			if ( local1 )
 			{
-				pushOpcode( expression.bytecode, expression.context[o].operation->alt );
+				bytecode.all[base + a + local1] = slot[code[a + local1]];
 			}
-			else
+			if ( local2 )
 			{
-				appendBytecode( expression.bytecode, expression.context[o].bytecode ); // apply operator
+				bytecode.all[base + a + local2] = slot[code[a + local2]];
 			}
+			a += size;
+		}
 
-			expression.context.remove( o - 1, 2 ); // knock off operator and arg
-			expression.pushToStack(o - 1);
+		// opaque to the keyhole optimizer, same as a wide instruction.
+		// Any jumps inside are relative so they came along intact, and
+		// those aimed at the return now land on whatever replaces it
+		bytecode.opcodes += O_Wide;
+	}
 
-			break;
-		}
+	// the return value is copied out of the frame exactly as
+	// PushIndexFunctionReturnValue would; a dropped zero is
+	// optimized away entirely
+	pushOpcode( bytecode, (code[end] == O_Return) ? O_Dereference : O_LiteralZero );
 
-		case WR_OPER_POST:
-		{
-			ret = 1;
+	return true;
+}
 
-			if( o == 0 )
-			{
-				m_err = WR_ERR_bad_expression;
-				return 0;
-			}
+//------------------------------------------------------------------------------
+// how long the instruction at 'code' is anywhere in a unit before it
+// is linked, and the offsets of any 8-bit locals it names (0 for
+// none), or of a 16-bit one in 'wideLocal'. 0 for anything else
+static int wr_frameInstructionSize( const unsigned char* code, int* local1, int* local2, int* wideLocal )
+{
+	*wideLocal = 0;
 
-			if ( expression.context[o - 1].stackPosition == -1 )
-			{
-				loadExpressionContext( expression, o - 1, o ); // load argument
-			}
-			else if ( expression.context[o - 1].stackPosition != 0 )
-			{
-				expression.swapWithTop( expression.context[o - 1].stackPosition );
-			}
+	bool store;
+	const int size = wr_inlineInstructionSize( code, local1, local2, &store );
+	if ( size )
+	{
+		return size;
+	}
 
-			appendBytecode( expression.bytecode, expression.context[o].bytecode );
-			expression.context.remove( o, 1 ); // knock off operator
-			expression.pushToStack( o - 1 );
+	switch( code[0] )
+	{
+		case O_Return:
+		case O_ReturnZero:
+		case O_InitVar:
+		case O_InitArray:
+			return 1;
+
+		case O_Yield:
+		case O_AssignToObjectTableByOffset:
+			return 2;
+
+		case O_NewObjectTable:
+		case O_AssignToArrayAndPop:
+		case O_DebugInfo:
+		case O_GPushIterator:
+			return 3;
+
+		case O_LPushIterator:
+			*local1 = 1;
+			return 3;
+
+		case O_AssignToObjectTableByHash:
+		case O_GNextValueOrJump:
+			return 5;
+
+		case O_LNextValueOrJump:
+			*local1 = 1;
+			return 5;
+
+		case O_FUNCTION_CALL_PLACEHOLDER:
+		case O_GGNextKeyValueOrJump:
+			return 6;
+
+		case O_LGNextKeyValueOrJump:
+			*local1 = 1;
+			return 6;
+
+		case O_GLNextKeyValueOrJump:
+			*local1 = 2;
+			return 6;
+
+		case O_LLNextKeyValueOrJump:
+			*local1 = 1;
+			*local2 = 2;
+			return 6;
+
+		case O_Switch:
+			return 5 + 6*(int)(uint16_t)READ_16_FROM_PC(code + 1);
+
+		case O_SwitchLinear:
+			return 4 + 2*(int)code[1];
+
+		case O_Wide:
+		{
+			switch( code[1] )
+			{
+				case W_PopToLocal:
+					*wideLocal = 2;
+					return 4;
+
+				case W_IntLLAddition:
+				case W_IntLLSubtraction:
+				case W_IntLLMultiplication:
+				case W_FloatLLAddition:
+				case W_FloatLLSubtraction:
+				case W_FloatLLMultiplication:
+				case W_FloatLLDivision:
+					*local1 = 2;
+					*local2 = 3;
+					return 4;
+
+				case W_IntLLCompareLTBZ:
+				case W_IntLLCompareLEBZ:
+				case W_IntLLCompareGTBZ:
+				case W_IntLLCompareGEBZ:
+				case W_IntLLCompareEQBZ:
+				case W_IntLLCompareNEBZ:
+				case W_IntLCountLTBZ:
+					*local1 = 2;
+					*local2 = 3;
+					return 6;
+
+				case W_IntLICompareLTBZ:
+				case W_IntLICompareLEBZ:
+				case W_IntLICompareGTBZ:
+				case W_IntLICompareGEBZ:
+				case W_IntLICompareEQBZ:
+				case W_IntLICompareNEBZ:
+					*local1 = 2;
+					return 7;
+
+				case W_SwitchDense:
+					return 10 + 2*(int)(uint16_t)READ_16_FROM_PC(code + 6);
 
-			break;
+				default:
+					return 0;
+			}
 		}
+
+		default:
+			return 0;
 	}
-	
-	return ret;
 }
 
 //------------------------------------------------------------------------------
-bool WRCompilationContext::operatorFound( WRstr const& token, WRarray<WRExpressionContext>& context, int depth )
+// anything made from unit 'u' with 'new', or looked up by name, has
+// its locals for members
+bool WRCompilationContext::localsAreMembers( const unsigned int u )
 {
-	for( int i=0; c_operations[i].token; i++ )
+	WRUnitContext& unit = m_units[u];
+	if ( unit.bytecode.isStructSpace
+		 || unit.parentUnitIndex
+		 || unit.exportNamespace )
 	{
-		if ( token == c_operations[i].token )
+		return true;
+	}
+
+	for( unsigned int ux=0; ux<m_units.count(); ++ux )
+	{
+		for( unsigned int f=0; f<m_units[ux].bytecode.unitObjectSpace.count(); ++f )
 		{
-			if ( c_operations[i].type == WR_OPER_PRE
-				 && depth > 0
-				 && (context[depth-1].type != EXTYPE_OPERATION 
-					 || (context[depth - 1].type == EXTYPE_OPERATION &&
-						 (context[depth - 1].operation->type != WR_OPER_BINARY && context[depth - 1].operation->type != WR_OPER_BINARY_COMMUTE))) )
+			if ( m_units[ux].bytecode.unitObjectSpace[f].hash == unit.hash )
 			{
-				continue;
+				return true;
 			}
-			
-			context[depth].operation = c_operations + i;
-			context[depth].type = EXTYPE_OPERATION;
-
-			pushOpcode( context[depth].bytecode, c_operations[i].opcode );
-
-			return true;
 		}
 	}
 
 	return false;
 }
 
-bool WRCompilationContext::parseCallFunction( WRExpression& expression, WRstr functionName, int depth, bool parseArguments )
+//------------------------------------------------------------------------------
+// WR_OPTIMIZE gives locals that are never live at the same time the
+// same slot, so the frame every call sets up is smaller. A local is
+// live from the statement that first overwrites it, or from the top
+// of the unit if it could be read before that, to the last statement
+// that names it, and through to the end of any loop it is live going
+// into. Arguments, and anything that might hold a reference, keep a
+// slot to themselves.
+//
+// Every slot is still cleared on entry: the collector walks the whole
+// frame, so none can be left holding whatever the last call did
+void WRCompilationContext::packFrame( const unsigned int u )
 {
-	WRstr prefix = expression.context[depth].prefix;
+	WRUnitContext& unit = m_units[u];
+	WRarray<WRNamespaceLookup>& space = unit.bytecode.localSpace;
+	const unsigned int count = space.count();
+
+	if ( localsAreMembers(u)
+		 || unit.bytecode.gotoSource.count()
+		 || count > 255
+		 || count < unit.arguments + 2 )
+	{
+		return;
+	}
 
-	expression.context[depth].type = EXTYPE_BYTECODE_RESULT;
-	
-	unsigned char argsPushed = 0;
+	// every local the code names has to be found to be moved
+	const unsigned char* code = unit.bytecode.all;
+	const unsigned int size = unit.bytecode.all.size();
+	int local1;
+	int local2;
+	int wideLocal;
+	unsigned int a = 0;
+	while( a < size )
+	{
+		const int length = wr_frameInstructionSize( code + a, &local1, &local2, &wideLocal );
+		if ( !length )
+		{
+			return;
+		}
+		a += length;
+	}
 
-	if ( parseArguments )
+	if ( a != size )
 	{
-		WRstr& token2 = expression.context[depth].token;
-		WRValue& value2 = expression.context[depth].value;
+		return;
+	}
 
-		for(;;)
+	int lo[255];
+	int hi[255];
+	bool pinned[255];
+	for( unsigned int l=0; l<count; ++l )
+	{
+		unsigned int s = 0;
+		for( ; s<m_localSpans.count(); ++s )
 		{
-			if ( !getToken(expression.context[depth]) )
-			{
-				m_err = WR_ERR_unexpected_EOF;
-				return 0;
-			}
-
-			if ( !m_quoted && token2 == ")" )
+			if ( m_localSpans[s].hash == space[l].hash && m_localSpans[s].unit == (int)u )
 			{
 				break;
 			}
+		}
 
-			++argsPushed;
+		// anything it was first named by that did not just store to
+		// it could have read it
+		pinned[l] = l < unit.arguments || s >= m_localSpans.count() || m_localSpans[s].pinned;
+		if ( !pinned[l] )
+		{
+			LocalSpan& S = m_localSpans[s];
+			const bool stored = S.writes && S.writes == S.notes && S.writes == S.loads;
+			lo[l] = (stored && S.scoped) ? S.first : -1;
+			hi[l] = S.last;
+		}
+	}
 
-				WRExpression nex( expression.bytecode.localSpace, expression.bytecode.isStructSpace );
-				nex.allowFunctionNameHashLiteral = true;
-				nex.context[0].token = token2;
-				nex.context[0].value = value2;
-			m_loadedToken = token2;
-			m_loadedValue = value2;
-			m_loadedQuoted = m_quoted;
-			
-			char end = parseExpression( nex );
+	for( bool grew = true; grew; )
+	{
+		grew = false;
+		for( unsigned int p=0; p<m_loopSpans.count(); ++p )
+		{
+			LoopSpan& L = m_loopSpans[p];
+			for( unsigned int l=0; L.unit == (int)u && l<count; ++l )
+			{
+				if ( !pinned[l] && lo[l] < L.first && hi[l] >= L.first && hi[l] < L.last )
+				{
+					hi[l] = L.last;
+					grew = true;
+				}
+			}
+		}
+	}
 
-			if ( nex.bytecode.opcodes.size() > 0 )
+	// first fit, in the order they were declared
+	unsigned char slot[255];
+	bool shared[255];
+	unsigned int slots = 0;
+	for( unsigned int l=0; l<count; ++l )
+	{
+		unsigned int t = unit.arguments;
+		for( ; !pinned[l] && t<slots; ++t )
+		{
+			unsigned int m = 0;
+			for( ; shared[t] && m<l; ++m )
 			{
-				uint8_t op = nex.bytecode.opcodes[nex.bytecode.opcodes.size() - 1];
-				if ( op == O_Index
-					 || op == O_IndexSkipLoad
-					 || op == O_IndexLiteral8
-					 || op == O_IndexLiteral16
-					 || op == O_IndexLocalLiteral8
-					 || op == O_IndexGlobalLiteral8
-					 || op == O_IndexLocalLiteral16
-					 || op == O_IndexGlobalLiteral16 )
+				if ( slot[m] == t && lo[m] <= hi[l] && lo[l] <= hi[m] )
 				{
-					nex.bytecode.opcodes += O_Dereference;
-					nex.bytecode.all += O_Dereference;
+					break;
 				}
 			}
-			
-			appendBytecode( expression.context[depth].bytecode, nex.bytecode );
 
-			if ( end == ')' )
+			if ( shared[t] && m >= l )
 			{
 				break;
 			}
-			else if ( end != ',' )
+		}
+
+		if ( pinned[l] || t >= slots )
+		{
+			t = slots++;
+			shared[t] = !pinned[l];
+			if ( t != l )
 			{
-				m_err = WR_ERR_unexpected_token;
-				return 0;
+				space[t] = space[l]; // named for whichever local got it first
 			}
 		}
-	}
 
-	pushDebug( WRD_LineNumber, expression.context[depth].bytecode, getSourcePosition() );
-	pushDebug( WRD_FunctionCall, expression.context[depth].bytecode, WRD_ExternalFunction );
+		slot[l] = (unsigned char)t;
+	}
 
-	if ( prefix.size() )
+	if ( slots == count )
 	{
-		prefix += "::";
-		prefix += functionName;
-
-		unsigned char buf[4];
-		wr_pack32( wr_hashStr(prefix), buf );
-
-		pushOpcode( expression.context[depth].bytecode, O_CallLibFunction );
-		pushData( expression.context[depth].bytecode, &argsPushed, 1 ); // arg #
-		pushData( expression.context[depth].bytecode, buf, 4 ); // hash id
-
-		// normal lib will copy down the result, otherwise
-		// ignore it, it will be AFTER args
+		return;
 	}
-	else
-	{
-		// push the number of args
-		uint32_t hash = wr_hashStr( functionName );
 
-		unsigned int i=0;
-		for( ; i<expression.context[depth].bytecode.functionSpace.count(); ++i )
+	for( a=0; a<size; )
+	{
+		const int length = wr_frameInstructionSize( code + a, &local1, &local2, &wideLocal );
+		if ( local1 )
 		{
-			if ( expression.context[depth].bytecode.functionSpace[i].hash == hash )
-			{
-				break;
-			}
+			unit.bytecode.all[a + local1] = slot[code[a + local1]];
 		}
-
-		expression.context[depth].bytecode.functionSpace[i].references.append() = getBytecodePosition( expression.context[depth].bytecode );
-		expression.context[depth].bytecode.functionSpace[i].hash = hash;
-
-		static const uint32_t c_yieldHash = wr_hashStr("yield");
-		if ( hash == c_yieldHash )
+		if ( local2 )
 		{
-			pushOpcode( expression.context[depth].bytecode, O_Yield );
-			pushData( expression.context[depth].bytecode, &argsPushed, 1 );
+			unit.bytecode.all[a + local2] = slot[code[a + local2]];
 		}
-		else
+		if ( wideLocal )
 		{
-			pushOpcode( expression.context[depth].bytecode, O_FUNCTION_CALL_PLACEHOLDER );
-			pushData( expression.context[depth].bytecode, &argsPushed, 1 );
-			pushData( expression.context[depth].bytecode, "XXXX", 4 ); // TBD opcode plus index, OR hash if index was not found
+			wr_pack16( slot[READ_16_FROM_PC(code + a + wideLocal)], unit.bytecode.all.p_str(a + wideLocal) );
 		}
-		
-		// hash will copydown result same as lib, unless
-		// copy/pop which case does nothing
-
-		// normal call does nothing special, to preserve
-		// the return value a call to copy-down must be
-		// inserted
+		a += length;
 	}
 
-	return true;
+	space.setCount( slots );
 }
 
 //------------------------------------------------------------------------------
@@ -1899,6 +4260,11 @@ bool WRCompilationContext::parseUnit( bool isStruct, int parentUnitIndex )
 							   true,
 							   true );
 
+			if ( m_optimize )
+			{
+				noteLocal( wr_hashStr(token), LOCAL_OTHER ); // whatever the caller passed
+			}
+
 			if ( !getToken(ex) )
 			{
 				m_err = WR_ERR_unexpected_EOF;
@@ -1929,8 +4295,16 @@ bool WRCompilationContext::parseUnit( bool isStruct, int parentUnitIndex )
 		return false;
 	}
 		
+	bool straightLine = m_straightLine;
+	bool unconditional = m_unconditional;
+	m_straightLine = true;
+	m_unconditional = true;
+	
 	parseStatement( m_unitTop, '}', O_Return );
 
+	m_straightLine = straightLine;
+	m_unconditional = unconditional;
+
 	if ( !m_units[m_unitTop].bytecode.opcodes.size()
 		 || (m_units[m_unitTop].bytecode.opcodes[m_units[m_unitTop].bytecode.opcodes.size() - 1] != O_Return
 			 && m_units[m_unitTop].bytecode.opcodes[m_units[m_unitTop].bytecode.opcodes.size() - 1] != O_ReturnZero) )
@@ -1962,9 +4336,15 @@ bool WRCompilationContext::parseWhile( WROpcode opcodeToReturn )
 		return false;
 	}
 
+	const int loopStart = m_statement;
+
+	WRBytecode hoisted;
+	openLoop( loopStart, hoisted );
+
 	WRExpression nex( m_units[m_unitTop].bytecode.localSpace, m_units[m_unitTop].bytecode.isStructSpace );
 	nex.context[0].token = token;
 	nex.context[0].value = value;
+	nex.valueOnly = true;
 	m_loadedToken = token;
 	m_loadedValue = value;
 	m_loadedQuoted = m_quoted;
@@ -1975,23 +4355,53 @@ bool WRCompilationContext::parseWhile( WROpcode opcodeToReturn )
 		return false;
 	}
 
+	// a literal condition either never needs testing or means the
+	// loop never runs at all
+	WRValue condition;
+	const bool known = m_optimize && literalValue(nex.bytecode, condition) && condition.type == WR_INT;
+	unsigned int mark = 0;
+	unsigned int targets = 0;
+	if ( known && !condition.i )
+	{
+		m_units[m_unitTop].bytecode.invalidateOpcodeCache();
+		mark = m_units[m_unitTop].bytecode.all.size();
+		targets = m_units[m_unitTop].bytecode.jumpOffsetTargets.count();
+	}
+
+	enterLoop();
+
 	*m_continueTargets.push() = addRelativeJumpTarget( m_units[m_unitTop].bytecode );
 	setRelativeJumpTarget(m_units[m_unitTop].bytecode, *m_continueTargets.tail() );
 
-	appendBytecode( m_units[m_unitTop].bytecode, nex.bytecode );
-
 	*m_breakTargets.push() = addRelativeJumpTarget( m_units[m_unitTop].bytecode );
 
-	addRelativeJumpSource( m_units[m_unitTop].bytecode, O_BZ, *m_breakTargets.tail() );
+	if ( !known )
+	{
+		appendBytecode( m_units[m_unitTop].bytecode, nex.bytecode );
+		addRelativeJumpSource( m_units[m_unitTop].bytecode, O_BZ, *m_breakTargets.tail() );
+	}
+	else if ( !condition.i )
+	{
+		addRelativeJumpSource( m_units[m_unitTop].bytecode, O_RelativeJump, *m_breakTargets.tail() );
+	}
 
 	if ( !parseStatement(m_unitTop, ';', opcodeToReturn) )
 	{
 		return false;
 	}
+
+	addLoopSpan( loopStart );
 	
 	addRelativeJumpSource( m_units[m_unitTop].bytecode, O_RelativeJump, *m_continueTargets.tail() );
+	closeLoop( *m_continueTargets.tail() );
 	setRelativeJumpTarget( m_units[m_unitTop].bytecode, *m_breakTargets.tail() );
 
+	if ( known && !condition.i )
+	{
+		discardBytecode( m_units[m_unitTop].bytecode, mark, targets );
+		setRelativeJumpTarget( m_units[m_unitTop].bytecode, *m_breakTargets.tail() );
+	}
+
 	m_continueTargets.pop();
 	m_breakTargets.pop();
 	
@@ -2008,6 +4418,8 @@ bool WRCompilationContext::parseDoWhile( WROpcode opcodeToReturn )
 
 	int jumpToTop = addRelativeJumpTarget( m_units[m_unitTop].bytecode );
 	setRelativeJumpTarget( m_units[m_unitTop].bytecode, jumpToTop );
+
+	const int loopStart = m_statement;
 	
 	if ( !parseStatement(m_unitTop, ';', opcodeToReturn) )
 	{
@@ -2038,9 +4450,14 @@ bool WRCompilationContext::parseDoWhile( WROpcode opcodeToReturn )
 		return false;
 	}
 
+	// a break can skip the condition, so it gets a block of its own
+	++m_statement;
+	const int block = openBlock();
+
 	WRExpression nex( m_units[m_unitTop].bytecode.localSpace, m_units[m_unitTop].bytecode.isStructSpace );
 	nex.context[0].token = token;
 	nex.context[0].value = value;
+	nex.valueOnly = true;
 	//m_loadedToken = token;
 	//m_loadedValue = value;
 
@@ -2050,6 +4467,9 @@ bool WRCompilationContext::parseDoWhile( WROpcode opcodeToReturn )
 		return false;
 	}
 
+	m_block = block;
+	addLoopSpan( loopStart );
+
 	if (!getToken(ex, ";"))
 	{
 		m_err = WR_ERR_unexpected_token;
@@ -2118,11 +4538,15 @@ A:
 */
 
 	bool foreachPossible = true;
+	bool fuseBack = false;
+	int body = -1;
+	unsigned char back[3] = { 0, 0, 0 };
 	bool foreachKV = false;
 	bool foreachV = false;
+	bool foreachWide = false;
 	int foreachLoadI = 0;
-	unsigned char foreachLoad[4];
-	unsigned char g = 0;
+	unsigned int foreachLoad[4];
+	unsigned int g = 0;
 
 	m_parsingFor = true;
 
@@ -2143,6 +4567,7 @@ A:
 		WRExpression nex( m_units[m_unitTop].bytecode.localSpace, m_units[m_unitTop].bytecode.isStructSpace );
 		nex.context[0].token = token;
 		nex.context[0].value = value;
+		nex.valueOnly = true;
 		m_loadedToken = token;
 		m_loadedValue = value;
 		m_loadedQuoted = m_quoted;
@@ -2153,20 +4578,9 @@ A:
 		{
 			if ( foreachLoadI < 3 )
 			{
-				if (nex.bytecode.opcodes.size() == 1
-					  && nex.bytecode.all.size() == 2
-					  && ((nex.bytecode.all[0] == O_LoadFromLocal) || (nex.bytecode.all[0] == O_LoadFromGlobal)) )
-				{
-					foreachLoad[foreachLoadI++] = nex.bytecode.all[0];
-					foreachLoad[foreachLoadI++] = nex.bytecode.all[1];
-				}
-				else if ( nex.bytecode.opcodes.size() == 2
-						  && nex.bytecode.all.size() == 5
-						  && nex.bytecode.all[0] == O_DebugInfo
-						  && ((nex.bytecode.all[3] == O_LoadFromLocal) || (nex.bytecode.all[3] == O_LoadFromGlobal)) )
+				if ( singleLoad(nex.bytecode, foreachLoad + foreachLoadI) )
 				{
-					foreachLoad[foreachLoadI++] = nex.bytecode.all[3];
-					foreachLoad[foreachLoadI++] = nex.bytecode.all[4];
+					foreachLoadI += 2;
 				}
 				else
 				{
@@ -2190,33 +4604,57 @@ A:
 		}
 		else if ( end == ':' )
 		{
+			// the loop writes whatever it finds into the names it was
+			// given, as references, so they keep slots to themselves
+			for( int f=0; f<foreachLoadI && tracksLocals(nex); f += 2 )
+			{
+				if ( foreachLoad[f] == O_LoadFromLocal && foreachLoad[f+1] < m_units[m_unitTop].bytecode.localSpace.count() )
+				{
+					noteLocal( m_units[m_unitTop].bytecode.localSpace[foreachLoad[f+1]].hash, LOCAL_OTHER );
+					localSpan( m_units[m_unitTop].bytecode.localSpace[foreachLoad[f+1]].hash ).pinned = true;
+				}
+			}
+
 			if ( foreachPossible )
 			{
 				WRExpression nex2( m_units[m_unitTop].bytecode.localSpace, m_units[m_unitTop].bytecode.isStructSpace );
 				nex2.context[0].token = token;
 				nex2.context[0].value = value;
 				end = parseExpression( nex2 );
-				if ( end == ')'
-					 && nex2.bytecode.opcodes.size() == 1
-					 && nex2.bytecode.all.size() == 2 )
+				unsigned int from[2];
+				if ( end == ')' && singleLoad(nex2.bytecode, from) )
 				{
 
 					WRstr T;
 					T.format( "foreach:%d", m_foreachHash++ );
-					g = (unsigned char)(addGlobalSpaceLoad(m_units[0].bytecode, T, true, true)); // #25 force "var seen" true since we are runtime adding the temporary ourselves
+					g = addGlobalSpaceLoad(m_units[0].bytecode, T, true, true); // #25 force "var seen" true since we are runtime adding the temporary ourselves
 
-					if ( nex2.bytecode.opcodes[0] == O_LoadFromLocal )
+					foreachWide = from[1] > 255 || g > 255 || foreachLoad[1] > 255 || (foreachLoadI == 4 && foreachLoad[3] > 255);
+					if ( foreachWide )
 					{
-						m_units[m_unitTop].bytecode.all += O_LPushIterator;
+						unsigned char data[6];
+						data[0] = W_PushIterator;
+						data[1] = (from[0] == O_LoadFromLocal) ? 1 : 0;
+						wr_pack16( from[1], data + 2 );
+						wr_pack16( g, data + 4 );
+						pushOpcode( m_units[m_unitTop].bytecode, O_Wide );
+						pushData( m_units[m_unitTop].bytecode, data, 6 );
 					}
 					else
 					{
-						m_units[m_unitTop].bytecode.all += O_GPushIterator;
+						if ( from[0] == O_LoadFromLocal )
+						{
+							m_units[m_unitTop].bytecode.all += O_LPushIterator;
+						}
+						else
+						{
+							m_units[m_unitTop].bytecode.all += O_GPushIterator;
+						}
+
+						m_units[m_unitTop].bytecode.all += (unsigned char)from[1];
+						m_units[m_unitTop].bytecode.all += (unsigned char)g;
 					}
 
-					m_units[m_unitTop].bytecode.all += nex2.bytecode.all[1];
-					pushData( m_units[m_unitTop].bytecode, &g, 1 );
-
 					if ( foreachLoadI == 4 )
 					{
 						foreachKV = true;
@@ -2252,54 +4690,85 @@ A:
 		}
 	}
 
+	const int loopStart = ++m_statement;
+
+	// a foreach loop has nothing of its own to move out
+	WRBytecode hoisted;
+	const bool hoistable = !foreachV && !foreachKV;
+	if ( hoistable )
+	{
+		openLoop( loopStart, hoisted );
+		enterLoop();
+	}
+
 	// <- condition point
 	int conditionPoint = addRelativeJumpTarget( m_units[m_unitTop].bytecode );
 
 	setRelativeJumpTarget( m_units[m_unitTop].bytecode, conditionPoint );
 	
-	if ( foreachV || foreachKV )
+	if ( foreachWide )
 	{
-		if ( foreachV )
+		// [W_Next...][shape][(key) value iterator] rel16
+		unsigned char data[8];
+		int size = 0;
+		data[size++] = foreachKV ? W_NextKeyValueOrJump : W_NextValueOrJump;
+		data[size++] = ((foreachLoad[0] == O_LoadFromLocal) ? 1 : 0)
+					   | ((foreachKV && foreachLoad[2] == O_LoadFromLocal) ? 2 : 0);
+		wr_pack16( foreachLoad[1], data + size );
+		size += 2;
+		if ( foreachKV )
 		{
-			unsigned char load[2] = { foreachLoad[1], g };
+			wr_pack16( foreachLoad[3], data + size );
+			size += 2;
+		}
+		wr_pack16( g, data + size );
+		size += 2;
 
-			if ( foreachLoad[0] == O_LoadFromLocal )
+		addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_Wide, *m_breakTargets.tail(), data, size );
+	}
+	else if ( foreachV )
+	{
+		unsigned char load[2] = { (unsigned char)foreachLoad[1], (unsigned char)g };
+
+		if ( foreachLoad[0] == O_LoadFromLocal )
+		{
+			addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_LNextValueOrJump, *m_breakTargets.tail(), load, 2 );
+		}
+		else
+		{
+			addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_GNextValueOrJump, *m_breakTargets.tail(), load, 2 );
+		}
+	}
+	else if ( foreachKV )
+	{
+		unsigned char load[3] = { (unsigned char)foreachLoad[1], (unsigned char)foreachLoad[3], (unsigned char)g };
+		
+		if ( foreachLoad[0] == O_LoadFromLocal )
+		{
+			if ( foreachLoad[2] == O_LoadFromLocal )
 			{
-				addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_LNextValueOrJump, *m_breakTargets.tail(), load, 2 );
+				addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_LLNextKeyValueOrJump, *m_breakTargets.tail(), load, 3 );
 			}
 			else
 			{
-				addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_GNextValueOrJump, *m_breakTargets.tail(), load, 2 );
+				addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_LGNextKeyValueOrJump, *m_breakTargets.tail(), load, 3 );
 			}
 		}
 		else
 		{
-			unsigned char load[3] = { foreachLoad[1], foreachLoad[3], g };
-			
-			if ( foreachLoad[0] == O_LoadFromLocal )
+			if ( foreachLoad[2] == O_LoadFromLocal )
 			{
-				if ( foreachLoad[2] == O_LoadFromLocal )
-				{
-					addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_LLNextKeyValueOrJump, *m_breakTargets.tail(), load, 3 );
-				}
-				else
-				{
-					addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_LGNextKeyValueOrJump, *m_breakTargets.tail(), load, 3 );
-				}
+				addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_GLNextKeyValueOrJump, *m_breakTargets.tail(), load, 3 );
 			}
 			else
 			{
-				if ( foreachLoad[2] == O_LoadFromLocal )
-				{
-					addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_GLNextKeyValueOrJump, *m_breakTargets.tail(), load, 3 );
-				}
-				else
-				{
-					addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_GGNextKeyValueOrJump, *m_breakTargets.tail(), load, 3 );
-				}
+				addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_GGNextKeyValueOrJump, *m_breakTargets.tail(), load, 3 );
 			}
 		}
-		
+	}
+
+	if ( foreachV || foreachKV )
+	{
 		m_parsingFor = false;
 
 		// [ code ]
@@ -2317,11 +4786,14 @@ A:
 		}
 
 		// [ condition ]
+		int conditionStart = -1;
+		int conditionSize = 0;
 		if ( token != ";" )
 		{
 			WRExpression nex( m_units[m_unitTop].bytecode.localSpace, m_units[m_unitTop].bytecode.isStructSpace );
 			nex.context[0].token = token;
 			nex.context[0].value = value;
+			nex.valueOnly = true;
 			m_loadedToken = token;
 			m_loadedValue = value;
 			m_loadedQuoted = m_quoted;
@@ -2332,16 +4804,49 @@ A:
 				return false;
 			}
 
+			conditionStart = m_units[m_unitTop].bytecode.all.size();
 			appendBytecode( m_units[m_unitTop].bytecode, nex.bytecode );
 
 			// -> false jump break
 			addRelativeJumpSource( m_units[m_unitTop].bytecode, O_BZ, *m_breakTargets.tail() );
+			conditionSize = m_units[m_unitTop].bytecode.all.size() - conditionStart;
+		}
+
+		// 'i < n' can be tested again by the instruction that
+		// increments 'i', which then jumps straight to the body
+		int backLocals = 0;
+		const unsigned char* condition = m_units[m_unitTop].bytecode.all.p_str( (conditionStart == -1) ? 0 : conditionStart );
+		if ( conditionStart == -1
+			 || m_units[m_unitTop].bytecode.jumpOffsetTargets[conditionPoint].offset != conditionStart
+			 || (m_optimize && hoistable && m_loops.tail()->entry != -1) )
+		{
+			// nothing to fuse with, or the hoisted code follows the
+			// jump back and must not be fallen into
+		}
+		else if ( conditionSize == 5 && condition[0] == O_LLCompareLTBZ )
+		{
+			backLocals = 1;
+		}
+		else if ( conditionSize == 6 && condition[0] == O_Wide && condition[1] == W_IntLLCompareLTBZ )
+		{
+			backLocals = 2;
+		}
+
+		if ( backLocals )
+		{
+			back[0] = W_IncLocalLLCompareLT;
+			back[1] = condition[backLocals];
+			back[2] = condition[backLocals + 1];
+			body = addRelativeJumpTarget( m_units[m_unitTop].bytecode );
+			setRelativeJumpTarget( m_units[m_unitTop].bytecode, body );
 		}
 
 
 		WRExpression post( m_units[m_unitTop].bytecode.localSpace, m_units[m_unitTop].bytecode.isStructSpace );
 
-		// [ post code ]
+		// [ post code ] might never run, so it gets a block of its own
+		++m_statement;
+		const int block = openBlock();
 		for(;;)
 		{
 			if ( !getToken(ex) )
@@ -2358,6 +4863,7 @@ A:
 			WRExpression nex( m_units[m_unitTop].bytecode.localSpace, m_units[m_unitTop].bytecode.isStructSpace );
 			nex.context[0].token = token;
 			nex.context[0].value = value;
+			nex.valueOnly = true;
 			m_loadedToken = token;
 			m_loadedValue = value;
 			m_loadedQuoted = m_quoted;
@@ -2378,6 +4884,7 @@ A:
 			}
 		}
 
+		m_block = block;
 		m_parsingFor = false;
 
 		// [ code ]
@@ -2390,10 +4897,34 @@ A:
 		setRelativeJumpTarget( m_units[m_unitTop].bytecode, *m_continueTargets.tail() );
 
 		// [post code]
-		appendBytecode( m_units[m_unitTop].bytecode, post.bytecode );
+		if ( body != -1
+			 && post.bytecode.all.size() == 2
+			 && post.bytecode.all[0] == O_IncLocal
+			 && (unsigned char)post.bytecode.all[1] == back[2] )
+		{
+			fuseBack = true;
+		}
+		else
+		{
+			appendBytecode( m_units[m_unitTop].bytecode, post.bytecode );
+		}
 	}
 
-	addRelativeJumpSource( m_units[m_unitTop].bytecode, O_RelativeJump, conditionPoint );
+	addLoopSpan( loopStart );
+
+	if ( fuseBack )
+	{
+		// -> [++i, i < n jump body]
+		addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_Wide, body, back, 3 );
+	}
+	else
+	{
+		addRelativeJumpSource( m_units[m_unitTop].bytecode, O_RelativeJump, conditionPoint );
+	}
+	if ( hoistable )
+	{
+		closeLoop( conditionPoint );
+	}
 	setRelativeJumpTarget( m_units[m_unitTop].bytecode, *m_breakTargets.tail() );
 
 	m_continueTargets.pop();
@@ -2598,6 +5129,24 @@ uint32_t WRCompilationContext::getSingleValueHash( const char* end )
 		return getSingleValueHash( ")" );
 	}
 
+	if ( !m_quoted && token == "-" ) // negative literal
+	{
+		getToken( ex );
+		if ( value.type == WR_INT )
+		{
+			value.i = -value.i;
+		}
+		else if ( value.type == WR_FLOAT )
+		{
+			value.f = -value.f;
+		}
+		else
+		{
+			m_err = WR_ERR_switch_bad_case_hash;
+			return 0;
+		}
+	}
+
 	if ( value.type == WR_REF )
 	{
 		m_err = WR_ERR_switch_bad_case_hash;
@@ -2630,6 +5179,18 @@ pc> 16-bit default location
     break target:
 
 
+continue target:
+O_Wide W_SwitchDense
+    32-bit lowest case
+    16-bit count
+pc> 16-bit default location
+    16 bit case offset (case lowest + n)
+    ...
+    cases...
+    [cases]
+    break target:
+
+
 continue target:
 switch ins
 16-bit mod
@@ -2798,6 +5359,12 @@ bool WRCompilationContext::parseSwitch( WROpcode opcodeToReturn )
 
 	// find the highest hash value, and size an array to that
 	unsigned int size = 0;
+
+	// and the span of the cases read as signed ints, so a run like
+	// 1000..1063 or -8..8 can still get a direct table
+	int32_t low = 0;
+	int32_t high = 0;
+	unsigned int labels = 0;
 	for( unsigned int d=0; d<cases.count(); ++d )
 	{
 		if ( cases[d].defaultCase )
@@ -2807,15 +5374,28 @@ bool WRCompilationContext::parseSwitch( WROpcode opcodeToReturn )
 
 		if ( cases[d].hash > size )
 		{
-			size = cases[d].hash;
+			size = cases[d].hash < 254 ? cases[d].hash : 254;
 		}
 
-		if ( size >= 254 )
+		if ( !labels++ )
 		{
-			break;
+			low = high = (int32_t)cases[d].hash;
+		}
+		else if ( (int32_t)cases[d].hash < low )
+		{
+			low = (int32_t)cases[d].hash;
+		}
+		else if ( (int32_t)cases[d].hash > high )
+		{
+			high = (int32_t)cases[d].hash;
 		}
 	}
 
+	// a dense table is two bytes a slot against six for a hashed
+	// bucket, so it is never larger as long as a third are used
+	int64_t span = (int64_t)high - (int64_t)low + 1;
+	bool dense = (span < 0x7FFF) && (span <= (int64_t)labels*3);
+
 	// first try the easy way
 
 	++size;
@@ -2871,6 +5451,47 @@ bool WRCompilationContext::parseSwitch( WROpcode opcodeToReturn )
 			}
 		}
 	}
+	else if ( dense ) // cases are a tight run somewhere else, rebase them to 0
+	{
+		size = (unsigned int)span;
+
+		packbuf[0] = W_SwitchDense;
+		pushOpcode( m_units[m_unitTop].bytecode, O_Wide );
+		pushData( m_units[m_unitTop].bytecode, packbuf, 1 );
+		pushData( m_units[m_unitTop].bytecode, wr_pack32(low, packbuf), 4 );
+		pushData( m_units[m_unitTop].bytecode, wr_pack16(size, packbuf), 2 );
+
+		int currentPos = m_units[m_unitTop].bytecode.all.size();
+
+		if ( defaultOffset == -1 )
+		{
+			defaultOffset = size*2 + 2;
+		}
+		else
+		{
+			defaultOffset -= currentPos;
+		}
+
+		table = (WRSwitchCase *)g_malloc(size * sizeof(WRSwitchCase));
+		memset( table, 0, size*sizeof(WRSwitchCase) );
+
+		for( unsigned int c=0; c<cases.count(); ++c )
+		{
+			if ( cases[c].occupied && !cases[c].defaultCase )
+			{
+				uint32_t slot = cases[c].hash - (uint32_t)low;
+				table[slot].jumpOffset = cases[c].jumpOffset - currentPos;
+				table[slot].occupied = true;
+			}
+		}
+
+		pushData( m_units[m_unitTop].bytecode, wr_pack16(defaultOffset, packbuf), 2 );
+
+		for( unsigned int i=0; i<size; ++i )
+		{
+			pushData( m_units[m_unitTop].bytecode, wr_pack16(table[i].occupied ? table[i].jumpOffset : defaultOffset, packbuf), 2 );
+		}
+	}
 	else
 	{
 		pushOpcode( m_units[m_unitTop].bytecode, O_Switch ); // add switch command
@@ -2979,6 +5600,7 @@ bool WRCompilationContext::parseIf( WROpcode opcodeToReturn )
 	WRExpression nex( m_units[m_unitTop].bytecode.localSpace, m_units[m_unitTop].bytecode.isStructSpace );
 	nex.context[0].token = token;
 	nex.context[0].value = value;
+	nex.valueOnly = true;
 	m_loadedToken = token;
 	m_loadedValue = value;
 	m_loadedQuoted = m_quoted;
@@ -2989,23 +5611,59 @@ bool WRCompilationContext::parseIf( WROpcode opcodeToReturn )
 		return false;
 	}
 
-	appendBytecode( m_units[m_unitTop].bytecode, nex.bytecode );
+	// when the condition is a literal the side that can never run is
+	// still parsed, then thrown away
+	WRValue condition;
+	const bool known = m_optimize && literalValue(nex.bytecode, condition) && condition.type == WR_INT;
+	unsigned int mark = 0;
+	unsigned int targets = 0;
 
 	int conditionFalseMarker = addRelativeJumpTarget( m_units[m_unitTop].bytecode );
-	
-	addRelativeJumpSource( m_units[m_unitTop].bytecode, O_BZ, conditionFalseMarker );
+
+	if ( !known )
+	{
+		appendBytecode( m_units[m_unitTop].bytecode, nex.bytecode );
+		addRelativeJumpSource( m_units[m_unitTop].bytecode, O_BZ, conditionFalseMarker );
+	}
+	else if ( !condition.i )
+	{
+		m_units[m_unitTop].bytecode.invalidateOpcodeCache();
+		mark = m_units[m_unitTop].bytecode.all.size();
+		targets = m_units[m_unitTop].bytecode.jumpOffsetTargets.count();
+		addRelativeJumpSource( m_units[m_unitTop].bytecode, O_RelativeJump, conditionFalseMarker );
+	}
 
 	if ( !parseStatement(m_unitTop, ';', opcodeToReturn) )
 	{
 		return false;
 	}
 
+	const bool neverTrue = known
+						   && !condition.i
+						   && discardBytecode( m_units[m_unitTop].bytecode, mark, targets );
+
  	if ( !getToken(ex) )
 	{
 		setRelativeJumpTarget(m_units[m_unitTop].bytecode, conditionFalseMarker);
 	}
+	else if ( !m_quoted && token == "else" && neverTrue )
+	{
+		setRelativeJumpTarget( m_units[m_unitTop].bytecode, conditionFalseMarker );
+
+		if ( !parseStatement(m_unitTop, ';', opcodeToReturn) )
+		{
+			return false;
+		}
+	}
 	else if ( !m_quoted && token == "else" )
 	{
+		if ( known && condition.i )
+		{
+			m_units[m_unitTop].bytecode.invalidateOpcodeCache();
+			mark = m_units[m_unitTop].bytecode.all.size();
+			targets = m_units[m_unitTop].bytecode.jumpOffsetTargets.count();
+		}
+		
 		int conditionTrueMarker = addRelativeJumpTarget( m_units[m_unitTop].bytecode ); // when it hits here it will jump OVER this section
 
 		addRelativeJumpSource( m_units[m_unitTop].bytecode, O_RelativeJump, conditionTrueMarker );
@@ -3016,6 +5674,11 @@ bool WRCompilationContext::parseIf( WROpcode opcodeToReturn )
 		{
 			return false;
 		}
+
+		if ( known && condition.i )
+		{
+			discardBytecode( m_units[m_unitTop].bytecode, mark, targets );
+		}
 		
 		setRelativeJumpTarget( m_units[m_unitTop].bytecode, conditionTrueMarker );
 	}
@@ -3038,12 +5701,15 @@ bool WRCompilationContext::parseStatement( int unitIndex, char end, WROpcode opc
 	WRExpressionContext ex;
 	bool varSeen = false;
 	m_exportNextUnit = false;
+	const int block = openBlock();
 
 	for(;;)
 	{
 		WRstr& token = ex.token;
 //		WRValue& value = ex.value;
 
+		++m_statement;
+
 		if ( !getToken(ex) ) // if we run out of tokens that's fine as long as we were not waiting for a }
 		{
 			if ( end == '}' )
@@ -3071,7 +5737,25 @@ bool WRCompilationContext::parseStatement( int unitIndex, char end, WROpcode opc
 		
 		if ( !m_quoted && token == "{" )
 		{
-			return parseStatement( unitIndex, '}', opcodeToReturn );
+			const bool parsed = parseStatement( unitIndex, '}', opcodeToReturn );
+			m_block = block;
+			return parsed;
+		}
+
+		const bool unconditional = m_unconditional;
+		if ( !m_quoted
+			 && (token == "if"
+				 || token == "while"
+				 || token == "for"
+				 || token == "do"
+				 || token == "switch"
+				 || token == "break"
+				 || token == "continue"
+				 || token == "goto"
+				 || token == "return") )
+		{
+			m_straightLine = false; // anything after this might run more than once, or not at all
+			m_unconditional = false; // and anything in it might not run at all
 		}
 
 		if ( !m_quoted && token == "return" )
@@ -3091,6 +5775,7 @@ bool WRCompilationContext::parseStatement( int unitIndex, char end, WROpcode opc
 				WRExpression nex( m_units[unitIndex].bytecode.localSpace, m_units[unitIndex].bytecode.isStructSpace );
 				nex.context[0].token = token;
 				nex.context[0].value = ex.value;
+				nex.valueOnly = true;
 				m_loadedToken = token;
 				m_loadedValue = ex.value;
 				m_loadedQuoted = m_quoted;
@@ -3236,6 +5921,7 @@ bool WRCompilationContext::parseStatement( int unitIndex, char end, WROpcode opc
 			nex.context[0].varSeen = varSeen;
 			nex.context[0].token = token;
 			nex.context[0].value = ex.value;
+			nex.valueOnly = true;
 			nex.lValue = true;
 			m_loadedToken = token;
 			m_loadedValue = ex.value;
@@ -3249,16 +5935,23 @@ bool WRCompilationContext::parseStatement( int unitIndex, char end, WROpcode opc
 				return false;
 			}
 
-			appendBytecode( m_units[unitIndex].bytecode, nex.bytecode );
-			pushOpcode( m_units[unitIndex].bytecode, O_PopOne );
+			WRValue value;
+			if ( !m_optimize || !literalValue(nex.bytecode, value) ) // a value on its own does nothing
+			{
+				appendBytecode( m_units[unitIndex].bytecode, nex.bytecode );
+				pushOpcode( m_units[unitIndex].bytecode, O_PopOne );
+			}
 		}
 
+		m_unconditional = unconditional;
+
 		if ( end == ';' ) // single statement
 		{
 			break;
 		}
 	}
 
+	m_block = block;
 	return m_err ? false : true;
 }
 
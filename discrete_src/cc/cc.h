@@ -128,6 +128,7 @@ const WROperation c_operations[] =
 	{ 0, 0, O_LAST, false, WR_OPER_PRE, O_LAST },
 };
 const int c_highestPrecedence = 17; // one higher than the highest entry above, things that happen absolutely LAST
+const int c_optimizerPasses = 4; // WR_OPTIMIZE gives up looking for more constants after compiling this many times
 
 //------------------------------------------------------------------------------
 enum WRExpressionType
@@ -225,6 +226,7 @@ struct WRExpressionContext
 	const WROperation* operation;
 	
 	int stackPosition;
+	int resultType; // WR_INT or WR_FLOAT when WR_OPTIMIZE knows what this leaves on the stack, otherwise -1
 	
 	WRBytecode bytecode;
 
@@ -250,6 +252,7 @@ struct WRExpressionContext
 		spaceAfter = false;
 		global = false;
 		stackPosition = -1;
+		resultType = -1;
 		token.clear();
 		value.init();
 		bytecode.clear();
@@ -268,6 +271,7 @@ public:
 	WRBytecode bytecode;
 	bool lValue;
 	bool allowFunctionNameHashLiteral;
+	bool valueOnly; // the result is only ever read, nothing can keep a reference to a local through it
 
 	//------------------------------------------------------------------------------
 	void pushToStack( int index )
@@ -329,6 +333,7 @@ public:
 
 	//------------------------------------------------------------------------------
 	void swapWithTop( int stackPosition, bool addOpcodes =true );
+	void swapTwoToTop( const int first, const int second );
 	
 	WRExpression() { reset(); }
 	WRExpression( WRarray<WRNamespaceLookup>& localSpace, bool isStructSpace )
@@ -347,6 +352,7 @@ public:
 		bytecode.clear();
 		lValue = false;
 		allowFunctionNameHashLiteral = false;
+		valueOnly = false;
 	}
 };
 
@@ -358,6 +364,99 @@ struct ConstantValue
 	ConstantValue() { value.init(); }
 };
 
+//------------------------------------------------------------------------------
+// what WR_OPTIMIZE has seen done to one local of one unit
+struct KnownLocal
+{
+	int unit;
+	uint32_t hash;
+	bool constant; // declared with a literal before anything read it, and only ever read after that
+	WRValue value;
+	int type; // WR_INT or WR_FLOAT if nothing ever leaves it holding anything else, otherwise -1
+	KnownLocal() : type(-1) { value.init(); }
+};
+
+//------------------------------------------------------------------------------
+// where in its unit WR_OPTIMIZE saw a local named, counted in
+// statements, so locals that are never live at the same time can be
+// given the same frame slot
+struct LocalSpan
+{
+	int unit;
+	uint32_t hash;
+	int first; // statement it is first named in
+	int last; // and the last
+	int block; // the block 'first' is in
+	int loads; // how many times 'first' loads it
+	int notes; // how many times 'first' notes it
+	int writes; // how many of those just overwrite it
+	bool scoped; // everything after 'first' that names it is inside 'block'
+	bool pinned; // something else can write to it, it keeps a slot to itself
+};
+
+//------------------------------------------------------------------------------
+// the statements a loop runs over and over, a local live going into
+// one stays live until it ends
+struct LoopSpan
+{
+	int unit;
+	int first;
+	int last;
+};
+
+//------------------------------------------------------------------------------
+// what one pass saw of a loop, by the statement it starts at, for the
+// next to decide how many locals to set aside for what it can move
+// ahead of it
+struct LoopFacts
+{
+	int unit;
+	int first;
+	int slots; // set aside for it this pass
+	int hoists; // operations found that could have been moved
+};
+
+//------------------------------------------------------------------------------
+// a local a loop stores to, or one that something moved out of it reads
+struct LoopLocal
+{
+	int unit;
+	int first;
+	uint32_t hash;
+};
+
+//------------------------------------------------------------------------------
+// a loop being parsed. 'code' runs once each time it is entered,
+// before its condition is first tested
+struct LoopHoist
+{
+	int first;
+	int slots; // locals set aside for it, '@hoist:<base + n>'
+	int base;
+	int used;
+	int hoists;
+	int entry; // jump target for 'code', -1 if there is none
+	WRBytecode* code;
+};
+
+//------------------------------------------------------------------------------
+// a local holding the result of an operation moved out of a loop
+struct HoistedLocal
+{
+	int unit;
+	uint32_t hash;
+	int type;
+	int loop; // index in m_loops of the loop whose 'code' sets it
+};
+
+//------------------------------------------------------------------------------
+enum WRLocalUse
+{
+	LOCAL_READ,
+	LOCAL_STORE,
+	LOCAL_OTHER,
+};
+
 //------------------------------------------------------------------------------
 struct WRUnitContext
 {
@@ -370,7 +469,7 @@ struct WRUnitContext
 
 	WRarray<ConstantValue> constantValues;
 
-	int16_t offsetOfLocalHashMap;
+	int offsetOfLocalHashMap;
 	
 	// the code that runs when it loads
 	// the locals it has
@@ -405,6 +504,13 @@ public:
 					 const uint8_t compilerOptionFlags );
 
 private:
+
+	WRError compilePass( const char* data,
+						 const int size,
+						 unsigned char** out,
+						 int* outLen,
+						 WRstr* erroMsg,
+						 const uint8_t compilerOptionFlags );
 	
 	bool isReserved( const char* token );
 	bool isValidLabel( WRstr& token, bool& isGlobal, WRstr& prefix, bool& isLibConstant );
@@ -418,6 +524,9 @@ private:
 
 	friend class WRExpression;
 	static void pushOpcode( WRBytecode& bytecode, WROpcode opcode );
+	static void pushLoad( WRBytecode& bytecode, const bool global, const unsigned int index );
+	static bool singleLoad( WRBytecode& bytecode, unsigned int* load );
+	static bool literalValue( WRBytecode& bytecode, WRValue& value );
 	static void pushData( WRBytecode& bytecode, const unsigned char* data, const int len ) { bytecode.all.append( data, len ); }
 	static void pushData( WRBytecode& bytecode, const char* data, const int len ) { bytecode.all.append( (unsigned char*)data, len ); }
 
@@ -427,6 +536,8 @@ private:
 	bool m_embedGlobalSymbols;
 	bool m_embedSourceCode;
 	bool m_needVar;
+	bool m_inlineFunctions;
+	bool m_optimize;
 	bool m_exportNextUnit;
 	
 	uint16_t m_lastCode;
@@ -454,7 +565,29 @@ private:
 	unsigned int resolveExpressionEx( WRExpression& expression, int o, int p );
 
 	bool operatorFound( WRstr const& token, WRarray<WRExpressionContext>& context, int depth );
-	bool parseCallFunction( WRExpression& expression, WRstr functionName, int depth, bool parseArguments );
+	bool parseCallFunction( WRExpression& expression, WRstr functionName, int depth, bool parseArguments, bool construct =false );
+	bool inlineCallFunction( WRExpression& expression, int depth, uint32_t hash, unsigned char argsPushed, bool argsAreLocals );
+	bool tracksLocals( WRExpression& expression );
+	void noteLocal( const uint32_t hash, WRLocalUse use, const WRValue* value =0, const int type =-1 );
+	LocalSpan& localSpan( const uint32_t hash );
+	void overwriteLocal( const uint32_t hash );
+	int openBlock();
+	void addLoopSpan( const int first );
+	void openLoop( const int first, WRBytecode& code );
+	void enterLoop();
+	void closeLoop( const int back );
+	unsigned int hoistOperation( WRExpression& expression, const int o );
+	bool localsAreMembers( const unsigned int u );
+	void packFrame( const unsigned int u );
+	bool knownLocal( WRstr const& token, WRValue& value );
+	int localType( const uint32_t hash );
+	int contextType( WRExpression& expression, const int index );
+	int operationType( WRExpression& expression, const int o );
+	int slotType( WRBytecode& bytecode, const int slot );
+	int typedCompare( WRBytecode& bytecode, const int offset );
+	void typedOperation( WRBytecode& bytecode, const unsigned int mark );
+	unsigned int optimizeOperation( WRExpression& expression, int o );
+	bool discardBytecode( WRBytecode& bytecode, unsigned int mark, unsigned int targets );
 	bool pushObjectTable( WRExpressionContext& context, WRarray<WRNamespaceLookup>& localSpace, uint32_t hash );
 	int parseInitializer( WRExpression& expression, int depth );
 	char parseExpression( WRExpression& expression );
@@ -515,6 +648,29 @@ private:
 	WRarray<int> m_breakTargets;
 
 	int m_foreachHash;
+
+	bool m_straightLine; // nothing in this unit has branched or been branched to yet
+	bool m_unconditional; // not inside an if, loop or switch, so every call runs what is being parsed
+	bool m_localsNoted; // the operation being resolved has already noted its locals
+	bool m_guessTypes; // first pass: type locals from what has been seen so far, nothing is emitted from it
+	WRarray<KnownLocal> m_knownLocals; // what the previous pass proved
+	WRarray<KnownLocal> m_localUses; // what this pass has seen
+	int m_statement; // statements parsed so far
+	int m_block; // the block being parsed, -1 for none
+	WRarray<int> m_blockParents; // the block each block is inside
+	WRarray<LocalSpan> m_localSpans;
+	WRarray<LoopSpan> m_loopSpans;
+	bool m_hoistLoops; // operations may be moved out of loops
+	bool m_hoisting; // the code being resolved is the moved copy
+	bool m_hoistRefused; // this pass moved something it should not have
+	int m_hoistSlots; // '@hoist' locals named so far
+	WRarray<LoopFacts> m_loopFacts;
+	WRarray<LoopFacts> m_lastLoopFacts;
+	WRarray<LoopLocal> m_loopStores;
+	WRarray<LoopLocal> m_lastLoopStores;
+	WRarray<LoopLocal> m_loopReads;
+	WRarray<LoopHoist> m_loops;
+	WRarray<HoistedLocal> m_hoisted;
 };
 
 //------------------------------------------------------------------------------
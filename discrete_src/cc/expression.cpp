@@ -70,6 +70,7 @@ char WRCompilationContext::parseExpression( WRExpression& expression )
 		WRstr& token = expression.context[depth].token;
 
 		expression.context[depth].bytecode.clear();
+		expression.context[depth].resultType = -1;
 		expression.context[depth].setLocalSpace( expression.bytecode.localSpace, expression.bytecode.isStructSpace );
 		if ( !getToken(expression.context[depth]) )
 		{
@@ -191,7 +192,7 @@ char WRCompilationContext::parseExpression( WRExpression& expression )
 
 			if ( !m_quoted && token2 == ";" )
 			{
-				if ( !parseCallFunction(expression, functionName, depth, false) )
+				if ( !parseCallFunction(expression, functionName, depth, false, true) )
 				{
 					return 0;
 				}
@@ -202,7 +203,7 @@ char WRCompilationContext::parseExpression( WRExpression& expression )
 			}
 			else if ( !m_quoted && token2 == "(" )
 			{
-				if ( !parseCallFunction(expression, functionName, depth, true) )
+				if ( !parseCallFunction(expression, functionName, depth, true, true) )
 				{
 					return 0;
 				}
@@ -222,7 +223,7 @@ char WRCompilationContext::parseExpression( WRExpression& expression )
 			}
 			else if (!m_quoted && token2 == "{")
 			{
-				if ( !parseCallFunction(expression, functionName, depth, false) )
+				if ( !parseCallFunction(expression, functionName, depth, false, true) )
 				{
 					return 0;
 				}
@@ -266,7 +267,7 @@ char WRCompilationContext::parseExpression( WRExpression& expression )
 							break;
 						}
 
-						if ( !parseCallFunction(expression, functionName, depth, false) )
+						if ( !parseCallFunction(expression, functionName, depth, false, true) )
 						{
 							return 0;
 						}
@@ -439,10 +440,16 @@ char WRCompilationContext::parseExpression( WRExpression& expression )
 					expression.context[depth].bytecode = nex.bytecode;
 					operatorFound( WRstr("._exists"), expression.context, depth );
 				}
+				else if ( m_optimize && literalValue(nex.bytecode, expression.context[depth].value) )
+				{
+					// folded all the way down, so let it fold further
+					expression.context[depth].type = EXTYPE_LITERAL;
+				}
 				else
 				{
 					expression.context[depth].type = EXTYPE_BYTECODE_RESULT;
 					expression.context[depth].bytecode = nex.bytecode;
+					expression.context[depth].resultType = (nex.context.count() == 1) ? nex.context[0].resultType : -1;
 				}
 			}
 
@@ -455,6 +462,7 @@ char WRCompilationContext::parseExpression( WRExpression& expression )
 			WRExpression nex( expression.bytecode.localSpace, expression.bytecode.isStructSpace );
 			nex.context[0].token = token;
 			nex.context[0].value = value;
+			nex.valueOnly = true;
 
 			if ( parseExpression(nex) != ']' )
 			{
@@ -521,6 +529,8 @@ char WRCompilationContext::parseExpression( WRExpression& expression )
 				
 				if ( !m_quoted && token == ":" )
 				{
+					m_straightLine = false;
+					
 					uint32_t hash = wr_hashStr( label );
 					for( unsigned int i=0; i<expression.bytecode.jumpOffsetTargets.count(); ++i )
 					{
@@ -40,6 +40,14 @@ void WRCompilationContext::createLocalHashMap( WRUnitContext& unit, unsigned cha
 		return;
 	}
 
+	if ( unit.bytecode.localSpace.count() > 255 )
+	{
+		m_err = WR_ERR_compiler_panic; // member offsets are 8-bit
+		*size = 0;
+		*buf = 0;
+		return;
+	}
+
 	WRHashTable<unsigned char> offsets;
 	for( unsigned char i=unit.arguments; i<unit.bytecode.localSpace.count(); ++i )
 	{
@@ -79,28 +87,84 @@ void WRCompilationContext::link( unsigned char** out, int* outLen, const uint8_t
 	uint8_t data[4];
 
 	NamespacePush *namespaceLookups = 0;
+	bool overflow = false;
+
+	for( unsigned int u=1; m_optimize && u<m_units.count(); ++u )
+	{
+		packFrame( u );
+	}
 
 	unsigned int globals = m_units[0].bytecode.localSpace.count();
-	if ( globals > 255 )
+	unsigned int functions = m_units.count() - 1;
+
+	// anything that doesn't fit in a byte moves the whole image to
+	// the wide format
+	bool wide = (compilerOptionFlags & WR_WIDE_BYTECODE) || globals > 255 || functions > 255;
+	for( unsigned int u=1; u<m_units.count(); ++u )
 	{
-		m_err = WR_ERR_compiler_panic;
-		return;
+		unsigned int frameSpaceNeeded = m_units[u].bytecode.localSpace.count() - m_units[u].arguments;
+		if ( 1 + m_units[u].arguments + frameSpaceNeeded > 255 )
+		{
+			wide = true;
+		}
+
+		if ( 1 + m_units[u].arguments + frameSpaceNeeded > 0xFFFF )
+		{
+			m_err = WR_ERR_compiler_panic;
+			return;
+		}
 	}
 
-	code += (uint8_t)globals; // globals count (for VM allocation)
-	if ( (m_units.count() - 1) > 255 )
+	if ( wide )
 	{
-		m_err = WR_ERR_compiler_panic;
-		return;
+		// the debugger's symbol table and codewords are 8-bit
+		if ( globals > 0xFFFF
+			 || functions > 0xFFFF
+			 || (compilerOptionFlags & (WR_EMBED_DEBUG_CODE | WR_EMBED_SOURCE_CODE)) )
+		{
+			m_err = WR_ERR_compiler_panic;
+			return;
+		}
+
+		code += (uint8_t)0; // zero globals/functions in the narrow slots
+		code += (uint8_t)0;
+		code += (uint8_t)(compilerOptionFlags | WR_WIDE_BYTECODE);
+		code.append( wr_pack16(globals, data), 2 );
+		code.append( wr_pack16(functions, data), 2 );
+	}
+	else
+	{
+		code += (uint8_t)globals; // globals count (for VM allocation)
+		code += (uint8_t)functions; // function count (for VM allocation)
+		code += (uint8_t)compilerOptionFlags;
 	}
-	code += (uint8_t)(m_units.count() - 1); // function count (for VM allocation)
-	code += (uint8_t)compilerOptionFlags;
 
 	// push function signatures
 	for( unsigned int u=1; u<m_units.count(); ++u )
 	{
 		m_units[u].offsetInBytecode = code.size(); // mark these two spots for later
 
+		unsigned int frameSpaceNeeded = m_units[u].bytecode.localSpace.count() - m_units[u].arguments;
+		unsigned int frameBaseAdjustment = 1 + m_units[u].arguments + frameSpaceNeeded;
+
+		if ( wide )
+		{
+			// WRFunction.namespaceOffset, WRFunction.functionOffset
+			code.append( wr_pack32(0, data), 4 ); // placeholder
+			code.append( wr_pack32(0, data), 4 ); // placeholder
+
+			// WRFunction.hash
+			code.append( wr_pack32(m_units[u].hash, data), 4 );
+
+			// WRFunction.arguments
+			code += (uint8_t)m_units[u].arguments;
+
+			// WRFunction.frameSpaceNeeded, WRFunction.frameBaseAdjustment
+			code.append( wr_pack16(frameSpaceNeeded, data), 2 );
+			code.append( wr_pack16(frameBaseAdjustment, data), 2 );
+			continue;
+		}
+
 		// WRFunction.namespaceOffset
 		data[0] = 0xAA;
 		data[1] = 0xBB;
@@ -119,17 +183,11 @@ void WRCompilationContext::link( unsigned char** out, int* outLen, const uint8_t
 		code.append( data, 1 );
 
 		// WRFunction.frameSpaceNeeded;
-		unsigned int frameSpaceNeeded = m_units[u].bytecode.localSpace.count() - m_units[u].arguments;
-		if ( frameSpaceNeeded > 255 )
-		{
-			m_err = WR_ERR_compiler_panic;
-			return;
-		}
 		data[1] = (uint8_t)frameSpaceNeeded;
 		code.append( data + 1, 1 );
 
 		// WRFunction.frameBaseAdjustment;
-		data[2] = 1 + data[0] + data[1];
+		data[2] = (uint8_t)frameBaseAdjustment;
 		code.append( data + 2, 1 );
 	}
 
@@ -216,10 +274,11 @@ void WRCompilationContext::link( unsigned char** out, int* outLen, const uint8_t
 	// append all the unit code
 	for( unsigned int u=0; u<m_units.count(); ++u )
 	{
-		uint16_t base;
+		unsigned int base;
 
 		if ( u > 0 ) // for the non-zero unit fill locations into the jump table
 		{
+			base = 0;
 			if ( m_units[u].exportNamespace )
 			{
 				base = code.size();
@@ -227,6 +286,10 @@ void WRCompilationContext::link( unsigned char** out, int* outLen, const uint8_t
 				int size = 0;
 				uint8_t* map = 0;
 				createLocalHashMap( m_units[u], &map, &size );
+				if ( m_err )
+				{
+					return;
+				}
 				
 				if ( size == 0 )
 				{
@@ -234,21 +297,28 @@ void WRCompilationContext::link( unsigned char** out, int* outLen, const uint8_t
 				}
 				m_units[u].offsetOfLocalHashMap = base;
 
-				wr_pack16( base, code.p_str(m_units[u].offsetInBytecode)); // WRFunction.namespaceOffset
-
 				WR_DUMP_LINK_OUTPUT(printf("<new> namespace\n%s\n", wr_asciiDump(map, size, str)));
 
 				code.append( map, size );
 				g_free( map );
 			}
+
+			if ( wide )
+			{
+				wr_pack32( base, code.p_str(m_units[u].offsetInBytecode) ); // WRFunction.namespaceOffset
+				wr_pack32( code.size(), code.p_str(m_units[u].offsetInBytecode + 4) ); // WRFunction.functionOffset
+			}
 			else
 			{
-				base = 0;
+				if ( code.size() > 0xFFFF )
+				{
+					overflow = true; // caught below, start over wide
+					break;
+				}
+				
 				wr_pack16( base, code.p_str(m_units[u].offsetInBytecode) ); // WRFunction.namespaceOffset
+				wr_pack16( code.size(), code.p_str(m_units[u].offsetInBytecode + 2) ); // WRFunction.functionOffset
 			}
-
-			base = code.size();
-			wr_pack16( base, code.p_str(m_units[u].offsetInBytecode + 2) ); // WRFunction.functionOffset
 		}
 
 		WR_DUMP_UNIT_OUTPUT(printf("unit %d:\n%s\n", u, wr_asciiDump(code, code.size(), str)));
@@ -344,6 +414,39 @@ void WRCompilationContext::link( unsigned char** out, int* outLen, const uint8_t
 							wr_pack16( codeword, (unsigned char *)code.p_str(index - 2) );
 						}
 
+						bool skip = code[index+5] == O_PopOne || code[index + 6] == O_NewObjectTable;
+
+						// the value is pushed and returned straight back,
+						// so the callee can take over this frame rather
+						// than stacking a new one on top of it
+						if ( !skip
+							 && code[index + 6] == O_Return
+							 && !m_addDebugSymbols
+							 && !m_units[u].bytecode.isStructSpace )
+						{
+							// [O_Wide][W_TailCall][args][index16][pad]
+							code[index+2] = code[index+1];
+							code[index] = O_Wide;
+							code[index+1] = W_TailCall;
+							wr_pack16( u2 - 1, code.p_str(index+3) );
+							code[index+5] = O_Return;
+							break;
+						}
+
+						if ( u2 - 1 > 255 )
+						{
+							// [O_Wide][sub-op][args][index16] then the push, if any
+							code[index+2] = code[index+1];
+							code[index] = O_Wide;
+							code[index+1] = skip ? W_CallFunctionByIndexSkip1 : W_CallFunctionByIndex;
+							wr_pack16( u2 - 1, code.p_str(index+3) );
+							if ( !skip )
+							{
+								code[index+5] = O_PushIndexFunctionReturnValue;
+							}
+							break;
+						}
+
 						code[index] = O_CallFunctionByIndex;
 
 						code[index+2] = (char)(u2 - 1);
@@ -352,7 +455,7 @@ void WRCompilationContext::link( unsigned char** out, int* outLen, const uint8_t
 						// r+2345 = hash
 						// r+6
 
-						if ( code[index+5] == O_PopOne || code[index + 6] == O_NewObjectTable)
+						if ( skip )
 						{
 							code[index+3] = 3; // skip past the pop, or TO the NewObjectTable
 						}
@@ -392,15 +495,27 @@ void WRCompilationContext::link( unsigned char** out, int* outLen, const uint8_t
 		}
 	}
 
-	// plug in namespace lookups
+	// plug in namespace lookups, wide code names the function rather
+	// than an offset that might not fit
 	while( namespaceLookups )
 	{
-		wr_pack16( m_units[namespaceLookups->unit].offsetOfLocalHashMap, code.p_str(namespaceLookups->location) );
+		if ( !overflow )
+		{
+			wr_pack16( wide ? (m_units[namespaceLookups->unit].offsetOfLocalHashMap ? namespaceLookups->unit : 0)
+							: m_units[namespaceLookups->unit].offsetOfLocalHashMap,
+					   code.p_str(namespaceLookups->location) );
+		}
 		NamespacePush* next = namespaceLookups->next;
 		g_free( namespaceLookups );
 		namespaceLookups = next;
 	}
 
+	if ( overflow )
+	{
+		link( out, outLen, compilerOptionFlags | WR_WIDE_BYTECODE );
+		return;
+	}
+
 	// append a CRC
 	uint32_t salted = wr_hash( code, code.size() );
 	salted += WRENCH_VERSION_MAJOR;
@@ -27,6 +27,20 @@ SOFTWARE.
 
 #define KEYHOLE_OPTIMIZER
 
+//------------------------------------------------------------------------------
+// [LLValues][a][b][IndexSkipLoad] was just put on the end of 'bytecode',
+// it is the pair dispatched most in anything that walks an array so
+// make it one instruction of the same size
+static void wr_fuseLLIndex( WRBytecode& bytecode )
+{
+	const int a = bytecode.all.size() - 4;
+	bytecode.all[a+3] = bytecode.all[a+2];
+	bytecode.all[a+2] = bytecode.all[a+1];
+	bytecode.all[a+1] = W_LLIndex;
+	bytecode.all[a] = O_Wide;
+	bytecode.opcodes[bytecode.opcodes.size() - 1] = O_Wide;
+}
+
 //------------------------------------------------------------------------------
 bool WRCompilationContext::CheckSkipLoad( WROpcode opcode, WRBytecode& bytecode, int a, int o )
 {
@@ -38,6 +52,10 @@ bool WRCompilationContext::CheckSkipLoad( WROpcode opcode, WRBytecode& bytecode,
 		bytecode.all[a] = opcode;
 		bytecode.opcodes.shave(2);
 		bytecode.opcodes += opcode;
+		if ( opcode == O_IndexSkipLoad )
+		{
+			wr_fuseLLIndex( bytecode );
+		}
 		return true;
 	}
 	else if ( bytecode.opcodes[o] == O_LoadFromGlobal
@@ -200,6 +218,7 @@ bool WRCompilationContext::CheckCompareReplace( WROpcode LS, WROpcode GS, WROpco
 			bytecode.all[ a - 6 ] = bytecode.opcodes[o];
 			bytecode.all[ a - 1 ] = ILS;
 
+			bytecode.opcodes[o-1] = bytecode.opcodes[o]; // the literal comes first now
 			bytecode.opcodes[o] = ILS; // reverse the logic
 
 			return true;
@@ -210,6 +229,7 @@ bool WRCompilationContext::CheckCompareReplace( WROpcode LS, WROpcode GS, WROpco
 			bytecode.all[ a - 2 ] = O_LiteralZero;
 			bytecode.all[ a ] = bytecode.all[ a - 1];
 			bytecode.all[ a - 1 ] = ILS;
+			bytecode.opcodes[o-1] = bytecode.opcodes[o]; // the literal comes first now
 			bytecode.opcodes[o] = ILS; // reverse the logic
 			return true;
 		}
@@ -219,6 +239,7 @@ bool WRCompilationContext::CheckCompareReplace( WROpcode LS, WROpcode GS, WROpco
 			bytecode.all[ a - 2 ] = O_LiteralZero;
 			bytecode.all[ a ] = bytecode.all[ a - 1];
 			bytecode.all[ a - 1 ] = ILS;
+			bytecode.opcodes[o-1] = bytecode.opcodes[o]; // the literal comes first now
 			bytecode.opcodes[o] = ILS; // reverse the logic
 			return true;
 		}
@@ -231,6 +252,7 @@ bool WRCompilationContext::CheckCompareReplace( WROpcode LS, WROpcode GS, WROpco
 			bytecode.all[ a - 1 ] = ILS;
 			bytecode.all[ a - 3 ] = O_LiteralInt8;
 
+			bytecode.opcodes[o-1] = bytecode.opcodes[o]; // the literal comes first now
 			bytecode.opcodes[o] = ILS; // reverse the logic
 			return true;
 		}
@@ -245,6 +267,7 @@ bool WRCompilationContext::CheckCompareReplace( WROpcode LS, WROpcode GS, WROpco
 			bytecode.all[ a - 1 ] = ILS;
 			bytecode.all[ a - 4 ] = O_LiteralInt16;
 
+			bytecode.opcodes[o-1] = bytecode.opcodes[o]; // the literal comes first now
 			bytecode.opcodes[o] = ILS; // reverse the logic
 			return true;
 		}
@@ -1338,8 +1361,10 @@ void WRCompilationContext::appendBytecode( WRBytecode& bytecode, WRBytecode& add
 	// add the namespace, making sure to offset it into the new block properly
 	for (unsigned int n = 0; n < addMe.localSpace.count(); ++n)
 	{
-		unsigned int m = 0;
-		for (m = 0; m < bytecode.localSpace.count(); ++m)
+		// expressions start from a copy of the space they are appended
+		// to, so the same slot is almost always the match
+		unsigned int m = (n < bytecode.localSpace.count() && bytecode.localSpace[n].hash == addMe.localSpace[n].hash) ? n : 0;
+		for ( ; m < bytecode.localSpace.count(); ++m)
 		{
 			if (bytecode.localSpace[m].hash == addMe.localSpace[n].hash)
 			{
@@ -1481,6 +1506,7 @@ void WRCompilationContext::appendBytecode( WRBytecode& bytecode, WRBytecode& add
 
 			bytecode.opcodes += O_LoadFromLocal;
 			bytecode.opcodes += O_IndexSkipLoad;
+			wr_fuseLLIndex( bytecode );
 			return;
 		}
 		else if ( bytecode.opcodes[bytecode.opcodes.size() - 1] == O_LoadFromGlobal
@@ -1546,7 +1572,16 @@ void WRCompilationContext::appendBytecode( WRBytecode& bytecode, WRBytecode& add
 				bytecode.all[o + 2] = bytecode.all[o + 1];
 				bytecode.all[o + 1] = bytecode.all[o + 6];
 
+				// remember it (and the one before it) only so swapWithTop()
+				// can tell when it has been handed two in a row
+				const bool pair = bytecode.opcodes.size() > 2
+								  && bytecode.opcodes[ bytecode.opcodes.size() - 3 ] == O_LocalIndexHash;
 				bytecode.opcodes.clear();
+				if ( pair )
+				{
+					bytecode.opcodes += O_LocalIndexHash;
+				}
+				bytecode.opcodes += O_LocalIndexHash;
 				bytecode.all.shave(1);
 			}
 			else if (bytecode.opcodes.size() > 1
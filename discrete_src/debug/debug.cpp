@@ -94,16 +94,34 @@ void wr_formatGCObject( WRGCObject const& obj, WRstr& out )
 			out.appendFormat( "SV_CHAR : size[%d]", obj.m_size ); 
 			break;
 		}
+
+		case SV_INT32:
+		{
+			out.appendFormat( "SV_INT32 : size[%d]", obj.m_size ); 
+			break;
+		}
+
+		case SV_FLOAT32:
+		{
+			out.appendFormat( "SV_FLOAT32 : size[%d]", obj.m_size ); 
+			break;
+		}
+
+		case SV_UINT8:
+		{
+			out.appendFormat( "SV_UINT8 : size[%d]", obj.m_size ); 
+			break;
+		}
 		
 		case SV_HASH_TABLE:
 		{
-			out.appendFormat( "SV_HASH_TABLE : mod[%d] size[%d] ", obj.m_mod, obj.m_size ); 
+			out.appendFormat( "SV_HASH_TABLE : capacity[%d] size[%d] ", obj.m_capacity, obj.m_size ); 
 			break;
 		}
 		
 		case SV_VOID_HASH_TABLE:
 		{
-			out.appendFormat( "SV_VOID_HASH_TABLE : @[%p] mod[%d] ", obj.m_ROMHashTable, obj.m_mod ); 
+			out.appendFormat( "SV_VOID_HASH_TABLE : @[%p] capacity[%d] ", obj.m_ROMHashTable, obj.m_capacity ); 
 			break;
 		}
 	}
@@ -143,7 +161,7 @@ void wr_formatStackEntry( const WRValue* v, WRstr& out )
 
 		case WR_EX:
 		{
-			switch( v->xtype )
+			switch( v->xtype & EX_TYPE_MASK )
 			{
 				case WR_EX_RAW_ARRAY:
 				{
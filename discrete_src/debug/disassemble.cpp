@@ -299,6 +299,59 @@ int wr_operandSizeForOpcode( const uint8_t* opPtr, const uint8_t* end, const uin
 			return 3 + (int)(count * 2U);
 		}
 
+		case O_Wide:
+		{
+			if ( opPtr + 1 > end )
+			{
+				return -1;
+			}
+			switch( READ_8_FROM_PC(opPtr) )
+			{
+				case W_LoadFromLocal:
+				case W_LoadFromGlobal:
+				case W_PopToLocal: return 3; // sub, idx16
+				case W_CallFunctionByIndex:
+				case W_CallFunctionByIndexSkip1: return 4; // sub, argc, fnIdx16
+				case W_TailCall: return 5; // sub, argc, fnIdx16, pad
+				case W_PushIterator: return 6; // sub, shape, idx16, iter16
+				case W_NextValueOrJump: return 8; // sub, shape, idx16, iter16, rel16
+				case W_NextKeyValueOrJump: return 10; // sub, shape, idx16, idx16, iter16, rel16
+				case W_IntLLCompareLTBZ:
+				case W_IntLLCompareLEBZ:
+				case W_IntLLCompareGTBZ:
+				case W_IntLLCompareGEBZ:
+				case W_IntLLCompareEQBZ:
+				case W_IntLLCompareNEBZ:
+				case W_IntLCountLTBZ:
+				case W_IncLocalLLCompareLT: return 5; // sub, idx8, idx8, rel16
+				case W_IntLICompareLTBZ:
+				case W_IntLICompareLEBZ:
+				case W_IntLICompareGTBZ:
+				case W_IntLICompareGEBZ:
+				case W_IntLICompareEQBZ:
+				case W_IntLICompareNEBZ: return 6; // sub, idx8, imm16, rel16
+				case W_IntLLAddition:
+				case W_IntLLSubtraction:
+				case W_IntLLMultiplication:
+				case W_FloatLLAddition:
+				case W_FloatLLSubtraction:
+				case W_FloatLLMultiplication:
+				case W_FloatLLDivision:
+				case W_LLIndex: return 3; // sub, idx8, idx8
+				case W_LLIndexHashPair: return 11; // sub, idx8, hash32, idx8, hash32
+				case W_SwitchDense:
+				{
+					if ( opPtr + 7 > end )
+					{
+						return -1;
+					}
+					uint16_t count = (uint16_t)READ_16_FROM_PC(opPtr + 5);
+					return 9 + (int)(count * 2U); // sub, base32, count16, default16, table
+				}
+			}
+			return -1;
+		}
+
 		default:
 		{
 			break;
@@ -437,6 +490,72 @@ void wr_decodeOperands( const uint8_t op,
 						  (unsigned int)opPtr[0], (unsigned int)opPtr[1], (unsigned int)opPtr[2] );
 		return;
 	}
+	if ( op == O_Wide )
+	{
+		uint8_t sub = opPtr[0];
+		ops.appendFormat( "%s", c_wideOpcodeName[sub] );
+		if ( sub == W_LoadFromLocal || sub == W_LoadFromGlobal || sub == W_PopToLocal )
+		{
+			ops.appendFormat( " %c[0x%04X]", (sub == W_LoadFromGlobal) ? 'g' : 'l', (unsigned int)(uint16_t)READ_16_FROM_PC(opPtr + 1) );
+		}
+		else if ( sub == W_CallFunctionByIndex || sub == W_CallFunctionByIndexSkip1 || sub == W_TailCall )
+		{
+			ops.appendFormat( " argc=0x%02X fnIdx=0x%04X", (unsigned int)opPtr[1], (unsigned int)(uint16_t)READ_16_FROM_PC(opPtr + 2) );
+		}
+		else if ( (sub >= W_IntLLCompareLTBZ && sub <= W_IntLLCompareNEBZ) || sub == W_IntLCountLTBZ || sub == W_IncLocalLLCompareLT )
+		{
+			int rel = (int)READ_16_FROM_PC(opPtr + 3);
+			ops.appendFormat( " l[0x%02X] l[0x%02X] rel=0x%04X ->0x%04X",
+							  (unsigned int)opPtr[1], (unsigned int)opPtr[2],
+							  (unsigned int)(uint16_t)rel, (unsigned int)(instOffset + 4 + rel) );
+		}
+		else if ( sub >= W_IntLICompareLTBZ && sub <= W_IntLICompareNEBZ )
+		{
+			int rel = (int)READ_16_FROM_PC(opPtr + 4);
+			ops.appendFormat( " l[0x%02X] imm=%d rel=0x%04X ->0x%04X",
+							  (unsigned int)opPtr[1], (int)READ_16_FROM_PC(opPtr + 2),
+							  (unsigned int)(uint16_t)rel, (unsigned int)(instOffset + 5 + rel) );
+		}
+		else if ( (sub >= W_IntLLAddition && sub <= W_FloatLLDivision) || sub == W_LLIndex )
+		{
+			ops.appendFormat( " l[0x%02X] l[0x%02X]", (unsigned int)opPtr[1], (unsigned int)opPtr[2] );
+		}
+		else if ( sub == W_LLIndexHashPair )
+		{
+			ops.appendFormat( " l[0x%02X] hash=0x%08X l[0x%02X] hash=0x%08X",
+							  (unsigned int)opPtr[1], (unsigned int)READ_32_FROM_PC(opPtr + 2),
+							  (unsigned int)opPtr[6], (unsigned int)READ_32_FROM_PC(opPtr + 7) );
+		}
+		else if ( sub == W_SwitchDense )
+		{
+			int16_t d = READ_16_FROM_PC(opPtr + 7);
+			ops.appendFormat( " base=%d count=0x%04X defaultRel=0x%04X ->0x%04X",
+							  (int)(int32_t)READ_32_FROM_PC(opPtr + 1),
+							  (unsigned int)(uint16_t)READ_16_FROM_PC(opPtr + 5),
+							  (unsigned int)(uint16_t)d,
+							  (unsigned int)(instOffset + 8 + d) );
+		}
+		else
+		{
+			int idx = 2;
+			ops.appendFormat( " %c[0x%04X]", (opPtr[1] & 1) ? 'l' : 'g', (unsigned int)(uint16_t)READ_16_FROM_PC(opPtr + idx) );
+			idx += 2;
+			if ( sub == W_NextKeyValueOrJump )
+			{
+				ops.appendFormat( " %c[0x%04X]", (opPtr[1] & 2) ? 'l' : 'g', (unsigned int)(uint16_t)READ_16_FROM_PC(opPtr + idx) );
+				idx += 2;
+			}
+			ops.appendFormat( " iter=g[0x%04X]", (unsigned int)(uint16_t)READ_16_FROM_PC(opPtr + idx) );
+			idx += 2;
+			if ( sub != W_PushIterator )
+			{
+				int rel = (int)READ_16_FROM_PC(opPtr + idx);
+				ops.appendFormat( " rel=0x%04X ->0x%04X", (unsigned int)(uint16_t)rel, (unsigned int)(instOffset + 1 + idx + rel) );
+			}
+		}
+		return;
+	}
+
 	if ( op == O_LoadLibConstant || op == O_AssignToObjectTableByHash || op == O_StackIndexHash )
 	{
 		ops.appendFormat( "hash=0x%08X", (unsigned int)READ_32_FROM_PC(opPtr) );
@@ -744,7 +863,7 @@ void wr_disassemble( const uint8_t* bytecode, const unsigned int len, WRstr& out
 	{
 		out += "Globals Table\n";
 		out += "-------------\n";
-		const uint8_t* gsym = context->bottom + 3 + (context->numLocalFunctions * WR_FUNCTION_CORE_SIZE);
+		const uint8_t* gsym = context->bottom + wr_functionTableEnd( context->bottom );
 		for( unsigned int g=0; g<context->globals; ++g, gsym += 4 )
 		{
 			out.appendFormat( "  g[0x%02X] hash=0x%08X\n", g, (unsigned int)READ_32_FROM_PC(gsym) );
@@ -826,3 +945,98 @@ void wr_disassemble( const uint8_t* bytecode, const unsigned int len, char** out
 }
 
 #endif
+
+#ifdef WRENCH_OPCODE_PROFILE
+//------------------------------------------------------------------------------
+static void wr_appendProfileCode( WRstr& out, const uint32_t code )
+{
+#ifdef WRENCH_WITHOUT_COMPILER
+	out.appendFormat( (code < (uint32_t)O_LAST) ? " %u" : " Wide:%u", (unsigned int)((code < (uint32_t)O_LAST) ? code : code - O_LAST) );
+#else
+	if ( code < (uint32_t)O_LAST )
+	{
+		out.appendFormat( " %s", c_opcodeName[code] );
+	}
+	else
+	{
+		out.appendFormat( " Wide:%s", c_wideOpcodeName[code - O_LAST] );
+	}
+#endif
+}
+
+//------------------------------------------------------------------------------
+// next entry of 'count' in descending order after the one at 'index'
+// (-1 to start), ties go by index. -1 when there are no more non-zero
+static int wr_nextLargest( const uint64_t* count, const int size, const int index )
+{
+	const uint64_t below = (index >= 0) ? count[index] : ~(uint64_t)0;
+	int best = -1;
+	for( int i=0; i<size; ++i )
+	{
+		if ( count[i]
+			 && (count[i] < below || (count[i] == below && i > index))
+			 && (best == -1 || count[i] > count[best]) )
+		{
+			best = i;
+		}
+	}
+	return best;
+}
+
+//------------------------------------------------------------------------------
+static void wr_appendProfileLine( WRstr& out, const uint64_t count, const uint64_t total )
+{
+	out.appendFormat( "%14llu %6.2f%% ", (unsigned long long)count, total ? (100.0 * (double)count) / (double)total : 0.0 );
+}
+
+//------------------------------------------------------------------------------
+void wr_opcodeProfile( WRState* w, WRstr& out, const int top )
+{
+	const WROpcodeProfile* p = w->opcodeProfile;
+	out.clear();
+
+	out.appendFormat( "%llu instructions dispatched\n\ninstructions:\n", (unsigned long long)p->total );
+	int n = -1;
+	for( int i=0; i<top && (n = wr_nextLargest(p->single, WR_PROFILE_CODES, n)) != -1; ++i )
+	{
+		wr_appendProfileLine( out, p->single[n], p->total );
+		wr_appendProfileCode( out, n );
+		out += "\n";
+	}
+
+	out += "\npairs:\n";
+	n = -1;
+	for( int i=0; i<top && (n = wr_nextLargest(p->pair, WR_PROFILE_CODES*WR_PROFILE_CODES, n)) != -1; ++i )
+	{
+		wr_appendProfileLine( out, p->pair[n], p->total );
+		wr_appendProfileCode( out, n / WR_PROFILE_CODES );
+		wr_appendProfileCode( out, n % WR_PROFILE_CODES );
+		out += "\n";
+	}
+
+	uint64_t* triples = (uint64_t*)g_malloc( WR_PROFILE_TRIPLES * sizeof(uint64_t) );
+	for( int t=0; t<WR_PROFILE_TRIPLES; ++t )
+	{
+		triples[t] = p->triple[t].count;
+	}
+
+	out += "\ntriples:\n";
+	n = -1;
+	for( int i=0; i<top && (n = wr_nextLargest(triples, WR_PROFILE_TRIPLES, n)) != -1; ++i )
+	{
+		const uint32_t key = p->triple[n].key - 1;
+		wr_appendProfileLine( out, triples[n], p->total );
+		wr_appendProfileCode( out, key / (WR_PROFILE_CODES*WR_PROFILE_CODES) );
+		wr_appendProfileCode( out, (key / WR_PROFILE_CODES) % WR_PROFILE_CODES );
+		wr_appendProfileCode( out, key % WR_PROFILE_CODES );
+		out += "\n";
+	}
+
+	g_free( triples );
+
+	if ( p->lostTriples )
+	{
+		out.appendFormat( "\n%llu triples not counted, the table is full\n", (unsigned long long)p->lostTriples );
+	}
+}
+#endif
@@ -106,12 +106,10 @@ WRContext* WRDebugServerInterface::loadBytes( const uint8_t* bytes, const int le
 	I->m_stepOut = false;
 	I->m_halted = false;
  	
-	const uint8_t* code = bytes + 2;
-	
-	I->m_compilerFlags = READ_8_FROM_PC( code++ );
+	I->m_compilerFlags = READ_8_FROM_PC( bytes + 2 );
 
-	// skip over function signatures
-	code += I->m_context->numLocalFunctions * WR_FUNCTION_CORE_SIZE;
+	// skip over header and function signatures
+	const uint8_t* code = bytes + wr_functionTableEnd( bytes );
 
 	if ( I->m_compilerFlags & WR_INCLUDE_GLOBALS )
 	{
@@ -26,7 +26,6 @@ SOFTWARE.
 
 // standard functions that sort of come up a lot
 
-int32_t wr_Seed = 0xA5EED;
 
 //------------------------------------------------------------------------------
 uint32_t wr_hash_read8( const void *dat, const int len )
@@ -174,12 +173,18 @@ int wr_ftoa( float f, char* string, size_t len )
 }
 
 //------------------------------------------------------------------------------
-const int32_t wr_randEx( const int32_t from, const int32_t to )
+void wr_setRandomSeed( WRState* w, const int32_t seed )
 {
-	const int32_t k = wr_Seed / 127773;
-	wr_Seed = 16807 * (wr_Seed - k * 127773) - 2836 * k;
+	w->randomSeed = seed;
+}
+
+//------------------------------------------------------------------------------
+const int32_t wr_randEx( WRState* w, const int32_t from, const int32_t to )
+{
+	const int32_t k = w->randomSeed / 127773;
+	w->randomSeed = 16807 * (w->randomSeed - k * 127773) - 2836 * k;
 
-	return (from >= to) ? from : ((uint32_t)wr_Seed % ((to - from) + 1)) + from;
+	return (from >= to) ? from : ((uint32_t)w->randomSeed % ((to - from) + 1)) + from;
 }
 
 //------------------------------------------------------------------------------
@@ -190,8 +195,8 @@ void wr_std_rand( WRValue* stackTop, const int argn, WRContext* c )
 		WRValue* args = stackTop - argn;
 
 		stackTop->i = argn > 1 ?
-					  wr_randEx(args[0].asInt(), args[1].asInt())
-							   : wr_randEx( 0, args[0].asInt() );
+					  wr_randEx(c->w, args[0].asInt(), args[1].asInt())
+							   : wr_randEx( c->w, 0, args[0].asInt() );
 	}
 }
 
@@ -200,7 +205,7 @@ void wr_std_srand( WRValue* stackTop, const int argn, WRContext* c )
 {
 	if ( argn == 1 )
 	{
-		wr_Seed = (uint32_t)((stackTop - 1)->asInt());
+		c->w->randomSeed = (uint32_t)((stackTop - 1)->asInt());
 	}
 }
 
@@ -266,4 +271,5 @@ void wr_loadAllLibs( WRState* w )
 	wr_loadDebugLib( w );
 	wr_loadTCPLib( w );
 	wr_loadContainerLib( w );
+	wr_loadVecLib( w );
 }
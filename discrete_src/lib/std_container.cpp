@@ -91,6 +91,7 @@ void wr_arrayPeek( WRValue* stackTop, const int argn, WRContext* c )
 
 	if ( A->va->m_size > 0 )
 	{
+		WR_GC_REMEMBER( c, A->vb );
 		stackTop->p2 = INIT_AS_CONTAINER_MEMBER;// | ENCODE_ARRAY_ELEMENT_TO_P2( 0 );
 		stackTop->r = A;
 	}
@@ -107,6 +108,7 @@ void wr_arrayPeekBack( WRValue* stackTop, const int argn, WRContext* c )
 
 	if ( A->va->m_size > 0 )
 	{
+		WR_GC_REMEMBER( c, A->vb );
 		stackTop->p2 = INIT_AS_CONTAINER_MEMBER | ENCODE_ARRAY_ELEMENT_TO_P2( A->va->m_size - 1 );
 		stackTop->r = A;
 	}
@@ -122,6 +124,15 @@ void wr_arrayRemoveEx( WRValue* A, const unsigned int where, const int count, WR
 		{
 			A->va->m_size = where; // simple truncation
 		}
+		else if ( where == 0 )
+		{
+			// just step the front forward, the room is reclaimed by the
+			// next push to the front or reallocation
+			A->va->m_Vdata += count;
+			A->va->m_head += count;
+			A->va->m_capacity -= count;
+			A->va->m_size -= count;
+		}
 		else
 		{
 			unsigned int elements = A->va->m_size - from;
@@ -183,9 +194,40 @@ void wr_arrayTruncate( WRValue* stackTop, const int argn, WRContext* c )
 	*stackTop = *A;
 }
 
+//------------------------------------------------------------------------------
+void wr_arrayReserve( WRValue* stackTop, const int argn, WRContext* c )
+{
+	WRValue* A;
+	WRValue* args = stackTop - argn;
+
+	if( (argn < 2) || !(A = wr_ifValueArray(args)) )
+	{
+		return;
+	}
+
+	int capacity = args[1].asInt();
+	if ( capacity > 0 && (uint32_t)capacity > A->va->m_capacity )
+	{
+		c->allocatedMemoryHint += (capacity - A->va->m_capacity) * sizeof(WRValue);
+		wr_reserveValueArray( A->va, capacity );
+	}
+
+	*stackTop = *A;
+}
+
 //------------------------------------------------------------------------------
 void wr_arrayInsertEx( WRValue* A, const unsigned int where, const unsigned int count, WRValue* stackTop, WRContext* c )
 {
+	WR_GC_REMEMBER( c, A->vb );
+
+	if ( where == 0 )
+	{
+		// inserting at the front (push/push_front) is a deque operation
+		wr_growValueArrayFront( A->va, count );
+		c->gc( stackTop + 1 );
+		return;
+	}
+
 	unsigned int originalSize = A->va->m_size;
 	// accommodate new size (passed value is expected to be the highest accessible index)
 	wr_growValueArray( A->va, originalSize + (count - 1) );
@@ -283,7 +325,7 @@ void wr_arrayPushBack( WRValue* stackTop, const int argn, WRContext* c )
 	const unsigned int where = A->va->m_size;
 
 	wr_arrayInsertEx( A, where, 1, stackTop, c );
-	A->va->m_Vdata[where] = args[1];
+	A->va->m_Vdata[where] = args[1].deref();
 }
 
 //------------------------------------------------------------------------------
@@ -298,7 +340,7 @@ void wr_arrayPush( WRValue* stackTop, const int argn, WRContext* c )
 	}
 
 	wr_arrayInsertEx( A, 0, 1, stackTop, c );
-	A->va->m_Vdata[0] = args[1];
+	A->va->m_Vdata[0] = args[1].deref();
 }
 
 //------------------------------------------------------------------------------
@@ -348,13 +390,14 @@ void wr_hashAdd( WRValue* stackTop, const int argn, WRContext* c )
 
 	uint32_t hash = args[2].getHash(); // key
 	int element;
+	WR_GC_REMEMBER( c, H->vb );
 	WRValue* entry = (WRValue*)( H->va->get(hash, &element) );
 
 	*entry = args[1].deref();
 	*(entry + 1) = args[2].deref();
 
 	stackTop->p2 = INIT_AS_CONTAINER_MEMBER | ENCODE_ARRAY_ELEMENT_TO_P2( element );
-	stackTop->vb = (WRGCBase*)(H->va->m_Vdata) - 1;
+	stackTop->vb = H->vb;
 }
 
 //------------------------------------------------------------------------------
@@ -388,6 +431,7 @@ void wr_loadContainerLib( WRState* w )
 	wr_registerLibraryFunction( w, "array::remove", wr_arrayRemove );     // ( array, where, [count == 1] )
 	wr_registerLibraryFunction( w, "array::insert", wr_arrayInsert );     // ( array, where, [count == 1] )
 	wr_registerLibraryFunction( w, "array::truncate", wr_arrayTruncate ); // ( array, newSize )
+	wr_registerLibraryFunction( w, "array::reserve", wr_arrayReserve );   // ( array, capacity )
 
 	wr_registerLibraryFunction( w, "hash::clear", wr_hashClear );   // ( hash )
 	wr_registerLibraryFunction( w, "hash::count", wr_hashCount );   // ( hash )
@@ -283,6 +283,57 @@ void wr_intScale(WRValue* stackTop, const int argn, WRContext* c)
 	stackTop->i = res;
 }
 
+//------------------------------------------------------------------------------
+struct WRPureMathFunction
+{
+	const char* name;
+	WR_LIB_CALLBACK function;
+};
+
+//------------------------------------------------------------------------------
+static const WRPureMathFunction c_pureMathFunctions[] =
+{
+	{ "math::sin", wr_math_sin },
+	{ "math::cos", wr_math_cos },
+	{ "math::tan", wr_math_tan },
+	{ "math::sinh", wr_math_sinh },
+	{ "math::cosh", wr_math_cosh },
+	{ "math::tanh", wr_math_tanh },
+	{ "math::asin", wr_math_asin },
+	{ "math::acos", wr_math_acos },
+	{ "math::atan", wr_math_atan },
+	{ "math::atan2", wr_math_atan2 },
+	{ "math::log", wr_math_log },
+	{ "math::ln", wr_math_log },
+	{ "math::log10", wr_math_log10 },
+	{ "math::exp", wr_math_exp },
+	{ "math::pow", wr_math_pow },
+	{ "math::fmod", wr_math_fmod },
+	{ "math::trunc", wr_math_trunc },
+	{ "math::sqrt", wr_math_sqrt },
+	{ "math::ceil", wr_math_ceil },
+	{ "math::floor", wr_math_floor },
+	{ "math::abs", wr_math_abs },
+	{ "math::ldexp", wr_math_ldexp },
+	{ "math::deg2rad", wr_math_deg2rad },
+	{ "math::rad2deg", wr_math_rad2deg },
+	{ 0, 0 },
+};
+
+//------------------------------------------------------------------------------
+WR_LIB_CALLBACK wr_pureMathFunction( const uint32_t hash )
+{
+	for( int f=0; c_pureMathFunctions[f].name; ++f )
+	{
+		if ( wr_hashStr(c_pureMathFunctions[f].name) == hash )
+		{
+			return c_pureMathFunctions[f].function;
+		}
+	}
+
+	return 0;
+}
+
 //------------------------------------------------------------------------------
 void wr_loadMathLib( WRState* w )
 {
@@ -36,12 +36,16 @@ void wr_mboxRead( WRValue* stackTop, const int argn, WRContext* c )
 		WRValue* args = stackTop - argn;
 		int clear = (argn > 1) ? args[1].asInt() : 0;
 
-		WRValue* msg = c->w->globalRegistry.exists( args[0].getHash(), clear != 0 );
+		const uint32_t hash = args[0].getHash();
+		WRValue* msg = c->w->globalRegistry.exists( hash, false );
 
 		if ( msg )
 		{
 			*stackTop = *msg;
-			return;
+			if ( clear )
+			{
+				c->w->globalRegistry.exists( hash, true );
+			}
 		}
 	}
 }
@@ -41,9 +41,9 @@ void wr_stdSerialize( WRValue* stackTop, const int argn, WRContext* c )
 			}
 #endif
 			stackTop->p2 = INIT_AS_ARRAY;
-			g_free( stackTop->va->m_Cdata );
+			stackTop->va->freeData( stackTop->va->m_Cdata );
 			stackTop->va->m_data = buf;
-			stackTop->va->m_size = len;
+			stackTop->va->m_capacity = stackTop->va->m_size = len;
 		}
 	}
 }
@@ -38,7 +38,7 @@ void wr_isFunction( WRValue* stackTop, const int argn, WRContext* c )
 		{
 			stackTop->i = 1;
 		}
-		else if ( c->registry.exists(hash, false) )
+		else if ( wr_registry(c).exists(hash, false) )
 		{
 			stackTop->i = 2;
 		}
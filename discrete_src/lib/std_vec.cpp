@@ -0,0 +1,719 @@
+/*******************************************************************************
+Copyright (c) 2026 Curt Hartung -- curt.hartung@gmail.com
+
+MIT Licence
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#include "wrench.h"
+
+// float kernels run WR_VEC_WIDTH lanes at a time where the target has
+// them. The integer loops are left plain, compilers vectorize those on
+// their own but can't reorder a float sum without being told to
+#ifndef WRENCH_VEC_SCALAR
+#if defined(__AVX__)
+
+#include <immintrin.h>
+#define WR_VEC_WIDTH 8
+typedef __m256 WRVecF;
+#define WR_VEC_LOAD(P) _mm256_loadu_ps(P)
+#define WR_VEC_STORE(P,V) _mm256_storeu_ps(P,V)
+#define WR_VEC_SET1(F) _mm256_set1_ps(F)
+#define WR_VEC_ADD(A,B) _mm256_add_ps(A,B)
+#define WR_VEC_MUL(A,B) _mm256_mul_ps(A,B)
+#define WR_VEC_MIN(A,B) _mm256_min_ps(A,B)
+#define WR_VEC_MAX(A,B) _mm256_max_ps(A,B)
+
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+
+#include <emmintrin.h>
+#define WR_VEC_WIDTH 4
+typedef __m128 WRVecF;
+#define WR_VEC_LOAD(P) _mm_loadu_ps(P)
+#define WR_VEC_STORE(P,V) _mm_storeu_ps(P,V)
+#define WR_VEC_SET1(F) _mm_set1_ps(F)
+#define WR_VEC_ADD(A,B) _mm_add_ps(A,B)
+#define WR_VEC_MUL(A,B) _mm_mul_ps(A,B)
+#define WR_VEC_MIN(A,B) _mm_min_ps(A,B)
+#define WR_VEC_MAX(A,B) _mm_max_ps(A,B)
+
+#endif
+#endif
+
+enum WRVecOp
+{
+	WRVec_Add,
+	WRVec_Mul,
+};
+
+//------------------------------------------------------------------------------
+static void vecAddF( float* a, const float* b, const uint32_t n )
+{
+	uint32_t i = 0;
+#ifdef WR_VEC_WIDTH
+	for( ; i + WR_VEC_WIDTH <= n; i += WR_VEC_WIDTH )
+	{
+		WR_VEC_STORE( a + i, WR_VEC_ADD(WR_VEC_LOAD(a + i), WR_VEC_LOAD(b + i)) );
+	}
+#endif
+	for( ; i<n; ++i )
+	{
+		a[i] += b[i];
+	}
+}
+
+//------------------------------------------------------------------------------
+static void vecMulF( float* a, const float* b, const uint32_t n )
+{
+	uint32_t i = 0;
+#ifdef WR_VEC_WIDTH
+	for( ; i + WR_VEC_WIDTH <= n; i += WR_VEC_WIDTH )
+	{
+		WR_VEC_STORE( a + i, WR_VEC_MUL(WR_VEC_LOAD(a + i), WR_VEC_LOAD(b + i)) );
+	}
+#endif
+	for( ; i<n; ++i )
+	{
+		a[i] *= b[i];
+	}
+}
+
+//------------------------------------------------------------------------------
+// a = a*scale + bias, add and mul by a constant are this too
+static void vecScaleF( float* a, const float scale, const float bias, const uint32_t n )
+{
+	uint32_t i = 0;
+#ifdef WR_VEC_WIDTH
+	const WRVecF S = WR_VEC_SET1( scale );
+	const WRVecF B = WR_VEC_SET1( bias );
+	for( ; i + WR_VEC_WIDTH <= n; i += WR_VEC_WIDTH )
+	{
+		WR_VEC_STORE( a + i, WR_VEC_ADD(WR_VEC_MUL(WR_VEC_LOAD(a + i), S), B) );
+	}
+#endif
+	for( ; i<n; ++i )
+	{
+		a[i] = a[i]*scale + bias;
+	}
+}
+
+//------------------------------------------------------------------------------
+static void vecClampF( float* a, const float lo, const float hi, const uint32_t n )
+{
+	uint32_t i = 0;
+#ifdef WR_VEC_WIDTH
+	const WRVecF L = WR_VEC_SET1( lo );
+	const WRVecF H = WR_VEC_SET1( hi );
+	for( ; i + WR_VEC_WIDTH <= n; i += WR_VEC_WIDTH )
+	{
+		WR_VEC_STORE( a + i, WR_VEC_MIN(WR_VEC_MAX(WR_VEC_LOAD(a + i), L), H) );
+	}
+#endif
+	for( ; i<n; ++i )
+	{
+		a[i] = a[i] < lo ? lo : (a[i] > hi ? hi : a[i]);
+	}
+}
+
+#ifdef WR_VEC_WIDTH
+//------------------------------------------------------------------------------
+static float vecLanes( const WRVecF V, const int op )
+{
+	float lane[WR_VEC_WIDTH];
+	WR_VEC_STORE( lane, V );
+
+	float ret = lane[0];
+	for( int l=1; l<WR_VEC_WIDTH; ++l )
+	{
+		if ( op == 0 )
+		{
+			ret += lane[l];
+		}
+		else if ( op < 0 )
+		{
+			ret = lane[l] < ret ? lane[l] : ret;
+		}
+		else
+		{
+			ret = lane[l] > ret ? lane[l] : ret;
+		}
+	}
+	return ret;
+}
+#endif
+
+//------------------------------------------------------------------------------
+// b null for a plain sum
+static float vecDotF( const float* a, const float* b, const uint32_t n )
+{
+	uint32_t i = 0;
+	float ret = 0;
+#ifdef WR_VEC_WIDTH
+	if ( n >= WR_VEC_WIDTH )
+	{
+		WRVecF acc = WR_VEC_SET1( 0.f );
+		for( ; i + WR_VEC_WIDTH <= n; i += WR_VEC_WIDTH )
+		{
+			acc = WR_VEC_ADD( acc, b ? WR_VEC_MUL(WR_VEC_LOAD(a + i), WR_VEC_LOAD(b + i)) : WR_VEC_LOAD(a + i) );
+		}
+		ret = vecLanes( acc, 0 );
+	}
+#endif
+	for( ; i<n; ++i )
+	{
+		ret += b ? a[i]*b[i] : a[i];
+	}
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// op < 0 for the minimum, > 0 for the maximum, n must not be zero
+static float vecExtremeF( const float* a, const uint32_t n, const int op )
+{
+	uint32_t i = 0;
+	float ret = a[0];
+#ifdef WR_VEC_WIDTH
+	if ( n >= WR_VEC_WIDTH )
+	{
+		WRVecF acc = WR_VEC_LOAD( a );
+		for( i = WR_VEC_WIDTH; i + WR_VEC_WIDTH <= n; i += WR_VEC_WIDTH )
+		{
+			acc = (op < 0) ? WR_VEC_MIN( acc, WR_VEC_LOAD(a + i) ) : WR_VEC_MAX( acc, WR_VEC_LOAD(a + i) );
+		}
+		ret = vecLanes( acc, op );
+	}
+#endif
+	for( ; i<n; ++i )
+	{
+		if ( (op < 0) ? (a[i] < ret) : (a[i] > ret) )
+		{
+			ret = a[i];
+		}
+	}
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+template<class T> static void vecBinaryI( T* a, const T* b, const uint32_t n, const int op )
+{
+	// unsigned so overflow wraps instead of being undefined
+	if ( op == WRVec_Add )
+	{
+		for( uint32_t i=0; i<n; ++i ) { a[i] = (T)((uint32_t)a[i] + (uint32_t)b[i]); }
+	}
+	else
+	{
+		for( uint32_t i=0; i<n; ++i ) { a[i] = (T)((uint32_t)a[i] * (uint32_t)b[i]); }
+	}
+}
+
+//------------------------------------------------------------------------------
+template<class T> static void vecScaleI( T* a, const int32_t scale, const int32_t bias, const uint32_t n )
+{
+	for( uint32_t i=0; i<n; ++i )
+	{
+		a[i] = (T)((uint32_t)a[i]*(uint32_t)scale + (uint32_t)bias);
+	}
+}
+
+//------------------------------------------------------------------------------
+template<class T> static void vecClampI( T* a, const int32_t lo, const int32_t hi, const uint32_t n )
+{
+	for( uint32_t i=0; i<n; ++i )
+	{
+		a[i] = (T)((a[i] < lo) ? lo : ((a[i] > hi) ? hi : a[i]));
+	}
+}
+
+//------------------------------------------------------------------------------
+template<class T> static int32_t vecDotI( const T* a, const T* b, const uint32_t n )
+{
+	uint32_t ret = 0;
+	for( uint32_t i=0; i<n; ++i )
+	{
+		ret += b ? (uint32_t)a[i]*(uint32_t)b[i] : (uint32_t)a[i];
+	}
+	return (int32_t)ret;
+}
+
+//------------------------------------------------------------------------------
+template<class T> static int32_t vecExtremeI( const T* a, const uint32_t n, const int op )
+{
+	T ret = a[0];
+	for( uint32_t i=1; i<n; ++i )
+	{
+		if ( (op < 0) ? (a[i] < ret) : (a[i] > ret) )
+		{
+			ret = a[i];
+		}
+	}
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// the array (if any) an argument refers to
+static WRGCObject* vecArray( const WRValue* arg )
+{
+	const WRValue& V = arg->deref();
+	return IS_ARRAY(V.xtype) ? V.va : 0;
+}
+
+//------------------------------------------------------------------------------
+static void vecGet( const WRGCObject* va, const uint32_t i, WRValue* to )
+{
+	if ( va->m_type == SV_VALUE )
+	{
+		*to = va->m_Vdata[i].deref();
+	}
+	else
+	{
+		wr_unpackElement( va, i, to );
+	}
+}
+
+//------------------------------------------------------------------------------
+static void vecSet( WRGCObject* va, const uint32_t i, const WRValue* from )
+{
+	if ( va->m_type == SV_VALUE )
+	{
+		va->m_Vdata[i] = *from;
+	}
+	else
+	{
+		wr_packElement( va, i, from );
+	}
+}
+
+//------------------------------------------------------------------------------
+// element by element for mixed types and plain wrench arrays, the result
+// is float if either side is
+static void vecBinaryAny( WRGCObject* a, const WRGCObject* b, const WRValue* scalar, const WRValue* bias, const uint32_t n, const int op )
+{
+	WRValue x;
+	WRValue y;
+	y.init();
+	if ( scalar )
+	{
+		y = *scalar;
+	}
+
+	for( uint32_t i=0; i<n; ++i )
+	{
+		vecGet( a, i, &x );
+		if ( b )
+		{
+			vecGet( b, i, &y );
+		}
+
+		if ( x.type == WR_FLOAT || y.type == WR_FLOAT || (bias && bias->type == WR_FLOAT) )
+		{
+			x.f = (op == WRVec_Add) ? x.asFloat() + y.asFloat() : x.asFloat() * y.asFloat();
+			if ( bias )
+			{
+				x.f += bias->asFloat();
+			}
+			x.p2 = INIT_AS_FLOAT;
+		}
+		else
+		{
+			x.i = (op == WRVec_Add) ? x.asInt() + y.asInt() : x.asInt() * y.asInt();
+			if ( bias )
+			{
+				x.i += bias->asInt();
+			}
+			x.p2 = INIT_AS_INT;
+		}
+
+		vecSet( a, i, &x );
+	}
+}
+
+//------------------------------------------------------------------------------
+// vec::add( a, b ) and vec::mul( a, b ): 'a' is updated in place with
+// the elementwise result and returned, 'b' is an array or a number
+static void vecBinary( WRValue* stackTop, const int argn, const int op )
+{
+	WRGCObject* a;
+	if ( argn < 2 || !(a = vecArray(stackTop - argn)) )
+	{
+		return;
+	}
+
+	WRValue* args = stackTop - argn;
+	*stackTop = args->deref();
+
+	const WRGCObject* b = vecArray( args + 1 );
+	uint32_t n = a->m_size;
+
+	if ( !b )
+	{
+		WRValue S = args[1].deref();
+		if ( a->m_type == SV_FLOAT32 )
+		{
+			if ( op == WRVec_Add )
+			{
+				vecScaleF( a->m_Fdata, 1.f, S.asFloat(), n );
+			}
+			else
+			{
+				vecScaleF( a->m_Fdata, S.asFloat(), 0.f, n );
+			}
+		}
+		else if ( a->m_type == SV_INT32 && S.type == WR_INT )
+		{
+			vecScaleI( a->m_Idata, (op == WRVec_Add) ? 1 : S.i, (op == WRVec_Add) ? S.i : 0, n );
+		}
+		else if ( (a->m_type == SV_UINT8 || a->m_type == SV_CHAR) && S.type == WR_INT )
+		{
+			vecScaleI( a->m_Cdata, (op == WRVec_Add) ? 1 : S.i, (op == WRVec_Add) ? S.i : 0, n );
+		}
+		else
+		{
+			vecBinaryAny( a, 0, &S, 0, n, op );
+		}
+		return;
+	}
+
+	if ( b->m_size < n )
+	{
+		n = b->m_size;
+	}
+
+	if ( a->m_type != b->m_type || a->m_type == SV_VALUE )
+	{
+		vecBinaryAny( a, b, 0, 0, n, op );
+	}
+	else if ( a->m_type == SV_FLOAT32 )
+	{
+		if ( op == WRVec_Add )
+		{
+			vecAddF( a->m_Fdata, b->m_Fdata, n );
+		}
+		else
+		{
+			vecMulF( a->m_Fdata, b->m_Fdata, n );
+		}
+	}
+	else if ( a->m_type == SV_INT32 )
+	{
+		vecBinaryI( a->m_Idata, b->m_Idata, n, op );
+	}
+	else
+	{
+		vecBinaryI( a->m_Cdata, b->m_Cdata, n, op );
+	}
+}
+
+//------------------------------------------------------------------------------
+void wr_vecAdd( WRValue* stackTop, const int argn, WRContext* c )
+{
+	vecBinary( stackTop, argn, WRVec_Add );
+}
+
+//------------------------------------------------------------------------------
+void wr_vecMul( WRValue* stackTop, const int argn, WRContext* c )
+{
+	vecBinary( stackTop, argn, WRVec_Mul );
+}
+
+//------------------------------------------------------------------------------
+// vec::scale( a, s, [bias] ): a[i] = a[i]*s + bias in place, returns 'a'
+void wr_vecScale( WRValue* stackTop, const int argn, WRContext* c )
+{
+	WRGCObject* a;
+	if ( argn < 2 || !(a = vecArray(stackTop - argn)) )
+	{
+		return;
+	}
+
+	WRValue* args = stackTop - argn;
+	*stackTop = args->deref();
+
+	WRValue S = args[1].deref();
+	WRValue B;
+	B.init();
+	if ( argn > 2 )
+	{
+		B = args[2].deref();
+	}
+
+	if ( a->m_type == SV_FLOAT32 )
+	{
+		vecScaleF( a->m_Fdata, S.asFloat(), B.asFloat(), a->m_size );
+	}
+	else if ( a->m_type == SV_INT32 && S.type == WR_INT && B.type == WR_INT )
+	{
+		vecScaleI( a->m_Idata, S.i, B.i, a->m_size );
+	}
+	else if ( (a->m_type == SV_UINT8 || a->m_type == SV_CHAR) && S.type == WR_INT && B.type == WR_INT )
+	{
+		vecScaleI( a->m_Cdata, S.i, B.i, a->m_size );
+	}
+	else
+	{
+		vecBinaryAny( a, 0, &S, &B, a->m_size, WRVec_Mul );
+	}
+}
+
+//------------------------------------------------------------------------------
+// vec::clamp( a, lo, hi ) in place, returns 'a'
+void wr_vecClamp( WRValue* stackTop, const int argn, WRContext* c )
+{
+	WRGCObject* a;
+	if ( argn < 3 || !(a = vecArray(stackTop - argn)) )
+	{
+		return;
+	}
+
+	WRValue* args = stackTop - argn;
+	*stackTop = args->deref();
+
+	// copies, deref() of an element can share storage
+	const WRValue L = args[1].deref();
+	const WRValue H = args[2].deref();
+
+	if ( a->m_type == SV_FLOAT32 )
+	{
+		vecClampF( a->m_Fdata, L.asFloat(), H.asFloat(), a->m_size );
+	}
+	else if ( a->m_type == SV_INT32 )
+	{
+		vecClampI( a->m_Idata, L.asInt(), H.asInt(), a->m_size );
+	}
+	else if ( a->m_type == SV_UINT8 || a->m_type == SV_CHAR )
+	{
+		vecClampI( a->m_Cdata, L.asInt(), H.asInt(), a->m_size );
+	}
+	else
+	{
+		const bool isFloat = L.type == WR_FLOAT || H.type == WR_FLOAT;
+		WRValue x;
+		for( uint32_t i=0; i<a->m_size; ++i )
+		{
+			vecGet( a, i, &x );
+			if ( isFloat || x.type == WR_FLOAT )
+			{
+				const float f = x.asFloat();
+				x.f = f < L.asFloat() ? L.asFloat() : (f > H.asFloat() ? H.asFloat() : f);
+				x.p2 = INIT_AS_FLOAT;
+			}
+			else
+			{
+				const int v = x.asInt();
+				x.i = v < L.asInt() ? L.asInt() : (v > H.asInt() ? H.asInt() : v);
+				x.p2 = INIT_AS_INT;
+			}
+			vecSet( a, i, &x );
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// sum of a[i]*b[i], or of a[i] when b is null
+static void vecDot( WRValue* stackTop, const WRGCObject* a, const WRGCObject* b )
+{
+	uint32_t n = a->m_size;
+	if ( b && b->m_size < n )
+	{
+		n = b->m_size;
+	}
+
+	stackTop->p2 = INIT_AS_INT;
+	stackTop->i = 0;
+
+	if ( (!b || b->m_type == a->m_type) && a->m_type == SV_FLOAT32 )
+	{
+		stackTop->p2 = INIT_AS_FLOAT;
+		stackTop->f = vecDotF( a->m_Fdata, b ? b->m_Fdata : 0, n );
+	}
+	else if ( (!b || b->m_type == a->m_type) && a->m_type == SV_INT32 )
+	{
+		stackTop->i = vecDotI( a->m_Idata, b ? b->m_Idata : 0, n );
+	}
+	else if ( (!b || b->m_type == a->m_type) && (a->m_type == SV_UINT8 || a->m_type == SV_CHAR) )
+	{
+		stackTop->i = vecDotI( a->m_Cdata, b ? b->m_Cdata : 0, n );
+	}
+	else
+	{
+		WRValue x;
+		WRValue y;
+		y.init( 1 );
+		for( uint32_t i=0; i<n; ++i )
+		{
+			vecGet( a, i, &x );
+			if ( b )
+			{
+				vecGet( b, i, &y );
+			}
+
+			if ( stackTop->type == WR_FLOAT || x.type == WR_FLOAT || y.type == WR_FLOAT )
+			{
+				stackTop->f = stackTop->asFloat() + x.asFloat()*y.asFloat();
+				stackTop->p2 = INIT_AS_FLOAT;
+			}
+			else
+			{
+				stackTop->i += x.asInt()*y.asInt();
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// vec::dot( a, b )
+void wr_vecDot( WRValue* stackTop, const int argn, WRContext* c )
+{
+	WRGCObject* a;
+	WRGCObject* b;
+	if ( argn >= 2 && (a = vecArray(stackTop - argn)) && (b = vecArray(stackTop - argn + 1)) )
+	{
+		vecDot( stackTop, a, b );
+	}
+}
+
+//------------------------------------------------------------------------------
+// vec::sum( a )
+void wr_vecSum( WRValue* stackTop, const int argn, WRContext* c )
+{
+	WRGCObject* a;
+	if ( argn >= 1 && (a = vecArray(stackTop - argn)) )
+	{
+		vecDot( stackTop, a, 0 );
+	}
+}
+
+//------------------------------------------------------------------------------
+static void vecExtreme( WRValue* stackTop, const int argn, const int op )
+{
+	WRGCObject* a;
+	if ( argn < 1 || !(a = vecArray(stackTop - argn)) || !a->m_size )
+	{
+		return;
+	}
+
+	if ( a->m_type == SV_FLOAT32 )
+	{
+		stackTop->p2 = INIT_AS_FLOAT;
+		stackTop->f = vecExtremeF( a->m_Fdata, a->m_size, op );
+	}
+	else if ( a->m_type == SV_INT32 )
+	{
+		stackTop->p2 = INIT_AS_INT;
+		stackTop->i = vecExtremeI( a->m_Idata, a->m_size, op );
+	}
+	else if ( a->m_type == SV_UINT8 || a->m_type == SV_CHAR )
+	{
+		stackTop->p2 = INIT_AS_INT;
+		stackTop->i = vecExtremeI( a->m_Cdata, a->m_size, op );
+	}
+	else
+	{
+		WRValue x;
+		vecGet( a, 0, stackTop );
+		for( uint32_t i=1; i<a->m_size; ++i )
+		{
+			vecGet( a, i, &x );
+			if ( (op < 0) ? (x.asFloat() < stackTop->asFloat()) : (x.asFloat() > stackTop->asFloat()) )
+			{
+				*stackTop = x;
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// vec::min( a )
+void wr_vecMin( WRValue* stackTop, const int argn, WRContext* c )
+{
+	vecExtreme( stackTop, argn, -1 );
+}
+
+//------------------------------------------------------------------------------
+// vec::max( a )
+void wr_vecMax( WRValue* stackTop, const int argn, WRContext* c )
+{
+	vecExtreme( stackTop, argn, 1 );
+}
+
+//------------------------------------------------------------------------------
+// vec::float32( count ) or vec::float32( array ) to convert one, same
+// for int32 and uint8
+static void vecMake( WRValue* stackTop, const int argn, WRContext* c, const char type )
+{
+	const WRGCObject* from = 0;
+	int count = 0;
+	if ( argn >= 1 && !(from = vecArray(stackTop - argn)) )
+	{
+		count = (stackTop - argn)->asInt();
+	}
+
+	if ( from )
+	{
+		count = from->m_size;
+	}
+
+	wr_makeTypedArray( c, stackTop, count > 0 ? count : 0, type );
+
+	if ( from && IS_ARRAY(stackTop->xtype) )
+	{
+		WRValue x;
+		for( uint32_t i=0; i<from->m_size; ++i )
+		{
+			vecGet( from, i, &x );
+			wr_packElement( stackTop->va, i, &x );
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+void wr_vecInt32( WRValue* stackTop, const int argn, WRContext* c )
+{
+	vecMake( stackTop, argn, c, SV_INT32 );
+}
+
+//------------------------------------------------------------------------------
+void wr_vecFloat32( WRValue* stackTop, const int argn, WRContext* c )
+{
+	vecMake( stackTop, argn, c, SV_FLOAT32 );
+}
+
+//------------------------------------------------------------------------------
+void wr_vecUint8( WRValue* stackTop, const int argn, WRContext* c )
+{
+	vecMake( stackTop, argn, c, SV_UINT8 );
+}
+
+//------------------------------------------------------------------------------
+void wr_loadVecLib( WRState* w )
+{
+	wr_registerLibraryFunction( w, "vec::int32", wr_vecInt32 );
+	wr_registerLibraryFunction( w, "vec::float32", wr_vecFloat32 );
+	wr_registerLibraryFunction( w, "vec::uint8", wr_vecUint8 );
+
+	wr_registerLibraryFunction( w, "vec::add", wr_vecAdd );
+	wr_registerLibraryFunction( w, "vec::mul", wr_vecMul );
+	wr_registerLibraryFunction( w, "vec::scale", wr_vecScale );
+	wr_registerLibraryFunction( w, "vec::clamp", wr_vecClamp );
+	wr_registerLibraryFunction( w, "vec::dot", wr_vecDot );
+	wr_registerLibraryFunction( w, "vec::sum", wr_vecSum );
+	wr_registerLibraryFunction( w, "vec::min", wr_vecMin );
+	wr_registerLibraryFunction( w, "vec::max", wr_vecMax );
+}
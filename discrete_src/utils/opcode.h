@@ -332,6 +332,8 @@ enum WROpcode
 	O_GlobalBZ,
 	O_GlobalBZ8,
 
+	O_Wide, // followed by a WRWideOpcode
+
 	// non-interpreted opcodes
 	O_HASH_PLACEHOLDER,
 	O_FUNCTION_CALL_PLACEHOLDER,
@@ -341,4 +343,89 @@ enum WROpcode
 
 extern const char* c_opcodeName[];
 
+//------------------------------------------------------------------------------
+// operations whose operands do not fit the 8-bit encodings above, only
+// emitted when they have to be. 'shape' bit 0 set means the first
+// operand is a local, bit 1 the second
+enum WRWideOpcode
+{
+	W_LoadFromLocal = 0, // index16
+	W_LoadFromGlobal, // index16
+
+	W_CallFunctionByIndex, // args8 function16, returns to the next byte
+	W_CallFunctionByIndexSkip1, // args8 function16, returns one byte past it
+
+	W_PushIterator, // shape8 from16 iterator16
+	W_NextValueOrJump, // shape8 value16 iterator16 rel16
+	W_NextKeyValueOrJump, // shape8 key16 value16 iterator16 rel16
+
+	W_SwitchDense, // base32 count16 default16 [count * rel16]
+
+	W_TailCall, // args8 function16 pad8, reuses the caller's frame
+
+	W_PopToLocal, // index16, moves the top of the stack into a local untouched
+
+	// WR_OPTIMIZE proved every local named holds the type given, so
+	// these skip the type dispatch of the forms they replace
+	W_IntLLCompareLTBZ, // l8 l8 rel16
+	W_IntLLCompareLEBZ, // l8 l8 rel16
+	W_IntLLCompareGTBZ, // l8 l8 rel16
+	W_IntLLCompareGEBZ, // l8 l8 rel16
+	W_IntLLCompareEQBZ, // l8 l8 rel16
+	W_IntLLCompareNEBZ, // l8 l8 rel16
+
+	W_IntLICompareLTBZ, // l8 imm16 rel16
+	W_IntLICompareLEBZ, // l8 imm16 rel16
+	W_IntLICompareGTBZ, // l8 imm16 rel16
+	W_IntLICompareGEBZ, // l8 imm16 rel16
+	W_IntLICompareEQBZ, // l8 imm16 rel16
+	W_IntLICompareNEBZ, // l8 imm16 rel16
+
+	W_IntLCountLTBZ, // l8 l8 rel16, the first local against the count of the second
+
+	W_IntLLAddition, // l8 l8
+	W_IntLLSubtraction, // l8 l8
+	W_IntLLMultiplication, // l8 l8
+
+	W_FloatLLAddition, // l8 l8
+	W_FloatLLSubtraction, // l8 l8
+	W_FloatLLMultiplication, // l8 l8
+	W_FloatLLDivision, // l8 l8
+
+	// the sequences "wrench prof" found dispatched most, each doing
+	// what the instructions it replaces would have in one go
+	W_IncLocalLLCompareLT, // l8 l8 rel16, ++ the second local then jump while it is below the first
+	W_LLIndex, // l8 l8, LLValues + IndexSkipLoad
+	W_LLIndexHashPair, // l8 hash32 l8 hash32, LocalIndexHash twice + StackSwap 2
+
+	W_LAST,
+};
+
+extern const char* c_wideOpcodeName[];
+
+#ifdef WRENCH_OPCODE_PROFILE
+//------------------------------------------------------------------------------
+// an O_Wide instruction is counted as O_LAST + its sub-op
+#define WR_PROFILE_CODES ((int)O_LAST + (int)W_LAST)
+#define WR_PROFILE_TRIPLES 8192 // must be a power of 2
+
+struct WRProfileTriple
+{
+	uint32_t key; // (a*WR_PROFILE_CODES + b)*WR_PROFILE_CODES + c + 1, 0 when unused
+	uint64_t count;
+};
+
+struct WROpcodeProfile
+{
+	uint64_t total;
+	uint64_t lostTriples; // seen after the triple table filled up
+	uint32_t triplesUsed;
+	uint32_t last[2]; // the two instructions before this one, WR_PROFILE_CODES for none
+
+	uint64_t single[ WR_PROFILE_CODES ];
+	uint64_t pair[ WR_PROFILE_CODES * WR_PROFILE_CODES ];
+	WRProfileTriple triple[ WR_PROFILE_TRIPLES ];
+};
+#endif
+
 #endif
@@ -53,15 +53,36 @@ bool wr_serializeEx( WRValueSerializer& serializer, const WRValue& val )
 			{
 				case WR_EX_ARRAY:
 				{
-					serializer.write( &(temp = value.va->m_type), 1 );
-					temp16 = wr_x16( value.va->m_size );
-					serializer.write( (char*)&temp16, 2 );
+					// sizes that don't fit in 16 bits flag the type byte
+					// and follow it with 32, older streams never set it
+					if ( value.va->m_size > 0xFFFF )
+					{
+						serializer.write( &(temp = (char)(value.va->m_type | WR_SERIALIZE_SIZE32)), 1 );
+						temp32 = wr_x32( value.va->m_size );
+						serializer.write( (char*)&temp32, 4 );
+					}
+					else
+					{
+						serializer.write( &(temp = value.va->m_type), 1 );
+						temp16 = wr_x16( (uint16_t)value.va->m_size );
+						serializer.write( (char*)&temp16, 2 );
+					}
 
-					if ( value.va->m_type == SV_CHAR )
+					if ( value.va->m_type == SV_CHAR || value.va->m_type == SV_UINT8 )
 					{
 						serializer.write( value.va->m_SCdata, value.va->m_size );
 						return true;
 					}
+					else if ( value.va->m_type == SV_INT32 || value.va->m_type == SV_FLOAT32 )
+					{
+						// both are four bytes, swapped the same way
+						for( uint32_t i=0; i<value.va->m_size; ++i )
+						{
+							temp32 = wr_x32( (uint32_t)value.va->m_Idata[i] );
+							serializer.write( (char*)&temp32, 4 );
+						}
+						return true;
+					}
 					else if ( value.va->m_type == SV_VALUE )
 					{
 						for( uint32_t i=0; i<value.va->m_size; ++i )
@@ -78,16 +99,20 @@ bool wr_serializeEx( WRValueSerializer& serializer, const WRValue& val )
 
 				case WR_EX_HASH_TABLE:
 				{
-					temp16 = wr_x16( value.va->m_mod );
+					if ( value.va->m_size > 0xFFFF )
+					{
+						return false; // entry count is 16 bits
+					}
+
+					temp16 = wr_x16( (uint16_t)value.va->m_size );
 					serializer.write( (char *)&temp16, 2 );
 
-					for( uint32_t i=0; i<value.va->m_mod; ++i )
+					// only live entries are written, each still flagged
+					// so older streams (which flagged empty slots) read
+					// the same way
+					for( uint32_t i=0; i<value.va->m_capacity; ++i )
 					{
-						if ( value.va->m_hashTable[i] == WRENCH_NULL_HASH )
-						{
-							serializer.write( &(temp = 0), 1 );
-						}
-						else
+						if ( value.va->m_hashTable[i] != WRENCH_NULL_HASH )
 						{
 							serializer.write( &(temp = 1), 1 );
 
@@ -141,20 +166,45 @@ bool wr_deserializeEx( WRValue& value, WRValueSerializer& serializer, WRContext*
 			{
 				case WR_EX_ARRAY:
 				{
-					if ( !serializer.read(&temp, 1)  // type
-						 || !serializer.read((char *)&temp16, 2) ) // size
+					uint32_t size;
+					if ( !serializer.read(&temp, 1) ) // type
+					{
+						return false;
+					}
+
+					if ( temp & WR_SERIALIZE_SIZE32 )
+					{
+						temp &= ~WR_SERIALIZE_SIZE32;
+						if ( !serializer.read((char *)&size, 4) )
+						{
+							return false;
+						}
+						size = wr_x32( size );
+					}
+					else
+					{
+						if ( !serializer.read((char *)&temp16, 2) )
+						{
+							return false;
+						}
+						size = wr_x16( temp16 );
+					}
+
+					// every element takes at least a byte, don't trust a
+					// size the rest of the stream can't hold
+					if ( size > serializer.remaining() )
 					{
 						return false;
 					}
 
-					temp16 = wr_x16( temp16 );
 					value.p2 = INIT_AS_ARRAY;
 					
 					switch( (uint8_t)temp )
 					{
 						case SV_CHAR:
+						case SV_UINT8:
 						{
-							value.va = context->getSVA( temp16, SV_CHAR, false );
+							value.va = context->getSVA( size, (WRGCObjectType)temp, false );
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
 							if ( !value.va )
 							{
@@ -162,16 +212,39 @@ bool wr_deserializeEx( WRValue& value, WRValueSerializer& serializer, WRContext*
 								return false;
 							}
 #endif
-							if ( !serializer.read(value.va->m_SCdata, temp16) )
+							if ( !serializer.read(value.va->m_SCdata, size) )
 							{
 								return false;
 							}
 							return true;
 						}
 
+						case SV_INT32:
+						case SV_FLOAT32:
+						{
+							value.va = context->getSVA( size, (WRGCObjectType)temp, false );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+							if ( !value.va )
+							{
+								value.p2 = INIT_AS_INT;
+								return false;
+							}
+#endif
+							for( uint32_t i=0; i<size; ++i )
+							{
+								uint32_t temp32;
+								if ( !serializer.read((char *)&temp32, 4) )
+								{
+									return false;
+								}
+								value.va->m_Idata[i] = (int32_t)wr_x32( temp32 );
+							}
+							return true;
+						}
+
 						case SV_VALUE:
 						{
-							value.va = context->getSVA( temp16, SV_VALUE, false );
+							value.va = context->getSVA( size, SV_VALUE, false );
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
 							if ( !value.va )
 							{
@@ -179,7 +252,7 @@ bool wr_deserializeEx( WRValue& value, WRValueSerializer& serializer, WRContext*
 								return false;
 							}
 #endif
-							for( uint16_t i=0; i<temp16; ++i )
+							for( uint32_t i=0; i<size; ++i )
 							{
 								if ( !wr_deserializeEx(value.va->m_Vdata[i], serializer, context) )
 								{
@@ -203,7 +276,7 @@ bool wr_deserializeEx( WRValue& value, WRValueSerializer& serializer, WRContext*
 
 					temp16 = wr_x16( temp16 );
 					
-					value.va = context->getSVA( temp16 - 1, SV_HASH_TABLE, false );
+					value.va = context->getSVA( temp16, SV_HASH_TABLE, false );
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
 					if ( !value.va )
 					{
@@ -221,20 +294,19 @@ bool wr_deserializeEx( WRValue& value, WRValueSerializer& serializer, WRContext*
 							return false;
 						}
 
-						if ( !temp )
+						if ( temp )
 						{
-							value.va->m_Vdata[i<<1].init();
-							value.va->m_Vdata[(i<<1) + 1].init();
-							value.va->m_hashTable[i] = WRENCH_NULL_HASH;
-						}
-						else
-						{
-							if ( !wr_deserializeEx(value.va->m_Vdata[i<<1], serializer, context)
-								 || !wr_deserializeEx(value.va->m_Vdata[(i<<1)+1], serializer, context) )
+							WRValue V( 0 );
+							WRValue K( 0 );
+							if ( !wr_deserializeEx(V, serializer, context)
+								 || !wr_deserializeEx(K, serializer, context) )
 							{
 								return false;
 							}
-							value.va->m_hashTable[i] = value.va->m_Vdata[(i<<1)+1].getHash();
+
+							WRValue* entry = (WRValue*)value.va->get( K.getHash() );
+							entry[0] = V;
+							entry[1] = K;
 						}
 					}
 					
@@ -29,6 +29,9 @@ struct WRValue;
 struct WRContext;
 class WRValueSerializer;
 
+// set in an array's type byte when its size is written as 32 bits
+#define WR_SERIALIZE_SIZE32 0x80
+
 //------------------------------------------------------------------------------
 bool wr_serializeEx( WRValueSerializer& serializer, const WRValue& val );
 bool wr_deserializeEx( WRValue& value, WRValueSerializer& serializer, WRContext* context );
@@ -68,6 +71,7 @@ public:
 	}
 	
 	int size() const { return m_pos; }
+	unsigned int remaining() const { return m_size - m_pos; }
 	const char* data() const { return m_buf; }
 
 	bool read( char* data, const int size )
@@ -96,7 +100,9 @@ public:
 
 		if ( m_pos + size >= m_size )
 		{
-			m_size += (size*2) + 8;
+			// grow geometrically, large arrays are written one
+			// element at a time
+			m_size += (m_size >> 1) + (size*2) + 8;
 			char* newBuf = (char*)g_malloc( m_size );
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
 			if ( !newBuf )
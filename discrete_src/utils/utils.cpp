@@ -24,6 +24,13 @@ SOFTWARE.
 
 #include "wrench.h"
 
+#ifdef WRENCH_LINUX_FILE_IO
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 void wr_destroyContextEx( WRContext* context );
 
 WR_ALLOC g_malloc = &malloc;
@@ -139,9 +146,10 @@ WRValue* WrenchValue::asArrayMember( const int index )
 	else if ( index >= (int)m_value->va->m_size )
 	{
 		wr_growValueArray( m_value->va, index );
-		m_context->allocatedMemoryHint += index * ((m_value->va->m_type == SV_CHAR) ? 1 : sizeof(WRValue));
+		m_context->allocatedMemoryHint += index * WR_SIZEOF_ELEMENT( m_value->va->m_type );
 	}
 
+	WR_GC_REMEMBER( m_context, m_value->vb );
 	return (WRValue*)m_value->va->get( index );
 }
 
@@ -166,6 +174,8 @@ WRValue* WrenchValue::addHashTableValue( const char* key )
 		m_value->p2 = INIT_AS_HASH_TABLE;
 	}
 
+	WR_GC_REMEMBER( m_context, m_value->vb );
+
 	uint32_t hash = wr_hashStr( key );
 	WRValue* entry = (WRValue*)(m_value->va->exists( hash, false ));
 	if ( !entry )
@@ -202,16 +212,32 @@ WRState* wr_newState( int stackSize )
 #endif
 																		   
 	memset( (unsigned char*)w, 0, sizeof(WRState) );
-	w->globalRegistry.growHash( WRENCH_NULL_HASH, 0 );
+	w->globalRegistry.init( 0, SV_VOID_HASH_TABLE, false );
 
 	w->stackSize = stackSize;
 	w->allocatedMemoryLimit = WRENCH_DEFAULT_ALLOCATED_MEMORY_GC_HINT;
+	w->randomSeed = 0xA5EED;
 
 	w->ctx = (void*)0;
+
+#ifdef WRENCH_OPCODE_PROFILE
+	w->opcodeProfile = (WROpcodeProfile*)g_malloc( sizeof(WROpcodeProfile) );
+	wr_resetOpcodeProfile( w );
+#endif
 	
 	return w;
 }
 
+#ifdef WRENCH_OPCODE_PROFILE
+//------------------------------------------------------------------------------
+void wr_resetOpcodeProfile( WRState* w )
+{
+	memset( (unsigned char*)w->opcodeProfile, 0, sizeof(WROpcodeProfile) );
+	w->opcodeProfile->last[0] = WR_PROFILE_CODES;
+	w->opcodeProfile->last[1] = WR_PROFILE_CODES;
+}
+#endif
+
 //------------------------------------------------------------------------------
 void wr_destroyState( WRState* w )
 {
@@ -228,10 +254,25 @@ void wr_destroyState( WRState* w )
 		wr_destroyContext( w->contextList );
 	}
 
-	wr_freeGCChain( w->globalRegistry.m_nextGC );
-
 	w->globalRegistry.clear();
 
+#ifdef WRENCH_LINUX_FILE_IO
+	while( w->mappedFiles )
+	{
+		WRMappedFile* next = w->mappedFiles->next;
+		wr_releaseMapped( w->mappedFiles );
+		w->mappedFiles = next;
+	}
+#endif
+
+#ifdef WRENCH_POOL_ALLOCATOR
+	wr_destroyPool( w );
+#endif
+
+#ifdef WRENCH_OPCODE_PROFILE
+	g_free( w->opcodeProfile );
+#endif
+
 	g_free( w );
 }
 
@@ -274,36 +315,77 @@ bool wr_executeFunctionZero( WRContext* context )
 }
 
 //------------------------------------------------------------------------------
-WRContext* wr_createContext( WRState* w, const unsigned char* block, const int blockSize, bool takeOwnership, WRValue* stack )
+static void wr_readFunctionTable( const unsigned char* block, const int count, WRFunction* functions )
 {
-	if ( blockSize < 8 )
+	if ( wr_isWideBytecode(block) )
 	{
-		w->err = WR_ERR_bad_bytecode_CRC;
-		return 0;
+		int pos = WR_WIDE_HEADER_SIZE;
+		for( int i=0; i<count; ++i )
+		{
+			functions[i].namespaceOffset = READ_32_FROM_PC( block + pos );
+			functions[i].functionOffset = READ_32_FROM_PC( block + pos + 4 );
+			functions[i].hash = READ_32_FROM_PC( block + pos + 8 );
+			functions[i].arguments = READ_8_FROM_PC( block + pos + 12 );
+			functions[i].frameSpaceNeeded = (uint16_t)READ_16_FROM_PC( block + pos + 13 );
+			functions[i].frameBaseAdjustment = (uint16_t)READ_16_FROM_PC( block + pos + 15 );
+
+			pos += WR_WIDE_FUNCTION_CORE_SIZE;
+		}
+		return;
+	}
+
+	int pos = 3;
+	for( int i=0; i<count; ++i )
+	{
+		functions[i].namespaceOffset = (uint16_t)READ_16_FROM_PC( block + pos );
+		pos += 2;
+		functions[i].functionOffset = (uint16_t)READ_16_FROM_PC( block + pos );
+		pos += 2;
+		functions[i].hash = READ_32_FROM_PC( block + pos );
+		pos += 3;
+		functions[i].arguments = READ_8_FROM_PC( block + ++pos );
+		functions[i].frameSpaceNeeded = READ_8_FROM_PC( block + ++pos );
+		functions[i].frameBaseAdjustment = READ_8_FROM_PC( block + ++pos );
+		
+		++pos;
+	}
+}
+
+//------------------------------------------------------------------------------
+void wr_buildRegistry( WRContext* context )
+{
+	context->flags &= ~WRC_LazyRegistry;
+	for( int i=0; i<context->numLocalFunctions; ++i )
+	{
+		context->registry.getAsRawValueHashTable(context->localFunctions[i].hash)->wrf = context->localFunctions + i;
 	}
+}
 
+//------------------------------------------------------------------------------
+WRContext* wr_createContext( WRState* w, const unsigned char* block, const int blockSize, bool takeOwnership, WRValue* stack, WRFunction* functions )
+{
 	// CRC the code block, at least is it what the compiler intended?
-	uint32_t hash = READ_32_FROM_PC(block + (blockSize - 4));
-	if ( hash != wr_hash_read8(block, (blockSize - 4)) + WRENCH_VERSION_MAJOR )
+	if ( !functions && (blockSize < 8 || !wr_isBytecodeValid(block, blockSize)) )
 	{
 		w->err = WR_ERR_bad_bytecode_CRC;
 		return 0;
 	}
 
-	int globals = READ_8_FROM_PC( block );
-	int localFuncs = READ_8_FROM_PC(block  + 1); // how many?
+	int globals = wr_globalsInBytecode( block );
+	int localFuncs = wr_functionsInBytecode( block ); // how many?
 
-	// 3-byte header + function table + 4-byte CRC must fit in block
-	int headerSize = 3 + (localFuncs * WR_FUNCTION_CORE_SIZE);
+	// header + function table + 4-byte CRC must fit in block
+	int headerSize = wr_functionTableEnd( block );
 	if ( headerSize + 4 > blockSize )
 	{
 		w->err = WR_ERR_bad_bytecode_CRC;
 		return 0;
 	}
-	
+
+	int tableSize = functions ? 0 : (localFuncs * sizeof(WRFunction));
 	int needed = sizeof(WRContext) // class
 				 + (globals * sizeof(WRValue))  // globals
-				 + (localFuncs * sizeof(WRFunction)) // functions
+				 + tableSize // functions
 				 + (stack ? 0 : (w->stackSize * sizeof(WRValue) + (int)sizeof(void*) - 1)); // stack + alignment slop
 
 	WRContext* C = (WRContext *)g_malloc( needed );
@@ -316,7 +398,7 @@ WRContext* wr_createContext( WRState* w, const unsigned char* block, const int b
 #endif
 	
 	memset((char*)C, 0, needed);
-	C->registry.growHash( WRENCH_NULL_HASH, 0 );
+	C->registry.init( 0, SV_VOID_HASH_TABLE, false );
 
 	C->numLocalFunctions = localFuncs;
 	C->localFunctions = (WRFunction *)((uint8_t *)(C + 1) + (globals * sizeof(WRValue)));
@@ -329,19 +411,28 @@ WRContext* wr_createContext( WRState* w, const unsigned char* block, const int b
 	}
 	else
 	{
-		uintptr_t rawStack = (uintptr_t)(C->localFunctions + localFuncs);
+		uintptr_t rawStack = (uintptr_t)C->localFunctions + tableSize;
 		uintptr_t alignedStack = (rawStack + (sizeof(void*) - 1)) & ~((uintptr_t)sizeof(void*) - 1);
 		C->stack = (WRValue*)alignedStack;
 	}
 
-	C->flags |= takeOwnership ? WRC_OwnsMemory : 0;
+	if ( functions )
+	{
+		C->localFunctions = functions;
+	}
+	else
+	{
+		wr_readFunctionTable( block, localFuncs, C->localFunctions );
+	}
+
+	C->flags |= (takeOwnership ? WRC_OwnsMemory : 0) | WRC_LazyRegistry | (wr_isWideBytecode(block) ? WRC_Wide : 0);
 	
 	C->w = w;
 
 	C->bottom = block;
 	C->bottomSize = blockSize;
 
-	C->codeStart = block + 3 + (C->numLocalFunctions * WR_FUNCTION_CORE_SIZE);
+	C->codeStart = block + headerSize;
 
 	uint8_t compilerFlags = READ_8_FROM_PC( block + 2 );
 
@@ -361,24 +452,6 @@ WRContext* wr_createContext( WRState* w, const unsigned char* block, const int b
 		C->codeStart += 4 + READ_32_FROM_PC( C->codeStart );		
 	}
 
-	int pos = 3;
-	for( int i=0; i<C->numLocalFunctions; ++i )
-	{
-		C->localFunctions[i].namespaceOffset = READ_16_FROM_PC( block + pos );
-		pos += 2;
-		C->localFunctions[i].functionOffset = READ_16_FROM_PC( block + pos );
-		pos += 2;
-		C->localFunctions[i].hash = READ_32_FROM_PC( block + pos );
-		pos += 3;
-		C->localFunctions[i].arguments = READ_8_FROM_PC( block + ++pos );
-		C->localFunctions[i].frameSpaceNeeded = READ_8_FROM_PC( block + ++pos );
-		C->localFunctions[i].frameBaseAdjustment = READ_8_FROM_PC( block + ++pos );
-		
-		++pos;
-
-		C->registry.getAsRawValueHashTable(C->localFunctions[i].hash)->wrf = C->localFunctions + i;
-	}
-
 	return C;
 }
 
@@ -407,6 +480,10 @@ WRContext* wr_import( WRContext* context, const unsigned char* block, const int
 		import->imported = context;
 	}
 
+#if WRENCH_CALL_SITE_CACHE
+	++context->w->callSiteGeneration;
+#endif
+
 	return import;
 }
 
@@ -480,15 +557,165 @@ WRContext* wr_run( WRState* w,
 	return context;
 }
 
+#ifdef WRENCH_LINUX_FILE_IO
+//------------------------------------------------------------------------------
+void wr_releaseMapped( WRMappedFile* mapped )
+{
+	if ( !__sync_sub_and_fetch(&mapped->references, 1) )
+	{
+		munmap( (void*)mapped->data, mapped->size );
+		g_free( mapped );
+	}
+}
+
+//------------------------------------------------------------------------------
+static WRMappedFile* wr_mapFile( const char* path, struct stat const& info )
+{
+	if ( info.st_size < 8 || info.st_size > 0x7FFFFFFF )
+	{
+		return 0;
+	}
+
+	int file = open( path, O_RDONLY );
+	if ( file < 0 )
+	{
+		return 0;
+	}
+
+	void* data = mmap( 0, info.st_size, PROT_READ, MAP_SHARED, file, 0 );
+	close( file );
+	if ( data == MAP_FAILED )
+	{
+		return 0;
+	}
+
+	const unsigned char* block = (const unsigned char*)data;
+	const int localFuncs = info.st_size >= WR_WIDE_HEADER_SIZE ? wr_functionsInBytecode( block ) : 0;
+	WRMappedFile* mapped = 0;
+
+	if ( info.st_size >= WR_WIDE_HEADER_SIZE
+		 && wr_functionTableEnd( block ) + 4 <= info.st_size
+		 && wr_isBytecodeValid(block, (unsigned int)info.st_size)
+		 && (mapped = (WRMappedFile*)g_malloc(sizeof(WRMappedFile) + localFuncs*sizeof(WRFunction))) )
+	{
+		mapped->data = block;
+		mapped->size = (uint32_t)info.st_size;
+		mapped->functions = (WRFunction*)(mapped + 1);
+		wr_readFunctionTable( block, localFuncs, mapped->functions );
+	}
+	else
+	{
+		munmap( data, info.st_size );
+	}
+
+	return mapped;
+}
+
+//------------------------------------------------------------------------------
+WRContext* wr_newContextMapped( WRState* w, const char* path )
+{
+	struct stat info;
+	if ( !path || stat(path, &info) )
+	{
+		w->err = WR_ERR_bad_bytecode_CRC;
+		return 0;
+	}
+
+#ifdef __APPLE__
+	const int32_t nsec = (int32_t)info.st_mtimespec.tv_nsec;
+#else
+	const int32_t nsec = (int32_t)info.st_mtim.tv_nsec;
+#endif
+
+	uint32_t pathHash = wr_hashStr( path );
+	WRMappedFile* mapped;
+	for( WRMappedFile** link = &w->mappedFiles; (mapped = *link); )
+	{
+		if ( mapped->inode == (uint64_t)info.st_ino
+			 && mapped->device == (uint64_t)info.st_dev
+			 && mapped->size == (uint32_t)info.st_size
+			 && mapped->mtime == (int64_t)info.st_mtime
+			 && mapped->mtimeNsec == nsec )
+		{
+			break;
+		}
+
+		if ( mapped->pathHash == pathHash )
+		{
+			// an older version of this file, contexts still running it
+			// keep it mapped
+			*link = mapped->next;
+			wr_releaseMapped( mapped );
+			continue;
+		}
+
+		link = &mapped->next;
+	}
+
+	if ( !mapped )
+	{
+		if ( !(mapped = wr_mapFile(path, info)) )
+		{
+			w->err = WR_ERR_bad_bytecode_CRC;
+			return 0;
+		}
+
+		mapped->pathHash = pathHash;
+		mapped->device = (uint64_t)info.st_dev;
+		mapped->inode = (uint64_t)info.st_ino;
+		mapped->mtime = (int64_t)info.st_mtime;
+		mapped->mtimeNsec = nsec;
+		mapped->references = 1;
+		mapped->next = w->mappedFiles;
+		w->mappedFiles = mapped;
+	}
+
+	WRContext* C = wr_createContext( w, mapped->data, mapped->size, false, 0, mapped->functions );
+	if ( C )
+	{
+		__sync_add_and_fetch( &mapped->references, 1 );
+		C->mapped = mapped;
+
+		C->nextStateContextLink = w->contextList;
+		w->contextList = C;
+	}
+	return C;
+}
+
+//------------------------------------------------------------------------------
+WRContext* wr_runMapped( WRState* w, const char* path )
+{
+	WRContext* context = wr_newContextMapped( w, path );
+
+	if ( context && !wr_callFunction(context, (WRFunction*)0) && !context->yield_pc )
+	{
+		wr_destroyContext( context );
+		context = 0;
+	}
+
+	return context;
+}
+#endif
+
 //------------------------------------------------------------------------------
 void wr_destroyContextEx( WRContext* context )
 {
+#if WRENCH_CALL_SITE_CACHE
+	// anything that resolved into this context is now stale
+	++context->w->callSiteGeneration;
+#endif
+
 	// g_free all memory allocations by forcing the gc to collect everything
 	context->globals = 0;
 	context->allocatedMemoryHint = (uint16_t)-1;
 	context->gc( 0 );
 
-	wr_freeGCChain( context->registry.m_nextGC );
+#ifdef WRENCH_GENERATIONAL_GC
+	if ( context->remembered )
+	{
+		g_free( context->remembered );
+	}
+#endif
 
 	context->registry.clear();
 
@@ -497,6 +724,20 @@ void wr_destroyContextEx( WRContext* context )
 		g_free( (void*)(context->bottom) );
 	}
 
+#ifdef WRENCH_QUICKENING
+	if ( context->threaded )
+	{
+		g_free( (void*)context->threaded );
+	}
+#endif
+
+#ifdef WRENCH_LINUX_FILE_IO
+	if ( context->mapped )
+	{
+		wr_releaseMapped( context->mapped );
+	}
+#endif
+
 	g_free( context );
 }
 
@@ -541,6 +782,245 @@ void wr_destroyContext( WRContext* context )
 	}
 }
 
+//------------------------------------------------------------------------------
+bool wr_migrateContext( WRContext* context, WRState* to )
+{
+	if ( !context || !to )
+	{
+		return false;
+	}
+
+	WRContext** link = &context->w->contextList;
+	for( ; *link && *link != context; link = (WRContext**)&(*link)->nextStateContextLink );
+	if ( !*link )
+	{
+		return false;
+	}
+
+	*link = (WRContext*)context->nextStateContextLink;
+	context->nextStateContextLink = to->contextList;
+	to->contextList = context;
+
+	context->w = to;
+	for( WRContext* import = context->imported; import && import != context; import = import->imported )
+	{
+		import->w = to; // the list is circular
+	}
+
+#if WRENCH_CALL_SITE_CACHE
+	// resolved against the old state's registry
+	memset( (char*)context->callSiteCache, 0, sizeof(context->callSiteCache) );
+#endif
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+struct WRCloneEntry
+{
+	WRGCBase* from;
+	WRGCBase* fromNext; // while cloning from->m_nextGC points at the copy
+};
+
+//------------------------------------------------------------------------------
+struct WRClone
+{
+	WRContext* from;
+	WRContext* to;
+	WRCloneEntry* entries; // every object copied, also the work list
+	uint32_t count;
+	uint32_t size;
+	bool failed;
+};
+
+//------------------------------------------------------------------------------
+static WRGCBase* wr_cloneObject( WRClone& C, WRGCBase* from )
+{
+	if ( from->m_flags & GCFlag_Marked )
+	{
+		return from->m_nextGC; // already copied
+	}
+
+	if ( C.count >= C.size )
+	{
+		uint32_t newSize = C.size ? C.size * 2 : 64;
+		WRCloneEntry* newEntries = (WRCloneEntry*)g_malloc( newSize * sizeof(WRCloneEntry) );
+		if ( !newEntries )
+		{
+			C.failed = true;
+			return 0;
+		}
+		if ( C.entries )
+		{
+			memcpy( (char*)newEntries, (char*)C.entries, C.count * sizeof(WRCloneEntry) );
+			g_free( C.entries );
+		}
+		C.entries = newEntries;
+		C.size = newSize;
+	}
+
+	// contents are filled in from the work list
+	WRGCObject* to = C.to->getSVA( ((WRGCObject*)from)->m_size, (WRGCObjectType)from->m_type, false );
+	if ( !to )
+	{
+		C.failed = true;
+		return 0;
+	}
+
+	C.entries[C.count].from = from;
+	C.entries[C.count++].fromNext = from->m_nextGC;
+	from->m_nextGC = to;
+	from->m_flags |= GCFlag_Marked;
+
+	return to;
+}
+
+//------------------------------------------------------------------------------
+static void wr_cloneValue( WRClone& C, WRValue* to, const WRValue* from )
+{
+	WRValue* globals = (WRValue*)(C.from + 1);
+
+	if ( from->type == WR_REF || (from->type == WR_EX && IS_CONTAINER_MEMBER(from->xtype)) )
+	{
+		if ( from->r >= globals && from->r < globals + C.from->globals )
+		{
+			to->p2 = from->p2;
+			to->r = (WRValue*)(C.to + 1) + (from->r - globals);
+		}
+		else if ( from->type == WR_REF )
+		{
+			wr_cloneValue( C, to, from->r ); // anything else is copied by value
+		}
+		else
+		{
+			to->init();
+		}
+	}
+	else if ( from->type == WR_EX && IS_EXARRAY_TYPE(from->xtype) )
+	{
+		to->p2 = from->p2;
+		if ( !(to->vb = wr_cloneObject(C, from->vb)) )
+		{
+			to->init();
+		}
+	}
+	else
+	{
+		to->p = from->p;
+		to->p2 = from->p2;
+	}
+}
+
+//------------------------------------------------------------------------------
+WRContext* wr_cloneContext( WRContext* context )
+{
+	WRState* w = context->w;
+	if ( context->yield_pc || context->imported || !context->stopLocation )
+	{
+		w->err = WR_ERR_context_cannot_be_cloned;
+		return 0;
+	}
+
+	// the decoded function table is shared along with the bytecode
+	WRContext* clone = wr_createContext( w, context->bottom, context->bottomSize, false, 0, context->localFunctions );
+	if ( !clone )
+	{
+		return 0;
+	}
+
+	clone->stopLocation = context->stopLocation;
+	clone->ctxLocal = context->ctxLocal;
+	clone->nextStateContextLink = w->contextList;
+	w->contextList = clone;
+
+#ifdef WRENCH_LINUX_FILE_IO
+	if ( (clone->mapped = context->mapped) )
+	{
+		__sync_add_and_fetch( &clone->mapped->references, 1 );
+	}
+#endif
+
+	WRClone C;
+	C.from = context;
+	C.to = clone;
+	C.entries = 0;
+	C.count = 0;
+	C.size = 0;
+	C.failed = false;
+
+	WRValue* fromGlobals = (WRValue*)(context + 1);
+	WRValue* toGlobals = (WRValue*)(clone + 1);
+	for( int g=0; g<context->globals; ++g )
+	{
+		wr_cloneValue( C, toGlobals + g, fromGlobals + g );
+	}
+
+	// objects are copied breadth first so deep structures don't recurse
+	for( uint32_t e=0; e<C.count && !C.failed; ++e )
+	{
+		WRGCObject* from = (WRGCObject*)C.entries[e].from;
+		WRGCObject* to = (WRGCObject*)from->m_nextGC;
+		to->m_flags |= from->m_flags & GCFlag_Perm;
+
+		if ( from->m_type > SV_VALUE )
+		{
+			memcpy( to->m_Cdata, from->m_Cdata, from->m_size * WR_SIZEOF_ELEMENT(from->m_type) );
+		}
+		else if ( from->m_type == SV_VALUE )
+		{
+			to->m_mod = from->m_mod;
+			if ( from->m_creatorContext != context )
+			{
+				to->m_ROMHashTable = from->m_ROMHashTable; // a struct, points into the shared bytecode
+			}
+
+			for( uint32_t i=0; i<from->m_size; ++i )
+			{
+				wr_cloneValue( C, to->m_Vdata + i, from->m_Vdata + i );
+			}
+		}
+		else
+		{
+			for( uint32_t i=0; i<from->m_capacity; ++i )
+			{
+				if ( from->m_hashTable[i] != WRENCH_NULL_HASH )
+				{
+					WRValue* entry = to->m_Vdata + (to->getIndexOfHit(from->m_hashTable[i]) << 1);
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+					if ( g_mallocFailed )
+					{
+						C.failed = true;
+						break;
+					}
+#endif
+					wr_cloneValue( C, entry, from->m_Vdata + (i<<1) ); // value
+					wr_cloneValue( C, entry + 1, from->m_Vdata + (i<<1) + 1 ); // key
+				}
+			}
+		}
+	}
+
+	for( uint32_t r=0; r<C.count; ++r )
+	{
+		C.entries[r].from->m_nextGC = C.entries[r].fromNext;
+		C.entries[r].from->m_flags &= ~GCFlag_Marked;
+	}
+
+	if ( C.entries )
+	{
+		g_free( C.entries );
+	}
+
+	if ( C.failed )
+	{
+		wr_destroyContext( clone );
+		w->err = WR_ERR_malloc_failed;
+		return 0;
+	}
+
+	return clone;
+}
+
 //------------------------------------------------------------------------------
 bool wr_runCommand( WRState* w, const char* sourceCode, const int size )
 {
@@ -570,6 +1050,9 @@ void wr_registerFunction( WRState* w, const char* name, WR_C_CALLBACK function,
 	WRValue* V = w->globalRegistry.getAsRawValueHashTable( wr_hashStr(name) );
 	V->usr = usr;
 	V->ccb = function;
+#if WRENCH_CALL_SITE_CACHE
+	++w->callSiteGeneration;
+#endif
 }
 
 //------------------------------------------------------------------------------
@@ -723,9 +1206,10 @@ WRValue* WRValue::indexArray( WRContext* context, const uint32_t index, const bo
 		}
 		
 		wr_growValueArray( V.va, index );
-		context->allocatedMemoryHint += index * ((V.va->m_type == SV_CHAR) ? 1 : sizeof(WRValue));
+		context->allocatedMemoryHint += index * WR_SIZEOF_ELEMENT( V.va->m_type );
 	}
 
+	WR_GC_REMEMBER( context, V.vb );
 	return V.va->m_Vdata + index;
 }
 
@@ -852,6 +1336,28 @@ int wr_technicalAsStringEx( char* string, const WRValue* value, size_t pos, size
 
 			pos += snprintf( string + pos, maxLen - pos, "\"" );
 		}
+		else if ( value->va->m_type > SV_CHAR )
+		{
+			pos += snprintf( string + pos, maxLen - pos, "[ " );
+
+			WRValue element;
+			for( uint32_t i=0; pos<maxLen && i<value->va->m_size; ++i )
+			{
+				if ( i )
+				{
+					pos += snprintf( string + pos, maxLen - pos, ", " );
+				}
+				wr_unpackElement( value->va, i, &element );
+				pos = wr_technicalAsStringEx( string, &element, pos, maxLen, valuesInHex );
+			}
+
+			if ( pos >= maxLen )
+			{
+				return maxLen;
+			}
+
+			pos += snprintf( string + pos, maxLen - pos, " ]" );
+		}
 		else
 		{
 			pos += snprintf( string + pos, maxLen - pos, "<raw array>" );
@@ -862,7 +1368,7 @@ int wr_technicalAsStringEx( char* string, const WRValue* value, size_t pos, size
 		pos += snprintf( string + pos, maxLen - pos, "{ " );
 		
 		bool first = true;
-		for( int32_t element=0; element<value->va->m_mod; ++element )
+		for( uint32_t element=0; element<value->va->m_capacity; ++element )
 		{
 			if ( value->va->m_hashTable[element] != WRENCH_NULL_HASH )
 			{
@@ -1009,8 +1515,8 @@ const WRValue::Iterator WRValue::Iterator::operator++()
 	{
 		if ( m_current.type == SV_HASH_TABLE || m_current.type == SV_VOID_HASH_TABLE )
 		{
-			int temp = m_element;
-			for( ; temp < m_va->m_mod; ++temp )
+			uint32_t temp = m_element;
+			for( ; temp < m_va->m_capacity; ++temp )
 			{
 				if ( m_va->m_hashTable[temp] != WRENCH_NULL_HASH )
 				{
@@ -1065,7 +1571,7 @@ WRValue* wr_callFunction( WRContext* context, const int32_t hash, const WRValue*
 			return 0;
 		}
 
-		cF = context->registry.getAsRawValueHashTable( hash );
+		cF = wr_registry( context ).getAsRawValueHashTable( hash );
 		if ( !cF->wrf ) // not found in the registry, but...
 		{
 				cF = context->w->globalRegistry.getAsRawValueHashTable(hash);
@@ -1107,7 +1613,7 @@ WRValue* wr_returnValueFromLastCall( WRContext* context )
 //------------------------------------------------------------------------------
 WRFunction* wr_getFunction( WRContext* context, const uint32_t functionHash )
 {
-	WRValue* f = context->registry.exists(functionHash, false);
+	WRValue* f = wr_registry( context ).exists(functionHash, false);
 	return f ? f->wrf : 0;
 }
 
@@ -1130,7 +1636,7 @@ WRValue* wr_getGlobalRef( WRContext* context, const char* label )
 		match = wr_hashStr( globalLabel );
 	}
 
-	const unsigned char* symbolsBlock = context->bottom + 3 + (context->numLocalFunctions * WR_FUNCTION_CORE_SIZE);
+	const unsigned char* symbolsBlock = context->bottom + wr_functionTableEnd( context->bottom );
 	for( unsigned int i=0; i<context->globals; ++i, symbolsBlock += 4 )
 	{
 		uint32_t symbolHash = READ_32_FROM_PC( symbolsBlock );
@@ -1160,6 +1666,21 @@ WRValue& wr_makeString( WRContext* context, WRValue* val, const char* data, cons
 	return *val;
 }
 
+//------------------------------------------------------------------------------
+WRValue& wr_makeTypedArray( WRContext* context, WRValue* val, const uint32_t count, const char arrayType )
+{
+	val->va = context->getSVA( count, (WRGCObjectType)arrayType, true );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+	if ( !val->va )
+	{
+		val->p2 = INIT_AS_INT;
+		return *val;
+	}
+#endif
+	val->p2 = INIT_AS_ARRAY;
+	return *val;
+}
+
 //------------------------------------------------------------------------------
 WRValue& wr_makeContainer( WRValue* val, const uint16_t sizeHint )
 {
@@ -1308,7 +1829,7 @@ void wr_addArrayToContainer( WRValue* container, const char* name, char* array,
 	}
 
 	entry->c = array;
-	entry->p2 = INIT_AS_RAW_ARRAY | (size<<8);
+	entry->p2 = INIT_AS_RAW_ARRAY | ENCODE_ARRAY_ELEMENT_TO_P2(size);
 }
 
 //------------------------------------------------------------------------------
@@ -1630,6 +2151,57 @@ const char* c_opcodeName[] =
 	"LocalBZ8",
 	"GlobalBZ",
 	"GlobalBZ8",
+
+	"Wide",
+};
+
+//------------------------------------------------------------------------------
+const char* c_wideOpcodeName[] =
+{
+	"LoadFromLocal",
+	"LoadFromGlobal",
+
+	"CallFunctionByIndex",
+	"CallFunctionByIndexSkip1",
+
+	"PushIterator",
+	"NextValueOrJump",
+	"NextKeyValueOrJump",
+
+	"SwitchDense",
+
+	"TailCall",
+
+	"PopToLocal",
+
+	"IntLLCompareLTBZ",
+	"IntLLCompareLEBZ",
+	"IntLLCompareGTBZ",
+	"IntLLCompareGEBZ",
+	"IntLLCompareEQBZ",
+	"IntLLCompareNEBZ",
+
+	"IntLICompareLTBZ",
+	"IntLICompareLEBZ",
+	"IntLICompareGTBZ",
+	"IntLICompareGEBZ",
+	"IntLICompareEQBZ",
+	"IntLICompareNEBZ",
+
+	"IntLCountLTBZ",
+
+	"IntLLAddition",
+	"IntLLSubtraction",
+	"IntLLMultiplication",
+
+	"FloatLLAddition",
+	"FloatLLSubtraction",
+	"FloatLLMultiplication",
+	"FloatLLDivision",
+
+	"IncLocalLLCompareLT",
+	"LLIndex",
+	"LLIndexHashPair",
 };
 
 //------------------------------------------------------------------------------
@@ -1697,6 +2269,8 @@ const char* c_errStrings[]=
 	"WR_ERR_USER_err_out_of_range",
 
 	"WR_ERR_division_by_zero",
+
+	"WR_ERR_context_cannot_be_cloned",
 };
 
 #endif
@@ -72,7 +72,9 @@ const uint16_t c_primeTable[] =
 };
 */
 
-WRContext* wr_createContext( WRState* w, const unsigned char* block, const int blockSize, bool takeOwnership, WRValue* stack =0 );
+// functions: an already decoded function table to share, the block is
+//            assumed to have been verified
+WRContext* wr_createContext( WRState* w, const unsigned char* block, const int blockSize, bool takeOwnership, WRValue* stack =0, WRFunction* functions =0 );
 
 #ifndef WRENCH_WITHOUT_COMPILER
 
@@ -436,8 +438,18 @@ private:
 #endif
 
 void wr_growValueArray( WRGCObject* va, int newSize );
+void wr_reserveValueArray( WRGCObject* va, const uint32_t capacity );
+void wr_growValueArrayFront( WRGCObject* va, const uint32_t count );
 WRValue* wr_valueFromConfirmedStruct( WRValue* value, uint32_t hash );
 
+// read/write one element of a flat array that isn't SV_VALUE (chars and
+// the packed numeric types), elements must be in range
+void wr_unpackElement( const WRGCObject* va, const uint32_t element, WRValue* value );
+void wr_packElement( WRGCObject* va, const uint32_t element, const WRValue* value );
+
+// bytes per element of a flat (>= SV_VALUE) array
+#define WR_SIZEOF_ELEMENT(T) ( ((T) == SV_VALUE) ? (int)sizeof(WRValue) : ((((T) == SV_INT32) || ((T) == SV_FLOAT32)) ? 4 : 1) )
+
 #define IS_SVA_VALUE_TYPE(V) ((V)->m_type & 0x1)
 
 #define INIT_AS_LIB_CONST    0xFFFFFFFC
@@ -454,19 +466,27 @@ WRValue* wr_valueFromConfirmedStruct( WRValue* value, uint32_t hash );
 #define INIT_AS_INT      WR_INT
 #define INIT_AS_FLOAT    WR_FLOAT
 
+// element indexes and raw array sizes live in the middle 21 bits of
+// p2, where p2 is 64 bits wide the bits past that go in the top word so
+// small values encode exactly as they always have
+#if defined(_WIN64) || (defined(__SIZEOF_POINTER__) && (__SIZEOF_POINTER__ == 8))
+#define ENCODE_ARRAY_ELEMENT_TO_P2(E) (((uintptr_t)((E) & 0x1FFFFF) << 8) | (((uintptr_t)(E) >> 21) << 32))
+#define DECODE_ARRAY_ELEMENT_FROM_P2(E) ((uint32_t)((((E)&0x1FFFFF00) >> 8) | (((E) >> 32) << 21)))
+#else
 #define ENCODE_ARRAY_ELEMENT_TO_P2(E) ((E)<<8)
 #define DECODE_ARRAY_ELEMENT_FROM_P2(E) (((E)&0x1FFFFF00) >> 8)
+#endif
 
 #define IS_EXARRAY_TYPE(P)   ((P)&0xC0)
 #define IS_EX_RAW_ARRAY_TYPE(P)   (((P)&0xE0) == WR_EX_RAW_ARRAY)
-#define EX_RAW_ARRAY_SIZE_FROM_P2(P) (((P)&0x1FFFFF00) >> 8)
+#define EX_RAW_ARRAY_SIZE_FROM_P2(P) DECODE_ARRAY_ELEMENT_FROM_P2(P)
 #define IS_EX_SINGLE_CHAR_RAW_P2(P) ((P) == (((uint32_t)WR_EX) | (((uint32_t)WR_EX_RAW_ARRAY<<24)) | (1<<8)))
 #define IS_INVALID(P) ((P) == INIT_AS_INVALID)
 
 #define EX_TYPE_MASK   0xE0
 #define IS_CONTAINER_MEMBER(X) (((X)&EX_TYPE_MASK)==WR_EX_CONTAINER_MEMBER)
 #define IS_ARRAY(X) ((X)==WR_EX_ARRAY)
-#define IS_ITERATOR(X) ((X)==WR_EX_ITERATOR)
+#define IS_ITERATOR(X) (((X)&EX_TYPE_MASK)==WR_EX_ITERATOR)
 #define IS_RAW_ARRAY(X) (((X)&EX_TYPE_MASK)==WR_EX_RAW_ARRAY)
 #define IS_HASH_TABLE(X) ((X)==WR_EX_HASH_TABLE)
 #define EXPECTS_HASH_INDEX(X) ( ((X)==WR_EX_STRUCT) || ((X)==WR_EX_HASH_TABLE) )
@@ -30,6 +30,7 @@ SOFTWARE.
 #include <stdio.h>
 #include <assert.h>
 #include <stdlib.h>
+#include <time.h>
 
 #ifdef WRENCH_CLI_DEBUG
 WRContext* g_context = 0;
@@ -43,6 +44,14 @@ void testImport();
 void testHalt();
 void testTimeSlices();
 void testScheduler();
+void testMigrateContext();
+void testCloneContext();
+#ifdef WRENCH_LINUX_FILE_IO
+void testMappedContext();
+#endif
+#if defined(WRENCH_TIME_SLICES) && defined(WRENCH_THREADED_SCHEDULER)
+void testThreadedScheduler();
+#endif
 void testStackOverflow();
 void testYield2();
 void testHostSeededGlobalValue( WRState* w );
@@ -54,6 +63,27 @@ void testNamedEnumUnqualifiedError();
 void testBlankVariablesCannotBeInitialized();
 void testDeepHashTableWithWrenchValue();
 void testStateContextOpaquePointer();
+void testCallSiteCache();
+void testWideBytecode();
+void testInlineFunctions();
+void testOptimizer();
+void testTypedLocals();
+void testPackedFrames();
+void testLoopHoisting();
+void testSuperinstructions();
+#ifdef WRENCH_OPCODE_PROFILE
+void testOpcodeProfile();
+#endif
+void testTypedArrays();
+#ifdef WRENCH_GENERATIONAL_GC
+void testGenerationalGC();
+#endif
+#ifdef WRENCH_POOL_ALLOCATOR
+void testPoolAllocator();
+#endif
+#if defined(__linux__) || defined(__APPLE__)
+void testThreadedStates();
+#endif
 void LEAKtest();
 void C3test();
 #ifdef WIN32_C17
@@ -205,6 +235,7 @@ const char* sourceOrder[]=
 	"/lib/std_sys.cpp",
 	"/lib/std_serialize.cpp",
 	"/lib/std_container.cpp",
+	"/lib/std_vec.cpp",
 	"/lib/debug_lib.cpp",
 	"/lib/esp32_lib.cpp",
 	"/lib/arduino_lib.cpp",
@@ -252,8 +283,20 @@ int usage()
 			"                               and output [todir]/wrench.[cpp/h]\n"
 			"\n"
 			"rb [binary file to execute]    execute the file as if its bytecode\n"
+#ifdef WRENCH_LINUX_FILE_IO
+			"rm [binary file to execute]    same as rb but map the file instead of reading it\n"
+			"cold [binary file] [count]     time creating/destroying count contexts from\n"
+			"                               the file, read into memory vs mapped\n"
+#endif
+			"calls [count]                  time count host->script calls to a\n"
+			"                               one-line function\n"
 			"r  [source file to execute]    compile and execute execute the file\n"
 			"                               as if its source code\n"
+#ifdef WRENCH_OPCODE_PROFILE
+			"prof [source file]             same as r, then print how often each\n"
+			"                               instruction, pair and triple ran\n"
+			"                               (-top [n] lines of each, default 30)\n"
+#endif
 			"\n"
 			"options:\n"
 			"-debug                         add debug code\n"
@@ -261,6 +304,8 @@ int usage()
 			"-noglobals                     no global hashes, this saves 4 bytes per global\n"
 			"                               and prevents wr_getGlobalRef() from working\n"
 			"-nostrict                     do NOT require 'var' for variables\n"
+			"-inline                       copy small functions into their callers\n"
+			"-optimize                     fold constants and drop dead code\n"
 		
 			"\n", (int)WRENCH_VERSION_MAJOR, (int)WRENCH_VERSION_MINOR );
 
@@ -321,7 +366,9 @@ int main( int argn, char* argv[] )
 
 	flags = (SimpleArgs::get(argn, argv, "-nostrict") ? WR_NON_STRICT_VAR : 0)
 			| (SimpleArgs::get(argn, argv, "-debug") ? WR_EMBED_DEBUG_CODE : 0)
-			| (SimpleArgs::get(argn, argv, "-debugsource") ? WR_EMBED_SOURCE_CODE : 0);
+			| (SimpleArgs::get(argn, argv, "-debugsource") ? WR_EMBED_SOURCE_CODE : 0)
+			| (SimpleArgs::get(argn, argv, "-inline") ? WR_INLINE_FUNCTIONS : 0)
+			| (SimpleArgs::get(argn, argv, "-optimize") ? WR_OPTIMIZE : 0);
 
 	if ( SimpleArgs::get(argn, argv, "t") )
 	{
@@ -432,6 +479,54 @@ int main( int argn, char* argv[] )
 		return usage();
 #endif
 	}
+#ifdef WRENCH_OPCODE_PROFILE
+	else if ( SimpleArgs::get(argn, argv, "prof") )
+	{
+#ifndef WRENCH_WITHOUT_COMPILER
+		WRstr infile;
+		if ( !infile.fileToBuffer(SimpleArgs::get(argn, argv, -1)) )
+		{
+			printf( "Could not open source file [%s]\n", SimpleArgs::get(argn, argv, -1) );
+			return usage();
+		}
+
+		unsigned char* out;
+		int outLen;
+		int err = wr_compile( infile, infile.size(), &out, &outLen, 0, flags );
+		if ( err )
+		{
+			printf( "compile error [%s]\n", c_errStrings[err] );
+			return -1;
+		}
+
+		char top[16] = "30";
+		SimpleArgs::get( argn, argv, "-top", top, 15 );
+
+		gw = wr_newState( 128 );
+		wr_loadAllLibs(gw);
+		wr_registerFunction( gw, "println", println );
+		wr_registerFunction( gw, "print", print );
+
+		wr_run( gw, out, outLen );
+
+		wr_free( out );
+
+		if ( wr_getLastError(gw) )
+		{
+			printf( "err: %s\n", c_errStrings[(int)wr_getLastError(gw)] );
+		}
+
+		WRstr report;
+		wr_opcodeProfile( gw, report, atoi(top) > 0 ? atoi(top) : 30 );
+		printf( "\n%s", report.c_str() );
+
+		wr_destroyState( gw );
+#else
+		printf( "compiler not included in this build\n" );
+		return usage();
+#endif
+	}
+#endif
 	else if ( SimpleArgs::get(argn, argv, "rb") )
 	{
 		WRstr bytes;
@@ -458,6 +553,128 @@ int main( int argn, char* argv[] )
 
 		wr_destroyState( gw );
 	}
+#ifdef WRENCH_LINUX_FILE_IO
+	else if ( SimpleArgs::get(argn, argv, "rm") )
+	{
+		gw = wr_newState( 128 );
+		wr_loadAllLibs(gw);
+		wr_registerFunction( gw, "println", println );
+		wr_registerFunction( gw, "print", print );
+
+		wr_runMapped( gw, SimpleArgs::get(argn, argv, -1) );
+		if ( wr_getLastError( gw ) )
+		{
+			printf( "err: %d\n", (int)wr_getLastError(gw) );
+		}
+
+		wr_destroyState( gw );
+	}
+	else if ( SimpleArgs::get(argn, argv, "cold") )
+	{
+		WRstr bytes;
+		if ( argn < 3 || !bytes.fileToBuffer(argv[2]) )
+		{
+			printf( "Could not open bytecode [%s]\n", argn < 3 ? "" : argv[2] );
+			return usage();
+		}
+		const int count = (argn >= 4 && atoi(argv[3]) > 0) ? atoi(argv[3]) : 1000;
+
+		gw = wr_newState( 128 );
+		wr_loadAllLibs(gw);
+
+		clock_t start = clock();
+		for( int i=0; i<count; ++i )
+		{
+			wr_destroyContext( wr_newContext(gw, (const unsigned char*)bytes.c_str(), bytes.size()) );
+		}
+		double copied = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		start = clock();
+		for( int i=0; i<count; ++i )
+		{
+			wr_destroyContext( wr_newContextMapped(gw, argv[2]) );
+		}
+		double mapped = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		WRContext* warm = wr_runMapped( gw, argv[2] );
+		start = clock();
+		for( int i=0; warm && i<count; ++i )
+		{
+			wr_destroyContext( wr_cloneContext(warm) );
+		}
+		double cloned = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		if ( wr_getLastError(gw) )
+		{
+			printf( "err: %d\n", (int)wr_getLastError(gw) );
+		}
+		else
+		{
+			printf( "%d contexts from %d bytes\n"
+					"wr_newContext       %.2fus per context\n"
+					"wr_newContextMapped %.2fus per context\n"
+					"wr_cloneContext     %.2fus per context (globals already run)\n",
+					count, (int)bytes.size(), copied * 1000000.0 / count, mapped * 1000000.0 / count, cloned * 1000000.0 / count );
+		}
+
+		wr_destroyState( gw );
+	}
+#endif
+	else if ( SimpleArgs::get(argn, argv, "calls") )
+	{
+#ifndef WRENCH_WITHOUT_COMPILER
+		const int count = (argn >= 3 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 1000000;
+		const char* code = "function leaf( a ) { return a; }";
+
+		unsigned char* out;
+		int outLen;
+		int err = wr_compile( code, (int)strlen(code), &out, &outLen );
+		if ( err )
+		{
+			printf( "compile error [%s]\n", c_errStrings[err] );
+			return 0;
+		}
+
+		gw = wr_newState( 128 );
+		WRContext* context = wr_run( gw, out, outLen, true );
+
+		WRValue arg;
+		arg.setInt( 1 );
+
+		const int32_t hash = wr_hashStr( "leaf" );
+		clock_t start = clock();
+		for( int i=0; context && i<count; ++i )
+		{
+			wr_callFunction( context, hash, &arg, 1 );
+		}
+		double byHash = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		WRFunction* leaf = context ? wr_getFunction( context, "leaf" ) : 0;
+		start = clock();
+		for( int i=0; leaf && i<count; ++i )
+		{
+			wr_callFunction( context, leaf, &arg, 1 );
+		}
+		double byFunction = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		if ( wr_getLastError(gw) || !leaf )
+		{
+			printf( "err: %d\n", (int)wr_getLastError(gw) );
+		}
+		else
+		{
+			printf( "%d calls to a one-line script function\n"
+					"by hash       %.1fns per call\n"
+					"by WRFunction %.1fns per call\n",
+					count, byHash * 1000000000.0 / count, byFunction * 1000000000.0 / count );
+		}
+
+		wr_destroyState( gw );
+#else
+		printf( "compiler not included in this build\n" );
+		return usage();
+#endif
+	}
 	else if ( SimpleArgs::get(argn, argv, "c") )
 	{
 #ifndef WRENCH_WITHOUT_COMPILER
@@ -1205,196 +1422,1291 @@ void testStateContextOpaquePointer()
 
 	wr_destroyState( w );
 }
-#endif
 
+//------------------------------------------------------------------------------
+static void siteCacheOne( WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr ) { wr_makeInt( &retVal, 1 ); }
+static void siteCacheTwo( WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr ) { wr_makeInt( &retVal, *(int*)usr ); }
 
 //------------------------------------------------------------------------------
-int runTests( int number )
+// call sites resolved once must notice when the target is re-registered
+// or a new import supplies it
+void testCallSiteCache()
 {
-	int err = 0;
+	WRState* w = wr_newState( 64 );
+	wr_registerFunction( w, "host", siteCacheOne );
 
-#ifndef WRENCH_WITHOUT_COMPILER
-	WRstr code;
-	WRstr codeName;
+	const char* mainScript = "function viaHost() { var t = 0; for( var i=0; i<4; ++i ) { t += host(); } return t; }\n"
+							 "function viaImport() { return imported( 3 ); }\n"
+							 "function popImport() { imported( 3 ); return 1; }\n";
+	const char* importScript = "function imported( a ) { return a * 7; }\n";
 
-	WRValue container;
-	wr_makeContainer( &container );
-	
-	wr_addFloatToContainer( &container, "_f", 20.02f );
+	unsigned char* mainOut = 0;
+	unsigned char* importOut = 0;
+	int mainLen = 0;
+	int importLen = 0;
+	if ( wr_compile(mainScript, (int)strlen(mainScript), &mainOut, &mainLen) != WR_ERR_None
+		 || wr_compile(importScript, (int)strlen(importScript), &importOut, &importLen) != WR_ERR_None )
+	{
+		assert(0);
+		wr_destroyState( w );
+		return;
+	}
 
-	wr_addIntToContainer( &container, "_i", 1001 );
-	wr_addIntToContainer( &container, "_j", 1001 );
-	
-	WRValue integer;
-	wr_makeInt( &integer, 0 );
-	wr_addValueToContainer( &container, "integer", &integer );
+	WRContext* c = wr_run( w, mainOut, mainLen, true );
+	assert( c );
 
-	char someArray[10] = "hello";
-	wr_addArrayToContainer( &container, "name", someArray, 10 );
+	WRValue* r = wr_callFunction( c, "viaHost" );
+	assert( r && r->asInt() == 4 );
+	r = wr_callFunction( c, "viaHost" );
+	assert( r && r->asInt() == 4 );
 
-	char* someBigArray = (char *)wr_malloc( 0x1FFFFF );
-	someBigArray[0] = 10;
-	someBigArray[0x99] = (char)0x88;
-	someBigArray[10000] = 20;
-	someBigArray[100000] = 30;
-	someBigArray[0x1FFFFE] = 40;
+	int five = 5;
+	wr_registerFunction( w, "host", siteCacheTwo, &five );
+	r = wr_callFunction( c, "viaHost" );
+	assert( r && r->asInt() == 20 );
 
-	char byte = (char)0x99;
-	char byte2 = (char)0x99;
-	wr_addArrayToContainer( &container, "b", &byte, 1 );
-	wr_addArrayToContainer( &container, "c", &byte2, 1 );
-		
-	wr_addArrayToContainer( &container, "big", someBigArray, 0x1FFFFF );
+	r = wr_callFunction( c, "viaImport" );
+	assert( !r && wr_getLastError(w) == WR_ERR_function_not_found );
 
-	FILE* tfile = fopen( "test_files.txt", "r" );
+	assert( wr_import(c, importOut, importLen, true) );
+	for( int i=0; i<3; ++i )
+	{
+		r = wr_callFunction( c, "viaImport" );
+		assert( r && r->asInt() == 21 );
+		r = wr_callFunction( c, "popImport" );
+		assert( r && r->asInt() == 1 );
+	}
 
-	WRState* w = wr_newState( 128 );
+	wr_destroyState( w );
+}
 
-	wr_loadAllLibs( w );
-	wr_setAllocatedMemoryGCHint( w, 0 );
+//------------------------------------------------------------------------------
+static WRContext* wideRun( WRState* w, WRstr const& source, const uint8_t flags, bool* wide )
+{
+	unsigned char* out = 0;
+	int outLen = 0;
+	if ( wr_compile(source.c_str(), source.size(), &out, &outLen, 0, flags) != WR_ERR_None )
+	{
+		return 0;
+	}
 
-	// library constants for enum interaction tests (012_enums.c)
-	wr_registerLibraryConstant( w, "TestLC::LIBVAL",  (int32_t)100 ); // never overridden by enum
-	wr_registerLibraryConstant( w, "TestLC::BOTH",    (int32_t)200 ); // shadowed by enum after its declaration
-	wr_registerLibraryConstant( w, "TestMix::LIBONLY",(int32_t)77  ); // lib-only member in a mixed namespace
+	*wide = (out[2] & WR_WIDE_BYTECODE) != 0;
+	return wr_run( w, out, outLen, true );
+}
 
-	char buf[256];
-	int fileNumber = 0;
-	WRstr errMsg;
+//------------------------------------------------------------------------------
+// scripts past the 8-bit limits: a thousand globals and functions, a
+// frame of hundreds of locals and more than 64k of code
+void testWideBytecode()
+{
+	WRState* w = wr_newState( 1024 );
+	bool wide = false;
 
-	unsigned char* out;
-	int outLen;
-	while( fgets(buf, 255, tfile) && (err==0) )
+	WRstr source;
+	for( int i=0; i<1000; ++i )
 	{
-		if ( !number || (number == fileNumber) )
+		source.appendFormat( "var g%d = %d;\n", i, i );
+	}
+	for( int i=0; i<1000; ++i )
+	{
+		source.appendFormat( "function f%d( a ) { return a + %d; }\n", i, i );
+	}
+
+	source += "function locals() {\n";
+	for( int i=0; i<300; ++i )
+	{
+		source.appendFormat( "var l%d = %d;\n", i, i );
+	}
+	source += "l299 += 1; ++l298; var arr[] = { 1, 2, 3 }; var t = 0;\n"
+			  "for( l297 : arr ) { t += l297; }\n"
+			  "return l0 + l150 + l299 + l298 + t; }\n";
+
+	source += "struct Point { var x = 3; var y = 4; }\n"
+			  "function calls() { f999( 1 ); return f998( 2 ) + f999( 3 ) + f0( 4 ); }\n"
+			  "function globals() { g999 += 1; return g500 + g999; }\n"
+			  "function members() { var p = new Point(); p.y = 10; return p.x + p.y; }\n"
+			  "var wh = { 1:10, 2:20 };\n"
+			  "var sum = 0;\n"
+			  "for( g800, g801 : wh ) { sum += g800 * g801; }\n"
+			  "function iterated() { return sum; }\n";
+
+	WRContext* c = wideRun( w, source, 0, &wide );
+	assert( c && wide );
+
+	WRValue* r = wr_callFunction( c, "calls" );
+	assert( r && r->asInt() == (2 + 998) + (3 + 999) + 4 );
+	r = wr_callFunction( c, "globals" );
+	assert( r && r->asInt() == 500 + 1000 );
+	r = wr_callFunction( c, "locals" );
+	assert( r && r->asInt() == 0 + 150 + 300 + 299 + 6 );
+	r = wr_callFunction( c, "members" );
+	assert( r && r->asInt() == 13 );
+	r = wr_callFunction( c, "iterated" );
+	assert( r && r->asInt() == 1*10 + 2*20 );
+
+	// few symbols but too much code for 16-bit offsets
+	source.clear();
+	for( int i=0; i<100; ++i )
+	{
+		source.appendFormat( "function s%d() { var x = \"", i );
+		for( int j=0; j<1000; ++j )
 		{
-			WRstr expect;
-			codeName = buf;
-			codeName.trim();
+			source += (char)('a' + (j % 26));
+		}
+		source.appendFormat( "\"; return %d; }\n", i );
+	}
+	source += "function tail() { return s99() + s1(); }\n";
+
+	c = wideRun( w, source, 0, &wide );
+	assert( c && wide );
+	r = wr_callFunction( c, "tail" );
+	assert( r && r->asInt() == 100 );
+
+	// forced, and the default stays narrow
+	source = "var a = 5; function f( b ) { return a + b; }\n";
+	WRValue arg;
+	wr_makeInt( &arg, 2 );
+	c = wideRun( w, source, WR_WIDE_BYTECODE, &wide );
+	assert( c && wide );
+	r = wr_callFunction( c, "f", &arg, 1 );
+	assert( r && r->asInt() == 7 );
+	c = wideRun( w, source, 0, &wide );
+	assert( c && !wide );
+	r = wr_callFunction( c, "f", &arg, 1 );
+	assert( r && r->asInt() == 7 );
 
-			if ( code.fileToBuffer(codeName) )
-			{
-				unsigned int t = 0;
+	wr_destroyState( w );
+}
 
-				for( ; (t < code.size()) && (code[t] != '~'); ++t );
+//------------------------------------------------------------------------------
+// compile 'script' with 'flags' on a fresh state and call 'function' in
+// it (with 'arg' if there is one), returns what that returned as an int
+// or -1 if it did not compile or run. The bytecode is handed back for the
+// caller to wr_free() when 'bytecode' is set, and 'frame' gets the frame
+// space the first function in the script needs
+static int runWithFlags( const char* script, const uint8_t flags, const char* function ="run", const WRValue* arg =0,
+						 unsigned char** bytecode =0, int* bytecodeLen =0, int* frame =0 )
+{
+	unsigned char* out;
+	int outLen;
+	if ( wr_compile(script, (int)strlen(script), &out, &outLen, 0, flags) != WR_ERR_None )
+	{
+		return -1;
+	}
 
-				t += 2;
+	WRState* w = wr_newState( 64 );
+	wr_loadMathLib( w );
+	WRContext* c = wr_run( w, out, outLen );
 
-				for( ; t<code.size() && (code[t] != '~'); ++t )
-				{
-					expect += code[t];
-				}
+	WRValue* r = c ? wr_callFunction( c, function, arg, arg ? 1 : 0 ) : 0;
+	const int ret = r ? r->asInt() : -1;
+	if ( c && frame )
+	{
+		*frame = c->localFunctions[0].frameSpaceNeeded;
+	}
 
-				printf( "test [%d][%s]: ", fileNumber, codeName.c_str() );
+	wr_destroyState( w );
 
-				wr_compile( code, code.size(), &out, &outLen, &errMsg, WR_INCLUDE_GLOBALS );
-				
-				if ( err )
-				{
-#ifdef WRENCH_WITHOUT_COMPILER
-					printf( "compile error [#%d]\n", err );
-#else
-					printf( "compile error [%s]\n", c_errStrings[err] );
-#endif
-					return -1;
-				}
+	if ( bytecode )
+	{
+		*bytecode = out;
+		*bytecodeLen = outLen;
+	}
+	else
+	{
+		wr_free( out );
+	}
+	return ret;
+}
 
-				WRstr logger;
-				wr_registerFunction( w, "print", emit, &logger );
-				wr_registerFunction( w, "println", emitln, &logger );
-				
-				wr_registerFunction( w, "checkIsWrenchArray", checkIsWrenchArray );
-				wr_registerFunction( w, "checkIsRawArray", checkIsRawArray );
-				wr_registerFunction( w, "checkIsString", checkIsString );
-				wr_registerFunction( w, "checkIsHashTable", checkIsHashTable );
-				wr_registerFunction( w, "checkIter", checkIter );
-				wr_registerFunction( w, "checkStruct", checkStruct );
-
-				WRContext* context = 0;
-				wr_destroyContext( context ); // make sure this doesn't crash
-				context = wr_run( w, out, outLen );
-
-				err = wr_getLastError( w );
-
-				int args;
-				WRValue* firstArg;
-				WRValue* returnValue;
-				while( wr_getYieldInfo(context, &firstArg, &args, &returnValue) )
-				{
-					if ( args > 0 )
-					{
-						*returnValue = *firstArg;
-					}
-					wr_continue( context );
-				}
+//------------------------------------------------------------------------------
+// is there a wide instruction whose name starts with 'name' anywhere in
+// the bytecode (end 'name' with a space to match all of it)
+static bool hasWideOp( const unsigned char* bytecode, const int len, const char* name )
+{
+	WRstr listing;
+	wr_disassemble( bytecode, len, listing, false );
 
-				if ( context && !(err = wr_getLastError(w)) )
-				{
-					integer.i = 2456;
-					someArray[1] = 'e';
+	const size_t nameLen = strlen( name );
+	for( const char* p = strstr(listing.c_str(), " Wide "); p; p = strstr(p, " Wide ") )
+	{
+		for( p += 6; *p == ' '; ++p );
+		if ( !strncmp(p, name, nameLen) )
+		{
+			return true;
+		}
+	}
+	return false;
+}
 
-					WRValue* V = wr_callFunction( context, "userCheck", &container, 1 );
-					if ( V && V->i == 77 )
-					{
-						assert( integer.i == 56789 );
-						assert( someArray[1] == 'c' );
-					}
+//------------------------------------------------------------------------------
+// the same script with and without WR_INLINE_FUNCTIONS has to come out
+// the same, including arguments written through and locals that start
+// at zero on every call
+void testInlineFunctions()
+{
+	const char* script =
+		"var g = 0;\n"
+		"function two( a, b ) { return a + b; }\n"
+		"function absv( a ) { var r = a; if ( a < 0 ) { r = -a; } return r; }\n"
+		"function acc( a ) { var t; t += a; return t; }\n"
+		"function tri( n ) { var s = 0; for( var i=1; i<=n; ++i ) { s += i; } return s; }\n"
+		"function bump( p ) { p.x += 1; }\n"
+		"function incg() { ++g; }\n"
+		"function second( a ) { return a[1]; }\n"
+		"function setTo( a, v ) { a = v; }\n"
+		"function clobber( a ) { a = 3; return a; }\n"
+		"function hyp( a, b ) { return math::sqrt( a*a + b*b ); }\n"
+		"function nothing() {}\n"
+		"function S( a ) { var q = a; return; }\n"
+		"function mk( a ) { var r = new S( a ); return r; }\n"
+		"struct P { var x = 1; }\n"
+		"function run()\n"
+		"{\n"
+		"	var bad = 0;\n"
+		"	var x = -7;\n"
+		"	if ( two(3, 4) != 7 ) bad += 1;\n"
+		"	if ( two(4) != 4 ) bad += 2;\n"
+		"	if ( two(1, 2, 99) != 3 ) bad += 4;\n"
+		"	if ( absv(x) != 7 || absv(5) != 5 ) bad += 8;\n"
+		"	if ( two(absv(-3), absv(x)) != 10 ) bad += 16;\n"
+		"	if ( acc(2) + acc(3) != 5 ) bad += 32;\n"
+		"	if ( tri(10) != 55 ) bad += 64;\n"
+		"	var p = new P;\n"
+		"	bump( p ); bump( p );\n"
+		"	if ( p.x != 3 ) bad += 128;\n"
+		"	incg(); incg();\n"
+		"	if ( g != 2 ) bad += 256;\n"
+		"	var arr[] = { 5, 6, 7 };\n"
+		"	if ( second(arr) != 6 ) bad += 512;\n"
+		"	if ( 1 + two(2, 3) * 2 != 11 ) bad += 1024;\n"
+		"	if ( hyp(3, 4) != 5 ) bad += 2048;\n"
+		"	if ( nothing() != 0 ) bad += 4096;\n"
+		"	var s = 0;\n"
+		"	for( var i=0; i<10; ++i ) { s += two( i, absv(-i) ); }\n"
+		"	if ( s != 90 ) bad += 8192;\n"
+		"	var o = mk( 3 );\n"
+		"	var o2 = new S( 4 );\n"
+		"	if ( o.q != 3 || o2.q != 4 ) bad += 16384;\n"
+		"	return bad;\n"
+		"}\n"
+		"function refs()\n"
+		"{\n"
+		"	var y = 1;\n"
+		"	setTo( y, 5 );\n"
+		"	var z = 1;\n"
+		"	var c = clobber( z );\n"
+		"	var w = 2;\n"
+		"	setTo( w + 0, 9 );\n"
+		"	return y*1000 + z*100 + c*10 + w;\n"
+		"}\n";
 
-					char testString[12] = "test string";
-					WRValue val;
-					wr_makeString( context, &val, testString, 11 );
+	unsigned char* out[2];
+	int outLen[2];
+	for( int i=0; i<2; ++i )
+	{
+		const uint8_t flags = i ? WR_INLINE_FUNCTIONS : 0;
+		int r = runWithFlags( script, flags, "run", 0, out + i, outLen + i );
+		assert( r == 0 );
+		r = runWithFlags( script, flags, "refs" );
+		assert( r == 5132 );
+	}
 
-					assert( val.isString() );
-					
-					wr_callFunction( context, "stringCheck", &val, 1 );
-					wr_callFunction( context, "stringCheck", &val, 1 );
-					wr_callFunction( context, "stringCheck", &val, 1 );
-					wr_callFunction( context, "stringCheck", &val, 1 );
+	// and the calls really did go away
+	assert( outLen[0] != outLen[1] || memcmp(out[0], out[1], outLen[0]) );
 
-					V = wr_callFunction( context, "arrayCheck" );
-					if ( V )
-					{
-						V->isWrenchArray();
-						assert( V->isWrenchArray() );
-						char someString[256] = { 0 };
-						someString[0] = someString[0]; // kill warning
-						assert( WRstr(V->indexArray(context, 0, false)->asString(someString)) == "some string" );
-						assert( V->indexArray(context, 1, false)->asFloat() == 0.0f );
-						assert( V->indexArray(context, 2, false)->asInt() == 0);
-						assert( !V->indexArray(context, 3, false)  );
-						assert( V->indexArray(context, 3, true)->asInt() == 0  );
-
-						assert( wr_getValueFromContainer(container, "_i")->asInt() == 1001 );
-					}
+	wr_free( out[0] );
+	wr_free( out[1] );
+}
 
-					WRValue s;
-					wr_makeString( context, &s, "test string" );
-					wr_callFunction( context, "stringCheck", &s, 1 );
-				}
+//------------------------------------------------------------------------------
+// WR_OPTIMIZE has to get the same answers in less code: folded
+// expressions and math:: calls, locals that only ever hold a constant,
+// branches that can never run, and a function instanced as a struct
+// keeping its members
+void testOptimizer()
+{
+	const char* script =
+		"var g = 3;\n"
+		"function area( r )\n"
+		"{\n"
+		"	var pi = 3.5 * 2.0 / 7.0 * 3.0;\n"
+		"	var sides = 4;\n"
+		"	var corners = sides * 2 - sides;\n"
+		"	if ( corners != 4 ) { return -1; }\n"
+		"	return pi * r * r + math::sqrt( 16.0 ) * (1 << 3);\n"
+		"}\n"
+		"function branches( n )\n"
+		"{\n"
+		"	var s = 0;\n"
+		"	if ( 0 ) { s = 100; } else { s += 1; }\n"
+		"	if ( 2 > 1 ) { s += 10; } else { s = 200; }\n"
+		"	if ( 0 ) { s = 300; }\n"
+		"	while( 0 ) { s = 400; }\n"
+		"	var k = 5;\n"
+		"	for( var i=0; i<n; ++i ) { s += k; }\n"
+		"	k += 1;\n"
+		"	return s + k + g;\n"
+		"}\n"
+		"function shape() { var w = 7; var h = w * 2; }\n"
+		"function run()\n"
+		"{\n"
+		"	var bad = 0;\n"
+		"	if ( area(2) != 44 ) bad += 1;\n"
+		"	if ( branches(3) != 35 ) bad += 2;\n"
+		"	if ( -7 / 2 != -3 || 7 % 3 != 1 || (5 / 0.5) != 10 ) bad += 4;\n"
+		"	if ( (0x7FFFFFFF + 1) != -2147483647 - 1 ) bad += 8;\n"
+		"	var s = new shape;\n"
+		"	if ( s.w != 7 || s.h != 14 ) bad += 16;\n"
+		"	return bad;\n"
+		"}\n";
 
-				if ( err )
-				{
-					printf( "execute error [%s]\n", c_errStrings[err] );
-				}
-				else if ( logger != expect )
+	unsigned char* out[2];
+	int outLen[2];
+	for( int i=0; i<2; ++i )
+	{
+		int r = runWithFlags( script, i ? WR_OPTIMIZE : 0, "run", 0, out + i, outLen + i );
+		assert( r == 0 );
+	}
+
+	assert( outLen[1] < outLen[0] );
+
+	wr_free( out[0] );
+	wr_free( out[1] );
+}
+
+//------------------------------------------------------------------------------
+// locals WR_OPTIMIZE decides only ever hold an int (or a float) get
+// typed compares and arithmetic; the ones it can't be sure of, or
+// that wrap, divide by zero or change type, have to come out the same
+void testTypedLocals()
+{
+	const char* script =
+		"function two( a, b ) { return a + b; }\n"
+		"function run()\n"
+		"{\n"
+		"	var bad = 0;\n"
+		"	var sum = 0;\n"
+		"	var step = 1;\n"
+		"	var i = 0;\n"
+		"	while( i < 100 ) { sum = sum + i; i = i + step; }\n"
+		"	if ( sum != 4950 ) bad += 1;\n"
+		"	var lo = 0;\n"
+		"	var hi = 10;\n"
+		"	var turns = 0;\n"
+		"	while( lo < hi ) { ++lo; --hi; turns = turns + step; }\n"
+		"	if ( lo != 5 || turns != 5 ) bad += 2;\n"
+		"	var x = 0.5;\n"
+		"	var y = 0.25;\n"
+		"	var h = 0.0;\n"
+		"	for( var k=0; k<4; ++k ) { x = x + y; y = y * x; h = x / y; }\n"
+		"	if ( h < 5.1 || h > 5.12 ) bad += 4;\n"
+		"	var a = 0;\n"
+		"	var f = 1.5;\n"
+		"	a += f;\n"
+		"	var twice = a + a;\n"
+		"	if ( twice != 3.0 ) bad += 8;\n"
+		"	var e = 1;\n"
+		"	two( e = 2.5, 0 );\n"
+		"	var ee = e * e;\n"
+		"	if ( ee != 6.25 ) bad += 16;\n"
+		"	var big = 0x7FFFFFFF;\n"
+		"	big = big + step;\n"
+		"	if ( big != -2147483647 - 1 ) bad += 32;\n"
+		"	var z = 0.0;\n"
+		"	var q = 1.0;\n"
+		"	q = q / z;\n"
+		"	if ( q != 0 ) bad += 64;\n"
+		"	var m = 1;\n"
+		"	if ( step ) { m = 0.5; }\n"
+		"	var mm = m + m;\n"
+		"	if ( mm != 1.0 ) bad += 128;\n"
+		"	if ( step ) { goto skip; }\n"
+		"	var s = 2.5;\n"
+		"skip:\n"
+		"	var ss = s + s;\n"
+		"	if ( ss != 0 ) bad += 256;\n"
+		"	return bad;\n"
+		"}\n";
+
+	unsigned char* out[2];
+	int outLen[2];
+	for( int i=0; i<2; ++i )
+	{
+		int r = runWithFlags( script, i ? WR_OPTIMIZE : 0, "run", 0, out + i, outLen + i );
+		assert( r == 0 );
+	}
+
+	// and the typed instructions really went out
+	assert( !hasWideOp(out[0], outLen[0], "IntL") && !hasWideOp(out[0], outLen[0], "FloatL") );
+	assert( hasWideOp(out[1], outLen[1], "IntLICompareLTBZ") );
+	assert( hasWideOp(out[1], outLen[1], "IntLLAddition") );
+	assert( hasWideOp(out[1], outLen[1], "FloatLLDivision") );
+
+	wr_free( out[0] );
+	wr_free( out[1] );
+
+	// a local written inside an argument list can't be typed from its
+	// declaration, without that write it can
+	const char* through =
+		"function two( a, b ) { return a + b; }\n"
+		"function run() { var e = 0.5; two( e = 2, 0 ); e = e + e; var ee = e * e; return ee; }\n";
+	const char* direct =
+		"function two( a, b ) { return a + b; }\n"
+		"function run() { var e = 0.5; two( 2, 0 ); e = e + e; var ee = e * e; return ee * 4; }\n";
+
+	unsigned char* code;
+	int codeLen;
+	int r = runWithFlags( through, WR_OPTIMIZE, "run", 0, &code, &codeLen );
+	assert( r == 16 );
+	assert( !hasWideOp(code, codeLen, "IntLL") && !hasWideOp(code, codeLen, "FloatLL") );
+	wr_free( code );
+
+	r = runWithFlags( direct, WR_OPTIMIZE, "run", 0, &code, &codeLen );
+	assert( r == 4 );
+	assert( hasWideOp(code, codeLen, "FloatLLAddition") );
+	wr_free( code );
+
+	// comparing a local with something that could be a float converts
+	// it in place, 'i < n' alone can't type i
+	const char* compared =
+		"function run( n )\n"
+		"{\n"
+		"	var s = 0;\n"
+		"	var i = 0;\n"
+		"	while( i < n ) { s = s + i; i = i + 1; }\n"
+		"	for( var k=0; k<n; ++k ) { s = s + k; }\n"
+		"	return s;\n"
+		"}\n";
+
+	WRValue arg;
+	wr_makeFloat( &arg, 3.f );
+	for( int i=0; i<2; ++i )
+	{
+		r = runWithFlags( compared, i ? WR_OPTIMIZE : 0, "run", &arg );
+		assert( r == 6 );
+	}
+}
+
+//------------------------------------------------------------------------------
+// WR_OPTIMIZE lets locals that are never live together share a frame
+// slot; the ones that might be read before anything stores to them,
+// or that a loop carries around, must still see what they would have
+void testPackedFrames()
+{
+	const char* script =
+		"function frame( n )\n"
+		"{\n"
+		"	var bad = 0;\n"
+		"	first = n * 2;\n"
+		"	if ( first != 6 ) bad += 1;\n"
+		"	acc = 0;\n"
+		"	for( i=0; i<n; ++i ) { step = i + 1; acc = acc + step; }\n"
+		"	if ( acc != 6 ) bad += 2;\n"
+		"	for( j=0; j<0; last = 5 ) { ++j; }\n"
+		"	filler = n + 1;\n"
+		"	if ( last != 0 || filler != 4 ) bad += 4;\n"
+		"	do { junk = 5; if ( n ) { break; } } while( (seen = junk) );\n"
+		"	spare = 7;\n"
+		"	if ( seen != 0 || spare != 7 ) bad += 8;\n"
+		"	if ( n > 100 ) { set = 1; }\n"
+		"	other = 9;\n"
+		"	if ( set != 0 || other != 9 ) bad += 16;\n"
+		"	carried = 0;\n"
+		"	for( k=0; k<n; ++k ) { before = carried; carried = k + 10; }\n"
+		"	if ( before != 11 || carried != 12 ) bad += 32;\n"
+		"	base = n;\n"
+		"	sum = 0;\n"
+		"	for( q=0; q<3; ++q ) { sum += base; extra = q * 100; sum += extra; }\n"
+		"	if ( sum != 309 ) bad += 64;\n"
+		"	arr[2] = 3;\n"
+		"	total = 0;\n"
+		"	for( v : arr ) { twice = v * 2; total += twice; }\n"
+		"	after = 1.5;\n"
+		"	if ( total != 6 || v != 3 || after != 1.5 ) bad += 128;\n"
+		"	return bad;\n"
+		"}\n";
+
+	WRValue arg;
+	wr_makeInt( &arg, 3 );
+	int frames[2];
+	for( int i=0; i<2; ++i )
+	{
+		int r = runWithFlags( script, WR_NON_STRICT_VAR | (i ? WR_OPTIMIZE : 0), "frame", &arg, 0, 0, frames + i );
+		assert( r == 0 );
+	}
+
+	assert( frames[1] < frames[0] );
+}
+
+//------------------------------------------------------------------------------
+// WR_OPTIMIZE works out what a loop never changes once, before it
+// starts; anything the loop does store to, or that can be reached
+// some other way, and counts that can grow under it, have to come
+// out the same
+void testLoopHoisting()
+{
+	const char* script =
+		"function widths( n )\n"
+		"{\n"
+		"	var count = (int)n;\n"
+		"	var w = 1;\n"
+		"	var h = 0.5;\n"
+		"	for( var k=0; k<count; ++k ) { w += k; h += 0.5; }\n"
+		"	var s = 0;\n"
+		"	var f = 0.0;\n"
+		"	for( var i=0; i<count; ++i )\n"
+		"	{\n"
+		"		s += i * (w * w);\n"
+		"		var j = 0;\n"
+		"		while( j < 3 ) { s = s + (w - 7) + i * w; f = f + h * w; ++j; }\n"
+		"	}\n"
+		"	return s + f;\n"
+		"}\n"
+		"function moving( n )\n"
+		"{\n"
+		"	var a = 2;\n"
+		"	var b = 3;\n"
+		"	var s = 0;\n"
+		"	for( var i=0; i<n; ++i ) { s += a * b; a = a + 1; }\n"
+		"	var c = 0;\n"
+		"	var i = 0;\n"
+		"	while( i < n ) { ++i; if ( i == 2 ) { continue; } c = c + (b | 8); b = b + 1; }\n"
+		"	return s * 1000 + c;\n"
+		"}\n"
+		"function never( n )\n"
+		"{\n"
+		"	var a = 4;\n"
+		"	var s = 0;\n"
+		"	for( var i=0; i<n; ++i ) { a = a + 1; }\n"
+		"	for( var i=0; i<0; ++i ) { s += a * a; }\n"
+		"	while( s ) { s = s - (a ^ 1); }\n"
+		"	return s + a;\n"
+		"}\n"
+		"function counted( n )\n"
+		"{\n"
+		"	var arr[] = { 1, 2 };\n"
+		"	var t = 0;\n"
+		"	for( var i=0; i<arr._count; ++i ) { t += arr[i]; if ( i < n ) { arr[arr._count] = i; } }\n"
+		"	var h = { 1:1 };\n"
+		"	var j = 0;\n"
+		"	while( j < h._count ) { ++j; if ( j < n ) { h[j + 100] = j; } }\n"
+		"	return t * 100 + j;\n"
+		"}\n"
+		"function jumps( n )\n"
+		"{\n"
+		"	var a = 2;\n"
+		"	var b = 3;\n"
+		"	var s = 0;\n"
+		"	if ( n ) { goto inside; }\n"
+		"	for( var i=0; i<n; ++i )\n"
+		"	{\n"
+		"inside:\n"
+		"		s += a * b;\n"
+		"	}\n"
+		"	return s;\n"
+		"}\n"
+		"function member( n ) { var m = 0; for( var i=0; i<n; ++i ) { m += n * n; } }\n"
+		"function run()\n"
+		"{\n"
+		"	var bad = 0;\n"
+		"	if ( widths(6) != 5730.0 ) bad += 1;\n"
+		"	if ( moving(4) != 42036 ) bad += 2;\n"
+		"	if ( never(3) != 7 ) bad += 4;\n"
+		"	if ( counted(3) != 603 ) bad += 8;\n"
+		"	if ( jumps(2) != 12 ) bad += 16;\n"
+		"	var m = new member( 3 );\n"
+		"	if ( m.m != 27 || m._count != 2 ) bad += 32;\n"
+		"	return bad;\n"
+		"}\n";
+
+	int frames[2];
+	for( int i=0; i<2; ++i )
+	{
+		int r = runWithFlags( script, i ? WR_OPTIMIZE : 0, "run", 0, 0, 0, frames + i );
+		assert( r == 0 );
+	}
+
+	// without hoisting widths() packs into seven slots, w * w, w - 7
+	// and h * w moved out of the outer loop and i * w out of the inner
+	// one are kept in four hidden ones. Its loops compare against
+	// (int)n, against n itself they could not be typed
+	assert( frames[0] == 8 && frames[1] == 11 );
+}
+
+//------------------------------------------------------------------------------
+// the for() back edge, a[i] and 'a.x op= b.y' each go out as one wide
+// instruction now; whatever the locals hold (ints, floats, refs, things
+// that are not tables yet) they have to do what the sequences they
+// replaced did
+void testSuperinstructions()
+{
+	const char* script =
+		"function bump( x ) { x = x + 100; return x; }\n"
+		"function loops( n )\n"
+		"{\n"
+		"	var s = 0;\n"
+		"	for( var i=0; i<n; ++i ) { s += i; }\n"
+		"	var f = 0.0;\n"
+		"	for( var x=0.5; x<n; ++x ) { f += x; }\n"
+		"	var m = 0;\n"
+		"	for( var j=0; j<2.5; ++j ) { m += 10; }\n"
+		"	for( var k=0; k<n; ++k ) { if ( k == 1 ) { continue; } if ( k == 4 ) { break; } m += k; }\n"
+		"	var lim = 3;\n"
+		"	for( var q=0; q<lim; ++q ) { if ( q == 0 ) { lim = 5; } m += 100; }\n"
+		"	for( var r=0; r<n; ++r ) { r += 1; m += 1000; }\n"
+		"	for( var a=0; a<3; ++a ) { for( var b=0; b<a; ++b ) { m += 10000; } }\n"
+		"	return s + f + m;\n"
+		"}\n"
+		"function index( n )\n"
+		"{\n"
+		"	var a[] = { 1, 2, 3, 4 };\n"
+		"	var s = 0;\n"
+		"	for( var i=0; i<n; ++i ) { s += bump( a[i] ); }\n"
+		"	for( var i=0; i<n; ++i ) { a[i] = a[i] * 2 + i; }\n"
+		"	var t = 0;\n"
+		"	for( var i=0; i<n; ++i ) { t = t * 10 + a[i]; }\n"
+		"	return s * 100000 + t;\n"
+		"}\n"
+		"struct P { var x = 1; var vx = 2.5; }\n"
+		"function members( n )\n"
+		"{\n"
+		"	var p = new P;\n"
+		"	for( var i=0; i<n; ++i ) { p.x += p.vx; }\n"
+		"	var q = new P;\n"
+		"	q.x -= p.x;\n"
+		"	q.vx *= q.x;\n"
+		"	q.x = p.vx;\n"
+		"	q.vx /= q.x;\n"
+		"	var h;\n"
+		"	h.a = 4;\n"
+		"	h.a += p.vx;\n"
+		"	var u;\n"
+		"	u.z += q.x;\n"
+		"	return p.x * 1000 + q.x * 100 + q.vx * 10 + h.a + u.z;\n"
+		"}\n"
+		"function run()\n"
+		"{\n"
+		"	var bad = 0;\n"
+		"	if ( loops(6) != 33568 ) bad += 1;\n"
+		"	if ( index(4) != 41002591 ) bad += 2;\n"
+		"	if ( members(3) != 8684 ) bad += 4;\n"
+		"	return bad;\n"
+		"}\n";
+
+	// they go out whether or not the optimizer runs, but it turns the
+	// loop tests into typed compares and adds hoisted code in front of
+	// loops, neither may keep them from being used
+	for( int i=0; i<3; ++i )
+	{
+		unsigned char* out;
+		int outLen;
+		const uint8_t flags = (i == 0) ? 0 : ((i == 1) ? WR_OPTIMIZE : (WR_OPTIMIZE | WR_INLINE_FUNCTIONS));
+		int r = runWithFlags( script, flags, "run", 0, &out, &outLen );
+		assert( r == 0 );
+
+		assert( hasWideOp(out, outLen, "IncLocalLLCompareLT ") );
+		assert( hasWideOp(out, outLen, "LLIndex ") );
+		assert( hasWideOp(out, outLen, "LLIndexHashPair ") );
+		wr_free( out );
+	}
+}
+
+#ifdef WRENCH_OPCODE_PROFILE
+//------------------------------------------------------------------------------
+// an empty for() is its back edge branching to itself, the profile has
+// to count it on its own, as a pair and as a triple, and forget it all
+// when reset
+void testOpcodeProfile()
+{
+	const char* script = "function spin( n ) { for( var i=0; i<n; ++i ) {} }\n";
+
+	unsigned char* out;
+	int outLen;
+	if ( wr_compile(script, (int)strlen(script), &out, &outLen) != WR_ERR_None )
+	{
+		assert(0);
+		return;
+	}
+
+	WRState* w = wr_newState( 64 );
+	WRContext* c = wr_run( w, out, outLen, true );
+	assert( c );
+
+	const WROpcodeProfile* p = w->opcodeProfile;
+	const uint32_t back = O_LAST + W_IncLocalLLCompareLT;
+	const uint32_t key = (back*WR_PROFILE_CODES + back)*WR_PROFILE_CODES + back + 1;
+
+	wr_resetOpcodeProfile( w );
+
+	WRValue arg;
+	wr_makeInt( &arg, 100 );
+	wr_callFunction( c, "spin", &arg, 1 );
+
+	uint64_t triple = 0;
+	for( int t=0; t<WR_PROFILE_TRIPLES; ++t )
+	{
+		triple += (p->triple[t].key == key) ? p->triple[t].count : 0;
+	}
+	assert( p->total > 100 && p->single[back] == 100 );
+	assert( p->pair[back*WR_PROFILE_CODES + back] == 99 && triple == 98 );
+
+	WRstr report;
+	wr_opcodeProfile( w, report );
+	assert( strstr(report.c_str(), "Wide:IncLocalLLCompareLT Wide:IncLocalLLCompareLT Wide:IncLocalLLCompareLT") );
+
+	wr_resetOpcodeProfile( w );
+	assert( !p->total && !p->single[back] && !p->pair[back*WR_PROFILE_CODES + back] && !p->triplesUsed );
+
+	wr_destroyState( w );
+}
+#endif
+
+//------------------------------------------------------------------------------
+// a packed array made by the host, written by script and read back
+void testTypedArrays()
+{
+	WRState* w = wr_newState( 64 );
+	wr_loadVecLib( w );
+
+	const char* script = "function fill( a ) { a[1] = a[0] * 2; ++a[3]; return vec::sum( a ); }\n";
+
+	unsigned char* out = 0;
+	int outLen = 0;
+	if ( wr_compile(script, (int)strlen(script), &out, &outLen) != WR_ERR_None )
+	{
+		assert(0);
+		wr_destroyState( w );
+		return;
+	}
+
+	WRContext* c = wr_run( w, out, outLen, true );
+	assert( c );
+
+	WRValue arg;
+	wr_makeTypedArray( c, &arg, 4, SV_FLOAT32 );
+	unsigned int len = 0;
+	float* f = (float*)arg.array( &len, SV_FLOAT32 );
+	assert( f && len == 4 && f[3] == 0.f );
+	f[0] = 1.5f;
+	f[2] = 3.f;
+
+	WRValue* r = wr_callFunction( c, "fill", &arg, 1 );
+	assert( r && r->isFloat() && r->asFloat() == 8.5f );
+	assert( f[1] == 3.f && f[3] == 1.f );
+	assert( !arg.array(&len, SV_INT32) );
+
+	wr_makeTypedArray( c, &arg, 4, SV_UINT8 );
+	unsigned char* u = (unsigned char*)arg.array( &len, SV_UINT8 );
+	assert( u && len == 4 );
+	u[0] = 250;
+	r = wr_callFunction( c, "fill", &arg, 1 );
+	assert( r && r->asInt() == 250 + (500 & 0xFF) + 1 );
+	assert( u[1] == (500 & 0xFF) );
+
+	wr_destroyState( w );
+}
+
+#ifdef WRENCH_GENERATIONAL_GC
+//------------------------------------------------------------------------------
+// host writes of new values into promoted containers, and switching the
+// mode back while there is an old generation
+void testGenerationalGC()
+{
+	WRState* w = wr_newState( 64 );
+	wr_setAllocatedMemoryGCHint( w, 0 );
+	wr_setGCMode( w, WR_GC_GENERATIONAL );
+
+	const char* script = "var held[];\n"
+						 "function churn() { var t = 0; for( var i=0; i<200; ++i ) { var s = \"x\" + i; t += i; } return t; }\n"
+						 "function check( n ) { return held[n] == (\"host\" + n); }\n";
+
+	unsigned char* out = 0;
+	int outLen = 0;
+	if ( wr_compile(script, (int)strlen(script), &out, &outLen, 0, WR_INCLUDE_GLOBALS) != WR_ERR_None )
+	{
+		assert(0);
+		wr_destroyState( w );
+		return;
+	}
+
+	WRContext* c = wr_run( w, out, outLen, true );
+	assert( c );
+
+	// promote 'held' then hand it strings allocated afterwards
+	assert( wr_callFunction(c, "churn") );
+
+	char buf[32];
+	int n;
+	for( n=0; n<16; ++n )
+	{
+		WrenchValue held( c, "held" );
+		sprintf( buf, "host%d", n );
+		wr_makeString( c, held.asArrayMember(n), buf );
+
+		assert( wr_callFunction(c, "churn") );
+	}
+
+	WRValue arg;
+	for( n=0; n<16; ++n )
+	{
+		wr_makeInt( &arg, n );
+		WRValue* r = wr_callFunction( c, "check", &arg, 1 );
+		assert( r && r->asInt() == 1 );
+	}
+
+	wr_setGCMode( w, WR_GC_FULL );
+	assert( wr_callFunction(c, "churn") );
+
+	for( n=0; n<16; ++n )
+	{
+		wr_makeInt( &arg, n );
+		WRValue* r = wr_callFunction( c, "check", &arg, 1 );
+		assert( r && r->asInt() == 1 );
+	}
+
+	wr_destroyState( w );
+}
+#endif
+
+#ifdef WRENCH_POOL_ALLOCATOR
+//------------------------------------------------------------------------------
+// pooled arrays that outgrow their block, and objects that outlive the
+// pool being switched off
+void testPoolAllocator()
+{
+	WRState* w = wr_newState( 64 );
+	wr_loadAllLibs( w );
+	wr_setAllocatedMemoryGCHint( w, 0 );
+	wr_setPoolAllocator( w, true );
+
+	const char* script = "var a[] = { 1, 2 };\n"
+						 "var s = \"short\";\n"
+						 "function grow( n ) { for( var i=0; i<n; ++i ) { list::push_back( a, i ); s += \"x\"; } return a._count; }\n"
+						 "function sum() { var t = 0; for( var v : a ) { t += v; } return t + s._count; }\n";
+
+	unsigned char* out = 0;
+	int outLen = 0;
+	if ( wr_compile(script, (int)strlen(script), &out, &outLen) != WR_ERR_None )
+	{
+		assert(0);
+		wr_destroyState( w );
+		return;
+	}
+
+	WRContext* c = wr_run( w, out, outLen, true );
+	assert( c );
+
+	WRValue arg;
+	wr_makeInt( &arg, 100 );
+	WRValue* r = wr_callFunction( c, "grow", &arg, 1 );
+	assert( r && r->asInt() == 102 );
+
+	// 1 + 2 + (0..99), plus the 105 characters in s
+	r = wr_callFunction( c, "sum" );
+	assert( r && r->asInt() == 3 + 4950 + 105 );
+
+	wr_setPoolAllocator( w, false );
+	r = wr_callFunction( c, "grow", &arg, 1 );
+	assert( r && r->asInt() == 202 );
+	r = wr_callFunction( c, "sum" );
+	assert( r && r->asInt() == 3 + 9900 + 205 );
+
+	wr_destroyState( w );
+}
+#endif
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#include <unistd.h>
+
+struct ThreadedCorpus
+{
+	WRstr* code;
+	WRstr* expect;
+	int files;
+	int passes;
+	int failures;
+};
+
+//------------------------------------------------------------------------------
+// compile and run one corpus file on its own context, returns what it printed
+static bool runCorpusFile( WRState* w, WRstr const& code, WRstr& logger )
+{
+	unsigned char* out;
+	int outLen;
+	if ( wr_compile(code, code.size(), &out, &outLen, 0, WR_INCLUDE_GLOBALS|WR_NON_STRICT_VAR) != WR_ERR_None )
+	{
+		return false;
+	}
+
+	wr_registerFunction( w, "print", emit, &logger );
+	wr_registerFunction( w, "println", emitln, &logger );
+
+	WRContext* context = wr_run( w, out, outLen );
+
+	int args;
+	WRValue* firstArg;
+	WRValue* returnValue;
+	while( wr_getYieldInfo(context, &firstArg, &args, &returnValue) )
+	{
+		if ( args > 0 )
+		{
+			*returnValue = *firstArg;
+		}
+		wr_continue( context );
+	}
+
+	bool ret = context && !wr_getLastError( w );
+
+	wr_destroyContext( context );
+	wr_free( out );
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+static WRState* newCorpusState()
+{
+	WRState* w = wr_newState( 128 );
+	wr_loadAllLibs( w );
+	wr_setAllocatedMemoryGCHint( w, 0 );
+#ifdef WRENCH_GENERATIONAL_GC
+	wr_setGCMode( w, WR_GC_GENERATIONAL );
+#endif
+#ifdef WRENCH_POOL_ALLOCATOR
+	wr_setPoolAllocator( w, true );
+#endif
+	wr_registerLibraryConstant( w, "TestLC::LIBVAL",  (int32_t)100 );
+	wr_registerLibraryConstant( w, "TestLC::BOTH",    (int32_t)200 );
+	wr_registerLibraryConstant( w, "TestMix::LIBONLY",(int32_t)77  );
+
+	wr_registerFunction( w, "checkIsWrenchArray", checkIsWrenchArray );
+	wr_registerFunction( w, "checkIsRawArray", checkIsRawArray );
+	wr_registerFunction( w, "checkIsString", checkIsString );
+	wr_registerFunction( w, "checkIsHashTable", checkIsHashTable );
+	wr_registerFunction( w, "checkIter", checkIter );
+	wr_registerFunction( w, "checkStruct", checkStruct );
+	return w;
+}
+
+//------------------------------------------------------------------------------
+static void* corpusThread( void* arg )
+{
+	ThreadedCorpus* T = (ThreadedCorpus*)arg;
+
+	WRState* w = newCorpusState();
+	for( int p=0; p<T->passes; ++p )
+	{
+		for( int f=0; f<T->files; ++f )
+		{
+			WRstr logger;
+			if ( !runCorpusFile(w, T->code[f], logger) || logger != T->expect[f] )
+			{
+				++T->failures;
+			}
+		}
+	}
+	wr_destroyState( w );
+
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// every thread owns a state and runs the whole corpus against it, the
+// output must match a single threaded run exactly
+void testThreadedStates()
+{
+	const int maxFiles = 64;
+	WRstr code[maxFiles];
+	WRstr expect[maxFiles];
+	int files = 0;
+
+	FILE* tfile = fopen( "test_files.txt", "r" );
+	if ( !tfile )
+	{
+		return;
+	}
+
+	char buf[256];
+	WRState* w = newCorpusState();
+	while( fgets(buf, 255, tfile) && files < maxFiles )
+	{
+		WRstr name = buf;
+		name.trim();
+
+		// these write to the (shared) filesystem, leave them to the serial run
+		if ( name == "tests/013_files.c" || name == "tests/019_serialize.c" )
+		{
+			continue;
+		}
+
+		if ( !code[files].fileToBuffer(name) )
+		{
+			continue;
+		}
+
+		if ( !runCorpusFile(w, code[files], expect[files]) )
+		{
+			printf( "test [x][threaded states]: FAIL (%s did not run)\n", name.c_str() );
+			assert( 0 );
+		}
+
+		++files;
+	}
+	wr_destroyState( w );
+	fclose( tfile );
+
+	long threads = sysconf( _SC_NPROCESSORS_ONLN );
+	threads = threads < 2 ? 2 : (threads > 8 ? 8 : threads);
+
+	printf( "test [x][threaded states: %d files on %d threads]: ", files, (int)threads );
+
+	pthread_t thread[8];
+	ThreadedCorpus corpus[8];
+	int t;
+	for( t=0; t<threads; ++t )
+	{
+		corpus[t].code = code;
+		corpus[t].expect = expect;
+		corpus[t].files = files;
+		corpus[t].passes = 3;
+		corpus[t].failures = 0;
+		pthread_create( thread + t, 0, corpusThread, corpus + t );
+	}
+
+	int failures = 0;
+	for( t=0; t<threads; ++t )
+	{
+		pthread_join( thread[t], 0 );
+		failures += corpus[t].failures;
+	}
+
+	if ( failures )
+	{
+		printf( "FAIL (%d mismatched runs)\n", failures );
+		assert( 0 );
+	}
+	else
+	{
+		printf( "PASS\n" );
+	}
+}
+#endif
+#endif
+
+
+//------------------------------------------------------------------------------
+// what userCheck() in tests/008_userData.c gets handed; it writes into
+// the container so every run of it needs a new one
+static void makeUserData( WRValue* container, WRValue* integer, char* someArray, char* someBigArray, char* byte, char* byte2 )
+{
+	wr_makeContainer( container );
+	
+	wr_addFloatToContainer( container, "_f", 20.02f );
+
+	wr_addIntToContainer( container, "_i", 1001 );
+	wr_addIntToContainer( container, "_j", 1001 );
+	
+	wr_makeInt( integer, 0 );
+	wr_addValueToContainer( container, "integer", integer );
+
+	strncpy( someArray, "hello", 10 );
+	wr_addArrayToContainer( container, "name", someArray, 10 );
+
+	*byte = (char)0x99;
+	*byte2 = (char)0x99;
+	wr_addArrayToContainer( container, "b", byte, 1 );
+	wr_addArrayToContainer( container, "c", byte2, 1 );
+		
+	wr_addArrayToContainer( container, "big", someBigArray, 0x1FFFFF );
+}
+
+//------------------------------------------------------------------------------
+int runTests( int number )
+{
+	int err = 0;
+
+#ifndef WRENCH_WITHOUT_COMPILER
+	WRstr code;
+	WRstr codeName;
+
+	WRValue integer;
+	char someArray[10];
+	char* someBigArray = (char *)wr_malloc( 0x1FFFFF );
+	someBigArray[0] = 10;
+	someBigArray[0x99] = (char)0x88;
+	someBigArray[10000] = 20;
+	someBigArray[100000] = 30;
+	someBigArray[0x1FFFFE] = 40;
+	char byte;
+	char byte2;
+
+	WRValue container;
+	makeUserData( &container, &integer, someArray, someBigArray, &byte, &byte2 );
+
+	FILE* tfile = fopen( "test_files.txt", "r" );
+
+	WRState* w = wr_newState( 128 );
+
+	wr_loadAllLibs( w );
+	wr_setAllocatedMemoryGCHint( w, 0 );
+#ifdef WRENCH_GENERATIONAL_GC
+	wr_setGCMode( w, WR_GC_GENERATIONAL );
+#endif
+#ifdef WRENCH_POOL_ALLOCATOR
+	wr_setPoolAllocator( w, true );
+#endif
+
+	// library constants for enum interaction tests (012_enums.c)
+	wr_registerLibraryConstant( w, "TestLC::LIBVAL",  (int32_t)100 ); // never overridden by enum
+	wr_registerLibraryConstant( w, "TestLC::BOTH",    (int32_t)200 ); // shadowed by enum after its declaration
+	wr_registerLibraryConstant( w, "TestMix::LIBONLY",(int32_t)77  ); // lib-only member in a mixed namespace
+
+	char buf[256];
+	int fileNumber = 0;
+	WRstr errMsg;
+
+	unsigned char* out;
+	int outLen;
+	while( fgets(buf, 255, tfile) && (err==0) )
+	{
+		if ( !number || (number == fileNumber) )
+		{
+			WRstr expect;
+			codeName = buf;
+			codeName.trim();
+
+			if ( code.fileToBuffer(codeName) )
+			{
+				unsigned int t = 0;
+
+				for( ; (t < code.size()) && (code[t] != '~'); ++t );
+
+				t += 2;
+
+				for( ; t<code.size() && (code[t] != '~'); ++t )
 				{
-					printf( "error: expected\n"
-							"-----------------------------\n"
-							"%s\n"
-							"saw:-------------------------\n"
-							"%s"
-							"\n"
-							"-----------------------------\n",
-							expect.c_str(),
-							logger.c_str() );
+					expect += code[t];
 				}
-				else
+
+				// as written, then again with WR_OPTIMIZE and WR_INLINE_FUNCTIONS,
+				// both have to print what the file expects
+				for( int pass=0; pass<2 && !err; ++pass )
 				{
-					printf( "PASS\n" );
-				}
+					printf( "test [%d][%s%s]: ", fileNumber, codeName.c_str(), pass ? " -optimize -inline" : "" );
+
+					wr_compile( code, code.size(), &out, &outLen, &errMsg, WR_INCLUDE_GLOBALS|WR_NON_STRICT_VAR|flags|(pass ? WR_OPTIMIZE|WR_INLINE_FUNCTIONS : 0) );
+				
+					if ( err )
+					{
+#ifdef WRENCH_WITHOUT_COMPILER
+						printf( "compile error [#%d]\n", err );
+#else
+						printf( "compile error [%s]\n", c_errStrings[err] );
+#endif
+						return -1;
+					}
+
+					WRstr logger;
+					wr_registerFunction( w, "print", emit, &logger );
+					wr_registerFunction( w, "println", emitln, &logger );
+				
+					wr_registerFunction( w, "checkIsWrenchArray", checkIsWrenchArray );
+					wr_registerFunction( w, "checkIsRawArray", checkIsRawArray );
+					wr_registerFunction( w, "checkIsString", checkIsString );
+					wr_registerFunction( w, "checkIsHashTable", checkIsHashTable );
+					wr_registerFunction( w, "checkIter", checkIter );
+					wr_registerFunction( w, "checkStruct", checkStruct );
+
+					WRContext* context = 0;
+					wr_destroyContext( context ); // make sure this doesn't crash
+					context = wr_run( w, out, outLen );
+
+					err = wr_getLastError( w );
+
+					int args;
+					WRValue* firstArg;
+					WRValue* returnValue;
+					while( wr_getYieldInfo(context, &firstArg, &args, &returnValue) )
+					{
+						if ( args > 0 )
+						{
+							*returnValue = *firstArg;
+						}
+						wr_continue( context );
+					}
+
+					if ( context && !(err = wr_getLastError(w)) )
+					{
+						integer.i = 2456;
+						someArray[1] = 'e';
+
+						WRValue* V = wr_callFunction( context, "userCheck", &container, 1 );
+						if ( V && V->i == 77 )
+						{
+							assert( integer.i == 56789 );
+							assert( someArray[1] == 'c' );
+						}
+
+						char testString[12] = "test string";
+						WRValue val;
+						wr_makeString( context, &val, testString, 11 );
+
+						assert( val.isString() );
+					
+						wr_callFunction( context, "stringCheck", &val, 1 );
+						wr_callFunction( context, "stringCheck", &val, 1 );
+						wr_callFunction( context, "stringCheck", &val, 1 );
+						wr_callFunction( context, "stringCheck", &val, 1 );
+
+						V = wr_callFunction( context, "arrayCheck" );
+						if ( V )
+						{
+							V->isWrenchArray();
+							assert( V->isWrenchArray() );
+							char someString[256] = { 0 };
+							someString[0] = someString[0]; // kill warning
+							assert( WRstr(V->indexArray(context, 0, false)->asString(someString)) == "some string" );
+							assert( V->indexArray(context, 1, false)->asFloat() == 0.0f );
+							assert( V->indexArray(context, 2, false)->asInt() == 0);
+							assert( !V->indexArray(context, 3, false)  );
+							assert( V->indexArray(context, 3, true)->asInt() == 0  );
+
+							assert( wr_getValueFromContainer(container, "_i")->asInt() == 1001 );
+						}
+
+						WRValue s;
+						wr_makeString( context, &s, "test string" );
+						wr_callFunction( context, "stringCheck", &s, 1 );
+					}
 
-				wr_free( out );
-				wr_destroyContext( context );
+					if ( err )
+					{
+						printf( "execute error [%s]\n", c_errStrings[err] );
+					}
+					else if ( logger != expect )
+					{
+						printf( "error: expected\n"
+								"-----------------------------\n"
+								"%s\n"
+								"saw:-------------------------\n"
+								"%s"
+								"\n"
+								"-----------------------------\n",
+								expect.c_str(),
+								logger.c_str() );
+					}
+					else
+					{
+						printf( "PASS\n" );
+					}
+
+					wr_free( out );
+					wr_destroyContext( context );
+
+					wr_destroyContainer( &container );
+					makeUserData( &container, &integer, someArray, someBigArray, &byte, &byte2 );
+				}
 			}
 			else if ( fileNumber != 0 )
 			{
@@ -1416,6 +2728,27 @@ int runTests( int number )
 	testBlankVariablesCannotBeInitialized();
 	testDeepHashTableWithWrenchValue();
 	testStateContextOpaquePointer();
+	testCallSiteCache();
+	testWideBytecode();
+	testInlineFunctions();
+	testOptimizer();
+	testTypedLocals();
+	testPackedFrames();
+	testLoopHoisting();
+	testSuperinstructions();
+#ifdef WRENCH_OPCODE_PROFILE
+	testOpcodeProfile();
+#endif
+	testTypedArrays();
+#ifdef WRENCH_GENERATIONAL_GC
+	testGenerationalGC();
+#endif
+#ifdef WRENCH_POOL_ALLOCATOR
+	testPoolAllocator();
+#endif
+#if defined(__linux__) || defined(__APPLE__)
+	testThreadedStates();
+#endif
 #ifdef WRENCH_ENABLE_CROSS_MODULE_EXTERNAL_TEST
 	printf( "test [x][discrete_src/utils/test_wrench_cross_module_globals.cpp]: " );
 #ifdef _WIN32
@@ -1437,6 +2770,14 @@ int runTests( int number )
 	testImport();
 	testHalt();
 	testScheduler();
+	testMigrateContext();
+	testCloneContext();
+#ifdef WRENCH_LINUX_FILE_IO
+	testMappedContext();
+#endif
+#if defined(WRENCH_TIME_SLICES) && defined(WRENCH_THREADED_SCHEDULER)
+	testThreadedScheduler();
+#endif
 	testStackOverflow();
 	testYield2();
 	testStructs();
@@ -1736,9 +3077,300 @@ void testScheduler()
 	assert( !scheduler.removeTask(0x12345678) );
 	wr_free( out );
 
+	// priority orders a tick, a budget outlasts the tick's slice
+	WrenchScheduler ordered( 8 );
+	wr_registerFunction( ordered.state(), "println", emitln, &logger );
+
+	const char* taskA = "for(;;) { println(\"a\"); yield(0); }";
+	wr_compile( taskA, strlen(taskA), &out, &outLen );
+	idA = ordered.addThread( out, outLen, 1000, true );
+	const char* taskB = "for(;;) { println(\"b\"); yield(0); }";
+	wr_compile( taskB, strlen(taskB), &out, &outLen );
+	idB = ordered.addThread( out, outLen, 1000, true );
+
+	logger.clear();
+	ordered.tick();
+	assert( logger == "b\na\n" );
+
+	assert( ordered.setTaskPriority(idA, 5) );
+	assert( !ordered.setTaskPriority(0x12345678, 5) );
+	logger.clear();
+	ordered.tick();
+	assert( logger == "a\nb\n" );
+
+	const char* counting = "for( var i=0; i<1000; ++i ) {}";
+	wr_compile( counting, strlen(counting), &out, &outLen );
+	int idC = ordered.addThread( out, outLen, 10, true );
+	assert( idC > 0 && ordered.tasks() == 3 );
+	ordered.tick( 10 );
+	assert( ordered.tasks() == 3 );
+	assert( ordered.setTaskBudget(idC, 100000) );
+	ordered.tick( 10 );
+	assert( ordered.tasks() == 2 );
+
 #endif
 }
 
+//------------------------------------------------------------------------------
+static void countHits( WRContext* c, const WRValue* argv, const int argn, WRValue& retVal, void* usr )
+{
+	++*(int*)usr;
+}
+
+//------------------------------------------------------------------------------
+// a context yielded in one state picks up where it left off in another
+void testMigrateContext()
+{
+	WRState* A = wr_newState( 64 );
+	WRState* B = wr_newState( 64 );
+	int hitsA = 0;
+	int hitsB = 0;
+	wr_registerFunction( A, "hit", countHits, &hitsA );
+	wr_registerFunction( B, "hit", countHits, &hitsB );
+
+	const char* script = "var s = \"abc\"; hit(); yield(0); hit(); s += \"def\";\n"
+						 "function get() { hit(); return s._count; }\n";
+
+	unsigned char* out = 0;
+	int outLen = 0;
+	if ( wr_compile(script, (int)strlen(script), &out, &outLen) != WR_ERR_None )
+	{
+		assert(0);
+		return;
+	}
+
+	WRContext* c = wr_run( A, out, outLen, true );
+	assert( c && wr_getYieldInfo(c) && hitsA == 1 );
+
+	assert( wr_migrateContext(c, B) );
+	assert( !wr_migrateContext(0, B) );
+	wr_continue( c );
+	assert( hitsA == 1 && hitsB == 1 );
+
+	wr_destroyState( A );
+
+	WRValue* r = wr_callFunction( c, "get" );
+	assert( r && r->asInt() == 6 && hitsB == 2 );
+
+	wr_destroyState( B );
+}
+
+//------------------------------------------------------------------------------
+// clones start from the finished global code and never see each other's
+// changes
+void testCloneContext()
+{
+	WRState* w = wr_newState( 64 );
+	wr_loadAllLibs( w );
+	int inits = 0;
+	wr_registerFunction( w, "init", countHits, &inits );
+
+	const char* script = "struct Node { var name; var next; };\n"
+						 "var count = 5;\n"
+						 "var name = \"base\";\n"
+						 "var list[] = { 1, 2, { 3, 4 } };\n"
+						 "var table = { \"a\":1, \"b\":\"two\" };\n"
+						 "var head = new Node;\n"
+						 "head.name = \"head\";\n"
+						 "var tail = new Node;\n"
+						 "head.next = tail;\n"
+						 "var alias = tail;\n"
+						 "var chain = null;\n"
+						 "for( var i=0; i<300; ++i ) { var n = new Node; n.name = i; n.next = chain; chain = n; }\n"
+						 "init();\n"
+						 "function change() { ++count; name += \"!\"; list[2][0] = 30; table[\"a\"] = 10; table[\"c\"] = 3; head.name = \"changed\"; alias.name = \"shared\"; }\n"
+						 "function check( c, n, l, a, h ) { return count == c && name == n && list[2][0] == l && table[\"a\"] == a && head.name == h && head.next.name == alias.name && table[\"b\"] == \"two\"; }\n"
+						 "function chainLength() { var k = 0; for( var c = chain; c; c = c.next ) { if ( c.name != 299 - k ) return -1; ++k; } return k; }\n";
+
+	unsigned char* out = 0;
+	int outLen = 0;
+	if ( wr_compile(script, (int)strlen(script), &out, &outLen) != WR_ERR_None )
+	{
+		assert(0);
+		wr_destroyState( w );
+		return;
+	}
+
+	WRContext* base = wr_run( w, out, outLen );
+	assert( base && inits == 1 );
+
+	WRContext* A = wr_cloneContext( base );
+	WRContext* B = wr_cloneContext( base );
+	assert( A && B && inits == 1 );
+
+	assert( wr_callFunction(A, "change") );
+
+	WRValue args[5];
+	wr_makeInt( args, 6 );
+	wr_makeString( A, args + 1, "base!" );
+	wr_makeInt( args + 2, 30 );
+	wr_makeInt( args + 3, 10 );
+	wr_makeString( A, args + 4, "changed" );
+	WRValue* r = wr_callFunction( A, "check", args, 5 );
+	assert( r && r->asInt() == 1 );
+
+	wr_makeInt( args, 5 );
+	wr_makeString( B, args + 1, "base" );
+	wr_makeInt( args + 2, 3 );
+	wr_makeInt( args + 3, 1 );
+	wr_makeString( B, args + 4, "head" );
+	r = wr_callFunction( B, "check", args, 5 );
+	assert( r && r->asInt() == 1 );
+	r = wr_callFunction( base, "check", args, 5 );
+	assert( r && r->asInt() == 1 );
+
+	wr_destroyContext( A );
+	r = wr_callFunction( B, "chainLength" );
+	assert( r && r->asInt() == 300 );
+
+	// a clone of a clone is just as good, but it must go before its source
+	WRContext* C = wr_cloneContext( B );
+	r = wr_callFunction( C, "chainLength" );
+	assert( r && r->asInt() == 300 );
+	wr_destroyContext( C );
+	wr_destroyContext( B );
+
+	const char* yielder = "yield(0);";
+	unsigned char* yout = 0;
+	int youtLen = 0;
+	assert( wr_compile(yielder, (int)strlen(yielder), &yout, &youtLen) == WR_ERR_None );
+	WRContext* Y = wr_run( w, yout, youtLen, true );
+	assert( Y && !wr_cloneContext(Y) && wr_getLastError(w) == WR_ERR_context_cannot_be_cloned );
+
+	wr_destroyState( w );
+	wr_free( out );
+}
+
+#ifdef WRENCH_LINUX_FILE_IO
+//------------------------------------------------------------------------------
+static bool compileToFile( const char* script, const char* path )
+{
+	unsigned char* out = 0;
+	int outLen = 0;
+	if ( wr_compile(script, (int)strlen(script), &out, &outLen) != WR_ERR_None )
+	{
+		return false;
+	}
+
+	WRstr bytes;
+	bytes.set( (const char*)out, outLen );
+	wr_free( out );
+	return bytes.bufferToFile( path );
+}
+
+//------------------------------------------------------------------------------
+// contexts from the same file share one mapping until it is replaced
+void testMappedContext()
+{
+	const char* path = "_mapped_test.bin";
+	const char* next = "_mapped_test.next";
+
+	if ( !compileToFile("var n = 10; function get() { return n; } function bump() { n += 1; return n; }", path) )
+	{
+		assert(0);
+		return;
+	}
+
+	WRState* w = wr_newState( 64 );
+
+	WRContext* A = wr_runMapped( w, path );
+	WRContext* B = wr_runMapped( w, path );
+	assert( A && B && A->bottom == B->bottom && A->localFunctions == B->localFunctions );
+
+	// each still has its own globals
+	WRValue* r = wr_callFunction( A, "bump" );
+	assert( r && r->asInt() == 11 );
+	r = wr_callFunction( B, "get" );
+	assert( r && r->asInt() == 10 );
+
+	// a new file at the same path gets a new mapping, A keeps the old one
+	assert( compileToFile("function get() { return 20; }", next) );
+	assert( rename(next, path) == 0 );
+
+	WRContext* C = wr_runMapped( w, path );
+	assert( C && C->bottom != A->bottom );
+	r = wr_callFunction( C, "get" );
+	assert( r && r->asInt() == 20 );
+
+	wr_destroyContext( B );
+	r = wr_callFunction( A, "get" );
+	assert( r && r->asInt() == 11 );
+
+	assert( !wr_runMapped(w, "_mapped_test.missing") );
+	assert( wr_getLastError(w) == WR_ERR_bad_bytecode_CRC );
+
+	wr_destroyState( w );
+	remove( path );
+}
+#endif
+
+#if defined(WRENCH_TIME_SLICES) && defined(WRENCH_THREADED_SCHEDULER)
+//------------------------------------------------------------------------------
+// lopsided queues so the idle workers have to steal
+void testThreadedScheduler()
+{
+	WrenchScheduler scheduler( 64, 4 );
+	assert( scheduler.workers() == 4 );
+
+	int done[4] = { 0, 0, 0, 0 }; // per worker, they run concurrently
+	int w;
+	for( w=0; w<4; ++w )
+	{
+		wr_registerFunction( scheduler.state(w), "done", countHits, done + w );
+	}
+
+	const char* task = "var t = 0; for( var i=0; i<1000; ++i ) { t += i; } if ( t == 499500 ) { done(); }";
+	unsigned char* out = 0;
+	int outLen = 0;
+	if ( wr_compile(task, (int)strlen(task), &out, &outLen) != WR_ERR_None )
+	{
+		assert(0);
+		return;
+	}
+
+	// new tasks go to the least loaded worker, lowest first
+	int ids[400];
+	int n;
+	for( n=0; n<400; ++n )
+	{
+		ids[n] = scheduler.addThread( out, outLen, 50 );
+		assert( ids[n] > 0 );
+	}
+
+	int kept = 0;
+	for( n=0; n<400; ++n )
+	{
+		if ( (n & 3) && n > 40 )
+		{
+			assert( scheduler.removeTask(ids[n]) );
+			continue;
+		}
+
+		++kept;
+		if ( !(n % 10) )
+		{
+			assert( scheduler.setTaskPriority(ids[n], 1) );
+		}
+		if ( !(n % 7) )
+		{
+			assert( scheduler.setTaskBudget(ids[n], 5000) );
+		}
+	}
+	assert( scheduler.tasks() == kept );
+
+	for( n=0; n<10000 && scheduler.tasks(); ++n )
+	{
+		scheduler.tick( 50 );
+	}
+
+	assert( !scheduler.tasks() );
+	assert( !scheduler.lastErr() );
+	assert( done[0] + done[1] + done[2] + done[3] == kept );
+
+	wr_free( out );
+}
+#endif
+
 //------------------------------------------------------------------------------
 void testTimeSlices()
 {
@@ -1815,7 +3447,7 @@ void testD()
 	wr_registerFunction( w, "flame_speed", set_ );
 	wr_registerFunction( w, "flame_brightness", set_ );
 	wr_registerLibraryConstant( w, "rgb::count", (int32_t)5 );
-	wr_Seed = 187280232;
+	wr_setRandomSeed( w, 187280232 );
 	wr_loadStdLib( w );
 
 
@@ -2420,7 +4052,7 @@ namespace wrench_wrapper
 	{
 		if (argn != 2) return;
 
-		wr_makeInt(&retVal, wr_randEx(argv[0].asInt(), argv[1].asInt()));
+		wr_makeInt(&retVal, wr_randEx(c->w, argv[0].asInt(), argv[1].asInt()));
 	}
 
 	static void register_wrench_functions(WRState* w, ControlElements* ce)
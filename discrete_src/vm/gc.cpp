@@ -24,8 +24,113 @@ SOFTWARE.
 
 #include "wrench.h"
 
+#ifdef WRENCH_POOL_ALLOCATOR
+// every block is prefixed with one word: the free list link while it is
+// free, its size class while it is in use
+static const uint16_t c_poolClassSize[ WRENCH_POOL_CLASSES ] = { 64, 96, 128, 192, 256, 384 };
+
+//------------------------------------------------------------------------------
+void* wr_poolAlloc( WRState* w, const unsigned int bytes )
+{
+	const unsigned int needed = bytes + sizeof(void*);
+	unsigned int sizeClass = 0;
+	while( c_poolClassSize[sizeClass] < needed )
+	{
+		if ( ++sizeClass >= WRENCH_POOL_CLASSES )
+		{
+			return 0;
+		}
+	}
+
+	void** block = (void**)w->pool.freeList[sizeClass];
+	if ( !block )
+	{
+		// carve a new slab up into blocks of this class
+		void** slab = (void**)g_malloc( WRENCH_POOL_SLAB_SIZE );
+		if ( !slab )
+		{
+			return 0; // let the caller try the global allocator
+		}
+
+		*slab = w->pool.slabs;
+		w->pool.slabs = slab;
+
+		const unsigned int size = c_poolClassSize[sizeClass];
+		for( unsigned int offset = sizeof(void*); offset + size <= WRENCH_POOL_SLAB_SIZE; offset += size )
+		{
+			block = (void**)((char*)slab + offset);
+			*block = w->pool.freeList[sizeClass];
+			w->pool.freeList[sizeClass] = block;
+		}
+	}
+
+	w->pool.freeList[sizeClass] = *block;
+	*(uintptr_t*)block = sizeClass;
+	return block + 1;
+}
+
+//------------------------------------------------------------------------------
+void wr_poolFree( WRState* w, void* mem )
+{
+	void** block = (void**)mem - 1;
+	uintptr_t sizeClass = *(uintptr_t*)block;
+
+	*block = w->pool.freeList[sizeClass];
+	w->pool.freeList[sizeClass] = block;
+}
+
+//------------------------------------------------------------------------------
+void wr_destroyPool( WRState* w )
+{
+	while( w->pool.slabs )
+	{
+		void* next = *(void**)w->pool.slabs;
+		g_free( w->pool.slabs );
+		w->pool.slabs = next;
+	}
+
+	memset( (char*)w->pool.freeList, 0, sizeof(w->pool.freeList) );
+}
+
+//------------------------------------------------------------------------------
+void wr_setPoolAllocator( WRState* w, const bool enable )
+{
+	// objects already allocated know where they came from, so this can
+	// be changed at any time
+	w->pool.enabled = enable;
+}
+#endif
+
+//------------------------------------------------------------------------------
+void WRContext::freeObject( WRGCBase* svb )
+{
+	svb->clear();
+
+#ifdef WRENCH_POOL_ALLOCATOR
+	if ( svb->m_flags & GCFlag_Pooled )
+	{
+		wr_poolFree( w, svb );
+		return;
+	}
+#endif
+
+	g_free( svb );
+}
+
+#ifdef WRENCH_GENERATIONAL_GC
 //------------------------------------------------------------------------------
 void WRContext::markBase( WRGCBase* svb )
+{
+	markContents( svb );
+	svb->m_flags |= GCFlag_Marked;
+}
+
+//------------------------------------------------------------------------------
+void WRContext::markContents( WRGCBase* svb )
+#else
+//------------------------------------------------------------------------------
+void WRContext::markBase( WRGCBase* svb )
+#endif
 {
 	if ( svb->m_type == SV_VALUE )
 	{
@@ -38,11 +143,7 @@ void WRContext::markBase( WRGCBase* svb )
 	}
 	else if ( svb->m_type == SV_HASH_TABLE )
 	{
-		// hash table points one WRGCBase size PAST the actual pointer,
-		// recover it and mark it
-		((WRGCBase*)(((WRGCObject*)svb)->m_Vdata) - 1)->m_flags |= GCFlag_Marked;
-
-		for( uint32_t i=0; i<((WRGCObject*)svb)->m_mod; ++i )
+		for( uint32_t i=0; i<((WRGCObject*)svb)->m_capacity; ++i )
 		{
 			if ( ((WRGCObject*)svb)->m_hashTable[i] != WRENCH_NULL_HASH )
 			{
@@ -55,23 +156,44 @@ void WRContext::markBase( WRGCBase* svb )
 	else if ( svb->m_type == SV_HASH_ENTRY )
 	{
 		// mark the referenced table so it is not collected
+#ifdef WRENCH_GENERATIONAL_GC
+		if ( !(((WRGCBase*)svb)->m_referencedTable->m_flags & gcSkipFlags) )
+#endif
 		((WRGCBase*)svb)->m_referencedTable->m_flags |= GCFlag_Marked;
 	}
 
+#ifndef WRENCH_GENERATIONAL_GC
 	svb->m_flags |= GCFlag_Marked;
+#endif
 }
 
 //------------------------------------------------------------------------------
 void WRContext::mark( WRValue* s )
 {
-	if ( IS_CONTAINER_MEMBER(s->xtype) && IS_EXARRAY_TYPE(s->r->xtype) )
+	if ( IS_CONTAINER_MEMBER(s->xtype) )
+	{
+		// we don't mark this type, but we might mark it's target, a
+		// hash table member refers to the table itself
+		if ( s->vb->m_type != SV_HASH_TABLE )
+		{
+			if ( IS_EXARRAY_TYPE(s->r->xtype) )
+			{
+				mark( s->r );
+			}
+			return;
+		}
+	}
+	else if ( !IS_EXARRAY_TYPE(s->xtype) )
 	{
-		// we don't mark this type, but we might mark it's target
-		mark( s->r );
 		return;
 	}
 
-	if ( !IS_EXARRAY_TYPE(s->xtype) || (s->va->m_flags & GCFlag_Marked) )
+#ifdef WRENCH_GENERATIONAL_GC
+	// a minor collection also stops at the old generation
+	if ( s->va->m_flags & gcSkipFlags )
+#else
+	if ( s->va->m_flags & GCFlag_Marked )
+#endif
 	{
 		return;
 	}
@@ -81,6 +203,156 @@ void WRContext::mark( WRValue* s )
 	markBase( s->vb );
 }
 
+#ifdef WRENCH_GENERATIONAL_GC
+//------------------------------------------------------------------------------
+void WRContext::remember( WRGCBase* svb )
+{
+	if ( rememberedCount >= rememberedSize )
+	{
+		uint32_t newSize = rememberedSize ? rememberedSize * 2 : 32;
+		WRGCBase** newList = (WRGCBase**)g_malloc( newSize * sizeof(WRGCBase*) );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+		if ( !newList )
+		{
+			// can't track it, the next collection will have to be a full one
+			g_mallocFailed = true;
+			gcPromoted = 0x80000000;
+			return;
+		}
+#endif
+		if ( remembered )
+		{
+			memcpy( (char*)newList, (char*)remembered, rememberedCount * sizeof(WRGCBase*) );
+			g_free( remembered );
+		}
+		remembered = newList;
+		rememberedSize = newSize;
+	}
+
+	svb->m_flags |= GCFlag_Remembered;
+	remembered[rememberedCount++] = svb;
+}
+
+//------------------------------------------------------------------------------
+bool WRContext::stackHoldsInteriorRefs( WRValue* stackTop )
+{
+	// a ref into a container's storage can be written through at any
+	// time, as long as one exists the container has to stay remembered
+	WRValue* globalSpace = (WRValue *)(this + 1);
+	WRValue* globalTop = globalSpace + globals;
+	WRValue* stackEnd = stack + w->stackSize;
+	
+	for( WRValue* s=stack; s<stackTop; ++s )
+	{
+		if ( IS_CONTAINER_MEMBER(s->xtype) )
+		{
+			return true;
+		}
+		
+		if ( s->type == WR_REF
+			 && (s->r < stack || s->r >= stackEnd)
+			 && (s->r < globalSpace || s->r >= globalTop) )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+void WRContext::minorGC( WRValue* stackTop )
+{
+	gcSkipFlags = GCFlag_Marked | GCFlag_Old;
+
+	WRGCBase* a;
+	for( a=svAllocated; a; a = a->m_nextGC )
+	{
+		if ( (a->m_flags & GCFlag_Perm) && !(a->m_flags & GCFlag_Marked) )
+		{
+			markBase( a );
+		}
+	}
+
+	for( WRValue* s=stack + stackOffset; s<stackTop; ++s)
+	{
+		mark( s );
+	}
+
+	WRValue* globalSpace = (WRValue *)(this + 1);
+	for( unsigned int i=0; i<globals; ++i, ++globalSpace )
+	{
+		mark( globalSpace );
+	}
+
+	// old containers that may have been handed young objects, they
+	// themselves are not marked since the sweep never sees them
+	uint32_t r;
+	for( r=0; r<rememberedCount; ++r )
+	{
+		markContents( remembered[r] );
+	}
+
+	const bool dirty = stackHoldsInteriorRefs( stackTop );
+
+	// sweep the nursery, everything that survives is promoted
+	WRGCBase* current = svAllocated;
+	while( current )
+	{
+		WRGCBase* next = current->m_nextGC;
+		
+		if ( current->m_flags & GCFlag_Marked )
+		{
+			current->m_flags = (current->m_flags & ~GCFlag_Marked) | GCFlag_Old;
+			current->m_nextGC = svOld;
+			svOld = current;
+			++gcPromoted;
+
+			// perms are roots and must always be scanned, and if the stack
+			// still refers into containers they may be written to later
+			if ( (current->m_flags & GCFlag_Perm)
+				 || (dirty && (current->m_type == SV_VALUE || current->m_type == SV_HASH_TABLE)) )
+			{
+				remember( current );
+			}
+		}
+		else
+		{
+			freeObject( current );
+		}
+
+		current = next;
+	}
+
+	svAllocated = 0;
+
+	if ( !dirty )
+	{
+		// nothing can write into the old generation without going
+		// through WR_GC_REMEMBER again
+		uint32_t keep = 0;
+		for( r=0; r<rememberedCount; ++r )
+		{
+			if ( remembered[r]->m_flags & GCFlag_Perm )
+			{
+				remembered[keep++] = remembered[r];
+			}
+			else
+			{
+				remembered[r]->m_flags &= ~GCFlag_Remembered;
+			}
+		}
+		rememberedCount = keep;
+	}
+}
+
+//------------------------------------------------------------------------------
+void wr_setGCMode( WRState* w, const WRGCMode mode )
+{
+	w->gcMode = (uint8_t)mode;
+}
+#endif
+
 //------------------------------------------------------------------------------
 void WRContext::gc( WRValue* stackTop )
 {
@@ -91,6 +363,31 @@ void WRContext::gc( WRValue* stackTop )
 
 	allocatedMemoryHint = 0;
 
+#ifdef WRENCH_GENERATIONAL_GC
+	if ( stackTop
+		 && w->gcMode == WR_GC_GENERATIONAL
+		 && gcPromoted < 1024 + (gcOldObjects >> 1) )
+	{
+		minorGC( stackTop );
+		return;
+	}
+
+	// a full collection folds the old generation back in
+	if ( svOld )
+	{
+		WRGCBase* tail = svOld;
+		while( tail->m_nextGC )
+		{
+			tail = tail->m_nextGC;
+		}
+		tail->m_nextGC = svAllocated;
+		svAllocated = svOld;
+		svOld = 0;
+	}
+
+	gcSkipFlags = GCFlag_Marked;
+#endif
+
 	// mark permenants
 	if ( stackTop ) // zero stacktop means collect EVERYTHING
 	{
@@ -133,38 +430,109 @@ void WRContext::gc( WRValue* stackTop )
 		// otherwise free it as unreferenced
 		else
 		{
-			current->clear();
-
 			if ( prev == 0 )
 			{
 				svAllocated = current->m_nextGC;
-				g_free( current );
+				freeObject( current );
 				current = svAllocated;
 			}
 			else
 			{
 				prev->m_nextGC = current->m_nextGC;
-				g_free( current );
+				freeObject( current );
 				current = prev->m_nextGC;
 			}
 		}
 	}
+
+#ifdef WRENCH_GENERATIONAL_GC
+	// the remembered set is rebuilt from the survivors, some entries
+	// may have just been freed
+	rememberedCount = 0;
+	gcPromoted = 0;
+	gcOldObjects = 0;
+
+	if ( stackTop && w->gcMode == WR_GC_GENERATIONAL )
+	{
+		const bool dirty = stackHoldsInteriorRefs( stackTop );
+		
+		for( current = svAllocated; current; current = current->m_nextGC )
+		{
+			current->m_flags = (current->m_flags & ~GCFlag_Remembered) | GCFlag_Old;
+			++gcOldObjects;
+
+			if ( (current->m_flags & GCFlag_Perm)
+				 || (dirty && (current->m_type == SV_VALUE || current->m_type == SV_HASH_TABLE)) )
+			{
+				remember( current );
+			}
+		}
+
+		svOld = svAllocated;
+		svAllocated = 0;
+	}
+	else
+	{
+		for( current = svAllocated; current; current = current->m_nextGC )
+		{
+			current->m_flags &= ~(GCFlag_Old | GCFlag_Remembered);
+		}
+	}
+#endif
 }
 
 //------------------------------------------------------------------------------
 WRGCObject* WRContext::getSVA( int size, WRGCObjectType type, bool init )
 {
-	WRGCObject* ret = (WRGCObject*)g_malloc( sizeof(WRGCObject) );
+	WRGCObject* ret;
 
-#ifdef WRENCH_HANDLE_MALLOC_FAIL
-	if ( !ret )
+#ifdef WRENCH_POOL_ALLOCATOR
+	const int bytes = size * WR_SIZEOF_ELEMENT( type );
+	
+	if ( w->pool.enabled
+		 && (int)type >= SV_VALUE
+		 && (ret = (WRGCObject*)wr_poolAlloc(w, sizeof(WRGCObject) + bytes)) )
 	{
-		g_mallocFailed = true;
-		return 0;
+		// small enough for the payload to share the header's block
+		memset( (unsigned char*)ret, 0, sizeof(WRGCObject) );
+		ret->m_flags = GCFlag_Pooled | GCFlag_InlineData;
+		ret->m_type = type;
+		ret->m_capacity = ret->m_size = size;
+		ret->m_data = ret + 1;
+		if ( init )
+		{
+			memset( ret->m_SCdata, 0, bytes );
+		}
+
+		ret->m_nextGC = svAllocated;
+		svAllocated = ret;
+		ret->m_creatorContext = this;
+
+		allocatedMemoryHint += bytes + sizeof(WRGCObject);
+		return ret;
 	}
+
+	if ( w->pool.enabled && (ret = (WRGCObject*)wr_poolAlloc(w, sizeof(WRGCObject))) )
+	{
+		memset( (unsigned char*)ret, 0, sizeof(WRGCObject) );
+		ret->m_flags = GCFlag_Pooled;
+	}
+	else
 #endif
+	{
+		ret = (WRGCObject*)g_malloc( sizeof(WRGCObject) );
+
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+		if ( !ret )
+		{
+			g_mallocFailed = true;
+			return 0;
+		}
+#endif
+
+		memset( (unsigned char*)ret, 0, sizeof(WRGCObject) );
+	}
 
-	memset( (unsigned char*)ret, 0, sizeof(WRGCObject) );
 	ret->m_nextGC = svAllocated;
 	svAllocated = ret;
 
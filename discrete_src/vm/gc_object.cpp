@@ -27,7 +27,8 @@ SOFTWARE.
 //------------------------------------------------------------------------------
 int WRGCObject::init( const unsigned int size, const WRGCObjectType type, bool clear )
 {
-	int ret = (m_size = size);
+	int ret = (m_capacity = m_size = size);
+	m_head = 0;
 
 	if ( (m_type = type) == SV_VALUE )
 	{
@@ -36,7 +37,7 @@ int WRGCObject::init( const unsigned int size, const WRGCObjectType type, bool c
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
 		if ( !m_Vdata )
 		{
-			m_size = 0;
+			m_capacity = m_size = 0;
 			g_mallocFailed = true;
 			return 0;
 		}
@@ -47,51 +48,49 @@ int WRGCObject::init( const unsigned int size, const WRGCObjectType type, bool c
 			memset( m_SCdata, 0, ret );
 		}
 	}
-	else if ( m_type == SV_CHAR )
+	else if ( m_type > SV_VALUE )
 	{
-		m_Cdata = (unsigned char*)g_malloc( size );
+		// chars and the packed numeric types
+		ret *= WR_SIZEOF_ELEMENT( m_type );
+		m_Cdata = (unsigned char*)g_malloc( ret );
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
 		if ( !m_Cdata )
 		{
-			m_size = 0;
+			m_capacity = m_size = 0;
 			g_mallocFailed = true;
 			return 0;
 		}
 #endif
 		if ( clear )
 		{
-			memset( m_SCdata, 0, size );
+			memset( m_SCdata, 0, ret );
 		}
 	}
 	else
 	{
-		growHash( WRENCH_NULL_HASH, size, &ret );
+		// empty tables don't allocate until the first key goes in
+		m_capacity = m_size = 0;
+		m_Vdata = 0;
+		m_hashTable = 0;
+		ret = size ? growHash( size ) : 0;
 	}
 
 	return ret;
 }
 
+//------------------------------------------------------------------------------
+// int keys are their own hash, fold the high half down so keys that
+// differ only up there don't all land on the same slot. small ints
+// stay in order, which is the common case and the cheapest to probe
+static inline uint32_t wr_hashSlot( uint32_t hash )
+{
+	return hash ^ (hash >> 16);
+}
+
 //------------------------------------------------------------------------------
 WRValue* WRGCObject::getAsRawValueHashTable( const uint32_t hash, int* index )
 {
-#ifdef WRENCH_COMPACT
-	int i = getIndexOfHit( hash, false );
-#else
-	int i = hash % m_mod;
-	if ( m_hashTable[i] != hash )
-	{
-		if ( m_hashTable[(i = (i + 1) % m_mod)] != hash )
-		{
-			if ( m_hashTable[(i = (i + 1) % m_mod)] != hash )
-			{
-				if ( m_hashTable[(i = (i + 1) % m_mod)] != hash )
-				{
-					i = getIndexOfHit(hash, true);
-				}
-			}
-		}
-	}
-#endif
+	int i = getIndexOfHit( hash );
 
 	if ( index ) { *index = i; }
 	return m_Vdata + i;
@@ -100,33 +99,49 @@ WRValue* WRGCObject::getAsRawValueHashTable( const uint32_t hash, int* index )
 //------------------------------------------------------------------------------
 WRValue* WRGCObject::exists( const uint32_t hash, bool removeIfPresent )
 {
-	uint32_t index = hash % m_mod;
-
-	if ( m_hashTable[index] != hash )
+	uint32_t* slot = findSlot( hash );
+	if ( !slot )
 	{
-		int tries = 3;
-		do
-		{
-			index = (index + 1) % m_mod;
-			if ( m_hashTable[index] == hash )
-			{
-				goto foundExists;
-			}
-
-		} while( tries-- );
-
 		return 0;
 	}
 
-foundExists:
+	const uint32_t entry = *slot - 1;
+	WRValue* ret = m_Vdata + ((m_type == SV_HASH_TABLE) ? (entry << 1) : entry);
 
 	if ( removeIfPresent )
 	{
+		// pull the rest of the run back over the hole instead of
+		// leaving a tombstone
+		const uint32_t mask = (m_capacity << 1) - 1;
+		uint32_t* slots = m_hashTable + m_capacity;
+		uint32_t s = (uint32_t)(slot - slots) >> 1;
+		for(;;)
+		{
+			uint32_t* next = slots + (((s + 1) & mask) << 1);
+			if ( !next[0] || !(((s + 1) - wr_hashSlot(next[1])) & mask) )
+			{
+				break;
+			}
+
+			slots[s<<1] = next[0];
+			slots[(s<<1) + 1] = next[1];
+			s = (s + 1) & mask;
+		}
+		slots[s<<1] = 0;
+
+		// the entry goes on the free list
+		m_hashTable[entry] = WRENCH_NULL_HASH;
+		if ( m_type == SV_HASH_TABLE )
+		{
+			ret[1].init();
+		}
+		ret->p2 = INIT_AS_INT;
+		ret->ui = m_head;
+		m_head = entry + 1;
 		--m_size;
-		m_hashTable[index] = WRENCH_NULL_HASH;
 	}
 
-	return m_Vdata + ((m_type == SV_HASH_TABLE) ? (index << 1) : index);
+	return ret;
 }
 
 //------------------------------------------------------------------------------
@@ -135,13 +150,13 @@ void* WRGCObject::get( const uint32_t l, int* index )
 	int s = l < m_size ? l : m_size - 1;
 	void* ret = m_Vdata + s;
 
-	if ( m_type == SV_CHAR )
+	if ( m_type > SV_VALUE )
 	{
-		ret = m_Cdata + s;
+		ret = m_Cdata + s*WR_SIZEOF_ELEMENT( m_type );
 	}
 	else if ( m_type == SV_HASH_TABLE )
 	{
-		s = getIndexOfHit(l, false) << 1;
+		s = getIndexOfHit(l) << 1;
 		ret = m_Vdata + s;
 	}
 	else if ( m_type == SV_VOID_HASH_TABLE )
@@ -155,169 +170,176 @@ void* WRGCObject::get( const uint32_t l, int* index )
 }
 
 //------------------------------------------------------------------------------
-uint32_t WRGCObject::getIndexOfHit( const uint32_t hash, const bool inserting )
+uint32_t* WRGCObject::findSlot( const uint32_t hash )
 {
-	uint32_t index = hash % m_mod;
-	if ( m_hashTable[index] == hash )
+	if ( !m_capacity )
 	{
-		return index; // immediate hits should be cheap
+		return 0;
 	}
 
-	int tries = 3;
-	do
+	const uint32_t mask = (m_capacity << 1) - 1;
+	uint32_t* slots = m_hashTable + m_capacity;
+	uint32_t s = wr_hashSlot( hash ) & mask;
+
+	for( uint32_t distance = 0; slots[s<<1]; ++distance, s = (s + 1) & mask )
 	{
-		if ( inserting && m_hashTable[index] == WRENCH_NULL_HASH )
+		const uint32_t h = slots[(s<<1) + 1];
+		if ( h == hash )
 		{
-			++m_size;
-			m_hashTable[index] = hash;
-			return index;
+			return slots + (s<<1);
 		}
 
-		index = (index + 1) % m_mod;
-
-		if ( m_hashTable[index] == hash )
+		// if it were any further along it would have displaced this one
+		if ( ((s - wr_hashSlot(h)) & mask) < distance )
 		{
-			return index;
+			break;
 		}
+	}
 
-	} while( tries-- );
-
-	return inserting ? growHash(hash) : getIndexOfHit( hash, true );
+	return 0;
 }
 
 //------------------------------------------------------------------------------
-uint32_t WRGCObject::growHash( const uint32_t hash, const uint16_t sizeHint, int* sizeAllocated )
+void WRGCObject::addSlot( uint32_t s, uint32_t distance, uint32_t carry, uint32_t hash )
 {
-	// there was a collision with the passed hash, grow until the
-	// collision disappears
-
-	uint16_t start = (sizeHint > m_mod) ? sizeHint : m_mod;
-	int t = 0;
-	for( ; c_primeTable[t] <= start ; ++t );
+	const uint32_t mask = (m_capacity << 1) - 1;
+	uint32_t* slots = m_hashTable + m_capacity;
 
-	for(;;)
+	for( ; slots[s<<1]; ++distance, s = (s + 1) & mask )
 	{
-tryAgain:
-		int newMod = c_primeTable[t];
-
-		int newSize;
-		if ( m_type == SV_VOID_HASH_TABLE )
-		{
-			newSize = newMod;
-		}
-		else
+		// robin hood, take the slot from anything closer to its home
+		const uint32_t theirs = (s - wr_hashSlot(slots[(s<<1) + 1])) & mask;
+		if ( theirs < distance )
 		{
-			newSize = newMod << 1;
+			const uint32_t swapEntry = slots[s<<1];
+			const uint32_t swapHash = slots[(s<<1) + 1];
+			slots[s<<1] = carry;
+			slots[(s<<1) + 1] = hash;
+			carry = swapEntry;
+			hash = swapHash;
+			distance = theirs;
 		}
+	}
+
+	slots[s<<1] = carry;
+	slots[(s<<1) + 1] = hash;
+}
+
+//------------------------------------------------------------------------------
+uint32_t WRGCObject::getIndexOfHit( const uint32_t hash )
+{
+	uint32_t s = 0;
+	uint32_t distance = 0;
+
+	if ( m_capacity )
+	{
+		// same walk as findSlot(), but a miss leaves off exactly where
+		// the new key belongs
+		const uint32_t mask = (m_capacity << 1) - 1;
+		uint32_t* slots = m_hashTable + m_capacity;
+		s = wr_hashSlot( hash ) & mask;
 
-		newSize *= sizeof(WRValue);
-		newSize += sizeof(WRGCBase);
-	
-		int total = newMod*sizeof(uint32_t) + newSize;
-		if ( sizeAllocated )
+		for( ; slots[s<<1]; ++distance, s = (s + 1) & mask )
 		{
-			*sizeAllocated = total;
+			const uint32_t h = slots[(s<<1) + 1];
+			if ( h == hash )
+			{
+				return slots[s<<1] - 1;
+			}
+
+			if ( ((s - wr_hashSlot(h)) & mask) < distance )
+			{
+				break;
+			}
 		}
+	}
 
-		WRGCBase* base = (WRGCBase*)g_malloc( total );
-#ifdef WRENCH_HANDLE_MALLOC_FAIL
-		if ( !base )
+	if ( !m_head )
+	{
+		if ( !growHash(m_capacity << 1) )
 		{
-			g_mallocFailed = true;
 			return 0; // congradulations, clobber this one. we're dying it doesn't matter.
 		}
-#endif
 
-		memset( (unsigned char *)base, 0, total );
+		s = wr_hashSlot( hash ) & ((m_capacity << 1) - 1);
+		distance = 0;
+	}
 
-		uint32_t* proposed = (uint32_t *)((char*)base + newSize);
+	// take the first free entry
+	const uint32_t entry = m_head - 1;
+	WRValue* V = m_Vdata + ((m_type == SV_HASH_TABLE) ? (entry << 1) : entry);
+	m_head = V->ui;
+	V->init();
 
-		for( int n = 0; n<newMod; ++n )
-		{
-			proposed[n] = WRENCH_NULL_HASH;
-		}
+	m_hashTable[entry] = hash;
+	++m_size;
 
-		proposed[ hash % newMod ] = hash;
+	addSlot( s, distance, entry + 1, hash );
 
-		for( unsigned int h=0; h<m_mod; ++h )
-		{
-			int tries = 3;
-			int newEntry = m_hashTable[h] % newMod;
-			for(;;)
-			{
-				if ( proposed[newEntry] == WRENCH_NULL_HASH )
-				{
-					proposed[newEntry] = m_hashTable[h];
-					break;
-				}
-				else if ( tries-- )
-				{
-					newEntry = (newEntry + 1) % newMod;
-				}
-				else
-				{
-					g_free( base );
-					++t;
-
-					assert( (unsigned int)newMod != 49157 );
-
-					goto tryAgain;
-				}
-			}
-		}
+	return entry;
+}
 
-		// accepted, link it into the existing table
-		base->m_type = SV_HASH_INTERNAL;
+//------------------------------------------------------------------------------
+int WRGCObject::growHash( const uint32_t capacity )
+{
+	// entries never move so existing entry indexes stay valid, there
+	// are always twice as many slots as entries
+	uint32_t newCapacity = 2;
+	while( newCapacity < capacity )
+	{
+		newCapacity <<= 1;
+	}
 
-		base->m_nextGC = m_nextGC;
-		m_nextGC = base;
-		
-		WRValue* newValues = (WRValue*)(base + 1);
+	const int per = (m_type == SV_HASH_TABLE) ? 2 : 1;
+	const int total = newCapacity * (per*sizeof(WRValue) + 5*sizeof(uint32_t));
 
-		uint32_t* oldHashTable = m_hashTable;
-		m_hashTable = proposed;
-		int oldMod = m_mod;
-		m_mod = newMod;
+	WRValue* values = (WRValue*)g_malloc( total );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+	if ( !values )
+	{
+		g_mallocFailed = true;
+		return 0;
+	}
+#endif
 
-		for( int v=0; v<oldMod; ++v )
-		{
-			if ( oldHashTable[v] == WRENCH_NULL_HASH )
-			{
-				continue;
-			}
+	uint32_t* hashes = (uint32_t*)(values + newCapacity*per);
+	memset( (unsigned char*)(hashes + newCapacity), 0, newCapacity*4*sizeof(uint32_t) );
 
-			unsigned int newPos = getIndexOfHit( oldHashTable[v], true );
+	const uint32_t oldCapacity = m_capacity;
+	if ( oldCapacity )
+	{
+		memcpy( (unsigned char*)values, (unsigned char*)m_Vdata, oldCapacity*per*sizeof(WRValue) );
+		memcpy( (unsigned char*)hashes, (unsigned char*)m_hashTable, oldCapacity*sizeof(uint32_t) );
+		g_free( m_Vdata );
+	}
 
-			if ( m_type == SV_VOID_HASH_TABLE )
-			{
-				newValues[newPos] = m_Vdata[v];
-				m_Vdata[v].r = newValues + newPos;
-				m_Vdata[v].p2 = INIT_AS_REF;
-			}
-			else
-			{
-				// copy all the new hashes to their new locations
-				WRValue* to = newValues + (newPos<<1);
-				WRValue* from = m_Vdata + (v<<1);
-
-				// value
-				to->p2 = from->p2;
-				to->p = from->p;
-				from->p2 = INIT_AS_REF;
-				from->r = to;
-
-				// key
-				++to;
-				++from;
-				to->p2 = from->p2;
-				to->p = from->p;
-				from->p2 = INIT_AS_REF;
-				from->r = to;
-			}
+	// the new entries go on the front of the free list, lowest first
+	for( uint32_t e = newCapacity; e > oldCapacity; )
+	{
+		--e;
+		WRValue* V = values + e*per;
+		if ( per == 2 )
+		{
+			V[1].init();
 		}
+		V->p2 = INIT_AS_INT;
+		V->ui = m_head;
+		m_head = e + 1;
+		hashes[e] = WRENCH_NULL_HASH;
+	}
 
-		m_Vdata = newValues;
+	m_Vdata = values;
+	m_hashTable = hashes;
+	m_capacity = newCapacity;
 
-		return getIndexOfHit( hash, true );
+	const uint32_t mask = (newCapacity << 1) - 1;
+	for( uint32_t e=0; e<oldCapacity; ++e )
+	{
+		if ( hashes[e] != WRENCH_NULL_HASH )
+		{
+			addSlot( wr_hashSlot(hashes[e]) & mask, 0, e + 1, hashes[e] );
+		}
 	}
+
+	return total;
 }
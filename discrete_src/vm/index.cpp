@@ -25,7 +25,7 @@ SOFTWARE.
 #include "wrench.h"
 
 //------------------------------------------------------------------------------
-void arrayElementToTarget( const uint32_t index, WRValue* target, WRValue* value )
+void arrayElementToTarget( WRContext* c, const uint32_t index, WRValue* target, WRValue* value )
 {
 	if ( target == value )
 	{
@@ -38,10 +38,9 @@ void arrayElementToTarget( const uint32_t index, WRValue* target, WRValue* value
 		{
 			*target = value->va->m_Vdata[ index ];
 		}
-		else if ( value->va->m_type == SV_CHAR )
+		else if ( value->va->m_type > SV_VALUE )
 		{
-			target->p2 = INIT_AS_INT;
-			target->ui = value->va->m_Cdata[ index ];
+			wr_unpackElement( value->va, index, target );
 		}
 		else // SV_HASH_TABLE, right?
 		{
@@ -50,6 +49,12 @@ void arrayElementToTarget( const uint32_t index, WRValue* target, WRValue* value
 	}
 	else
 	{
+#ifdef WRENCH_GENERATIONAL_GC
+		if ( !IS_RAW_ARRAY(value->xtype) )
+		{
+			WR_GC_REMEMBER( c, value->vb );
+		}
+#endif
 		target->r = value;
 		target->p2 = INIT_AS_CONTAINER_MEMBER | ENCODE_ARRAY_ELEMENT_TO_P2( index );
 	}
@@ -64,10 +69,12 @@ WRValue* wr_valueFromConfirmedStruct( WRValue* value, uint32_t hash )
 }
 
 //------------------------------------------------------------------------------
-void wr_doIndexHash( WRValue* index, WRValue* value, WRValue* target )
+void wr_doIndexHash( WRContext* c, WRValue* index, WRValue* value, WRValue* target )
 {
 	uint32_t hash = index->getHash();
 
+	WR_GC_REMEMBER( c, value->vb );
+
 	if ( value->xtype == WR_EX_HASH_TABLE ) 
 	{
 		int element;
@@ -77,7 +84,7 @@ void wr_doIndexHash( WRValue* index, WRValue* value, WRValue* target )
 		*(entry + 1) = *index; // might be the first time it was registered
 
 		target->p2 = INIT_AS_CONTAINER_MEMBER | ENCODE_ARRAY_ELEMENT_TO_P2( element );
-		target->vb = (WRGCBase*)(value->va->m_Vdata) - 1;
+		target->vb = value->vb;
 	}
 	else // naming an element of a struct "S.element"
 	{
@@ -106,13 +113,13 @@ void doIndex_I_X( WRContext* c, WRValue* index, WRValue* value, WRValue* target
 #endif
 	value->p2 = INIT_AS_ARRAY;
 	
-	arrayElementToTarget( index->ui, target, value );
+	arrayElementToTarget( c, index->ui, target, value );
 }
 
 //------------------------------------------------------------------------------
 void doIndex_I_E( WRContext* c, WRValue* index, WRValue* value, WRValue* target )
 {
-	if ( IS_CONTAINER_MEMBER(value->xtype) && IS_RAW_ARRAY(value->r->xtype) )
+	if ( IS_CONTAINER_MEMBER(value->xtype) && value->vb->m_type != SV_HASH_TABLE && IS_RAW_ARRAY(value->r->xtype) )
 	{
 		unsigned int s = DECODE_ARRAY_ELEMENT_FROM_P2(value->r->p2);
 
@@ -125,7 +132,7 @@ void doIndex_I_E( WRContext* c, WRValue* index, WRValue* value, WRValue* target
 
 		if (EXPECTS_HASH_INDEX(value->xtype))
 		{
-			wr_doIndexHash( index, value, target );
+			wr_doIndexHash( c, index, value, target );
 			return;
 		}
 
@@ -168,7 +175,7 @@ void doIndex_I_E( WRContext* c, WRValue* index, WRValue* value, WRValue* target
 #endif
 				value->p2 = INIT_AS_HASH_TABLE;
 
-				wr_doIndexHash( I, value, target );
+				wr_doIndexHash( c, I, value, target );
 				return;
 			}
 		}
@@ -184,7 +191,7 @@ boundsFailed:
 			wr_growValueArray( value->va, index->ui );
 		}
 
-		arrayElementToTarget( index->ui, target, value );
+		arrayElementToTarget( c, index->ui, target, value );
 	}
 }
 
@@ -223,7 +230,7 @@ void doIndex_E_E( WRContext* c, WRValue* index, WRValue* value, WRValue* target
 		}
 		else
 		{
-			wr_doIndexHash( I, V, target );
+			wr_doIndexHash( c, I, V, target );
 		}
 	}
 	else
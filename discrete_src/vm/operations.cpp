@@ -94,15 +94,60 @@ bool wr_concatStringCheck( WRValue* to, WRValue* from, WRValue* target )
 //------------------------------------------------------------------------------
 void wr_growValueArray( WRGCObject* va, int newMinIndex )
 {
-	int size_of = (va->m_type == SV_CHAR) ? 1 : sizeof(WRValue);
+	// size_t so byte counts for large arrays can't wrap
+	size_t size_of = WR_SIZEOF_ELEMENT( va->m_type );
 
 	// increase size to accommodate new element
-	int size_el = va->m_size * size_of;
+	size_t size_el = va->m_size * size_of;
 
-	// create new array to hold the data, and g_free the existing one
+	if ( (uint32_t)newMinIndex >= va->m_capacity )
+	{
+		// grow by half again so appending is amortized O(1)
+		uint32_t capacity = va->m_capacity + (va->m_capacity >> 1);
+		if ( capacity <= (uint32_t)newMinIndex )
+		{
+			capacity = newMinIndex + 1;
+		}
+		
+		// create new array to hold the data, and g_free the existing one
+		uint8_t* old = va->m_Cdata;
+
+		va->m_Cdata = (uint8_t *)g_malloc( capacity * size_of );
+
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+		if ( !va->m_Cdata )
+		{
+			va->m_Cdata = old;
+			g_mallocFailed = true;
+			return;
+		}
+#endif
+
+		memcpy( va->m_Cdata, old, size_el );
+		va->freeData( old - va->m_head * size_of );
+
+		va->m_capacity = capacity;
+		va->m_head = 0;
+	}
+
+	va->m_size = newMinIndex + 1;
+
+	// clear new entries, anything past the old size may be stale
+	memset( va->m_Cdata + size_el, 0, (va->m_size * size_of) - size_el );
+}
+
+//------------------------------------------------------------------------------
+void wr_reserveValueArray( WRGCObject* va, const uint32_t capacity )
+{
+	if ( capacity <= va->m_capacity )
+	{
+		return;
+	}
+
+	size_t size_of = WR_SIZEOF_ELEMENT( va->m_type );
 	uint8_t* old = va->m_Cdata;
 
-	va->m_Cdata = (uint8_t *)g_malloc( (newMinIndex + 1) * size_of );
+	va->m_Cdata = (uint8_t *)g_malloc( capacity * size_of );
 
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
 	if ( !va->m_Cdata )
@@ -112,17 +157,55 @@ void wr_growValueArray( WRGCObject* va, int newMinIndex )
 		return;
 	}
 #endif
-	
-	memcpy( va->m_Cdata, old, size_el );
-	g_free( old );
-	
-	va->m_size = newMinIndex + 1;
 
-	// clear new entries
-	memset( va->m_Cdata + size_el, 0, (va->m_size * size_of) - size_el );
+	memcpy( va->m_Cdata, old, va->m_size * size_of );
+	va->freeData( old - va->m_head * size_of );
+
+	va->m_capacity = capacity;
+	va->m_head = 0;
 }
 
-static WRValue s_temp1;
+//------------------------------------------------------------------------------
+// open 'count' cleared entries at the front of an SV_VALUE array, room
+// is kept in front of m_Vdata (m_head) so this is amortized O(1)
+void wr_growValueArrayFront( WRGCObject* va, const uint32_t count )
+{
+	if ( count > va->m_head )
+	{
+		uint32_t head = count + (va->m_size >> 1);
+
+		WRValue* data = (WRValue*)g_malloc( (head + va->m_size) * sizeof(WRValue) );
+
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+		if ( !data )
+		{
+			g_mallocFailed = true;
+			return;
+		}
+#endif
+
+		memcpy( (char*)(data + head), (char*)va->m_Vdata, va->m_size * sizeof(WRValue) );
+		va->freeData( va->m_Vdata - va->m_head );
+
+		va->m_Vdata = data + head;
+		va->m_head = head;
+		va->m_capacity = va->m_size;
+	}
+
+	va->m_Vdata -= count;
+	va->m_head -= count;
+	va->m_capacity += count;
+	va->m_size += count;
+
+	memset( (char*)va->m_Vdata, 0, count * sizeof(WRValue) );
+}
+
+// scratch results for singleValue()/deref(), one set per thread. Kept as
+// raw words since a thread-local can't have a constructor
+static WR_THREAD_LOCAL uintptr_t s_temp1Storage[ sizeof(WRValue) / sizeof(uintptr_t) ];
+static WR_THREAD_LOCAL uintptr_t s_temp2Storage[ sizeof(WRValue) / sizeof(uintptr_t) ];
+#define s_temp1 (*(WRValue*)s_temp1Storage)
+#define s_temp2 (*(WRValue*)s_temp2Storage)
 
 //------------------------------------------------------------------------------
 WRValue& WRValue::singleValue() const
@@ -136,8 +219,6 @@ WRValue& WRValue::singleValue() const
 	return s_temp1;
 }
 
-static WRValue s_temp2;
-
 //------------------------------------------------------------------------------
 WRValue& WRValue::deref() const
 {
@@ -154,13 +235,14 @@ WRValue& WRValue::deref() const
 	s_temp2.p2 = INIT_AS_INT;
 	unsigned int s = DECODE_ARRAY_ELEMENT_FROM_P2(p2);
 
-	if (IS_RAW_ARRAY(r->xtype))
+	if (vb->m_type == SV_HASH_TABLE)
 	{
-		s_temp2.ui = (s < (uint32_t)(EX_RAW_ARRAY_SIZE_FROM_P2(r->p2))) ? (uint32_t)(unsigned char)(r->c[s]) : 0;
+		// hash table members refer to the table, entries never move
+		return ((WRGCObject*)vb)->m_Vdata[s].deref();
 	}
-	else if (vb->m_type == SV_HASH_INTERNAL)
+	else if (IS_RAW_ARRAY(r->xtype))
 	{
-		return ((WRValue*)(vb + 1))[s].deref();
+		s_temp2.ui = (s < (uint32_t)(EX_RAW_ARRAY_SIZE_FROM_P2(r->p2))) ? (uint32_t)(unsigned char)(r->c[s]) : 0;
 	}
 	else if (s < r->va->m_size)
 	{
@@ -170,13 +252,16 @@ WRValue& WRValue::deref() const
 		}
 		else
 		{
-			s_temp2.ui = (uint32_t)(unsigned char)r->va->m_Cdata[s];
+			wr_unpackElement( r->va, s, &s_temp2 );
 		}
 	}
 
 	return s_temp2;
 }
 
+#undef s_temp1
+#undef s_temp2
+
 //------------------------------------------------------------------------------
 uint32_t WRValue::getHashEx() const
 {
@@ -196,18 +281,18 @@ uint32_t WRValue::getHashEx() const
 		{
 			return wr_hash(va->m_Cdata, va->m_size);
 		}
-		else if (va->m_type == SV_VALUE)
+		else if (va->m_type >= SV_VALUE)
 		{
-			return wr_hash(va->m_Vdata, va->m_size * sizeof(WRValue));
+			return wr_hash(va->m_Vdata, va->m_size * WR_SIZEOF_ELEMENT(va->m_type));
 		}
 	}
 	else if (xtype == WR_EX_HASH_TABLE)
 	{
 		// start with a hash of the key hashes
-		uint32_t hash = wr_hash(va->m_hashTable, va->m_mod * sizeof(uint32_t));
+		uint32_t hash = wr_hash(va->m_hashTable, va->m_capacity * sizeof(uint32_t));
 
 		// hash each element, positionally dependant
-		for (uint32_t e = 0; e < va->m_mod; ++e)
+		for (uint32_t e = 0; e < va->m_capacity; ++e)
 		{
 			if (va->m_hashTable[e] != WRENCH_NULL_HASH)
 			{
@@ -237,6 +322,43 @@ uint32_t WRValue::getHashEx() const
 	return 0;
 }
 
+//------------------------------------------------------------------------------
+void wr_unpackElement( const WRGCObject* va, const uint32_t element, WRValue* value )
+{
+	if ( va->m_type == SV_INT32 )
+	{
+		value->p2 = INIT_AS_INT;
+		value->i = va->m_Idata[element];
+	}
+	else if ( va->m_type == SV_FLOAT32 )
+	{
+		value->p2 = INIT_AS_FLOAT;
+		value->f = va->m_Fdata[element];
+	}
+	else // SV_CHAR and SV_UINT8
+	{
+		value->p2 = INIT_AS_INT;
+		value->ui = va->m_Cdata[element];
+	}
+}
+
+//------------------------------------------------------------------------------
+void wr_packElement( WRGCObject* va, const uint32_t element, const WRValue* value )
+{
+	if ( va->m_type == SV_FLOAT32 )
+	{
+		va->m_Fdata[element] = value->asFloat();
+	}
+	else if ( va->m_type == SV_INT32 )
+	{
+		va->m_Idata[element] = value->asInt();
+	}
+	else
+	{
+		va->m_Cdata[element] = (unsigned char)value->asInt();
+	}
+}
+
 //------------------------------------------------------------------------------
 void wr_valueToEx( const WRValue* ex, WRValue* value )
 {
@@ -259,12 +381,12 @@ void wr_valueToEx( const WRValue* ex, WRValue* value )
 					return; // grow failed, don't write out of bounds
 				}
 #endif
-				ex->va->m_creatorContext->allocatedMemoryHint += s * ((ex->va->m_type == SV_CHAR) ? 1 : sizeof(WRValue));
+				ex->va->m_creatorContext->allocatedMemoryHint += s * WR_SIZEOF_ELEMENT( ex->va->m_type );
 			}
 
-			if ( ex->va->m_type == SV_CHAR )
+			if ( ex->va->m_type != SV_VALUE )
 			{
-				ex->va->m_Cdata[s] = value->ui;
+				wr_packElement( ex->va, s, value );
 			}
 			else
 			{
@@ -272,10 +394,22 @@ void wr_valueToEx( const WRValue* ex, WRValue* value )
 				wr_assign[(V->type<<2)+value->type](V, value);
 			}
 		}
-		else if ( IS_CONTAINER_MEMBER(ex->xtype) && IS_RAW_ARRAY(ex->r->xtype) )
+		else if ( IS_CONTAINER_MEMBER(ex->xtype) && ex->vb->m_type != SV_HASH_TABLE && IS_RAW_ARRAY(ex->r->xtype) )
 		{
 			ex->r->c[s] = value->ui;
 		}
+		else if ( IS_CONTAINER_MEMBER(ex->xtype)
+				  && ex->vb->m_type != SV_HASH_TABLE
+				  && IS_ARRAY(ex->r->xtype)
+				  && ex->r->va->m_type != SV_VALUE )
+		{
+			// chars and packed elements have no WRValue to write
+			// through, deref() would hand back a copy
+			if ( s < ex->r->va->m_size )
+			{
+				wr_packElement( ex->r->va, s, &value->deref() );
+			}
+		}
 		else
 		{
 			ex->deref() = value->deref();
@@ -359,6 +493,8 @@ void wr_assignToHashTable( WRContext* c, WRValue* index, WRValue* value, WRValue
 		table->p2 = INIT_AS_HASH_TABLE;
 	}
 
+	WR_GC_REMEMBER( c, table->vb );
+
 	WRValue *entry = (WRValue *)table->va->get( index->getHash() );
 
 	*entry++ = *value;
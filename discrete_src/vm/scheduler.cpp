@@ -26,82 +26,365 @@ SOFTWARE.
 
 #ifdef WRENCH_TIME_SLICES
 
+#ifdef WRENCH_THREADED_SCHEDULER
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
 //------------------------------------------------------------------------------
 struct WrenchScheduledTask
 {
 	WRContext* context;
 	WrenchScheduledTask* next;
 	int id;
+	int priority;
+	int budget; // instructions per slice, 0 for tick()'s
+	int worker; // whose state the context lives in
 };
 
 //------------------------------------------------------------------------------
-WrenchScheduler::WrenchScheduler( const int stackSizePerThread )
+struct WrenchSchedulerWorker
+{
+	WRState* w;
+
+	// this tick's tasks sorted by priority, the worker takes them from
+	// the front and thieves take them from the back
+	WrenchScheduledTask** queue;
+	int head;
+	int tail;
+	int capacity;
+
+	int owned; // tasks whose context lives in w
+
+	int lastErr;
+	int lastErrId;
+
+#ifdef WRENCH_THREADED_SCHEDULER
+	WrenchScheduler* scheduler;
+	pthread_mutex_t lock; // queue/head/tail
+	pthread_t thread;
+#endif
+};
+
+#ifdef WRENCH_THREADED_SCHEDULER
+//------------------------------------------------------------------------------
+struct WrenchSchedulerSync
+{
+	pthread_mutex_t lock;
+	pthread_cond_t start;
+	pthread_cond_t done;
+	pthread_mutex_t migrate; // contextList of every worker state
+	unsigned int generation; // bumped to start a tick
+	int running; // helper threads still inside the tick
+	bool quit;
+};
+
+#define QUEUE_LOCK( W ) pthread_mutex_lock( &(W)->lock )
+#define QUEUE_UNLOCK( W ) pthread_mutex_unlock( &(W)->lock )
+#else
+#define QUEUE_LOCK( W )
+#define QUEUE_UNLOCK( W )
+#endif
+
+//------------------------------------------------------------------------------
+WrenchScheduler::WrenchScheduler( const int stackSizePerThread, const int workers )
 {
-	m_w = wr_newState( stackSizePerThread );
 	m_tasks = 0;
+	m_taskCount = 0;
+	m_instructionsPerSlice = 0;
 	m_lastErr = 0;
 	m_lastErrId = 0;
+	m_idGenerator = 0;
+
+#ifdef WRENCH_THREADED_SCHEDULER
+	m_workerCount = workers > 0 ? workers : (int)sysconf( _SC_NPROCESSORS_ONLN );
+	m_workerCount = m_workerCount > 0 ? m_workerCount : 1;
+#else
+	m_workerCount = 1;
+#endif
+
+	m_workers = (WrenchSchedulerWorker*)g_malloc( m_workerCount * sizeof(WrenchSchedulerWorker) );
+	memset( (char*)m_workers, 0, m_workerCount * sizeof(WrenchSchedulerWorker) );
+	for( int i=0; i<m_workerCount; ++i )
+	{
+		m_workers[i].w = wr_newState( stackSizePerThread );
+	}
+
+#ifdef WRENCH_THREADED_SCHEDULER
+	m_sync = (WrenchSchedulerSync*)g_malloc( sizeof(WrenchSchedulerSync) );
+	pthread_mutex_init( &m_sync->lock, 0 );
+	pthread_cond_init( &m_sync->start, 0 );
+	pthread_cond_init( &m_sync->done, 0 );
+	pthread_mutex_init( &m_sync->migrate, 0 );
+	m_sync->generation = 0;
+	m_sync->running = 0;
+	m_sync->quit = false;
+
+	// worker 0 is whoever calls tick()
+	for( int t=0; t<m_workerCount; ++t )
+	{
+		m_workers[t].scheduler = this;
+		pthread_mutex_init( &m_workers[t].lock, 0 );
+		if ( t )
+		{
+			pthread_create( &m_workers[t].thread, 0, workerThread, m_workers + t );
+		}
+	}
+#endif
 }
 
 //------------------------------------------------------------------------------
 WrenchScheduler::~WrenchScheduler()
 {
+#ifdef WRENCH_THREADED_SCHEDULER
+	pthread_mutex_lock( &m_sync->lock );
+	m_sync->quit = true;
+	pthread_cond_broadcast( &m_sync->start );
+	pthread_mutex_unlock( &m_sync->lock );
+
+	for( int t=0; t<m_workerCount; ++t )
+	{
+		if ( t )
+		{
+			pthread_join( m_workers[t].thread, 0 );
+		}
+		pthread_mutex_destroy( &m_workers[t].lock );
+	}
+
+	pthread_mutex_destroy( &m_sync->lock );
+	pthread_cond_destroy( &m_sync->start );
+	pthread_cond_destroy( &m_sync->done );
+	pthread_mutex_destroy( &m_sync->migrate );
+	g_free( m_sync );
+#endif
+
+	// contexts first, they may have migrated between states
 	while( m_tasks )
 	{
 		WrenchScheduledTask* next = m_tasks->next;
+		wr_destroyContext( m_tasks->context );
 		g_free( m_tasks );
 		m_tasks = next;
 	}
 
-	wr_destroyState( m_w );
+	for( int i=0; i<m_workerCount; ++i )
+	{
+		wr_destroyState( m_workers[i].w );
+		g_free( m_workers[i].queue );
+	}
+	g_free( m_workers );
 }
 
 //------------------------------------------------------------------------------
-void WrenchScheduler::tick( int instructionsPerSlice )
+WRState* WrenchScheduler::state( const int worker ) const
 {
-	wr_setInstructionsPerSlice( m_w, instructionsPerSlice );
-	WrenchScheduledTask** link = &m_tasks;
-	while( *link )
+	return (worker >= 0 && worker < m_workerCount) ? m_workers[worker].w : 0;
+}
+
+//------------------------------------------------------------------------------
+void WrenchScheduler::tick( const int instructionsPerSlice )
+{
+	m_instructionsPerSlice = instructionsPerSlice;
+
+	// deal the tasks out to the workers that own them
+	int i;
+	for( i=0; i<m_workerCount; ++i )
 	{
-		WrenchScheduledTask* task = *link;
+		WrenchSchedulerWorker* worker = m_workers + i;
+		worker->head = 0;
+		worker->tail = 0;
+		if ( worker->capacity < worker->owned )
+		{
+			g_free( worker->queue );
+			worker->capacity = worker->owned + (worker->owned >> 1);
+			worker->queue = (WrenchScheduledTask**)g_malloc( worker->capacity * sizeof(WrenchScheduledTask*) );
+		}
+	}
 
-		// If this task is complete, unlink it in-place.
-		if ( !task->context->yield_pc )
+	WrenchScheduledTask* task;
+	for( task = m_tasks; task; task = task->next )
+	{
+		WrenchSchedulerWorker* worker = m_workers + task->worker;
+
+		// stable, so equal priorities (the usual case) append in O(1)
+		int slot = worker->tail++;
+		for( ; slot && worker->queue[slot - 1]->priority < task->priority; --slot )
 		{
-			*link = task->next;
-			wr_destroyContext( task->context );
-			g_free( task );
-			continue;
+			worker->queue[slot] = worker->queue[slot - 1];
 		}
+		worker->queue[slot] = task;
+	}
 
-		wr_callFunction( task->context, (WRFunction*)0, task->context->yield_argv, task->context->yield_argn );
+#ifdef WRENCH_THREADED_SCHEDULER
+	pthread_mutex_lock( &m_sync->lock );
+	m_sync->running = m_workerCount - 1;
+	++m_sync->generation;
+	pthread_cond_broadcast( &m_sync->start );
+	pthread_mutex_unlock( &m_sync->lock );
+#endif
+
+	runQueue( m_workers );
+
+#ifdef WRENCH_THREADED_SCHEDULER
+	pthread_mutex_lock( &m_sync->lock );
+	while( m_sync->running )
+	{
+		pthread_cond_wait( &m_sync->done, &m_sync->lock );
+	}
+	pthread_mutex_unlock( &m_sync->lock );
+#endif
+
+	for( i=0; i<m_workerCount; ++i )
+	{
+		m_workers[i].owned = 0;
+		if ( m_workers[i].lastErr )
+		{
+			m_lastErr = m_workers[i].lastErr;
+			m_lastErrId = m_workers[i].lastErrId;
+			m_workers[i].lastErr = 0;
+		}
+	}
 
-		// A task can finish during this tick or may have faulted; remove it either way.
+	// tasks that finished or faulted are done, the rest may have moved
+	WrenchScheduledTask** link = &m_tasks;
+	while( (task = *link) )
+	{
 		if ( !task->context->yield_pc )
 		{
-			if ( m_w->err )
-			{
-				m_lastErr = m_w->err;
-				m_lastErrId = task->id;
-				m_w->err = 0;
-			}
 			*link = task->next;
 			wr_destroyContext( task->context );
 			g_free( task );
+			--m_taskCount;
 			continue;
 		}
 
+		++m_workers[task->worker].owned;
 		link = &task->next;
 	}
 }
 
-static int wr_idGenerator = 0;
+//------------------------------------------------------------------------------
+void WrenchScheduler::runQueue( WrenchSchedulerWorker* worker )
+{
+	const int index = (int)(worker - m_workers);
+	WRState* w = worker->w;
+
+	for(;;)
+	{
+		QUEUE_LOCK( worker );
+		WrenchScheduledTask* task = (worker->head < worker->tail) ? worker->queue[worker->head++] : 0;
+		QUEUE_UNLOCK( worker );
+
+		if ( !task && !(task = steal(worker)) )
+		{
+			return;
+		}
+
+		WRContext* context = task->context;
+		if ( task->worker != index )
+		{
+#ifdef WRENCH_THREADED_SCHEDULER
+			pthread_mutex_lock( &m_sync->migrate );
+			wr_migrateContext( context, w );
+			pthread_mutex_unlock( &m_sync->migrate );
+#endif
+			task->worker = index;
+		}
+
+		if ( !context->yield_pc )
+		{
+			continue; // completed when it was added
+		}
+
+		wr_setInstructionsPerSlice( w, task->budget ? task->budget : m_instructionsPerSlice );
+		wr_callFunction( context, (WRFunction*)0, context->yield_argv, context->yield_argn );
+
+		// A task can finish during this tick or may have faulted, tick() removes it either way.
+		if ( !context->yield_pc && w->err )
+		{
+			worker->lastErr = w->err;
+			worker->lastErrId = task->id;
+			w->err = 0;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+WrenchScheduledTask* WrenchScheduler::steal( WrenchSchedulerWorker* thief )
+{
+	const int index = (int)(thief - m_workers);
+	for( int i=1; i<m_workerCount; ++i )
+	{
+		WrenchSchedulerWorker* victim = m_workers + ((index + i) % m_workerCount);
+
+		QUEUE_LOCK( victim );
+		WrenchScheduledTask* task = (victim->head < victim->tail) ? victim->queue[--victim->tail] : 0;
+		QUEUE_UNLOCK( victim );
+
+		if ( task )
+		{
+			return task;
+		}
+	}
+
+	return 0;
+}
+
+#ifdef WRENCH_THREADED_SCHEDULER
+//------------------------------------------------------------------------------
+void* WrenchScheduler::workerThread( void* arg )
+{
+	WrenchSchedulerWorker* worker = (WrenchSchedulerWorker*)arg;
+	WrenchScheduler* S = worker->scheduler;
+	WrenchSchedulerSync* sync = S->m_sync;
+
+	unsigned int seen = 0;
+	pthread_mutex_lock( &sync->lock );
+	for(;;)
+	{
+		while( !sync->quit && sync->generation == seen )
+		{
+			pthread_cond_wait( &sync->start, &sync->lock );
+		}
+
+		if ( sync->quit )
+		{
+			break;
+		}
+
+		seen = sync->generation;
+		pthread_mutex_unlock( &sync->lock );
+
+		S->runQueue( worker );
+
+		pthread_mutex_lock( &sync->lock );
+		if ( !--sync->running )
+		{
+			pthread_cond_signal( &sync->done );
+		}
+	}
+	pthread_mutex_unlock( &sync->lock );
+
+	return 0;
+}
+#endif
+
 //------------------------------------------------------------------------------
 int WrenchScheduler::addThread( const uint8_t* byteCode, const int size, const int instructionsThisSlice, const bool takeOwnership )
 {
-	wr_setInstructionsPerSlice( m_w, instructionsThisSlice );
+	// new tasks start on whichever worker has the fewest
+	WrenchSchedulerWorker* worker = m_workers;
+	for( int i=1; i<m_workerCount; ++i )
+	{
+		if ( m_workers[i].owned < worker->owned )
+		{
+			worker = m_workers + i;
+		}
+	}
 
-	WRContext* context = wr_run( m_w, byteCode, size, takeOwnership );
+	wr_setInstructionsPerSlice( worker->w, instructionsThisSlice );
+
+	WRContext* context = wr_run( worker->w, byteCode, size, takeOwnership );
 	if ( !context )
 	{
 		return -1; // error running task
@@ -117,15 +400,21 @@ int WrenchScheduler::addThread( const uint8_t* byteCode, const int size, const i
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
 		g_mallocFailed = true;
 #endif
-		m_w->err = WR_ERR_malloc_failed;
+		worker->w->err = WR_ERR_malloc_failed;
 		wr_destroyContext( context );
 		return -1;
 	}
 	task->context = context;
 	task->next = m_tasks;
-	task->id = ++wr_idGenerator;
+	task->id = ++m_idGenerator;
+	task->priority = 0;
+	task->budget = 0;
+	task->worker = (int)(worker - m_workers);
 	m_tasks = task;
-			  	
+
+	++worker->owned;
+	++m_taskCount;
+
 	return task->id;
 }
 
@@ -148,7 +437,10 @@ bool WrenchScheduler::removeTask( const int taskId )
 			{
 				m_tasks = task->next;
 			}
-			
+
+			--m_workers[task->worker].owned;
+			--m_taskCount;
+
 			g_free( task );
 			return true;
 		}
@@ -160,4 +452,34 @@ bool WrenchScheduler::removeTask( const int taskId )
 	return false;
 }
 
+//------------------------------------------------------------------------------
+WrenchScheduledTask* WrenchScheduler::findTask( const int taskId ) const
+{
+	WrenchScheduledTask* task = m_tasks;
+	for( ; task && task->id != taskId; task = task->next );
+	return task;
+}
+
+//------------------------------------------------------------------------------
+bool WrenchScheduler::setTaskPriority( const int taskId, const int priority )
+{
+	WrenchScheduledTask* task = findTask( taskId );
+	if ( task )
+	{
+		task->priority = priority;
+	}
+	return task != 0;
+}
+
+//------------------------------------------------------------------------------
+bool WrenchScheduler::setTaskBudget( const int taskId, const int instructionsPerSlice )
+{
+	WrenchScheduledTask* task = findTask( taskId );
+	if ( task )
+	{
+		task->budget = instructionsPerSlice;
+	}
+	return task != 0;
+}
+
 #endif
@@ -25,7 +25,7 @@ SOFTWARE.
 #include "wrench.h"
 
 //------------------------------------------------------------------------------
-inline bool wr_getNextValue( WRValue* iterator, WRValue* value, WRValue* key )
+inline bool wr_getNextValue( WRContext* context, WRValue* iterator, WRValue* value, WRValue* key )
 {
 	if ( !IS_ITERATOR(iterator->xtype) )
 	{
@@ -34,9 +34,11 @@ inline bool wr_getNextValue( WRValue* iterator, WRValue* value, WRValue* key )
 
 	uint32_t element = DECODE_ARRAY_ELEMENT_FROM_P2( iterator->p2 );
 
+	WR_GC_REMEMBER( context, iterator->vb );
+
 	if ( iterator->va->m_type == SV_HASH_TABLE )
 	{
-		for( ; element<iterator->va->m_mod; ++element )
+		for( ; element<iterator->va->m_capacity; ++element )
 		{
 			if ( iterator->va->m_hashTable[element] != WRENCH_NULL_HASH )
 			{
@@ -76,17 +78,16 @@ inline bool wr_getNextValue( WRValue* iterator, WRValue* value, WRValue* key )
 			value->p2 = INIT_AS_REF;
 			value->r = iterator->va->m_Vdata + element;
 		}
-		else if ( iterator->va->m_type == SV_CHAR )
+		else if ( iterator->va->m_type > SV_VALUE )
 		{
-			value->p2 = INIT_AS_INT;
-			value->i = iterator->va->m_Cdata[element];
+			wr_unpackElement( iterator->va, element, value );
 		}
 		else
 		{
 			return false;
 		}
 
-		iterator->p2 = INIT_AS_ITERATOR | ENCODE_ARRAY_ELEMENT_TO_P2(++element);
+		iterator->p2 = INIT_AS_ITERATOR | ENCODE_ARRAY_ELEMENT_TO_P2(element + 1);
 	}
 
 	return true;
@@ -102,7 +103,12 @@ WRValue* wr_newObjectTable( WRContext* context, WRValue* stackTop, const uint8_t
 	}
 	else
 	{
-		uint32_t offset = READ_16_FROM_PC(pc);
+		uint32_t offset = (uint16_t)READ_16_FROM_PC(pc);
+		if ( (context->flags & WRC_Wide) && offset )
+		{
+			// wide bytecode names the function, offsets may not fit
+			offset = context->localFunctions[offset - 1].namespaceOffset;
+		}
 		table = context->bottom + offset;
 	}
 
@@ -171,6 +177,58 @@ static void dumpStack( const WRValue* bottom, const WRValue* top )
 
 #define DEBUG_PER_INSTRUCTION
 
+#ifdef WRENCH_OPCODE_PROFILE
+//------------------------------------------------------------------------------
+// pc is on the instruction about to be dispatched, pairs and triples
+// are in the order they ran so a taken jump, call or return joins two
+// instructions that are not next to each other in the bytecode
+static void wr_profileOpcode( WROpcodeProfile* p, const unsigned char* pc )
+{
+	const uint32_t code = (*pc == O_Wide) ? (uint32_t)O_LAST + pc[1] : (uint32_t)*pc;
+
+	++p->total;
+	++p->single[code];
+
+	if ( p->last[1] != WR_PROFILE_CODES )
+	{
+		++p->pair[ p->last[1]*WR_PROFILE_CODES + code ];
+
+		if ( p->last[0] != WR_PROFILE_CODES )
+		{
+			const uint32_t key = (p->last[0]*WR_PROFILE_CODES + p->last[1])*WR_PROFILE_CODES + code + 1;
+			for( uint32_t t = ((key * 2654435761u) >> 16) & (WR_PROFILE_TRIPLES - 1); ; t = (t + 1) & (WR_PROFILE_TRIPLES - 1) )
+			{
+				if ( p->triple[t].key == key )
+				{
+					++p->triple[t].count;
+					break;
+				}
+				else if ( p->triple[t].key == 0 )
+				{
+					if ( p->triplesUsed >= (WR_PROFILE_TRIPLES*3)/4 )
+					{
+						++p->lostTriples;
+					}
+					else
+					{
+						++p->triplesUsed;
+						p->triple[t].key = key;
+						p->triple[t].count = 1;
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	p->last[0] = p->last[1];
+	p->last[1] = code;
+}
+ #define PROFILE_DISPATCH wr_profileOpcode( w->opcodeProfile, pc )
+#else
+ #define PROFILE_DISPATCH
+#endif
+
 //------------------------------------------------------------------------------
 #ifdef WRENCH_PROTECT_STACK_FROM_OVERFLOW
 #define CHECK_STACK { if ( stackTop >= stackLimit ) { w->err = WR_ERR_stack_overflow; return 0; } }
@@ -180,7 +238,7 @@ static void dumpStack( const WRValue* bottom, const WRValue* top )
 
 //------------------------------------------------------------------------------
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
-  bool g_mallocFailed = false;
+  WR_THREAD_LOCAL bool g_mallocFailed = false;
   #define MALLOC_FAIL_CHECK {if( g_mallocFailed ) { w->err = WR_ERR_malloc_failed; g_mallocFailed = false; return 0; } }
 #else
   #define MALLOC_FAIL_CHECK
@@ -213,6 +271,13 @@ int wr_slicesUsedLastCall( WRState* w )
 #define CHECK_FORCE_YIELD
 #endif
 
+#if WRENCH_CALL_SITE_CACHE
+// pc is pointing at the function hash of a CallFunctionByHash[AndPop]
+#define LOOKUP_CALL_SITE const uint32_t siteOffset = (uint32_t)(pc - context->bottom); WRCallSiteCache* site = context->callSiteCache + (siteOffset & (WRENCH_CALL_SITE_CACHE - 1))
+#define CALL_SITE_HIT ( site->offset == siteOffset && site->generation == w->callSiteGeneration )
+#define CACHE_CALL_SITE( CCB, USR, WRF ) { site->offset = siteOffset; site->generation = w->callSiteGeneration; site->ccb = (CCB); site->usr = (void*)(USR); site->wrf = (WRF); }
+#endif
+
 //------------------------------------------------------------------------------
 #define WRENCH_JUMPTABLE_INTERPRETER
 #ifdef WRENCH_REALLY_COMPACT
@@ -225,9 +290,133 @@ int wr_slicesUsedLastCall( WRState* w )
 
 //------------------------------------------------------------------------------
 // FASTCONTINUE for when malloc could not have been called so no need to check
+#if defined(WRENCH_QUICKENING) && (!defined(WRENCH_JUMPTABLE_INTERPRETER) || defined(WRENCH_COMPACT))
+#undef WRENCH_QUICKENING
+#endif
+
+#ifdef WRENCH_QUICKENING
+ // the handler for the instruction at 'pc' is at threaded[pc - bottom],
+ // kept as a single biased address so dispatch is one load
+ #define DISPATCH goto **(const void* const*)(dispatchBias + (uintptr_t)(pc++) * sizeof(void*))
+
+ // threaded entry of the instruction whose opcode is LEN bytes behind pc
+ #define QUICK_SLOT( LEN ) (*(const void**)(dispatchBias + (uintptr_t)(pc - (LEN)) * sizeof(void*)))
+
+ // a reference is looked through once, the way the _R_ functions do
+ #define QUICK_TYPE( R ) ( (R)->type == WR_REF ? (R)->r->type : (R)->type )
+ #define QUICK_DEREF quick0 = register0->type == WR_REF ? register0->r : register0; quick1 = register1->type == WR_REF ? register1->r : register1
+
+ // on entry to a generic handler, remember which specialized handlers
+ // it could be replaced with
+ #define QUICK( LABEL ) { quickSlot = &QUICK_SLOT(1); quickII = &&LABEL##_II; quickFF = &&LABEL##_FF; }
+ #define QUICK_INT( LABEL ) { quickSlot = &QUICK_SLOT(1); quickII = &&LABEL##_II; quickFF = 0; }
+
+ // then once its operands are loaded, replace it if they agree
+ #define QUICKEN { const int quickTypes = (QUICK_TYPE(register0)<<2) | QUICK_TYPE(register1); if ( quickTypes == ((WR_INT<<2)|WR_INT) ) { *quickSlot = quickII; } else if ( quickTypes == ((WR_FLOAT<<2)|WR_FLOAT) && quickFF ) { *quickSlot = quickFF; } }
+ #define QUICKEN_ONE { if ( register0->type == WR_INT ) { *quickSlot = quickII; } else if ( register0->type == WR_FLOAT ) { *quickSlot = quickFF; } }
+
+ // specialized handlers look at their operands before consuming
+ // anything, so when the guess is wrong they can put the generic
+ // handler back and run it as if nothing happened
+ #define DEOPT( LABEL ) { QUICK_SLOT(1) = &&LABEL; goto LABEL; }
+ #define QUICK_INTS ( !(quick0->type | quick1->type) )
+ #define QUICK_FLOATS ( quick0->type == WR_FLOAT && quick1->type == WR_FLOAT )
+
+ // where the operands come from, and what it takes to consume them
+ #define QUICK_PEEK_LL register1 = frameBase + READ_8_FROM_PC(pc); register0 = frameBase + READ_8_FROM_PC(pc + 1)
+ #define QUICK_PEEK_GG register1 = globalSpace + READ_8_FROM_PC(pc); register0 = globalSpace + READ_8_FROM_PC(pc + 1)
+ #define QUICK_PEEK_GL register1 = frameBase + READ_8_FROM_PC(pc); register0 = globalSpace + READ_8_FROM_PC(pc + 1)
+ #define QUICK_PEEK_LG register1 = globalSpace + READ_8_FROM_PC(pc); register0 = frameBase + READ_8_FROM_PC(pc + 1)
+ #define QUICK_PEEK_LS register0 = frameBase + READ_8_FROM_PC(pc); register1 = stackTop - 1
+ #define QUICK_PEEK_GS register0 = globalSpace + READ_8_FROM_PC(pc); register1 = stackTop - 1
+ #define QUICK_PEEK_SS register0 = stackTop - 1; register1 = stackTop - 2
+ #define QUICK_TAKE_2 pc += 2
+ #define QUICK_TAKE_1 ++pc
+ #define QUICK_TAKE_1_POP ++pc; --stackTop
+ #define QUICK_TAKE_POP --stackTop
+ #define QUICK_TAKE_POP2 stackTop -= 2
+
+ #define QUICK_LT( A, B ) ((A) < (B))
+ #define QUICK_GT( A, B ) ((A) > (B))
+ #define QUICK_EQ( A, B ) ((A) == (B))
+ #define QUICK_AND( A, B ) ((A) && (B))
+ #define QUICK_OR( A, B ) ((A) || (B))
+ #define QUICK_IS( C ) ((int)(C))
+ #define QUICK_NOT( C ) ((int)!(C))
+ #define QUICK_BZ( C ) ((C) ? 2 : READ_16_FROM_PC(pc))
+ #define QUICK_BNZ( C ) ((C) ? READ_16_FROM_PC(pc) : 2)
+ #define QUICK_BZ8( C ) ((C) ? 2 : (int8_t)READ_8_FROM_PC(pc))
+ #define QUICK_BNZ8( C ) ((C) ? (int8_t)READ_8_FROM_PC(pc) : 2)
+
+ #define QUICK_ADD( A, B ) ((A) + (B))
+ #define QUICK_SUB( A, B ) ((A) - (B))
+ #define QUICK_MUL( A, B ) ((A) * (B))
+ #define QUICK_DIV( A, B ) ((A) / (B))
+ #define QUICK_MOD( A, B ) ((A) % (B))
+ #define QUICK_SHL( A, B ) ((A) << (B))
+ #define QUICK_SHR( A, B ) ((A) >> (B))
+ #define QUICK_BAND( A, B ) ((A) & (B))
+ #define QUICK_BOR( A, B ) ((A) | (B))
+ #define QUICK_BXOR( A, B ) ((A) ^ (B))
+
+ // division by zero is left to the generic handler
+ #define QUICK_ANY( V ) true
+ #define QUICK_NONZERO( V ) ((V) != 0)
+
+ // specialized handlers, each computes 'quick0 OP quick1' the same way
+ // the matching _I_I/_F_F function in operations does, register1 is
+ // still the slot a result replaces
+ #define QUICK_BRANCH( LABEL, PEEK, TAKE, ICMP, FCMP, BRANCH, NEXT ) \
+LABEL##_II: QUICK_PEEK_##PEEK; QUICK_DEREF; if ( !QUICK_INTS ) DEOPT( LABEL ); QUICK_TAKE_##TAKE; pc += BRANCH( ICMP(quick0->i, quick1->i) ); NEXT; \
+LABEL##_FF: QUICK_PEEK_##PEEK; QUICK_DEREF; if ( !QUICK_FLOATS ) DEOPT( LABEL ); QUICK_TAKE_##TAKE; pc += BRANCH( FCMP(quick0->f, quick1->f) ); NEXT;
+
+ #define QUICK_COMPARE( LABEL, PEEK, TAKE, ICMP, FCMP, RESULT ) \
+LABEL##_II: QUICK_PEEK_##PEEK; QUICK_DEREF; if ( !QUICK_INTS ) DEOPT( LABEL ); QUICK_TAKE_##TAKE; register1->i = RESULT( ICMP(quick0->i, quick1->i) ); register1->p2 = INIT_AS_INT; FASTCONTINUE; \
+LABEL##_FF: QUICK_PEEK_##PEEK; QUICK_DEREF; if ( !QUICK_FLOATS ) DEOPT( LABEL ); QUICK_TAKE_##TAKE; register1->i = RESULT( FCMP(quick0->f, quick1->f) ); register1->p2 = INIT_AS_INT; FASTCONTINUE;
+
+ #define QUICK_COMPARE_PUSH( LABEL, PEEK, ICMP, FCMP, RESULT ) \
+LABEL##_II: QUICK_PEEK_##PEEK; QUICK_DEREF; if ( !QUICK_INTS ) DEOPT( LABEL ); QUICK_TAKE_2; stackTop->i = RESULT( ICMP(quick0->i, quick1->i) ); (stackTop++)->p2 = INIT_AS_INT; CHECK_STACK; FASTCONTINUE; \
+LABEL##_FF: QUICK_PEEK_##PEEK; QUICK_DEREF; if ( !QUICK_FLOATS ) DEOPT( LABEL ); QUICK_TAKE_2; stackTop->i = RESULT( FCMP(quick0->f, quick1->f) ); (stackTop++)->p2 = INIT_AS_INT; CHECK_STACK; FASTCONTINUE;
+
+ #define QUICK_BINARY_PUSH( LABEL, PEEK, IOP, FOP, DIVISOR ) \
+LABEL##_II: QUICK_PEEK_##PEEK; QUICK_DEREF; if ( !QUICK_INTS || !DIVISOR(quick1->i) ) DEOPT( LABEL ); QUICK_TAKE_2; stackTop->p2 = INIT_AS_INT; (stackTop++)->i = IOP( quick0->i, quick1->i ); CHECK_STACK; FASTCONTINUE; \
+LABEL##_FF: QUICK_PEEK_##PEEK; QUICK_DEREF; if ( !QUICK_FLOATS || !DIVISOR(quick1->f) ) DEOPT( LABEL ); QUICK_TAKE_2; stackTop->p2 = INIT_AS_FLOAT; (stackTop++)->f = FOP( quick0->f, quick1->f ); CHECK_STACK; FASTCONTINUE;
+
+ #define QUICK_BINARY( LABEL, IOP, FOP, DIVISOR ) \
+LABEL##_II: QUICK_PEEK_SS; QUICK_DEREF; if ( !QUICK_INTS || !DIVISOR(quick1->i) ) DEOPT( LABEL ); QUICK_TAKE_POP; register1->i = IOP( quick0->i, quick1->i ); register1->p2 = INIT_AS_INT; FASTCONTINUE; \
+LABEL##_FF: QUICK_PEEK_SS; QUICK_DEREF; if ( !QUICK_FLOATS || !DIVISOR(quick1->f) ) DEOPT( LABEL ); QUICK_TAKE_POP; register1->f = FOP( quick0->f, quick1->f ); register1->p2 = INIT_AS_FLOAT; FASTCONTINUE;
+
+ #define QUICK_BINARY_STORE( LABEL, SPACE, IOP, FOP, DIVISOR ) \
+LABEL##_II: QUICK_PEEK_SS; QUICK_DEREF; if ( !QUICK_INTS || !DIVISOR(quick1->i) ) DEOPT( LABEL ); QUICK_TAKE_POP2; register2 = SPACE + READ_8_FROM_PC(pc++); register2->p2 = INIT_AS_INT; register2->i = IOP( quick0->i, quick1->i ); FASTCONTINUE; \
+LABEL##_FF: QUICK_PEEK_SS; QUICK_DEREF; if ( !QUICK_FLOATS || !DIVISOR(quick1->f) ) DEOPT( LABEL ); QUICK_TAKE_POP2; register2 = SPACE + READ_8_FROM_PC(pc++); register2->p2 = INIT_AS_FLOAT; register2->f = FOP( quick0->f, quick1->f ); FASTCONTINUE;
+
+ #define QUICK_INT_BINARY( LABEL, IOP ) \
+LABEL##_II: QUICK_PEEK_SS; QUICK_DEREF; if ( !QUICK_INTS ) DEOPT( LABEL ); QUICK_TAKE_POP; register1->i = IOP( quick0->i, quick1->i ); register1->p2 = INIT_AS_INT; FASTCONTINUE;
+
+ // the registers were loaded by the instruction before, in the
+ // opposite order
+ #define QUICK_INT_SKIPLOAD( LABEL, IOP ) \
+LABEL##_II: QUICK_DEREF; if ( !QUICK_INTS ) DEOPT( LABEL ); stackTop->p2 = INIT_AS_INT; (stackTop++)->i = IOP( quick1->i, quick0->i ); CHECK_STACK; FASTCONTINUE;
+
+ // a reference here is not looked through, wr_preinc_R replaces it
+ // with the value
+ #define QUICK_STEP( LABEL, SPACE, OP ) \
+LABEL##_II: register0 = SPACE + READ_8_FROM_PC(pc); if ( register0->type != WR_INT ) DEOPT( LABEL ); QUICK_TAKE_1; OP register0->i; FASTCONTINUE; \
+LABEL##_FF: register0 = SPACE + READ_8_FROM_PC(pc); if ( register0->type != WR_FLOAT ) DEOPT( LABEL ); QUICK_TAKE_1; OP register0->f; FASTCONTINUE;
+#else
+ #ifdef WRENCH_JUMPTABLE_INTERPRETER
+  #define DISPATCH goto *opcodeJumptable[READ_8_FROM_PC(pc++)]
+ #endif
+
+ #define QUICK( LABEL )
+ #define QUICK_INT( LABEL )
+ #define QUICKEN
+ #define QUICKEN_ONE
+#endif
+
 #ifdef WRENCH_JUMPTABLE_INTERPRETER
- #define CONTINUE { DEBUG_PER_INSTRUCTION; MALLOC_FAIL_CHECK; goto *opcodeJumptable[READ_8_FROM_PC(pc++)];  }
- #define FASTCONTINUE { DEBUG_PER_INSTRUCTION; goto *opcodeJumptable[READ_8_FROM_PC(pc++)];  }
+ #define CONTINUE { DEBUG_PER_INSTRUCTION; MALLOC_FAIL_CHECK; PROFILE_DISPATCH; DISPATCH; }
+ #define FASTCONTINUE { DEBUG_PER_INSTRUCTION; PROFILE_DISPATCH; DISPATCH; }
  #define CASE(LABEL) LABEL
 #else
  #define CONTINUE { DEBUG_PER_INSTRUCTION; MALLOC_FAIL_CHECK; continue; }
@@ -290,6 +479,64 @@ int16_t READ_16_FROM_PC_func( const unsigned char* P )
 
 #endif
 
+//------------------------------------------------------------------------------
+// what LocalIndexHash leaves in 'target' for 'value' and the hash at
+// 'pc', using the slot above 'target' for the index the way it does.
+// false if 'value' had to become a table and could not
+static bool wr_indexHashInto( WRContext* context, WRValue* value, WRValue* target, const unsigned char* pc )
+{
+	WRValue* index = target + 1;
+	index->ui = READ_32_FROM_PC(pc);
+	if ( !EXPECTS_HASH_INDEX(value->xtype) )
+	{
+		value->p2 = INIT_AS_HASH_TABLE;
+		value->va = context->getSVA( 0, SV_HASH_TABLE, false );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+		if ( !value->va )
+		{
+			return false;
+		}
+#endif
+		context->gc( index );
+	}
+
+#ifdef WRENCH_COMPACT
+	index->p2 = INIT_AS_INT;
+	wr_index[(WR_INT<<2)|value->type]( context, index, value, target );
+#else
+#if WRENCH_MEMBER_CACHE
+	if ( IS_STRUCT(value->xtype) )
+	{
+		const uint32_t siteOffset = (uint32_t)(pc + 4 - context->bottom);
+		WRMemberCache* site = context->memberCache + (siteOffset & (WRENCH_MEMBER_CACHE - 1));
+		if ( site->table != value->va->m_ROMHashTable || site->offset != siteOffset )
+		{
+			WRValue* member = wr_valueFromConfirmedStruct( value, index->ui );
+			if ( !member )
+			{
+				target->p2 = INIT_AS_INT;
+				target->r = 0;
+				return true;
+			}
+
+			site->table = value->va->m_ROMHashTable;
+			site->offset = siteOffset;
+			site->member = (uint32_t)(member - value->va->m_Vdata);
+		}
+
+		WR_GC_REMEMBER( context, value->vb );
+		target->r = value->va->m_Vdata + site->member;
+		target->p2 = INIT_AS_REF;
+		return true;
+	}
+#endif
+	index->p2 = INIT_AS_INT;
+	wr_doIndexHash( context, index, value, target );
+#endif
+
+	return true;
+}
+
 //------------------------------------------------------------------------------
 WRValue* wr_continue( WRContext* context )
 {
@@ -306,7 +553,9 @@ WRValue* wr_continue( WRContext* context )
 WRValue* wr_callFunction( WRContext* context, WRFunction* function, const WRValue* argv, const int argn )
 {
 #ifdef WRENCH_JUMPTABLE_INTERPRETER
-	const void* opcodeJumptable[] =
+	// static so it is laid down once at compile time rather than
+	// rebuilt on the stack every time a host calls in
+	static const void* const opcodeJumptable[] =
 	{
 		&&Yield,
 
@@ -611,6 +860,8 @@ WRValue* wr_callFunction( WRContext* context, WRFunction* function, const WRValu
 		&&LocalBZ8,
 		&&GlobalBZ,
 		&&GlobalBZ8,
+
+		&&Wide,
 	};
 #endif
 
@@ -675,6 +926,36 @@ WRValue* wr_callFunction( WRContext* context, WRFunction* function, const WRValu
 
 	w->err = WR_ERR_None;
 
+#ifdef WRENCH_QUICKENING
+	if ( !context->threaded )
+	{
+		// every byte gets the handler its value would dispatch to, only
+		// the ones that start an instruction are ever used
+		context->threaded = (const void**)g_malloc( context->bottomSize * sizeof(void*) );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+		if ( !context->threaded )
+		{
+			w->err = WR_ERR_malloc_failed;
+			return 0;
+		}
+#endif
+		for( int32_t b=0; b<context->bottomSize; ++b )
+		{
+			const uint8_t op = READ_8_FROM_PC( context->bottom + b );
+			context->threaded[b] = (op < sizeof(opcodeJumptable)/sizeof(opcodeJumptable[0])) ? opcodeJumptable[op] : 0;
+		}
+	}
+	const uintptr_t dispatchBias = (uintptr_t)context->threaded - (uintptr_t)context->bottom * sizeof(void*);
+#endif
+
+#ifdef WRENCH_QUICKENING
+	const void** quickSlot = 0;
+	const void* quickII = 0;
+	const void* quickFF = 0;
+	WRValue* quick0;
+	WRValue* quick1;
+#endif
+
 	WRValue* stackBase = context->stack + context->stackOffset;
 	WRValue* stackTop;
 #ifdef WRENCH_PROTECT_STACK_FROM_OVERFLOW
@@ -724,7 +1005,12 @@ WRValue* wr_callFunction( WRContext* context, WRFunction* function, const WRValu
 		
 		pc = context->stopLocation;
 
-		context->gc( stackTop + 1 );
+		// hosts calling in per-event mostly find nothing to collect,
+		// don't leave the interpreter to find that out
+		if ( context->allocatedMemoryHint >= w->allocatedMemoryLimit )
+		{
+			context->gc( stackTop + 1 );
+		}
 
 		goto callFunction;
 	}
@@ -743,6 +1029,7 @@ yieldContinue:
 
 	for(;;)
 	{
+		PROFILE_DISPATCH;
 		switch( READ_8_FROM_PC(pc++) )
 		{
 #endif
@@ -869,6 +1156,22 @@ debugReturn:
 				register0 = stackTop->init();
 
 				uint32_t fhash = READ_32_FROM_PC(pc);
+#if WRENCH_CALL_SITE_CACHE
+				LOOKUP_CALL_SITE;
+				if ( CALL_SITE_HIT )
+				{
+					pc += 4;
+					if ( site->ccb )
+					{
+						site->ccb( context, stackTop - args, args, *stackTop, site->usr );
+						goto CallFunctionByHash_continue;
+					}
+
+					import = site->import;
+					function = site->wrf;
+					goto CallFunctionByHash_import;
+				}
+#endif
 				pc += 4;
 				if ( ! ((register1 = w->globalRegistry.getAsRawValueHashTable(fhash))->ccb) )
 				{
@@ -877,33 +1180,38 @@ debugReturn:
 						while( import != context )
 						{
 							WRValue* I;
-								if ( (I = import->registry.exists(fhash, false)) )
+							if ( (I = wr_registry(import).exists(fhash, false)) )
+							{
+								function = I->wrf;
+#if WRENCH_CALL_SITE_CACHE
+								CACHE_CALL_SITE( 0, import, function );
+CallFunctionByHash_import:
+#endif
+								// import shares our stack, tell it where to find it's args
+								uint16_t savedOffset = import->stackOffset;
+								import->stackOffset = (uint16_t)(stackTop - context->stack);
+								register0 = wr_callFunction( import, function, stackTop - args, args );
+								import->stackOffset = savedOffset;
+								if ( import->yield_pc )
 								{
-									// import shares our stack, tell it where to find it's args
-									uint16_t savedOffset = import->stackOffset;
-									import->stackOffset = (uint16_t)(stackTop - context->stack);
-									register0 = wr_callFunction( import, I->wrf, stackTop - args, args );
-									import->stackOffset = savedOffset;
-									if ( import->yield_pc )
-									{
-										w->err = WR_ERR_cannot_call_function_context_yielded;
-										return 0;
-									}
-									if ( !register0 )
-									{
-										return 0;
-									}
-									register0 = stackTop;
+									w->err = WR_ERR_cannot_call_function_context_yielded;
+									return 0;
+								}
+								if ( !register0 )
+								{
+									return 0;
+								}
+								register0 = stackTop;
 
 								if ( *pc == O_NewObjectTable )
 								{
-									if ( !I->wrf->namespaceOffset )
+									if ( !function->namespaceOffset )
 									{
 										w->err = WR_ERR_struct_not_exported;
 										return 0;
 									}
 									
-									table = import->bottom + I->wrf->namespaceOffset;
+									table = import->bottom + function->namespaceOffset;
 									// so this was in service of a new
 									// ObjectTable. no problemo, find
 									// the actual table location and
@@ -937,6 +1245,9 @@ debugReturn:
 				}
 				else
 				{
+#if WRENCH_CALL_SITE_CACHE
+					CACHE_CALL_SITE( register1->ccb, register1->usr, 0 );
+#endif
 					register1->ccb( context, stackTop - args, args, *stackTop, register1->usr );
 				}
 
@@ -964,6 +1275,22 @@ newObjOut:
 				args = READ_8_FROM_PC(pc++);
 
 				uint32_t fhash = READ_32_FROM_PC(pc);
+#if WRENCH_CALL_SITE_CACHE
+				LOOKUP_CALL_SITE;
+				if ( CALL_SITE_HIT )
+				{
+					pc += 4;
+					if ( site->ccb )
+					{
+						site->ccb( context, stackTop - args, args, *stackTop, site->usr );
+						goto CallFunctionByHashAndPop_continue;
+					}
+
+					import = site->import;
+					function = site->wrf;
+					goto CallFunctionByHashAndPop_import;
+				}
+#endif
 				pc += 4;
 				if ( !((register1 = w->globalRegistry.getAsRawValueHashTable(fhash))->ccb) )
 				{
@@ -972,24 +1299,29 @@ newObjOut:
 					{
 						while( import != context )
 						{
-								if ( (register0 = import->registry.exists(fhash, false)) )
+							if ( (register0 = wr_registry(import).exists(fhash, false)) )
+							{
+								function = register0->wrf;
+#if WRENCH_CALL_SITE_CACHE
+								CACHE_CALL_SITE( 0, import, function );
+CallFunctionByHashAndPop_import:
+#endif
+								// import shares our stack, tell it where to find it's args
+								uint16_t savedOffset = import->stackOffset;
+								import->stackOffset = (uint16_t)(stackTop - context->stack);
+								register0 = wr_callFunction( import, function, stackTop - args, args );
+								import->stackOffset = savedOffset;
+								if ( import->yield_pc )
 								{
-									// import shares our stack, tell it where to find it's args
-									uint16_t savedOffset = import->stackOffset;
-									import->stackOffset = (uint16_t)(stackTop - context->stack);
-									register0 = wr_callFunction( import, register0->wrf, stackTop - args, args );
-									import->stackOffset = savedOffset;
-									if ( import->yield_pc )
-									{
-										w->err = WR_ERR_cannot_call_function_context_yielded;
-										return 0;
-									}
-									if ( !register0 )
-									{
-										return 0;
-									}
-									goto CallFunctionByHashAndPop_continue;
+									w->err = WR_ERR_cannot_call_function_context_yielded;
+									return 0;
+								}
+								if ( !register0 )
+								{
+									return 0;
 								}
+								goto CallFunctionByHashAndPop_continue;
+							}
 
 							import = import->imported;
 						}
@@ -1000,6 +1332,9 @@ newObjOut:
 				}
 				else
 				{
+#if WRENCH_CALL_SITE_CACHE
+					CACHE_CALL_SITE( register1->ccb, register1->usr, 0 );
+#endif
 					register1->ccb( context, stackTop - args, args, *stackTop, register1->usr );
 				}
 
@@ -1048,8 +1383,8 @@ callFunction:
 				// initialize locals to int zero
 				for( int l=0; l<function->frameSpaceNeeded; ++l )
 				{
-					(stackTop++)->p2 = INIT_AS_INT;
 					stackTop->p = 0;
+					(stackTop++)->p2 = INIT_AS_INT;
 				}
 			
 				// temp value contains return vector/frame base
@@ -1157,6 +1492,7 @@ callFunction:
 				
 				if ( (uint32_t)READ_32_FROM_PC(table) == hash )
 				{
+					WR_GC_REMEMBER( context, register0->vb );
 					register2 = (((WRValue*)(register0->va->m_data)) + READ_8_FROM_PC(table + 4));
 					wr_assign[register2->type<<2|register1->type]( register2, register1 );
 				}
@@ -1176,6 +1512,7 @@ callFunction:
 				hash = READ_8_FROM_PC(pc++);
 				if ( IS_EXARRAY_TYPE(register0->xtype) && (hash < register0->va->m_size) )
 				{
+					WR_GC_REMEMBER( context, register0->vb );
 					register0 = register0->va->m_Vdata + hash;
 #ifdef WRENCH_COMPACT
 					goto doAssignToLocalAndPop;
@@ -1214,12 +1551,10 @@ callFunction:
 							va->m_Vdata[move] = va->m_Vdata[move+1];
 						}
 					}
-					else if ( register0->va->m_type == SV_CHAR )
+					else if ( hash < va->m_size )
 					{
-						for( uint32_t move = hash; (move+1) < va->m_size; ++move )
-						{
-							va->m_Cdata[move] = va->m_Cdata[move+1];
-						}
+						const int size_of = WR_SIZEOF_ELEMENT( va->m_type );
+						memmove( va->m_Cdata + hash*size_of, va->m_Cdata + (hash + 1)*size_of, (va->m_size - hash - 1) * size_of );
 					}
 
 					--va->m_size;
@@ -1376,8 +1711,33 @@ hashIndexJump:
 #ifdef WRENCH_COMPACT
 				goto indexTempLiteralPostLoad;
 #else
+#if WRENCH_MEMBER_CACHE
+				if ( IS_STRUCT(register0->xtype) )
+				{
+					const uint32_t siteOffset = (uint32_t)(pc - context->bottom);
+					WRMemberCache* site = context->memberCache + (siteOffset & (WRENCH_MEMBER_CACHE - 1));
+					if ( site->table != register0->va->m_ROMHashTable || site->offset != siteOffset )
+					{
+						if ( !(register2 = wr_valueFromConfirmedStruct(register0, stackTop->ui)) )
+						{
+							(stackTop - 1)->p2 = INIT_AS_INT;
+							(stackTop - 1)->r = 0;
+							CONTINUE;
+						}
+
+						site->table = register0->va->m_ROMHashTable;
+						site->offset = siteOffset;
+						site->member = (uint32_t)(register2 - register0->va->m_Vdata);
+					}
+
+					WR_GC_REMEMBER( context, register0->vb );
+					(stackTop - 1)->r = register0->va->m_Vdata + site->member;
+					(stackTop - 1)->p2 = INIT_AS_REF;
+					CONTINUE;
+				}
+#endif
 				stackTop->p2 = INIT_AS_INT;
-				wr_doIndexHash( stackTop, register0, stackTop - 1);
+				wr_doIndexHash( context, stackTop, register0, stackTop - 1);
 				CONTINUE;
 #endif
 			}
@@ -1735,10 +2095,246 @@ load32ToTemp:
 				register1 = 0;
 NextIterator:
 				register2 = globalSpace + READ_8_FROM_PC(pc++);
-				pc += wr_getNextValue( register2, register0, register1) ? 2 : READ_16_FROM_PC(pc);
+NextIteratorLoaded:
+				pc += wr_getNextValue( context, register2, register0, register1) ? 2 : READ_16_FROM_PC(pc);
 				CHECK_FORCE_YIELD;
 				FASTCONTINUE;
 			}
+
+			CASE(Wide):
+			{
+				switch( READ_8_FROM_PC(pc++) )
+				{
+					case W_LoadFromLocal:
+					{
+						stackTop->p = frameBase + (uint16_t)READ_16_FROM_PC(pc);
+						pc += 2;
+						(stackTop++)->p2 = INIT_AS_REF;
+						CHECK_STACK;
+						FASTCONTINUE;
+					}
+
+					case W_LoadFromGlobal:
+					{
+						stackTop->p = globalSpace + (uint16_t)READ_16_FROM_PC(pc);
+						pc += 2;
+						(stackTop++)->p2 = INIT_AS_REF;
+						CHECK_STACK;
+						FASTCONTINUE;
+					}
+
+					case W_CallFunctionByIndex:
+					{
+						args = READ_8_FROM_PC(pc);
+						function = context->localFunctions + (uint16_t)READ_16_FROM_PC(pc + 1);
+						pc += 3;
+						goto callFunction;
+					}
+
+					case W_CallFunctionByIndexSkip1:
+					{
+						args = READ_8_FROM_PC(pc);
+						function = context->localFunctions + (uint16_t)READ_16_FROM_PC(pc + 1);
+						pc += 4;
+						goto callFunction;
+					}
+
+					case W_PushIterator:
+					{
+						register0 = ((READ_8_FROM_PC(pc) & 1) ? frameBase : globalSpace) + (uint16_t)READ_16_FROM_PC(pc + 1);
+						wr_pushIterator[register0->type]( register0, globalSpace + (uint16_t)READ_16_FROM_PC(pc + 3) );
+						pc += 5;
+						FASTCONTINUE;
+					}
+
+					case W_NextValueOrJump:
+					{
+						register0 = ((READ_8_FROM_PC(pc) & 1) ? frameBase : globalSpace) + (uint16_t)READ_16_FROM_PC(pc + 1);
+						register1 = 0;
+						register2 = globalSpace + (uint16_t)READ_16_FROM_PC(pc + 3);
+						pc += 5;
+						goto NextIteratorLoaded;
+					}
+
+					case W_NextKeyValueOrJump:
+					{
+						register1 = ((READ_8_FROM_PC(pc) & 1) ? frameBase : globalSpace) + (uint16_t)READ_16_FROM_PC(pc + 1);
+						register0 = ((READ_8_FROM_PC(pc) & 2) ? frameBase : globalSpace) + (uint16_t)READ_16_FROM_PC(pc + 3);
+						register2 = globalSpace + (uint16_t)READ_16_FROM_PC(pc + 5);
+						pc += 7;
+						goto NextIteratorLoaded;
+					}
+
+					case W_TailCall:
+					{
+						args = READ_8_FROM_PC(pc);
+						function = context->localFunctions + (uint16_t)READ_16_FROM_PC(pc + 1);
+
+						// the arguments were pushed right on top of this
+						// frame's return vector
+						register0 = stackTop - args - 1;
+
+						// anything still pointing into the frame that is
+						// about to be overwritten has to be resolved now
+						for( register1 = register0 + 1; register1 < stackTop; ++register1 )
+						{
+							while( (register1->type == WR_REF || (register1->type == WR_EX && IS_CONTAINER_MEMBER(register1->xtype)))
+								   && register1->r >= frameBase
+								   && register1->r < register0 )
+							{
+								*register1 = (register1->type == WR_REF) ? *register1->r : register1->deref();
+							}
+						}
+
+						// return to wherever this frame would have, the
+						// call below re-pushes the same vector
+						pc = context->bottom + register0->returnOffset;
+						register1 = frameBase;
+						frameBase = register0->frame;
+
+						for( int a=0; a<args; ++a )
+						{
+							register1[a] = register0[a + 1];
+						}
+						stackTop = register1 + args;
+
+						goto callFunction;
+					}
+
+					case W_PopToLocal:
+					{
+						// no deref, the local takes exactly what an
+						// argument slot would have
+						frameBase[(uint16_t)READ_16_FROM_PC(pc)] = *(--stackTop);
+						pc += 2;
+						FASTCONTINUE;
+					}
+
+					case W_SwitchDense:
+					{
+						// rebase so the lowest case is 0, anything below it
+						// wraps high and fails the same bounds check
+						hashLocInt = (--stackTop)->getHash() - (uint32_t)READ_32_FROM_PC(pc);
+						pc += 6; // point at default vector
+
+						if ( hashLocInt < (uint16_t)READ_16_FROM_PC(pc - 2) )
+						{
+							hashLoc = pc + (hashLocInt<<1) + 2;
+							pc += READ_16_FROM_PC( hashLoc );
+						}
+						else
+						{
+							pc += READ_16_FROM_PC( pc );
+						}
+						FASTCONTINUE;
+					}
+
+					// same operand order as the LLCompare/LSCompare
+					// forms, but both sides are known to be ints
+					case W_IntLLCompareLTBZ: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); pc += (register0->i < register1->i) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLLCompareLEBZ: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); pc += (register0->i <= register1->i) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLLCompareGTBZ: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); pc += (register0->i > register1->i) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLLCompareGEBZ: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); pc += (register0->i >= register1->i) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLLCompareEQBZ: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); pc += (register0->i == register1->i) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLLCompareNEBZ: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); pc += (register0->i != register1->i) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+
+					case W_IntLICompareLTBZ: { register0 = frameBase + READ_8_FROM_PC(pc++); pc += 2; pc += (register0->i < READ_16_FROM_PC(pc - 2)) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLICompareLEBZ: { register0 = frameBase + READ_8_FROM_PC(pc++); pc += 2; pc += (register0->i <= READ_16_FROM_PC(pc - 2)) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLICompareGTBZ: { register0 = frameBase + READ_8_FROM_PC(pc++); pc += 2; pc += (register0->i > READ_16_FROM_PC(pc - 2)) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLICompareGEBZ: { register0 = frameBase + READ_8_FROM_PC(pc++); pc += 2; pc += (register0->i >= READ_16_FROM_PC(pc - 2)) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLICompareEQBZ: { register0 = frameBase + READ_8_FROM_PC(pc++); pc += 2; pc += (register0->i == READ_16_FROM_PC(pc - 2)) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLICompareNEBZ: { register0 = frameBase + READ_8_FROM_PC(pc++); pc += 2; pc += (register0->i != READ_16_FROM_PC(pc - 2)) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+
+					case W_IntLCountLTBZ: { register0 = frameBase + READ_8_FROM_PC(pc++); wr_countOfArrayElement( frameBase + READ_8_FROM_PC(pc++), stackTop ); pc += (register0->i < stackTop->i) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+
+					case W_IntLLAddition: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); stackTop->i = wr_iadd_wrap( register0->i, register1->i ); (stackTop++)->p2 = INIT_AS_INT; CHECK_STACK; FASTCONTINUE; }
+					case W_IntLLSubtraction: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); stackTop->i = wr_isub_wrap( register0->i, register1->i ); (stackTop++)->p2 = INIT_AS_INT; CHECK_STACK; FASTCONTINUE; }
+					case W_IntLLMultiplication: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); stackTop->i = wr_imul_wrap( register0->i, register1->i ); (stackTop++)->p2 = INIT_AS_INT; CHECK_STACK; FASTCONTINUE; }
+
+					case W_FloatLLAddition: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); stackTop->f = register0->f + register1->f; (stackTop++)->p2 = INIT_AS_FLOAT; CHECK_STACK; FASTCONTINUE; }
+					case W_FloatLLSubtraction: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); stackTop->f = register0->f - register1->f; (stackTop++)->p2 = INIT_AS_FLOAT; CHECK_STACK; FASTCONTINUE; }
+					case W_FloatLLMultiplication: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); stackTop->f = register0->f * register1->f; (stackTop++)->p2 = INIT_AS_FLOAT; CHECK_STACK; FASTCONTINUE; }
+					case W_FloatLLDivision:
+					{
+						register1 = frameBase + READ_8_FROM_PC(pc++);
+						register0 = frameBase + READ_8_FROM_PC(pc++);
+						if ( register1->f )
+						{
+							stackTop->f = register0->f / register1->f;
+						}
+						else
+						{
+#ifdef WRENCH_TRAP_DIVISION_BY_ZERO
+							w->err = WR_ERR_division_by_zero;
+							return 0;
+#else
+							stackTop->i = 0;
+#endif
+						}
+						(stackTop++)->p2 = INIT_AS_FLOAT;
+						CHECK_STACK;
+						FASTCONTINUE;
+					}
+
+					// the back edge of 'for( ...; i < n; ++i )', the
+					// IncLocal/RelativeJump/LLCompareLTBZ it replaces
+					// left the loop by falling out of the compare, so
+					// this falls through when it fails
+					case W_IncLocalLLCompareLT:
+					{
+						register1 = frameBase + READ_8_FROM_PC(pc++);
+						register0 = frameBase + READ_8_FROM_PC(pc++);
+#ifdef WRENCH_COMPACT
+						register2 = stackTop + 1;
+						register2->i = 1;
+						register2->p2 = INIT_AS_INT;
+						wr_FuncAssign[(register0->type<<2)|WR_INT]( register0, register2, wr_addI, addF );
+						pc += wr_Compare[(register0->type<<2)|register1->type]( register0, register1, CompareLTI, CompareLTF ) ? READ_16_FROM_PC(pc) : 2;
+#else
+						if ( register0->type == WR_INT && register1->type == WR_INT )
+						{
+							pc += (++register0->i < register1->i) ? READ_16_FROM_PC(pc) : 2;
+						}
+						else
+						{
+							wr_preinc[ register0->type ]( register0 );
+							pc += wr_CompareLT[(register0->type<<2)|register1->type]( register0, register1 ) ? READ_16_FROM_PC(pc) : 2;
+						}
+#endif
+						CHECK_FORCE_YIELD;
+						CONTINUE;
+					}
+
+					case W_LLIndex:
+					{
+						register0 = frameBase + READ_8_FROM_PC(pc++);
+						register1 = frameBase + READ_8_FROM_PC(pc++);
+						wr_index[(register0->type<<2)|register1->type]( context, register0, register1, stackTop++ );
+						CONTINUE;
+					}
+
+					// both members are looked up in the order they were
+					// written, then left the way the swap would have
+					case W_LLIndexHashPair:
+					{
+						if ( !wr_indexHashInto(context, &(frameBase + READ_8_FROM_PC(pc))->deref(), stackTop, pc + 1)
+							 || !wr_indexHashInto(context, &(frameBase + READ_8_FROM_PC(pc + 5))->deref(), stackTop + 1, pc + 6) )
+						{
+							CONTINUE;
+						}
+						pc += 10;
+
+						const WRValue swap = *stackTop;
+						*stackTop = *(stackTop + 1);
+						*(++stackTop) = swap;
+						++stackTop;
+						CONTINUE;
+					}
+				}
+
+				w->err = WR_ERR_unknown_opcode;
+				return 0;
+			}
 			
 			CASE(Switch):
 			{
@@ -2534,10 +3130,10 @@ compactCompareGG8:
 			CASE(PreDecrement): { register0 = stackTop - 1; wr_predec[ register0->type ]( register0 ); CONTINUE; }
 			CASE(PreIncrementAndPop): { register0 = --stackTop; wr_preinc[ register0->type ]( register0 ); CONTINUE; }
 			CASE(PreDecrementAndPop): { register0 = --stackTop; wr_predec[ register0->type ]( register0 ); CONTINUE; }
-			CASE(IncGlobal): { register0 = globalSpace + READ_8_FROM_PC(pc++); wr_preinc[ register0->type ]( register0 ); CONTINUE; }
-			CASE(DecGlobal): { register0 = globalSpace + READ_8_FROM_PC(pc++); wr_predec[ register0->type ]( register0 ); CONTINUE; }
-			CASE(IncLocal): { register0 = frameBase + READ_8_FROM_PC(pc++); wr_preinc[ register0->type ]( register0 ); CONTINUE; }
-			CASE(DecLocal): { register0 = frameBase + READ_8_FROM_PC(pc++); wr_predec[ register0->type ]( register0 ); CONTINUE; }
+			CASE(IncGlobal): { QUICK(IncGlobal); register0 = globalSpace + READ_8_FROM_PC(pc++); QUICKEN_ONE; wr_preinc[ register0->type ]( register0 ); CONTINUE; }
+			CASE(DecGlobal): { QUICK(DecGlobal); register0 = globalSpace + READ_8_FROM_PC(pc++); QUICKEN_ONE; wr_predec[ register0->type ]( register0 ); CONTINUE; }
+			CASE(IncLocal): { QUICK(IncLocal); register0 = frameBase + READ_8_FROM_PC(pc++); QUICKEN_ONE; wr_preinc[ register0->type ]( register0 ); CONTINUE; }
+			CASE(DecLocal): { QUICK(DecLocal); register0 = frameBase + READ_8_FROM_PC(pc++); QUICKEN_ONE; wr_predec[ register0->type ]( register0 ); CONTINUE; }
 
 			CASE(BLA):
 			{
@@ -2578,8 +3174,10 @@ compactCompareGG8:
 			
 			CASE(GGBinaryMultiplication):
 			{
+				QUICK(GGBinaryMultiplication);
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_MultiplyBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -2587,8 +3185,10 @@ compactCompareGG8:
 
 			CASE(GLBinaryMultiplication):
 			{
+				QUICK(GLBinaryMultiplication);
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_MultiplyBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -2596,8 +3196,10 @@ compactCompareGG8:
 
 			CASE(LLBinaryMultiplication):
 			{
+				QUICK(LLBinaryMultiplication);
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_MultiplyBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -2606,8 +3208,10 @@ compactCompareGG8:
 			
 			CASE(GGBinaryAddition):
 			{
+				QUICK(GGBinaryAddition);
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_AdditionBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -2615,8 +3219,10 @@ compactCompareGG8:
 
 			CASE(GLBinaryAddition):
 			{
+				QUICK(GLBinaryAddition);
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++); 
+				QUICKEN;
 				wr_AdditionBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -2624,8 +3230,10 @@ compactCompareGG8:
 
 			CASE(LLBinaryAddition):
 			{
+				QUICK(LLBinaryAddition);
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_AdditionBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -2634,8 +3242,10 @@ compactCompareGG8:
 			
 			CASE(GGBinarySubtraction):
 			{
+				QUICK(GGBinarySubtraction);
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_SubtractBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -2643,8 +3253,10 @@ compactCompareGG8:
 
 			CASE(GLBinarySubtraction):
 			{
+				QUICK(GLBinarySubtraction);
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_SubtractBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -2652,8 +3264,10 @@ compactCompareGG8:
 
 			CASE(LGBinarySubtraction):
 			{
+				QUICK(LGBinarySubtraction);
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_SubtractBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -2661,8 +3275,10 @@ compactCompareGG8:
 
 			CASE(LLBinarySubtraction):
 			{
+				QUICK(LLBinarySubtraction);
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_SubtractBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -2671,8 +3287,10 @@ compactCompareGG8:
 
 			CASE(GGBinaryDivision):
 			{
+				QUICK(GGBinaryDivision);
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 #ifdef WRENCH_TRAP_DIVISION_BY_ZERO
 				wr_DivideBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop );
 				if ( IS_INVALID(stackTop++->p2) )
@@ -2689,8 +3307,10 @@ compactCompareGG8:
 
 			CASE(GLBinaryDivision):
 			{
+				QUICK(GLBinaryDivision);
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 #ifdef WRENCH_TRAP_DIVISION_BY_ZERO
 				wr_DivideBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop );
 				if ( IS_INVALID(stackTop++->p2) )
@@ -2707,8 +3327,10 @@ compactCompareGG8:
 
 			CASE(LGBinaryDivision):
 			{
+				QUICK(LGBinaryDivision);
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 #ifdef WRENCH_TRAP_DIVISION_BY_ZERO
 				wr_DivideBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop );
 				if ( IS_INVALID(stackTop++->p2) )
@@ -2725,8 +3347,10 @@ compactCompareGG8:
 
 			CASE(LLBinaryDivision):
 			{
+				QUICK(LLBinaryDivision);
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 #ifdef WRENCH_TRAP_DIVISION_BY_ZERO
 				wr_DivideBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop );
 				if ( IS_INVALID(stackTop++->p2) )
@@ -2742,19 +3366,21 @@ compactCompareGG8:
 			}
 
 			
-			CASE(LogicalAnd): { returnFunc = wr_LogicalAND; goto returnFuncNormal; }
-			CASE(LogicalOr): { returnFunc = wr_LogicalOR; goto returnFuncNormal; }
-			CASE(CompareLE): { returnFunc = wr_CompareGT; goto returnFuncInverted; }
-			CASE(CompareGE): { returnFunc = wr_CompareLT; goto returnFuncInverted; }
-			CASE(CompareGT): { returnFunc = wr_CompareGT; goto returnFuncNormal; }
-			CASE(CompareLT): { returnFunc = wr_CompareLT; goto returnFuncNormal; }
+			CASE(LogicalAnd): { QUICK(LogicalAnd); returnFunc = wr_LogicalAND; goto returnFuncNormal; }
+			CASE(LogicalOr): { QUICK(LogicalOr); returnFunc = wr_LogicalOR; goto returnFuncNormal; }
+			CASE(CompareLE): { QUICK(CompareLE); returnFunc = wr_CompareGT; goto returnFuncInverted; }
+			CASE(CompareGE): { QUICK(CompareGE); returnFunc = wr_CompareLT; goto returnFuncInverted; }
+			CASE(CompareGT): { QUICK(CompareGT); returnFunc = wr_CompareGT; goto returnFuncNormal; }
+			CASE(CompareLT): { QUICK(CompareLT); returnFunc = wr_CompareLT; goto returnFuncNormal; }
 			CASE(CompareEQ):
 			{
+				QUICK(CompareEQ);
 				returnFunc = wr_CompareEQ;
 returnFuncNormal:
 				register0 = --stackTop;
 returnFuncPostLoad:
 				register1 = stackTop - 1;
+				QUICKEN;
 				register1->i = (int)returnFunc[(register0->type<<2)|register1->type]( register0, register1 );
 				register1->p2 = INIT_AS_INT;
 				FASTCONTINUE;
@@ -2762,40 +3388,44 @@ returnFuncPostLoad:
 
 			CASE(CompareNE):
 			{
+				QUICK(CompareNE);
 				returnFunc = wr_CompareEQ;
 returnFuncInverted:
 				register0 = --stackTop;
 returnFuncInvertedPostLoad:
 				register1 = stackTop - 1;
+				QUICKEN;
 				register1->i = (int)!returnFunc[(register0->type<<2)|register1->type]( register0, register1 );
 				register1->p2 = INIT_AS_INT;
 				FASTCONTINUE;
 			}
 
-			CASE(GSCompareEQ): { register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareEQ; goto returnFuncPostLoad; }
-			CASE(GSCompareNE): { register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareEQ; goto returnFuncInvertedPostLoad; }
-			CASE(GSCompareGT): { register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareGT; goto returnFuncPostLoad; }
-			CASE(GSCompareLT): { register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareLT; goto returnFuncPostLoad; }
-			CASE(GSCompareGE): { register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareLT; goto returnFuncInvertedPostLoad; }
-			CASE(GSCompareLE): { register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareGT; goto returnFuncInvertedPostLoad; }
+			CASE(GSCompareEQ): { QUICK(GSCompareEQ); register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareEQ; goto returnFuncPostLoad; }
+			CASE(GSCompareNE): { QUICK(GSCompareNE); register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareEQ; goto returnFuncInvertedPostLoad; }
+			CASE(GSCompareGT): { QUICK(GSCompareGT); register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareGT; goto returnFuncPostLoad; }
+			CASE(GSCompareLT): { QUICK(GSCompareLT); register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareLT; goto returnFuncPostLoad; }
+			CASE(GSCompareGE): { QUICK(GSCompareGE); register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareLT; goto returnFuncInvertedPostLoad; }
+			CASE(GSCompareLE): { QUICK(GSCompareLE); register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareGT; goto returnFuncInvertedPostLoad; }
 							   
-			CASE(LSCompareEQ): { register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareEQ; goto returnFuncPostLoad; }
-			CASE(LSCompareNE): { register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareEQ; goto returnFuncInvertedPostLoad; }
-			CASE(LSCompareGT): { register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareGT; goto returnFuncPostLoad; }
-			CASE(LSCompareLT): { register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareLT; goto returnFuncPostLoad; }
-			CASE(LSCompareGE): { register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareLT; goto returnFuncInvertedPostLoad; }
-			CASE(LSCompareLE): { register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareGT; goto returnFuncInvertedPostLoad; }
-
-			CASE(CompareBLE): { returnFunc = wr_CompareGT; goto returnFuncBInverted; }
-			CASE(CompareBGE): { returnFunc = wr_CompareLT; goto returnFuncBInverted; }
-			CASE(CompareBGT): { returnFunc = wr_CompareGT; goto returnFuncBNormal; }
-			CASE(CompareBLT): { returnFunc = wr_CompareLT; goto returnFuncBNormal; }
+			CASE(LSCompareEQ): { QUICK(LSCompareEQ); register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareEQ; goto returnFuncPostLoad; }
+			CASE(LSCompareNE): { QUICK(LSCompareNE); register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareEQ; goto returnFuncInvertedPostLoad; }
+			CASE(LSCompareGT): { QUICK(LSCompareGT); register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareGT; goto returnFuncPostLoad; }
+			CASE(LSCompareLT): { QUICK(LSCompareLT); register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareLT; goto returnFuncPostLoad; }
+			CASE(LSCompareGE): { QUICK(LSCompareGE); register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareLT; goto returnFuncInvertedPostLoad; }
+			CASE(LSCompareLE): { QUICK(LSCompareLE); register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareGT; goto returnFuncInvertedPostLoad; }
+
+			CASE(CompareBLE): { QUICK(CompareBLE); returnFunc = wr_CompareGT; goto returnFuncBInverted; }
+			CASE(CompareBGE): { QUICK(CompareBGE); returnFunc = wr_CompareLT; goto returnFuncBInverted; }
+			CASE(CompareBGT): { QUICK(CompareBGT); returnFunc = wr_CompareGT; goto returnFuncBNormal; }
+			CASE(CompareBLT): { QUICK(CompareBLT); returnFunc = wr_CompareLT; goto returnFuncBNormal; }
 			CASE(CompareBEQ):
 			{
+				QUICK(CompareBEQ);
 				returnFunc = wr_CompareEQ;
 returnFuncBNormal:
 				register0 = --stackTop;
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : READ_16_FROM_PC(pc);
 				CHECK_FORCE_YIELD;
 				FASTCONTINUE;
@@ -2803,25 +3433,29 @@ returnFuncBNormal:
 			
 			CASE(CompareBNE):
 			{
+				QUICK(CompareBNE);
 				returnFunc = wr_CompareEQ;
 returnFuncBInverted:
 				register0 = --stackTop;
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? READ_16_FROM_PC(pc) : 2;
 				CHECK_FORCE_YIELD;
 				FASTCONTINUE;
 			}
 			
-			CASE(CompareBLE8): { returnFunc = wr_CompareGT; goto returnFuncBInverted8; }
-			CASE(CompareBGE8): { returnFunc = wr_CompareLT; goto returnFuncBInverted8; }
-			CASE(CompareBGT8): { returnFunc = wr_CompareGT; goto returnFuncBNormal8; }
-			CASE(CompareBLT8): { returnFunc = wr_CompareLT; goto returnFuncBNormal8; }
+			CASE(CompareBLE8): { QUICK(CompareBLE8); returnFunc = wr_CompareGT; goto returnFuncBInverted8; }
+			CASE(CompareBGE8): { QUICK(CompareBGE8); returnFunc = wr_CompareLT; goto returnFuncBInverted8; }
+			CASE(CompareBGT8): { QUICK(CompareBGT8); returnFunc = wr_CompareGT; goto returnFuncBNormal8; }
+			CASE(CompareBLT8): { QUICK(CompareBLT8); returnFunc = wr_CompareLT; goto returnFuncBNormal8; }
 			CASE(CompareBEQ8):
 			{
+				QUICK(CompareBEQ8);
 				returnFunc = wr_CompareEQ;
 returnFuncBNormal8:
 				register0 = --stackTop;
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type << 2) | register1->type](register0, register1) ? 2 : (int8_t)READ_8_FROM_PC(pc);
 				CHECK_FORCE_YIELD;
 				FASTCONTINUE;
@@ -2829,10 +3463,12 @@ returnFuncBNormal8:
 			
 			CASE(CompareBNE8):
 			{
+				QUICK(CompareBNE8);
 				returnFunc = wr_CompareEQ;
 returnFuncBInverted8:
 				register0 = --stackTop;
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? (int8_t)READ_8_FROM_PC(pc) : 2;
 				CHECK_FORCE_YIELD;
 				FASTCONTINUE;
@@ -2840,6 +3476,7 @@ returnFuncBInverted8:
 
 			CASE(GGCompareEQ):
 			{
+				QUICK(GGCompareEQ);
 				returnFunc = wr_CompareEQ;
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
@@ -2847,6 +3484,7 @@ returnFuncBInverted8:
 			}
 			CASE(GGCompareNE):
 			{
+				QUICK(GGCompareNE);
 				returnFunc = wr_CompareEQ;
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
@@ -2854,6 +3492,7 @@ returnFuncBInverted8:
 			}
 			CASE(GGCompareGT):
 			{
+				QUICK(GGCompareGT);
 				returnFunc = wr_CompareGT;
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
@@ -2861,6 +3500,7 @@ returnFuncBInverted8:
 			}
 			CASE(GGCompareGE):
 			{
+				QUICK(GGCompareGE);
 				returnFunc = wr_CompareLT;
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
@@ -2868,6 +3508,7 @@ returnFuncBInverted8:
 			}
 			CASE(GGCompareLT):
 			{
+				QUICK(GGCompareLT);
 				returnFunc = wr_CompareLT;
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
@@ -2875,6 +3516,7 @@ returnFuncBInverted8:
 			}
 			CASE(GGCompareLE):
 			{
+				QUICK(GGCompareLE);
 				returnFunc = wr_CompareGT;
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
@@ -2882,30 +3524,34 @@ returnFuncBInverted8:
 			}
 
 			
-			CASE(LLCompareGT): { returnFunc = wr_CompareGT; goto returnCompareEQ; }
-			CASE(LLCompareLT): { returnFunc = wr_CompareLT; goto returnCompareEQ; }
+			CASE(LLCompareGT): { QUICK(LLCompareGT); returnFunc = wr_CompareGT; goto returnCompareEQ; }
+			CASE(LLCompareLT): { QUICK(LLCompareLT); returnFunc = wr_CompareLT; goto returnCompareEQ; }
 			CASE(LLCompareEQ):
 			{
+				QUICK(LLCompareEQ);
 				returnFunc = wr_CompareEQ;
 returnCompareEQ:
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
 returnCompareEQPost:
+				QUICKEN;
 				stackTop->i = (int)returnFunc[(register0->type<<2)|register1->type]( register0, register1 );
 				(stackTop++)->p2 = INIT_AS_INT;
 				CHECK_STACK;
 				FASTCONTINUE;
 			}
 			
-			CASE(LLCompareGE): { returnFunc = wr_CompareLT; goto returnCompareNE; }
-			CASE(LLCompareLE): { returnFunc = wr_CompareGT; goto returnCompareNE; }
+			CASE(LLCompareGE): { QUICK(LLCompareGE); returnFunc = wr_CompareLT; goto returnCompareNE; }
+			CASE(LLCompareLE): { QUICK(LLCompareLE); returnFunc = wr_CompareGT; goto returnCompareNE; }
 			CASE(LLCompareNE):
 			{
+				QUICK(LLCompareNE);
 				returnFunc = wr_CompareEQ;
 returnCompareNE:
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
 returnCompareNEPost:
+				QUICKEN;
 				stackTop->i = (int)!returnFunc[(register0->type<<2)|register1->type]( register0, register1 );
 				(stackTop++)->p2 = INIT_AS_INT;
 				CHECK_STACK;
@@ -2914,228 +3560,264 @@ returnCompareNEPost:
 
 
 			
-			CASE(GSCompareGEBZ): { returnFunc = wr_CompareLT; goto CompareGInverted; }
-			CASE(GSCompareLEBZ): { returnFunc = wr_CompareGT; goto CompareGInverted; }
+			CASE(GSCompareGEBZ): { QUICK(GSCompareGEBZ); returnFunc = wr_CompareLT; goto CompareGInverted; }
+			CASE(GSCompareLEBZ): { QUICK(GSCompareLEBZ); returnFunc = wr_CompareGT; goto CompareGInverted; }
 			CASE(GSCompareNEBZ):
 			{
+				QUICK(GSCompareNEBZ);
 				returnFunc = wr_CompareEQ;
 CompareGInverted:
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? READ_16_FROM_PC(pc) : 2;
 				FASTCONTINUE;
 			}
 			
-			CASE(GSCompareEQBZ): { returnFunc = wr_CompareEQ; goto CompareGNormal; }
-			CASE(GSCompareGTBZ): { returnFunc = wr_CompareGT; goto CompareGNormal; }
+			CASE(GSCompareEQBZ): { QUICK(GSCompareEQBZ); returnFunc = wr_CompareEQ; goto CompareGNormal; }
+			CASE(GSCompareGTBZ): { QUICK(GSCompareGTBZ); returnFunc = wr_CompareGT; goto CompareGNormal; }
 			CASE(GSCompareLTBZ):
 			{
+				QUICK(GSCompareLTBZ);
 				returnFunc = wr_CompareLT;
 CompareGNormal:
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : READ_16_FROM_PC(pc);
 				FASTCONTINUE;
 			}
 			
-			CASE(LSCompareGEBZ): { returnFunc = wr_CompareLT; goto CompareLInverted; }
-			CASE(LSCompareLEBZ): { returnFunc = wr_CompareGT; goto CompareLInverted; }
+			CASE(LSCompareGEBZ): { QUICK(LSCompareGEBZ); returnFunc = wr_CompareLT; goto CompareLInverted; }
+			CASE(LSCompareLEBZ): { QUICK(LSCompareLEBZ); returnFunc = wr_CompareGT; goto CompareLInverted; }
 			CASE(LSCompareNEBZ):
 			{
+				QUICK(LSCompareNEBZ);
 				returnFunc = wr_CompareEQ;
 CompareLInverted:
 				register0 = frameBase + READ_8_FROM_PC(pc++);
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? READ_16_FROM_PC(pc) : 2;
 				FASTCONTINUE;
 			}
 			
-			CASE(LSCompareEQBZ): { returnFunc = wr_CompareEQ; goto CompareLNormal; }
-			CASE(LSCompareGTBZ): { returnFunc = wr_CompareGT; goto CompareLNormal; }
+			CASE(LSCompareEQBZ): { QUICK(LSCompareEQBZ); returnFunc = wr_CompareEQ; goto CompareLNormal; }
+			CASE(LSCompareGTBZ): { QUICK(LSCompareGTBZ); returnFunc = wr_CompareGT; goto CompareLNormal; }
 			CASE(LSCompareLTBZ):
 			{
+				QUICK(LSCompareLTBZ);
 				returnFunc = wr_CompareLT;
 CompareLNormal:
 				register0 = frameBase + READ_8_FROM_PC(pc++);
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : READ_16_FROM_PC(pc);
 				FASTCONTINUE;
 			}
 			
-			CASE(GSCompareGEBZ8): { returnFunc = wr_CompareLT; goto CompareG8Inverted; }
-			CASE(GSCompareLEBZ8): { returnFunc = wr_CompareGT; goto CompareG8Inverted; }
+			CASE(GSCompareGEBZ8): { QUICK(GSCompareGEBZ8); returnFunc = wr_CompareLT; goto CompareG8Inverted; }
+			CASE(GSCompareLEBZ8): { QUICK(GSCompareLEBZ8); returnFunc = wr_CompareGT; goto CompareG8Inverted; }
 			CASE(GSCompareNEBZ8):
 			{
+				QUICK(GSCompareNEBZ8);
 				returnFunc = wr_CompareEQ;
 CompareG8Inverted:
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? (int8_t)READ_8_FROM_PC(pc) : 2;
 				FASTCONTINUE;
 			}
 			
-			CASE(GSCompareEQBZ8): { returnFunc = wr_CompareEQ; goto CompareG8Normal; }
-			CASE(GSCompareGTBZ8): { returnFunc = wr_CompareGT; goto CompareG8Normal; }
+			CASE(GSCompareEQBZ8): { QUICK(GSCompareEQBZ8); returnFunc = wr_CompareEQ; goto CompareG8Normal; }
+			CASE(GSCompareGTBZ8): { QUICK(GSCompareGTBZ8); returnFunc = wr_CompareGT; goto CompareG8Normal; }
 			CASE(GSCompareLTBZ8):
 			{
+				QUICK(GSCompareLTBZ8);
 				returnFunc = wr_CompareLT;
 CompareG8Normal:
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : (int8_t)READ_8_FROM_PC(pc);
 				FASTCONTINUE;
 			}
 			
-			CASE(LSCompareGEBZ8): { returnFunc = wr_CompareLT; goto CompareL8Inverted; }
-			CASE(LSCompareLEBZ8): { returnFunc = wr_CompareGT; goto CompareL8Inverted; }
+			CASE(LSCompareGEBZ8): { QUICK(LSCompareGEBZ8); returnFunc = wr_CompareLT; goto CompareL8Inverted; }
+			CASE(LSCompareLEBZ8): { QUICK(LSCompareLEBZ8); returnFunc = wr_CompareGT; goto CompareL8Inverted; }
 			CASE(LSCompareNEBZ8):
 			{
+				QUICK(LSCompareNEBZ8);
 				returnFunc = wr_CompareEQ;
 CompareL8Inverted:
 				register0 = frameBase + READ_8_FROM_PC(pc++);
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? (int8_t)READ_8_FROM_PC(pc) : 2;
 				FASTCONTINUE;
 			}
 			
-			CASE(LSCompareEQBZ8): { returnFunc = wr_CompareEQ; goto CompareL8Normal; }
-			CASE(LSCompareGTBZ8): { returnFunc = wr_CompareGT; goto CompareL8Normal; }
+			CASE(LSCompareEQBZ8): { QUICK(LSCompareEQBZ8); returnFunc = wr_CompareEQ; goto CompareL8Normal; }
+			CASE(LSCompareGTBZ8): { QUICK(LSCompareGTBZ8); returnFunc = wr_CompareGT; goto CompareL8Normal; }
 			CASE(LSCompareLTBZ8):
 			{
+				QUICK(LSCompareLTBZ8);
 				returnFunc = wr_CompareLT;
 CompareL8Normal:
 				register0 = frameBase + READ_8_FROM_PC(pc++);
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : (int8_t)READ_8_FROM_PC(pc);
 				FASTCONTINUE;
 			}
 
-			CASE(LLCompareGEBZ): { returnFunc = wr_CompareLT; goto CompareLLInv; }
-			CASE(LLCompareLEBZ): { returnFunc = wr_CompareGT; goto CompareLLInv; }
+			CASE(LLCompareGEBZ): { QUICK(LLCompareGEBZ); returnFunc = wr_CompareLT; goto CompareLLInv; }
+			CASE(LLCompareLEBZ): { QUICK(LLCompareLEBZ); returnFunc = wr_CompareGT; goto CompareLLInv; }
 			CASE(LLCompareNEBZ):
 			{
+				QUICK(LLCompareNEBZ);
 				returnFunc = wr_CompareEQ;
 CompareLLInv:
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? READ_16_FROM_PC(pc) : 2;
 				FASTCONTINUE;
 			}
-			CASE(LLCompareEQBZ): { returnFunc = wr_CompareEQ; goto CompareLL; }
-			CASE(LLCompareGTBZ): { returnFunc = wr_CompareGT; goto CompareLL; }
+			CASE(LLCompareEQBZ): { QUICK(LLCompareEQBZ); returnFunc = wr_CompareEQ; goto CompareLL; }
+			CASE(LLCompareGTBZ): { QUICK(LLCompareGTBZ); returnFunc = wr_CompareGT; goto CompareLL; }
 			CASE(LLCompareLTBZ):
 			{
+				QUICK(LLCompareLTBZ);
 				returnFunc = wr_CompareLT;
 CompareLL:	
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : READ_16_FROM_PC(pc);
 				FASTCONTINUE;
 			}
 
 			
-			CASE(LLCompareGEBZ8): { returnFunc = wr_CompareLT; goto CompareLL8Inv; }
-			CASE(LLCompareLEBZ8): { returnFunc = wr_CompareGT; goto CompareLL8Inv; }
+			CASE(LLCompareGEBZ8): { QUICK(LLCompareGEBZ8); returnFunc = wr_CompareLT; goto CompareLL8Inv; }
+			CASE(LLCompareLEBZ8): { QUICK(LLCompareLEBZ8); returnFunc = wr_CompareGT; goto CompareLL8Inv; }
 			CASE(LLCompareNEBZ8):
 			{
+				QUICK(LLCompareNEBZ8);
 				returnFunc = wr_CompareEQ;
 CompareLL8Inv:
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? (int8_t)READ_8_FROM_PC(pc) : 2;
 				FASTCONTINUE;
 			}
-			CASE(LLCompareEQBZ8): { returnFunc = wr_CompareEQ; goto CompareLL8; }
-			CASE(LLCompareGTBZ8): { returnFunc = wr_CompareGT; goto CompareLL8; }
+			CASE(LLCompareEQBZ8): { QUICK(LLCompareEQBZ8); returnFunc = wr_CompareEQ; goto CompareLL8; }
+			CASE(LLCompareGTBZ8): { QUICK(LLCompareGTBZ8); returnFunc = wr_CompareGT; goto CompareLL8; }
 			CASE(LLCompareLTBZ8):
 			{
+				QUICK(LLCompareLTBZ8);
 				returnFunc = wr_CompareLT;
 CompareLL8:
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : (int8_t)READ_8_FROM_PC(pc);
 				FASTCONTINUE;
 			}
 
 			
-			CASE(GGCompareGEBZ): { returnFunc = wr_CompareLT; goto CompareGGInv; }
- 		    CASE(GGCompareLEBZ): { returnFunc = wr_CompareGT; goto CompareGGInv; }
+			CASE(GGCompareGEBZ): { QUICK(GGCompareGEBZ); returnFunc = wr_CompareLT; goto CompareGGInv; }
+ 		    CASE(GGCompareLEBZ): { QUICK(GGCompareLEBZ); returnFunc = wr_CompareGT; goto CompareGGInv; }
 			CASE(GGCompareNEBZ):
 			{
+				QUICK(GGCompareNEBZ);
 				returnFunc = wr_CompareEQ;
 CompareGGInv:
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? READ_16_FROM_PC(pc) : 2;
 				FASTCONTINUE;
 			}
 
-			CASE(GGCompareEQBZ): { returnFunc = wr_CompareEQ; goto CompareGG; }
-			CASE(GGCompareGTBZ): { returnFunc = wr_CompareGT; goto CompareGG; }
+			CASE(GGCompareEQBZ): { QUICK(GGCompareEQBZ); returnFunc = wr_CompareEQ; goto CompareGG; }
+			CASE(GGCompareGTBZ): { QUICK(GGCompareGTBZ); returnFunc = wr_CompareGT; goto CompareGG; }
 			CASE(GGCompareLTBZ):
 			{
+				QUICK(GGCompareLTBZ);
 				returnFunc = wr_CompareLT;
 CompareGG:	
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : READ_16_FROM_PC(pc);
 				FASTCONTINUE;
 			}
 
 			
-			CASE(GGCompareGEBZ8): { returnFunc = wr_CompareLT; goto CompareGG8Inv; }
-			CASE(GGCompareLEBZ8): { returnFunc = wr_CompareGT; goto CompareGG8Inv; }
+			CASE(GGCompareGEBZ8): { QUICK(GGCompareGEBZ8); returnFunc = wr_CompareLT; goto CompareGG8Inv; }
+			CASE(GGCompareLEBZ8): { QUICK(GGCompareLEBZ8); returnFunc = wr_CompareGT; goto CompareGG8Inv; }
 			CASE(GGCompareNEBZ8):
 			{
+				QUICK(GGCompareNEBZ8);
 				returnFunc = wr_CompareEQ;
 CompareGG8Inv:
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? (int8_t)READ_8_FROM_PC(pc) : 2;
 				FASTCONTINUE;
 			}
-			CASE(GGCompareEQBZ8): { returnFunc = wr_CompareEQ; goto CompareGG8; }
-			CASE(GGCompareGTBZ8): { returnFunc = wr_CompareGT; goto CompareGG8; }
+			CASE(GGCompareEQBZ8): { QUICK(GGCompareEQBZ8); returnFunc = wr_CompareEQ; goto CompareGG8; }
+			CASE(GGCompareGTBZ8): { QUICK(GGCompareGTBZ8); returnFunc = wr_CompareGT; goto CompareGG8; }
 			CASE(GGCompareLTBZ8):
 			{
+				QUICK(GGCompareLTBZ8);
 				returnFunc = wr_CompareLT;
 CompareGG8:	
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : (int8_t)READ_8_FROM_PC(pc);
 				FASTCONTINUE;
 			}
 
 			
-			CASE(BinaryRightShiftSkipLoad): { targetFunc = wr_RightShiftBinary; goto targetFuncOpSkipLoad; }
-			CASE(BinaryLeftShiftSkipLoad): { targetFunc = wr_LeftShiftBinary; goto targetFuncOpSkipLoad; }
-			CASE(BinaryAndSkipLoad): { targetFunc = wr_ANDBinary; goto targetFuncOpSkipLoad; }
-			CASE(BinaryOrSkipLoad): { targetFunc = wr_ORBinary; goto targetFuncOpSkipLoad; }
-			CASE(BinaryXORSkipLoad): { targetFunc = wr_XORBinary; goto targetFuncOpSkipLoad; }
+			CASE(BinaryRightShiftSkipLoad): { QUICK_INT(BinaryRightShiftSkipLoad); targetFunc = wr_RightShiftBinary; goto targetFuncOpSkipLoad; }
+			CASE(BinaryLeftShiftSkipLoad): { QUICK_INT(BinaryLeftShiftSkipLoad); targetFunc = wr_LeftShiftBinary; goto targetFuncOpSkipLoad; }
+			CASE(BinaryAndSkipLoad): { QUICK_INT(BinaryAndSkipLoad); targetFunc = wr_ANDBinary; goto targetFuncOpSkipLoad; }
+			CASE(BinaryOrSkipLoad): { QUICK_INT(BinaryOrSkipLoad); targetFunc = wr_ORBinary; goto targetFuncOpSkipLoad; }
+			CASE(BinaryXORSkipLoad): { QUICK_INT(BinaryXORSkipLoad); targetFunc = wr_XORBinary; goto targetFuncOpSkipLoad; }
 			CASE(BinaryModSkipLoad):
 			{
+				QUICK_INT(BinaryModSkipLoad);
 				targetFunc = wr_ModBinary;
 targetFuncOpSkipLoad:
+				QUICKEN;
 				targetFunc[(register1->type<<2)|register0->type]( register1, register0, stackTop++ );
 				CHECK_STACK;
 				CONTINUE;
 			}
 			
-			CASE(BinaryMultiplication): { targetFunc = wr_MultiplyBinary; goto targetFuncOp; }
-			CASE(BinarySubtraction): { targetFunc = wr_SubtractBinary; goto targetFuncOp; }
-			CASE(BinaryDivision): { targetFunc = wr_DivideBinary; goto targetFuncOp; }
-			CASE(BinaryRightShift): { targetFunc = wr_RightShiftBinary; goto targetFuncOp; }
-			CASE(BinaryLeftShift): { targetFunc = wr_LeftShiftBinary; goto targetFuncOp; }
-			CASE(BinaryMod): { targetFunc = wr_ModBinary; goto targetFuncOp; }
-			CASE(BinaryOr): { targetFunc = wr_ORBinary; goto targetFuncOp; }
-			CASE(BinaryXOR): { targetFunc = wr_XORBinary; goto targetFuncOp; }
-			CASE(BinaryAnd): { targetFunc = wr_ANDBinary; goto targetFuncOp; }
+			CASE(BinaryMultiplication): { QUICK(BinaryMultiplication); targetFunc = wr_MultiplyBinary; goto targetFuncOp; }
+			CASE(BinarySubtraction): { QUICK(BinarySubtraction); targetFunc = wr_SubtractBinary; goto targetFuncOp; }
+			CASE(BinaryDivision): { QUICK(BinaryDivision); targetFunc = wr_DivideBinary; goto targetFuncOp; }
+			CASE(BinaryRightShift): { QUICK_INT(BinaryRightShift); targetFunc = wr_RightShiftBinary; goto targetFuncOp; }
+			CASE(BinaryLeftShift): { QUICK_INT(BinaryLeftShift); targetFunc = wr_LeftShiftBinary; goto targetFuncOp; }
+			CASE(BinaryMod): { QUICK_INT(BinaryMod); targetFunc = wr_ModBinary; goto targetFuncOp; }
+			CASE(BinaryOr): { QUICK_INT(BinaryOr); targetFunc = wr_ORBinary; goto targetFuncOp; }
+			CASE(BinaryXOR): { QUICK_INT(BinaryXOR); targetFunc = wr_XORBinary; goto targetFuncOp; }
+			CASE(BinaryAnd): { QUICK_INT(BinaryAnd); targetFunc = wr_ANDBinary; goto targetFuncOp; }
 			CASE(BinaryAddition):
 			{
+				QUICK(BinaryAddition);
 				targetFunc = wr_AdditionBinary;
 targetFuncOp:
 				register1 = --stackTop;
 				register0 = stackTop - 1;
+				QUICKEN;
 				targetFunc[(register1->type<<2)|register0->type]( register1, register0, register0 );
 #ifdef WRENCH_TRAP_DIVISION_BY_ZERO
 				if ( IS_INVALID(register0->p2) )
@@ -3202,16 +3884,18 @@ binaryTableOpAndPop:
 				CONTINUE;
 			}
 			
-			CASE(BinaryAdditionAndStoreGlobal) : { targetFunc = wr_AdditionBinary; goto targetFuncStoreGlobalOp; }
-			CASE(BinarySubtractionAndStoreGlobal): { targetFunc = wr_SubtractBinary; goto targetFuncStoreGlobalOp; }
-			CASE(BinaryMultiplicationAndStoreGlobal): { targetFunc = wr_MultiplyBinary; goto targetFuncStoreGlobalOp; }
+			CASE(BinaryAdditionAndStoreGlobal) : { QUICK(BinaryAdditionAndStoreGlobal); targetFunc = wr_AdditionBinary; goto targetFuncStoreGlobalOp; }
+			CASE(BinarySubtractionAndStoreGlobal): { QUICK(BinarySubtractionAndStoreGlobal); targetFunc = wr_SubtractBinary; goto targetFuncStoreGlobalOp; }
+			CASE(BinaryMultiplicationAndStoreGlobal): { QUICK(BinaryMultiplicationAndStoreGlobal); targetFunc = wr_MultiplyBinary; goto targetFuncStoreGlobalOp; }
 			CASE(BinaryDivisionAndStoreGlobal):
 			{
+				QUICK(BinaryDivisionAndStoreGlobal);
 				targetFunc = wr_DivideBinary;
 				
 targetFuncStoreGlobalOp:
 				register1 = --stackTop;
 				register0 = --stackTop;
+				QUICKEN;
 #ifdef WRENCH_TRAP_DIVISION_BY_ZERO
 				WRValue* T = globalSpace + READ_8_FROM_PC(pc++);
 				targetFunc[(register1->type<<2)|register0->type]( register1, register0, T );
@@ -3226,16 +3910,18 @@ targetFuncStoreGlobalOp:
 				CONTINUE;
 			}
 			
-			CASE(BinaryAdditionAndStoreLocal): { targetFunc = wr_AdditionBinary; goto targetFuncStoreLocalOp; }
-			CASE(BinarySubtractionAndStoreLocal): { targetFunc = wr_SubtractBinary; goto targetFuncStoreLocalOp; }
-			CASE(BinaryMultiplicationAndStoreLocal): { targetFunc = wr_MultiplyBinary; goto targetFuncStoreLocalOp; }
+			CASE(BinaryAdditionAndStoreLocal): { QUICK(BinaryAdditionAndStoreLocal); targetFunc = wr_AdditionBinary; goto targetFuncStoreLocalOp; }
+			CASE(BinarySubtractionAndStoreLocal): { QUICK(BinarySubtractionAndStoreLocal); targetFunc = wr_SubtractBinary; goto targetFuncStoreLocalOp; }
+			CASE(BinaryMultiplicationAndStoreLocal): { QUICK(BinaryMultiplicationAndStoreLocal); targetFunc = wr_MultiplyBinary; goto targetFuncStoreLocalOp; }
 			CASE(BinaryDivisionAndStoreLocal):
 			{
+				QUICK(BinaryDivisionAndStoreLocal);
 				targetFunc = wr_DivideBinary;
 				
 targetFuncStoreLocalOp:
 				register1 = --stackTop;
 				register0 = --stackTop;
+				QUICKEN;
 #ifdef WRENCH_TRAP_DIVISION_BY_ZERO
 				WRValue* T = frameBase + READ_8_FROM_PC(pc++);
 				targetFunc[(register1->type<<2)|register0->type]( register1, register0, T );
@@ -3251,6 +3937,158 @@ targetFuncStoreLocalOp:
 			}
 
 			
+#ifdef WRENCH_QUICKENING
+			// what the generic handlers above get replaced with, see QUICK()
+			QUICK_BRANCH( LLCompareEQBZ, LL, 2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareGTBZ, LL, 2, QUICK_GT, QUICK_GT, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareLTBZ, LL, 2, QUICK_LT, QUICK_LT, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareNEBZ, LL, 2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareLEBZ, LL, 2, QUICK_GT, QUICK_GT, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareGEBZ, LL, 2, QUICK_LT, QUICK_LT, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareEQBZ8, LL, 2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareGTBZ8, LL, 2, QUICK_GT, QUICK_GT, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareLTBZ8, LL, 2, QUICK_LT, QUICK_LT, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareNEBZ8, LL, 2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ8, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareLEBZ8, LL, 2, QUICK_GT, QUICK_GT, QUICK_BNZ8, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareGEBZ8, LL, 2, QUICK_LT, QUICK_LT, QUICK_BNZ8, FASTCONTINUE )
+
+			QUICK_BRANCH( GGCompareEQBZ, GG, 2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareGTBZ, GG, 2, QUICK_GT, QUICK_GT, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareLTBZ, GG, 2, QUICK_LT, QUICK_LT, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareNEBZ, GG, 2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareLEBZ, GG, 2, QUICK_GT, QUICK_GT, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareGEBZ, GG, 2, QUICK_LT, QUICK_LT, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareEQBZ8, GG, 2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareGTBZ8, GG, 2, QUICK_GT, QUICK_GT, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareLTBZ8, GG, 2, QUICK_LT, QUICK_LT, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareNEBZ8, GG, 2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ8, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareLEBZ8, GG, 2, QUICK_GT, QUICK_GT, QUICK_BNZ8, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareGEBZ8, GG, 2, QUICK_LT, QUICK_LT, QUICK_BNZ8, FASTCONTINUE )
+
+			QUICK_BRANCH( LSCompareEQBZ, LS, 1_POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareGTBZ, LS, 1_POP, QUICK_GT, QUICK_GT, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareLTBZ, LS, 1_POP, QUICK_LT, QUICK_LT, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareNEBZ, LS, 1_POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareLEBZ, LS, 1_POP, QUICK_GT, QUICK_GT, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareGEBZ, LS, 1_POP, QUICK_LT, QUICK_LT, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareEQBZ8, LS, 1_POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareGTBZ8, LS, 1_POP, QUICK_GT, QUICK_GT, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareLTBZ8, LS, 1_POP, QUICK_LT, QUICK_LT, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareNEBZ8, LS, 1_POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ8, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareLEBZ8, LS, 1_POP, QUICK_GT, QUICK_GT, QUICK_BNZ8, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareGEBZ8, LS, 1_POP, QUICK_LT, QUICK_LT, QUICK_BNZ8, FASTCONTINUE )
+
+			QUICK_BRANCH( GSCompareEQBZ, GS, 1_POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareGTBZ, GS, 1_POP, QUICK_GT, QUICK_GT, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareLTBZ, GS, 1_POP, QUICK_LT, QUICK_LT, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareNEBZ, GS, 1_POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareLEBZ, GS, 1_POP, QUICK_GT, QUICK_GT, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareGEBZ, GS, 1_POP, QUICK_LT, QUICK_LT, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareEQBZ8, GS, 1_POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareGTBZ8, GS, 1_POP, QUICK_GT, QUICK_GT, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareLTBZ8, GS, 1_POP, QUICK_LT, QUICK_LT, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareNEBZ8, GS, 1_POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ8, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareLEBZ8, GS, 1_POP, QUICK_GT, QUICK_GT, QUICK_BNZ8, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareGEBZ8, GS, 1_POP, QUICK_LT, QUICK_LT, QUICK_BNZ8, FASTCONTINUE )
+
+			QUICK_BRANCH( CompareBEQ, SS, POP2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBGT, SS, POP2, QUICK_GT, QUICK_GT, QUICK_BZ, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBLT, SS, POP2, QUICK_LT, QUICK_LT, QUICK_BZ, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBNE, SS, POP2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBLE, SS, POP2, QUICK_GT, QUICK_GT, QUICK_BNZ, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBGE, SS, POP2, QUICK_LT, QUICK_LT, QUICK_BNZ, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBEQ8, SS, POP2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ8, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBGT8, SS, POP2, QUICK_GT, QUICK_GT, QUICK_BZ8, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBLT8, SS, POP2, QUICK_LT, QUICK_LT, QUICK_BZ8, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBNE8, SS, POP2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ8, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBLE8, SS, POP2, QUICK_GT, QUICK_GT, QUICK_BNZ8, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBGE8, SS, POP2, QUICK_LT, QUICK_LT, QUICK_BNZ8, CHECK_FORCE_YIELD; FASTCONTINUE )
+
+			QUICK_COMPARE( CompareEQ, SS, POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_IS )
+			QUICK_COMPARE( CompareNE, SS, POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_NOT )
+			QUICK_COMPARE( CompareGT, SS, POP, QUICK_GT, QUICK_GT, QUICK_IS )
+			QUICK_COMPARE( CompareLT, SS, POP, QUICK_LT, QUICK_LT, QUICK_IS )
+			QUICK_COMPARE( CompareGE, SS, POP, QUICK_LT, QUICK_LT, QUICK_NOT )
+			QUICK_COMPARE( CompareLE, SS, POP, QUICK_GT, QUICK_GT, QUICK_NOT )
+			QUICK_COMPARE( LogicalAnd, SS, POP, QUICK_AND, QUICK_AND, QUICK_IS )
+			QUICK_COMPARE( LogicalOr, SS, POP, QUICK_OR, QUICK_OR, QUICK_IS )
+
+			QUICK_COMPARE( LSCompareEQ, LS, 1, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_IS )
+			QUICK_COMPARE( LSCompareNE, LS, 1, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_NOT )
+			QUICK_COMPARE( LSCompareGT, LS, 1, QUICK_GT, QUICK_GT, QUICK_IS )
+			QUICK_COMPARE( LSCompareLT, LS, 1, QUICK_LT, QUICK_LT, QUICK_IS )
+			QUICK_COMPARE( LSCompareGE, LS, 1, QUICK_LT, QUICK_LT, QUICK_NOT )
+			QUICK_COMPARE( LSCompareLE, LS, 1, QUICK_GT, QUICK_GT, QUICK_NOT )
+
+			QUICK_COMPARE( GSCompareEQ, GS, 1, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_IS )
+			QUICK_COMPARE( GSCompareNE, GS, 1, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_NOT )
+			QUICK_COMPARE( GSCompareGT, GS, 1, QUICK_GT, QUICK_GT, QUICK_IS )
+			QUICK_COMPARE( GSCompareLT, GS, 1, QUICK_LT, QUICK_LT, QUICK_IS )
+			QUICK_COMPARE( GSCompareGE, GS, 1, QUICK_LT, QUICK_LT, QUICK_NOT )
+			QUICK_COMPARE( GSCompareLE, GS, 1, QUICK_GT, QUICK_GT, QUICK_NOT )
+
+			QUICK_COMPARE_PUSH( LLCompareEQ, LL, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_IS )
+			QUICK_COMPARE_PUSH( LLCompareNE, LL, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_NOT )
+			QUICK_COMPARE_PUSH( LLCompareGT, LL, QUICK_GT, QUICK_GT, QUICK_IS )
+			QUICK_COMPARE_PUSH( LLCompareLT, LL, QUICK_LT, QUICK_LT, QUICK_IS )
+			QUICK_COMPARE_PUSH( LLCompareGE, LL, QUICK_LT, QUICK_LT, QUICK_NOT )
+			QUICK_COMPARE_PUSH( LLCompareLE, LL, QUICK_GT, QUICK_GT, QUICK_NOT )
+
+			QUICK_COMPARE_PUSH( GGCompareEQ, GG, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_IS )
+			QUICK_COMPARE_PUSH( GGCompareNE, GG, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_NOT )
+			QUICK_COMPARE_PUSH( GGCompareGT, GG, QUICK_GT, QUICK_GT, QUICK_IS )
+			QUICK_COMPARE_PUSH( GGCompareLT, GG, QUICK_LT, QUICK_LT, QUICK_IS )
+			QUICK_COMPARE_PUSH( GGCompareGE, GG, QUICK_LT, QUICK_LT, QUICK_NOT )
+			QUICK_COMPARE_PUSH( GGCompareLE, GG, QUICK_GT, QUICK_GT, QUICK_NOT )
+
+			QUICK_BINARY_PUSH( GGBinaryAddition, GG, wr_iadd_wrap, QUICK_ADD, QUICK_ANY )
+			QUICK_BINARY_PUSH( GLBinaryAddition, GL, wr_iadd_wrap, QUICK_ADD, QUICK_ANY )
+			QUICK_BINARY_PUSH( LLBinaryAddition, LL, wr_iadd_wrap, QUICK_ADD, QUICK_ANY )
+			QUICK_BINARY_PUSH( GGBinarySubtraction, GG, wr_isub_wrap, QUICK_SUB, QUICK_ANY )
+			QUICK_BINARY_PUSH( GLBinarySubtraction, GL, wr_isub_wrap, QUICK_SUB, QUICK_ANY )
+			QUICK_BINARY_PUSH( LGBinarySubtraction, LG, wr_isub_wrap, QUICK_SUB, QUICK_ANY )
+			QUICK_BINARY_PUSH( LLBinarySubtraction, LL, wr_isub_wrap, QUICK_SUB, QUICK_ANY )
+			QUICK_BINARY_PUSH( GGBinaryMultiplication, GG, wr_imul_wrap, QUICK_MUL, QUICK_ANY )
+			QUICK_BINARY_PUSH( GLBinaryMultiplication, GL, wr_imul_wrap, QUICK_MUL, QUICK_ANY )
+			QUICK_BINARY_PUSH( LLBinaryMultiplication, LL, wr_imul_wrap, QUICK_MUL, QUICK_ANY )
+			QUICK_BINARY_PUSH( GGBinaryDivision, GG, QUICK_DIV, QUICK_DIV, QUICK_NONZERO )
+			QUICK_BINARY_PUSH( GLBinaryDivision, GL, QUICK_DIV, QUICK_DIV, QUICK_NONZERO )
+			QUICK_BINARY_PUSH( LGBinaryDivision, LG, QUICK_DIV, QUICK_DIV, QUICK_NONZERO )
+			QUICK_BINARY_PUSH( LLBinaryDivision, LL, QUICK_DIV, QUICK_DIV, QUICK_NONZERO )
+
+			QUICK_BINARY( BinaryAddition, wr_iadd_wrap, QUICK_ADD, QUICK_ANY )
+			QUICK_BINARY( BinarySubtraction, wr_isub_wrap, QUICK_SUB, QUICK_ANY )
+			QUICK_BINARY( BinaryMultiplication, wr_imul_wrap, QUICK_MUL, QUICK_ANY )
+			QUICK_BINARY( BinaryDivision, QUICK_DIV, QUICK_DIV, QUICK_NONZERO )
+			QUICK_INT_BINARY( BinaryRightShift, QUICK_SHR )
+			QUICK_INT_BINARY( BinaryLeftShift, QUICK_SHL )
+			QUICK_INT_BINARY( BinaryMod, QUICK_MOD )
+			QUICK_INT_BINARY( BinaryOr, QUICK_BOR )
+			QUICK_INT_BINARY( BinaryXOR, QUICK_BXOR )
+			QUICK_INT_BINARY( BinaryAnd, QUICK_BAND )
+
+			QUICK_INT_SKIPLOAD( BinaryRightShiftSkipLoad, QUICK_SHR )
+			QUICK_INT_SKIPLOAD( BinaryLeftShiftSkipLoad, QUICK_SHL )
+			QUICK_INT_SKIPLOAD( BinaryModSkipLoad, QUICK_MOD )
+			QUICK_INT_SKIPLOAD( BinaryOrSkipLoad, QUICK_BOR )
+			QUICK_INT_SKIPLOAD( BinaryXORSkipLoad, QUICK_BXOR )
+			QUICK_INT_SKIPLOAD( BinaryAndSkipLoad, QUICK_BAND )
+
+			QUICK_BINARY_STORE( BinaryAdditionAndStoreLocal, frameBase, wr_iadd_wrap, QUICK_ADD, QUICK_ANY )
+			QUICK_BINARY_STORE( BinarySubtractionAndStoreLocal, frameBase, wr_isub_wrap, QUICK_SUB, QUICK_ANY )
+			QUICK_BINARY_STORE( BinaryMultiplicationAndStoreLocal, frameBase, wr_imul_wrap, QUICK_MUL, QUICK_ANY )
+			QUICK_BINARY_STORE( BinaryDivisionAndStoreLocal, frameBase, QUICK_DIV, QUICK_DIV, QUICK_NONZERO )
+			QUICK_BINARY_STORE( BinaryAdditionAndStoreGlobal, globalSpace, wr_iadd_wrap, QUICK_ADD, QUICK_ANY )
+			QUICK_BINARY_STORE( BinarySubtractionAndStoreGlobal, globalSpace, wr_isub_wrap, QUICK_SUB, QUICK_ANY )
+			QUICK_BINARY_STORE( BinaryMultiplicationAndStoreGlobal, globalSpace, wr_imul_wrap, QUICK_MUL, QUICK_ANY )
+			QUICK_BINARY_STORE( BinaryDivisionAndStoreGlobal, globalSpace, QUICK_DIV, QUICK_DIV, QUICK_NONZERO )
+
+			QUICK_STEP( IncLocal, frameBase, ++ )
+			QUICK_STEP( DecLocal, frameBase, -- )
+			QUICK_STEP( IncGlobal, globalSpace, ++ )
+			QUICK_STEP( DecGlobal, globalSpace, -- )
+#endif
+
 //-------------------------------------------------------------------------------------------------------------
 #endif//-------------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------------------
@@ -27,17 +27,20 @@ SOFTWARE.
 /*------------------------------------------------------------------------------*/
 
 #define WR_FUNCTION_CORE_SIZE 11
+#define WR_WIDE_FUNCTION_CORE_SIZE 17 // 32-bit offsets and 16-bit frame, see WR_WIDE_BYTECODE
+#define WR_WIDE_HEADER_SIZE 7 // the usual 3 bytes then 16-bit globals and function counts
+
 //------------------------------------------------------------------------------
 struct WRFunction
 {
-	uint16_t namespaceOffset;
-	uint16_t functionOffset;
+	uint32_t namespaceOffset;
+	uint32_t functionOffset;
 	
 	uint32_t hash;
 
 	uint8_t arguments;
-	uint8_t frameSpaceNeeded;
-	uint8_t frameBaseAdjustment;
+	uint16_t frameSpaceNeeded;
+	uint16_t frameBaseAdjustment;
 };
 
 //------------------------------------------------------------------------------
@@ -45,8 +48,43 @@ enum WRContextFlags
 {
 	WRC_OwnsMemory = 1<<0, // if this is true, 'bottom' must be freed upon destruction
 	WRC_ForceYielded = 1<<1, // if this is true, 'bottom' must be freed upon destruction
+	WRC_LazyRegistry = 1<<2, // 'registry' has not been filled in from localFunctions yet
+	WRC_Wide = 1<<3, // bytecode is WR_WIDE_BYTECODE, NewObjectTable names a function instead of an offset
 };
 
+// the registry (function hash -> WRFunction) is only needed to look
+// functions up by name, so it is built the first time that happens
+void wr_buildRegistry( WRContext* context );
+inline WRGCObject& wr_registry( WRContext* context )
+{
+	if ( context->flags & WRC_LazyRegistry )
+	{
+		wr_buildRegistry( context );
+	}
+	return context->registry;
+}
+
+#ifdef WRENCH_LINUX_FILE_IO
+//------------------------------------------------------------------------------
+// a read-only mapping of a bytecode file, checked and decoded once then
+// shared by every context running it
+struct WRMappedFile
+{
+	WRMappedFile* next; // in WRState::mappedFiles
+	const unsigned char* data;
+	uint32_t size;
+	uint32_t pathHash;
+	uint64_t device;
+	uint64_t inode;
+	int64_t mtime;
+	int32_t mtimeNsec;
+	int references; // the state's cache plus each context, atomic
+	WRFunction* functions;
+};
+
+void wr_releaseMapped( WRMappedFile* mapped );
+#endif
+
 //------------------------------------------------------------------------------
 struct WRLibraryCleanup
 {
@@ -57,8 +95,17 @@ struct WRLibraryCleanup
 
 void wr_addLibraryCleanupFunction( WRState* w, void(*function)(WRState *w, void* param), void* param );
 
+// the math:: function registered under 'hash' when its result depends
+// on nothing but its arguments, so the compiler can call it early
+WR_LIB_CALLBACK wr_pureMathFunction( const uint32_t hash );
+
 void wr_countOfArrayElement( WRValue* array, WRValue* target );
 
+// Define 32-bit signed integer overflow behavior explicitly as two's-complement wrap.
+inline int32_t wr_iadd_wrap( const int32_t a, const int32_t b ) { return (int32_t)((uint32_t)a + (uint32_t)b); }
+inline int32_t wr_isub_wrap( const int32_t a, const int32_t b ) { return (int32_t)((uint32_t)a - (uint32_t)b); }
+inline int32_t wr_imul_wrap( const int32_t a, const int32_t b ) { return (int32_t)((uint32_t)a * (uint32_t)b); }
+
 typedef void (*WRVoidFunc)( WRValue* to, WRValue* from );
 extern WRVoidFunc wr_assign[16];
 extern WRVoidFunc wr_SubtractAssign[16];
@@ -105,7 +152,7 @@ extern WRTargetFunc wr_ANDBinary[16];
 extern WRTargetFunc wr_ORBinary[16];
 extern WRTargetFunc wr_XORBinary[16];
 
-void wr_doIndexHash( WRValue* index, WRValue* value, WRValue* target );
+void wr_doIndexHash( WRContext* c, WRValue* index, WRValue* value, WRValue* target );
 typedef void (*WRStateFunc)( WRContext* c, WRValue* to, WRValue* from, WRValue* target );
 extern WRStateFunc wr_index[16];
 extern WRStateFunc wr_assignAsHash[4];
@@ -145,7 +192,7 @@ WRValue* wr_newObjectTable( WRContext* context, WRValue* stackTop, const uint8_t
 bool wr_concatStringCheck( WRValue* to, WRValue* from, WRValue* target );
 void wr_valueToEx( const WRValue* ex, WRValue* value );
 
-#define WR_FLOATS_EQUAL(f1,f2) (fabsf((f1) - (f2)) <= (fabsf((f1)*.0000005f)));
+#define WR_FLOATS_EQUAL(f1,f2) (fabsf((f1) - (f2)) <= (fabsf((f1)*.0000005f)))
 
 // if the current + native match then great it's a simple read, it's
 // only when they differ that we need bitshiftiness
@@ -201,4 +248,20 @@ void wr_valueToEx( const WRValue* ex, WRValue* value );
   #define READ_8_FROM_PC(P) (*(P))
  #endif
 
+//------------------------------------------------------------------------------
+// bytecode starts with [globals][functions][compiler flags], unless it
+// was linked WR_WIDE_BYTECODE in which case both counts follow as
+// 16-bit values
+inline bool wr_isWideBytecode( const unsigned char* block ) { return (READ_8_FROM_PC(block + 2) & WR_WIDE_BYTECODE) != 0; }
+inline int wr_globalsInBytecode( const unsigned char* block ) { return wr_isWideBytecode(block) ? (uint16_t)READ_16_FROM_PC(block + 3) : READ_8_FROM_PC(block); }
+inline int wr_functionsInBytecode( const unsigned char* block ) { return wr_isWideBytecode(block) ? (uint16_t)READ_16_FROM_PC(block + 5) : READ_8_FROM_PC(block + 1); }
+
+// header plus function table, what follows is the global symbols (if
+// WR_INCLUDE_GLOBALS) and then debug/source/code
+inline int wr_functionTableEnd( const unsigned char* block )
+{
+	return wr_isWideBytecode(block) ? WR_WIDE_HEADER_SIZE + (wr_functionsInBytecode(block) * WR_WIDE_FUNCTION_CORE_SIZE)
+									: 3 + (wr_functionsInBytecode(block) * WR_FUNCTION_CORE_SIZE);
+}
+
 #endif
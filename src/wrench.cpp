@@ -78,7 +78,9 @@ const uint16_t c_primeTable[] =
 };
 */
 
-WRContext* wr_createContext( WRState* w, const unsigned char* block, const int blockSize, bool takeOwnership, WRValue* stack =0 );
+// functions: an already decoded function table to share, the block is
+//            assumed to have been verified
+WRContext* wr_createContext( WRState* w, const unsigned char* block, const int blockSize, bool takeOwnership, WRValue* stack =0, WRFunction* functions =0 );
 
 #ifndef WRENCH_WITHOUT_COMPILER
 
@@ -442,8 +444,18 @@ private:
 #endif
 
 void wr_growValueArray( WRGCObject* va, int newSize );
+void wr_reserveValueArray( WRGCObject* va, const uint32_t capacity );
+void wr_growValueArrayFront( WRGCObject* va, const uint32_t count );
 WRValue* wr_valueFromConfirmedStruct( WRValue* value, uint32_t hash );
 
+// read/write one element of a flat array that isn't SV_VALUE (chars and
+// the packed numeric types), elements must be in range
+void wr_unpackElement( const WRGCObject* va, const uint32_t element, WRValue* value );
+void wr_packElement( WRGCObject* va, const uint32_t element, const WRValue* value );
+
+// bytes per element of a flat (>= SV_VALUE) array
+#define WR_SIZEOF_ELEMENT(T) ( ((T) == SV_VALUE) ? (int)sizeof(WRValue) : ((((T) == SV_INT32) || ((T) == SV_FLOAT32)) ? 4 : 1) )
+
 #define IS_SVA_VALUE_TYPE(V) ((V)->m_type & 0x1)
 
 #define INIT_AS_LIB_CONST    0xFFFFFFFC
@@ -460,19 +472,27 @@ WRValue* wr_valueFromConfirmedStruct( WRValue* value, uint32_t hash );
 #define INIT_AS_INT      WR_INT
 #define INIT_AS_FLOAT    WR_FLOAT
 
+// element indexes and raw array sizes live in the middle 21 bits of
+// p2, where p2 is 64 bits wide the bits past that go in the top word so
+// small values encode exactly as they always have
+#if defined(_WIN64) || (defined(__SIZEOF_POINTER__) && (__SIZEOF_POINTER__ == 8))
+#define ENCODE_ARRAY_ELEMENT_TO_P2(E) (((uintptr_t)((E) & 0x1FFFFF) << 8) | (((uintptr_t)(E) >> 21) << 32))
+#define DECODE_ARRAY_ELEMENT_FROM_P2(E) ((uint32_t)((((E)&0x1FFFFF00) >> 8) | (((E) >> 32) << 21)))
+#else
 #define ENCODE_ARRAY_ELEMENT_TO_P2(E) ((E)<<8)
 #define DECODE_ARRAY_ELEMENT_FROM_P2(E) (((E)&0x1FFFFF00) >> 8)
+#endif
 
 #define IS_EXARRAY_TYPE(P)   ((P)&0xC0)
 #define IS_EX_RAW_ARRAY_TYPE(P)   (((P)&0xE0) == WR_EX_RAW_ARRAY)
-#define EX_RAW_ARRAY_SIZE_FROM_P2(P) (((P)&0x1FFFFF00) >> 8)
+#define EX_RAW_ARRAY_SIZE_FROM_P2(P) DECODE_ARRAY_ELEMENT_FROM_P2(P)
 #define IS_EX_SINGLE_CHAR_RAW_P2(P) ((P) == (((uint32_t)WR_EX) | (((uint32_t)WR_EX_RAW_ARRAY<<24)) | (1<<8)))
 #define IS_INVALID(P) ((P) == INIT_AS_INVALID)
 
 #define EX_TYPE_MASK   0xE0
 #define IS_CONTAINER_MEMBER(X) (((X)&EX_TYPE_MASK)==WR_EX_CONTAINER_MEMBER)
 #define IS_ARRAY(X) ((X)==WR_EX_ARRAY)
-#define IS_ITERATOR(X) ((X)==WR_EX_ITERATOR)
+#define IS_ITERATOR(X) (((X)&EX_TYPE_MASK)==WR_EX_ITERATOR)
 #define IS_RAW_ARRAY(X) (((X)&EX_TYPE_MASK)==WR_EX_RAW_ARRAY)
 #define IS_HASH_TABLE(X) ((X)==WR_EX_HASH_TABLE)
 #define EXPECTS_HASH_INDEX(X) ( ((X)==WR_EX_STRUCT) || ((X)==WR_EX_HASH_TABLE) )
@@ -512,6 +532,9 @@ struct WRValue;
 struct WRContext;
 class WRValueSerializer;
 
+// set in an array's type byte when its size is written as 32 bits
+#define WR_SERIALIZE_SIZE32 0x80
+
 //------------------------------------------------------------------------------
 bool wr_serializeEx( WRValueSerializer& serializer, const WRValue& val );
 bool wr_deserializeEx( WRValue& value, WRValueSerializer& serializer, WRContext* context );
@@ -551,6 +574,7 @@ public:
 	}
 	
 	int size() const { return m_pos; }
+	unsigned int remaining() const { return m_size - m_pos; }
 	const char* data() const { return m_buf; }
 
 	bool read( char* data, const int size )
@@ -579,7 +603,9 @@ public:
 
 		if ( m_pos + size >= m_size )
 		{
-			m_size += (size*2) + 8;
+			// grow geometrically, large arrays are written one
+			// element at a time
+			m_size += (m_size >> 1) + (size*2) + 8;
 			char* newBuf = (char*)g_malloc( m_size );
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
 			if ( !newBuf )
@@ -1129,17 +1155,20 @@ SOFTWARE.
 /*------------------------------------------------------------------------------*/
 
 #define WR_FUNCTION_CORE_SIZE 11
+#define WR_WIDE_FUNCTION_CORE_SIZE 17 // 32-bit offsets and 16-bit frame, see WR_WIDE_BYTECODE
+#define WR_WIDE_HEADER_SIZE 7 // the usual 3 bytes then 16-bit globals and function counts
+
 //------------------------------------------------------------------------------
 struct WRFunction
 {
-	uint16_t namespaceOffset;
-	uint16_t functionOffset;
+	uint32_t namespaceOffset;
+	uint32_t functionOffset;
 	
 	uint32_t hash;
 
 	uint8_t arguments;
-	uint8_t frameSpaceNeeded;
-	uint8_t frameBaseAdjustment;
+	uint16_t frameSpaceNeeded;
+	uint16_t frameBaseAdjustment;
 };
 
 //------------------------------------------------------------------------------
@@ -1147,8 +1176,43 @@ enum WRContextFlags
 {
 	WRC_OwnsMemory = 1<<0, // if this is true, 'bottom' must be freed upon destruction
 	WRC_ForceYielded = 1<<1, // if this is true, 'bottom' must be freed upon destruction
+	WRC_LazyRegistry = 1<<2, // 'registry' has not been filled in from localFunctions yet
+	WRC_Wide = 1<<3, // bytecode is WR_WIDE_BYTECODE, NewObjectTable names a function instead of an offset
+};
+
+// the registry (function hash -> WRFunction) is only needed to look
+// functions up by name, so it is built the first time that happens
+void wr_buildRegistry( WRContext* context );
+inline WRGCObject& wr_registry( WRContext* context )
+{
+	if ( context->flags & WRC_LazyRegistry )
+	{
+		wr_buildRegistry( context );
+	}
+	return context->registry;
+}
+
+#ifdef WRENCH_LINUX_FILE_IO
+//------------------------------------------------------------------------------
+// a read-only mapping of a bytecode file, checked and decoded once then
+// shared by every context running it
+struct WRMappedFile
+{
+	WRMappedFile* next; // in WRState::mappedFiles
+	const unsigned char* data;
+	uint32_t size;
+	uint32_t pathHash;
+	uint64_t device;
+	uint64_t inode;
+	int64_t mtime;
+	int32_t mtimeNsec;
+	int references; // the state's cache plus each context, atomic
+	WRFunction* functions;
 };
 
+void wr_releaseMapped( WRMappedFile* mapped );
+#endif
+
 //------------------------------------------------------------------------------
 struct WRLibraryCleanup
 {
@@ -1159,8 +1223,17 @@ struct WRLibraryCleanup
 
 void wr_addLibraryCleanupFunction( WRState* w, void(*function)(WRState *w, void* param), void* param );
 
+// the math:: function registered under 'hash' when its result depends
+// on nothing but its arguments, so the compiler can call it early
+WR_LIB_CALLBACK wr_pureMathFunction( const uint32_t hash );
+
 void wr_countOfArrayElement( WRValue* array, WRValue* target );
 
+// Define 32-bit signed integer overflow behavior explicitly as two's-complement wrap.
+inline int32_t wr_iadd_wrap( const int32_t a, const int32_t b ) { return (int32_t)((uint32_t)a + (uint32_t)b); }
+inline int32_t wr_isub_wrap( const int32_t a, const int32_t b ) { return (int32_t)((uint32_t)a - (uint32_t)b); }
+inline int32_t wr_imul_wrap( const int32_t a, const int32_t b ) { return (int32_t)((uint32_t)a * (uint32_t)b); }
+
 typedef void (*WRVoidFunc)( WRValue* to, WRValue* from );
 extern WRVoidFunc wr_assign[16];
 extern WRVoidFunc wr_SubtractAssign[16];
@@ -1207,7 +1280,7 @@ extern WRTargetFunc wr_ANDBinary[16];
 extern WRTargetFunc wr_ORBinary[16];
 extern WRTargetFunc wr_XORBinary[16];
 
-void wr_doIndexHash( WRValue* index, WRValue* value, WRValue* target );
+void wr_doIndexHash( WRContext* c, WRValue* index, WRValue* value, WRValue* target );
 typedef void (*WRStateFunc)( WRContext* c, WRValue* to, WRValue* from, WRValue* target );
 extern WRStateFunc wr_index[16];
 extern WRStateFunc wr_assignAsHash[4];
@@ -1247,7 +1320,7 @@ WRValue* wr_newObjectTable( WRContext* context, WRValue* stackTop, const uint8_t
 bool wr_concatStringCheck( WRValue* to, WRValue* from, WRValue* target );
 void wr_valueToEx( const WRValue* ex, WRValue* value );
 
-#define WR_FLOATS_EQUAL(f1,f2) (fabsf((f1) - (f2)) <= (fabsf((f1)*.0000005f)));
+#define WR_FLOATS_EQUAL(f1,f2) (fabsf((f1) - (f2)) <= (fabsf((f1)*.0000005f)))
 
 // if the current + native match then great it's a simple read, it's
 // only when they differ that we need bitshiftiness
@@ -1303,6 +1376,22 @@ void wr_valueToEx( const WRValue* ex, WRValue* value );
   #define READ_8_FROM_PC(P) (*(P))
  #endif
 
+//------------------------------------------------------------------------------
+// bytecode starts with [globals][functions][compiler flags], unless it
+// was linked WR_WIDE_BYTECODE in which case both counts follow as
+// 16-bit values
+inline bool wr_isWideBytecode( const unsigned char* block ) { return (READ_8_FROM_PC(block + 2) & WR_WIDE_BYTECODE) != 0; }
+inline int wr_globalsInBytecode( const unsigned char* block ) { return wr_isWideBytecode(block) ? (uint16_t)READ_16_FROM_PC(block + 3) : READ_8_FROM_PC(block); }
+inline int wr_functionsInBytecode( const unsigned char* block ) { return wr_isWideBytecode(block) ? (uint16_t)READ_16_FROM_PC(block + 5) : READ_8_FROM_PC(block + 1); }
+
+// header plus function table, what follows is the global symbols (if
+// WR_INCLUDE_GLOBALS) and then debug/source/code
+inline int wr_functionTableEnd( const unsigned char* block )
+{
+	return wr_isWideBytecode(block) ? WR_WIDE_HEADER_SIZE + (wr_functionsInBytecode(block) * WR_WIDE_FUNCTION_CORE_SIZE)
+									: 3 + (wr_functionsInBytecode(block) * WR_FUNCTION_CORE_SIZE);
+}
+
 #endif
 /*******************************************************************************
 Copyright (c) 2026 Curt Hartung -- curt.hartung@gmail.com
@@ -1638,6 +1727,8 @@ enum WROpcode
 	O_GlobalBZ,
 	O_GlobalBZ8,
 
+	O_Wide, // followed by a WRWideOpcode
+
 	// non-interpreted opcodes
 	O_HASH_PLACEHOLDER,
 	O_FUNCTION_CALL_PLACEHOLDER,
@@ -1647,6 +1738,91 @@ enum WROpcode
 
 extern const char* c_opcodeName[];
 
+//------------------------------------------------------------------------------
+// operations whose operands do not fit the 8-bit encodings above, only
+// emitted when they have to be. 'shape' bit 0 set means the first
+// operand is a local, bit 1 the second
+enum WRWideOpcode
+{
+	W_LoadFromLocal = 0, // index16
+	W_LoadFromGlobal, // index16
+
+	W_CallFunctionByIndex, // args8 function16, returns to the next byte
+	W_CallFunctionByIndexSkip1, // args8 function16, returns one byte past it
+
+	W_PushIterator, // shape8 from16 iterator16
+	W_NextValueOrJump, // shape8 value16 iterator16 rel16
+	W_NextKeyValueOrJump, // shape8 key16 value16 iterator16 rel16
+
+	W_SwitchDense, // base32 count16 default16 [count * rel16]
+
+	W_TailCall, // args8 function16 pad8, reuses the caller's frame
+
+	W_PopToLocal, // index16, moves the top of the stack into a local untouched
+
+	// WR_OPTIMIZE proved every local named holds the type given, so
+	// these skip the type dispatch of the forms they replace
+	W_IntLLCompareLTBZ, // l8 l8 rel16
+	W_IntLLCompareLEBZ, // l8 l8 rel16
+	W_IntLLCompareGTBZ, // l8 l8 rel16
+	W_IntLLCompareGEBZ, // l8 l8 rel16
+	W_IntLLCompareEQBZ, // l8 l8 rel16
+	W_IntLLCompareNEBZ, // l8 l8 rel16
+
+	W_IntLICompareLTBZ, // l8 imm16 rel16
+	W_IntLICompareLEBZ, // l8 imm16 rel16
+	W_IntLICompareGTBZ, // l8 imm16 rel16
+	W_IntLICompareGEBZ, // l8 imm16 rel16
+	W_IntLICompareEQBZ, // l8 imm16 rel16
+	W_IntLICompareNEBZ, // l8 imm16 rel16
+
+	W_IntLCountLTBZ, // l8 l8 rel16, the first local against the count of the second
+
+	W_IntLLAddition, // l8 l8
+	W_IntLLSubtraction, // l8 l8
+	W_IntLLMultiplication, // l8 l8
+
+	W_FloatLLAddition, // l8 l8
+	W_FloatLLSubtraction, // l8 l8
+	W_FloatLLMultiplication, // l8 l8
+	W_FloatLLDivision, // l8 l8
+
+	// the sequences "wrench prof" found dispatched most, each doing
+	// what the instructions it replaces would have in one go
+	W_IncLocalLLCompareLT, // l8 l8 rel16, ++ the second local then jump while it is below the first
+	W_LLIndex, // l8 l8, LLValues + IndexSkipLoad
+	W_LLIndexHashPair, // l8 hash32 l8 hash32, LocalIndexHash twice + StackSwap 2
+
+	W_LAST,
+};
+
+extern const char* c_wideOpcodeName[];
+
+#ifdef WRENCH_OPCODE_PROFILE
+//------------------------------------------------------------------------------
+// an O_Wide instruction is counted as O_LAST + its sub-op
+#define WR_PROFILE_CODES ((int)O_LAST + (int)W_LAST)
+#define WR_PROFILE_TRIPLES 8192 // must be a power of 2
+
+struct WRProfileTriple
+{
+	uint32_t key; // (a*WR_PROFILE_CODES + b)*WR_PROFILE_CODES + c + 1, 0 when unused
+	uint64_t count;
+};
+
+struct WROpcodeProfile
+{
+	uint64_t total;
+	uint64_t lostTriples; // seen after the triple table filled up
+	uint32_t triplesUsed;
+	uint32_t last[2]; // the two instructions before this one, WR_PROFILE_CODES for none
+
+	uint64_t single[ WR_PROFILE_CODES ];
+	uint64_t pair[ WR_PROFILE_CODES * WR_PROFILE_CODES ];
+	WRProfileTriple triple[ WR_PROFILE_TRIPLES ];
+};
+#endif
+
 #endif
 /*******************************************************************************
 Copyright (c) 2026 Curt Hartung -- curt.hartung@gmail.com
@@ -1893,6 +2069,7 @@ const WROperation c_operations[] =
 	{ 0, 0, O_LAST, false, WR_OPER_PRE, O_LAST },
 };
 const int c_highestPrecedence = 17; // one higher than the highest entry above, things that happen absolutely LAST
+const int c_optimizerPasses = 4; // WR_OPTIMIZE gives up looking for more constants after compiling this many times
 
 //------------------------------------------------------------------------------
 enum WRExpressionType
@@ -1990,6 +2167,7 @@ struct WRExpressionContext
 	const WROperation* operation;
 	
 	int stackPosition;
+	int resultType; // WR_INT or WR_FLOAT when WR_OPTIMIZE knows what this leaves on the stack, otherwise -1
 	
 	WRBytecode bytecode;
 
@@ -2015,6 +2193,7 @@ struct WRExpressionContext
 		spaceAfter = false;
 		global = false;
 		stackPosition = -1;
+		resultType = -1;
 		token.clear();
 		value.init();
 		bytecode.clear();
@@ -2033,6 +2212,7 @@ public:
 	WRBytecode bytecode;
 	bool lValue;
 	bool allowFunctionNameHashLiteral;
+	bool valueOnly; // the result is only ever read, nothing can keep a reference to a local through it
 
 	//------------------------------------------------------------------------------
 	void pushToStack( int index )
@@ -2094,6 +2274,7 @@ public:
 
 	//------------------------------------------------------------------------------
 	void swapWithTop( int stackPosition, bool addOpcodes =true );
+	void swapTwoToTop( const int first, const int second );
 	
 	WRExpression() { reset(); }
 	WRExpression( WRarray<WRNamespaceLookup>& localSpace, bool isStructSpace )
@@ -2112,6 +2293,7 @@ public:
 		bytecode.clear();
 		lValue = false;
 		allowFunctionNameHashLiteral = false;
+		valueOnly = false;
 	}
 };
 
@@ -2123,6 +2305,99 @@ struct ConstantValue
 	ConstantValue() { value.init(); }
 };
 
+//------------------------------------------------------------------------------
+// what WR_OPTIMIZE has seen done to one local of one unit
+struct KnownLocal
+{
+	int unit;
+	uint32_t hash;
+	bool constant; // declared with a literal before anything read it, and only ever read after that
+	WRValue value;
+	int type; // WR_INT or WR_FLOAT if nothing ever leaves it holding anything else, otherwise -1
+	KnownLocal() : type(-1) { value.init(); }
+};
+
+//------------------------------------------------------------------------------
+// where in its unit WR_OPTIMIZE saw a local named, counted in
+// statements, so locals that are never live at the same time can be
+// given the same frame slot
+struct LocalSpan
+{
+	int unit;
+	uint32_t hash;
+	int first; // statement it is first named in
+	int last; // and the last
+	int block; // the block 'first' is in
+	int loads; // how many times 'first' loads it
+	int notes; // how many times 'first' notes it
+	int writes; // how many of those just overwrite it
+	bool scoped; // everything after 'first' that names it is inside 'block'
+	bool pinned; // something else can write to it, it keeps a slot to itself
+};
+
+//------------------------------------------------------------------------------
+// the statements a loop runs over and over, a local live going into
+// one stays live until it ends
+struct LoopSpan
+{
+	int unit;
+	int first;
+	int last;
+};
+
+//------------------------------------------------------------------------------
+// what one pass saw of a loop, by the statement it starts at, for the
+// next to decide how many locals to set aside for what it can move
+// ahead of it
+struct LoopFacts
+{
+	int unit;
+	int first;
+	int slots; // set aside for it this pass
+	int hoists; // operations found that could have been moved
+};
+
+//------------------------------------------------------------------------------
+// a local a loop stores to, or one that something moved out of it reads
+struct LoopLocal
+{
+	int unit;
+	int first;
+	uint32_t hash;
+};
+
+//------------------------------------------------------------------------------
+// a loop being parsed. 'code' runs once each time it is entered,
+// before its condition is first tested
+struct LoopHoist
+{
+	int first;
+	int slots; // locals set aside for it, '@hoist:<base + n>'
+	int base;
+	int used;
+	int hoists;
+	int entry; // jump target for 'code', -1 if there is none
+	WRBytecode* code;
+};
+
+//------------------------------------------------------------------------------
+// a local holding the result of an operation moved out of a loop
+struct HoistedLocal
+{
+	int unit;
+	uint32_t hash;
+	int type;
+	int loop; // index in m_loops of the loop whose 'code' sets it
+};
+
+//------------------------------------------------------------------------------
+enum WRLocalUse
+{
+	LOCAL_READ,
+	LOCAL_STORE,
+	LOCAL_OTHER,
+};
+
 //------------------------------------------------------------------------------
 struct WRUnitContext
 {
@@ -2135,7 +2410,7 @@ struct WRUnitContext
 
 	WRarray<ConstantValue> constantValues;
 
-	int16_t offsetOfLocalHashMap;
+	int offsetOfLocalHashMap;
 	
 	// the code that runs when it loads
 	// the locals it has
@@ -2170,6 +2445,13 @@ public:
 					 const uint8_t compilerOptionFlags );
 
 private:
+
+	WRError compilePass( const char* data,
+						 const int size,
+						 unsigned char** out,
+						 int* outLen,
+						 WRstr* erroMsg,
+						 const uint8_t compilerOptionFlags );
 	
 	bool isReserved( const char* token );
 	bool isValidLabel( WRstr& token, bool& isGlobal, WRstr& prefix, bool& isLibConstant );
@@ -2183,6 +2465,9 @@ private:
 
 	friend class WRExpression;
 	static void pushOpcode( WRBytecode& bytecode, WROpcode opcode );
+	static void pushLoad( WRBytecode& bytecode, const bool global, const unsigned int index );
+	static bool singleLoad( WRBytecode& bytecode, unsigned int* load );
+	static bool literalValue( WRBytecode& bytecode, WRValue& value );
 	static void pushData( WRBytecode& bytecode, const unsigned char* data, const int len ) { bytecode.all.append( data, len ); }
 	static void pushData( WRBytecode& bytecode, const char* data, const int len ) { bytecode.all.append( (unsigned char*)data, len ); }
 
@@ -2192,6 +2477,8 @@ private:
 	bool m_embedGlobalSymbols;
 	bool m_embedSourceCode;
 	bool m_needVar;
+	bool m_inlineFunctions;
+	bool m_optimize;
 	bool m_exportNextUnit;
 	
 	uint16_t m_lastCode;
@@ -2219,7 +2506,29 @@ private:
 	unsigned int resolveExpressionEx( WRExpression& expression, int o, int p );
 
 	bool operatorFound( WRstr const& token, WRarray<WRExpressionContext>& context, int depth );
-	bool parseCallFunction( WRExpression& expression, WRstr functionName, int depth, bool parseArguments );
+	bool parseCallFunction( WRExpression& expression, WRstr functionName, int depth, bool parseArguments, bool construct =false );
+	bool inlineCallFunction( WRExpression& expression, int depth, uint32_t hash, unsigned char argsPushed, bool argsAreLocals );
+	bool tracksLocals( WRExpression& expression );
+	void noteLocal( const uint32_t hash, WRLocalUse use, const WRValue* value =0, const int type =-1 );
+	LocalSpan& localSpan( const uint32_t hash );
+	void overwriteLocal( const uint32_t hash );
+	int openBlock();
+	void addLoopSpan( const int first );
+	void openLoop( const int first, WRBytecode& code );
+	void enterLoop();
+	void closeLoop( const int back );
+	unsigned int hoistOperation( WRExpression& expression, const int o );
+	bool localsAreMembers( const unsigned int u );
+	void packFrame( const unsigned int u );
+	bool knownLocal( WRstr const& token, WRValue& value );
+	int localType( const uint32_t hash );
+	int contextType( WRExpression& expression, const int index );
+	int operationType( WRExpression& expression, const int o );
+	int slotType( WRBytecode& bytecode, const int slot );
+	int typedCompare( WRBytecode& bytecode, const int offset );
+	void typedOperation( WRBytecode& bytecode, const unsigned int mark );
+	unsigned int optimizeOperation( WRExpression& expression, int o );
+	bool discardBytecode( WRBytecode& bytecode, unsigned int mark, unsigned int targets );
 	bool pushObjectTable( WRExpressionContext& context, WRarray<WRNamespaceLookup>& localSpace, uint32_t hash );
 	int parseInitializer( WRExpression& expression, int depth );
 	char parseExpression( WRExpression& expression );
@@ -2280,6 +2589,29 @@ private:
 	WRarray<int> m_breakTargets;
 
 	int m_foreachHash;
+
+	bool m_straightLine; // nothing in this unit has branched or been branched to yet
+	bool m_unconditional; // not inside an if, loop or switch, so every call runs what is being parsed
+	bool m_localsNoted; // the operation being resolved has already noted its locals
+	bool m_guessTypes; // first pass: type locals from what has been seen so far, nothing is emitted from it
+	WRarray<KnownLocal> m_knownLocals; // what the previous pass proved
+	WRarray<KnownLocal> m_localUses; // what this pass has seen
+	int m_statement; // statements parsed so far
+	int m_block; // the block being parsed, -1 for none
+	WRarray<int> m_blockParents; // the block each block is inside
+	WRarray<LocalSpan> m_localSpans;
+	WRarray<LoopSpan> m_loopSpans;
+	bool m_hoistLoops; // operations may be moved out of loops
+	bool m_hoisting; // the code being resolved is the moved copy
+	bool m_hoistRefused; // this pass moved something it should not have
+	int m_hoistSlots; // '@hoist' locals named so far
+	WRarray<LoopFacts> m_loopFacts;
+	WRarray<LoopFacts> m_lastLoopFacts;
+	WRarray<LoopLocal> m_loopStores;
+	WRarray<LoopLocal> m_lastLoopStores;
+	WRarray<LoopLocal> m_loopReads;
+	WRarray<LoopHoist> m_loops;
+	WRarray<HoistedLocal> m_hoisted;
 };
 
 //------------------------------------------------------------------------------
@@ -3101,6 +3433,122 @@ WRError WRCompilationContext::compile( const char* source,
 									   int* outLen,
 									   WRstr* errorMsg,
 									   const uint8_t compilerOptionFlags )
+{
+	m_guessTypes = false;
+	m_hoistLoops = true;
+
+	if ( !(compilerOptionFlags & WR_OPTIMIZE) || (compilerOptionFlags & WR_EMBED_DEBUG_CODE) )
+	{
+		return compilePass( source, size, out, outLen, errorMsg, compilerOptionFlags );
+	}
+
+	// a local is only known to be constant once a whole pass has seen
+	// every use of it, and folding with what one pass learned can turn
+	// up more, so compile again until a pass learns nothing new.
+	//
+	// Types go the other way: the first pass guesses one for every
+	// local and emits nothing from it, each pass after that emits
+	// typed code for the guesses still standing and checks them
+	// again. Only a pass that broke none of them can be kept
+	//
+	// What can be moved out of a loop is only known once the whole
+	// loop has been seen, so each pass sets aside as many locals to
+	// move things into as the one before it found a use for
+	bool typed = true;
+	for( int pass=1; ; ++pass )
+	{
+		WRCompilationContext comp;
+		comp.m_knownLocals = m_knownLocals;
+		comp.m_guessTypes = (pass == 1);
+		comp.m_hoistLoops = m_hoistLoops;
+		comp.m_lastLoopFacts = m_lastLoopFacts;
+		comp.m_lastLoopStores = m_lastLoopStores;
+
+		WRError err = comp.compilePass( source, size, out, outLen, errorMsg, compilerOptionFlags );
+		if ( err != WR_ERR_None )
+		{
+			return err;
+		}
+
+		unsigned int knew = 0;
+		bool broken = false;
+		for( unsigned int k=0; k<m_knownLocals.count(); ++k )
+		{
+			KnownLocal& K = m_knownLocals[k];
+			knew += K.constant ? 1 : 0;
+
+			for( unsigned int l=0; K.type != -1 && l<comp.m_localUses.count(); ++l )
+			{
+				if ( comp.m_localUses[l].hash == K.hash && comp.m_localUses[l].unit == K.unit )
+				{
+					broken = broken || (comp.m_localUses[l].type != K.type);
+					break;
+				}
+			}
+		}
+
+		unsigned int known = 0;
+		bool guessed = false;
+		for( unsigned int l=0; l<comp.m_localUses.count(); ++l )
+		{
+			known += comp.m_localUses[l].constant ? 1 : 0;
+			guessed = guessed || (pass == 1 && comp.m_localUses[l].type != -1);
+		}
+
+		bool unsettled = false;
+		for( unsigned int f=0; f<comp.m_loopFacts.count(); ++f )
+		{
+			unsettled = unsettled || (comp.m_loopFacts[f].hoists != comp.m_loopFacts[f].slots);
+		}
+
+		if ( !broken
+			 && !comp.m_hoistRefused
+			 && ((known <= knew && !guessed && !unsettled) || pass >= c_optimizerPasses) )
+		{
+			return err;
+		}
+
+		g_free( *out );
+
+		// one that moved something it should not have has to be done
+		// over without moving anything
+		m_hoistLoops = m_hoistLoops && !comp.m_hoistRefused;
+		m_lastLoopFacts = comp.m_loopFacts;
+		m_lastLoopStores = comp.m_loopStores;
+
+		// out of passes with the types still moving, settle for none
+		typed = typed && pass < c_optimizerPasses;
+		
+		WRarray<KnownLocal> assumed;
+		assumed = m_knownLocals;
+		m_knownLocals.clear();
+		for( unsigned int l=0; l<comp.m_localUses.count(); ++l )
+		{
+			KnownLocal& L = comp.m_localUses[l];
+
+			bool stands = typed && L.type != -1 && pass == 1;
+			for( unsigned int a=0; typed && !stands && L.type != -1 && a<assumed.count(); ++a )
+			{
+				stands = assumed[a].hash == L.hash && assumed[a].unit == L.unit && assumed[a].type == L.type;
+			}
+
+			if ( L.constant || stands )
+			{
+				KnownLocal& K = m_knownLocals.append();
+				K = L;
+				K.type = stands ? L.type : -1;
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+WRError WRCompilationContext::compilePass( const char* source,
+										   const int size,
+										   unsigned char** out,
+										   int* outLen,
+										   WRstr* errorMsg,
+										   const uint8_t compilerOptionFlags )
 {
 	m_source = source;
 	m_sourceLen = size;
@@ -3127,6 +3575,24 @@ WRError WRCompilationContext::compile( const char* source,
 	m_embedSourceCode = compilerOptionFlags & WR_EMBED_SOURCE_CODE;
 	m_embedGlobalSymbols = compilerOptionFlags & WR_INCLUDE_GLOBALS;
 	m_needVar = !(compilerOptionFlags & WR_NON_STRICT_VAR);
+	m_inlineFunctions = (compilerOptionFlags & WR_INLINE_FUNCTIONS) && !m_addDebugSymbols;
+	m_optimize = (compilerOptionFlags & WR_OPTIMIZE) && !m_addDebugSymbols;
+	m_straightLine = false;
+	m_unconditional = false;
+	m_localsNoted = false;
+	m_statement = 0;
+	m_block = -1;
+	m_blockParents.clear();
+	m_localSpans.clear();
+	m_loopSpans.clear();
+	m_hoisting = false;
+	m_hoistRefused = false;
+	m_hoistSlots = 0;
+	m_loopFacts.clear();
+	m_loopStores.clear();
+	m_loopReads.clear();
+	m_loops.clear();
+	m_hoisted.clear();
 
 	do
 	{
@@ -3186,6 +3652,30 @@ WRError WRCompilationContext::compile( const char* source,
 
 	pushOpcode( m_units[0].bytecode, O_Stop );
 
+	// what was moved out of a loop is only safe if the loop turned out
+	// not to store what it read, and nothing can reach its locals by name
+	// or jump into it past the code that sets them
+	for( unsigned int f=0; f<m_loopFacts.count(); ++f )
+	{
+		const int u = m_loopFacts[f].unit;
+		if ( localsAreMembers(u) || m_units[u].bytecode.gotoSource.count() )
+		{
+			m_hoistRefused = m_hoistRefused || m_loopFacts[f].slots;
+			m_loopFacts[f].hoists = 0;
+		}
+	}
+
+	for( unsigned int r=0; r<m_loopReads.count(); ++r )
+	{
+		for( unsigned int w=0; w<m_loopStores.count(); ++w )
+		{
+			m_hoistRefused = m_hoistRefused
+							 || (m_loopStores[w].unit == m_loopReads[r].unit
+								 && m_loopStores[w].first == m_loopReads[r].first
+								 && m_loopStores[w].hash == m_loopReads[r].hash);
+		}
+	}
+
 	link( out, outLen, compilerOptionFlags );
 	if ( m_err )
 	{
@@ -3458,11 +3948,36 @@ void WRCompilationContext::addRelativeJumpSource( WRBytecode& bytecode, WROpcode
 
 		default: break;
 	}
+
+	if ( opcode == O_BZ )
+	{
+		offset = typedCompare( bytecode, offset );
+	}
 	
 	bytecode.jumpOffsetTargets[relativeJumpTarget].references.append() = offset;
 	pushData( bytecode, "\t\t", 2 );
 }
 
+//------------------------------------------------------------------------------
+// how far past its sub-opcode a wide jump keeps its 16-bit vector
+static int wr_wideJumpOffset( const unsigned char sub )
+{
+	if ( sub == W_NextKeyValueOrJump )
+	{
+		return 8;
+	}
+	else if ( sub == W_NextValueOrJump )
+	{
+		return 6;
+	}
+	else if ( sub >= W_IntLICompareLTBZ && sub <= W_IntLICompareNEBZ )
+	{
+		return 4;
+	}
+
+	return 3; // W_IntLLCompare*BZ, W_IntLCountLTBZ, W_IncLocalLLCompareLT
+}
+
 //------------------------------------------------------------------------------
 void WRCompilationContext::resolveRelativeJumps( WRBytecode& bytecode )
 {
@@ -3558,6 +4073,13 @@ void WRCompilationContext::resolveRelativeJumps( WRBytecode& bytecode )
 					break;
 				}
 
+				case O_Wide:
+				{
+					no8version = true;
+					diff -= wr_wideJumpOffset( bytecode.all[offset] );
+					break;
+				}
+
 				default:
 					break;
 			}
@@ -3775,6 +4297,12 @@ void WRCompilationContext::resolveRelativeJumps( WRBytecode& bytecode )
 						offset += 2;
 						break;
 					}
+
+					case O_Wide:
+					{
+						offset += wr_wideJumpOffset( bytecode.all[offset] );
+						break;
+					}
 						
 					default:
 					{
@@ -3789,6 +4317,62 @@ void WRCompilationContext::resolveRelativeJumps( WRBytecode& bytecode )
 	}
 }
 
+//------------------------------------------------------------------------------
+static void wr_trimReferences( WRarray<int>& references, const int mark )
+{
+	for( int r=references.count() - 1; r>=0; --r )
+	{
+		if ( references[r] >= mark )
+		{
+			references.remove( r, 1 );
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// throw away everything added to 'bytecode' since it was 'mark' bytes
+// long and had 'targets' jump targets, because it can never run.
+// Refused when a goto label in there means it still could
+bool WRCompilationContext::discardBytecode( WRBytecode& bytecode, unsigned int mark, unsigned int targets )
+{
+	for( unsigned int j=targets; j<bytecode.jumpOffsetTargets.count(); ++j )
+	{
+		if ( bytecode.jumpOffsetTargets[j].gotoHash )
+		{
+			return false;
+		}
+	}
+
+	bytecode.all.shave( bytecode.all.size() - mark );
+	bytecode.invalidateOpcodeCache();
+
+	for( unsigned int j=0; j<bytecode.jumpOffsetTargets.count(); ++j )
+	{
+		wr_trimReferences( bytecode.jumpOffsetTargets[j].references, mark );
+	}
+	for( unsigned int n=0; n<bytecode.localSpace.count(); ++n )
+	{
+		wr_trimReferences( bytecode.localSpace[n].references, mark );
+	}
+	for( unsigned int n=0; n<bytecode.functionSpace.count(); ++n )
+	{
+		wr_trimReferences( bytecode.functionSpace[n].references, mark );
+	}
+	for( unsigned int n=0; n<bytecode.unitObjectSpace.count(); ++n )
+	{
+		wr_trimReferences( bytecode.unitObjectSpace[n].references, mark );
+	}
+	for( int g=bytecode.gotoSource.count() - 1; g>=0; --g )
+	{
+		if ( bytecode.gotoSource[g].offset >= (int)mark )
+		{
+			bytecode.gotoSource.remove( g, 1 );
+		}
+	}
+
+	return true;
+}
+
 //------------------------------------------------------------------------------
 void WRCompilationContext::pushLiteral( WRBytecode& bytecode, WRExpressionContext& context )
 {
@@ -3869,53 +4453,153 @@ bool WRCompilationContext::isNamedEnumMember( WRstr const& token )
 }
 
 //------------------------------------------------------------------------------
-int WRCompilationContext::addLocalSpaceLoad( WRBytecode& bytecode, WRstr& token, bool addOnly, bool varSeen, bool allowFunctionNameHashLiteral )
+void WRCompilationContext::pushLoad( WRBytecode& bytecode, const bool global, const unsigned int index )
 {
-	if ( m_unitTop == 0 )
+	if ( index < 256 )
 	{
-		return addGlobalSpaceLoad( bytecode, token, addOnly, varSeen, allowFunctionNameHashLiteral );
+		pushOpcode( bytecode, global ? O_LoadFromGlobal : O_LoadFromLocal );
+		unsigned char c = index;
+		pushData( bytecode, &c, 1 );
 	}
+	else
+	{
+		// past 255 the index needs two bytes; link() sees the
+		// counts and marks the whole image wide
+		unsigned char data[3];
+		data[0] = global ? W_LoadFromGlobal : W_LoadFromLocal;
+		wr_pack16( index, data + 1 );
+		pushOpcode( bytecode, O_Wide );
+		pushData( bytecode, data, 3 );
+	}
+}
 
-	uint32_t hash = wr_hashStr(token);
+//------------------------------------------------------------------------------
+// is this bytecode nothing but one load? if so report it as the
+// narrow opcode and its index
+bool WRCompilationContext::singleLoad( WRBytecode& bytecode, unsigned int* load )
+{
+	unsigned int a = 0;
+	unsigned int o = 0;
+	if ( bytecode.opcodes.size() == 2 && bytecode.all.size() > 3 && bytecode.all[0] == O_DebugInfo )
+	{
+		a = 3;
+		o = 1;
+	}
 	
-	unsigned int i=0;
-		
-	for( ; i<bytecode.localSpace.count(); ++i )
+	if ( bytecode.opcodes.size() != o + 1 )
 	{
-		if ( bytecode.localSpace[i].hash == hash )
-		{
-			break;
-		}
+		return false;
 	}
 
-	if ( i >= bytecode.localSpace.count() )
+	if ( bytecode.all.size() == a + 2
+		 && (bytecode.all[a] == O_LoadFromLocal || bytecode.all[a] == O_LoadFromGlobal) )
 	{
-		if ( !addOnly )
-		{
-			WRstr t2;
-			if ( varSeen || (token[0] == ':' && token[1] == ':') )
-			{
-				t2 = token;
-			}
-			else
-			{
-				t2.format("::%s", token.c_str());
-			}
+		load[0] = bytecode.all[a];
+		load[1] = (unsigned char)bytecode.all[a + 1];
+		return true;
+	}
 
-			uint32_t ghash = wr_hashStr(t2);
+	if ( bytecode.all.size() == a + 4
+		 && bytecode.all[a] == O_Wide
+		 && (bytecode.all[a + 1] == W_LoadFromLocal || bytecode.all[a + 1] == W_LoadFromGlobal) )
+	{
+		load[0] = (bytecode.all[a + 1] == W_LoadFromLocal) ? O_LoadFromLocal : O_LoadFromGlobal;
+		load[1] = bytecode.all[a + 2] | ((unsigned int)bytecode.all[a + 3] << 8);
+		return true;
+	}
 
-			// was NOT found locally which is possible for a "global" if
-			// the argument list names it, now check global with the global
-			// hash
-			if ( !bytecode.isStructSpace || varSeen ) // structs and explicit 'var' are immune to this
-			{
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// is this bytecode nothing but a numeric literal? if so report its value
+bool WRCompilationContext::literalValue( WRBytecode& bytecode, WRValue& value )
+{
+	if ( bytecode.jumpOffsetTargets.count() )
+	{
+		return false;
+	}
+
+	const unsigned char* code = bytecode.all;
+	const unsigned int size = bytecode.all.size();
+
+	if ( size == 1 && code[0] == O_LiteralZero )
+	{
+		value.p2 = INIT_AS_INT;
+		value.i = 0;
+	}
+	else if ( size == 2 && code[0] == O_LiteralInt8 )
+	{
+		value.p2 = INIT_AS_INT;
+		value.i = (int8_t)code[1];
+	}
+	else if ( size == 3 && code[0] == O_LiteralInt16 )
+	{
+		value.p2 = INIT_AS_INT;
+		value.i = (int16_t)((uint16_t)code[1] | ((uint16_t)code[2] << 8));
+	}
+	else if ( size == 5 && (code[0] == O_LiteralInt32 || code[0] == O_LiteralFloat) )
+	{
+		value.p2 = (code[0] == O_LiteralInt32) ? INIT_AS_INT : INIT_AS_FLOAT;
+		value.ui = (uint32_t)code[1]
+				   | ((uint32_t)code[2] << 8)
+				   | ((uint32_t)code[3] << 16)
+				   | ((uint32_t)code[4] << 24);
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+int WRCompilationContext::addLocalSpaceLoad( WRBytecode& bytecode, WRstr& token, bool addOnly, bool varSeen, bool allowFunctionNameHashLiteral )
+{
+	if ( m_unitTop == 0 )
+	{
+		return addGlobalSpaceLoad( bytecode, token, addOnly, varSeen, allowFunctionNameHashLiteral );
+	}
+
+	uint32_t hash = wr_hashStr(token);
+	
+	unsigned int i=0;
+		
+	for( ; i<bytecode.localSpace.count(); ++i )
+	{
+		if ( bytecode.localSpace[i].hash == hash )
+		{
+			break;
+		}
+	}
+
+	if ( i >= bytecode.localSpace.count() )
+	{
+		if ( !addOnly )
+		{
+			WRstr t2;
+			if ( varSeen || (token[0] == ':' && token[1] == ':') )
+			{
+				t2 = token;
+			}
+			else
+			{
+				t2.format("::%s", token.c_str());
+			}
+
+			uint32_t ghash = wr_hashStr(t2);
+
+			// was NOT found locally which is possible for a "global" if
+			// the argument list names it, now check global with the global
+			// hash
+			if ( !bytecode.isStructSpace || varSeen ) // structs and explicit 'var' are immune to this
+			{
 				for (unsigned int j = 0; j < m_units[0].bytecode.localSpace.count(); ++j)
 				{
 					if (m_units[0].bytecode.localSpace[j].hash == ghash)
 					{
-						pushOpcode(bytecode, O_LoadFromGlobal);
-						unsigned char c = j;
-						pushData(bytecode, &c, 1);
+						pushLoad( bytecode, true, j );
 						return j;
 					}
 				}
@@ -3942,9 +4626,25 @@ int WRCompilationContext::addLocalSpaceLoad( WRBytecode& bytecode, WRstr& token,
 	
 	if ( !addOnly )
 	{
-		pushOpcode( bytecode, O_LoadFromLocal );
-		unsigned char c = i;
-		pushData( bytecode, &c, 1 );
+		if ( m_optimize )
+		{
+			LocalSpan& S = localSpan( hash );
+			if ( S.first == m_statement )
+			{
+				++S.loads;
+			}
+			else
+			{
+				// named again further on, it only stays scoped if
+				// that is somewhere inside the block it started in
+				S.last = m_statement;
+				int b = m_block;
+				for( ; b != -1 && b != S.block; b = m_blockParents[b] );
+				S.scoped = S.scoped && b == S.block;
+			}
+		}
+
+		pushLoad( bytecode, false, i );
 	}
 	
 	return i;
@@ -3994,9 +4694,7 @@ int WRCompilationContext::addGlobalSpaceLoad( WRBytecode& bytecode, WRstr& token
 
 	if ( !addOnly )
 	{
-		pushOpcode( bytecode, O_LoadFromGlobal );
-		unsigned char c = i;
-		pushData( bytecode, &c, 1 );
+		pushLoad( bytecode, true, i );
 	}
 
 	return i;
@@ -4005,6 +4703,11 @@ int WRCompilationContext::addGlobalSpaceLoad( WRBytecode& bytecode, WRstr& token
 //------------------------------------------------------------------------------
 void WRCompilationContext::loadExpressionContext( WRExpression& expression, int depth, int operation )
 {
+	if ( m_optimize && expression.context[depth].stackPosition == -1 )
+	{
+		expression.context[depth].resultType = contextType( expression, depth );
+	}
+
 	if ( operation > 0
 		 && expression.context[operation].operation
 		 && expression.context[operation].operation->opcode == O_HASH_PLACEHOLDER
@@ -4036,6 +4739,27 @@ void WRCompilationContext::loadExpressionContext( WRExpression& expression, int
 			case EXTYPE_LABEL_AND_NULL:
 			case EXTYPE_LABEL:
 			{
+				if ( !m_localsNoted
+					 && !expression.context[depth].global
+					 && tracksLocals(expression) )
+				{
+					// on its own it is only read, or for a bare 'var'
+					// declaration set to 0. Anywhere else it could be
+					// handed out as a reference
+					WRLocalUse use = LOCAL_OTHER;
+					if ( expression.valueOnly && expression.context.count() == 1 )
+					{
+						use = (expression.context[depth].type == EXTYPE_LABEL) ? LOCAL_READ
+							  : (expression.context[depth].blankSeen ? LOCAL_OTHER : LOCAL_STORE);
+					}
+					
+					noteLocal( wr_hashStr(expression.context[depth].token), use, 0, WR_INT );
+					if ( use == LOCAL_STORE )
+					{
+						overwriteLocal( wr_hashStr(expression.context[depth].token) );
+					}
+				}
+
 					if ( expression.context[depth].global )
 					{
 						addGlobalSpaceLoad( expression.bytecode,
@@ -4109,7 +4833,31 @@ void WRExpression::swapWithTop( int stackPosition, bool addOpcodes )
 
 	assert( (currentTop != (unsigned int)-1) && (swapWith != (unsigned int)-1) );
 
-	if ( addOpcodes )
+	const unsigned int size = bytecode.all.size();
+	const unsigned int cached = bytecode.opcodes.size();
+	if ( addOpcodes
+		 && stackPosition == 1
+		 && cached >= 2
+		 && bytecode.opcodes[cached - 2] == O_LocalIndexHash
+		 && bytecode.opcodes[cached - 1] == O_LocalIndexHash
+		 && size >= 12
+		 && bytecode.all[size - 12] == O_LocalIndexHash
+		 && bytecode.all[size - 6] == O_LocalIndexHash )
+	{
+		// 'a.x op= b.y' looks both members up and swaps them, which is
+		// the same twelve bytes as one wide instruction that does it all:
+		// [LIH][a][hash] [LIH][b][hash] -> [O_Wide][sub][a][hash] [b][hash]
+		for( unsigned int i = size - 6; i > size - 11; --i )
+		{
+			bytecode.all[i] = bytecode.all[i - 1];
+		}
+		bytecode.all[size - 11] = W_LLIndexHashPair;
+		bytecode.all[size - 12] = O_Wide;
+
+		bytecode.opcodes.shave( 2 );
+		bytecode.opcodes += O_Wide;
+	}
+	else if ( addOpcodes )
 	{
 		unsigned char pos = stackPosition + 1;
 		WRCompilationContext::pushOpcode( bytecode, O_StackSwap );
@@ -4120,467 +4868,2412 @@ void WRExpression::swapWithTop( int stackPosition, bool addOpcodes )
 }
 
 //------------------------------------------------------------------------------
-void WRCompilationContext::resolveExpression( WRExpression& expression )
+// move context 'first' to the top and 'second' just below it with one
+// SwapTwoToTop, which swaps the top with A and then the slot below the
+// top with B
+void WRExpression::swapTwoToTop( const int first, const int second )
 {
-	if ( expression.context.count() == 1 ) // single expression is trivial to resolve, load it!
+	const int f = context[first].stackPosition;
+	const int s = context[second].stackPosition ? context[second].stackPosition : f; // where second is after the first swap
+
+	WRCompilationContext::pushOpcode( bytecode, O_SwapTwoToTop );
+	unsigned char pos = f + 1;
+	WRCompilationContext::pushData( bytecode, &pos, 1 );
+	pos = s + 1;
+	WRCompilationContext::pushData( bytecode, &pos, 1 );
+
+	swapWithTop( f, false );
+
+	// slot 1 <-> slot s by way of the top
+	swapWithTop( 1, false );
+	swapWithTop( s, false );
+	swapWithTop( 1, false );
+}
+
+//------------------------------------------------------------------------------
+// operations that only read their operands and cannot do anything
+// else, so literal operands can be worked out ahead of time
+static bool wr_isPureOperation( const int opcode )
+{
+	switch( opcode )
 	{
-		loadExpressionContext( expression, 0, 0 );
-		return;
-	}
+		case O_CompareEQ:
+		case O_CompareNE:
+		case O_CompareGE:
+		case O_CompareLE:
+		case O_CompareGT:
+		case O_CompareLT:
+		case O_LogicalAnd:
+		case O_LogicalOr:
+		case O_LogicalNot:
+		case O_BitwiseNOT:
+		case O_Negate:
+		case O_BinaryAddition:
+		case O_BinarySubtraction:
+		case O_BinaryMultiplication:
+		case O_BinaryDivision:
+		case O_BinaryMod:
+		case O_BinaryOr:
+		case O_BinaryAnd:
+		case O_BinaryXOR:
+		case O_BinaryRightShift:
+		case O_BinaryLeftShift:
+		case O_ToInt:
+		case O_ToFloat:
+			return true;
 
-	unsigned int resolves = 1;
-	unsigned int startedWith = expression.context.count();
+		default:
+			return false;
+	}
+}
 
-	for( int p=0; p<c_highestPrecedence && expression.context.count() > 1; ++p )
+//------------------------------------------------------------------------------
+// 'a <opcode> b', or '<opcode> b' when 'a' is null, worked out the
+// way the VM would. Anything the VM would do differently depending
+// on how it was built (dividing by zero, shifting too far, comparing
+// floats) is left for it to do
+static bool wr_foldOperation( const int opcode, const WRValue* a, const WRValue& b, WRValue& result )
+{
+	if ( !a )
 	{
-		// left to right operations
-		for( int o=0; (unsigned int)o < expression.context.count(); ++o )
+		if ( b.type == WR_INT )
 		{
-			if ( (expression.context[o].type != EXTYPE_OPERATION)
-				 || expression.context[o].operation->precedence > p
-				 || !expression.context[o].operation->leftToRight )
+			result.p2 = INIT_AS_INT;
+			switch( opcode )
 			{
-				continue;
+				case O_Negate: result.i = wr_isub_wrap( 0, b.i ); return true;
+				case O_BitwiseNOT: result.i = ~b.i; return true;
+				case O_LogicalNot: result.i = !b.i; return true;
+				case O_ToInt: result.i = b.i; return true;
+				case O_ToFloat: result.p2 = INIT_AS_FLOAT; result.f = (float)b.i; return true;
+				default: return false;
 			}
+		}
 
-			resolves += resolveExpressionEx( expression, o, p );
-			if (m_err)
+		switch( opcode )
+		{
+			case O_Negate: result.p2 = INIT_AS_FLOAT; result.f = -b.f; return true;
+			case O_ToFloat: result = b; return true;
+			case O_ToInt:
 			{
-				return;
+				if ( !(b.f >= -2147483648.f && b.f < 2147483648.f) )
+				{
+					return false;
+				}
+				result.p2 = INIT_AS_INT;
+				result.i = (int32_t)b.f;
+				return true;
 			}
-			o = (unsigned int)-1;
+			default: return false;
 		}
+	}
 
-		// right to left operations
-		for( int o = expression.context.count() - 1; o >= 0; --o )
+	if ( a->type == WR_INT && b.type == WR_INT )
+	{
+		const int32_t minInt = (int32_t)0x80000000;
+		result.p2 = INIT_AS_INT;
+		switch( opcode )
 		{
-			if ( (expression.context[o].type != EXTYPE_OPERATION)
-				 || expression.context[o].operation->precedence > p
-				 || expression.context[o].operation->leftToRight )
+			case O_BinaryAddition: result.i = wr_iadd_wrap( a->i, b.i ); return true;
+			case O_BinarySubtraction: result.i = wr_isub_wrap( a->i, b.i ); return true;
+			case O_BinaryMultiplication: result.i = wr_imul_wrap( a->i, b.i ); return true;
+			case O_BinaryDivision:
+			case O_BinaryMod:
 			{
-				continue;
+				if ( !b.i || (b.i == -1 && a->i == minInt) )
+				{
+					return false;
+				}
+				result.i = (opcode == O_BinaryDivision) ? (a->i / b.i) : (a->i % b.i);
+				return true;
 			}
-
-			resolves += resolveExpressionEx( expression, o, p );
-			if (m_err)
+			case O_BinaryOr: result.i = a->i | b.i; return true;
+			case O_BinaryAnd: result.i = a->i & b.i; return true;
+			case O_BinaryXOR: result.i = a->i ^ b.i; return true;
+			case O_BinaryRightShift:
+			case O_BinaryLeftShift:
 			{
-				return;
+				if ( (uint32_t)b.i > 31 )
+				{
+					return false;
+				}
+				result.i = (opcode == O_BinaryRightShift) ? (a->i >> b.i) : (int32_t)((uint32_t)a->i << b.i);
+				return true;
 			}
-			o = expression.context.count();
+			case O_CompareEQ: result.i = a->i == b.i; return true;
+			case O_CompareNE: result.i = a->i != b.i; return true;
+			case O_CompareGE: result.i = a->i >= b.i; return true;
+			case O_CompareLE: result.i = a->i <= b.i; return true;
+			case O_CompareGT: result.i = a->i > b.i; return true;
+			case O_CompareLT: result.i = a->i < b.i; return true;
+			case O_LogicalAnd: result.i = a->i && b.i; return true;
+			case O_LogicalOr: result.i = a->i || b.i; return true;
+			default: return false;
 		}
 	}
 
-	if ( startedWith && (resolves != startedWith) )
+	// otherwise the int side is promoted, as the VM does
+	const float f1 = (a->type == WR_INT) ? (float)a->i : a->f;
+	const float f2 = (b.type == WR_INT) ? (float)b.i : b.f;
+	result.p2 = INIT_AS_FLOAT;
+	switch( opcode )
 	{
-		m_err = WR_ERR_bad_expression;
-		return;
+		case O_BinaryAddition: result.f = f1 + f2; return true;
+		case O_BinarySubtraction: result.f = f1 - f2; return true;
+		case O_BinaryMultiplication: result.f = f1 * f2; return true;
+		case O_BinaryDivision:
+		{
+			if ( f2 == 0.f )
+			{
+				return false;
+			}
+			result.f = f1 / f2;
+			return true;
+		}
+		default: return false;
 	}
 }
 
 //------------------------------------------------------------------------------
-unsigned int WRCompilationContext::resolveExpressionEx( WRExpression& expression, int o, int p )
+static bool wr_isNumericLiteral( WRExpressionContext& context )
 {
-	unsigned int ret = 0;
-	switch( expression.context[o].operation->type )
+	return context.type == EXTYPE_LITERAL
+		   && context.stackPosition == -1
+		   && (context.value.type == WR_INT || context.value.type == WR_FLOAT);
+}
+
+//------------------------------------------------------------------------------
+bool WRCompilationContext::tracksLocals( WRExpression& expression )
+{
+	return m_optimize
+		   && m_unitTop != 0
+		   && !expression.bytecode.isStructSpace
+		   && !m_units[m_unitTop].bytecode.isStructSpace
+		   && !m_units[m_unitTop].parentUnitIndex;
+}
+
+//------------------------------------------------------------------------------
+// a local is constant if the first thing that happens to it is a
+// 'var' declaration that assigns it a literal, in code that runs
+// exactly once per call, and everything after that only reads it.
+//
+// It has a type if the first thing that happens to it settles one,
+// and every store after that keeps it. Every local starts out as the
+// int 0, so reading it first makes it an int; a float has to be
+// stored by a statement every call runs, with no goto ahead of it
+// that could skip it
+void WRCompilationContext::noteLocal( const uint32_t hash, WRLocalUse use, const WRValue* value, const int type )
+{
+	for( unsigned int h=0; h<m_hoisted.count(); ++h )
 	{
-		case WR_OPER_PRE:
+		if ( m_hoisted[h].hash == hash && m_hoisted[h].unit == m_unitTop )
 		{
-			ret = 1;
+			return; // only ever set by the code moved out of its loop
+		}
+	}
 
-			if ( expression.context[o + 1].stackPosition == -1 )
-			{
-				loadExpressionContext( expression, o + 1, 0 ); // load argument
-			}
-			else if ( expression.context[o + 1].stackPosition != 0 )
+	for( unsigned int l=0; use != LOCAL_READ && l<m_loops.count(); ++l )
+	{
+		unsigned int w = 0;
+		for( ; w<m_loopStores.count(); ++w )
+		{
+			if ( m_loopStores[w].hash == hash && m_loopStores[w].first == m_loops[l].first && m_loopStores[w].unit == m_unitTop )
 			{
-				expression.swapWithTop( expression.context[o + 1].stackPosition );
+				break;
 			}
-
-			appendBytecode( expression.bytecode, expression.context[o].bytecode );  // apply operator
-			expression.context.remove( o, 1 ); // knock off operator
-			expression.pushToStack(o);
-			break;
 		}
 
-		case WR_OPER_BINARY_COMMUTE:
+		if ( w >= m_loopStores.count() )
 		{
-			// for operations like + and * the operands can be in any
-			// order, so don't go to any great lengths to shift the stack
-			// around for them
+			LoopLocal& W = m_loopStores.append();
+			W.unit = m_unitTop;
+			W.first = m_loops[l].first;
+			W.hash = hash;
+		}
+	}
 
-			ret = 2;
+	LocalSpan& S = localSpan( hash );
+	if ( S.first == m_statement )
+	{
+		++S.notes;
+	}
 
-			if( o == 0 )
+	unsigned int l = 0;
+	for( ; l<m_localUses.count(); ++l )
+	{
+		if ( m_localUses[l].hash == hash && m_localUses[l].unit == m_unitTop )
+		{
+			if ( use != LOCAL_READ )
 			{
-				m_err = WR_ERR_bad_expression;
-				return 0;
+				m_localUses[l].constant = false;
 			}
 
-			int second = o + 1; // push first
-			int first = o - 1;  // push second
-			// so
-			// 1 - first
-			// [oper]
-			// 0 - second
-
-			if ( expression.context[second].stackPosition == -1 )
+			if ( use == LOCAL_OTHER || (use == LOCAL_STORE && type != m_localUses[l].type) )
 			{
-				if ( expression.context[first].stackPosition == -1 )
-				{
-					loadExpressionContext( expression, first, o ); 
-				}
-				else if ( expression.context[first].stackPosition != 0 )
-				{
-					// otherwise swap first to the top and load the second
-					expression.swapWithTop( expression.context[first].stackPosition );
-				}
-
-				loadExpressionContext( expression, second, o );
+				m_localUses[l].type = -1;
 			}
-			else if ( expression.context[first].stackPosition == -1 )
-			{
-				if ( expression.context[second].stackPosition != 0 )
-				{
-					expression.swapWithTop( expression.context[second].stackPosition );
-				}
-
-				// just load the second to top
+			return;
+		}
+	}
+
+	KnownLocal& L = m_localUses.append();
+	L.unit = m_unitTop;
+	L.hash = hash;
+	L.constant = value && (use == LOCAL_STORE) && m_straightLine;
+	if ( value )
+	{
+		L.value = *value;
+	}
+
+	if ( use == LOCAL_READ )
+	{
+		L.type = WR_INT;
+	}
+	else if ( use == LOCAL_STORE
+			  && (type == WR_INT
+				  || (type == WR_FLOAT && m_unconditional && !m_units[m_unitTop].bytecode.gotoSource.count())) )
+	{
+		L.type = type;
+	}
+}
+
+//------------------------------------------------------------------------------
+bool WRCompilationContext::knownLocal( WRstr const& token, WRValue& value )
+{
+	uint32_t hash = wr_hashStr( token );
+	for( unsigned int l=0; l<m_knownLocals.count(); ++l )
+	{
+		if ( m_knownLocals[l].hash == hash && m_knownLocals[l].unit == m_unitTop )
+		{
+			value = m_knownLocals[l].value;
+			return m_knownLocals[l].constant;
+		}
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// the span of a local of this unit, started at this statement if
+// nothing has named it yet
+LocalSpan& WRCompilationContext::localSpan( const uint32_t hash )
+{
+	for( unsigned int l=0; l<m_localSpans.count(); ++l )
+	{
+		if ( m_localSpans[l].hash == hash && m_localSpans[l].unit == m_unitTop )
+		{
+			return m_localSpans[l];
+		}
+	}
+
+	LocalSpan& S = m_localSpans.append();
+	S.unit = m_unitTop;
+	S.hash = hash;
+	S.first = m_statement;
+	S.last = m_statement;
+	S.block = m_block;
+	S.loads = 0;
+	S.notes = 0;
+	S.writes = 0;
+	S.scoped = true;
+	S.pinned = false;
+	return S;
+}
+
+//------------------------------------------------------------------------------
+// the local has just been noted as stored to with no regard for what
+// it held, which is the only way it can start a span part way through
+// a unit
+void WRCompilationContext::overwriteLocal( const uint32_t hash )
+{
+	LocalSpan& S = localSpan( hash );
+	if ( S.first == m_statement )
+	{
+		++S.writes;
+	}
+}
+
+//------------------------------------------------------------------------------
+// start a block inside the current one, returning the current one
+// for the caller to put back when it ends
+int WRCompilationContext::openBlock()
+{
+	const int block = m_block;
+	m_block = m_blockParents.count();
+	m_blockParents.append() = block;
+	return block;
+}
+
+//------------------------------------------------------------------------------
+void WRCompilationContext::addLoopSpan( const int first )
+{
+	if ( m_optimize )
+	{
+		LoopSpan& L = m_loopSpans.append();
+		L.unit = m_unitTop;
+		L.first = first;
+		L.last = m_statement;
+	}
+}
+
+//------------------------------------------------------------------------------
+// start a loop at statement 'first', with 'code' to collect what is
+// moved ahead of it. As many locals as the last pass found a use for
+// are set aside for it now, so every expression inside it already has
+// them in its space
+void WRCompilationContext::openLoop( const int first, WRBytecode& code )
+{
+	if ( !m_optimize )
+	{
+		return;
+	}
+
+	LoopHoist& L = m_loops.append();
+	L.first = first;
+	L.slots = 0;
+	L.base = m_hoistSlots;
+	L.used = 0;
+	L.hoists = 0;
+	L.entry = -1;
+	L.code = &code;
+
+	for( unsigned int f=0; m_hoistLoops && !m_guessTypes && f<m_lastLoopFacts.count(); ++f )
+	{
+		if ( m_lastLoopFacts[f].unit == m_unitTop && m_lastLoopFacts[f].first == first )
+		{
+			L.slots = m_lastLoopFacts[f].hoists;
+			break;
+		}
+	}
+
+	for( int s=0; s<L.slots; ++s )
+	{
+		WRstr token;
+		token.format( "@hoist:%d", m_hoistSlots++ );
+		addLocalSpaceLoad( m_units[m_unitTop].bytecode, token, true, true );
+	}
+}
+
+//------------------------------------------------------------------------------
+// the loop opened last is about to test its condition for the first
+// time, anything moved out of it has to be run first
+void WRCompilationContext::enterLoop()
+{
+	if ( m_optimize && m_loops.tail()->slots )
+	{
+		m_loops.tail()->entry = addRelativeJumpTarget( m_units[m_unitTop].bytecode );
+		addRelativeJumpSource( m_units[m_unitTop].bytecode, O_RelativeJump, m_loops.tail()->entry );
+	}
+}
+
+//------------------------------------------------------------------------------
+// the loop opened last has just emitted the jump back to its top; what
+// was moved out of it goes after that, and jumps to 'back' when done
+void WRCompilationContext::closeLoop( const int back )
+{
+	if ( !m_optimize )
+	{
+		return;
+	}
+
+	LoopHoist& L = *m_loops.tail();
+	WRBytecode& bytecode = m_units[m_unitTop].bytecode;
+	if ( L.entry != -1 )
+	{
+		setRelativeJumpTarget( bytecode, L.entry );
+		bytecode.invalidateOpcodeCache();
+		appendBytecode( bytecode, *L.code );
+		addRelativeJumpSource( bytecode, O_RelativeJump, back );
+	}
+
+	LoopFacts& F = m_loopFacts.append();
+	F.unit = m_unitTop;
+	F.first = L.first;
+	F.slots = L.slots;
+	F.hoists = L.hoists;
+
+	m_loops.pop();
+}
+
+//------------------------------------------------------------------------------
+// the type a local of this unit is taken to hold: while guessing,
+// whatever it has held so far (so one nothing has touched yet is
+// still the int 0), otherwise whatever the last pass settled on
+int WRCompilationContext::localType( const uint32_t hash )
+{
+	for( unsigned int h=0; h<m_hoisted.count(); ++h )
+	{
+		if ( m_hoisted[h].hash == hash && m_hoisted[h].unit == m_unitTop )
+		{
+			return m_hoisted[h].type;
+		}
+	}
+
+	WRarray<KnownLocal>& locals = m_guessTypes ? m_localUses : m_knownLocals;
+	for( unsigned int l=0; l<locals.count(); ++l )
+	{
+		if ( locals[l].hash == hash && locals[l].unit == m_unitTop )
+		{
+			return locals[l].type;
+		}
+	}
+
+	return m_guessTypes ? WR_INT : -1;
+}
+
+//------------------------------------------------------------------------------
+// WR_INT or WR_FLOAT if that is all context 'index' can be, otherwise -1
+int WRCompilationContext::contextType( WRExpression& expression, const int index )
+{
+	if ( index < 0 || index >= (int)expression.context.count() )
+	{
+		return -1;
+	}
+
+	WRExpressionContext& context = expression.context[index];
+	if ( context.stackPosition != -1 || context.type == EXTYPE_BYTECODE_RESULT )
+	{
+		return context.resultType;
+	}
+	else if ( context.type == EXTYPE_LITERAL )
+	{
+		return (context.value.type == WR_INT || context.value.type == WR_FLOAT) ? context.value.type : -1;
+	}
+	else if ( context.type == EXTYPE_LABEL && !context.global && tracksLocals(expression) )
+	{
+		// a name this unit has not given a slot yet could still turn
+		// out to be a global
+		const uint32_t hash = wr_hashStr( context.token );
+		for( unsigned int i=0; i<expression.bytecode.localSpace.count(); ++i )
+		{
+			if ( expression.bytecode.localSpace[i].hash == hash )
+			{
+				return localType( hash );
+			}
+		}
+	}
+
+	return -1;
+}
+
+//------------------------------------------------------------------------------
+static int wr_arithmeticType( const int left, const int right )
+{
+	if ( left == WR_INT && right == WR_INT )
+	{
+		return WR_INT;
+	}
+
+	return ((left == WR_INT || left == WR_FLOAT) && (right == WR_INT || right == WR_FLOAT)) ? WR_FLOAT : -1;
+}
+
+//------------------------------------------------------------------------------
+// the type operation 'o' leaves behind, as far as its operands say
+int WRCompilationContext::operationType( WRExpression& expression, const int o )
+{
+	const WROperation* operation = expression.context[o].operation;
+	const int left = (operation->type == WR_OPER_PRE) ? -1 : contextType( expression, o - 1 );
+	const int right = (operation->type == WR_OPER_POST) ? -1 : contextType( expression, o + 1 );
+
+	switch( operation->opcode )
+	{
+		case O_CompareEQ:
+		case O_CompareNE:
+		case O_CompareGE:
+		case O_CompareLE:
+		case O_CompareGT:
+		case O_CompareLT:
+		case O_LogicalAnd:
+		case O_LogicalOr:
+		case O_LogicalNot:
+		case O_ToInt:
+			return WR_INT;
+
+		case O_ToFloat:
+			return WR_FLOAT;
+
+		case O_CountOf:
+			return WR_INT;
+
+		case O_Negate:
+		case O_PreIncrement:
+		case O_PreDecrement:
+			return right;
+
+		case O_PostIncrement:
+		case O_PostDecrement:
+			return left;
+
+		case O_BitwiseNOT:
+			return (right == WR_INT) ? WR_INT : -1;
+
+		case O_Assign:
+			return right;
+
+		case O_BinaryAddition:
+		case O_BinarySubtraction:
+		case O_BinaryMultiplication:
+		case O_BinaryDivision:
+		case O_AddAssign:
+		case O_SubtractAssign:
+		case O_MultiplyAssign:
+		case O_DivideAssign:
+			return wr_arithmeticType( left, right );
+
+		case O_BinaryMod:
+		case O_BinaryOr:
+		case O_BinaryAnd:
+		case O_BinaryXOR:
+		case O_BinaryRightShift:
+		case O_BinaryLeftShift:
+		case O_ModAssign:
+		case O_ORAssign:
+		case O_ANDAssign:
+		case O_XORAssign:
+		case O_RightShiftAssign:
+		case O_LeftShiftAssign:
+			return (left == WR_INT && right == WR_INT) ? WR_INT : -1;
+
+		default:
+			return -1;
+	}
+}
+
+//------------------------------------------------------------------------------
+static bool wr_isTrackedLocal( WRExpressionContext& context, const bool track )
+{
+	return track
+		   && context.type == EXTYPE_LABEL
+		   && context.stackPosition == -1
+		   && !context.global;
+}
+
+//------------------------------------------------------------------------------
+// WR_OPTIMIZE looks at operation 'o' before it is resolved, noting
+// what it does to any locals and swapping in the value of any known
+// to be constant. When that leaves nothing but literals the work is
+// done here and the result left as a literal; returns how many
+// contexts that resolved, or 0 if the operation still needs code
+unsigned int WRCompilationContext::optimizeOperation( WRExpression& expression, int o )
+{
+	const WROperation* operation = expression.context[o].operation;
+	const int count = expression.context.count();
+
+	int a = o - 1; // left operand
+	int b = o + 1; // right operand
+	if ( operation->type == WR_OPER_PRE )
+	{
+		a = -1;
+	}
+	else if ( operation->type == WR_OPER_POST )
+	{
+		b = -1;
+	}
+
+	if ( (b != -1 && b >= count) || (operation->type != WR_OPER_PRE && a < 0) )
+	{
+		return 0; // let the usual path report it
+	}
+
+	const bool pure = wr_isPureOperation( operation->opcode );
+	const bool assign = operation->opcode == O_Assign;
+	const bool compound = operation->opcode == O_AddAssign
+						  || operation->opcode == O_SubtractAssign
+						  || operation->opcode == O_MultiplyAssign
+						  || operation->opcode == O_DivideAssign
+						  || operation->opcode == O_ModAssign
+						  || operation->opcode == O_ORAssign
+						  || operation->opcode == O_ANDAssign
+						  || operation->opcode == O_XORAssign
+						  || operation->opcode == O_RightShiftAssign
+						  || operation->opcode == O_LeftShiftAssign;
+	const bool step = operation->opcode == O_PreIncrement
+					  || operation->opcode == O_PreDecrement
+					  || operation->opcode == O_PostIncrement
+					  || operation->opcode == O_PostDecrement;
+	const bool track = tracksLocals( expression );
+	WRValue value;
+
+	m_localsNoted = pure || assign || compound || step;
+
+	if ( !m_localsNoted )
+	{
+		return 0;
+	}
+
+	// a store leaves a reference to what it stored on the stack, so
+	// it only counts as one if nothing can hold on to that
+	const WRLocalUse store = expression.valueOnly ? LOCAL_STORE : LOCAL_OTHER;
+
+	if ( step )
+	{
+		const int operand = (a == -1) ? b : a;
+		if ( wr_isTrackedLocal(expression.context[operand], track) )
+		{
+			noteLocal( wr_hashStr(expression.context[operand].token), store, 0, contextType(expression, operand) );
+		}
+		return 0;
+	}
+
+	// a compare between two different types converts the local it
+	// was handed in place, so it only reads one when the other side is
+	// known to be the same type
+	const bool compare = operation->opcode == O_CompareEQ
+						 || operation->opcode == O_CompareNE
+						 || operation->opcode == O_CompareGE
+						 || operation->opcode == O_CompareLE
+						 || operation->opcode == O_CompareGT
+						 || operation->opcode == O_CompareLT;
+
+	// an assignment only reads what it assigns
+	const int reads[2] = { pure ? a : -1, compound ? -1 : b };
+	for( int r=0; r<2; ++r )
+	{
+		if ( reads[r] == -1 )
+		{
+			continue;
+		}
+
+		WRExpressionContext& context = expression.context[reads[r]];
+		if ( wr_isTrackedLocal(context, track) )
+		{
+			const int type = compare ? contextType( expression, reads[r] ) : -1;
+			noteLocal( wr_hashStr(context.token),
+					   (!compare || (type != -1 && type == contextType(expression, r ? a : b))) ? LOCAL_READ : LOCAL_OTHER );
+
+			if ( knownLocal(context.token, value) )
+			{
+				context.type = EXTYPE_LITERAL;
+				context.value = value;
+			}
+		}
+	}
+
+	if ( compound )
+	{
+		WRExpressionContext& target = expression.context[a];
+		WRExpressionContext& source = expression.context[b];
+		const bool local = wr_isTrackedLocal( target, track );
+		const int type = local ? operationType( expression, o ) : -1;
+
+		if ( wr_isTrackedLocal(source, track) )
+		{
+			// when the two sides differ the compound forms convert
+			// what they were handed in place, so the source is only
+			// read if it matches the local it is applied to
+			const int sourceType = contextType( expression, b );
+			noteLocal( wr_hashStr(source.token),
+					   (local && sourceType != -1 && sourceType == contextType(expression, a)) ? LOCAL_READ : LOCAL_OTHER );
+
+			if ( knownLocal(source.token, value) )
+			{
+				source.type = EXTYPE_LITERAL;
+				source.value = value;
+			}
+		}
+
+		if ( local )
+		{
+			noteLocal( wr_hashStr(target.token), store, 0, type );
+		}
+		return 0;
+	}
+
+	if ( assign )
+	{
+		WRExpressionContext& target = expression.context[a];
+		if ( !wr_isTrackedLocal(target, track) )
+		{
+			return 0;
+		}
+
+		// the store itself stays even once every read has been
+		// replaced: any function can be instanced with 'new', and
+		// then its locals are the members
+		const bool literal = store == LOCAL_STORE && target.varSeen && wr_isNumericLiteral( expression.context[b] );
+		noteLocal( wr_hashStr(target.token), store, literal ? &expression.context[b].value : 0, contextType(expression, b) );
+		overwriteLocal( wr_hashStr(target.token) );
+		return 0;
+	}
+
+	if ( a == -1 )
+	{
+		if ( wr_isNumericLiteral(expression.context[b])
+			 && wr_foldOperation(operation->opcode, 0, expression.context[b].value, value) )
+		{
+			expression.context[b].value = value;
+			expression.context.remove( o, 1 );
+			m_localsNoted = false;
+			return 1;
+		}
+	}
+	else if ( wr_isNumericLiteral(expression.context[a])
+			  && wr_isNumericLiteral(expression.context[b])
+			  && wr_foldOperation(operation->opcode, &expression.context[a].value, expression.context[b].value, value) )
+	{
+		expression.context[a].value = value;
+		expression.context.remove( o, 2 );
+		m_localsNoted = false;
+		return 2;
+	}
+
+	return hoistOperation( expression, o );
+}
+
+//------------------------------------------------------------------------------
+// an operation on nothing but numbers, in a loop that never stores to
+// the locals it reads, gives the same answer every time around. Work
+// it out once into a local set aside in the outermost loop that
+// allows it, before that loop starts, and read that instead. Returns
+// how many contexts that resolved, like optimizeOperation()
+unsigned int WRCompilationContext::hoistOperation( WRExpression& expression, const int o )
+{
+	if ( m_hoisting || m_guessTypes || !m_hoistLoops || !m_loops.count() || !tracksLocals(expression) )
+	{
+		return 0;
+	}
+
+	// division and shifts have rules for what they are handed that
+	// could trip on a path that never ran them
+	switch( expression.context[o].operation->opcode )
+	{
+		case O_BinaryAddition:
+		case O_BinarySubtraction:
+		case O_BinaryMultiplication:
+		case O_BinaryOr:
+		case O_BinaryAnd:
+		case O_BinaryXOR:
+			break;
+
+		default:
+			return 0;
+	}
+
+	const int type = operationType( expression, o );
+	if ( type == -1 )
+	{
+		return 0;
+	}
+
+	WRarray<WRNamespaceLookup>& space = m_units[m_unitTop].bytecode.localSpace;
+	int loop = 0;
+	int labels = 0;
+	uint32_t reads[2];
+	for( int side=-1; side<=1; side += 2 )
+	{
+		WRExpressionContext& context = expression.context[o + side];
+		if ( wr_isNumericLiteral(context) )
+		{
+			continue;
+		}
+
+		if ( !wr_isTrackedLocal(context, true) || contextType(expression, o + side) == -1 )
+		{
+			return 0;
+		}
+
+		const uint32_t hash = wr_hashStr( context.token );
+		unsigned int i = 0;
+		for( ; i<space.count() && space[i].hash != hash; ++i );
+		if ( i >= space.count() )
+		{
+			return 0;
+		}
+
+		// one moved already can only be read once its own loop has set it
+		for( unsigned int h=0; h<m_hoisted.count(); ++h )
+		{
+			if ( m_hoisted[h].hash == hash && m_hoisted[h].unit == m_unitTop && m_hoisted[h].loop > loop )
+			{
+				loop = m_hoisted[h].loop;
+			}
+		}
+
+		// and not past the innermost loop that stores to it
+		for( int l=m_loops.count() - 1; l >= loop; --l )
+		{
+			unsigned int w = 0;
+			for( ; w<m_lastLoopStores.count(); ++w )
+			{
+				if ( m_lastLoopStores[w].hash == hash && m_lastLoopStores[w].first == m_loops[l].first && m_lastLoopStores[w].unit == m_unitTop )
+				{
+					break;
+				}
+			}
+
+			if ( w < m_lastLoopStores.count() )
+			{
+				loop = l + 1;
+				break;
+			}
+		}
+
+		reads[labels++] = hash;
+	}
+
+	if ( !labels || loop >= (int)m_loops.count() )
+	{
+		return 0;
+	}
+
+	++m_loops[loop].hoists;
+	if ( m_loops[loop].used >= m_loops[loop].slots )
+	{
+		return 0; // the next pass will have room for it
+	}
+
+	WRstr token;
+	token.format( "@hoist:%d", m_loops[loop].base + m_loops[loop].used++ );
+	const uint32_t hash = wr_hashStr( token );
+
+	HoistedLocal& H = m_hoisted.append();
+	H.unit = m_unitTop;
+	H.hash = hash;
+	H.type = type;
+	H.loop = loop;
+
+	for( int r=0; r<labels; ++r )
+	{
+		LoopLocal& R = m_loopReads.append();
+		R.unit = m_unitTop;
+		R.first = m_loops[loop].first;
+		R.hash = reads[r];
+	}
+
+	// <hoist> = <a> <op> <b>;
+	WRExpression hoist( space, false );
+	hoist.valueOnly = true;
+	hoist.context[0].type = EXTYPE_LABEL;
+	hoist.context[0].token = token;
+	hoist.context[0].varSeen = true;
+	operatorFound( "=", hoist.context, 1 );
+	hoist.context[2] = expression.context[o - 1];
+	hoist.context[3] = expression.context[o];
+	hoist.context[4] = expression.context[o + 1];
+
+	m_hoisting = true;
+	resolveExpression( hoist );
+	pushOpcode( hoist.bytecode, O_PopOne );
+	m_hoisting = false;
+
+	appendBytecode( *m_loops[loop].code, hoist.bytecode );
+	localSpan( hash ).pinned = true;
+
+	WRExpressionContext& result = expression.context[o - 1];
+	result.reset();
+	result.type = EXTYPE_LABEL;
+	result.token = token;
+	result.varSeen = true;
+	expression.context.remove( o, 2 );
+	m_localsNoted = false;
+	return 2;
+}
+
+//------------------------------------------------------------------------------
+// the type the last pass proved local 'slot' of this unit holds, or -1
+int WRCompilationContext::slotType( WRBytecode& bytecode, const int slot )
+{
+	if ( !m_optimize || m_guessTypes || slot >= (int)bytecode.localSpace.count() )
+	{
+		return -1;
+	}
+
+	return localType( bytecode.localSpace[slot].hash );
+}
+
+//------------------------------------------------------------------------------
+// 'offset' is where addRelativeJumpSource() is about to point the jump
+// that was just fused onto the end of 'bytecode'. When that compares
+// two int locals, or an int local with a small literal, swap in the
+// wide form that skips the type dispatch, and return where its jump
+// vector goes instead
+int WRCompilationContext::typedCompare( WRBytecode& bytecode, const int offset )
+{
+	const int size = bytecode.all.size();
+	const int cached = bytecode.opcodes.size();
+	if ( offset < 1 || cached < 1 )
+	{
+		return offset;
+	}
+
+	const unsigned char op = bytecode.all[offset - 1];
+
+	if ( op >= O_LLCompareLTBZ && op <= O_LLCompareNEBZ && offset == size - 2 )
+	{
+		if ( slotType(bytecode, bytecode.all[size - 2]) != WR_INT
+			 || slotType(bytecode, bytecode.all[size - 1]) != WR_INT )
+		{
+			return offset;
+		}
+
+		// [op][l][l] -> [O_Wide][sub][l][l]
+		bytecode.all += bytecode.all[size - 1];
+		bytecode.all[size - 1] = bytecode.all[size - 2];
+		bytecode.all[size - 2] = W_IntLLCompareLTBZ + (op - O_LLCompareLTBZ);
+		bytecode.all[size - 3] = O_Wide;
+		bytecode.opcodes[cached - 1] = O_Wide;
+		return offset;
+	}
+
+	// 'i < a._count' can not keep the count from one time to the next,
+	// anything that indexes 'a' can grow it, but it can skip loading
+	// it onto the stack to be compared
+	if ( op == O_CompareBLT
+		 && offset == size
+		 && size >= 6
+		 && cached >= 4
+		 && bytecode.opcodes[cached - 4] == O_LoadFromLocal
+		 && bytecode.opcodes[cached - 3] == O_CountOf
+		 && bytecode.opcodes[cached - 2] == O_LoadFromLocal
+		 && bytecode.all[size - 6] == O_LoadFromLocal
+		 && bytecode.all[size - 4] == O_CountOf
+		 && bytecode.all[size - 3] == O_LoadFromLocal
+		 && slotType(bytecode, bytecode.all[size - 2]) == WR_INT )
+	{
+		// [load a][count][load i][op] -> [O_Wide][sub][i][a]
+		const unsigned char array = bytecode.all[size - 5];
+		const unsigned char index = bytecode.all[size - 2];
+		bytecode.all.shave( 6 );
+		bytecode.all += O_Wide;
+		bytecode.all += (unsigned char)W_IntLCountLTBZ;
+		bytecode.all += index;
+		bytecode.all += array;
+
+		bytecode.opcodes.shave( 4 );
+		bytecode.opcodes += O_Wide;
+		return size - 5;
+	}
+
+	int sub;
+	switch( op )
+	{
+		case O_LSCompareLTBZ: sub = W_IntLICompareLTBZ; break;
+		case O_LSCompareLEBZ: sub = W_IntLICompareLEBZ; break;
+		case O_LSCompareGTBZ: sub = W_IntLICompareGTBZ; break;
+		case O_LSCompareGEBZ: sub = W_IntLICompareGEBZ; break;
+		case O_LSCompareEQBZ: sub = W_IntLICompareEQBZ; break;
+		case O_LSCompareNEBZ: sub = W_IntLICompareNEBZ; break;
+		default: return offset;
+	}
+
+	if ( offset != size - 1 || cached < 2 )
+	{
+		return offset;
+	}
+
+	// the literal the compare pops sits right in front of it
+	const unsigned char literal = bytecode.opcodes[cached - 2];
+	int16_t value;
+	int start;
+	if ( literal == O_LiteralZero )
+	{
+		start = size - 3;
+		value = 0;
+	}
+	else if ( literal == O_LiteralInt8 )
+	{
+		start = size - 4;
+		value = (int8_t)bytecode.all[size - 3];
+	}
+	else if ( literal == O_LiteralInt16 )
+	{
+		start = size - 5;
+		value = READ_16_FROM_PC( bytecode.all.p_str(size - 4) );
+	}
+	else
+	{
+		return offset;
+	}
+
+	const unsigned char slot = bytecode.all[size - 1];
+	if ( start < 0
+		 || bytecode.all[start] != literal
+		 || slotType(bytecode, slot) != WR_INT )
+	{
+		return offset;
+	}
+
+	// [literal][op][l] -> [O_Wide][sub][l][imm16]
+	unsigned char data[2];
+	bytecode.all.shave( size - start );
+	bytecode.all += O_Wide;
+	bytecode.all += (unsigned char)sub;
+	bytecode.all += slot;
+	pushData( bytecode, wr_pack16(value, data), 2 );
+
+	bytecode.opcodes.shave( 2 );
+	bytecode.opcodes += O_Wide;
+	return start + 1;
+}
+
+//------------------------------------------------------------------------------
+// the operation resolved since 'mark' fused into one LL arithmetic
+// instruction; when both locals are the same known type swap in the
+// wide form for it
+void WRCompilationContext::typedOperation( WRBytecode& bytecode, const unsigned int mark )
+{
+	if ( bytecode.all.size() != mark + 3 )
+	{
+		return;
+	}
+
+	const int type = slotType( bytecode, bytecode.all[mark + 1] );
+	if ( type == -1 || type != slotType(bytecode, bytecode.all[mark + 2]) )
+	{
+		return;
+	}
+
+	int sub = -1;
+	switch( bytecode.all[mark] )
+	{
+		case O_LLBinaryAddition: sub = (type == WR_INT) ? W_IntLLAddition : W_FloatLLAddition; break;
+		case O_LLBinarySubtraction: sub = (type == WR_INT) ? W_IntLLSubtraction : W_FloatLLSubtraction; break;
+		case O_LLBinaryMultiplication: sub = (type == WR_INT) ? W_IntLLMultiplication : W_FloatLLMultiplication; break;
+		case O_LLBinaryDivision: sub = (type == WR_FLOAT) ? W_FloatLLDivision : -1; break; // int division has its own rules for 0
+		default: break;
+	}
+
+	if ( sub == -1 )
+	{
+		return;
+	}
+
+	// [op][l][l] -> [O_Wide][sub][l][l]
+	bytecode.all += bytecode.all[mark + 2];
+	bytecode.all[mark + 2] = bytecode.all[mark + 1];
+	bytecode.all[mark + 1] = (unsigned char)sub;
+	bytecode.all[mark] = O_Wide;
+	bytecode.invalidateOpcodeCache();
+}
+
+//------------------------------------------------------------------------------
+void WRCompilationContext::resolveExpression( WRExpression& expression )
+{
+	if ( expression.context.count() == 1 ) // single expression is trivial to resolve, load it!
+	{
+		loadExpressionContext( expression, 0, 0 );
+		return;
+	}
+
+	unsigned int resolves = 1;
+	unsigned int startedWith = expression.context.count();
+
+	for( int p=0; p<c_highestPrecedence && expression.context.count() > 1; ++p )
+	{
+		// left to right operations
+		for( int o=0; (unsigned int)o < expression.context.count(); ++o )
+		{
+			if ( (expression.context[o].type != EXTYPE_OPERATION)
+				 || expression.context[o].operation->precedence > p
+				 || !expression.context[o].operation->leftToRight )
+			{
+				continue;
+			}
+
+			resolves += resolveExpressionEx( expression, o, p );
+			if (m_err)
+			{
+				return;
+			}
+			o = (unsigned int)-1;
+		}
+
+		// right to left operations
+		for( int o = expression.context.count() - 1; o >= 0; --o )
+		{
+			if ( (expression.context[o].type != EXTYPE_OPERATION)
+				 || expression.context[o].operation->precedence > p
+				 || expression.context[o].operation->leftToRight )
+			{
+				continue;
+			}
+
+			resolves += resolveExpressionEx( expression, o, p );
+			if (m_err)
+			{
+				return;
+			}
+			o = expression.context.count();
+		}
+	}
+
+	if ( startedWith && (resolves != startedWith) )
+	{
+		m_err = WR_ERR_bad_expression;
+		return;
+	}
+
+	if ( expression.context.count() == 1 && expression.context[0].stackPosition == -1 )
+	{
+		loadExpressionContext( expression, 0, 0 ); // everything folded into one literal
+	}
+}
+
+//------------------------------------------------------------------------------
+unsigned int WRCompilationContext::resolveExpressionEx( WRExpression& expression, int o, int p )
+{
+	int type = -1;
+	unsigned int mark = 0;
+	bool locals = false;
+	if ( m_optimize )
+	{
+		unsigned int resolved = optimizeOperation( expression, o );
+		if ( resolved )
+		{
+			return resolved;
+		}
+
+		type = operationType( expression, o );
+		mark = expression.bytecode.all.size();
+		locals = expression.context[o].operation->type != WR_OPER_PRE
+				 && expression.context[o].operation->type != WR_OPER_POST
+				 && wr_isTrackedLocal( expression.context[o - 1], tracksLocals(expression) )
+				 && wr_isTrackedLocal( expression.context[o + 1], tracksLocals(expression) );
+	}
+
+	const WROpcode opcode = expression.context[o].operation->opcode;
+	const int result = (expression.context[o].operation->type == WR_OPER_PRE) ? o : o - 1; // where what it leaves ends up
+	unsigned int ret = 0;
+	switch( expression.context[o].operation->type )
+	{
+		case WR_OPER_PRE:
+		{
+			ret = 1;
+
+			if ( expression.context[o + 1].stackPosition == -1 )
+			{
+				loadExpressionContext( expression, o + 1, 0 ); // load argument
+			}
+			else if ( expression.context[o + 1].stackPosition != 0 )
+			{
+				expression.swapWithTop( expression.context[o + 1].stackPosition );
+			}
+
+			appendBytecode( expression.bytecode, expression.context[o].bytecode );  // apply operator
+			expression.context.remove( o, 1 ); // knock off operator
+			expression.pushToStack(o);
+			break;
+		}
+
+		case WR_OPER_BINARY_COMMUTE:
+		{
+			// for operations like + and * the operands can be in any
+			// order, so don't go to any great lengths to shift the stack
+			// around for them
+
+			ret = 2;
+
+			if( o == 0 )
+			{
+				m_err = WR_ERR_bad_expression;
+				return 0;
+			}
+
+			int second = o + 1; // push first
+			int first = o - 1;  // push second
+			// so
+			// 1 - first
+			// [oper]
+			// 0 - second
+
+			if ( expression.context[second].stackPosition == -1 )
+			{
+				if ( expression.context[first].stackPosition == -1 )
+				{
+					loadExpressionContext( expression, first, o ); 
+				}
+				else if ( expression.context[first].stackPosition != 0 )
+				{
+					// otherwise swap first to the top and load the second
+					expression.swapWithTop( expression.context[first].stackPosition );
+				}
+
+				loadExpressionContext( expression, second, o );
+			}
+			else if ( expression.context[first].stackPosition == -1 )
+			{
+				if ( expression.context[second].stackPosition != 0 )
+				{
+					expression.swapWithTop( expression.context[second].stackPosition );
+				}
+
+				// just load the second to top
+				loadExpressionContext( expression, first, o );
+			}
+			else if ( expression.context[second].stackPosition == 1 )
+			{
+				expression.swapWithTop( expression.context[first].stackPosition );
+			}
+			else if ( expression.context[first].stackPosition == 1 )
+			{
+				expression.swapWithTop( expression.context[second].stackPosition );
+			}
+			else
+			{
+				// first and second are both loaded but neither
+				// is in the correct position
+
+				expression.swapTwoToTop( first, second );
+			}
+
+			appendBytecode( expression.bytecode, expression.context[o].bytecode ); // apply operator
+
+			expression.context.remove( o - 1, 2 ); // knock off operator and arg
+			expression.pushToStack(o - 1);
+
+			break;
+		}
+
+		case WR_OPER_BINARY:
+		{
+			ret = 2;
+
+			if( o == 0 )
+			{
+				m_err = WR_ERR_bad_expression;
+				return 0;
+			}
+
+			int second = o + 1; // push first
+			int first = o - 1;  // push second
+			bool useAlt = false;
+			// so
+			// 1 - first
+			// [oper]
+			// 0 - second
+
+			if ( expression.context[second].stackPosition == -1 )
+			{
+				if ( expression.context[first].stackPosition == -1 )
+				{
+					loadExpressionContext( expression, second, o ); // nope, grab 'em
+					loadExpressionContext( expression, first, o ); 
+				}
+				else
+				{
+					// first is in the stack somewhere, we need
+					// to swap it to the top, then load, then
+					// swap top values
+					expression.swapWithTop( expression.context[first].stackPosition );
+
+					loadExpressionContext( expression, second, o );
+
+					if ( expression.context[o].operation->alt == O_LAST )
+					{
+						expression.swapWithTop( 1 );
+					}
+					else // otherwise top shuffle is NOT required because we have an equal-but-opposite operation
+					{
+						useAlt = true;
+					}
+				}
+			}
+			else if ( expression.context[first].stackPosition == -1 )
+			{
+				// perfect, swap up the second, then load the
+				// first
+
+				expression.swapWithTop( expression.context[second].stackPosition );
+
 				loadExpressionContext( expression, first, o );
 			}
-			else if ( expression.context[second].stackPosition == 1 )
+			else if ( expression.context[second].stackPosition == 1 )
+			{
+				// second is already where its supposed to be,
+				// swap first to top if it's not there already
+				if ( expression.context[first].stackPosition != 0 )
+				{
+					expression.swapWithTop( expression.context[first].stackPosition );
+				}
+			}
+			else if ( expression.context[second].stackPosition == 0 )
+			{
+				// second is on top of the stack, swap with
+				// next level down then swap first up
+
+
+				if ( expression.context[first].stackPosition == 1 )
+				{
+					// lucky! a simple single-swap will put them in the
+					// right order (turns out this is common)
+					expression.swapWithTop( 1 );
+				}
+				else
+				{
+					// can still do it in one opcode
+					
+					expression.swapTwoToTop( first, second );
+				}
+			}
+			else
+			{
+				// first and second are both loaded but neither is in the correct position
+
+				expression.swapTwoToTop( first, second );
+			}
+
+			if ( useAlt )
+			{
+				pushOpcode( expression.bytecode, expression.context[o].operation->alt );
+			}
+			else
+			{
+				appendBytecode( expression.bytecode, expression.context[o].bytecode ); // apply operator
+			}
+
+			expression.context.remove( o - 1, 2 ); // knock off operator and arg
+			expression.pushToStack(o - 1);
+
+			break;
+		}
+
+		case WR_OPER_POST:
+		{
+			ret = 1;
+
+			if( o == 0 )
+			{
+				m_err = WR_ERR_bad_expression;
+				return 0;
+			}
+
+			if ( expression.context[o - 1].stackPosition == -1 )
+			{
+				loadExpressionContext( expression, o - 1, o ); // load argument
+			}
+			else if ( expression.context[o - 1].stackPosition != 0 )
+			{
+				expression.swapWithTop( expression.context[o - 1].stackPosition );
+			}
+
+			appendBytecode( expression.bytecode, expression.context[o].bytecode );
+			expression.context.remove( o, 1 ); // knock off operator
+			expression.pushToStack( o - 1 );
+
+			break;
+		}
+	}
+	
+	m_localsNoted = false;
+
+	if ( m_optimize && ret )
+	{
+		expression.context[result].resultType = type;
+
+		if ( locals
+			 && (opcode == O_BinaryAddition
+				 || opcode == O_BinarySubtraction
+				 || opcode == O_BinaryMultiplication
+				 || opcode == O_BinaryDivision) )
+		{
+			typedOperation( expression.bytecode, mark );
+		}
+	}
+
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+bool WRCompilationContext::operatorFound( WRstr const& token, WRarray<WRExpressionContext>& context, int depth )
+{
+	for( int i=0; c_operations[i].token; i++ )
+	{
+		if ( token == c_operations[i].token )
+		{
+			if ( c_operations[i].type == WR_OPER_PRE
+				 && depth > 0
+				 && (context[depth-1].type != EXTYPE_OPERATION 
+					 || (context[depth - 1].type == EXTYPE_OPERATION &&
+						 (context[depth - 1].operation->type != WR_OPER_BINARY && context[depth - 1].operation->type != WR_OPER_BINARY_COMMUTE))) )
+			{
+				continue;
+			}
+			
+			context[depth].operation = c_operations + i;
+			context[depth].type = EXTYPE_OPERATION;
+
+			pushOpcode( context[depth].bytecode, c_operations[i].opcode );
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool WRCompilationContext::parseCallFunction( WRExpression& expression, WRstr functionName, int depth, bool parseArguments, bool construct )
+{
+	WRstr prefix = expression.context[depth].prefix;
+
+	expression.context[depth].type = EXTYPE_BYTECODE_RESULT;
+	
+	unsigned char argsPushed = 0;
+	bool argsAreLocals = true;
+	bool argsAreLiterals = true;
+	WRValue literalArgs[2];
+	literalArgs[0].init();
+	literalArgs[1].init();
+
+	if ( parseArguments )
+	{
+		WRstr& token2 = expression.context[depth].token;
+		WRValue& value2 = expression.context[depth].value;
+
+		for(;;)
+		{
+			if ( !getToken(expression.context[depth]) )
+			{
+				m_err = WR_ERR_unexpected_EOF;
+				return 0;
+			}
+
+			if ( !m_quoted && token2 == ")" )
 			{
-				expression.swapWithTop( expression.context[first].stackPosition );
+				break;
 			}
-			else if ( expression.context[first].stackPosition == 1 )
+
+			++argsPushed;
+
+				WRExpression nex( expression.bytecode.localSpace, expression.bytecode.isStructSpace );
+				nex.allowFunctionNameHashLiteral = true;
+				nex.context[0].token = token2;
+				nex.context[0].value = value2;
+			m_loadedToken = token2;
+			m_loadedValue = value2;
+			m_loadedQuoted = m_quoted;
+			
+			char end = parseExpression( nex );
+
+			if ( nex.bytecode.opcodes.size() > 0 )
 			{
-				expression.swapWithTop( expression.context[second].stackPosition );
+				uint8_t op = nex.bytecode.opcodes[nex.bytecode.opcodes.size() - 1];
+				if ( op == O_Index
+					 || op == O_IndexSkipLoad
+					 || op == O_IndexLiteral8
+					 || op == O_IndexLiteral16
+					 || op == O_IndexLocalLiteral8
+					 || op == O_IndexGlobalLiteral8
+					 || op == O_IndexLocalLiteral16
+					 || op == O_IndexGlobalLiteral16
+					 || (op == O_Wide
+						 && nex.bytecode.all.size() >= 4
+						 && nex.bytecode.all[nex.bytecode.all.size() - 4] == O_Wide
+						 && nex.bytecode.all[nex.bytecode.all.size() - 3] == W_LLIndex) )
+				{
+					nex.bytecode.opcodes += O_Dereference;
+					nex.bytecode.all += O_Dereference;
+				}
 			}
-			else
+			
+			argsAreLocals = argsAreLocals
+							&& nex.bytecode.all.size() == 2
+							&& nex.bytecode.all[0] == O_LoadFromLocal;
+
+			argsAreLiterals = argsAreLiterals
+							  && m_optimize
+							  && argsPushed <= 2
+							  && literalValue( nex.bytecode, literalArgs[argsPushed - 1] );
+			
+			appendBytecode( expression.context[depth].bytecode, nex.bytecode );
+
+			if ( end == ')' )
+			{
+				break;
+			}
+			else if ( end != ',' )
+			{
+				m_err = WR_ERR_unexpected_token;
+				return 0;
+			}
+		}
+	}
+
+	pushDebug( WRD_LineNumber, expression.context[depth].bytecode, getSourcePosition() );
+	pushDebug( WRD_FunctionCall, expression.context[depth].bytecode, WRD_ExternalFunction );
+
+	if ( prefix.size() )
+	{
+		prefix += "::";
+		prefix += functionName;
+
+		WR_LIB_CALLBACK pure;
+		if ( m_optimize
+			 && argsAreLiterals
+			 && argsPushed
+			 && (pure = wr_pureMathFunction(wr_hashStr(prefix))) )
+		{
+			// nothing but literals going into a function of only its
+			// arguments, so the answer is known now
+			WRValue stack[3];
+			stack[0] = literalArgs[0];
+			stack[1] = literalArgs[1];
+			stack[argsPushed].init();
+			pure( stack + argsPushed, argsPushed, 0 );
+
+			if ( stack[argsPushed].type == WR_INT || stack[argsPushed].type == WR_FLOAT )
+			{
+				expression.context[depth].type = EXTYPE_LITERAL;
+				expression.context[depth].value = stack[argsPushed];
+				expression.context[depth].bytecode.all.clear();
+				expression.context[depth].bytecode.invalidateOpcodeCache();
+				return true;
+			}
+		}
+
+		unsigned char buf[4];
+		wr_pack32( wr_hashStr(prefix), buf );
+
+		pushOpcode( expression.context[depth].bytecode, O_CallLibFunction );
+		pushData( expression.context[depth].bytecode, &argsPushed, 1 ); // arg #
+		pushData( expression.context[depth].bytecode, buf, 4 ); // hash id
+
+		// normal lib will copy down the result, otherwise
+		// ignore it, it will be AFTER args
+	}
+	else
+	{
+		// push the number of args
+		uint32_t hash = wr_hashStr( functionName );
+
+		// 'new' runs it against the table it makes, it has to be called
+		if ( m_inlineFunctions && !construct && inlineCallFunction(expression, depth, hash, argsPushed, argsAreLocals) )
+		{
+			return true;
+		}
+
+		unsigned int i=0;
+		for( ; i<expression.context[depth].bytecode.functionSpace.count(); ++i )
+		{
+			if ( expression.context[depth].bytecode.functionSpace[i].hash == hash )
+			{
+				break;
+			}
+		}
+
+		expression.context[depth].bytecode.functionSpace[i].references.append() = getBytecodePosition( expression.context[depth].bytecode );
+		expression.context[depth].bytecode.functionSpace[i].hash = hash;
+
+		static const uint32_t c_yieldHash = wr_hashStr("yield");
+		if ( hash == c_yieldHash )
+		{
+			pushOpcode( expression.context[depth].bytecode, O_Yield );
+			pushData( expression.context[depth].bytecode, &argsPushed, 1 );
+		}
+		else
+		{
+			pushOpcode( expression.context[depth].bytecode, O_FUNCTION_CALL_PLACEHOLDER );
+			pushData( expression.context[depth].bytecode, &argsPushed, 1 );
+			pushData( expression.context[depth].bytecode, "XXXX", 4 ); // TBD opcode plus index, OR hash if index was not found
+		}
+		
+		// hash will copydown result same as lib, unless
+		// copy/pop which case does nothing
+
+		// normal call does nothing special, to preserve
+		// the return value a call to copy-down must be
+		// inserted
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// how long the instruction at 'code' is when inlineCallFunction() can
+// move it into another frame, and the offsets of any locals it names
+// (0 for none). 'store' is set when the first local is overwritten
+// rather than assigned through. Anything else returns 0
+static int wr_inlineInstructionSize( const unsigned char* code, int* local1, int* local2, bool* store )
+{
+	*local1 = 0;
+	*local2 = 0;
+	*store = false;
+	
+	switch( code[0] )
+	{
+		case O_LiteralZero:
+		case O_AssignToHashTableAndPop:
+		case O_Remove:
+		case O_HashEntryExists:
+		case O_PopOne:
+		case O_Dereference:
+		case O_Index:
+		case O_IndexSkipLoad:
+		case O_CountOf:
+		case O_HashOf:
+		case O_BinaryRightShiftSkipLoad:
+		case O_BinaryLeftShiftSkipLoad:
+		case O_BinaryAndSkipLoad:
+		case O_BinaryOrSkipLoad:
+		case O_BinaryXORSkipLoad:
+		case O_BinaryModSkipLoad:
+		case O_BinaryMultiplication:
+		case O_BinarySubtraction:
+		case O_BinaryDivision:
+		case O_BinaryRightShift:
+		case O_BinaryLeftShift:
+		case O_BinaryMod:
+		case O_BinaryOr:
+		case O_BinaryXOR:
+		case O_BinaryAnd:
+		case O_BinaryAddition:
+		case O_BitwiseNOT:
+		case O_LogicalAnd:
+		case O_LogicalOr:
+		case O_CompareLE:
+		case O_CompareGE:
+		case O_CompareGT:
+		case O_CompareLT:
+		case O_CompareEQ:
+		case O_CompareNE:
+		case O_PostIncrement:
+		case O_PostDecrement:
+		case O_PreIncrement:
+		case O_PreDecrement:
+		case O_PreIncrementAndPop:
+		case O_PreDecrementAndPop:
+		case O_Assign:
+		case O_AssignAndPop:
+		case O_SubtractAssign:
+		case O_AddAssign:
+		case O_ModAssign:
+		case O_MultiplyAssign:
+		case O_DivideAssign:
+		case O_ORAssign:
+		case O_ANDAssign:
+		case O_XORAssign:
+		case O_RightShiftAssign:
+		case O_LeftShiftAssign:
+		case O_SubtractAssignAndPop:
+		case O_AddAssignAndPop:
+		case O_ModAssignAndPop:
+		case O_MultiplyAssignAndPop:
+		case O_DivideAssignAndPop:
+		case O_ORAssignAndPop:
+		case O_ANDAssignAndPop:
+		case O_XORAssignAndPop:
+		case O_RightShiftAssignAndPop:
+		case O_LeftShiftAssignAndPop:
+		case O_LogicalNot:
+		case O_Negate:
+		case O_ToInt:
+		case O_ToFloat:
+			return 1;
+
+		case O_LiteralInt8:
+		case O_IndexLiteral8:
+		case O_StackSwap:
+		case O_LoadFromGlobal:
+		case O_AssignToGlobalAndPop:
+		case O_IncGlobal:
+		case O_DecGlobal:
+		case O_BinaryAdditionAndStoreGlobal:
+		case O_BinarySubtractionAndStoreGlobal:
+		case O_BinaryMultiplicationAndStoreGlobal:
+		case O_BinaryDivisionAndStoreGlobal:
+		case O_GSCompareEQ:
+		case O_GSCompareNE:
+		case O_GSCompareGE:
+		case O_GSCompareLE:
+		case O_GSCompareGT:
+		case O_GSCompareLT:
+			return 2;
+
+		case O_AssignToLocalAndPop:
+		case O_IncLocal:
+		case O_DecLocal:
+		case O_BinaryAdditionAndStoreLocal:
+		case O_BinarySubtractionAndStoreLocal:
+		case O_BinaryMultiplicationAndStoreLocal:
+		case O_BinaryDivisionAndStoreLocal:
+			*store = true;
+		case O_LoadFromLocal:
+		case O_LSCompareEQ:
+		case O_LSCompareNE:
+		case O_LSCompareGE:
+		case O_LSCompareLE:
+		case O_LSCompareGT:
+		case O_LSCompareLT:
+			*local1 = 1;
+			return 2;
+
+		// 8-bit jumps keep the width of the 16-bit ones they replaced
+		case O_LiteralInt16:
+		case O_IndexLiteral16:
+		case O_RelativeJump:
+		case O_RelativeJump8:
+		case O_BZ:
+		case O_BZ8:
+		case O_CompareBEQ:
+		case O_CompareBNE:
+		case O_CompareBGE:
+		case O_CompareBLE:
+		case O_CompareBGT:
+		case O_CompareBLT:
+		case O_CompareBEQ8:
+		case O_CompareBNE8:
+		case O_CompareBGE8:
+		case O_CompareBLE8:
+		case O_CompareBGT8:
+		case O_CompareBLT8:
+		case O_BLA:
+		case O_BLA8:
+		case O_BLO:
+		case O_BLO8:
+		case O_LiteralInt8ToGlobal:
+		case O_IndexGlobalLiteral8:
+		case O_SwapTwoToTop:
+		case O_GGValues:
+		case O_GGCompareGT:
+		case O_GGCompareGE:
+		case O_GGCompareLT:
+		case O_GGCompareLE:
+		case O_GGCompareEQ:
+		case O_GGCompareNE:
+		case O_GGBinaryMultiplication:
+		case O_GGBinaryAddition:
+		case O_GGBinarySubtraction:
+		case O_GGBinaryDivision:
+			return 3;
+
+		case O_LiteralInt8ToLocal:
+			*store = true;
+		case O_IndexLocalLiteral8:
+		case O_LGValues:
+		case O_GLBinaryMultiplication:
+		case O_GLBinaryAddition:
+		case O_GLBinarySubtraction:
+		case O_GLBinaryDivision:
+			*local1 = 1;
+			return 3;
+
+		case O_GLValues:
+		case O_LGBinarySubtraction:
+		case O_LGBinaryDivision:
+			*local1 = 2;
+			return 3;
+
+		case O_LLValues:
+		case O_LLCompareGT:
+		case O_LLCompareGE:
+		case O_LLCompareLT:
+		case O_LLCompareLE:
+		case O_LLCompareEQ:
+		case O_LLCompareNE:
+		case O_LLBinaryMultiplication:
+		case O_LLBinaryAddition:
+		case O_LLBinarySubtraction:
+		case O_LLBinaryDivision:
+			*local1 = 1;
+			*local2 = 2;
+			return 3;
+
+		case O_LiteralInt16ToGlobal:
+		case O_IndexGlobalLiteral16:
+		case O_GSCompareEQBZ:
+		case O_GSCompareNEBZ:
+		case O_GSCompareGEBZ:
+		case O_GSCompareLEBZ:
+		case O_GSCompareGTBZ:
+		case O_GSCompareLTBZ:
+		case O_GSCompareEQBZ8:
+		case O_GSCompareNEBZ8:
+		case O_GSCompareGEBZ8:
+		case O_GSCompareLEBZ8:
+		case O_GSCompareGTBZ8:
+		case O_GSCompareLTBZ8:
+		case O_GlobalBZ:
+		case O_GlobalBZ8:
+			return 4;
+
+		case O_LiteralInt16ToLocal:
+			*store = true;
+		case O_IndexLocalLiteral16:
+		case O_LSCompareEQBZ:
+		case O_LSCompareNEBZ:
+		case O_LSCompareGEBZ:
+		case O_LSCompareLEBZ:
+		case O_LSCompareGTBZ:
+		case O_LSCompareLTBZ:
+		case O_LSCompareEQBZ8:
+		case O_LSCompareNEBZ8:
+		case O_LSCompareGEBZ8:
+		case O_LSCompareLEBZ8:
+		case O_LSCompareGTBZ8:
+		case O_LSCompareLTBZ8:
+		case O_LocalBZ:
+		case O_LocalBZ8:
+			*local1 = 1;
+			return 4;
+
+		case O_LiteralInt32:
+		case O_LiteralFloat:
+		case O_LoadLibConstant:
+		case O_StackIndexHash:
+		case O_GGCompareLTBZ:
+		case O_GGCompareLEBZ:
+		case O_GGCompareGTBZ:
+		case O_GGCompareGEBZ:
+		case O_GGCompareEQBZ:
+		case O_GGCompareNEBZ:
+		case O_GGCompareLTBZ8:
+		case O_GGCompareLEBZ8:
+		case O_GGCompareGTBZ8:
+		case O_GGCompareGEBZ8:
+		case O_GGCompareEQBZ8:
+		case O_GGCompareNEBZ8:
+			return 5;
+
+		case O_LLCompareLTBZ:
+		case O_LLCompareLEBZ:
+		case O_LLCompareGTBZ:
+		case O_LLCompareGEBZ:
+		case O_LLCompareEQBZ:
+		case O_LLCompareNEBZ:
+		case O_LLCompareLTBZ8:
+		case O_LLCompareLEBZ8:
+		case O_LLCompareGTBZ8:
+		case O_LLCompareGEBZ8:
+		case O_LLCompareEQBZ8:
+		case O_LLCompareNEBZ8:
+			*local1 = 1;
+			*local2 = 2;
+			return 5;
+
+		case O_LiteralInt32ToGlobal:
+		case O_LiteralFloatToGlobal:
+		case O_GlobalIndexHash:
+		case O_CallLibFunction:
+		case O_CallLibFunctionAndPop:
+			return 6;
+
+		case O_LiteralInt32ToLocal:
+		case O_LiteralFloatToLocal:
+			*store = true;
+		case O_LocalIndexHash:
+			*local1 = 1;
+			return 6;
+
+		case O_LiteralString:
+			return 3 + (int)(uint16_t)READ_16_FROM_PC(code + 1);
+
+		case O_Wide:
+		{
+			switch( code[1] )
 			{
-				// first and second are both loaded but neither
-				// is in the correct position
+				case W_IncLocalLLCompareLT:
+					*store = true;
+					*local1 = 3;
+					*local2 = 2;
+					return 6;
 
-				WRCompilationContext::pushOpcode( expression.bytecode, O_SwapTwoToTop );
-				unsigned char pos = expression.context[first].stackPosition + 1;
-				WRCompilationContext::pushData( expression.bytecode, &pos, 1 );
-				pos = expression.context[second].stackPosition + 1;
-				WRCompilationContext::pushData( expression.bytecode, &pos, 1 );
+				case W_LLIndex:
+					*local1 = 2;
+					*local2 = 3;
+					return 4;
 
-				expression.swapWithTop( expression.context[second].stackPosition, false );
-				expression.swapWithTop( 1, false );
-				expression.swapWithTop( expression.context[first].stackPosition, false );
+				case W_LLIndexHashPair:
+					*local1 = 2;
+					*local2 = 7;
+					return 12;
+
+				default:
+					return 0;
 			}
+		}
 
-			appendBytecode( expression.bytecode, expression.context[o].bytecode ); // apply operator
+		default:
+			return 0;
+	}
+}
 
-			expression.context.remove( o - 1, 2 ); // knock off operator and arg
-			expression.pushToStack(o - 1);
+//------------------------------------------------------------------------------
+// the arguments have been pushed for a call to 'hash'; if it names a
+// small function that does nothing but work on its own frame, copy its
+// body in here with its locals moved into this frame instead of
+// making the call
+bool WRCompilationContext::inlineCallFunction( WRExpression& expression,
+											   int depth,
+											   uint32_t hash,
+											   unsigned char argsPushed,
+											   bool argsAreLocals )
+{
+	if ( m_unitTop == 0 || expression.bytecode.isStructSpace )
+	{
+		return false;
+	}
 
-			break;
+	// same resolution link() will use
+	unsigned int u = 1;
+	for( ; u<m_units.count() && m_units[u].hash != hash; ++u );
+
+	if ( u >= m_units.count() || (int)u == m_unitTop )
+	{
+		return false;
+	}
+
+	WRUnitContext& callee = m_units[u];
+	const unsigned int locals = callee.bytecode.localSpace.count();
+	const unsigned int end = callee.bytecode.all.size() - 1;
+	
+	if ( localsAreMembers(u)
+		 || callee.bytecode.all.size() == 0
+		 || end > WRENCH_INLINE_MAX_BYTES
+		 || locals > 255
+		 || callee.bytecode.functionSpace.count()
+		 || callee.bytecode.unitObjectSpace.count()
+		 || callee.bytecode.gotoSource.count() )
+	{
+		return false;
+	}
+
+	// everything must be movable, with the only return at the very
+	// end so the body can fall out the bottom
+	const unsigned char* code = callee.bytecode.all;
+	if ( code[end] != O_Return && code[end] != O_ReturnZero )
+	{
+		return false;
+	}
+
+	int local1;
+	int local2;
+	bool store;
+	bool paramStored = false;
+	unsigned int a = 0;
+	while( a < end )
+	{
+		int size = wr_inlineInstructionSize( code + a, &local1, &local2, &store );
+		if ( !size
+			 || a + size > end
+			 || (local1 && code[a + local1] >= locals)
+			 || (local2 && code[a + local2] >= locals) )
+		{
+			return false;
 		}
 
-		case WR_OPER_BINARY:
+		paramStored = paramStored || (store && code[a + local1] < callee.arguments);
+		a += size;
+	}
+
+	WRBytecode& bytecode = expression.context[depth].bytecode;
+
+	// arguments that are plain locals the callee only reads can be
+	// used where they are, the loads that pushed them go away
+	const bool alias = argsAreLocals
+					   && !paramStored
+					   && bytecode.all.size() == (unsigned int)argsPushed * 2;
+
+	unsigned char slot[256];
+	unsigned int bound = (argsPushed < callee.arguments) ? argsPushed : callee.arguments;
+	unsigned int first = 0;
+	if ( alias )
+	{
+		for( ; first<bound; ++first )
 		{
-			ret = 2;
+			slot[first] = bytecode.all[first*2 + 1];
+		}
+	}
 
-			if( o == 0 )
-			{
-				m_err = WR_ERR_bad_expression;
-				return 0;
-			}
+	// the rest live in slots this frame sets aside, shared by every
+	// inlined body since none of them can be running at once. Pick up
+	// anything the arguments declared first so the indexes line up
+	WRarray<WRNamespaceLookup>& space = expression.bytecode.localSpace;
+	for( unsigned int n=0; n<bytecode.localSpace.count(); ++n )
+	{
+		unsigned int m = 0;
+		for( ; m<space.count() && space[m].hash != bytecode.localSpace[n].hash; ++m );
+		if ( m >= space.count() )
+		{
+			WRNamespaceLookup& L = space.append();
+			L.hash = bytecode.localSpace[n].hash;
+			L.label = bytecode.localSpace[n].label;
+		}
+	}
 
-			int second = o + 1; // push first
-			int first = o - 1;  // push second
-			bool useAlt = false;
-			// so
-			// 1 - first
-			// [oper]
-			// 0 - second
+	WRstr label;
+	for( unsigned int l=first; l<locals; ++l )
+	{
+		label.format( "@inline%d", l );
+		uint32_t h = wr_hashStr( label );
 
-			if ( expression.context[second].stackPosition == -1 )
-			{
-				if ( expression.context[first].stackPosition == -1 )
-				{
-					loadExpressionContext( expression, second, o ); // nope, grab 'em
-					loadExpressionContext( expression, first, o ); 
-				}
-				else
-				{
-					// first is in the stack somewhere, we need
-					// to swap it to the top, then load, then
-					// swap top values
-					expression.swapWithTop( expression.context[first].stackPosition );
+		unsigned int m = 0;
+		for( ; m<space.count() && space[m].hash != h; ++m );
+		if ( m > 255 )
+		{
+			return false;
+		}
+		
+		if ( m >= space.count() )
+		{
+			WRNamespaceLookup& L = space.append();
+			L.hash = h;
+			L.label = label;
+		}
+		
+		slot[l] = (unsigned char)m;
+	}
 
-					loadExpressionContext( expression, second, o );
+	unsigned char data[3];
+	if ( alias )
+	{
+		bytecode.all.shave( argsPushed * 2 );
+		bytecode.invalidateOpcodeCache();
+	}
+	else
+	{
+		for( ; argsPushed > callee.arguments; --argsPushed )
+		{
+			pushOpcode( bytecode, O_PopOne );
+		}
 
-					if ( expression.context[o].operation->alt == O_LAST )
-					{
-						expression.swapWithTop( 1 );
-					}
-					else // otherwise top shuffle is NOT required because we have an equal-but-opposite operation
-					{
-						useAlt = true;
-					}
-				}
-			}
-			else if ( expression.context[first].stackPosition == -1 )
-			{
-				// perfect, swap up the second, then load the
-				// first
+		// exactly what the call would have left in its argument slots
+		for( int p=argsPushed - 1; p>=0; --p )
+		{
+			data[0] = W_PopToLocal;
+			wr_pack16( slot[p], data + 1 );
+			pushOpcode( bytecode, O_Wide );
+			pushData( bytecode, data, 3 );
+		}
+	}
 
-				expression.swapWithTop( expression.context[second].stackPosition );
+	// and the call would have started everything else at zero
+	for( unsigned int l=bound; l<locals; ++l )
+	{
+		data[0] = slot[l];
+		data[1] = 0;
+		pushOpcode( bytecode, O_LiteralInt8ToLocal );
+		pushData( bytecode, data, 2 );
+	}
 
-				loadExpressionContext( expression, first, o );
-			}
-			else if ( expression.context[second].stackPosition == 1 )
+	if ( end )
+	{
+		unsigned int base = bytecode.all.size();
+		bytecode.all.append( code, end );
+		for( a=0; a<end; )
+		{
+			int size = wr_inlineInstructionSize( code + a, &local1, &local2, &store );
+			if ( local1 )
 			{
-				// second is already where its supposed to be,
-				// swap first to top if it's not there already
-				if ( expression.context[first].stackPosition != 0 )
-				{
-					expression.swapWithTop( expression.context[first].stackPosition );
-				}
+				bytecode.all[base + a + local1] = slot[code[a + local1]];
 			}
-			else if ( expression.context[second].stackPosition == 0 )
+			if ( local2 )
 			{
-				// second is on top of the stack, swap with
-				// next level down then swap first up
+				bytecode.all[base + a + local2] = slot[code[a + local2]];
+			}
+			a += size;
+		}
 
+		// opaque to the keyhole optimizer, same as a wide instruction.
+		// Any jumps inside are relative so they came along intact, and
+		// those aimed at the return now land on whatever replaces it
+		bytecode.opcodes += O_Wide;
+	}
 
-				if ( expression.context[first].stackPosition == 1 )
-				{
-					// lucky! a simple single-swap will put them in the
-					// right order (turns out this is common)
-					expression.swapWithTop( 1 );
-				}
-				else
-				{
-					// can still do it in one opcode
-					
-					WRCompilationContext::pushOpcode( expression.bytecode, O_SwapTwoToTop );
-					unsigned char pos = expression.context[first].stackPosition + 1;
-					WRCompilationContext::pushData( expression.bytecode, &pos, 1 );
-					pos = 2;
-					WRCompilationContext::pushData( expression.bytecode, &pos, 1 );
-					
-					expression.swapWithTop( 1, false );
-					expression.swapWithTop( expression.context[first].stackPosition, false );
-				}
-			}
-			else
-			{
-				// first and second are both loaded but neither is in the correct position
+	// the return value is copied out of the frame exactly as
+	// PushIndexFunctionReturnValue would; a dropped zero is
+	// optimized away entirely
+	pushOpcode( bytecode, (code[end] == O_Return) ? O_Dereference : O_LiteralZero );
 
-				WRCompilationContext::pushOpcode( expression.bytecode, O_SwapTwoToTop );
-				unsigned char pos = expression.context[first].stackPosition + 1;
-				WRCompilationContext::pushData( expression.bytecode, &pos, 1 );
-				pos = expression.context[second].stackPosition + 1;
-				WRCompilationContext::pushData( expression.bytecode, &pos, 1 );
+	return true;
+}
 
-				expression.swapWithTop( expression.context[second].stackPosition, false );
-				expression.swapWithTop( 1, false );
-				expression.swapWithTop( expression.context[first].stackPosition, false );
-			}
+//------------------------------------------------------------------------------
+// how long the instruction at 'code' is anywhere in a unit before it
+// is linked, and the offsets of any 8-bit locals it names (0 for
+// none), or of a 16-bit one in 'wideLocal'. 0 for anything else
+static int wr_frameInstructionSize( const unsigned char* code, int* local1, int* local2, int* wideLocal )
+{
+	*wideLocal = 0;
 
-			if ( useAlt )
-			{
-				pushOpcode( expression.bytecode, expression.context[o].operation->alt );
-			}
-			else
-			{
-				appendBytecode( expression.bytecode, expression.context[o].bytecode ); // apply operator
-			}
+	bool store;
+	const int size = wr_inlineInstructionSize( code, local1, local2, &store );
+	if ( size )
+	{
+		return size;
+	}
+
+	switch( code[0] )
+	{
+		case O_Return:
+		case O_ReturnZero:
+		case O_InitVar:
+		case O_InitArray:
+			return 1;
+
+		case O_Yield:
+		case O_AssignToObjectTableByOffset:
+			return 2;
+
+		case O_NewObjectTable:
+		case O_AssignToArrayAndPop:
+		case O_DebugInfo:
+		case O_GPushIterator:
+			return 3;
+
+		case O_LPushIterator:
+			*local1 = 1;
+			return 3;
+
+		case O_AssignToObjectTableByHash:
+		case O_GNextValueOrJump:
+			return 5;
 
-			expression.context.remove( o - 1, 2 ); // knock off operator and arg
-			expression.pushToStack(o - 1);
+		case O_LNextValueOrJump:
+			*local1 = 1;
+			return 5;
 
-			break;
-		}
+		case O_FUNCTION_CALL_PLACEHOLDER:
+		case O_GGNextKeyValueOrJump:
+			return 6;
 
-		case WR_OPER_POST:
-		{
-			ret = 1;
+		case O_LGNextKeyValueOrJump:
+			*local1 = 1;
+			return 6;
 
-			if( o == 0 )
-			{
-				m_err = WR_ERR_bad_expression;
-				return 0;
-			}
+		case O_GLNextKeyValueOrJump:
+			*local1 = 2;
+			return 6;
 
-			if ( expression.context[o - 1].stackPosition == -1 )
-			{
-				loadExpressionContext( expression, o - 1, o ); // load argument
-			}
-			else if ( expression.context[o - 1].stackPosition != 0 )
-			{
-				expression.swapWithTop( expression.context[o - 1].stackPosition );
-			}
+		case O_LLNextKeyValueOrJump:
+			*local1 = 1;
+			*local2 = 2;
+			return 6;
 
-			appendBytecode( expression.bytecode, expression.context[o].bytecode );
-			expression.context.remove( o, 1 ); // knock off operator
-			expression.pushToStack( o - 1 );
+		case O_Switch:
+			return 5 + 6*(int)(uint16_t)READ_16_FROM_PC(code + 1);
 
-			break;
+		case O_SwitchLinear:
+			return 4 + 2*(int)code[1];
+
+		case O_Wide:
+		{
+			switch( code[1] )
+			{
+				case W_PopToLocal:
+					*wideLocal = 2;
+					return 4;
+
+				case W_IntLLAddition:
+				case W_IntLLSubtraction:
+				case W_IntLLMultiplication:
+				case W_FloatLLAddition:
+				case W_FloatLLSubtraction:
+				case W_FloatLLMultiplication:
+				case W_FloatLLDivision:
+					*local1 = 2;
+					*local2 = 3;
+					return 4;
+
+				case W_IntLLCompareLTBZ:
+				case W_IntLLCompareLEBZ:
+				case W_IntLLCompareGTBZ:
+				case W_IntLLCompareGEBZ:
+				case W_IntLLCompareEQBZ:
+				case W_IntLLCompareNEBZ:
+				case W_IntLCountLTBZ:
+					*local1 = 2;
+					*local2 = 3;
+					return 6;
+
+				case W_IntLICompareLTBZ:
+				case W_IntLICompareLEBZ:
+				case W_IntLICompareGTBZ:
+				case W_IntLICompareGEBZ:
+				case W_IntLICompareEQBZ:
+				case W_IntLICompareNEBZ:
+					*local1 = 2;
+					return 7;
+
+				case W_SwitchDense:
+					return 10 + 2*(int)(uint16_t)READ_16_FROM_PC(code + 6);
+
+				default:
+					return 0;
+			}
 		}
+
+		default:
+			return 0;
 	}
-	
-	return ret;
 }
 
 //------------------------------------------------------------------------------
-bool WRCompilationContext::operatorFound( WRstr const& token, WRarray<WRExpressionContext>& context, int depth )
+// anything made from unit 'u' with 'new', or looked up by name, has
+// its locals for members
+bool WRCompilationContext::localsAreMembers( const unsigned int u )
 {
-	for( int i=0; c_operations[i].token; i++ )
+	WRUnitContext& unit = m_units[u];
+	if ( unit.bytecode.isStructSpace
+		 || unit.parentUnitIndex
+		 || unit.exportNamespace )
 	{
-		if ( token == c_operations[i].token )
+		return true;
+	}
+
+	for( unsigned int ux=0; ux<m_units.count(); ++ux )
+	{
+		for( unsigned int f=0; f<m_units[ux].bytecode.unitObjectSpace.count(); ++f )
 		{
-			if ( c_operations[i].type == WR_OPER_PRE
-				 && depth > 0
-				 && (context[depth-1].type != EXTYPE_OPERATION 
-					 || (context[depth - 1].type == EXTYPE_OPERATION &&
-						 (context[depth - 1].operation->type != WR_OPER_BINARY && context[depth - 1].operation->type != WR_OPER_BINARY_COMMUTE))) )
+			if ( m_units[ux].bytecode.unitObjectSpace[f].hash == unit.hash )
 			{
-				continue;
+				return true;
 			}
-			
-			context[depth].operation = c_operations + i;
-			context[depth].type = EXTYPE_OPERATION;
-
-			pushOpcode( context[depth].bytecode, c_operations[i].opcode );
-
-			return true;
 		}
 	}
 
 	return false;
 }
 
-bool WRCompilationContext::parseCallFunction( WRExpression& expression, WRstr functionName, int depth, bool parseArguments )
+//------------------------------------------------------------------------------
+// WR_OPTIMIZE gives locals that are never live at the same time the
+// same slot, so the frame every call sets up is smaller. A local is
+// live from the statement that first overwrites it, or from the top
+// of the unit if it could be read before that, to the last statement
+// that names it, and through to the end of any loop it is live going
+// into. Arguments, and anything that might hold a reference, keep a
+// slot to themselves.
+//
+// Every slot is still cleared on entry: the collector walks the whole
+// frame, so none can be left holding whatever the last call did
+void WRCompilationContext::packFrame( const unsigned int u )
 {
-	WRstr prefix = expression.context[depth].prefix;
-
-	expression.context[depth].type = EXTYPE_BYTECODE_RESULT;
-	
-	unsigned char argsPushed = 0;
+	WRUnitContext& unit = m_units[u];
+	WRarray<WRNamespaceLookup>& space = unit.bytecode.localSpace;
+	const unsigned int count = space.count();
 
-	if ( parseArguments )
+	if ( localsAreMembers(u)
+		 || unit.bytecode.gotoSource.count()
+		 || count > 255
+		 || count < unit.arguments + 2 )
 	{
-		WRstr& token2 = expression.context[depth].token;
-		WRValue& value2 = expression.context[depth].value;
+		return;
+	}
 
-		for(;;)
+	// every local the code names has to be found to be moved
+	const unsigned char* code = unit.bytecode.all;
+	const unsigned int size = unit.bytecode.all.size();
+	int local1;
+	int local2;
+	int wideLocal;
+	unsigned int a = 0;
+	while( a < size )
+	{
+		const int length = wr_frameInstructionSize( code + a, &local1, &local2, &wideLocal );
+		if ( !length )
 		{
-			if ( !getToken(expression.context[depth]) )
-			{
-				m_err = WR_ERR_unexpected_EOF;
-				return 0;
-			}
+			return;
+		}
+		a += length;
+	}
 
-			if ( !m_quoted && token2 == ")" )
+	if ( a != size )
+	{
+		return;
+	}
+
+	int lo[255];
+	int hi[255];
+	bool pinned[255];
+	for( unsigned int l=0; l<count; ++l )
+	{
+		unsigned int s = 0;
+		for( ; s<m_localSpans.count(); ++s )
+		{
+			if ( m_localSpans[s].hash == space[l].hash && m_localSpans[s].unit == (int)u )
 			{
 				break;
 			}
+		}
 
-			++argsPushed;
+		// anything it was first named by that did not just store to
+		// it could have read it
+		pinned[l] = l < unit.arguments || s >= m_localSpans.count() || m_localSpans[s].pinned;
+		if ( !pinned[l] )
+		{
+			LocalSpan& S = m_localSpans[s];
+			const bool stored = S.writes && S.writes == S.notes && S.writes == S.loads;
+			lo[l] = (stored && S.scoped) ? S.first : -1;
+			hi[l] = S.last;
+		}
+	}
 
-				WRExpression nex( expression.bytecode.localSpace, expression.bytecode.isStructSpace );
-				nex.allowFunctionNameHashLiteral = true;
-				nex.context[0].token = token2;
-				nex.context[0].value = value2;
-			m_loadedToken = token2;
-			m_loadedValue = value2;
-			m_loadedQuoted = m_quoted;
-			
-			char end = parseExpression( nex );
+	for( bool grew = true; grew; )
+	{
+		grew = false;
+		for( unsigned int p=0; p<m_loopSpans.count(); ++p )
+		{
+			LoopSpan& L = m_loopSpans[p];
+			for( unsigned int l=0; L.unit == (int)u && l<count; ++l )
+			{
+				if ( !pinned[l] && lo[l] < L.first && hi[l] >= L.first && hi[l] < L.last )
+				{
+					hi[l] = L.last;
+					grew = true;
+				}
+			}
+		}
+	}
 
-			if ( nex.bytecode.opcodes.size() > 0 )
+	// first fit, in the order they were declared
+	unsigned char slot[255];
+	bool shared[255];
+	unsigned int slots = 0;
+	for( unsigned int l=0; l<count; ++l )
+	{
+		unsigned int t = unit.arguments;
+		for( ; !pinned[l] && t<slots; ++t )
+		{
+			unsigned int m = 0;
+			for( ; shared[t] && m<l; ++m )
 			{
-				uint8_t op = nex.bytecode.opcodes[nex.bytecode.opcodes.size() - 1];
-				if ( op == O_Index
-					 || op == O_IndexSkipLoad
-					 || op == O_IndexLiteral8
-					 || op == O_IndexLiteral16
-					 || op == O_IndexLocalLiteral8
-					 || op == O_IndexGlobalLiteral8
-					 || op == O_IndexLocalLiteral16
-					 || op == O_IndexGlobalLiteral16 )
+				if ( slot[m] == t && lo[m] <= hi[l] && lo[l] <= hi[m] )
 				{
-					nex.bytecode.opcodes += O_Dereference;
-					nex.bytecode.all += O_Dereference;
+					break;
 				}
 			}
-			
-			appendBytecode( expression.context[depth].bytecode, nex.bytecode );
 
-			if ( end == ')' )
+			if ( shared[t] && m >= l )
 			{
 				break;
 			}
-			else if ( end != ',' )
+		}
+
+		if ( pinned[l] || t >= slots )
+		{
+			t = slots++;
+			shared[t] = !pinned[l];
+			if ( t != l )
 			{
-				m_err = WR_ERR_unexpected_token;
-				return 0;
+				space[t] = space[l]; // named for whichever local got it first
 			}
 		}
-	}
 
-	pushDebug( WRD_LineNumber, expression.context[depth].bytecode, getSourcePosition() );
-	pushDebug( WRD_FunctionCall, expression.context[depth].bytecode, WRD_ExternalFunction );
+		slot[l] = (unsigned char)t;
+	}
 
-	if ( prefix.size() )
+	if ( slots == count )
 	{
-		prefix += "::";
-		prefix += functionName;
-
-		unsigned char buf[4];
-		wr_pack32( wr_hashStr(prefix), buf );
-
-		pushOpcode( expression.context[depth].bytecode, O_CallLibFunction );
-		pushData( expression.context[depth].bytecode, &argsPushed, 1 ); // arg #
-		pushData( expression.context[depth].bytecode, buf, 4 ); // hash id
-
-		// normal lib will copy down the result, otherwise
-		// ignore it, it will be AFTER args
+		return;
 	}
-	else
-	{
-		// push the number of args
-		uint32_t hash = wr_hashStr( functionName );
 
-		unsigned int i=0;
-		for( ; i<expression.context[depth].bytecode.functionSpace.count(); ++i )
+	for( a=0; a<size; )
+	{
+		const int length = wr_frameInstructionSize( code + a, &local1, &local2, &wideLocal );
+		if ( local1 )
 		{
-			if ( expression.context[depth].bytecode.functionSpace[i].hash == hash )
-			{
-				break;
-			}
+			unit.bytecode.all[a + local1] = slot[code[a + local1]];
 		}
-
-		expression.context[depth].bytecode.functionSpace[i].references.append() = getBytecodePosition( expression.context[depth].bytecode );
-		expression.context[depth].bytecode.functionSpace[i].hash = hash;
-
-		static const uint32_t c_yieldHash = wr_hashStr("yield");
-		if ( hash == c_yieldHash )
+		if ( local2 )
 		{
-			pushOpcode( expression.context[depth].bytecode, O_Yield );
-			pushData( expression.context[depth].bytecode, &argsPushed, 1 );
+			unit.bytecode.all[a + local2] = slot[code[a + local2]];
 		}
-		else
+		if ( wideLocal )
 		{
-			pushOpcode( expression.context[depth].bytecode, O_FUNCTION_CALL_PLACEHOLDER );
-			pushData( expression.context[depth].bytecode, &argsPushed, 1 );
-			pushData( expression.context[depth].bytecode, "XXXX", 4 ); // TBD opcode plus index, OR hash if index was not found
+			wr_pack16( slot[READ_16_FROM_PC(code + a + wideLocal)], unit.bytecode.all.p_str(a + wideLocal) );
 		}
-		
-		// hash will copydown result same as lib, unless
-		// copy/pop which case does nothing
-
-		// normal call does nothing special, to preserve
-		// the return value a call to copy-down must be
-		// inserted
+		a += length;
 	}
 
-	return true;
+	space.setCount( slots );
 }
 
 //------------------------------------------------------------------------------
@@ -4937,6 +7630,11 @@ bool WRCompilationContext::parseUnit( bool isStruct, int parentUnitIndex )
 							   true,
 							   true );
 
+			if ( m_optimize )
+			{
+				noteLocal( wr_hashStr(token), LOCAL_OTHER ); // whatever the caller passed
+			}
+
 			if ( !getToken(ex) )
 			{
 				m_err = WR_ERR_unexpected_EOF;
@@ -4967,8 +7665,16 @@ bool WRCompilationContext::parseUnit( bool isStruct, int parentUnitIndex )
 		return false;
 	}
 		
+	bool straightLine = m_straightLine;
+	bool unconditional = m_unconditional;
+	m_straightLine = true;
+	m_unconditional = true;
+	
 	parseStatement( m_unitTop, '}', O_Return );
 
+	m_straightLine = straightLine;
+	m_unconditional = unconditional;
+
 	if ( !m_units[m_unitTop].bytecode.opcodes.size()
 		 || (m_units[m_unitTop].bytecode.opcodes[m_units[m_unitTop].bytecode.opcodes.size() - 1] != O_Return
 			 && m_units[m_unitTop].bytecode.opcodes[m_units[m_unitTop].bytecode.opcodes.size() - 1] != O_ReturnZero) )
@@ -5000,9 +7706,15 @@ bool WRCompilationContext::parseWhile( WROpcode opcodeToReturn )
 		return false;
 	}
 
+	const int loopStart = m_statement;
+
+	WRBytecode hoisted;
+	openLoop( loopStart, hoisted );
+
 	WRExpression nex( m_units[m_unitTop].bytecode.localSpace, m_units[m_unitTop].bytecode.isStructSpace );
 	nex.context[0].token = token;
 	nex.context[0].value = value;
+	nex.valueOnly = true;
 	m_loadedToken = token;
 	m_loadedValue = value;
 	m_loadedQuoted = m_quoted;
@@ -5013,23 +7725,53 @@ bool WRCompilationContext::parseWhile( WROpcode opcodeToReturn )
 		return false;
 	}
 
+	// a literal condition either never needs testing or means the
+	// loop never runs at all
+	WRValue condition;
+	const bool known = m_optimize && literalValue(nex.bytecode, condition) && condition.type == WR_INT;
+	unsigned int mark = 0;
+	unsigned int targets = 0;
+	if ( known && !condition.i )
+	{
+		m_units[m_unitTop].bytecode.invalidateOpcodeCache();
+		mark = m_units[m_unitTop].bytecode.all.size();
+		targets = m_units[m_unitTop].bytecode.jumpOffsetTargets.count();
+	}
+
+	enterLoop();
+
 	*m_continueTargets.push() = addRelativeJumpTarget( m_units[m_unitTop].bytecode );
 	setRelativeJumpTarget(m_units[m_unitTop].bytecode, *m_continueTargets.tail() );
 
-	appendBytecode( m_units[m_unitTop].bytecode, nex.bytecode );
-
 	*m_breakTargets.push() = addRelativeJumpTarget( m_units[m_unitTop].bytecode );
 
-	addRelativeJumpSource( m_units[m_unitTop].bytecode, O_BZ, *m_breakTargets.tail() );
+	if ( !known )
+	{
+		appendBytecode( m_units[m_unitTop].bytecode, nex.bytecode );
+		addRelativeJumpSource( m_units[m_unitTop].bytecode, O_BZ, *m_breakTargets.tail() );
+	}
+	else if ( !condition.i )
+	{
+		addRelativeJumpSource( m_units[m_unitTop].bytecode, O_RelativeJump, *m_breakTargets.tail() );
+	}
 
 	if ( !parseStatement(m_unitTop, ';', opcodeToReturn) )
 	{
 		return false;
 	}
+
+	addLoopSpan( loopStart );
 	
 	addRelativeJumpSource( m_units[m_unitTop].bytecode, O_RelativeJump, *m_continueTargets.tail() );
+	closeLoop( *m_continueTargets.tail() );
 	setRelativeJumpTarget( m_units[m_unitTop].bytecode, *m_breakTargets.tail() );
 
+	if ( known && !condition.i )
+	{
+		discardBytecode( m_units[m_unitTop].bytecode, mark, targets );
+		setRelativeJumpTarget( m_units[m_unitTop].bytecode, *m_breakTargets.tail() );
+	}
+
 	m_continueTargets.pop();
 	m_breakTargets.pop();
 	
@@ -5046,6 +7788,8 @@ bool WRCompilationContext::parseDoWhile( WROpcode opcodeToReturn )
 
 	int jumpToTop = addRelativeJumpTarget( m_units[m_unitTop].bytecode );
 	setRelativeJumpTarget( m_units[m_unitTop].bytecode, jumpToTop );
+
+	const int loopStart = m_statement;
 	
 	if ( !parseStatement(m_unitTop, ';', opcodeToReturn) )
 	{
@@ -5076,9 +7820,14 @@ bool WRCompilationContext::parseDoWhile( WROpcode opcodeToReturn )
 		return false;
 	}
 
+	// a break can skip the condition, so it gets a block of its own
+	++m_statement;
+	const int block = openBlock();
+
 	WRExpression nex( m_units[m_unitTop].bytecode.localSpace, m_units[m_unitTop].bytecode.isStructSpace );
 	nex.context[0].token = token;
 	nex.context[0].value = value;
+	nex.valueOnly = true;
 	//m_loadedToken = token;
 	//m_loadedValue = value;
 
@@ -5088,6 +7837,9 @@ bool WRCompilationContext::parseDoWhile( WROpcode opcodeToReturn )
 		return false;
 	}
 
+	m_block = block;
+	addLoopSpan( loopStart );
+
 	if (!getToken(ex, ";"))
 	{
 		m_err = WR_ERR_unexpected_token;
@@ -5156,11 +7908,15 @@ A:
 */
 
 	bool foreachPossible = true;
+	bool fuseBack = false;
+	int body = -1;
+	unsigned char back[3] = { 0, 0, 0 };
 	bool foreachKV = false;
 	bool foreachV = false;
+	bool foreachWide = false;
 	int foreachLoadI = 0;
-	unsigned char foreachLoad[4];
-	unsigned char g = 0;
+	unsigned int foreachLoad[4];
+	unsigned int g = 0;
 
 	m_parsingFor = true;
 
@@ -5181,6 +7937,7 @@ A:
 		WRExpression nex( m_units[m_unitTop].bytecode.localSpace, m_units[m_unitTop].bytecode.isStructSpace );
 		nex.context[0].token = token;
 		nex.context[0].value = value;
+		nex.valueOnly = true;
 		m_loadedToken = token;
 		m_loadedValue = value;
 		m_loadedQuoted = m_quoted;
@@ -5191,20 +7948,9 @@ A:
 		{
 			if ( foreachLoadI < 3 )
 			{
-				if (nex.bytecode.opcodes.size() == 1
-					  && nex.bytecode.all.size() == 2
-					  && ((nex.bytecode.all[0] == O_LoadFromLocal) || (nex.bytecode.all[0] == O_LoadFromGlobal)) )
-				{
-					foreachLoad[foreachLoadI++] = nex.bytecode.all[0];
-					foreachLoad[foreachLoadI++] = nex.bytecode.all[1];
-				}
-				else if ( nex.bytecode.opcodes.size() == 2
-						  && nex.bytecode.all.size() == 5
-						  && nex.bytecode.all[0] == O_DebugInfo
-						  && ((nex.bytecode.all[3] == O_LoadFromLocal) || (nex.bytecode.all[3] == O_LoadFromGlobal)) )
+				if ( singleLoad(nex.bytecode, foreachLoad + foreachLoadI) )
 				{
-					foreachLoad[foreachLoadI++] = nex.bytecode.all[3];
-					foreachLoad[foreachLoadI++] = nex.bytecode.all[4];
+					foreachLoadI += 2;
 				}
 				else
 				{
@@ -5228,32 +7974,56 @@ A:
 		}
 		else if ( end == ':' )
 		{
+			// the loop writes whatever it finds into the names it was
+			// given, as references, so they keep slots to themselves
+			for( int f=0; f<foreachLoadI && tracksLocals(nex); f += 2 )
+			{
+				if ( foreachLoad[f] == O_LoadFromLocal && foreachLoad[f+1] < m_units[m_unitTop].bytecode.localSpace.count() )
+				{
+					noteLocal( m_units[m_unitTop].bytecode.localSpace[foreachLoad[f+1]].hash, LOCAL_OTHER );
+					localSpan( m_units[m_unitTop].bytecode.localSpace[foreachLoad[f+1]].hash ).pinned = true;
+				}
+			}
+
 			if ( foreachPossible )
 			{
 				WRExpression nex2( m_units[m_unitTop].bytecode.localSpace, m_units[m_unitTop].bytecode.isStructSpace );
 				nex2.context[0].token = token;
 				nex2.context[0].value = value;
 				end = parseExpression( nex2 );
-				if ( end == ')'
-					 && nex2.bytecode.opcodes.size() == 1
-					 && nex2.bytecode.all.size() == 2 )
+				unsigned int from[2];
+				if ( end == ')' && singleLoad(nex2.bytecode, from) )
 				{
 
 					WRstr T;
 					T.format( "foreach:%d", m_foreachHash++ );
-					g = (unsigned char)(addGlobalSpaceLoad(m_units[0].bytecode, T, true, true)); // #25 force "var seen" true since we are runtime adding the temporary ourselves
+					g = addGlobalSpaceLoad(m_units[0].bytecode, T, true, true); // #25 force "var seen" true since we are runtime adding the temporary ourselves
 
-					if ( nex2.bytecode.opcodes[0] == O_LoadFromLocal )
+					foreachWide = from[1] > 255 || g > 255 || foreachLoad[1] > 255 || (foreachLoadI == 4 && foreachLoad[3] > 255);
+					if ( foreachWide )
 					{
-						m_units[m_unitTop].bytecode.all += O_LPushIterator;
+						unsigned char data[6];
+						data[0] = W_PushIterator;
+						data[1] = (from[0] == O_LoadFromLocal) ? 1 : 0;
+						wr_pack16( from[1], data + 2 );
+						wr_pack16( g, data + 4 );
+						pushOpcode( m_units[m_unitTop].bytecode, O_Wide );
+						pushData( m_units[m_unitTop].bytecode, data, 6 );
 					}
 					else
 					{
-						m_units[m_unitTop].bytecode.all += O_GPushIterator;
-					}
+						if ( from[0] == O_LoadFromLocal )
+						{
+							m_units[m_unitTop].bytecode.all += O_LPushIterator;
+						}
+						else
+						{
+							m_units[m_unitTop].bytecode.all += O_GPushIterator;
+						}
 
-					m_units[m_unitTop].bytecode.all += nex2.bytecode.all[1];
-					pushData( m_units[m_unitTop].bytecode, &g, 1 );
+						m_units[m_unitTop].bytecode.all += (unsigned char)from[1];
+						m_units[m_unitTop].bytecode.all += (unsigned char)g;
+					}
 
 					if ( foreachLoadI == 4 )
 					{
@@ -5290,54 +8060,85 @@ A:
 		}
 	}
 
+	const int loopStart = ++m_statement;
+
+	// a foreach loop has nothing of its own to move out
+	WRBytecode hoisted;
+	const bool hoistable = !foreachV && !foreachKV;
+	if ( hoistable )
+	{
+		openLoop( loopStart, hoisted );
+		enterLoop();
+	}
+
 	// <- condition point
 	int conditionPoint = addRelativeJumpTarget( m_units[m_unitTop].bytecode );
 
 	setRelativeJumpTarget( m_units[m_unitTop].bytecode, conditionPoint );
 	
-	if ( foreachV || foreachKV )
+	if ( foreachWide )
 	{
-		if ( foreachV )
+		// [W_Next...][shape][(key) value iterator] rel16
+		unsigned char data[8];
+		int size = 0;
+		data[size++] = foreachKV ? W_NextKeyValueOrJump : W_NextValueOrJump;
+		data[size++] = ((foreachLoad[0] == O_LoadFromLocal) ? 1 : 0)
+					   | ((foreachKV && foreachLoad[2] == O_LoadFromLocal) ? 2 : 0);
+		wr_pack16( foreachLoad[1], data + size );
+		size += 2;
+		if ( foreachKV )
 		{
-			unsigned char load[2] = { foreachLoad[1], g };
+			wr_pack16( foreachLoad[3], data + size );
+			size += 2;
+		}
+		wr_pack16( g, data + size );
+		size += 2;
+
+		addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_Wide, *m_breakTargets.tail(), data, size );
+	}
+	else if ( foreachV )
+	{
+		unsigned char load[2] = { (unsigned char)foreachLoad[1], (unsigned char)g };
 
-			if ( foreachLoad[0] == O_LoadFromLocal )
+		if ( foreachLoad[0] == O_LoadFromLocal )
+		{
+			addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_LNextValueOrJump, *m_breakTargets.tail(), load, 2 );
+		}
+		else
+		{
+			addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_GNextValueOrJump, *m_breakTargets.tail(), load, 2 );
+		}
+	}
+	else if ( foreachKV )
+	{
+		unsigned char load[3] = { (unsigned char)foreachLoad[1], (unsigned char)foreachLoad[3], (unsigned char)g };
+		
+		if ( foreachLoad[0] == O_LoadFromLocal )
+		{
+			if ( foreachLoad[2] == O_LoadFromLocal )
 			{
-				addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_LNextValueOrJump, *m_breakTargets.tail(), load, 2 );
+				addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_LLNextKeyValueOrJump, *m_breakTargets.tail(), load, 3 );
 			}
 			else
 			{
-				addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_GNextValueOrJump, *m_breakTargets.tail(), load, 2 );
+				addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_LGNextKeyValueOrJump, *m_breakTargets.tail(), load, 3 );
 			}
 		}
 		else
 		{
-			unsigned char load[3] = { foreachLoad[1], foreachLoad[3], g };
-			
-			if ( foreachLoad[0] == O_LoadFromLocal )
-			{
-				if ( foreachLoad[2] == O_LoadFromLocal )
-				{
-					addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_LLNextKeyValueOrJump, *m_breakTargets.tail(), load, 3 );
-				}
-				else
-				{
-					addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_LGNextKeyValueOrJump, *m_breakTargets.tail(), load, 3 );
-				}
-			}
-			else
+			if ( foreachLoad[2] == O_LoadFromLocal )
 			{
-				if ( foreachLoad[2] == O_LoadFromLocal )
-				{
-					addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_GLNextKeyValueOrJump, *m_breakTargets.tail(), load, 3 );
-				}
-				else
-				{
-					addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_GGNextKeyValueOrJump, *m_breakTargets.tail(), load, 3 );
-				}
+				addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_GLNextKeyValueOrJump, *m_breakTargets.tail(), load, 3 );
+			}
+			else
+			{
+				addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_GGNextKeyValueOrJump, *m_breakTargets.tail(), load, 3 );
 			}
 		}
-		
+	}
+
+	if ( foreachV || foreachKV )
+	{
 		m_parsingFor = false;
 
 		// [ code ]
@@ -5355,11 +8156,14 @@ A:
 		}
 
 		// [ condition ]
+		int conditionStart = -1;
+		int conditionSize = 0;
 		if ( token != ";" )
 		{
 			WRExpression nex( m_units[m_unitTop].bytecode.localSpace, m_units[m_unitTop].bytecode.isStructSpace );
 			nex.context[0].token = token;
 			nex.context[0].value = value;
+			nex.valueOnly = true;
 			m_loadedToken = token;
 			m_loadedValue = value;
 			m_loadedQuoted = m_quoted;
@@ -5370,16 +8174,49 @@ A:
 				return false;
 			}
 
+			conditionStart = m_units[m_unitTop].bytecode.all.size();
 			appendBytecode( m_units[m_unitTop].bytecode, nex.bytecode );
 
 			// -> false jump break
 			addRelativeJumpSource( m_units[m_unitTop].bytecode, O_BZ, *m_breakTargets.tail() );
+			conditionSize = m_units[m_unitTop].bytecode.all.size() - conditionStart;
+		}
+
+		// 'i < n' can be tested again by the instruction that
+		// increments 'i', which then jumps straight to the body
+		int backLocals = 0;
+		const unsigned char* condition = m_units[m_unitTop].bytecode.all.p_str( (conditionStart == -1) ? 0 : conditionStart );
+		if ( conditionStart == -1
+			 || m_units[m_unitTop].bytecode.jumpOffsetTargets[conditionPoint].offset != conditionStart
+			 || (m_optimize && hoistable && m_loops.tail()->entry != -1) )
+		{
+			// nothing to fuse with, or the hoisted code follows the
+			// jump back and must not be fallen into
+		}
+		else if ( conditionSize == 5 && condition[0] == O_LLCompareLTBZ )
+		{
+			backLocals = 1;
+		}
+		else if ( conditionSize == 6 && condition[0] == O_Wide && condition[1] == W_IntLLCompareLTBZ )
+		{
+			backLocals = 2;
+		}
+
+		if ( backLocals )
+		{
+			back[0] = W_IncLocalLLCompareLT;
+			back[1] = condition[backLocals];
+			back[2] = condition[backLocals + 1];
+			body = addRelativeJumpTarget( m_units[m_unitTop].bytecode );
+			setRelativeJumpTarget( m_units[m_unitTop].bytecode, body );
 		}
 
 
 		WRExpression post( m_units[m_unitTop].bytecode.localSpace, m_units[m_unitTop].bytecode.isStructSpace );
 
-		// [ post code ]
+		// [ post code ] might never run, so it gets a block of its own
+		++m_statement;
+		const int block = openBlock();
 		for(;;)
 		{
 			if ( !getToken(ex) )
@@ -5396,6 +8233,7 @@ A:
 			WRExpression nex( m_units[m_unitTop].bytecode.localSpace, m_units[m_unitTop].bytecode.isStructSpace );
 			nex.context[0].token = token;
 			nex.context[0].value = value;
+			nex.valueOnly = true;
 			m_loadedToken = token;
 			m_loadedValue = value;
 			m_loadedQuoted = m_quoted;
@@ -5416,6 +8254,7 @@ A:
 			}
 		}
 
+		m_block = block;
 		m_parsingFor = false;
 
 		// [ code ]
@@ -5428,10 +8267,34 @@ A:
 		setRelativeJumpTarget( m_units[m_unitTop].bytecode, *m_continueTargets.tail() );
 
 		// [post code]
-		appendBytecode( m_units[m_unitTop].bytecode, post.bytecode );
+		if ( body != -1
+			 && post.bytecode.all.size() == 2
+			 && post.bytecode.all[0] == O_IncLocal
+			 && (unsigned char)post.bytecode.all[1] == back[2] )
+		{
+			fuseBack = true;
+		}
+		else
+		{
+			appendBytecode( m_units[m_unitTop].bytecode, post.bytecode );
+		}
 	}
 
-	addRelativeJumpSource( m_units[m_unitTop].bytecode, O_RelativeJump, conditionPoint );
+	addLoopSpan( loopStart );
+
+	if ( fuseBack )
+	{
+		// -> [++i, i < n jump body]
+		addRelativeJumpSourceEx( m_units[m_unitTop].bytecode, O_Wide, body, back, 3 );
+	}
+	else
+	{
+		addRelativeJumpSource( m_units[m_unitTop].bytecode, O_RelativeJump, conditionPoint );
+	}
+	if ( hoistable )
+	{
+		closeLoop( conditionPoint );
+	}
 	setRelativeJumpTarget( m_units[m_unitTop].bytecode, *m_breakTargets.tail() );
 
 	m_continueTargets.pop();
@@ -5636,6 +8499,24 @@ uint32_t WRCompilationContext::getSingleValueHash( const char* end )
 		return getSingleValueHash( ")" );
 	}
 
+	if ( !m_quoted && token == "-" ) // negative literal
+	{
+		getToken( ex );
+		if ( value.type == WR_INT )
+		{
+			value.i = -value.i;
+		}
+		else if ( value.type == WR_FLOAT )
+		{
+			value.f = -value.f;
+		}
+		else
+		{
+			m_err = WR_ERR_switch_bad_case_hash;
+			return 0;
+		}
+	}
+
 	if ( value.type == WR_REF )
 	{
 		m_err = WR_ERR_switch_bad_case_hash;
@@ -5668,6 +8549,18 @@ pc> 16-bit default location
     break target:
 
 
+continue target:
+O_Wide W_SwitchDense
+    32-bit lowest case
+    16-bit count
+pc> 16-bit default location
+    16 bit case offset (case lowest + n)
+    ...
+    cases...
+    [cases]
+    break target:
+
+
 continue target:
 switch ins
 16-bit mod
@@ -5836,6 +8729,12 @@ bool WRCompilationContext::parseSwitch( WROpcode opcodeToReturn )
 
 	// find the highest hash value, and size an array to that
 	unsigned int size = 0;
+
+	// and the span of the cases read as signed ints, so a run like
+	// 1000..1063 or -8..8 can still get a direct table
+	int32_t low = 0;
+	int32_t high = 0;
+	unsigned int labels = 0;
 	for( unsigned int d=0; d<cases.count(); ++d )
 	{
 		if ( cases[d].defaultCase )
@@ -5845,15 +8744,28 @@ bool WRCompilationContext::parseSwitch( WROpcode opcodeToReturn )
 
 		if ( cases[d].hash > size )
 		{
-			size = cases[d].hash;
+			size = cases[d].hash < 254 ? cases[d].hash : 254;
 		}
 
-		if ( size >= 254 )
+		if ( !labels++ )
 		{
-			break;
+			low = high = (int32_t)cases[d].hash;
+		}
+		else if ( (int32_t)cases[d].hash < low )
+		{
+			low = (int32_t)cases[d].hash;
+		}
+		else if ( (int32_t)cases[d].hash > high )
+		{
+			high = (int32_t)cases[d].hash;
 		}
 	}
 
+	// a dense table is two bytes a slot against six for a hashed
+	// bucket, so it is never larger as long as a third are used
+	int64_t span = (int64_t)high - (int64_t)low + 1;
+	bool dense = (span < 0x7FFF) && (span <= (int64_t)labels*3);
+
 	// first try the easy way
 
 	++size;
@@ -5909,6 +8821,47 @@ bool WRCompilationContext::parseSwitch( WROpcode opcodeToReturn )
 			}
 		}
 	}
+	else if ( dense ) // cases are a tight run somewhere else, rebase them to 0
+	{
+		size = (unsigned int)span;
+
+		packbuf[0] = W_SwitchDense;
+		pushOpcode( m_units[m_unitTop].bytecode, O_Wide );
+		pushData( m_units[m_unitTop].bytecode, packbuf, 1 );
+		pushData( m_units[m_unitTop].bytecode, wr_pack32(low, packbuf), 4 );
+		pushData( m_units[m_unitTop].bytecode, wr_pack16(size, packbuf), 2 );
+
+		int currentPos = m_units[m_unitTop].bytecode.all.size();
+
+		if ( defaultOffset == -1 )
+		{
+			defaultOffset = size*2 + 2;
+		}
+		else
+		{
+			defaultOffset -= currentPos;
+		}
+
+		table = (WRSwitchCase *)g_malloc(size * sizeof(WRSwitchCase));
+		memset( table, 0, size*sizeof(WRSwitchCase) );
+
+		for( unsigned int c=0; c<cases.count(); ++c )
+		{
+			if ( cases[c].occupied && !cases[c].defaultCase )
+			{
+				uint32_t slot = cases[c].hash - (uint32_t)low;
+				table[slot].jumpOffset = cases[c].jumpOffset - currentPos;
+				table[slot].occupied = true;
+			}
+		}
+
+		pushData( m_units[m_unitTop].bytecode, wr_pack16(defaultOffset, packbuf), 2 );
+
+		for( unsigned int i=0; i<size; ++i )
+		{
+			pushData( m_units[m_unitTop].bytecode, wr_pack16(table[i].occupied ? table[i].jumpOffset : defaultOffset, packbuf), 2 );
+		}
+	}
 	else
 	{
 		pushOpcode( m_units[m_unitTop].bytecode, O_Switch ); // add switch command
@@ -6017,6 +8970,7 @@ bool WRCompilationContext::parseIf( WROpcode opcodeToReturn )
 	WRExpression nex( m_units[m_unitTop].bytecode.localSpace, m_units[m_unitTop].bytecode.isStructSpace );
 	nex.context[0].token = token;
 	nex.context[0].value = value;
+	nex.valueOnly = true;
 	m_loadedToken = token;
 	m_loadedValue = value;
 	m_loadedQuoted = m_quoted;
@@ -6027,23 +8981,59 @@ bool WRCompilationContext::parseIf( WROpcode opcodeToReturn )
 		return false;
 	}
 
-	appendBytecode( m_units[m_unitTop].bytecode, nex.bytecode );
+	// when the condition is a literal the side that can never run is
+	// still parsed, then thrown away
+	WRValue condition;
+	const bool known = m_optimize && literalValue(nex.bytecode, condition) && condition.type == WR_INT;
+	unsigned int mark = 0;
+	unsigned int targets = 0;
 
 	int conditionFalseMarker = addRelativeJumpTarget( m_units[m_unitTop].bytecode );
-	
-	addRelativeJumpSource( m_units[m_unitTop].bytecode, O_BZ, conditionFalseMarker );
+
+	if ( !known )
+	{
+		appendBytecode( m_units[m_unitTop].bytecode, nex.bytecode );
+		addRelativeJumpSource( m_units[m_unitTop].bytecode, O_BZ, conditionFalseMarker );
+	}
+	else if ( !condition.i )
+	{
+		m_units[m_unitTop].bytecode.invalidateOpcodeCache();
+		mark = m_units[m_unitTop].bytecode.all.size();
+		targets = m_units[m_unitTop].bytecode.jumpOffsetTargets.count();
+		addRelativeJumpSource( m_units[m_unitTop].bytecode, O_RelativeJump, conditionFalseMarker );
+	}
 
 	if ( !parseStatement(m_unitTop, ';', opcodeToReturn) )
 	{
 		return false;
 	}
 
+	const bool neverTrue = known
+						   && !condition.i
+						   && discardBytecode( m_units[m_unitTop].bytecode, mark, targets );
+
  	if ( !getToken(ex) )
 	{
 		setRelativeJumpTarget(m_units[m_unitTop].bytecode, conditionFalseMarker);
 	}
+	else if ( !m_quoted && token == "else" && neverTrue )
+	{
+		setRelativeJumpTarget( m_units[m_unitTop].bytecode, conditionFalseMarker );
+
+		if ( !parseStatement(m_unitTop, ';', opcodeToReturn) )
+		{
+			return false;
+		}
+	}
 	else if ( !m_quoted && token == "else" )
 	{
+		if ( known && condition.i )
+		{
+			m_units[m_unitTop].bytecode.invalidateOpcodeCache();
+			mark = m_units[m_unitTop].bytecode.all.size();
+			targets = m_units[m_unitTop].bytecode.jumpOffsetTargets.count();
+		}
+		
 		int conditionTrueMarker = addRelativeJumpTarget( m_units[m_unitTop].bytecode ); // when it hits here it will jump OVER this section
 
 		addRelativeJumpSource( m_units[m_unitTop].bytecode, O_RelativeJump, conditionTrueMarker );
@@ -6054,6 +9044,11 @@ bool WRCompilationContext::parseIf( WROpcode opcodeToReturn )
 		{
 			return false;
 		}
+
+		if ( known && condition.i )
+		{
+			discardBytecode( m_units[m_unitTop].bytecode, mark, targets );
+		}
 		
 		setRelativeJumpTarget( m_units[m_unitTop].bytecode, conditionTrueMarker );
 	}
@@ -6076,12 +9071,15 @@ bool WRCompilationContext::parseStatement( int unitIndex, char end, WROpcode opc
 	WRExpressionContext ex;
 	bool varSeen = false;
 	m_exportNextUnit = false;
+	const int block = openBlock();
 
 	for(;;)
 	{
 		WRstr& token = ex.token;
 //		WRValue& value = ex.value;
 
+		++m_statement;
+
 		if ( !getToken(ex) ) // if we run out of tokens that's fine as long as we were not waiting for a }
 		{
 			if ( end == '}' )
@@ -6109,7 +9107,25 @@ bool WRCompilationContext::parseStatement( int unitIndex, char end, WROpcode opc
 		
 		if ( !m_quoted && token == "{" )
 		{
-			return parseStatement( unitIndex, '}', opcodeToReturn );
+			const bool parsed = parseStatement( unitIndex, '}', opcodeToReturn );
+			m_block = block;
+			return parsed;
+		}
+
+		const bool unconditional = m_unconditional;
+		if ( !m_quoted
+			 && (token == "if"
+				 || token == "while"
+				 || token == "for"
+				 || token == "do"
+				 || token == "switch"
+				 || token == "break"
+				 || token == "continue"
+				 || token == "goto"
+				 || token == "return") )
+		{
+			m_straightLine = false; // anything after this might run more than once, or not at all
+			m_unconditional = false; // and anything in it might not run at all
 		}
 
 		if ( !m_quoted && token == "return" )
@@ -6129,6 +9145,7 @@ bool WRCompilationContext::parseStatement( int unitIndex, char end, WROpcode opc
 				WRExpression nex( m_units[unitIndex].bytecode.localSpace, m_units[unitIndex].bytecode.isStructSpace );
 				nex.context[0].token = token;
 				nex.context[0].value = ex.value;
+				nex.valueOnly = true;
 				m_loadedToken = token;
 				m_loadedValue = ex.value;
 				m_loadedQuoted = m_quoted;
@@ -6274,6 +9291,7 @@ bool WRCompilationContext::parseStatement( int unitIndex, char end, WROpcode opc
 			nex.context[0].varSeen = varSeen;
 			nex.context[0].token = token;
 			nex.context[0].value = ex.value;
+			nex.valueOnly = true;
 			nex.lValue = true;
 			m_loadedToken = token;
 			m_loadedValue = ex.value;
@@ -6287,16 +9305,23 @@ bool WRCompilationContext::parseStatement( int unitIndex, char end, WROpcode opc
 				return false;
 			}
 
-			appendBytecode( m_units[unitIndex].bytecode, nex.bytecode );
-			pushOpcode( m_units[unitIndex].bytecode, O_PopOne );
+			WRValue value;
+			if ( !m_optimize || !literalValue(nex.bytecode, value) ) // a value on its own does nothing
+			{
+				appendBytecode( m_units[unitIndex].bytecode, nex.bytecode );
+				pushOpcode( m_units[unitIndex].bytecode, O_PopOne );
+			}
 		}
 
+		m_unconditional = unconditional;
+
 		if ( end == ';' ) // single statement
 		{
 			break;
 		}
 	}
 
+	m_block = block;
 	return m_err ? false : true;
 }
 
@@ -6457,6 +9482,14 @@ void WRCompilationContext::createLocalHashMap( WRUnitContext& unit, unsigned cha
 		return;
 	}
 
+	if ( unit.bytecode.localSpace.count() > 255 )
+	{
+		m_err = WR_ERR_compiler_panic; // member offsets are 8-bit
+		*size = 0;
+		*buf = 0;
+		return;
+	}
+
 	WRHashTable<unsigned char> offsets;
 	for( unsigned char i=unit.arguments; i<unit.bytecode.localSpace.count(); ++i )
 	{
@@ -6496,28 +9529,84 @@ void WRCompilationContext::link( unsigned char** out, int* outLen, const uint8_t
 	uint8_t data[4];
 
 	NamespacePush *namespaceLookups = 0;
+	bool overflow = false;
+
+	for( unsigned int u=1; m_optimize && u<m_units.count(); ++u )
+	{
+		packFrame( u );
+	}
 
 	unsigned int globals = m_units[0].bytecode.localSpace.count();
-	if ( globals > 255 )
+	unsigned int functions = m_units.count() - 1;
+
+	// anything that doesn't fit in a byte moves the whole image to
+	// the wide format
+	bool wide = (compilerOptionFlags & WR_WIDE_BYTECODE) || globals > 255 || functions > 255;
+	for( unsigned int u=1; u<m_units.count(); ++u )
 	{
-		m_err = WR_ERR_compiler_panic;
-		return;
+		unsigned int frameSpaceNeeded = m_units[u].bytecode.localSpace.count() - m_units[u].arguments;
+		if ( 1 + m_units[u].arguments + frameSpaceNeeded > 255 )
+		{
+			wide = true;
+		}
+
+		if ( 1 + m_units[u].arguments + frameSpaceNeeded > 0xFFFF )
+		{
+			m_err = WR_ERR_compiler_panic;
+			return;
+		}
 	}
 
-	code += (uint8_t)globals; // globals count (for VM allocation)
-	if ( (m_units.count() - 1) > 255 )
+	if ( wide )
 	{
-		m_err = WR_ERR_compiler_panic;
-		return;
+		// the debugger's symbol table and codewords are 8-bit
+		if ( globals > 0xFFFF
+			 || functions > 0xFFFF
+			 || (compilerOptionFlags & (WR_EMBED_DEBUG_CODE | WR_EMBED_SOURCE_CODE)) )
+		{
+			m_err = WR_ERR_compiler_panic;
+			return;
+		}
+
+		code += (uint8_t)0; // zero globals/functions in the narrow slots
+		code += (uint8_t)0;
+		code += (uint8_t)(compilerOptionFlags | WR_WIDE_BYTECODE);
+		code.append( wr_pack16(globals, data), 2 );
+		code.append( wr_pack16(functions, data), 2 );
+	}
+	else
+	{
+		code += (uint8_t)globals; // globals count (for VM allocation)
+		code += (uint8_t)functions; // function count (for VM allocation)
+		code += (uint8_t)compilerOptionFlags;
 	}
-	code += (uint8_t)(m_units.count() - 1); // function count (for VM allocation)
-	code += (uint8_t)compilerOptionFlags;
 
 	// push function signatures
 	for( unsigned int u=1; u<m_units.count(); ++u )
 	{
 		m_units[u].offsetInBytecode = code.size(); // mark these two spots for later
 
+		unsigned int frameSpaceNeeded = m_units[u].bytecode.localSpace.count() - m_units[u].arguments;
+		unsigned int frameBaseAdjustment = 1 + m_units[u].arguments + frameSpaceNeeded;
+
+		if ( wide )
+		{
+			// WRFunction.namespaceOffset, WRFunction.functionOffset
+			code.append( wr_pack32(0, data), 4 ); // placeholder
+			code.append( wr_pack32(0, data), 4 ); // placeholder
+
+			// WRFunction.hash
+			code.append( wr_pack32(m_units[u].hash, data), 4 );
+
+			// WRFunction.arguments
+			code += (uint8_t)m_units[u].arguments;
+
+			// WRFunction.frameSpaceNeeded, WRFunction.frameBaseAdjustment
+			code.append( wr_pack16(frameSpaceNeeded, data), 2 );
+			code.append( wr_pack16(frameBaseAdjustment, data), 2 );
+			continue;
+		}
+
 		// WRFunction.namespaceOffset
 		data[0] = 0xAA;
 		data[1] = 0xBB;
@@ -6536,17 +9625,11 @@ void WRCompilationContext::link( unsigned char** out, int* outLen, const uint8_t
 		code.append( data, 1 );
 
 		// WRFunction.frameSpaceNeeded;
-		unsigned int frameSpaceNeeded = m_units[u].bytecode.localSpace.count() - m_units[u].arguments;
-		if ( frameSpaceNeeded > 255 )
-		{
-			m_err = WR_ERR_compiler_panic;
-			return;
-		}
 		data[1] = (uint8_t)frameSpaceNeeded;
 		code.append( data + 1, 1 );
 
 		// WRFunction.frameBaseAdjustment;
-		data[2] = 1 + data[0] + data[1];
+		data[2] = (uint8_t)frameBaseAdjustment;
 		code.append( data + 2, 1 );
 	}
 
@@ -6633,10 +9716,11 @@ void WRCompilationContext::link( unsigned char** out, int* outLen, const uint8_t
 	// append all the unit code
 	for( unsigned int u=0; u<m_units.count(); ++u )
 	{
-		uint16_t base;
+		unsigned int base;
 
 		if ( u > 0 ) // for the non-zero unit fill locations into the jump table
 		{
+			base = 0;
 			if ( m_units[u].exportNamespace )
 			{
 				base = code.size();
@@ -6644,6 +9728,10 @@ void WRCompilationContext::link( unsigned char** out, int* outLen, const uint8_t
 				int size = 0;
 				uint8_t* map = 0;
 				createLocalHashMap( m_units[u], &map, &size );
+				if ( m_err )
+				{
+					return;
+				}
 				
 				if ( size == 0 )
 				{
@@ -6651,21 +9739,28 @@ void WRCompilationContext::link( unsigned char** out, int* outLen, const uint8_t
 				}
 				m_units[u].offsetOfLocalHashMap = base;
 
-				wr_pack16( base, code.p_str(m_units[u].offsetInBytecode)); // WRFunction.namespaceOffset
-
 				WR_DUMP_LINK_OUTPUT(printf("<new> namespace\n%s\n", wr_asciiDump(map, size, str)));
 
 				code.append( map, size );
 				g_free( map );
 			}
+
+			if ( wide )
+			{
+				wr_pack32( base, code.p_str(m_units[u].offsetInBytecode) ); // WRFunction.namespaceOffset
+				wr_pack32( code.size(), code.p_str(m_units[u].offsetInBytecode + 4) ); // WRFunction.functionOffset
+			}
 			else
 			{
-				base = 0;
+				if ( code.size() > 0xFFFF )
+				{
+					overflow = true; // caught below, start over wide
+					break;
+				}
+				
 				wr_pack16( base, code.p_str(m_units[u].offsetInBytecode) ); // WRFunction.namespaceOffset
+				wr_pack16( code.size(), code.p_str(m_units[u].offsetInBytecode + 2) ); // WRFunction.functionOffset
 			}
-
-			base = code.size();
-			wr_pack16( base, code.p_str(m_units[u].offsetInBytecode + 2) ); // WRFunction.functionOffset
 		}
 
 		WR_DUMP_UNIT_OUTPUT(printf("unit %d:\n%s\n", u, wr_asciiDump(code, code.size(), str)));
@@ -6761,6 +9856,39 @@ void WRCompilationContext::link( unsigned char** out, int* outLen, const uint8_t
 							wr_pack16( codeword, (unsigned char *)code.p_str(index - 2) );
 						}
 
+						bool skip = code[index+5] == O_PopOne || code[index + 6] == O_NewObjectTable;
+
+						// the value is pushed and returned straight back,
+						// so the callee can take over this frame rather
+						// than stacking a new one on top of it
+						if ( !skip
+							 && code[index + 6] == O_Return
+							 && !m_addDebugSymbols
+							 && !m_units[u].bytecode.isStructSpace )
+						{
+							// [O_Wide][W_TailCall][args][index16][pad]
+							code[index+2] = code[index+1];
+							code[index] = O_Wide;
+							code[index+1] = W_TailCall;
+							wr_pack16( u2 - 1, code.p_str(index+3) );
+							code[index+5] = O_Return;
+							break;
+						}
+
+						if ( u2 - 1 > 255 )
+						{
+							// [O_Wide][sub-op][args][index16] then the push, if any
+							code[index+2] = code[index+1];
+							code[index] = O_Wide;
+							code[index+1] = skip ? W_CallFunctionByIndexSkip1 : W_CallFunctionByIndex;
+							wr_pack16( u2 - 1, code.p_str(index+3) );
+							if ( !skip )
+							{
+								code[index+5] = O_PushIndexFunctionReturnValue;
+							}
+							break;
+						}
+
 						code[index] = O_CallFunctionByIndex;
 
 						code[index+2] = (char)(u2 - 1);
@@ -6769,7 +9897,7 @@ void WRCompilationContext::link( unsigned char** out, int* outLen, const uint8_t
 						// r+2345 = hash
 						// r+6
 
-						if ( code[index+5] == O_PopOne || code[index + 6] == O_NewObjectTable)
+						if ( skip )
 						{
 							code[index+3] = 3; // skip past the pop, or TO the NewObjectTable
 						}
@@ -6809,15 +9937,27 @@ void WRCompilationContext::link( unsigned char** out, int* outLen, const uint8_t
 		}
 	}
 
-	// plug in namespace lookups
+	// plug in namespace lookups, wide code names the function rather
+	// than an offset that might not fit
 	while( namespaceLookups )
 	{
-		wr_pack16( m_units[namespaceLookups->unit].offsetOfLocalHashMap, code.p_str(namespaceLookups->location) );
+		if ( !overflow )
+		{
+			wr_pack16( wide ? (m_units[namespaceLookups->unit].offsetOfLocalHashMap ? namespaceLookups->unit : 0)
+							: m_units[namespaceLookups->unit].offsetOfLocalHashMap,
+					   code.p_str(namespaceLookups->location) );
+		}
 		NamespacePush* next = namespaceLookups->next;
 		g_free( namespaceLookups );
 		namespaceLookups = next;
 	}
 
+	if ( overflow )
+	{
+		link( out, outLen, compilerOptionFlags | WR_WIDE_BYTECODE );
+		return;
+	}
+
 	// append a CRC
 	uint32_t salted = wr_hash( code, code.size() );
 	salted += WRENCH_VERSION_MAJOR;
@@ -6905,6 +10045,7 @@ char WRCompilationContext::parseExpression( WRExpression& expression )
 		WRstr& token = expression.context[depth].token;
 
 		expression.context[depth].bytecode.clear();
+		expression.context[depth].resultType = -1;
 		expression.context[depth].setLocalSpace( expression.bytecode.localSpace, expression.bytecode.isStructSpace );
 		if ( !getToken(expression.context[depth]) )
 		{
@@ -7026,7 +10167,7 @@ char WRCompilationContext::parseExpression( WRExpression& expression )
 
 			if ( !m_quoted && token2 == ";" )
 			{
-				if ( !parseCallFunction(expression, functionName, depth, false) )
+				if ( !parseCallFunction(expression, functionName, depth, false, true) )
 				{
 					return 0;
 				}
@@ -7037,7 +10178,7 @@ char WRCompilationContext::parseExpression( WRExpression& expression )
 			}
 			else if ( !m_quoted && token2 == "(" )
 			{
-				if ( !parseCallFunction(expression, functionName, depth, true) )
+				if ( !parseCallFunction(expression, functionName, depth, true, true) )
 				{
 					return 0;
 				}
@@ -7057,7 +10198,7 @@ char WRCompilationContext::parseExpression( WRExpression& expression )
 			}
 			else if (!m_quoted && token2 == "{")
 			{
-				if ( !parseCallFunction(expression, functionName, depth, false) )
+				if ( !parseCallFunction(expression, functionName, depth, false, true) )
 				{
 					return 0;
 				}
@@ -7101,7 +10242,7 @@ char WRCompilationContext::parseExpression( WRExpression& expression )
 							break;
 						}
 
-						if ( !parseCallFunction(expression, functionName, depth, false) )
+						if ( !parseCallFunction(expression, functionName, depth, false, true) )
 						{
 							return 0;
 						}
@@ -7274,10 +10415,16 @@ char WRCompilationContext::parseExpression( WRExpression& expression )
 					expression.context[depth].bytecode = nex.bytecode;
 					operatorFound( WRstr("._exists"), expression.context, depth );
 				}
+				else if ( m_optimize && literalValue(nex.bytecode, expression.context[depth].value) )
+				{
+					// folded all the way down, so let it fold further
+					expression.context[depth].type = EXTYPE_LITERAL;
+				}
 				else
 				{
 					expression.context[depth].type = EXTYPE_BYTECODE_RESULT;
 					expression.context[depth].bytecode = nex.bytecode;
+					expression.context[depth].resultType = (nex.context.count() == 1) ? nex.context[0].resultType : -1;
 				}
 			}
 
@@ -7290,6 +10437,7 @@ char WRCompilationContext::parseExpression( WRExpression& expression )
 			WRExpression nex( expression.bytecode.localSpace, expression.bytecode.isStructSpace );
 			nex.context[0].token = token;
 			nex.context[0].value = value;
+			nex.valueOnly = true;
 
 			if ( parseExpression(nex) != ']' )
 			{
@@ -7356,6 +10504,8 @@ char WRCompilationContext::parseExpression( WRExpression& expression )
 				
 				if ( !m_quoted && token == ":" )
 				{
+					m_straightLine = false;
+					
 					uint32_t hash = wr_hashStr( label );
 					for( unsigned int i=0; i<expression.bytecode.jumpOffsetTargets.count(); ++i )
 					{
@@ -7478,6 +10628,20 @@ SOFTWARE.
 
 #define KEYHOLE_OPTIMIZER
 
+//------------------------------------------------------------------------------
+// [LLValues][a][b][IndexSkipLoad] was just put on the end of 'bytecode',
+// it is the pair dispatched most in anything that walks an array so
+// make it one instruction of the same size
+static void wr_fuseLLIndex( WRBytecode& bytecode )
+{
+	const int a = bytecode.all.size() - 4;
+	bytecode.all[a+3] = bytecode.all[a+2];
+	bytecode.all[a+2] = bytecode.all[a+1];
+	bytecode.all[a+1] = W_LLIndex;
+	bytecode.all[a] = O_Wide;
+	bytecode.opcodes[bytecode.opcodes.size() - 1] = O_Wide;
+}
+
 //------------------------------------------------------------------------------
 bool WRCompilationContext::CheckSkipLoad( WROpcode opcode, WRBytecode& bytecode, int a, int o )
 {
@@ -7489,6 +10653,10 @@ bool WRCompilationContext::CheckSkipLoad( WROpcode opcode, WRBytecode& bytecode,
 		bytecode.all[a] = opcode;
 		bytecode.opcodes.shave(2);
 		bytecode.opcodes += opcode;
+		if ( opcode == O_IndexSkipLoad )
+		{
+			wr_fuseLLIndex( bytecode );
+		}
 		return true;
 	}
 	else if ( bytecode.opcodes[o] == O_LoadFromGlobal
@@ -7651,6 +10819,7 @@ bool WRCompilationContext::CheckCompareReplace( WROpcode LS, WROpcode GS, WROpco
 			bytecode.all[ a - 6 ] = bytecode.opcodes[o];
 			bytecode.all[ a - 1 ] = ILS;
 
+			bytecode.opcodes[o-1] = bytecode.opcodes[o]; // the literal comes first now
 			bytecode.opcodes[o] = ILS; // reverse the logic
 
 			return true;
@@ -7661,6 +10830,7 @@ bool WRCompilationContext::CheckCompareReplace( WROpcode LS, WROpcode GS, WROpco
 			bytecode.all[ a - 2 ] = O_LiteralZero;
 			bytecode.all[ a ] = bytecode.all[ a - 1];
 			bytecode.all[ a - 1 ] = ILS;
+			bytecode.opcodes[o-1] = bytecode.opcodes[o]; // the literal comes first now
 			bytecode.opcodes[o] = ILS; // reverse the logic
 			return true;
 		}
@@ -7670,6 +10840,7 @@ bool WRCompilationContext::CheckCompareReplace( WROpcode LS, WROpcode GS, WROpco
 			bytecode.all[ a - 2 ] = O_LiteralZero;
 			bytecode.all[ a ] = bytecode.all[ a - 1];
 			bytecode.all[ a - 1 ] = ILS;
+			bytecode.opcodes[o-1] = bytecode.opcodes[o]; // the literal comes first now
 			bytecode.opcodes[o] = ILS; // reverse the logic
 			return true;
 		}
@@ -7682,6 +10853,7 @@ bool WRCompilationContext::CheckCompareReplace( WROpcode LS, WROpcode GS, WROpco
 			bytecode.all[ a - 1 ] = ILS;
 			bytecode.all[ a - 3 ] = O_LiteralInt8;
 
+			bytecode.opcodes[o-1] = bytecode.opcodes[o]; // the literal comes first now
 			bytecode.opcodes[o] = ILS; // reverse the logic
 			return true;
 		}
@@ -7696,6 +10868,7 @@ bool WRCompilationContext::CheckCompareReplace( WROpcode LS, WROpcode GS, WROpco
 			bytecode.all[ a - 1 ] = ILS;
 			bytecode.all[ a - 4 ] = O_LiteralInt16;
 
+			bytecode.opcodes[o-1] = bytecode.opcodes[o]; // the literal comes first now
 			bytecode.opcodes[o] = ILS; // reverse the logic
 			return true;
 		}
@@ -8789,8 +11962,10 @@ void WRCompilationContext::appendBytecode( WRBytecode& bytecode, WRBytecode& add
 	// add the namespace, making sure to offset it into the new block properly
 	for (unsigned int n = 0; n < addMe.localSpace.count(); ++n)
 	{
-		unsigned int m = 0;
-		for (m = 0; m < bytecode.localSpace.count(); ++m)
+		// expressions start from a copy of the space they are appended
+		// to, so the same slot is almost always the match
+		unsigned int m = (n < bytecode.localSpace.count() && bytecode.localSpace[n].hash == addMe.localSpace[n].hash) ? n : 0;
+		for ( ; m < bytecode.localSpace.count(); ++m)
 		{
 			if (bytecode.localSpace[m].hash == addMe.localSpace[n].hash)
 			{
@@ -8932,6 +12107,7 @@ void WRCompilationContext::appendBytecode( WRBytecode& bytecode, WRBytecode& add
 
 			bytecode.opcodes += O_LoadFromLocal;
 			bytecode.opcodes += O_IndexSkipLoad;
+			wr_fuseLLIndex( bytecode );
 			return;
 		}
 		else if ( bytecode.opcodes[bytecode.opcodes.size() - 1] == O_LoadFromGlobal
@@ -8997,7 +12173,16 @@ void WRCompilationContext::appendBytecode( WRBytecode& bytecode, WRBytecode& add
 				bytecode.all[o + 2] = bytecode.all[o + 1];
 				bytecode.all[o + 1] = bytecode.all[o + 6];
 
+				// remember it (and the one before it) only so swapWithTop()
+				// can tell when it has been handed two in a row
+				const bool pair = bytecode.opcodes.size() > 2
+								  && bytecode.opcodes[ bytecode.opcodes.size() - 3 ] == O_LocalIndexHash;
 				bytecode.opcodes.clear();
+				if ( pair )
+				{
+					bytecode.opcodes += O_LocalIndexHash;
+				}
+				bytecode.opcodes += O_LocalIndexHash;
 				bytecode.all.shave(1);
 			}
 			else if (bytecode.opcodes.size() > 1
@@ -9690,7 +12875,8 @@ SOFTWARE.
 //------------------------------------------------------------------------------
 int WRGCObject::init( const unsigned int size, const WRGCObjectType type, bool clear )
 {
-	int ret = (m_size = size);
+	int ret = (m_capacity = m_size = size);
+	m_head = 0;
 
 	if ( (m_type = type) == SV_VALUE )
 	{
@@ -9699,7 +12885,7 @@ int WRGCObject::init( const unsigned int size, const WRGCObjectType type, bool c
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
 		if ( !m_Vdata )
 		{
-			m_size = 0;
+			m_capacity = m_size = 0;
 			g_mallocFailed = true;
 			return 0;
 		}
@@ -9710,51 +12896,49 @@ int WRGCObject::init( const unsigned int size, const WRGCObjectType type, bool c
 			memset( m_SCdata, 0, ret );
 		}
 	}
-	else if ( m_type == SV_CHAR )
+	else if ( m_type > SV_VALUE )
 	{
-		m_Cdata = (unsigned char*)g_malloc( size );
+		// chars and the packed numeric types
+		ret *= WR_SIZEOF_ELEMENT( m_type );
+		m_Cdata = (unsigned char*)g_malloc( ret );
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
 		if ( !m_Cdata )
 		{
-			m_size = 0;
+			m_capacity = m_size = 0;
 			g_mallocFailed = true;
 			return 0;
 		}
 #endif
 		if ( clear )
 		{
-			memset( m_SCdata, 0, size );
+			memset( m_SCdata, 0, ret );
 		}
 	}
 	else
 	{
-		growHash( WRENCH_NULL_HASH, size, &ret );
+		// empty tables don't allocate until the first key goes in
+		m_capacity = m_size = 0;
+		m_Vdata = 0;
+		m_hashTable = 0;
+		ret = size ? growHash( size ) : 0;
 	}
 
 	return ret;
 }
 
+//------------------------------------------------------------------------------
+// int keys are their own hash, fold the high half down so keys that
+// differ only up there don't all land on the same slot. small ints
+// stay in order, which is the common case and the cheapest to probe
+static inline uint32_t wr_hashSlot( uint32_t hash )
+{
+	return hash ^ (hash >> 16);
+}
+
 //------------------------------------------------------------------------------
 WRValue* WRGCObject::getAsRawValueHashTable( const uint32_t hash, int* index )
 {
-#ifdef WRENCH_COMPACT
-	int i = getIndexOfHit( hash, false );
-#else
-	int i = hash % m_mod;
-	if ( m_hashTable[i] != hash )
-	{
-		if ( m_hashTable[(i = (i + 1) % m_mod)] != hash )
-		{
-			if ( m_hashTable[(i = (i + 1) % m_mod)] != hash )
-			{
-				if ( m_hashTable[(i = (i + 1) % m_mod)] != hash )
-				{
-					i = getIndexOfHit(hash, true);
-				}
-			}
-		}
-	}
-#endif
+	int i = getIndexOfHit( hash );
 
 	if ( index ) { *index = i; }
 	return m_Vdata + i;
@@ -9763,33 +12947,49 @@ WRValue* WRGCObject::getAsRawValueHashTable( const uint32_t hash, int* index )
 //------------------------------------------------------------------------------
 WRValue* WRGCObject::exists( const uint32_t hash, bool removeIfPresent )
 {
-	uint32_t index = hash % m_mod;
-
-	if ( m_hashTable[index] != hash )
+	uint32_t* slot = findSlot( hash );
+	if ( !slot )
 	{
-		int tries = 3;
-		do
-		{
-			index = (index + 1) % m_mod;
-			if ( m_hashTable[index] == hash )
-			{
-				goto foundExists;
-			}
-
-		} while( tries-- );
-
 		return 0;
 	}
 
-foundExists:
+	const uint32_t entry = *slot - 1;
+	WRValue* ret = m_Vdata + ((m_type == SV_HASH_TABLE) ? (entry << 1) : entry);
 
 	if ( removeIfPresent )
 	{
+		// pull the rest of the run back over the hole instead of
+		// leaving a tombstone
+		const uint32_t mask = (m_capacity << 1) - 1;
+		uint32_t* slots = m_hashTable + m_capacity;
+		uint32_t s = (uint32_t)(slot - slots) >> 1;
+		for(;;)
+		{
+			uint32_t* next = slots + (((s + 1) & mask) << 1);
+			if ( !next[0] || !(((s + 1) - wr_hashSlot(next[1])) & mask) )
+			{
+				break;
+			}
+
+			slots[s<<1] = next[0];
+			slots[(s<<1) + 1] = next[1];
+			s = (s + 1) & mask;
+		}
+		slots[s<<1] = 0;
+
+		// the entry goes on the free list
+		m_hashTable[entry] = WRENCH_NULL_HASH;
+		if ( m_type == SV_HASH_TABLE )
+		{
+			ret[1].init();
+		}
+		ret->p2 = INIT_AS_INT;
+		ret->ui = m_head;
+		m_head = entry + 1;
 		--m_size;
-		m_hashTable[index] = WRENCH_NULL_HASH;
 	}
 
-	return m_Vdata + ((m_type == SV_HASH_TABLE) ? (index << 1) : index);
+	return ret;
 }
 
 //------------------------------------------------------------------------------
@@ -9798,13 +12998,13 @@ void* WRGCObject::get( const uint32_t l, int* index )
 	int s = l < m_size ? l : m_size - 1;
 	void* ret = m_Vdata + s;
 
-	if ( m_type == SV_CHAR )
+	if ( m_type > SV_VALUE )
 	{
-		ret = m_Cdata + s;
+		ret = m_Cdata + s*WR_SIZEOF_ELEMENT( m_type );
 	}
 	else if ( m_type == SV_HASH_TABLE )
 	{
-		s = getIndexOfHit(l, false) << 1;
+		s = getIndexOfHit(l) << 1;
 		ret = m_Vdata + s;
 	}
 	else if ( m_type == SV_VOID_HASH_TABLE )
@@ -9818,171 +13018,178 @@ void* WRGCObject::get( const uint32_t l, int* index )
 }
 
 //------------------------------------------------------------------------------
-uint32_t WRGCObject::getIndexOfHit( const uint32_t hash, const bool inserting )
+uint32_t* WRGCObject::findSlot( const uint32_t hash )
 {
-	uint32_t index = hash % m_mod;
-	if ( m_hashTable[index] == hash )
+	if ( !m_capacity )
 	{
-		return index; // immediate hits should be cheap
+		return 0;
 	}
 
-	int tries = 3;
-	do
+	const uint32_t mask = (m_capacity << 1) - 1;
+	uint32_t* slots = m_hashTable + m_capacity;
+	uint32_t s = wr_hashSlot( hash ) & mask;
+
+	for( uint32_t distance = 0; slots[s<<1]; ++distance, s = (s + 1) & mask )
 	{
-		if ( inserting && m_hashTable[index] == WRENCH_NULL_HASH )
+		const uint32_t h = slots[(s<<1) + 1];
+		if ( h == hash )
 		{
-			++m_size;
-			m_hashTable[index] = hash;
-			return index;
+			return slots + (s<<1);
 		}
 
-		index = (index + 1) % m_mod;
-
-		if ( m_hashTable[index] == hash )
+		// if it were any further along it would have displaced this one
+		if ( ((s - wr_hashSlot(h)) & mask) < distance )
 		{
-			return index;
+			break;
 		}
+	}
 
-	} while( tries-- );
-
-	return inserting ? growHash(hash) : getIndexOfHit( hash, true );
+	return 0;
 }
 
 //------------------------------------------------------------------------------
-uint32_t WRGCObject::growHash( const uint32_t hash, const uint16_t sizeHint, int* sizeAllocated )
+void WRGCObject::addSlot( uint32_t s, uint32_t distance, uint32_t carry, uint32_t hash )
 {
-	// there was a collision with the passed hash, grow until the
-	// collision disappears
+	const uint32_t mask = (m_capacity << 1) - 1;
+	uint32_t* slots = m_hashTable + m_capacity;
 
-	uint16_t start = (sizeHint > m_mod) ? sizeHint : m_mod;
-	int t = 0;
-	for( ; c_primeTable[t] <= start ; ++t );
-
-	for(;;)
+	for( ; slots[s<<1]; ++distance, s = (s + 1) & mask )
 	{
-tryAgain:
-		int newMod = c_primeTable[t];
-
-		int newSize;
-		if ( m_type == SV_VOID_HASH_TABLE )
-		{
-			newSize = newMod;
-		}
-		else
+		// robin hood, take the slot from anything closer to its home
+		const uint32_t theirs = (s - wr_hashSlot(slots[(s<<1) + 1])) & mask;
+		if ( theirs < distance )
 		{
-			newSize = newMod << 1;
+			const uint32_t swapEntry = slots[s<<1];
+			const uint32_t swapHash = slots[(s<<1) + 1];
+			slots[s<<1] = carry;
+			slots[(s<<1) + 1] = hash;
+			carry = swapEntry;
+			hash = swapHash;
+			distance = theirs;
 		}
+	}
+
+	slots[s<<1] = carry;
+	slots[(s<<1) + 1] = hash;
+}
+
+//------------------------------------------------------------------------------
+uint32_t WRGCObject::getIndexOfHit( const uint32_t hash )
+{
+	uint32_t s = 0;
+	uint32_t distance = 0;
 
-		newSize *= sizeof(WRValue);
-		newSize += sizeof(WRGCBase);
-	
-		int total = newMod*sizeof(uint32_t) + newSize;
-		if ( sizeAllocated )
+	if ( m_capacity )
+	{
+		// same walk as findSlot(), but a miss leaves off exactly where
+		// the new key belongs
+		const uint32_t mask = (m_capacity << 1) - 1;
+		uint32_t* slots = m_hashTable + m_capacity;
+		s = wr_hashSlot( hash ) & mask;
+
+		for( ; slots[s<<1]; ++distance, s = (s + 1) & mask )
 		{
-			*sizeAllocated = total;
+			const uint32_t h = slots[(s<<1) + 1];
+			if ( h == hash )
+			{
+				return slots[s<<1] - 1;
+			}
+
+			if ( ((s - wr_hashSlot(h)) & mask) < distance )
+			{
+				break;
+			}
 		}
+	}
 
-		WRGCBase* base = (WRGCBase*)g_malloc( total );
-#ifdef WRENCH_HANDLE_MALLOC_FAIL
-		if ( !base )
+	if ( !m_head )
+	{
+		if ( !growHash(m_capacity << 1) )
 		{
-			g_mallocFailed = true;
 			return 0; // congradulations, clobber this one. we're dying it doesn't matter.
 		}
-#endif
 
-		memset( (unsigned char *)base, 0, total );
+		s = wr_hashSlot( hash ) & ((m_capacity << 1) - 1);
+		distance = 0;
+	}
 
-		uint32_t* proposed = (uint32_t *)((char*)base + newSize);
+	// take the first free entry
+	const uint32_t entry = m_head - 1;
+	WRValue* V = m_Vdata + ((m_type == SV_HASH_TABLE) ? (entry << 1) : entry);
+	m_head = V->ui;
+	V->init();
 
-		for( int n = 0; n<newMod; ++n )
-		{
-			proposed[n] = WRENCH_NULL_HASH;
-		}
+	m_hashTable[entry] = hash;
+	++m_size;
 
-		proposed[ hash % newMod ] = hash;
+	addSlot( s, distance, entry + 1, hash );
 
-		for( unsigned int h=0; h<m_mod; ++h )
-		{
-			int tries = 3;
-			int newEntry = m_hashTable[h] % newMod;
-			for(;;)
-			{
-				if ( proposed[newEntry] == WRENCH_NULL_HASH )
-				{
-					proposed[newEntry] = m_hashTable[h];
-					break;
-				}
-				else if ( tries-- )
-				{
-					newEntry = (newEntry + 1) % newMod;
-				}
-				else
-				{
-					g_free( base );
-					++t;
+	return entry;
+}
 
-					assert( (unsigned int)newMod != 49157 );
+//------------------------------------------------------------------------------
+int WRGCObject::growHash( const uint32_t capacity )
+{
+	// entries never move so existing entry indexes stay valid, there
+	// are always twice as many slots as entries
+	uint32_t newCapacity = 2;
+	while( newCapacity < capacity )
+	{
+		newCapacity <<= 1;
+	}
 
-					goto tryAgain;
-				}
-			}
-		}
+	const int per = (m_type == SV_HASH_TABLE) ? 2 : 1;
+	const int total = newCapacity * (per*sizeof(WRValue) + 5*sizeof(uint32_t));
 
-		// accepted, link it into the existing table
-		base->m_type = SV_HASH_INTERNAL;
+	WRValue* values = (WRValue*)g_malloc( total );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+	if ( !values )
+	{
+		g_mallocFailed = true;
+		return 0;
+	}
+#endif
 
-		base->m_nextGC = m_nextGC;
-		m_nextGC = base;
-		
-		WRValue* newValues = (WRValue*)(base + 1);
+	uint32_t* hashes = (uint32_t*)(values + newCapacity*per);
+	memset( (unsigned char*)(hashes + newCapacity), 0, newCapacity*4*sizeof(uint32_t) );
 
-		uint32_t* oldHashTable = m_hashTable;
-		m_hashTable = proposed;
-		int oldMod = m_mod;
-		m_mod = newMod;
+	const uint32_t oldCapacity = m_capacity;
+	if ( oldCapacity )
+	{
+		memcpy( (unsigned char*)values, (unsigned char*)m_Vdata, oldCapacity*per*sizeof(WRValue) );
+		memcpy( (unsigned char*)hashes, (unsigned char*)m_hashTable, oldCapacity*sizeof(uint32_t) );
+		g_free( m_Vdata );
+	}
 
-		for( int v=0; v<oldMod; ++v )
+	// the new entries go on the front of the free list, lowest first
+	for( uint32_t e = newCapacity; e > oldCapacity; )
+	{
+		--e;
+		WRValue* V = values + e*per;
+		if ( per == 2 )
 		{
-			if ( oldHashTable[v] == WRENCH_NULL_HASH )
-			{
-				continue;
-			}
-
-			unsigned int newPos = getIndexOfHit( oldHashTable[v], true );
-
-			if ( m_type == SV_VOID_HASH_TABLE )
-			{
-				newValues[newPos] = m_Vdata[v];
-				m_Vdata[v].r = newValues + newPos;
-				m_Vdata[v].p2 = INIT_AS_REF;
-			}
-			else
-			{
-				// copy all the new hashes to their new locations
-				WRValue* to = newValues + (newPos<<1);
-				WRValue* from = m_Vdata + (v<<1);
-
-				// value
-				to->p2 = from->p2;
-				to->p = from->p;
-				from->p2 = INIT_AS_REF;
-				from->r = to;
-
-				// key
-				++to;
-				++from;
-				to->p2 = from->p2;
-				to->p = from->p;
-				from->p2 = INIT_AS_REF;
-				from->r = to;
-			}
+			V[1].init();
 		}
+		V->p2 = INIT_AS_INT;
+		V->ui = m_head;
+		m_head = e + 1;
+		hashes[e] = WRENCH_NULL_HASH;
+	}
 
-		m_Vdata = newValues;
+	m_Vdata = values;
+	m_hashTable = hashes;
+	m_capacity = newCapacity;
 
-		return getIndexOfHit( hash, true );
+	const uint32_t mask = (newCapacity << 1) - 1;
+	for( uint32_t e=0; e<oldCapacity; ++e )
+	{
+		if ( hashes[e] != WRENCH_NULL_HASH )
+		{
+			addSlot( wr_hashSlot(hashes[e]) & mask, 0, e + 1, hashes[e] );
+		}
 	}
+
+	return total;
 }
 /*******************************************************************************
 Copyright (c) 2026 Curt Hartung -- curt.hartung@gmail.com
@@ -10010,8 +13217,113 @@ SOFTWARE.
 
 #include "wrench.h"
 
+#ifdef WRENCH_POOL_ALLOCATOR
+// every block is prefixed with one word: the free list link while it is
+// free, its size class while it is in use
+static const uint16_t c_poolClassSize[ WRENCH_POOL_CLASSES ] = { 64, 96, 128, 192, 256, 384 };
+
+//------------------------------------------------------------------------------
+void* wr_poolAlloc( WRState* w, const unsigned int bytes )
+{
+	const unsigned int needed = bytes + sizeof(void*);
+	unsigned int sizeClass = 0;
+	while( c_poolClassSize[sizeClass] < needed )
+	{
+		if ( ++sizeClass >= WRENCH_POOL_CLASSES )
+		{
+			return 0;
+		}
+	}
+
+	void** block = (void**)w->pool.freeList[sizeClass];
+	if ( !block )
+	{
+		// carve a new slab up into blocks of this class
+		void** slab = (void**)g_malloc( WRENCH_POOL_SLAB_SIZE );
+		if ( !slab )
+		{
+			return 0; // let the caller try the global allocator
+		}
+
+		*slab = w->pool.slabs;
+		w->pool.slabs = slab;
+
+		const unsigned int size = c_poolClassSize[sizeClass];
+		for( unsigned int offset = sizeof(void*); offset + size <= WRENCH_POOL_SLAB_SIZE; offset += size )
+		{
+			block = (void**)((char*)slab + offset);
+			*block = w->pool.freeList[sizeClass];
+			w->pool.freeList[sizeClass] = block;
+		}
+	}
+
+	w->pool.freeList[sizeClass] = *block;
+	*(uintptr_t*)block = sizeClass;
+	return block + 1;
+}
+
+//------------------------------------------------------------------------------
+void wr_poolFree( WRState* w, void* mem )
+{
+	void** block = (void**)mem - 1;
+	uintptr_t sizeClass = *(uintptr_t*)block;
+
+	*block = w->pool.freeList[sizeClass];
+	w->pool.freeList[sizeClass] = block;
+}
+
+//------------------------------------------------------------------------------
+void wr_destroyPool( WRState* w )
+{
+	while( w->pool.slabs )
+	{
+		void* next = *(void**)w->pool.slabs;
+		g_free( w->pool.slabs );
+		w->pool.slabs = next;
+	}
+
+	memset( (char*)w->pool.freeList, 0, sizeof(w->pool.freeList) );
+}
+
+//------------------------------------------------------------------------------
+void wr_setPoolAllocator( WRState* w, const bool enable )
+{
+	// objects already allocated know where they came from, so this can
+	// be changed at any time
+	w->pool.enabled = enable;
+}
+#endif
+
+//------------------------------------------------------------------------------
+void WRContext::freeObject( WRGCBase* svb )
+{
+	svb->clear();
+
+#ifdef WRENCH_POOL_ALLOCATOR
+	if ( svb->m_flags & GCFlag_Pooled )
+	{
+		wr_poolFree( w, svb );
+		return;
+	}
+#endif
+
+	g_free( svb );
+}
+
+#ifdef WRENCH_GENERATIONAL_GC
+//------------------------------------------------------------------------------
+void WRContext::markBase( WRGCBase* svb )
+{
+	markContents( svb );
+	svb->m_flags |= GCFlag_Marked;
+}
+
+//------------------------------------------------------------------------------
+void WRContext::markContents( WRGCBase* svb )
+#else
 //------------------------------------------------------------------------------
 void WRContext::markBase( WRGCBase* svb )
+#endif
 {
 	if ( svb->m_type == SV_VALUE )
 	{
@@ -10024,11 +13336,7 @@ void WRContext::markBase( WRGCBase* svb )
 	}
 	else if ( svb->m_type == SV_HASH_TABLE )
 	{
-		// hash table points one WRGCBase size PAST the actual pointer,
-		// recover it and mark it
-		((WRGCBase*)(((WRGCObject*)svb)->m_Vdata) - 1)->m_flags |= GCFlag_Marked;
-
-		for( uint32_t i=0; i<((WRGCObject*)svb)->m_mod; ++i )
+		for( uint32_t i=0; i<((WRGCObject*)svb)->m_capacity; ++i )
 		{
 			if ( ((WRGCObject*)svb)->m_hashTable[i] != WRENCH_NULL_HASH )
 			{
@@ -10041,23 +13349,44 @@ void WRContext::markBase( WRGCBase* svb )
 	else if ( svb->m_type == SV_HASH_ENTRY )
 	{
 		// mark the referenced table so it is not collected
+#ifdef WRENCH_GENERATIONAL_GC
+		if ( !(((WRGCBase*)svb)->m_referencedTable->m_flags & gcSkipFlags) )
+#endif
 		((WRGCBase*)svb)->m_referencedTable->m_flags |= GCFlag_Marked;
 	}
 
+#ifndef WRENCH_GENERATIONAL_GC
 	svb->m_flags |= GCFlag_Marked;
+#endif
 }
 
 //------------------------------------------------------------------------------
 void WRContext::mark( WRValue* s )
 {
-	if ( IS_CONTAINER_MEMBER(s->xtype) && IS_EXARRAY_TYPE(s->r->xtype) )
+	if ( IS_CONTAINER_MEMBER(s->xtype) )
+	{
+		// we don't mark this type, but we might mark it's target, a
+		// hash table member refers to the table itself
+		if ( s->vb->m_type != SV_HASH_TABLE )
+		{
+			if ( IS_EXARRAY_TYPE(s->r->xtype) )
+			{
+				mark( s->r );
+			}
+			return;
+		}
+	}
+	else if ( !IS_EXARRAY_TYPE(s->xtype) )
 	{
-		// we don't mark this type, but we might mark it's target
-		mark( s->r );
 		return;
 	}
 
-	if ( !IS_EXARRAY_TYPE(s->xtype) || (s->va->m_flags & GCFlag_Marked) )
+#ifdef WRENCH_GENERATIONAL_GC
+	// a minor collection also stops at the old generation
+	if ( s->va->m_flags & gcSkipFlags )
+#else
+	if ( s->va->m_flags & GCFlag_Marked )
+#endif
 	{
 		return;
 	}
@@ -10067,6 +13396,156 @@ void WRContext::mark( WRValue* s )
 	markBase( s->vb );
 }
 
+#ifdef WRENCH_GENERATIONAL_GC
+//------------------------------------------------------------------------------
+void WRContext::remember( WRGCBase* svb )
+{
+	if ( rememberedCount >= rememberedSize )
+	{
+		uint32_t newSize = rememberedSize ? rememberedSize * 2 : 32;
+		WRGCBase** newList = (WRGCBase**)g_malloc( newSize * sizeof(WRGCBase*) );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+		if ( !newList )
+		{
+			// can't track it, the next collection will have to be a full one
+			g_mallocFailed = true;
+			gcPromoted = 0x80000000;
+			return;
+		}
+#endif
+		if ( remembered )
+		{
+			memcpy( (char*)newList, (char*)remembered, rememberedCount * sizeof(WRGCBase*) );
+			g_free( remembered );
+		}
+		remembered = newList;
+		rememberedSize = newSize;
+	}
+
+	svb->m_flags |= GCFlag_Remembered;
+	remembered[rememberedCount++] = svb;
+}
+
+//------------------------------------------------------------------------------
+bool WRContext::stackHoldsInteriorRefs( WRValue* stackTop )
+{
+	// a ref into a container's storage can be written through at any
+	// time, as long as one exists the container has to stay remembered
+	WRValue* globalSpace = (WRValue *)(this + 1);
+	WRValue* globalTop = globalSpace + globals;
+	WRValue* stackEnd = stack + w->stackSize;
+	
+	for( WRValue* s=stack; s<stackTop; ++s )
+	{
+		if ( IS_CONTAINER_MEMBER(s->xtype) )
+		{
+			return true;
+		}
+		
+		if ( s->type == WR_REF
+			 && (s->r < stack || s->r >= stackEnd)
+			 && (s->r < globalSpace || s->r >= globalTop) )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+void WRContext::minorGC( WRValue* stackTop )
+{
+	gcSkipFlags = GCFlag_Marked | GCFlag_Old;
+
+	WRGCBase* a;
+	for( a=svAllocated; a; a = a->m_nextGC )
+	{
+		if ( (a->m_flags & GCFlag_Perm) && !(a->m_flags & GCFlag_Marked) )
+		{
+			markBase( a );
+		}
+	}
+
+	for( WRValue* s=stack + stackOffset; s<stackTop; ++s)
+	{
+		mark( s );
+	}
+
+	WRValue* globalSpace = (WRValue *)(this + 1);
+	for( unsigned int i=0; i<globals; ++i, ++globalSpace )
+	{
+		mark( globalSpace );
+	}
+
+	// old containers that may have been handed young objects, they
+	// themselves are not marked since the sweep never sees them
+	uint32_t r;
+	for( r=0; r<rememberedCount; ++r )
+	{
+		markContents( remembered[r] );
+	}
+
+	const bool dirty = stackHoldsInteriorRefs( stackTop );
+
+	// sweep the nursery, everything that survives is promoted
+	WRGCBase* current = svAllocated;
+	while( current )
+	{
+		WRGCBase* next = current->m_nextGC;
+		
+		if ( current->m_flags & GCFlag_Marked )
+		{
+			current->m_flags = (current->m_flags & ~GCFlag_Marked) | GCFlag_Old;
+			current->m_nextGC = svOld;
+			svOld = current;
+			++gcPromoted;
+
+			// perms are roots and must always be scanned, and if the stack
+			// still refers into containers they may be written to later
+			if ( (current->m_flags & GCFlag_Perm)
+				 || (dirty && (current->m_type == SV_VALUE || current->m_type == SV_HASH_TABLE)) )
+			{
+				remember( current );
+			}
+		}
+		else
+		{
+			freeObject( current );
+		}
+
+		current = next;
+	}
+
+	svAllocated = 0;
+
+	if ( !dirty )
+	{
+		// nothing can write into the old generation without going
+		// through WR_GC_REMEMBER again
+		uint32_t keep = 0;
+		for( r=0; r<rememberedCount; ++r )
+		{
+			if ( remembered[r]->m_flags & GCFlag_Perm )
+			{
+				remembered[keep++] = remembered[r];
+			}
+			else
+			{
+				remembered[r]->m_flags &= ~GCFlag_Remembered;
+			}
+		}
+		rememberedCount = keep;
+	}
+}
+
+//------------------------------------------------------------------------------
+void wr_setGCMode( WRState* w, const WRGCMode mode )
+{
+	w->gcMode = (uint8_t)mode;
+}
+#endif
+
 //------------------------------------------------------------------------------
 void WRContext::gc( WRValue* stackTop )
 {
@@ -10077,6 +13556,31 @@ void WRContext::gc( WRValue* stackTop )
 
 	allocatedMemoryHint = 0;
 
+#ifdef WRENCH_GENERATIONAL_GC
+	if ( stackTop
+		 && w->gcMode == WR_GC_GENERATIONAL
+		 && gcPromoted < 1024 + (gcOldObjects >> 1) )
+	{
+		minorGC( stackTop );
+		return;
+	}
+
+	// a full collection folds the old generation back in
+	if ( svOld )
+	{
+		WRGCBase* tail = svOld;
+		while( tail->m_nextGC )
+		{
+			tail = tail->m_nextGC;
+		}
+		tail->m_nextGC = svAllocated;
+		svAllocated = svOld;
+		svOld = 0;
+	}
+
+	gcSkipFlags = GCFlag_Marked;
+#endif
+
 	// mark permenants
 	if ( stackTop ) // zero stacktop means collect EVERYTHING
 	{
@@ -10119,38 +13623,109 @@ void WRContext::gc( WRValue* stackTop )
 		// otherwise free it as unreferenced
 		else
 		{
-			current->clear();
-
 			if ( prev == 0 )
 			{
 				svAllocated = current->m_nextGC;
-				g_free( current );
+				freeObject( current );
 				current = svAllocated;
 			}
 			else
 			{
 				prev->m_nextGC = current->m_nextGC;
-				g_free( current );
+				freeObject( current );
 				current = prev->m_nextGC;
 			}
 		}
 	}
+
+#ifdef WRENCH_GENERATIONAL_GC
+	// the remembered set is rebuilt from the survivors, some entries
+	// may have just been freed
+	rememberedCount = 0;
+	gcPromoted = 0;
+	gcOldObjects = 0;
+
+	if ( stackTop && w->gcMode == WR_GC_GENERATIONAL )
+	{
+		const bool dirty = stackHoldsInteriorRefs( stackTop );
+		
+		for( current = svAllocated; current; current = current->m_nextGC )
+		{
+			current->m_flags = (current->m_flags & ~GCFlag_Remembered) | GCFlag_Old;
+			++gcOldObjects;
+
+			if ( (current->m_flags & GCFlag_Perm)
+				 || (dirty && (current->m_type == SV_VALUE || current->m_type == SV_HASH_TABLE)) )
+			{
+				remember( current );
+			}
+		}
+
+		svOld = svAllocated;
+		svAllocated = 0;
+	}
+	else
+	{
+		for( current = svAllocated; current; current = current->m_nextGC )
+		{
+			current->m_flags &= ~(GCFlag_Old | GCFlag_Remembered);
+		}
+	}
+#endif
 }
 
 //------------------------------------------------------------------------------
 WRGCObject* WRContext::getSVA( int size, WRGCObjectType type, bool init )
 {
-	WRGCObject* ret = (WRGCObject*)g_malloc( sizeof(WRGCObject) );
+	WRGCObject* ret;
 
-#ifdef WRENCH_HANDLE_MALLOC_FAIL
-	if ( !ret )
+#ifdef WRENCH_POOL_ALLOCATOR
+	const int bytes = size * WR_SIZEOF_ELEMENT( type );
+	
+	if ( w->pool.enabled
+		 && (int)type >= SV_VALUE
+		 && (ret = (WRGCObject*)wr_poolAlloc(w, sizeof(WRGCObject) + bytes)) )
+	{
+		// small enough for the payload to share the header's block
+		memset( (unsigned char*)ret, 0, sizeof(WRGCObject) );
+		ret->m_flags = GCFlag_Pooled | GCFlag_InlineData;
+		ret->m_type = type;
+		ret->m_capacity = ret->m_size = size;
+		ret->m_data = ret + 1;
+		if ( init )
+		{
+			memset( ret->m_SCdata, 0, bytes );
+		}
+
+		ret->m_nextGC = svAllocated;
+		svAllocated = ret;
+		ret->m_creatorContext = this;
+
+		allocatedMemoryHint += bytes + sizeof(WRGCObject);
+		return ret;
+	}
+
+	if ( w->pool.enabled && (ret = (WRGCObject*)wr_poolAlloc(w, sizeof(WRGCObject))) )
 	{
-		g_mallocFailed = true;
-		return 0;
+		memset( (unsigned char*)ret, 0, sizeof(WRGCObject) );
+		ret->m_flags = GCFlag_Pooled;
 	}
+	else
+#endif
+	{
+		ret = (WRGCObject*)g_malloc( sizeof(WRGCObject) );
+
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+		if ( !ret )
+		{
+			g_mallocFailed = true;
+			return 0;
+		}
 #endif
 
-	memset( (unsigned char*)ret, 0, sizeof(WRGCObject) );
+		memset( (unsigned char*)ret, 0, sizeof(WRGCObject) );
+	}
+
 	ret->m_nextGC = svAllocated;
 	svAllocated = ret;
 
@@ -10191,7 +13766,7 @@ SOFTWARE.
 #include "wrench.h"
 
 //------------------------------------------------------------------------------
-inline bool wr_getNextValue( WRValue* iterator, WRValue* value, WRValue* key )
+inline bool wr_getNextValue( WRContext* context, WRValue* iterator, WRValue* value, WRValue* key )
 {
 	if ( !IS_ITERATOR(iterator->xtype) )
 	{
@@ -10200,9 +13775,11 @@ inline bool wr_getNextValue( WRValue* iterator, WRValue* value, WRValue* key )
 
 	uint32_t element = DECODE_ARRAY_ELEMENT_FROM_P2( iterator->p2 );
 
+	WR_GC_REMEMBER( context, iterator->vb );
+
 	if ( iterator->va->m_type == SV_HASH_TABLE )
 	{
-		for( ; element<iterator->va->m_mod; ++element )
+		for( ; element<iterator->va->m_capacity; ++element )
 		{
 			if ( iterator->va->m_hashTable[element] != WRENCH_NULL_HASH )
 			{
@@ -10242,17 +13819,16 @@ inline bool wr_getNextValue( WRValue* iterator, WRValue* value, WRValue* key )
 			value->p2 = INIT_AS_REF;
 			value->r = iterator->va->m_Vdata + element;
 		}
-		else if ( iterator->va->m_type == SV_CHAR )
+		else if ( iterator->va->m_type > SV_VALUE )
 		{
-			value->p2 = INIT_AS_INT;
-			value->i = iterator->va->m_Cdata[element];
+			wr_unpackElement( iterator->va, element, value );
 		}
 		else
 		{
 			return false;
 		}
 
-		iterator->p2 = INIT_AS_ITERATOR | ENCODE_ARRAY_ELEMENT_TO_P2(++element);
+		iterator->p2 = INIT_AS_ITERATOR | ENCODE_ARRAY_ELEMENT_TO_P2(element + 1);
 	}
 
 	return true;
@@ -10268,7 +13844,12 @@ WRValue* wr_newObjectTable( WRContext* context, WRValue* stackTop, const uint8_t
 	}
 	else
 	{
-		uint32_t offset = READ_16_FROM_PC(pc);
+		uint32_t offset = (uint16_t)READ_16_FROM_PC(pc);
+		if ( (context->flags & WRC_Wide) && offset )
+		{
+			// wide bytecode names the function, offsets may not fit
+			offset = context->localFunctions[offset - 1].namespaceOffset;
+		}
 		table = context->bottom + offset;
 	}
 
@@ -10337,6 +13918,58 @@ static void dumpStack( const WRValue* bottom, const WRValue* top )
 
 #define DEBUG_PER_INSTRUCTION
 
+#ifdef WRENCH_OPCODE_PROFILE
+//------------------------------------------------------------------------------
+// pc is on the instruction about to be dispatched, pairs and triples
+// are in the order they ran so a taken jump, call or return joins two
+// instructions that are not next to each other in the bytecode
+static void wr_profileOpcode( WROpcodeProfile* p, const unsigned char* pc )
+{
+	const uint32_t code = (*pc == O_Wide) ? (uint32_t)O_LAST + pc[1] : (uint32_t)*pc;
+
+	++p->total;
+	++p->single[code];
+
+	if ( p->last[1] != WR_PROFILE_CODES )
+	{
+		++p->pair[ p->last[1]*WR_PROFILE_CODES + code ];
+
+		if ( p->last[0] != WR_PROFILE_CODES )
+		{
+			const uint32_t key = (p->last[0]*WR_PROFILE_CODES + p->last[1])*WR_PROFILE_CODES + code + 1;
+			for( uint32_t t = ((key * 2654435761u) >> 16) & (WR_PROFILE_TRIPLES - 1); ; t = (t + 1) & (WR_PROFILE_TRIPLES - 1) )
+			{
+				if ( p->triple[t].key == key )
+				{
+					++p->triple[t].count;
+					break;
+				}
+				else if ( p->triple[t].key == 0 )
+				{
+					if ( p->triplesUsed >= (WR_PROFILE_TRIPLES*3)/4 )
+					{
+						++p->lostTriples;
+					}
+					else
+					{
+						++p->triplesUsed;
+						p->triple[t].key = key;
+						p->triple[t].count = 1;
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	p->last[0] = p->last[1];
+	p->last[1] = code;
+}
+ #define PROFILE_DISPATCH wr_profileOpcode( w->opcodeProfile, pc )
+#else
+ #define PROFILE_DISPATCH
+#endif
+
 //------------------------------------------------------------------------------
 #ifdef WRENCH_PROTECT_STACK_FROM_OVERFLOW
 #define CHECK_STACK { if ( stackTop >= stackLimit ) { w->err = WR_ERR_stack_overflow; return 0; } }
@@ -10346,7 +13979,7 @@ static void dumpStack( const WRValue* bottom, const WRValue* top )
 
 //------------------------------------------------------------------------------
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
-  bool g_mallocFailed = false;
+  WR_THREAD_LOCAL bool g_mallocFailed = false;
   #define MALLOC_FAIL_CHECK {if( g_mallocFailed ) { w->err = WR_ERR_malloc_failed; g_mallocFailed = false; return 0; } }
 #else
   #define MALLOC_FAIL_CHECK
@@ -10379,6 +14012,13 @@ int wr_slicesUsedLastCall( WRState* w )
 #define CHECK_FORCE_YIELD
 #endif
 
+#if WRENCH_CALL_SITE_CACHE
+// pc is pointing at the function hash of a CallFunctionByHash[AndPop]
+#define LOOKUP_CALL_SITE const uint32_t siteOffset = (uint32_t)(pc - context->bottom); WRCallSiteCache* site = context->callSiteCache + (siteOffset & (WRENCH_CALL_SITE_CACHE - 1))
+#define CALL_SITE_HIT ( site->offset == siteOffset && site->generation == w->callSiteGeneration )
+#define CACHE_CALL_SITE( CCB, USR, WRF ) { site->offset = siteOffset; site->generation = w->callSiteGeneration; site->ccb = (CCB); site->usr = (void*)(USR); site->wrf = (WRF); }
+#endif
+
 //------------------------------------------------------------------------------
 #define WRENCH_JUMPTABLE_INTERPRETER
 #ifdef WRENCH_REALLY_COMPACT
@@ -10391,9 +14031,133 @@ int wr_slicesUsedLastCall( WRState* w )
 
 //------------------------------------------------------------------------------
 // FASTCONTINUE for when malloc could not have been called so no need to check
+#if defined(WRENCH_QUICKENING) && (!defined(WRENCH_JUMPTABLE_INTERPRETER) || defined(WRENCH_COMPACT))
+#undef WRENCH_QUICKENING
+#endif
+
+#ifdef WRENCH_QUICKENING
+ // the handler for the instruction at 'pc' is at threaded[pc - bottom],
+ // kept as a single biased address so dispatch is one load
+ #define DISPATCH goto **(const void* const*)(dispatchBias + (uintptr_t)(pc++) * sizeof(void*))
+
+ // threaded entry of the instruction whose opcode is LEN bytes behind pc
+ #define QUICK_SLOT( LEN ) (*(const void**)(dispatchBias + (uintptr_t)(pc - (LEN)) * sizeof(void*)))
+
+ // a reference is looked through once, the way the _R_ functions do
+ #define QUICK_TYPE( R ) ( (R)->type == WR_REF ? (R)->r->type : (R)->type )
+ #define QUICK_DEREF quick0 = register0->type == WR_REF ? register0->r : register0; quick1 = register1->type == WR_REF ? register1->r : register1
+
+ // on entry to a generic handler, remember which specialized handlers
+ // it could be replaced with
+ #define QUICK( LABEL ) { quickSlot = &QUICK_SLOT(1); quickII = &&LABEL##_II; quickFF = &&LABEL##_FF; }
+ #define QUICK_INT( LABEL ) { quickSlot = &QUICK_SLOT(1); quickII = &&LABEL##_II; quickFF = 0; }
+
+ // then once its operands are loaded, replace it if they agree
+ #define QUICKEN { const int quickTypes = (QUICK_TYPE(register0)<<2) | QUICK_TYPE(register1); if ( quickTypes == ((WR_INT<<2)|WR_INT) ) { *quickSlot = quickII; } else if ( quickTypes == ((WR_FLOAT<<2)|WR_FLOAT) && quickFF ) { *quickSlot = quickFF; } }
+ #define QUICKEN_ONE { if ( register0->type == WR_INT ) { *quickSlot = quickII; } else if ( register0->type == WR_FLOAT ) { *quickSlot = quickFF; } }
+
+ // specialized handlers look at their operands before consuming
+ // anything, so when the guess is wrong they can put the generic
+ // handler back and run it as if nothing happened
+ #define DEOPT( LABEL ) { QUICK_SLOT(1) = &&LABEL; goto LABEL; }
+ #define QUICK_INTS ( !(quick0->type | quick1->type) )
+ #define QUICK_FLOATS ( quick0->type == WR_FLOAT && quick1->type == WR_FLOAT )
+
+ // where the operands come from, and what it takes to consume them
+ #define QUICK_PEEK_LL register1 = frameBase + READ_8_FROM_PC(pc); register0 = frameBase + READ_8_FROM_PC(pc + 1)
+ #define QUICK_PEEK_GG register1 = globalSpace + READ_8_FROM_PC(pc); register0 = globalSpace + READ_8_FROM_PC(pc + 1)
+ #define QUICK_PEEK_GL register1 = frameBase + READ_8_FROM_PC(pc); register0 = globalSpace + READ_8_FROM_PC(pc + 1)
+ #define QUICK_PEEK_LG register1 = globalSpace + READ_8_FROM_PC(pc); register0 = frameBase + READ_8_FROM_PC(pc + 1)
+ #define QUICK_PEEK_LS register0 = frameBase + READ_8_FROM_PC(pc); register1 = stackTop - 1
+ #define QUICK_PEEK_GS register0 = globalSpace + READ_8_FROM_PC(pc); register1 = stackTop - 1
+ #define QUICK_PEEK_SS register0 = stackTop - 1; register1 = stackTop - 2
+ #define QUICK_TAKE_2 pc += 2
+ #define QUICK_TAKE_1 ++pc
+ #define QUICK_TAKE_1_POP ++pc; --stackTop
+ #define QUICK_TAKE_POP --stackTop
+ #define QUICK_TAKE_POP2 stackTop -= 2
+
+ #define QUICK_LT( A, B ) ((A) < (B))
+ #define QUICK_GT( A, B ) ((A) > (B))
+ #define QUICK_EQ( A, B ) ((A) == (B))
+ #define QUICK_AND( A, B ) ((A) && (B))
+ #define QUICK_OR( A, B ) ((A) || (B))
+ #define QUICK_IS( C ) ((int)(C))
+ #define QUICK_NOT( C ) ((int)!(C))
+ #define QUICK_BZ( C ) ((C) ? 2 : READ_16_FROM_PC(pc))
+ #define QUICK_BNZ( C ) ((C) ? READ_16_FROM_PC(pc) : 2)
+ #define QUICK_BZ8( C ) ((C) ? 2 : (int8_t)READ_8_FROM_PC(pc))
+ #define QUICK_BNZ8( C ) ((C) ? (int8_t)READ_8_FROM_PC(pc) : 2)
+
+ #define QUICK_ADD( A, B ) ((A) + (B))
+ #define QUICK_SUB( A, B ) ((A) - (B))
+ #define QUICK_MUL( A, B ) ((A) * (B))
+ #define QUICK_DIV( A, B ) ((A) / (B))
+ #define QUICK_MOD( A, B ) ((A) % (B))
+ #define QUICK_SHL( A, B ) ((A) << (B))
+ #define QUICK_SHR( A, B ) ((A) >> (B))
+ #define QUICK_BAND( A, B ) ((A) & (B))
+ #define QUICK_BOR( A, B ) ((A) | (B))
+ #define QUICK_BXOR( A, B ) ((A) ^ (B))
+
+ // division by zero is left to the generic handler
+ #define QUICK_ANY( V ) true
+ #define QUICK_NONZERO( V ) ((V) != 0)
+
+ // specialized handlers, each computes 'quick0 OP quick1' the same way
+ // the matching _I_I/_F_F function in operations does, register1 is
+ // still the slot a result replaces
+ #define QUICK_BRANCH( LABEL, PEEK, TAKE, ICMP, FCMP, BRANCH, NEXT ) \
+LABEL##_II: QUICK_PEEK_##PEEK; QUICK_DEREF; if ( !QUICK_INTS ) DEOPT( LABEL ); QUICK_TAKE_##TAKE; pc += BRANCH( ICMP(quick0->i, quick1->i) ); NEXT; \
+LABEL##_FF: QUICK_PEEK_##PEEK; QUICK_DEREF; if ( !QUICK_FLOATS ) DEOPT( LABEL ); QUICK_TAKE_##TAKE; pc += BRANCH( FCMP(quick0->f, quick1->f) ); NEXT;
+
+ #define QUICK_COMPARE( LABEL, PEEK, TAKE, ICMP, FCMP, RESULT ) \
+LABEL##_II: QUICK_PEEK_##PEEK; QUICK_DEREF; if ( !QUICK_INTS ) DEOPT( LABEL ); QUICK_TAKE_##TAKE; register1->i = RESULT( ICMP(quick0->i, quick1->i) ); register1->p2 = INIT_AS_INT; FASTCONTINUE; \
+LABEL##_FF: QUICK_PEEK_##PEEK; QUICK_DEREF; if ( !QUICK_FLOATS ) DEOPT( LABEL ); QUICK_TAKE_##TAKE; register1->i = RESULT( FCMP(quick0->f, quick1->f) ); register1->p2 = INIT_AS_INT; FASTCONTINUE;
+
+ #define QUICK_COMPARE_PUSH( LABEL, PEEK, ICMP, FCMP, RESULT ) \
+LABEL##_II: QUICK_PEEK_##PEEK; QUICK_DEREF; if ( !QUICK_INTS ) DEOPT( LABEL ); QUICK_TAKE_2; stackTop->i = RESULT( ICMP(quick0->i, quick1->i) ); (stackTop++)->p2 = INIT_AS_INT; CHECK_STACK; FASTCONTINUE; \
+LABEL##_FF: QUICK_PEEK_##PEEK; QUICK_DEREF; if ( !QUICK_FLOATS ) DEOPT( LABEL ); QUICK_TAKE_2; stackTop->i = RESULT( FCMP(quick0->f, quick1->f) ); (stackTop++)->p2 = INIT_AS_INT; CHECK_STACK; FASTCONTINUE;
+
+ #define QUICK_BINARY_PUSH( LABEL, PEEK, IOP, FOP, DIVISOR ) \
+LABEL##_II: QUICK_PEEK_##PEEK; QUICK_DEREF; if ( !QUICK_INTS || !DIVISOR(quick1->i) ) DEOPT( LABEL ); QUICK_TAKE_2; stackTop->p2 = INIT_AS_INT; (stackTop++)->i = IOP( quick0->i, quick1->i ); CHECK_STACK; FASTCONTINUE; \
+LABEL##_FF: QUICK_PEEK_##PEEK; QUICK_DEREF; if ( !QUICK_FLOATS || !DIVISOR(quick1->f) ) DEOPT( LABEL ); QUICK_TAKE_2; stackTop->p2 = INIT_AS_FLOAT; (stackTop++)->f = FOP( quick0->f, quick1->f ); CHECK_STACK; FASTCONTINUE;
+
+ #define QUICK_BINARY( LABEL, IOP, FOP, DIVISOR ) \
+LABEL##_II: QUICK_PEEK_SS; QUICK_DEREF; if ( !QUICK_INTS || !DIVISOR(quick1->i) ) DEOPT( LABEL ); QUICK_TAKE_POP; register1->i = IOP( quick0->i, quick1->i ); register1->p2 = INIT_AS_INT; FASTCONTINUE; \
+LABEL##_FF: QUICK_PEEK_SS; QUICK_DEREF; if ( !QUICK_FLOATS || !DIVISOR(quick1->f) ) DEOPT( LABEL ); QUICK_TAKE_POP; register1->f = FOP( quick0->f, quick1->f ); register1->p2 = INIT_AS_FLOAT; FASTCONTINUE;
+
+ #define QUICK_BINARY_STORE( LABEL, SPACE, IOP, FOP, DIVISOR ) \
+LABEL##_II: QUICK_PEEK_SS; QUICK_DEREF; if ( !QUICK_INTS || !DIVISOR(quick1->i) ) DEOPT( LABEL ); QUICK_TAKE_POP2; register2 = SPACE + READ_8_FROM_PC(pc++); register2->p2 = INIT_AS_INT; register2->i = IOP( quick0->i, quick1->i ); FASTCONTINUE; \
+LABEL##_FF: QUICK_PEEK_SS; QUICK_DEREF; if ( !QUICK_FLOATS || !DIVISOR(quick1->f) ) DEOPT( LABEL ); QUICK_TAKE_POP2; register2 = SPACE + READ_8_FROM_PC(pc++); register2->p2 = INIT_AS_FLOAT; register2->f = FOP( quick0->f, quick1->f ); FASTCONTINUE;
+
+ #define QUICK_INT_BINARY( LABEL, IOP ) \
+LABEL##_II: QUICK_PEEK_SS; QUICK_DEREF; if ( !QUICK_INTS ) DEOPT( LABEL ); QUICK_TAKE_POP; register1->i = IOP( quick0->i, quick1->i ); register1->p2 = INIT_AS_INT; FASTCONTINUE;
+
+ // the registers were loaded by the instruction before, in the
+ // opposite order
+ #define QUICK_INT_SKIPLOAD( LABEL, IOP ) \
+LABEL##_II: QUICK_DEREF; if ( !QUICK_INTS ) DEOPT( LABEL ); stackTop->p2 = INIT_AS_INT; (stackTop++)->i = IOP( quick1->i, quick0->i ); CHECK_STACK; FASTCONTINUE;
+
+ // a reference here is not looked through, wr_preinc_R replaces it
+ // with the value
+ #define QUICK_STEP( LABEL, SPACE, OP ) \
+LABEL##_II: register0 = SPACE + READ_8_FROM_PC(pc); if ( register0->type != WR_INT ) DEOPT( LABEL ); QUICK_TAKE_1; OP register0->i; FASTCONTINUE; \
+LABEL##_FF: register0 = SPACE + READ_8_FROM_PC(pc); if ( register0->type != WR_FLOAT ) DEOPT( LABEL ); QUICK_TAKE_1; OP register0->f; FASTCONTINUE;
+#else
+ #ifdef WRENCH_JUMPTABLE_INTERPRETER
+  #define DISPATCH goto *opcodeJumptable[READ_8_FROM_PC(pc++)]
+ #endif
+
+ #define QUICK( LABEL )
+ #define QUICK_INT( LABEL )
+ #define QUICKEN
+ #define QUICKEN_ONE
+#endif
+
 #ifdef WRENCH_JUMPTABLE_INTERPRETER
- #define CONTINUE { DEBUG_PER_INSTRUCTION; MALLOC_FAIL_CHECK; goto *opcodeJumptable[READ_8_FROM_PC(pc++)];  }
- #define FASTCONTINUE { DEBUG_PER_INSTRUCTION; goto *opcodeJumptable[READ_8_FROM_PC(pc++)];  }
+ #define CONTINUE { DEBUG_PER_INSTRUCTION; MALLOC_FAIL_CHECK; PROFILE_DISPATCH; DISPATCH; }
+ #define FASTCONTINUE { DEBUG_PER_INSTRUCTION; PROFILE_DISPATCH; DISPATCH; }
  #define CASE(LABEL) LABEL
 #else
  #define CONTINUE { DEBUG_PER_INSTRUCTION; MALLOC_FAIL_CHECK; continue; }
@@ -10456,6 +14220,64 @@ int16_t READ_16_FROM_PC_func( const unsigned char* P )
 
 #endif
 
+//------------------------------------------------------------------------------
+// what LocalIndexHash leaves in 'target' for 'value' and the hash at
+// 'pc', using the slot above 'target' for the index the way it does.
+// false if 'value' had to become a table and could not
+static bool wr_indexHashInto( WRContext* context, WRValue* value, WRValue* target, const unsigned char* pc )
+{
+	WRValue* index = target + 1;
+	index->ui = READ_32_FROM_PC(pc);
+	if ( !EXPECTS_HASH_INDEX(value->xtype) )
+	{
+		value->p2 = INIT_AS_HASH_TABLE;
+		value->va = context->getSVA( 0, SV_HASH_TABLE, false );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+		if ( !value->va )
+		{
+			return false;
+		}
+#endif
+		context->gc( index );
+	}
+
+#ifdef WRENCH_COMPACT
+	index->p2 = INIT_AS_INT;
+	wr_index[(WR_INT<<2)|value->type]( context, index, value, target );
+#else
+#if WRENCH_MEMBER_CACHE
+	if ( IS_STRUCT(value->xtype) )
+	{
+		const uint32_t siteOffset = (uint32_t)(pc + 4 - context->bottom);
+		WRMemberCache* site = context->memberCache + (siteOffset & (WRENCH_MEMBER_CACHE - 1));
+		if ( site->table != value->va->m_ROMHashTable || site->offset != siteOffset )
+		{
+			WRValue* member = wr_valueFromConfirmedStruct( value, index->ui );
+			if ( !member )
+			{
+				target->p2 = INIT_AS_INT;
+				target->r = 0;
+				return true;
+			}
+
+			site->table = value->va->m_ROMHashTable;
+			site->offset = siteOffset;
+			site->member = (uint32_t)(member - value->va->m_Vdata);
+		}
+
+		WR_GC_REMEMBER( context, value->vb );
+		target->r = value->va->m_Vdata + site->member;
+		target->p2 = INIT_AS_REF;
+		return true;
+	}
+#endif
+	index->p2 = INIT_AS_INT;
+	wr_doIndexHash( context, index, value, target );
+#endif
+
+	return true;
+}
+
 //------------------------------------------------------------------------------
 WRValue* wr_continue( WRContext* context )
 {
@@ -10472,7 +14294,9 @@ WRValue* wr_continue( WRContext* context )
 WRValue* wr_callFunction( WRContext* context, WRFunction* function, const WRValue* argv, const int argn )
 {
 #ifdef WRENCH_JUMPTABLE_INTERPRETER
-	const void* opcodeJumptable[] =
+	// static so it is laid down once at compile time rather than
+	// rebuilt on the stack every time a host calls in
+	static const void* const opcodeJumptable[] =
 	{
 		&&Yield,
 
@@ -10777,6 +14601,8 @@ WRValue* wr_callFunction( WRContext* context, WRFunction* function, const WRValu
 		&&LocalBZ8,
 		&&GlobalBZ,
 		&&GlobalBZ8,
+
+		&&Wide,
 	};
 #endif
 
@@ -10841,6 +14667,36 @@ WRValue* wr_callFunction( WRContext* context, WRFunction* function, const WRValu
 
 	w->err = WR_ERR_None;
 
+#ifdef WRENCH_QUICKENING
+	if ( !context->threaded )
+	{
+		// every byte gets the handler its value would dispatch to, only
+		// the ones that start an instruction are ever used
+		context->threaded = (const void**)g_malloc( context->bottomSize * sizeof(void*) );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+		if ( !context->threaded )
+		{
+			w->err = WR_ERR_malloc_failed;
+			return 0;
+		}
+#endif
+		for( int32_t b=0; b<context->bottomSize; ++b )
+		{
+			const uint8_t op = READ_8_FROM_PC( context->bottom + b );
+			context->threaded[b] = (op < sizeof(opcodeJumptable)/sizeof(opcodeJumptable[0])) ? opcodeJumptable[op] : 0;
+		}
+	}
+	const uintptr_t dispatchBias = (uintptr_t)context->threaded - (uintptr_t)context->bottom * sizeof(void*);
+#endif
+
+#ifdef WRENCH_QUICKENING
+	const void** quickSlot = 0;
+	const void* quickII = 0;
+	const void* quickFF = 0;
+	WRValue* quick0;
+	WRValue* quick1;
+#endif
+
 	WRValue* stackBase = context->stack + context->stackOffset;
 	WRValue* stackTop;
 #ifdef WRENCH_PROTECT_STACK_FROM_OVERFLOW
@@ -10890,7 +14746,12 @@ WRValue* wr_callFunction( WRContext* context, WRFunction* function, const WRValu
 		
 		pc = context->stopLocation;
 
-		context->gc( stackTop + 1 );
+		// hosts calling in per-event mostly find nothing to collect,
+		// don't leave the interpreter to find that out
+		if ( context->allocatedMemoryHint >= w->allocatedMemoryLimit )
+		{
+			context->gc( stackTop + 1 );
+		}
 
 		goto callFunction;
 	}
@@ -10909,6 +14770,7 @@ yieldContinue:
 
 	for(;;)
 	{
+		PROFILE_DISPATCH;
 		switch( READ_8_FROM_PC(pc++) )
 		{
 #endif
@@ -11035,6 +14897,22 @@ debugReturn:
 				register0 = stackTop->init();
 
 				uint32_t fhash = READ_32_FROM_PC(pc);
+#if WRENCH_CALL_SITE_CACHE
+				LOOKUP_CALL_SITE;
+				if ( CALL_SITE_HIT )
+				{
+					pc += 4;
+					if ( site->ccb )
+					{
+						site->ccb( context, stackTop - args, args, *stackTop, site->usr );
+						goto CallFunctionByHash_continue;
+					}
+
+					import = site->import;
+					function = site->wrf;
+					goto CallFunctionByHash_import;
+				}
+#endif
 				pc += 4;
 				if ( ! ((register1 = w->globalRegistry.getAsRawValueHashTable(fhash))->ccb) )
 				{
@@ -11043,33 +14921,38 @@ debugReturn:
 						while( import != context )
 						{
 							WRValue* I;
-								if ( (I = import->registry.exists(fhash, false)) )
+							if ( (I = wr_registry(import).exists(fhash, false)) )
+							{
+								function = I->wrf;
+#if WRENCH_CALL_SITE_CACHE
+								CACHE_CALL_SITE( 0, import, function );
+CallFunctionByHash_import:
+#endif
+								// import shares our stack, tell it where to find it's args
+								uint16_t savedOffset = import->stackOffset;
+								import->stackOffset = (uint16_t)(stackTop - context->stack);
+								register0 = wr_callFunction( import, function, stackTop - args, args );
+								import->stackOffset = savedOffset;
+								if ( import->yield_pc )
 								{
-									// import shares our stack, tell it where to find it's args
-									uint16_t savedOffset = import->stackOffset;
-									import->stackOffset = (uint16_t)(stackTop - context->stack);
-									register0 = wr_callFunction( import, I->wrf, stackTop - args, args );
-									import->stackOffset = savedOffset;
-									if ( import->yield_pc )
-									{
-										w->err = WR_ERR_cannot_call_function_context_yielded;
-										return 0;
-									}
-									if ( !register0 )
-									{
-										return 0;
-									}
-									register0 = stackTop;
+									w->err = WR_ERR_cannot_call_function_context_yielded;
+									return 0;
+								}
+								if ( !register0 )
+								{
+									return 0;
+								}
+								register0 = stackTop;
 
 								if ( *pc == O_NewObjectTable )
 								{
-									if ( !I->wrf->namespaceOffset )
+									if ( !function->namespaceOffset )
 									{
 										w->err = WR_ERR_struct_not_exported;
 										return 0;
 									}
 									
-									table = import->bottom + I->wrf->namespaceOffset;
+									table = import->bottom + function->namespaceOffset;
 									// so this was in service of a new
 									// ObjectTable. no problemo, find
 									// the actual table location and
@@ -11103,6 +14986,9 @@ debugReturn:
 				}
 				else
 				{
+#if WRENCH_CALL_SITE_CACHE
+					CACHE_CALL_SITE( register1->ccb, register1->usr, 0 );
+#endif
 					register1->ccb( context, stackTop - args, args, *stackTop, register1->usr );
 				}
 
@@ -11130,6 +15016,22 @@ newObjOut:
 				args = READ_8_FROM_PC(pc++);
 
 				uint32_t fhash = READ_32_FROM_PC(pc);
+#if WRENCH_CALL_SITE_CACHE
+				LOOKUP_CALL_SITE;
+				if ( CALL_SITE_HIT )
+				{
+					pc += 4;
+					if ( site->ccb )
+					{
+						site->ccb( context, stackTop - args, args, *stackTop, site->usr );
+						goto CallFunctionByHashAndPop_continue;
+					}
+
+					import = site->import;
+					function = site->wrf;
+					goto CallFunctionByHashAndPop_import;
+				}
+#endif
 				pc += 4;
 				if ( !((register1 = w->globalRegistry.getAsRawValueHashTable(fhash))->ccb) )
 				{
@@ -11138,24 +15040,29 @@ newObjOut:
 					{
 						while( import != context )
 						{
-								if ( (register0 = import->registry.exists(fhash, false)) )
+							if ( (register0 = wr_registry(import).exists(fhash, false)) )
+							{
+								function = register0->wrf;
+#if WRENCH_CALL_SITE_CACHE
+								CACHE_CALL_SITE( 0, import, function );
+CallFunctionByHashAndPop_import:
+#endif
+								// import shares our stack, tell it where to find it's args
+								uint16_t savedOffset = import->stackOffset;
+								import->stackOffset = (uint16_t)(stackTop - context->stack);
+								register0 = wr_callFunction( import, function, stackTop - args, args );
+								import->stackOffset = savedOffset;
+								if ( import->yield_pc )
 								{
-									// import shares our stack, tell it where to find it's args
-									uint16_t savedOffset = import->stackOffset;
-									import->stackOffset = (uint16_t)(stackTop - context->stack);
-									register0 = wr_callFunction( import, register0->wrf, stackTop - args, args );
-									import->stackOffset = savedOffset;
-									if ( import->yield_pc )
-									{
-										w->err = WR_ERR_cannot_call_function_context_yielded;
-										return 0;
-									}
-									if ( !register0 )
-									{
-										return 0;
-									}
-									goto CallFunctionByHashAndPop_continue;
+									w->err = WR_ERR_cannot_call_function_context_yielded;
+									return 0;
+								}
+								if ( !register0 )
+								{
+									return 0;
 								}
+								goto CallFunctionByHashAndPop_continue;
+							}
 
 							import = import->imported;
 						}
@@ -11166,6 +15073,9 @@ newObjOut:
 				}
 				else
 				{
+#if WRENCH_CALL_SITE_CACHE
+					CACHE_CALL_SITE( register1->ccb, register1->usr, 0 );
+#endif
 					register1->ccb( context, stackTop - args, args, *stackTop, register1->usr );
 				}
 
@@ -11214,8 +15124,8 @@ callFunction:
 				// initialize locals to int zero
 				for( int l=0; l<function->frameSpaceNeeded; ++l )
 				{
-					(stackTop++)->p2 = INIT_AS_INT;
 					stackTop->p = 0;
+					(stackTop++)->p2 = INIT_AS_INT;
 				}
 			
 				// temp value contains return vector/frame base
@@ -11323,6 +15233,7 @@ callFunction:
 				
 				if ( (uint32_t)READ_32_FROM_PC(table) == hash )
 				{
+					WR_GC_REMEMBER( context, register0->vb );
 					register2 = (((WRValue*)(register0->va->m_data)) + READ_8_FROM_PC(table + 4));
 					wr_assign[register2->type<<2|register1->type]( register2, register1 );
 				}
@@ -11342,6 +15253,7 @@ callFunction:
 				hash = READ_8_FROM_PC(pc++);
 				if ( IS_EXARRAY_TYPE(register0->xtype) && (hash < register0->va->m_size) )
 				{
+					WR_GC_REMEMBER( context, register0->vb );
 					register0 = register0->va->m_Vdata + hash;
 #ifdef WRENCH_COMPACT
 					goto doAssignToLocalAndPop;
@@ -11380,12 +15292,10 @@ callFunction:
 							va->m_Vdata[move] = va->m_Vdata[move+1];
 						}
 					}
-					else if ( register0->va->m_type == SV_CHAR )
+					else if ( hash < va->m_size )
 					{
-						for( uint32_t move = hash; (move+1) < va->m_size; ++move )
-						{
-							va->m_Cdata[move] = va->m_Cdata[move+1];
-						}
+						const int size_of = WR_SIZEOF_ELEMENT( va->m_type );
+						memmove( va->m_Cdata + hash*size_of, va->m_Cdata + (hash + 1)*size_of, (va->m_size - hash - 1) * size_of );
 					}
 
 					--va->m_size;
@@ -11542,8 +15452,33 @@ hashIndexJump:
 #ifdef WRENCH_COMPACT
 				goto indexTempLiteralPostLoad;
 #else
+#if WRENCH_MEMBER_CACHE
+				if ( IS_STRUCT(register0->xtype) )
+				{
+					const uint32_t siteOffset = (uint32_t)(pc - context->bottom);
+					WRMemberCache* site = context->memberCache + (siteOffset & (WRENCH_MEMBER_CACHE - 1));
+					if ( site->table != register0->va->m_ROMHashTable || site->offset != siteOffset )
+					{
+						if ( !(register2 = wr_valueFromConfirmedStruct(register0, stackTop->ui)) )
+						{
+							(stackTop - 1)->p2 = INIT_AS_INT;
+							(stackTop - 1)->r = 0;
+							CONTINUE;
+						}
+
+						site->table = register0->va->m_ROMHashTable;
+						site->offset = siteOffset;
+						site->member = (uint32_t)(register2 - register0->va->m_Vdata);
+					}
+
+					WR_GC_REMEMBER( context, register0->vb );
+					(stackTop - 1)->r = register0->va->m_Vdata + site->member;
+					(stackTop - 1)->p2 = INIT_AS_REF;
+					CONTINUE;
+				}
+#endif
 				stackTop->p2 = INIT_AS_INT;
-				wr_doIndexHash( stackTop, register0, stackTop - 1);
+				wr_doIndexHash( context, stackTop, register0, stackTop - 1);
 				CONTINUE;
 #endif
 			}
@@ -11901,10 +15836,246 @@ load32ToTemp:
 				register1 = 0;
 NextIterator:
 				register2 = globalSpace + READ_8_FROM_PC(pc++);
-				pc += wr_getNextValue( register2, register0, register1) ? 2 : READ_16_FROM_PC(pc);
+NextIteratorLoaded:
+				pc += wr_getNextValue( context, register2, register0, register1) ? 2 : READ_16_FROM_PC(pc);
 				CHECK_FORCE_YIELD;
 				FASTCONTINUE;
 			}
+
+			CASE(Wide):
+			{
+				switch( READ_8_FROM_PC(pc++) )
+				{
+					case W_LoadFromLocal:
+					{
+						stackTop->p = frameBase + (uint16_t)READ_16_FROM_PC(pc);
+						pc += 2;
+						(stackTop++)->p2 = INIT_AS_REF;
+						CHECK_STACK;
+						FASTCONTINUE;
+					}
+
+					case W_LoadFromGlobal:
+					{
+						stackTop->p = globalSpace + (uint16_t)READ_16_FROM_PC(pc);
+						pc += 2;
+						(stackTop++)->p2 = INIT_AS_REF;
+						CHECK_STACK;
+						FASTCONTINUE;
+					}
+
+					case W_CallFunctionByIndex:
+					{
+						args = READ_8_FROM_PC(pc);
+						function = context->localFunctions + (uint16_t)READ_16_FROM_PC(pc + 1);
+						pc += 3;
+						goto callFunction;
+					}
+
+					case W_CallFunctionByIndexSkip1:
+					{
+						args = READ_8_FROM_PC(pc);
+						function = context->localFunctions + (uint16_t)READ_16_FROM_PC(pc + 1);
+						pc += 4;
+						goto callFunction;
+					}
+
+					case W_PushIterator:
+					{
+						register0 = ((READ_8_FROM_PC(pc) & 1) ? frameBase : globalSpace) + (uint16_t)READ_16_FROM_PC(pc + 1);
+						wr_pushIterator[register0->type]( register0, globalSpace + (uint16_t)READ_16_FROM_PC(pc + 3) );
+						pc += 5;
+						FASTCONTINUE;
+					}
+
+					case W_NextValueOrJump:
+					{
+						register0 = ((READ_8_FROM_PC(pc) & 1) ? frameBase : globalSpace) + (uint16_t)READ_16_FROM_PC(pc + 1);
+						register1 = 0;
+						register2 = globalSpace + (uint16_t)READ_16_FROM_PC(pc + 3);
+						pc += 5;
+						goto NextIteratorLoaded;
+					}
+
+					case W_NextKeyValueOrJump:
+					{
+						register1 = ((READ_8_FROM_PC(pc) & 1) ? frameBase : globalSpace) + (uint16_t)READ_16_FROM_PC(pc + 1);
+						register0 = ((READ_8_FROM_PC(pc) & 2) ? frameBase : globalSpace) + (uint16_t)READ_16_FROM_PC(pc + 3);
+						register2 = globalSpace + (uint16_t)READ_16_FROM_PC(pc + 5);
+						pc += 7;
+						goto NextIteratorLoaded;
+					}
+
+					case W_TailCall:
+					{
+						args = READ_8_FROM_PC(pc);
+						function = context->localFunctions + (uint16_t)READ_16_FROM_PC(pc + 1);
+
+						// the arguments were pushed right on top of this
+						// frame's return vector
+						register0 = stackTop - args - 1;
+
+						// anything still pointing into the frame that is
+						// about to be overwritten has to be resolved now
+						for( register1 = register0 + 1; register1 < stackTop; ++register1 )
+						{
+							while( (register1->type == WR_REF || (register1->type == WR_EX && IS_CONTAINER_MEMBER(register1->xtype)))
+								   && register1->r >= frameBase
+								   && register1->r < register0 )
+							{
+								*register1 = (register1->type == WR_REF) ? *register1->r : register1->deref();
+							}
+						}
+
+						// return to wherever this frame would have, the
+						// call below re-pushes the same vector
+						pc = context->bottom + register0->returnOffset;
+						register1 = frameBase;
+						frameBase = register0->frame;
+
+						for( int a=0; a<args; ++a )
+						{
+							register1[a] = register0[a + 1];
+						}
+						stackTop = register1 + args;
+
+						goto callFunction;
+					}
+
+					case W_PopToLocal:
+					{
+						// no deref, the local takes exactly what an
+						// argument slot would have
+						frameBase[(uint16_t)READ_16_FROM_PC(pc)] = *(--stackTop);
+						pc += 2;
+						FASTCONTINUE;
+					}
+
+					case W_SwitchDense:
+					{
+						// rebase so the lowest case is 0, anything below it
+						// wraps high and fails the same bounds check
+						hashLocInt = (--stackTop)->getHash() - (uint32_t)READ_32_FROM_PC(pc);
+						pc += 6; // point at default vector
+
+						if ( hashLocInt < (uint16_t)READ_16_FROM_PC(pc - 2) )
+						{
+							hashLoc = pc + (hashLocInt<<1) + 2;
+							pc += READ_16_FROM_PC( hashLoc );
+						}
+						else
+						{
+							pc += READ_16_FROM_PC( pc );
+						}
+						FASTCONTINUE;
+					}
+
+					// same operand order as the LLCompare/LSCompare
+					// forms, but both sides are known to be ints
+					case W_IntLLCompareLTBZ: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); pc += (register0->i < register1->i) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLLCompareLEBZ: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); pc += (register0->i <= register1->i) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLLCompareGTBZ: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); pc += (register0->i > register1->i) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLLCompareGEBZ: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); pc += (register0->i >= register1->i) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLLCompareEQBZ: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); pc += (register0->i == register1->i) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLLCompareNEBZ: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); pc += (register0->i != register1->i) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+
+					case W_IntLICompareLTBZ: { register0 = frameBase + READ_8_FROM_PC(pc++); pc += 2; pc += (register0->i < READ_16_FROM_PC(pc - 2)) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLICompareLEBZ: { register0 = frameBase + READ_8_FROM_PC(pc++); pc += 2; pc += (register0->i <= READ_16_FROM_PC(pc - 2)) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLICompareGTBZ: { register0 = frameBase + READ_8_FROM_PC(pc++); pc += 2; pc += (register0->i > READ_16_FROM_PC(pc - 2)) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLICompareGEBZ: { register0 = frameBase + READ_8_FROM_PC(pc++); pc += 2; pc += (register0->i >= READ_16_FROM_PC(pc - 2)) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLICompareEQBZ: { register0 = frameBase + READ_8_FROM_PC(pc++); pc += 2; pc += (register0->i == READ_16_FROM_PC(pc - 2)) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+					case W_IntLICompareNEBZ: { register0 = frameBase + READ_8_FROM_PC(pc++); pc += 2; pc += (register0->i != READ_16_FROM_PC(pc - 2)) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+
+					case W_IntLCountLTBZ: { register0 = frameBase + READ_8_FROM_PC(pc++); wr_countOfArrayElement( frameBase + READ_8_FROM_PC(pc++), stackTop ); pc += (register0->i < stackTop->i) ? 2 : READ_16_FROM_PC(pc); CHECK_FORCE_YIELD; FASTCONTINUE; }
+
+					case W_IntLLAddition: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); stackTop->i = wr_iadd_wrap( register0->i, register1->i ); (stackTop++)->p2 = INIT_AS_INT; CHECK_STACK; FASTCONTINUE; }
+					case W_IntLLSubtraction: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); stackTop->i = wr_isub_wrap( register0->i, register1->i ); (stackTop++)->p2 = INIT_AS_INT; CHECK_STACK; FASTCONTINUE; }
+					case W_IntLLMultiplication: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); stackTop->i = wr_imul_wrap( register0->i, register1->i ); (stackTop++)->p2 = INIT_AS_INT; CHECK_STACK; FASTCONTINUE; }
+
+					case W_FloatLLAddition: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); stackTop->f = register0->f + register1->f; (stackTop++)->p2 = INIT_AS_FLOAT; CHECK_STACK; FASTCONTINUE; }
+					case W_FloatLLSubtraction: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); stackTop->f = register0->f - register1->f; (stackTop++)->p2 = INIT_AS_FLOAT; CHECK_STACK; FASTCONTINUE; }
+					case W_FloatLLMultiplication: { register1 = frameBase + READ_8_FROM_PC(pc++); register0 = frameBase + READ_8_FROM_PC(pc++); stackTop->f = register0->f * register1->f; (stackTop++)->p2 = INIT_AS_FLOAT; CHECK_STACK; FASTCONTINUE; }
+					case W_FloatLLDivision:
+					{
+						register1 = frameBase + READ_8_FROM_PC(pc++);
+						register0 = frameBase + READ_8_FROM_PC(pc++);
+						if ( register1->f )
+						{
+							stackTop->f = register0->f / register1->f;
+						}
+						else
+						{
+#ifdef WRENCH_TRAP_DIVISION_BY_ZERO
+							w->err = WR_ERR_division_by_zero;
+							return 0;
+#else
+							stackTop->i = 0;
+#endif
+						}
+						(stackTop++)->p2 = INIT_AS_FLOAT;
+						CHECK_STACK;
+						FASTCONTINUE;
+					}
+
+					// the back edge of 'for( ...; i < n; ++i )', the
+					// IncLocal/RelativeJump/LLCompareLTBZ it replaces
+					// left the loop by falling out of the compare, so
+					// this falls through when it fails
+					case W_IncLocalLLCompareLT:
+					{
+						register1 = frameBase + READ_8_FROM_PC(pc++);
+						register0 = frameBase + READ_8_FROM_PC(pc++);
+#ifdef WRENCH_COMPACT
+						register2 = stackTop + 1;
+						register2->i = 1;
+						register2->p2 = INIT_AS_INT;
+						wr_FuncAssign[(register0->type<<2)|WR_INT]( register0, register2, wr_addI, addF );
+						pc += wr_Compare[(register0->type<<2)|register1->type]( register0, register1, CompareLTI, CompareLTF ) ? READ_16_FROM_PC(pc) : 2;
+#else
+						if ( register0->type == WR_INT && register1->type == WR_INT )
+						{
+							pc += (++register0->i < register1->i) ? READ_16_FROM_PC(pc) : 2;
+						}
+						else
+						{
+							wr_preinc[ register0->type ]( register0 );
+							pc += wr_CompareLT[(register0->type<<2)|register1->type]( register0, register1 ) ? READ_16_FROM_PC(pc) : 2;
+						}
+#endif
+						CHECK_FORCE_YIELD;
+						CONTINUE;
+					}
+
+					case W_LLIndex:
+					{
+						register0 = frameBase + READ_8_FROM_PC(pc++);
+						register1 = frameBase + READ_8_FROM_PC(pc++);
+						wr_index[(register0->type<<2)|register1->type]( context, register0, register1, stackTop++ );
+						CONTINUE;
+					}
+
+					// both members are looked up in the order they were
+					// written, then left the way the swap would have
+					case W_LLIndexHashPair:
+					{
+						if ( !wr_indexHashInto(context, &(frameBase + READ_8_FROM_PC(pc))->deref(), stackTop, pc + 1)
+							 || !wr_indexHashInto(context, &(frameBase + READ_8_FROM_PC(pc + 5))->deref(), stackTop + 1, pc + 6) )
+						{
+							CONTINUE;
+						}
+						pc += 10;
+
+						const WRValue swap = *stackTop;
+						*stackTop = *(stackTop + 1);
+						*(++stackTop) = swap;
+						++stackTop;
+						CONTINUE;
+					}
+				}
+
+				w->err = WR_ERR_unknown_opcode;
+				return 0;
+			}
 			
 			CASE(Switch):
 			{
@@ -12700,10 +16871,10 @@ compactCompareGG8:
 			CASE(PreDecrement): { register0 = stackTop - 1; wr_predec[ register0->type ]( register0 ); CONTINUE; }
 			CASE(PreIncrementAndPop): { register0 = --stackTop; wr_preinc[ register0->type ]( register0 ); CONTINUE; }
 			CASE(PreDecrementAndPop): { register0 = --stackTop; wr_predec[ register0->type ]( register0 ); CONTINUE; }
-			CASE(IncGlobal): { register0 = globalSpace + READ_8_FROM_PC(pc++); wr_preinc[ register0->type ]( register0 ); CONTINUE; }
-			CASE(DecGlobal): { register0 = globalSpace + READ_8_FROM_PC(pc++); wr_predec[ register0->type ]( register0 ); CONTINUE; }
-			CASE(IncLocal): { register0 = frameBase + READ_8_FROM_PC(pc++); wr_preinc[ register0->type ]( register0 ); CONTINUE; }
-			CASE(DecLocal): { register0 = frameBase + READ_8_FROM_PC(pc++); wr_predec[ register0->type ]( register0 ); CONTINUE; }
+			CASE(IncGlobal): { QUICK(IncGlobal); register0 = globalSpace + READ_8_FROM_PC(pc++); QUICKEN_ONE; wr_preinc[ register0->type ]( register0 ); CONTINUE; }
+			CASE(DecGlobal): { QUICK(DecGlobal); register0 = globalSpace + READ_8_FROM_PC(pc++); QUICKEN_ONE; wr_predec[ register0->type ]( register0 ); CONTINUE; }
+			CASE(IncLocal): { QUICK(IncLocal); register0 = frameBase + READ_8_FROM_PC(pc++); QUICKEN_ONE; wr_preinc[ register0->type ]( register0 ); CONTINUE; }
+			CASE(DecLocal): { QUICK(DecLocal); register0 = frameBase + READ_8_FROM_PC(pc++); QUICKEN_ONE; wr_predec[ register0->type ]( register0 ); CONTINUE; }
 
 			CASE(BLA):
 			{
@@ -12744,8 +16915,10 @@ compactCompareGG8:
 			
 			CASE(GGBinaryMultiplication):
 			{
+				QUICK(GGBinaryMultiplication);
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_MultiplyBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -12753,8 +16926,10 @@ compactCompareGG8:
 
 			CASE(GLBinaryMultiplication):
 			{
+				QUICK(GLBinaryMultiplication);
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_MultiplyBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -12762,8 +16937,10 @@ compactCompareGG8:
 
 			CASE(LLBinaryMultiplication):
 			{
+				QUICK(LLBinaryMultiplication);
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_MultiplyBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -12772,8 +16949,10 @@ compactCompareGG8:
 			
 			CASE(GGBinaryAddition):
 			{
+				QUICK(GGBinaryAddition);
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_AdditionBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -12781,8 +16960,10 @@ compactCompareGG8:
 
 			CASE(GLBinaryAddition):
 			{
+				QUICK(GLBinaryAddition);
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++); 
+				QUICKEN;
 				wr_AdditionBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -12790,8 +16971,10 @@ compactCompareGG8:
 
 			CASE(LLBinaryAddition):
 			{
+				QUICK(LLBinaryAddition);
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_AdditionBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -12800,8 +16983,10 @@ compactCompareGG8:
 			
 			CASE(GGBinarySubtraction):
 			{
+				QUICK(GGBinarySubtraction);
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_SubtractBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -12809,8 +16994,10 @@ compactCompareGG8:
 
 			CASE(GLBinarySubtraction):
 			{
+				QUICK(GLBinarySubtraction);
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_SubtractBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -12818,8 +17005,10 @@ compactCompareGG8:
 
 			CASE(LGBinarySubtraction):
 			{
+				QUICK(LGBinarySubtraction);
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_SubtractBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -12827,8 +17016,10 @@ compactCompareGG8:
 
 			CASE(LLBinarySubtraction):
 			{
+				QUICK(LLBinarySubtraction);
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				wr_SubtractBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop++ );
 				CHECK_STACK;
 				FASTCONTINUE;
@@ -12837,8 +17028,10 @@ compactCompareGG8:
 
 			CASE(GGBinaryDivision):
 			{
+				QUICK(GGBinaryDivision);
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 #ifdef WRENCH_TRAP_DIVISION_BY_ZERO
 				wr_DivideBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop );
 				if ( IS_INVALID(stackTop++->p2) )
@@ -12855,8 +17048,10 @@ compactCompareGG8:
 
 			CASE(GLBinaryDivision):
 			{
+				QUICK(GLBinaryDivision);
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 #ifdef WRENCH_TRAP_DIVISION_BY_ZERO
 				wr_DivideBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop );
 				if ( IS_INVALID(stackTop++->p2) )
@@ -12873,8 +17068,10 @@ compactCompareGG8:
 
 			CASE(LGBinaryDivision):
 			{
+				QUICK(LGBinaryDivision);
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 #ifdef WRENCH_TRAP_DIVISION_BY_ZERO
 				wr_DivideBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop );
 				if ( IS_INVALID(stackTop++->p2) )
@@ -12891,8 +17088,10 @@ compactCompareGG8:
 
 			CASE(LLBinaryDivision):
 			{
+				QUICK(LLBinaryDivision);
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 #ifdef WRENCH_TRAP_DIVISION_BY_ZERO
 				wr_DivideBinary[(register0->type<<2)|register1->type]( register0, register1, stackTop );
 				if ( IS_INVALID(stackTop++->p2) )
@@ -12908,19 +17107,21 @@ compactCompareGG8:
 			}
 
 			
-			CASE(LogicalAnd): { returnFunc = wr_LogicalAND; goto returnFuncNormal; }
-			CASE(LogicalOr): { returnFunc = wr_LogicalOR; goto returnFuncNormal; }
-			CASE(CompareLE): { returnFunc = wr_CompareGT; goto returnFuncInverted; }
-			CASE(CompareGE): { returnFunc = wr_CompareLT; goto returnFuncInverted; }
-			CASE(CompareGT): { returnFunc = wr_CompareGT; goto returnFuncNormal; }
-			CASE(CompareLT): { returnFunc = wr_CompareLT; goto returnFuncNormal; }
+			CASE(LogicalAnd): { QUICK(LogicalAnd); returnFunc = wr_LogicalAND; goto returnFuncNormal; }
+			CASE(LogicalOr): { QUICK(LogicalOr); returnFunc = wr_LogicalOR; goto returnFuncNormal; }
+			CASE(CompareLE): { QUICK(CompareLE); returnFunc = wr_CompareGT; goto returnFuncInverted; }
+			CASE(CompareGE): { QUICK(CompareGE); returnFunc = wr_CompareLT; goto returnFuncInverted; }
+			CASE(CompareGT): { QUICK(CompareGT); returnFunc = wr_CompareGT; goto returnFuncNormal; }
+			CASE(CompareLT): { QUICK(CompareLT); returnFunc = wr_CompareLT; goto returnFuncNormal; }
 			CASE(CompareEQ):
 			{
+				QUICK(CompareEQ);
 				returnFunc = wr_CompareEQ;
 returnFuncNormal:
 				register0 = --stackTop;
 returnFuncPostLoad:
 				register1 = stackTop - 1;
+				QUICKEN;
 				register1->i = (int)returnFunc[(register0->type<<2)|register1->type]( register0, register1 );
 				register1->p2 = INIT_AS_INT;
 				FASTCONTINUE;
@@ -12928,40 +17129,44 @@ returnFuncPostLoad:
 
 			CASE(CompareNE):
 			{
+				QUICK(CompareNE);
 				returnFunc = wr_CompareEQ;
 returnFuncInverted:
 				register0 = --stackTop;
 returnFuncInvertedPostLoad:
 				register1 = stackTop - 1;
+				QUICKEN;
 				register1->i = (int)!returnFunc[(register0->type<<2)|register1->type]( register0, register1 );
 				register1->p2 = INIT_AS_INT;
 				FASTCONTINUE;
 			}
 
-			CASE(GSCompareEQ): { register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareEQ; goto returnFuncPostLoad; }
-			CASE(GSCompareNE): { register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareEQ; goto returnFuncInvertedPostLoad; }
-			CASE(GSCompareGT): { register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareGT; goto returnFuncPostLoad; }
-			CASE(GSCompareLT): { register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareLT; goto returnFuncPostLoad; }
-			CASE(GSCompareGE): { register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareLT; goto returnFuncInvertedPostLoad; }
-			CASE(GSCompareLE): { register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareGT; goto returnFuncInvertedPostLoad; }
+			CASE(GSCompareEQ): { QUICK(GSCompareEQ); register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareEQ; goto returnFuncPostLoad; }
+			CASE(GSCompareNE): { QUICK(GSCompareNE); register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareEQ; goto returnFuncInvertedPostLoad; }
+			CASE(GSCompareGT): { QUICK(GSCompareGT); register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareGT; goto returnFuncPostLoad; }
+			CASE(GSCompareLT): { QUICK(GSCompareLT); register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareLT; goto returnFuncPostLoad; }
+			CASE(GSCompareGE): { QUICK(GSCompareGE); register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareLT; goto returnFuncInvertedPostLoad; }
+			CASE(GSCompareLE): { QUICK(GSCompareLE); register0 = globalSpace + READ_8_FROM_PC(pc++); returnFunc = wr_CompareGT; goto returnFuncInvertedPostLoad; }
 							   
-			CASE(LSCompareEQ): { register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareEQ; goto returnFuncPostLoad; }
-			CASE(LSCompareNE): { register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareEQ; goto returnFuncInvertedPostLoad; }
-			CASE(LSCompareGT): { register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareGT; goto returnFuncPostLoad; }
-			CASE(LSCompareLT): { register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareLT; goto returnFuncPostLoad; }
-			CASE(LSCompareGE): { register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareLT; goto returnFuncInvertedPostLoad; }
-			CASE(LSCompareLE): { register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareGT; goto returnFuncInvertedPostLoad; }
-
-			CASE(CompareBLE): { returnFunc = wr_CompareGT; goto returnFuncBInverted; }
-			CASE(CompareBGE): { returnFunc = wr_CompareLT; goto returnFuncBInverted; }
-			CASE(CompareBGT): { returnFunc = wr_CompareGT; goto returnFuncBNormal; }
-			CASE(CompareBLT): { returnFunc = wr_CompareLT; goto returnFuncBNormal; }
+			CASE(LSCompareEQ): { QUICK(LSCompareEQ); register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareEQ; goto returnFuncPostLoad; }
+			CASE(LSCompareNE): { QUICK(LSCompareNE); register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareEQ; goto returnFuncInvertedPostLoad; }
+			CASE(LSCompareGT): { QUICK(LSCompareGT); register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareGT; goto returnFuncPostLoad; }
+			CASE(LSCompareLT): { QUICK(LSCompareLT); register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareLT; goto returnFuncPostLoad; }
+			CASE(LSCompareGE): { QUICK(LSCompareGE); register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareLT; goto returnFuncInvertedPostLoad; }
+			CASE(LSCompareLE): { QUICK(LSCompareLE); register0 = frameBase + READ_8_FROM_PC(pc++); returnFunc = wr_CompareGT; goto returnFuncInvertedPostLoad; }
+
+			CASE(CompareBLE): { QUICK(CompareBLE); returnFunc = wr_CompareGT; goto returnFuncBInverted; }
+			CASE(CompareBGE): { QUICK(CompareBGE); returnFunc = wr_CompareLT; goto returnFuncBInverted; }
+			CASE(CompareBGT): { QUICK(CompareBGT); returnFunc = wr_CompareGT; goto returnFuncBNormal; }
+			CASE(CompareBLT): { QUICK(CompareBLT); returnFunc = wr_CompareLT; goto returnFuncBNormal; }
 			CASE(CompareBEQ):
 			{
+				QUICK(CompareBEQ);
 				returnFunc = wr_CompareEQ;
 returnFuncBNormal:
 				register0 = --stackTop;
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : READ_16_FROM_PC(pc);
 				CHECK_FORCE_YIELD;
 				FASTCONTINUE;
@@ -12969,25 +17174,29 @@ returnFuncBNormal:
 			
 			CASE(CompareBNE):
 			{
+				QUICK(CompareBNE);
 				returnFunc = wr_CompareEQ;
 returnFuncBInverted:
 				register0 = --stackTop;
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? READ_16_FROM_PC(pc) : 2;
 				CHECK_FORCE_YIELD;
 				FASTCONTINUE;
 			}
 			
-			CASE(CompareBLE8): { returnFunc = wr_CompareGT; goto returnFuncBInverted8; }
-			CASE(CompareBGE8): { returnFunc = wr_CompareLT; goto returnFuncBInverted8; }
-			CASE(CompareBGT8): { returnFunc = wr_CompareGT; goto returnFuncBNormal8; }
-			CASE(CompareBLT8): { returnFunc = wr_CompareLT; goto returnFuncBNormal8; }
+			CASE(CompareBLE8): { QUICK(CompareBLE8); returnFunc = wr_CompareGT; goto returnFuncBInverted8; }
+			CASE(CompareBGE8): { QUICK(CompareBGE8); returnFunc = wr_CompareLT; goto returnFuncBInverted8; }
+			CASE(CompareBGT8): { QUICK(CompareBGT8); returnFunc = wr_CompareGT; goto returnFuncBNormal8; }
+			CASE(CompareBLT8): { QUICK(CompareBLT8); returnFunc = wr_CompareLT; goto returnFuncBNormal8; }
 			CASE(CompareBEQ8):
 			{
+				QUICK(CompareBEQ8);
 				returnFunc = wr_CompareEQ;
 returnFuncBNormal8:
 				register0 = --stackTop;
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type << 2) | register1->type](register0, register1) ? 2 : (int8_t)READ_8_FROM_PC(pc);
 				CHECK_FORCE_YIELD;
 				FASTCONTINUE;
@@ -12995,10 +17204,12 @@ returnFuncBNormal8:
 			
 			CASE(CompareBNE8):
 			{
+				QUICK(CompareBNE8);
 				returnFunc = wr_CompareEQ;
 returnFuncBInverted8:
 				register0 = --stackTop;
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? (int8_t)READ_8_FROM_PC(pc) : 2;
 				CHECK_FORCE_YIELD;
 				FASTCONTINUE;
@@ -13006,6 +17217,7 @@ returnFuncBInverted8:
 
 			CASE(GGCompareEQ):
 			{
+				QUICK(GGCompareEQ);
 				returnFunc = wr_CompareEQ;
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
@@ -13013,6 +17225,7 @@ returnFuncBInverted8:
 			}
 			CASE(GGCompareNE):
 			{
+				QUICK(GGCompareNE);
 				returnFunc = wr_CompareEQ;
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
@@ -13020,6 +17233,7 @@ returnFuncBInverted8:
 			}
 			CASE(GGCompareGT):
 			{
+				QUICK(GGCompareGT);
 				returnFunc = wr_CompareGT;
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
@@ -13027,6 +17241,7 @@ returnFuncBInverted8:
 			}
 			CASE(GGCompareGE):
 			{
+				QUICK(GGCompareGE);
 				returnFunc = wr_CompareLT;
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
@@ -13034,6 +17249,7 @@ returnFuncBInverted8:
 			}
 			CASE(GGCompareLT):
 			{
+				QUICK(GGCompareLT);
 				returnFunc = wr_CompareLT;
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
@@ -13041,6 +17257,7 @@ returnFuncBInverted8:
 			}
 			CASE(GGCompareLE):
 			{
+				QUICK(GGCompareLE);
 				returnFunc = wr_CompareGT;
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
@@ -13048,30 +17265,34 @@ returnFuncBInverted8:
 			}
 
 			
-			CASE(LLCompareGT): { returnFunc = wr_CompareGT; goto returnCompareEQ; }
-			CASE(LLCompareLT): { returnFunc = wr_CompareLT; goto returnCompareEQ; }
+			CASE(LLCompareGT): { QUICK(LLCompareGT); returnFunc = wr_CompareGT; goto returnCompareEQ; }
+			CASE(LLCompareLT): { QUICK(LLCompareLT); returnFunc = wr_CompareLT; goto returnCompareEQ; }
 			CASE(LLCompareEQ):
 			{
+				QUICK(LLCompareEQ);
 				returnFunc = wr_CompareEQ;
 returnCompareEQ:
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
 returnCompareEQPost:
+				QUICKEN;
 				stackTop->i = (int)returnFunc[(register0->type<<2)|register1->type]( register0, register1 );
 				(stackTop++)->p2 = INIT_AS_INT;
 				CHECK_STACK;
 				FASTCONTINUE;
 			}
 			
-			CASE(LLCompareGE): { returnFunc = wr_CompareLT; goto returnCompareNE; }
-			CASE(LLCompareLE): { returnFunc = wr_CompareGT; goto returnCompareNE; }
+			CASE(LLCompareGE): { QUICK(LLCompareGE); returnFunc = wr_CompareLT; goto returnCompareNE; }
+			CASE(LLCompareLE): { QUICK(LLCompareLE); returnFunc = wr_CompareGT; goto returnCompareNE; }
 			CASE(LLCompareNE):
 			{
+				QUICK(LLCompareNE);
 				returnFunc = wr_CompareEQ;
 returnCompareNE:
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
 returnCompareNEPost:
+				QUICKEN;
 				stackTop->i = (int)!returnFunc[(register0->type<<2)|register1->type]( register0, register1 );
 				(stackTop++)->p2 = INIT_AS_INT;
 				CHECK_STACK;
@@ -13080,228 +17301,264 @@ returnCompareNEPost:
 
 
 			
-			CASE(GSCompareGEBZ): { returnFunc = wr_CompareLT; goto CompareGInverted; }
-			CASE(GSCompareLEBZ): { returnFunc = wr_CompareGT; goto CompareGInverted; }
+			CASE(GSCompareGEBZ): { QUICK(GSCompareGEBZ); returnFunc = wr_CompareLT; goto CompareGInverted; }
+			CASE(GSCompareLEBZ): { QUICK(GSCompareLEBZ); returnFunc = wr_CompareGT; goto CompareGInverted; }
 			CASE(GSCompareNEBZ):
 			{
+				QUICK(GSCompareNEBZ);
 				returnFunc = wr_CompareEQ;
 CompareGInverted:
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? READ_16_FROM_PC(pc) : 2;
 				FASTCONTINUE;
 			}
 			
-			CASE(GSCompareEQBZ): { returnFunc = wr_CompareEQ; goto CompareGNormal; }
-			CASE(GSCompareGTBZ): { returnFunc = wr_CompareGT; goto CompareGNormal; }
+			CASE(GSCompareEQBZ): { QUICK(GSCompareEQBZ); returnFunc = wr_CompareEQ; goto CompareGNormal; }
+			CASE(GSCompareGTBZ): { QUICK(GSCompareGTBZ); returnFunc = wr_CompareGT; goto CompareGNormal; }
 			CASE(GSCompareLTBZ):
 			{
+				QUICK(GSCompareLTBZ);
 				returnFunc = wr_CompareLT;
 CompareGNormal:
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : READ_16_FROM_PC(pc);
 				FASTCONTINUE;
 			}
 			
-			CASE(LSCompareGEBZ): { returnFunc = wr_CompareLT; goto CompareLInverted; }
-			CASE(LSCompareLEBZ): { returnFunc = wr_CompareGT; goto CompareLInverted; }
+			CASE(LSCompareGEBZ): { QUICK(LSCompareGEBZ); returnFunc = wr_CompareLT; goto CompareLInverted; }
+			CASE(LSCompareLEBZ): { QUICK(LSCompareLEBZ); returnFunc = wr_CompareGT; goto CompareLInverted; }
 			CASE(LSCompareNEBZ):
 			{
+				QUICK(LSCompareNEBZ);
 				returnFunc = wr_CompareEQ;
 CompareLInverted:
 				register0 = frameBase + READ_8_FROM_PC(pc++);
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? READ_16_FROM_PC(pc) : 2;
 				FASTCONTINUE;
 			}
 			
-			CASE(LSCompareEQBZ): { returnFunc = wr_CompareEQ; goto CompareLNormal; }
-			CASE(LSCompareGTBZ): { returnFunc = wr_CompareGT; goto CompareLNormal; }
+			CASE(LSCompareEQBZ): { QUICK(LSCompareEQBZ); returnFunc = wr_CompareEQ; goto CompareLNormal; }
+			CASE(LSCompareGTBZ): { QUICK(LSCompareGTBZ); returnFunc = wr_CompareGT; goto CompareLNormal; }
 			CASE(LSCompareLTBZ):
 			{
+				QUICK(LSCompareLTBZ);
 				returnFunc = wr_CompareLT;
 CompareLNormal:
 				register0 = frameBase + READ_8_FROM_PC(pc++);
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : READ_16_FROM_PC(pc);
 				FASTCONTINUE;
 			}
 			
-			CASE(GSCompareGEBZ8): { returnFunc = wr_CompareLT; goto CompareG8Inverted; }
-			CASE(GSCompareLEBZ8): { returnFunc = wr_CompareGT; goto CompareG8Inverted; }
+			CASE(GSCompareGEBZ8): { QUICK(GSCompareGEBZ8); returnFunc = wr_CompareLT; goto CompareG8Inverted; }
+			CASE(GSCompareLEBZ8): { QUICK(GSCompareLEBZ8); returnFunc = wr_CompareGT; goto CompareG8Inverted; }
 			CASE(GSCompareNEBZ8):
 			{
+				QUICK(GSCompareNEBZ8);
 				returnFunc = wr_CompareEQ;
 CompareG8Inverted:
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? (int8_t)READ_8_FROM_PC(pc) : 2;
 				FASTCONTINUE;
 			}
 			
-			CASE(GSCompareEQBZ8): { returnFunc = wr_CompareEQ; goto CompareG8Normal; }
-			CASE(GSCompareGTBZ8): { returnFunc = wr_CompareGT; goto CompareG8Normal; }
+			CASE(GSCompareEQBZ8): { QUICK(GSCompareEQBZ8); returnFunc = wr_CompareEQ; goto CompareG8Normal; }
+			CASE(GSCompareGTBZ8): { QUICK(GSCompareGTBZ8); returnFunc = wr_CompareGT; goto CompareG8Normal; }
 			CASE(GSCompareLTBZ8):
 			{
+				QUICK(GSCompareLTBZ8);
 				returnFunc = wr_CompareLT;
 CompareG8Normal:
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : (int8_t)READ_8_FROM_PC(pc);
 				FASTCONTINUE;
 			}
 			
-			CASE(LSCompareGEBZ8): { returnFunc = wr_CompareLT; goto CompareL8Inverted; }
-			CASE(LSCompareLEBZ8): { returnFunc = wr_CompareGT; goto CompareL8Inverted; }
+			CASE(LSCompareGEBZ8): { QUICK(LSCompareGEBZ8); returnFunc = wr_CompareLT; goto CompareL8Inverted; }
+			CASE(LSCompareLEBZ8): { QUICK(LSCompareLEBZ8); returnFunc = wr_CompareGT; goto CompareL8Inverted; }
 			CASE(LSCompareNEBZ8):
 			{
+				QUICK(LSCompareNEBZ8);
 				returnFunc = wr_CompareEQ;
 CompareL8Inverted:
 				register0 = frameBase + READ_8_FROM_PC(pc++);
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? (int8_t)READ_8_FROM_PC(pc) : 2;
 				FASTCONTINUE;
 			}
 			
-			CASE(LSCompareEQBZ8): { returnFunc = wr_CompareEQ; goto CompareL8Normal; }
-			CASE(LSCompareGTBZ8): { returnFunc = wr_CompareGT; goto CompareL8Normal; }
+			CASE(LSCompareEQBZ8): { QUICK(LSCompareEQBZ8); returnFunc = wr_CompareEQ; goto CompareL8Normal; }
+			CASE(LSCompareGTBZ8): { QUICK(LSCompareGTBZ8); returnFunc = wr_CompareGT; goto CompareL8Normal; }
 			CASE(LSCompareLTBZ8):
 			{
+				QUICK(LSCompareLTBZ8);
 				returnFunc = wr_CompareLT;
 CompareL8Normal:
 				register0 = frameBase + READ_8_FROM_PC(pc++);
 				register1 = --stackTop;
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : (int8_t)READ_8_FROM_PC(pc);
 				FASTCONTINUE;
 			}
 
-			CASE(LLCompareGEBZ): { returnFunc = wr_CompareLT; goto CompareLLInv; }
-			CASE(LLCompareLEBZ): { returnFunc = wr_CompareGT; goto CompareLLInv; }
+			CASE(LLCompareGEBZ): { QUICK(LLCompareGEBZ); returnFunc = wr_CompareLT; goto CompareLLInv; }
+			CASE(LLCompareLEBZ): { QUICK(LLCompareLEBZ); returnFunc = wr_CompareGT; goto CompareLLInv; }
 			CASE(LLCompareNEBZ):
 			{
+				QUICK(LLCompareNEBZ);
 				returnFunc = wr_CompareEQ;
 CompareLLInv:
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? READ_16_FROM_PC(pc) : 2;
 				FASTCONTINUE;
 			}
-			CASE(LLCompareEQBZ): { returnFunc = wr_CompareEQ; goto CompareLL; }
-			CASE(LLCompareGTBZ): { returnFunc = wr_CompareGT; goto CompareLL; }
+			CASE(LLCompareEQBZ): { QUICK(LLCompareEQBZ); returnFunc = wr_CompareEQ; goto CompareLL; }
+			CASE(LLCompareGTBZ): { QUICK(LLCompareGTBZ); returnFunc = wr_CompareGT; goto CompareLL; }
 			CASE(LLCompareLTBZ):
 			{
+				QUICK(LLCompareLTBZ);
 				returnFunc = wr_CompareLT;
 CompareLL:	
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : READ_16_FROM_PC(pc);
 				FASTCONTINUE;
 			}
 
 			
-			CASE(LLCompareGEBZ8): { returnFunc = wr_CompareLT; goto CompareLL8Inv; }
-			CASE(LLCompareLEBZ8): { returnFunc = wr_CompareGT; goto CompareLL8Inv; }
+			CASE(LLCompareGEBZ8): { QUICK(LLCompareGEBZ8); returnFunc = wr_CompareLT; goto CompareLL8Inv; }
+			CASE(LLCompareLEBZ8): { QUICK(LLCompareLEBZ8); returnFunc = wr_CompareGT; goto CompareLL8Inv; }
 			CASE(LLCompareNEBZ8):
 			{
+				QUICK(LLCompareNEBZ8);
 				returnFunc = wr_CompareEQ;
 CompareLL8Inv:
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? (int8_t)READ_8_FROM_PC(pc) : 2;
 				FASTCONTINUE;
 			}
-			CASE(LLCompareEQBZ8): { returnFunc = wr_CompareEQ; goto CompareLL8; }
-			CASE(LLCompareGTBZ8): { returnFunc = wr_CompareGT; goto CompareLL8; }
+			CASE(LLCompareEQBZ8): { QUICK(LLCompareEQBZ8); returnFunc = wr_CompareEQ; goto CompareLL8; }
+			CASE(LLCompareGTBZ8): { QUICK(LLCompareGTBZ8); returnFunc = wr_CompareGT; goto CompareLL8; }
 			CASE(LLCompareLTBZ8):
 			{
+				QUICK(LLCompareLTBZ8);
 				returnFunc = wr_CompareLT;
 CompareLL8:
 				register1 = frameBase + READ_8_FROM_PC(pc++);
 				register0 = frameBase + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : (int8_t)READ_8_FROM_PC(pc);
 				FASTCONTINUE;
 			}
 
 			
-			CASE(GGCompareGEBZ): { returnFunc = wr_CompareLT; goto CompareGGInv; }
- 		    CASE(GGCompareLEBZ): { returnFunc = wr_CompareGT; goto CompareGGInv; }
+			CASE(GGCompareGEBZ): { QUICK(GGCompareGEBZ); returnFunc = wr_CompareLT; goto CompareGGInv; }
+ 		    CASE(GGCompareLEBZ): { QUICK(GGCompareLEBZ); returnFunc = wr_CompareGT; goto CompareGGInv; }
 			CASE(GGCompareNEBZ):
 			{
+				QUICK(GGCompareNEBZ);
 				returnFunc = wr_CompareEQ;
 CompareGGInv:
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? READ_16_FROM_PC(pc) : 2;
 				FASTCONTINUE;
 			}
 
-			CASE(GGCompareEQBZ): { returnFunc = wr_CompareEQ; goto CompareGG; }
-			CASE(GGCompareGTBZ): { returnFunc = wr_CompareGT; goto CompareGG; }
+			CASE(GGCompareEQBZ): { QUICK(GGCompareEQBZ); returnFunc = wr_CompareEQ; goto CompareGG; }
+			CASE(GGCompareGTBZ): { QUICK(GGCompareGTBZ); returnFunc = wr_CompareGT; goto CompareGG; }
 			CASE(GGCompareLTBZ):
 			{
+				QUICK(GGCompareLTBZ);
 				returnFunc = wr_CompareLT;
 CompareGG:	
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : READ_16_FROM_PC(pc);
 				FASTCONTINUE;
 			}
 
 			
-			CASE(GGCompareGEBZ8): { returnFunc = wr_CompareLT; goto CompareGG8Inv; }
-			CASE(GGCompareLEBZ8): { returnFunc = wr_CompareGT; goto CompareGG8Inv; }
+			CASE(GGCompareGEBZ8): { QUICK(GGCompareGEBZ8); returnFunc = wr_CompareLT; goto CompareGG8Inv; }
+			CASE(GGCompareLEBZ8): { QUICK(GGCompareLEBZ8); returnFunc = wr_CompareGT; goto CompareGG8Inv; }
 			CASE(GGCompareNEBZ8):
 			{
+				QUICK(GGCompareNEBZ8);
 				returnFunc = wr_CompareEQ;
 CompareGG8Inv:
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? (int8_t)READ_8_FROM_PC(pc) : 2;
 				FASTCONTINUE;
 			}
-			CASE(GGCompareEQBZ8): { returnFunc = wr_CompareEQ; goto CompareGG8; }
-			CASE(GGCompareGTBZ8): { returnFunc = wr_CompareGT; goto CompareGG8; }
+			CASE(GGCompareEQBZ8): { QUICK(GGCompareEQBZ8); returnFunc = wr_CompareEQ; goto CompareGG8; }
+			CASE(GGCompareGTBZ8): { QUICK(GGCompareGTBZ8); returnFunc = wr_CompareGT; goto CompareGG8; }
 			CASE(GGCompareLTBZ8):
 			{
+				QUICK(GGCompareLTBZ8);
 				returnFunc = wr_CompareLT;
 CompareGG8:	
 				register1 = globalSpace + READ_8_FROM_PC(pc++);
 				register0 = globalSpace + READ_8_FROM_PC(pc++);
+				QUICKEN;
 				pc += returnFunc[(register0->type<<2)|register1->type]( register0, register1 ) ? 2 : (int8_t)READ_8_FROM_PC(pc);
 				FASTCONTINUE;
 			}
 
 			
-			CASE(BinaryRightShiftSkipLoad): { targetFunc = wr_RightShiftBinary; goto targetFuncOpSkipLoad; }
-			CASE(BinaryLeftShiftSkipLoad): { targetFunc = wr_LeftShiftBinary; goto targetFuncOpSkipLoad; }
-			CASE(BinaryAndSkipLoad): { targetFunc = wr_ANDBinary; goto targetFuncOpSkipLoad; }
-			CASE(BinaryOrSkipLoad): { targetFunc = wr_ORBinary; goto targetFuncOpSkipLoad; }
-			CASE(BinaryXORSkipLoad): { targetFunc = wr_XORBinary; goto targetFuncOpSkipLoad; }
+			CASE(BinaryRightShiftSkipLoad): { QUICK_INT(BinaryRightShiftSkipLoad); targetFunc = wr_RightShiftBinary; goto targetFuncOpSkipLoad; }
+			CASE(BinaryLeftShiftSkipLoad): { QUICK_INT(BinaryLeftShiftSkipLoad); targetFunc = wr_LeftShiftBinary; goto targetFuncOpSkipLoad; }
+			CASE(BinaryAndSkipLoad): { QUICK_INT(BinaryAndSkipLoad); targetFunc = wr_ANDBinary; goto targetFuncOpSkipLoad; }
+			CASE(BinaryOrSkipLoad): { QUICK_INT(BinaryOrSkipLoad); targetFunc = wr_ORBinary; goto targetFuncOpSkipLoad; }
+			CASE(BinaryXORSkipLoad): { QUICK_INT(BinaryXORSkipLoad); targetFunc = wr_XORBinary; goto targetFuncOpSkipLoad; }
 			CASE(BinaryModSkipLoad):
 			{
+				QUICK_INT(BinaryModSkipLoad);
 				targetFunc = wr_ModBinary;
 targetFuncOpSkipLoad:
+				QUICKEN;
 				targetFunc[(register1->type<<2)|register0->type]( register1, register0, stackTop++ );
 				CHECK_STACK;
 				CONTINUE;
 			}
 			
-			CASE(BinaryMultiplication): { targetFunc = wr_MultiplyBinary; goto targetFuncOp; }
-			CASE(BinarySubtraction): { targetFunc = wr_SubtractBinary; goto targetFuncOp; }
-			CASE(BinaryDivision): { targetFunc = wr_DivideBinary; goto targetFuncOp; }
-			CASE(BinaryRightShift): { targetFunc = wr_RightShiftBinary; goto targetFuncOp; }
-			CASE(BinaryLeftShift): { targetFunc = wr_LeftShiftBinary; goto targetFuncOp; }
-			CASE(BinaryMod): { targetFunc = wr_ModBinary; goto targetFuncOp; }
-			CASE(BinaryOr): { targetFunc = wr_ORBinary; goto targetFuncOp; }
-			CASE(BinaryXOR): { targetFunc = wr_XORBinary; goto targetFuncOp; }
-			CASE(BinaryAnd): { targetFunc = wr_ANDBinary; goto targetFuncOp; }
+			CASE(BinaryMultiplication): { QUICK(BinaryMultiplication); targetFunc = wr_MultiplyBinary; goto targetFuncOp; }
+			CASE(BinarySubtraction): { QUICK(BinarySubtraction); targetFunc = wr_SubtractBinary; goto targetFuncOp; }
+			CASE(BinaryDivision): { QUICK(BinaryDivision); targetFunc = wr_DivideBinary; goto targetFuncOp; }
+			CASE(BinaryRightShift): { QUICK_INT(BinaryRightShift); targetFunc = wr_RightShiftBinary; goto targetFuncOp; }
+			CASE(BinaryLeftShift): { QUICK_INT(BinaryLeftShift); targetFunc = wr_LeftShiftBinary; goto targetFuncOp; }
+			CASE(BinaryMod): { QUICK_INT(BinaryMod); targetFunc = wr_ModBinary; goto targetFuncOp; }
+			CASE(BinaryOr): { QUICK_INT(BinaryOr); targetFunc = wr_ORBinary; goto targetFuncOp; }
+			CASE(BinaryXOR): { QUICK_INT(BinaryXOR); targetFunc = wr_XORBinary; goto targetFuncOp; }
+			CASE(BinaryAnd): { QUICK_INT(BinaryAnd); targetFunc = wr_ANDBinary; goto targetFuncOp; }
 			CASE(BinaryAddition):
 			{
+				QUICK(BinaryAddition);
 				targetFunc = wr_AdditionBinary;
 targetFuncOp:
 				register1 = --stackTop;
 				register0 = stackTop - 1;
+				QUICKEN;
 				targetFunc[(register1->type<<2)|register0->type]( register1, register0, register0 );
 #ifdef WRENCH_TRAP_DIVISION_BY_ZERO
 				if ( IS_INVALID(register0->p2) )
@@ -13368,16 +17625,18 @@ binaryTableOpAndPop:
 				CONTINUE;
 			}
 			
-			CASE(BinaryAdditionAndStoreGlobal) : { targetFunc = wr_AdditionBinary; goto targetFuncStoreGlobalOp; }
-			CASE(BinarySubtractionAndStoreGlobal): { targetFunc = wr_SubtractBinary; goto targetFuncStoreGlobalOp; }
-			CASE(BinaryMultiplicationAndStoreGlobal): { targetFunc = wr_MultiplyBinary; goto targetFuncStoreGlobalOp; }
+			CASE(BinaryAdditionAndStoreGlobal) : { QUICK(BinaryAdditionAndStoreGlobal); targetFunc = wr_AdditionBinary; goto targetFuncStoreGlobalOp; }
+			CASE(BinarySubtractionAndStoreGlobal): { QUICK(BinarySubtractionAndStoreGlobal); targetFunc = wr_SubtractBinary; goto targetFuncStoreGlobalOp; }
+			CASE(BinaryMultiplicationAndStoreGlobal): { QUICK(BinaryMultiplicationAndStoreGlobal); targetFunc = wr_MultiplyBinary; goto targetFuncStoreGlobalOp; }
 			CASE(BinaryDivisionAndStoreGlobal):
 			{
+				QUICK(BinaryDivisionAndStoreGlobal);
 				targetFunc = wr_DivideBinary;
 				
 targetFuncStoreGlobalOp:
 				register1 = --stackTop;
 				register0 = --stackTop;
+				QUICKEN;
 #ifdef WRENCH_TRAP_DIVISION_BY_ZERO
 				WRValue* T = globalSpace + READ_8_FROM_PC(pc++);
 				targetFunc[(register1->type<<2)|register0->type]( register1, register0, T );
@@ -13392,16 +17651,18 @@ targetFuncStoreGlobalOp:
 				CONTINUE;
 			}
 			
-			CASE(BinaryAdditionAndStoreLocal): { targetFunc = wr_AdditionBinary; goto targetFuncStoreLocalOp; }
-			CASE(BinarySubtractionAndStoreLocal): { targetFunc = wr_SubtractBinary; goto targetFuncStoreLocalOp; }
-			CASE(BinaryMultiplicationAndStoreLocal): { targetFunc = wr_MultiplyBinary; goto targetFuncStoreLocalOp; }
+			CASE(BinaryAdditionAndStoreLocal): { QUICK(BinaryAdditionAndStoreLocal); targetFunc = wr_AdditionBinary; goto targetFuncStoreLocalOp; }
+			CASE(BinarySubtractionAndStoreLocal): { QUICK(BinarySubtractionAndStoreLocal); targetFunc = wr_SubtractBinary; goto targetFuncStoreLocalOp; }
+			CASE(BinaryMultiplicationAndStoreLocal): { QUICK(BinaryMultiplicationAndStoreLocal); targetFunc = wr_MultiplyBinary; goto targetFuncStoreLocalOp; }
 			CASE(BinaryDivisionAndStoreLocal):
 			{
+				QUICK(BinaryDivisionAndStoreLocal);
 				targetFunc = wr_DivideBinary;
 				
 targetFuncStoreLocalOp:
 				register1 = --stackTop;
 				register0 = --stackTop;
+				QUICKEN;
 #ifdef WRENCH_TRAP_DIVISION_BY_ZERO
 				WRValue* T = frameBase + READ_8_FROM_PC(pc++);
 				targetFunc[(register1->type<<2)|register0->type]( register1, register0, T );
@@ -13417,6 +17678,158 @@ targetFuncStoreLocalOp:
 			}
 
 			
+#ifdef WRENCH_QUICKENING
+			// what the generic handlers above get replaced with, see QUICK()
+			QUICK_BRANCH( LLCompareEQBZ, LL, 2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareGTBZ, LL, 2, QUICK_GT, QUICK_GT, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareLTBZ, LL, 2, QUICK_LT, QUICK_LT, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareNEBZ, LL, 2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareLEBZ, LL, 2, QUICK_GT, QUICK_GT, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareGEBZ, LL, 2, QUICK_LT, QUICK_LT, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareEQBZ8, LL, 2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareGTBZ8, LL, 2, QUICK_GT, QUICK_GT, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareLTBZ8, LL, 2, QUICK_LT, QUICK_LT, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareNEBZ8, LL, 2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ8, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareLEBZ8, LL, 2, QUICK_GT, QUICK_GT, QUICK_BNZ8, FASTCONTINUE )
+			QUICK_BRANCH( LLCompareGEBZ8, LL, 2, QUICK_LT, QUICK_LT, QUICK_BNZ8, FASTCONTINUE )
+
+			QUICK_BRANCH( GGCompareEQBZ, GG, 2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareGTBZ, GG, 2, QUICK_GT, QUICK_GT, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareLTBZ, GG, 2, QUICK_LT, QUICK_LT, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareNEBZ, GG, 2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareLEBZ, GG, 2, QUICK_GT, QUICK_GT, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareGEBZ, GG, 2, QUICK_LT, QUICK_LT, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareEQBZ8, GG, 2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareGTBZ8, GG, 2, QUICK_GT, QUICK_GT, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareLTBZ8, GG, 2, QUICK_LT, QUICK_LT, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareNEBZ8, GG, 2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ8, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareLEBZ8, GG, 2, QUICK_GT, QUICK_GT, QUICK_BNZ8, FASTCONTINUE )
+			QUICK_BRANCH( GGCompareGEBZ8, GG, 2, QUICK_LT, QUICK_LT, QUICK_BNZ8, FASTCONTINUE )
+
+			QUICK_BRANCH( LSCompareEQBZ, LS, 1_POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareGTBZ, LS, 1_POP, QUICK_GT, QUICK_GT, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareLTBZ, LS, 1_POP, QUICK_LT, QUICK_LT, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareNEBZ, LS, 1_POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareLEBZ, LS, 1_POP, QUICK_GT, QUICK_GT, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareGEBZ, LS, 1_POP, QUICK_LT, QUICK_LT, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareEQBZ8, LS, 1_POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareGTBZ8, LS, 1_POP, QUICK_GT, QUICK_GT, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareLTBZ8, LS, 1_POP, QUICK_LT, QUICK_LT, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareNEBZ8, LS, 1_POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ8, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareLEBZ8, LS, 1_POP, QUICK_GT, QUICK_GT, QUICK_BNZ8, FASTCONTINUE )
+			QUICK_BRANCH( LSCompareGEBZ8, LS, 1_POP, QUICK_LT, QUICK_LT, QUICK_BNZ8, FASTCONTINUE )
+
+			QUICK_BRANCH( GSCompareEQBZ, GS, 1_POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareGTBZ, GS, 1_POP, QUICK_GT, QUICK_GT, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareLTBZ, GS, 1_POP, QUICK_LT, QUICK_LT, QUICK_BZ, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareNEBZ, GS, 1_POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareLEBZ, GS, 1_POP, QUICK_GT, QUICK_GT, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareGEBZ, GS, 1_POP, QUICK_LT, QUICK_LT, QUICK_BNZ, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareEQBZ8, GS, 1_POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareGTBZ8, GS, 1_POP, QUICK_GT, QUICK_GT, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareLTBZ8, GS, 1_POP, QUICK_LT, QUICK_LT, QUICK_BZ8, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareNEBZ8, GS, 1_POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ8, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareLEBZ8, GS, 1_POP, QUICK_GT, QUICK_GT, QUICK_BNZ8, FASTCONTINUE )
+			QUICK_BRANCH( GSCompareGEBZ8, GS, 1_POP, QUICK_LT, QUICK_LT, QUICK_BNZ8, FASTCONTINUE )
+
+			QUICK_BRANCH( CompareBEQ, SS, POP2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBGT, SS, POP2, QUICK_GT, QUICK_GT, QUICK_BZ, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBLT, SS, POP2, QUICK_LT, QUICK_LT, QUICK_BZ, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBNE, SS, POP2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBLE, SS, POP2, QUICK_GT, QUICK_GT, QUICK_BNZ, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBGE, SS, POP2, QUICK_LT, QUICK_LT, QUICK_BNZ, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBEQ8, SS, POP2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BZ8, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBGT8, SS, POP2, QUICK_GT, QUICK_GT, QUICK_BZ8, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBLT8, SS, POP2, QUICK_LT, QUICK_LT, QUICK_BZ8, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBNE8, SS, POP2, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_BNZ8, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBLE8, SS, POP2, QUICK_GT, QUICK_GT, QUICK_BNZ8, CHECK_FORCE_YIELD; FASTCONTINUE )
+			QUICK_BRANCH( CompareBGE8, SS, POP2, QUICK_LT, QUICK_LT, QUICK_BNZ8, CHECK_FORCE_YIELD; FASTCONTINUE )
+
+			QUICK_COMPARE( CompareEQ, SS, POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_IS )
+			QUICK_COMPARE( CompareNE, SS, POP, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_NOT )
+			QUICK_COMPARE( CompareGT, SS, POP, QUICK_GT, QUICK_GT, QUICK_IS )
+			QUICK_COMPARE( CompareLT, SS, POP, QUICK_LT, QUICK_LT, QUICK_IS )
+			QUICK_COMPARE( CompareGE, SS, POP, QUICK_LT, QUICK_LT, QUICK_NOT )
+			QUICK_COMPARE( CompareLE, SS, POP, QUICK_GT, QUICK_GT, QUICK_NOT )
+			QUICK_COMPARE( LogicalAnd, SS, POP, QUICK_AND, QUICK_AND, QUICK_IS )
+			QUICK_COMPARE( LogicalOr, SS, POP, QUICK_OR, QUICK_OR, QUICK_IS )
+
+			QUICK_COMPARE( LSCompareEQ, LS, 1, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_IS )
+			QUICK_COMPARE( LSCompareNE, LS, 1, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_NOT )
+			QUICK_COMPARE( LSCompareGT, LS, 1, QUICK_GT, QUICK_GT, QUICK_IS )
+			QUICK_COMPARE( LSCompareLT, LS, 1, QUICK_LT, QUICK_LT, QUICK_IS )
+			QUICK_COMPARE( LSCompareGE, LS, 1, QUICK_LT, QUICK_LT, QUICK_NOT )
+			QUICK_COMPARE( LSCompareLE, LS, 1, QUICK_GT, QUICK_GT, QUICK_NOT )
+
+			QUICK_COMPARE( GSCompareEQ, GS, 1, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_IS )
+			QUICK_COMPARE( GSCompareNE, GS, 1, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_NOT )
+			QUICK_COMPARE( GSCompareGT, GS, 1, QUICK_GT, QUICK_GT, QUICK_IS )
+			QUICK_COMPARE( GSCompareLT, GS, 1, QUICK_LT, QUICK_LT, QUICK_IS )
+			QUICK_COMPARE( GSCompareGE, GS, 1, QUICK_LT, QUICK_LT, QUICK_NOT )
+			QUICK_COMPARE( GSCompareLE, GS, 1, QUICK_GT, QUICK_GT, QUICK_NOT )
+
+			QUICK_COMPARE_PUSH( LLCompareEQ, LL, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_IS )
+			QUICK_COMPARE_PUSH( LLCompareNE, LL, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_NOT )
+			QUICK_COMPARE_PUSH( LLCompareGT, LL, QUICK_GT, QUICK_GT, QUICK_IS )
+			QUICK_COMPARE_PUSH( LLCompareLT, LL, QUICK_LT, QUICK_LT, QUICK_IS )
+			QUICK_COMPARE_PUSH( LLCompareGE, LL, QUICK_LT, QUICK_LT, QUICK_NOT )
+			QUICK_COMPARE_PUSH( LLCompareLE, LL, QUICK_GT, QUICK_GT, QUICK_NOT )
+
+			QUICK_COMPARE_PUSH( GGCompareEQ, GG, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_IS )
+			QUICK_COMPARE_PUSH( GGCompareNE, GG, QUICK_EQ, WR_FLOATS_EQUAL, QUICK_NOT )
+			QUICK_COMPARE_PUSH( GGCompareGT, GG, QUICK_GT, QUICK_GT, QUICK_IS )
+			QUICK_COMPARE_PUSH( GGCompareLT, GG, QUICK_LT, QUICK_LT, QUICK_IS )
+			QUICK_COMPARE_PUSH( GGCompareGE, GG, QUICK_LT, QUICK_LT, QUICK_NOT )
+			QUICK_COMPARE_PUSH( GGCompareLE, GG, QUICK_GT, QUICK_GT, QUICK_NOT )
+
+			QUICK_BINARY_PUSH( GGBinaryAddition, GG, wr_iadd_wrap, QUICK_ADD, QUICK_ANY )
+			QUICK_BINARY_PUSH( GLBinaryAddition, GL, wr_iadd_wrap, QUICK_ADD, QUICK_ANY )
+			QUICK_BINARY_PUSH( LLBinaryAddition, LL, wr_iadd_wrap, QUICK_ADD, QUICK_ANY )
+			QUICK_BINARY_PUSH( GGBinarySubtraction, GG, wr_isub_wrap, QUICK_SUB, QUICK_ANY )
+			QUICK_BINARY_PUSH( GLBinarySubtraction, GL, wr_isub_wrap, QUICK_SUB, QUICK_ANY )
+			QUICK_BINARY_PUSH( LGBinarySubtraction, LG, wr_isub_wrap, QUICK_SUB, QUICK_ANY )
+			QUICK_BINARY_PUSH( LLBinarySubtraction, LL, wr_isub_wrap, QUICK_SUB, QUICK_ANY )
+			QUICK_BINARY_PUSH( GGBinaryMultiplication, GG, wr_imul_wrap, QUICK_MUL, QUICK_ANY )
+			QUICK_BINARY_PUSH( GLBinaryMultiplication, GL, wr_imul_wrap, QUICK_MUL, QUICK_ANY )
+			QUICK_BINARY_PUSH( LLBinaryMultiplication, LL, wr_imul_wrap, QUICK_MUL, QUICK_ANY )
+			QUICK_BINARY_PUSH( GGBinaryDivision, GG, QUICK_DIV, QUICK_DIV, QUICK_NONZERO )
+			QUICK_BINARY_PUSH( GLBinaryDivision, GL, QUICK_DIV, QUICK_DIV, QUICK_NONZERO )
+			QUICK_BINARY_PUSH( LGBinaryDivision, LG, QUICK_DIV, QUICK_DIV, QUICK_NONZERO )
+			QUICK_BINARY_PUSH( LLBinaryDivision, LL, QUICK_DIV, QUICK_DIV, QUICK_NONZERO )
+
+			QUICK_BINARY( BinaryAddition, wr_iadd_wrap, QUICK_ADD, QUICK_ANY )
+			QUICK_BINARY( BinarySubtraction, wr_isub_wrap, QUICK_SUB, QUICK_ANY )
+			QUICK_BINARY( BinaryMultiplication, wr_imul_wrap, QUICK_MUL, QUICK_ANY )
+			QUICK_BINARY( BinaryDivision, QUICK_DIV, QUICK_DIV, QUICK_NONZERO )
+			QUICK_INT_BINARY( BinaryRightShift, QUICK_SHR )
+			QUICK_INT_BINARY( BinaryLeftShift, QUICK_SHL )
+			QUICK_INT_BINARY( BinaryMod, QUICK_MOD )
+			QUICK_INT_BINARY( BinaryOr, QUICK_BOR )
+			QUICK_INT_BINARY( BinaryXOR, QUICK_BXOR )
+			QUICK_INT_BINARY( BinaryAnd, QUICK_BAND )
+
+			QUICK_INT_SKIPLOAD( BinaryRightShiftSkipLoad, QUICK_SHR )
+			QUICK_INT_SKIPLOAD( BinaryLeftShiftSkipLoad, QUICK_SHL )
+			QUICK_INT_SKIPLOAD( BinaryModSkipLoad, QUICK_MOD )
+			QUICK_INT_SKIPLOAD( BinaryOrSkipLoad, QUICK_BOR )
+			QUICK_INT_SKIPLOAD( BinaryXORSkipLoad, QUICK_BXOR )
+			QUICK_INT_SKIPLOAD( BinaryAndSkipLoad, QUICK_BAND )
+
+			QUICK_BINARY_STORE( BinaryAdditionAndStoreLocal, frameBase, wr_iadd_wrap, QUICK_ADD, QUICK_ANY )
+			QUICK_BINARY_STORE( BinarySubtractionAndStoreLocal, frameBase, wr_isub_wrap, QUICK_SUB, QUICK_ANY )
+			QUICK_BINARY_STORE( BinaryMultiplicationAndStoreLocal, frameBase, wr_imul_wrap, QUICK_MUL, QUICK_ANY )
+			QUICK_BINARY_STORE( BinaryDivisionAndStoreLocal, frameBase, QUICK_DIV, QUICK_DIV, QUICK_NONZERO )
+			QUICK_BINARY_STORE( BinaryAdditionAndStoreGlobal, globalSpace, wr_iadd_wrap, QUICK_ADD, QUICK_ANY )
+			QUICK_BINARY_STORE( BinarySubtractionAndStoreGlobal, globalSpace, wr_isub_wrap, QUICK_SUB, QUICK_ANY )
+			QUICK_BINARY_STORE( BinaryMultiplicationAndStoreGlobal, globalSpace, wr_imul_wrap, QUICK_MUL, QUICK_ANY )
+			QUICK_BINARY_STORE( BinaryDivisionAndStoreGlobal, globalSpace, QUICK_DIV, QUICK_DIV, QUICK_NONZERO )
+
+			QUICK_STEP( IncLocal, frameBase, ++ )
+			QUICK_STEP( DecLocal, frameBase, -- )
+			QUICK_STEP( IncGlobal, globalSpace, ++ )
+			QUICK_STEP( DecGlobal, globalSpace, -- )
+#endif
+
 //-------------------------------------------------------------------------------------------------------------
 #endif//-------------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------------------
@@ -13455,6 +17868,13 @@ SOFTWARE.
 
 #include "wrench.h"
 
+#ifdef WRENCH_LINUX_FILE_IO
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 void wr_destroyContextEx( WRContext* context );
 
 WR_ALLOC g_malloc = &malloc;
@@ -13570,9 +17990,10 @@ WRValue* WrenchValue::asArrayMember( const int index )
 	else if ( index >= (int)m_value->va->m_size )
 	{
 		wr_growValueArray( m_value->va, index );
-		m_context->allocatedMemoryHint += index * ((m_value->va->m_type == SV_CHAR) ? 1 : sizeof(WRValue));
+		m_context->allocatedMemoryHint += index * WR_SIZEOF_ELEMENT( m_value->va->m_type );
 	}
 
+	WR_GC_REMEMBER( m_context, m_value->vb );
 	return (WRValue*)m_value->va->get( index );
 }
 
@@ -13597,6 +18018,8 @@ WRValue* WrenchValue::addHashTableValue( const char* key )
 		m_value->p2 = INIT_AS_HASH_TABLE;
 	}
 
+	WR_GC_REMEMBER( m_context, m_value->vb );
+
 	uint32_t hash = wr_hashStr( key );
 	WRValue* entry = (WRValue*)(m_value->va->exists( hash, false ));
 	if ( !entry )
@@ -13633,16 +18056,32 @@ WRState* wr_newState( int stackSize )
 #endif
 																		   
 	memset( (unsigned char*)w, 0, sizeof(WRState) );
-	w->globalRegistry.growHash( WRENCH_NULL_HASH, 0 );
+	w->globalRegistry.init( 0, SV_VOID_HASH_TABLE, false );
 
 	w->stackSize = stackSize;
 	w->allocatedMemoryLimit = WRENCH_DEFAULT_ALLOCATED_MEMORY_GC_HINT;
+	w->randomSeed = 0xA5EED;
 
 	w->ctx = (void*)0;
+
+#ifdef WRENCH_OPCODE_PROFILE
+	w->opcodeProfile = (WROpcodeProfile*)g_malloc( sizeof(WROpcodeProfile) );
+	wr_resetOpcodeProfile( w );
+#endif
 	
 	return w;
 }
 
+#ifdef WRENCH_OPCODE_PROFILE
+//------------------------------------------------------------------------------
+void wr_resetOpcodeProfile( WRState* w )
+{
+	memset( (unsigned char*)w->opcodeProfile, 0, sizeof(WROpcodeProfile) );
+	w->opcodeProfile->last[0] = WR_PROFILE_CODES;
+	w->opcodeProfile->last[1] = WR_PROFILE_CODES;
+}
+#endif
+
 //------------------------------------------------------------------------------
 void wr_destroyState( WRState* w )
 {
@@ -13656,12 +18095,27 @@ void wr_destroyState( WRState* w )
 
 	while( w->contextList )
 	{
-		wr_destroyContext( w->contextList );
+		wr_destroyContext( w->contextList );
+	}
+
+	w->globalRegistry.clear();
+
+#ifdef WRENCH_LINUX_FILE_IO
+	while( w->mappedFiles )
+	{
+		WRMappedFile* next = w->mappedFiles->next;
+		wr_releaseMapped( w->mappedFiles );
+		w->mappedFiles = next;
 	}
+#endif
 
-	wr_freeGCChain( w->globalRegistry.m_nextGC );
+#ifdef WRENCH_POOL_ALLOCATOR
+	wr_destroyPool( w );
+#endif
 
-	w->globalRegistry.clear();
+#ifdef WRENCH_OPCODE_PROFILE
+	g_free( w->opcodeProfile );
+#endif
 
 	g_free( w );
 }
@@ -13705,36 +18159,77 @@ bool wr_executeFunctionZero( WRContext* context )
 }
 
 //------------------------------------------------------------------------------
-WRContext* wr_createContext( WRState* w, const unsigned char* block, const int blockSize, bool takeOwnership, WRValue* stack )
+static void wr_readFunctionTable( const unsigned char* block, const int count, WRFunction* functions )
 {
-	if ( blockSize < 8 )
+	if ( wr_isWideBytecode(block) )
 	{
-		w->err = WR_ERR_bad_bytecode_CRC;
-		return 0;
+		int pos = WR_WIDE_HEADER_SIZE;
+		for( int i=0; i<count; ++i )
+		{
+			functions[i].namespaceOffset = READ_32_FROM_PC( block + pos );
+			functions[i].functionOffset = READ_32_FROM_PC( block + pos + 4 );
+			functions[i].hash = READ_32_FROM_PC( block + pos + 8 );
+			functions[i].arguments = READ_8_FROM_PC( block + pos + 12 );
+			functions[i].frameSpaceNeeded = (uint16_t)READ_16_FROM_PC( block + pos + 13 );
+			functions[i].frameBaseAdjustment = (uint16_t)READ_16_FROM_PC( block + pos + 15 );
+
+			pos += WR_WIDE_FUNCTION_CORE_SIZE;
+		}
+		return;
+	}
+
+	int pos = 3;
+	for( int i=0; i<count; ++i )
+	{
+		functions[i].namespaceOffset = (uint16_t)READ_16_FROM_PC( block + pos );
+		pos += 2;
+		functions[i].functionOffset = (uint16_t)READ_16_FROM_PC( block + pos );
+		pos += 2;
+		functions[i].hash = READ_32_FROM_PC( block + pos );
+		pos += 3;
+		functions[i].arguments = READ_8_FROM_PC( block + ++pos );
+		functions[i].frameSpaceNeeded = READ_8_FROM_PC( block + ++pos );
+		functions[i].frameBaseAdjustment = READ_8_FROM_PC( block + ++pos );
+		
+		++pos;
+	}
+}
+
+//------------------------------------------------------------------------------
+void wr_buildRegistry( WRContext* context )
+{
+	context->flags &= ~WRC_LazyRegistry;
+	for( int i=0; i<context->numLocalFunctions; ++i )
+	{
+		context->registry.getAsRawValueHashTable(context->localFunctions[i].hash)->wrf = context->localFunctions + i;
 	}
+}
 
+//------------------------------------------------------------------------------
+WRContext* wr_createContext( WRState* w, const unsigned char* block, const int blockSize, bool takeOwnership, WRValue* stack, WRFunction* functions )
+{
 	// CRC the code block, at least is it what the compiler intended?
-	uint32_t hash = READ_32_FROM_PC(block + (blockSize - 4));
-	if ( hash != wr_hash_read8(block, (blockSize - 4)) + WRENCH_VERSION_MAJOR )
+	if ( !functions && (blockSize < 8 || !wr_isBytecodeValid(block, blockSize)) )
 	{
 		w->err = WR_ERR_bad_bytecode_CRC;
 		return 0;
 	}
 
-	int globals = READ_8_FROM_PC( block );
-	int localFuncs = READ_8_FROM_PC(block  + 1); // how many?
+	int globals = wr_globalsInBytecode( block );
+	int localFuncs = wr_functionsInBytecode( block ); // how many?
 
-	// 3-byte header + function table + 4-byte CRC must fit in block
-	int headerSize = 3 + (localFuncs * WR_FUNCTION_CORE_SIZE);
+	// header + function table + 4-byte CRC must fit in block
+	int headerSize = wr_functionTableEnd( block );
 	if ( headerSize + 4 > blockSize )
 	{
 		w->err = WR_ERR_bad_bytecode_CRC;
 		return 0;
 	}
-	
+
+	int tableSize = functions ? 0 : (localFuncs * sizeof(WRFunction));
 	int needed = sizeof(WRContext) // class
 				 + (globals * sizeof(WRValue))  // globals
-				 + (localFuncs * sizeof(WRFunction)) // functions
+				 + tableSize // functions
 				 + (stack ? 0 : (w->stackSize * sizeof(WRValue) + (int)sizeof(void*) - 1)); // stack + alignment slop
 
 	WRContext* C = (WRContext *)g_malloc( needed );
@@ -13747,7 +18242,7 @@ WRContext* wr_createContext( WRState* w, const unsigned char* block, const int b
 #endif
 	
 	memset((char*)C, 0, needed);
-	C->registry.growHash( WRENCH_NULL_HASH, 0 );
+	C->registry.init( 0, SV_VOID_HASH_TABLE, false );
 
 	C->numLocalFunctions = localFuncs;
 	C->localFunctions = (WRFunction *)((uint8_t *)(C + 1) + (globals * sizeof(WRValue)));
@@ -13760,19 +18255,28 @@ WRContext* wr_createContext( WRState* w, const unsigned char* block, const int b
 	}
 	else
 	{
-		uintptr_t rawStack = (uintptr_t)(C->localFunctions + localFuncs);
+		uintptr_t rawStack = (uintptr_t)C->localFunctions + tableSize;
 		uintptr_t alignedStack = (rawStack + (sizeof(void*) - 1)) & ~((uintptr_t)sizeof(void*) - 1);
 		C->stack = (WRValue*)alignedStack;
 	}
 
-	C->flags |= takeOwnership ? WRC_OwnsMemory : 0;
+	if ( functions )
+	{
+		C->localFunctions = functions;
+	}
+	else
+	{
+		wr_readFunctionTable( block, localFuncs, C->localFunctions );
+	}
+
+	C->flags |= (takeOwnership ? WRC_OwnsMemory : 0) | WRC_LazyRegistry | (wr_isWideBytecode(block) ? WRC_Wide : 0);
 	
 	C->w = w;
 
 	C->bottom = block;
 	C->bottomSize = blockSize;
 
-	C->codeStart = block + 3 + (C->numLocalFunctions * WR_FUNCTION_CORE_SIZE);
+	C->codeStart = block + headerSize;
 
 	uint8_t compilerFlags = READ_8_FROM_PC( block + 2 );
 
@@ -13792,24 +18296,6 @@ WRContext* wr_createContext( WRState* w, const unsigned char* block, const int b
 		C->codeStart += 4 + READ_32_FROM_PC( C->codeStart );		
 	}
 
-	int pos = 3;
-	for( int i=0; i<C->numLocalFunctions; ++i )
-	{
-		C->localFunctions[i].namespaceOffset = READ_16_FROM_PC( block + pos );
-		pos += 2;
-		C->localFunctions[i].functionOffset = READ_16_FROM_PC( block + pos );
-		pos += 2;
-		C->localFunctions[i].hash = READ_32_FROM_PC( block + pos );
-		pos += 3;
-		C->localFunctions[i].arguments = READ_8_FROM_PC( block + ++pos );
-		C->localFunctions[i].frameSpaceNeeded = READ_8_FROM_PC( block + ++pos );
-		C->localFunctions[i].frameBaseAdjustment = READ_8_FROM_PC( block + ++pos );
-		
-		++pos;
-
-		C->registry.getAsRawValueHashTable(C->localFunctions[i].hash)->wrf = C->localFunctions + i;
-	}
-
 	return C;
 }
 
@@ -13838,6 +18324,10 @@ WRContext* wr_import( WRContext* context, const unsigned char* block, const int
 		import->imported = context;
 	}
 
+#if WRENCH_CALL_SITE_CACHE
+	++context->w->callSiteGeneration;
+#endif
+
 	return import;
 }
 
@@ -13911,15 +18401,165 @@ WRContext* wr_run( WRState* w,
 	return context;
 }
 
+#ifdef WRENCH_LINUX_FILE_IO
+//------------------------------------------------------------------------------
+void wr_releaseMapped( WRMappedFile* mapped )
+{
+	if ( !__sync_sub_and_fetch(&mapped->references, 1) )
+	{
+		munmap( (void*)mapped->data, mapped->size );
+		g_free( mapped );
+	}
+}
+
+//------------------------------------------------------------------------------
+static WRMappedFile* wr_mapFile( const char* path, struct stat const& info )
+{
+	if ( info.st_size < 8 || info.st_size > 0x7FFFFFFF )
+	{
+		return 0;
+	}
+
+	int file = open( path, O_RDONLY );
+	if ( file < 0 )
+	{
+		return 0;
+	}
+
+	void* data = mmap( 0, info.st_size, PROT_READ, MAP_SHARED, file, 0 );
+	close( file );
+	if ( data == MAP_FAILED )
+	{
+		return 0;
+	}
+
+	const unsigned char* block = (const unsigned char*)data;
+	const int localFuncs = info.st_size >= WR_WIDE_HEADER_SIZE ? wr_functionsInBytecode( block ) : 0;
+	WRMappedFile* mapped = 0;
+
+	if ( info.st_size >= WR_WIDE_HEADER_SIZE
+		 && wr_functionTableEnd( block ) + 4 <= info.st_size
+		 && wr_isBytecodeValid(block, (unsigned int)info.st_size)
+		 && (mapped = (WRMappedFile*)g_malloc(sizeof(WRMappedFile) + localFuncs*sizeof(WRFunction))) )
+	{
+		mapped->data = block;
+		mapped->size = (uint32_t)info.st_size;
+		mapped->functions = (WRFunction*)(mapped + 1);
+		wr_readFunctionTable( block, localFuncs, mapped->functions );
+	}
+	else
+	{
+		munmap( data, info.st_size );
+	}
+
+	return mapped;
+}
+
+//------------------------------------------------------------------------------
+WRContext* wr_newContextMapped( WRState* w, const char* path )
+{
+	struct stat info;
+	if ( !path || stat(path, &info) )
+	{
+		w->err = WR_ERR_bad_bytecode_CRC;
+		return 0;
+	}
+
+#ifdef __APPLE__
+	const int32_t nsec = (int32_t)info.st_mtimespec.tv_nsec;
+#else
+	const int32_t nsec = (int32_t)info.st_mtim.tv_nsec;
+#endif
+
+	uint32_t pathHash = wr_hashStr( path );
+	WRMappedFile* mapped;
+	for( WRMappedFile** link = &w->mappedFiles; (mapped = *link); )
+	{
+		if ( mapped->inode == (uint64_t)info.st_ino
+			 && mapped->device == (uint64_t)info.st_dev
+			 && mapped->size == (uint32_t)info.st_size
+			 && mapped->mtime == (int64_t)info.st_mtime
+			 && mapped->mtimeNsec == nsec )
+		{
+			break;
+		}
+
+		if ( mapped->pathHash == pathHash )
+		{
+			// an older version of this file, contexts still running it
+			// keep it mapped
+			*link = mapped->next;
+			wr_releaseMapped( mapped );
+			continue;
+		}
+
+		link = &mapped->next;
+	}
+
+	if ( !mapped )
+	{
+		if ( !(mapped = wr_mapFile(path, info)) )
+		{
+			w->err = WR_ERR_bad_bytecode_CRC;
+			return 0;
+		}
+
+		mapped->pathHash = pathHash;
+		mapped->device = (uint64_t)info.st_dev;
+		mapped->inode = (uint64_t)info.st_ino;
+		mapped->mtime = (int64_t)info.st_mtime;
+		mapped->mtimeNsec = nsec;
+		mapped->references = 1;
+		mapped->next = w->mappedFiles;
+		w->mappedFiles = mapped;
+	}
+
+	WRContext* C = wr_createContext( w, mapped->data, mapped->size, false, 0, mapped->functions );
+	if ( C )
+	{
+		__sync_add_and_fetch( &mapped->references, 1 );
+		C->mapped = mapped;
+
+		C->nextStateContextLink = w->contextList;
+		w->contextList = C;
+	}
+	return C;
+}
+
+//------------------------------------------------------------------------------
+WRContext* wr_runMapped( WRState* w, const char* path )
+{
+	WRContext* context = wr_newContextMapped( w, path );
+
+	if ( context && !wr_callFunction(context, (WRFunction*)0) && !context->yield_pc )
+	{
+		wr_destroyContext( context );
+		context = 0;
+	}
+
+	return context;
+}
+#endif
+
 //------------------------------------------------------------------------------
 void wr_destroyContextEx( WRContext* context )
 {
+#if WRENCH_CALL_SITE_CACHE
+	// anything that resolved into this context is now stale
+	++context->w->callSiteGeneration;
+#endif
+
 	// g_free all memory allocations by forcing the gc to collect everything
 	context->globals = 0;
 	context->allocatedMemoryHint = (uint16_t)-1;
 	context->gc( 0 );
 
-	wr_freeGCChain( context->registry.m_nextGC );
+#ifdef WRENCH_GENERATIONAL_GC
+	if ( context->remembered )
+	{
+		g_free( context->remembered );
+	}
+#endif
 
 	context->registry.clear();
 
@@ -13928,6 +18568,20 @@ void wr_destroyContextEx( WRContext* context )
 		g_free( (void*)(context->bottom) );
 	}
 
+#ifdef WRENCH_QUICKENING
+	if ( context->threaded )
+	{
+		g_free( (void*)context->threaded );
+	}
+#endif
+
+#ifdef WRENCH_LINUX_FILE_IO
+	if ( context->mapped )
+	{
+		wr_releaseMapped( context->mapped );
+	}
+#endif
+
 	g_free( context );
 }
 
@@ -13939,37 +18593,276 @@ void wr_destroyContext( WRContext* context )
 		return;
 	}
 
-	WRContext* prev = 0;
+	WRContext* prev = 0;
+
+	// unlink it
+	for( WRContext* c = context->w->contextList; c; c = (WRContext*)c->nextStateContextLink )
+	{
+		if ( c == context )
+		{
+			if ( prev )
+			{
+				prev->nextStateContextLink = c->nextStateContextLink;
+			}
+			else
+			{
+				context->w->contextList = (WRContext*)context->w->contextList->nextStateContextLink;
+			}
+
+			while( context->imported )
+			{
+				WRContext* next = context->imported->imported;
+				wr_destroyContextEx( context->imported );
+
+				context->imported = next == context ? 0 : next; // the list is circular, stop here!
+			}
+
+			wr_destroyContextEx( context );
+
+			break;
+		}
+
+		prev = c;
+	}
+}
+
+//------------------------------------------------------------------------------
+bool wr_migrateContext( WRContext* context, WRState* to )
+{
+	if ( !context || !to )
+	{
+		return false;
+	}
+
+	WRContext** link = &context->w->contextList;
+	for( ; *link && *link != context; link = (WRContext**)&(*link)->nextStateContextLink );
+	if ( !*link )
+	{
+		return false;
+	}
+
+	*link = (WRContext*)context->nextStateContextLink;
+	context->nextStateContextLink = to->contextList;
+	to->contextList = context;
+
+	context->w = to;
+	for( WRContext* import = context->imported; import && import != context; import = import->imported )
+	{
+		import->w = to; // the list is circular
+	}
+
+#if WRENCH_CALL_SITE_CACHE
+	// resolved against the old state's registry
+	memset( (char*)context->callSiteCache, 0, sizeof(context->callSiteCache) );
+#endif
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+struct WRCloneEntry
+{
+	WRGCBase* from;
+	WRGCBase* fromNext; // while cloning from->m_nextGC points at the copy
+};
+
+//------------------------------------------------------------------------------
+struct WRClone
+{
+	WRContext* from;
+	WRContext* to;
+	WRCloneEntry* entries; // every object copied, also the work list
+	uint32_t count;
+	uint32_t size;
+	bool failed;
+};
+
+//------------------------------------------------------------------------------
+static WRGCBase* wr_cloneObject( WRClone& C, WRGCBase* from )
+{
+	if ( from->m_flags & GCFlag_Marked )
+	{
+		return from->m_nextGC; // already copied
+	}
+
+	if ( C.count >= C.size )
+	{
+		uint32_t newSize = C.size ? C.size * 2 : 64;
+		WRCloneEntry* newEntries = (WRCloneEntry*)g_malloc( newSize * sizeof(WRCloneEntry) );
+		if ( !newEntries )
+		{
+			C.failed = true;
+			return 0;
+		}
+		if ( C.entries )
+		{
+			memcpy( (char*)newEntries, (char*)C.entries, C.count * sizeof(WRCloneEntry) );
+			g_free( C.entries );
+		}
+		C.entries = newEntries;
+		C.size = newSize;
+	}
+
+	// contents are filled in from the work list
+	WRGCObject* to = C.to->getSVA( ((WRGCObject*)from)->m_size, (WRGCObjectType)from->m_type, false );
+	if ( !to )
+	{
+		C.failed = true;
+		return 0;
+	}
+
+	C.entries[C.count].from = from;
+	C.entries[C.count++].fromNext = from->m_nextGC;
+	from->m_nextGC = to;
+	from->m_flags |= GCFlag_Marked;
+
+	return to;
+}
+
+//------------------------------------------------------------------------------
+static void wr_cloneValue( WRClone& C, WRValue* to, const WRValue* from )
+{
+	WRValue* globals = (WRValue*)(C.from + 1);
+
+	if ( from->type == WR_REF || (from->type == WR_EX && IS_CONTAINER_MEMBER(from->xtype)) )
+	{
+		if ( from->r >= globals && from->r < globals + C.from->globals )
+		{
+			to->p2 = from->p2;
+			to->r = (WRValue*)(C.to + 1) + (from->r - globals);
+		}
+		else if ( from->type == WR_REF )
+		{
+			wr_cloneValue( C, to, from->r ); // anything else is copied by value
+		}
+		else
+		{
+			to->init();
+		}
+	}
+	else if ( from->type == WR_EX && IS_EXARRAY_TYPE(from->xtype) )
+	{
+		to->p2 = from->p2;
+		if ( !(to->vb = wr_cloneObject(C, from->vb)) )
+		{
+			to->init();
+		}
+	}
+	else
+	{
+		to->p = from->p;
+		to->p2 = from->p2;
+	}
+}
+
+//------------------------------------------------------------------------------
+WRContext* wr_cloneContext( WRContext* context )
+{
+	WRState* w = context->w;
+	if ( context->yield_pc || context->imported || !context->stopLocation )
+	{
+		w->err = WR_ERR_context_cannot_be_cloned;
+		return 0;
+	}
+
+	// the decoded function table is shared along with the bytecode
+	WRContext* clone = wr_createContext( w, context->bottom, context->bottomSize, false, 0, context->localFunctions );
+	if ( !clone )
+	{
+		return 0;
+	}
+
+	clone->stopLocation = context->stopLocation;
+	clone->ctxLocal = context->ctxLocal;
+	clone->nextStateContextLink = w->contextList;
+	w->contextList = clone;
+
+#ifdef WRENCH_LINUX_FILE_IO
+	if ( (clone->mapped = context->mapped) )
+	{
+		__sync_add_and_fetch( &clone->mapped->references, 1 );
+	}
+#endif
+
+	WRClone C;
+	C.from = context;
+	C.to = clone;
+	C.entries = 0;
+	C.count = 0;
+	C.size = 0;
+	C.failed = false;
 
-	// unlink it
-	for( WRContext* c = context->w->contextList; c; c = (WRContext*)c->nextStateContextLink )
+	WRValue* fromGlobals = (WRValue*)(context + 1);
+	WRValue* toGlobals = (WRValue*)(clone + 1);
+	for( int g=0; g<context->globals; ++g )
 	{
-		if ( c == context )
+		wr_cloneValue( C, toGlobals + g, fromGlobals + g );
+	}
+
+	// objects are copied breadth first so deep structures don't recurse
+	for( uint32_t e=0; e<C.count && !C.failed; ++e )
+	{
+		WRGCObject* from = (WRGCObject*)C.entries[e].from;
+		WRGCObject* to = (WRGCObject*)from->m_nextGC;
+		to->m_flags |= from->m_flags & GCFlag_Perm;
+
+		if ( from->m_type > SV_VALUE )
 		{
-			if ( prev )
+			memcpy( to->m_Cdata, from->m_Cdata, from->m_size * WR_SIZEOF_ELEMENT(from->m_type) );
+		}
+		else if ( from->m_type == SV_VALUE )
+		{
+			to->m_mod = from->m_mod;
+			if ( from->m_creatorContext != context )
 			{
-				prev->nextStateContextLink = c->nextStateContextLink;
+				to->m_ROMHashTable = from->m_ROMHashTable; // a struct, points into the shared bytecode
 			}
-			else
+
+			for( uint32_t i=0; i<from->m_size; ++i )
 			{
-				context->w->contextList = (WRContext*)context->w->contextList->nextStateContextLink;
+				wr_cloneValue( C, to->m_Vdata + i, from->m_Vdata + i );
 			}
-
-			while( context->imported )
+		}
+		else
+		{
+			for( uint32_t i=0; i<from->m_capacity; ++i )
 			{
-				WRContext* next = context->imported->imported;
-				wr_destroyContextEx( context->imported );
-
-				context->imported = next == context ? 0 : next; // the list is circular, stop here!
+				if ( from->m_hashTable[i] != WRENCH_NULL_HASH )
+				{
+					WRValue* entry = to->m_Vdata + (to->getIndexOfHit(from->m_hashTable[i]) << 1);
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+					if ( g_mallocFailed )
+					{
+						C.failed = true;
+						break;
+					}
+#endif
+					wr_cloneValue( C, entry, from->m_Vdata + (i<<1) ); // value
+					wr_cloneValue( C, entry + 1, from->m_Vdata + (i<<1) + 1 ); // key
+				}
 			}
+		}
+	}
 
-			wr_destroyContextEx( context );
+	for( uint32_t r=0; r<C.count; ++r )
+	{
+		C.entries[r].from->m_nextGC = C.entries[r].fromNext;
+		C.entries[r].from->m_flags &= ~GCFlag_Marked;
+	}
 
-			break;
-		}
+	if ( C.entries )
+	{
+		g_free( C.entries );
+	}
 
-		prev = c;
+	if ( C.failed )
+	{
+		wr_destroyContext( clone );
+		w->err = WR_ERR_malloc_failed;
+		return 0;
 	}
+
+	return clone;
 }
 
 //------------------------------------------------------------------------------
@@ -14001,6 +18894,9 @@ void wr_registerFunction( WRState* w, const char* name, WR_C_CALLBACK function,
 	WRValue* V = w->globalRegistry.getAsRawValueHashTable( wr_hashStr(name) );
 	V->usr = usr;
 	V->ccb = function;
+#if WRENCH_CALL_SITE_CACHE
+	++w->callSiteGeneration;
+#endif
 }
 
 //------------------------------------------------------------------------------
@@ -14154,9 +19050,10 @@ WRValue* WRValue::indexArray( WRContext* context, const uint32_t index, const bo
 		}
 		
 		wr_growValueArray( V.va, index );
-		context->allocatedMemoryHint += index * ((V.va->m_type == SV_CHAR) ? 1 : sizeof(WRValue));
+		context->allocatedMemoryHint += index * WR_SIZEOF_ELEMENT( V.va->m_type );
 	}
 
+	WR_GC_REMEMBER( context, V.vb );
 	return V.va->m_Vdata + index;
 }
 
@@ -14283,6 +19180,28 @@ int wr_technicalAsStringEx( char* string, const WRValue* value, size_t pos, size
 
 			pos += snprintf( string + pos, maxLen - pos, "\"" );
 		}
+		else if ( value->va->m_type > SV_CHAR )
+		{
+			pos += snprintf( string + pos, maxLen - pos, "[ " );
+
+			WRValue element;
+			for( uint32_t i=0; pos<maxLen && i<value->va->m_size; ++i )
+			{
+				if ( i )
+				{
+					pos += snprintf( string + pos, maxLen - pos, ", " );
+				}
+				wr_unpackElement( value->va, i, &element );
+				pos = wr_technicalAsStringEx( string, &element, pos, maxLen, valuesInHex );
+			}
+
+			if ( pos >= maxLen )
+			{
+				return maxLen;
+			}
+
+			pos += snprintf( string + pos, maxLen - pos, " ]" );
+		}
 		else
 		{
 			pos += snprintf( string + pos, maxLen - pos, "<raw array>" );
@@ -14293,7 +19212,7 @@ int wr_technicalAsStringEx( char* string, const WRValue* value, size_t pos, size
 		pos += snprintf( string + pos, maxLen - pos, "{ " );
 		
 		bool first = true;
-		for( int32_t element=0; element<value->va->m_mod; ++element )
+		for( uint32_t element=0; element<value->va->m_capacity; ++element )
 		{
 			if ( value->va->m_hashTable[element] != WRENCH_NULL_HASH )
 			{
@@ -14440,8 +19359,8 @@ const WRValue::Iterator WRValue::Iterator::operator++()
 	{
 		if ( m_current.type == SV_HASH_TABLE || m_current.type == SV_VOID_HASH_TABLE )
 		{
-			int temp = m_element;
-			for( ; temp < m_va->m_mod; ++temp )
+			uint32_t temp = m_element;
+			for( ; temp < m_va->m_capacity; ++temp )
 			{
 				if ( m_va->m_hashTable[temp] != WRENCH_NULL_HASH )
 				{
@@ -14496,7 +19415,7 @@ WRValue* wr_callFunction( WRContext* context, const int32_t hash, const WRValue*
 			return 0;
 		}
 
-		cF = context->registry.getAsRawValueHashTable( hash );
+		cF = wr_registry( context ).getAsRawValueHashTable( hash );
 		if ( !cF->wrf ) // not found in the registry, but...
 		{
 				cF = context->w->globalRegistry.getAsRawValueHashTable(hash);
@@ -14538,7 +19457,7 @@ WRValue* wr_returnValueFromLastCall( WRContext* context )
 //------------------------------------------------------------------------------
 WRFunction* wr_getFunction( WRContext* context, const uint32_t functionHash )
 {
-	WRValue* f = context->registry.exists(functionHash, false);
+	WRValue* f = wr_registry( context ).exists(functionHash, false);
 	return f ? f->wrf : 0;
 }
 
@@ -14561,7 +19480,7 @@ WRValue* wr_getGlobalRef( WRContext* context, const char* label )
 		match = wr_hashStr( globalLabel );
 	}
 
-	const unsigned char* symbolsBlock = context->bottom + 3 + (context->numLocalFunctions * WR_FUNCTION_CORE_SIZE);
+	const unsigned char* symbolsBlock = context->bottom + wr_functionTableEnd( context->bottom );
 	for( unsigned int i=0; i<context->globals; ++i, symbolsBlock += 4 )
 	{
 		uint32_t symbolHash = READ_32_FROM_PC( symbolsBlock );
@@ -14591,6 +19510,21 @@ WRValue& wr_makeString( WRContext* context, WRValue* val, const char* data, cons
 	return *val;
 }
 
+//------------------------------------------------------------------------------
+WRValue& wr_makeTypedArray( WRContext* context, WRValue* val, const uint32_t count, const char arrayType )
+{
+	val->va = context->getSVA( count, (WRGCObjectType)arrayType, true );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+	if ( !val->va )
+	{
+		val->p2 = INIT_AS_INT;
+		return *val;
+	}
+#endif
+	val->p2 = INIT_AS_ARRAY;
+	return *val;
+}
+
 //------------------------------------------------------------------------------
 WRValue& wr_makeContainer( WRValue* val, const uint16_t sizeHint )
 {
@@ -14739,7 +19673,7 @@ void wr_addArrayToContainer( WRValue* container, const char* name, char* array,
 	}
 
 	entry->c = array;
-	entry->p2 = INIT_AS_RAW_ARRAY | (size<<8);
+	entry->p2 = INIT_AS_RAW_ARRAY | ENCODE_ARRAY_ELEMENT_TO_P2(size);
 }
 
 //------------------------------------------------------------------------------
@@ -15061,6 +19995,57 @@ const char* c_opcodeName[] =
 	"LocalBZ8",
 	"GlobalBZ",
 	"GlobalBZ8",
+
+	"Wide",
+};
+
+//------------------------------------------------------------------------------
+const char* c_wideOpcodeName[] =
+{
+	"LoadFromLocal",
+	"LoadFromGlobal",
+
+	"CallFunctionByIndex",
+	"CallFunctionByIndexSkip1",
+
+	"PushIterator",
+	"NextValueOrJump",
+	"NextKeyValueOrJump",
+
+	"SwitchDense",
+
+	"TailCall",
+
+	"PopToLocal",
+
+	"IntLLCompareLTBZ",
+	"IntLLCompareLEBZ",
+	"IntLLCompareGTBZ",
+	"IntLLCompareGEBZ",
+	"IntLLCompareEQBZ",
+	"IntLLCompareNEBZ",
+
+	"IntLICompareLTBZ",
+	"IntLICompareLEBZ",
+	"IntLICompareGTBZ",
+	"IntLICompareGEBZ",
+	"IntLICompareEQBZ",
+	"IntLICompareNEBZ",
+
+	"IntLCountLTBZ",
+
+	"IntLLAddition",
+	"IntLLSubtraction",
+	"IntLLMultiplication",
+
+	"FloatLLAddition",
+	"FloatLLSubtraction",
+	"FloatLLMultiplication",
+	"FloatLLDivision",
+
+	"IncLocalLLCompareLT",
+	"LLIndex",
+	"LLIndexHashPair",
 };
 
 //------------------------------------------------------------------------------
@@ -15128,6 +20113,8 @@ const char* c_errStrings[]=
 	"WR_ERR_USER_err_out_of_range",
 
 	"WR_ERR_division_by_zero",
+
+	"WR_ERR_context_cannot_be_cloned",
 };
 
 #endif
@@ -15186,15 +20173,36 @@ bool wr_serializeEx( WRValueSerializer& serializer, const WRValue& val )
 			{
 				case WR_EX_ARRAY:
 				{
-					serializer.write( &(temp = value.va->m_type), 1 );
-					temp16 = wr_x16( value.va->m_size );
-					serializer.write( (char*)&temp16, 2 );
+					// sizes that don't fit in 16 bits flag the type byte
+					// and follow it with 32, older streams never set it
+					if ( value.va->m_size > 0xFFFF )
+					{
+						serializer.write( &(temp = (char)(value.va->m_type | WR_SERIALIZE_SIZE32)), 1 );
+						temp32 = wr_x32( value.va->m_size );
+						serializer.write( (char*)&temp32, 4 );
+					}
+					else
+					{
+						serializer.write( &(temp = value.va->m_type), 1 );
+						temp16 = wr_x16( (uint16_t)value.va->m_size );
+						serializer.write( (char*)&temp16, 2 );
+					}
 
-					if ( value.va->m_type == SV_CHAR )
+					if ( value.va->m_type == SV_CHAR || value.va->m_type == SV_UINT8 )
 					{
 						serializer.write( value.va->m_SCdata, value.va->m_size );
 						return true;
 					}
+					else if ( value.va->m_type == SV_INT32 || value.va->m_type == SV_FLOAT32 )
+					{
+						// both are four bytes, swapped the same way
+						for( uint32_t i=0; i<value.va->m_size; ++i )
+						{
+							temp32 = wr_x32( (uint32_t)value.va->m_Idata[i] );
+							serializer.write( (char*)&temp32, 4 );
+						}
+						return true;
+					}
 					else if ( value.va->m_type == SV_VALUE )
 					{
 						for( uint32_t i=0; i<value.va->m_size; ++i )
@@ -15211,16 +20219,20 @@ bool wr_serializeEx( WRValueSerializer& serializer, const WRValue& val )
 
 				case WR_EX_HASH_TABLE:
 				{
-					temp16 = wr_x16( value.va->m_mod );
+					if ( value.va->m_size > 0xFFFF )
+					{
+						return false; // entry count is 16 bits
+					}
+
+					temp16 = wr_x16( (uint16_t)value.va->m_size );
 					serializer.write( (char *)&temp16, 2 );
 
-					for( uint32_t i=0; i<value.va->m_mod; ++i )
+					// only live entries are written, each still flagged
+					// so older streams (which flagged empty slots) read
+					// the same way
+					for( uint32_t i=0; i<value.va->m_capacity; ++i )
 					{
-						if ( value.va->m_hashTable[i] == WRENCH_NULL_HASH )
-						{
-							serializer.write( &(temp = 0), 1 );
-						}
-						else
+						if ( value.va->m_hashTable[i] != WRENCH_NULL_HASH )
 						{
 							serializer.write( &(temp = 1), 1 );
 
@@ -15274,20 +20286,45 @@ bool wr_deserializeEx( WRValue& value, WRValueSerializer& serializer, WRContext*
 			{
 				case WR_EX_ARRAY:
 				{
-					if ( !serializer.read(&temp, 1)  // type
-						 || !serializer.read((char *)&temp16, 2) ) // size
+					uint32_t size;
+					if ( !serializer.read(&temp, 1) ) // type
+					{
+						return false;
+					}
+
+					if ( temp & WR_SERIALIZE_SIZE32 )
+					{
+						temp &= ~WR_SERIALIZE_SIZE32;
+						if ( !serializer.read((char *)&size, 4) )
+						{
+							return false;
+						}
+						size = wr_x32( size );
+					}
+					else
+					{
+						if ( !serializer.read((char *)&temp16, 2) )
+						{
+							return false;
+						}
+						size = wr_x16( temp16 );
+					}
+
+					// every element takes at least a byte, don't trust a
+					// size the rest of the stream can't hold
+					if ( size > serializer.remaining() )
 					{
 						return false;
 					}
 
-					temp16 = wr_x16( temp16 );
 					value.p2 = INIT_AS_ARRAY;
 					
 					switch( (uint8_t)temp )
 					{
 						case SV_CHAR:
+						case SV_UINT8:
 						{
-							value.va = context->getSVA( temp16, SV_CHAR, false );
+							value.va = context->getSVA( size, (WRGCObjectType)temp, false );
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
 							if ( !value.va )
 							{
@@ -15295,16 +20332,39 @@ bool wr_deserializeEx( WRValue& value, WRValueSerializer& serializer, WRContext*
 								return false;
 							}
 #endif
-							if ( !serializer.read(value.va->m_SCdata, temp16) )
+							if ( !serializer.read(value.va->m_SCdata, size) )
+							{
+								return false;
+							}
+							return true;
+						}
+
+						case SV_INT32:
+						case SV_FLOAT32:
+						{
+							value.va = context->getSVA( size, (WRGCObjectType)temp, false );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+							if ( !value.va )
 							{
+								value.p2 = INIT_AS_INT;
 								return false;
 							}
+#endif
+							for( uint32_t i=0; i<size; ++i )
+							{
+								uint32_t temp32;
+								if ( !serializer.read((char *)&temp32, 4) )
+								{
+									return false;
+								}
+								value.va->m_Idata[i] = (int32_t)wr_x32( temp32 );
+							}
 							return true;
 						}
 
 						case SV_VALUE:
 						{
-							value.va = context->getSVA( temp16, SV_VALUE, false );
+							value.va = context->getSVA( size, SV_VALUE, false );
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
 							if ( !value.va )
 							{
@@ -15312,7 +20372,7 @@ bool wr_deserializeEx( WRValue& value, WRValueSerializer& serializer, WRContext*
 								return false;
 							}
 #endif
-							for( uint16_t i=0; i<temp16; ++i )
+							for( uint32_t i=0; i<size; ++i )
 							{
 								if ( !wr_deserializeEx(value.va->m_Vdata[i], serializer, context) )
 								{
@@ -15336,7 +20396,7 @@ bool wr_deserializeEx( WRValue& value, WRValueSerializer& serializer, WRContext*
 
 					temp16 = wr_x16( temp16 );
 					
-					value.va = context->getSVA( temp16 - 1, SV_HASH_TABLE, false );
+					value.va = context->getSVA( temp16, SV_HASH_TABLE, false );
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
 					if ( !value.va )
 					{
@@ -15354,20 +20414,19 @@ bool wr_deserializeEx( WRValue& value, WRValueSerializer& serializer, WRContext*
 							return false;
 						}
 
-						if ( !temp )
-						{
-							value.va->m_Vdata[i<<1].init();
-							value.va->m_Vdata[(i<<1) + 1].init();
-							value.va->m_hashTable[i] = WRENCH_NULL_HASH;
-						}
-						else
+						if ( temp )
 						{
-							if ( !wr_deserializeEx(value.va->m_Vdata[i<<1], serializer, context)
-								 || !wr_deserializeEx(value.va->m_Vdata[(i<<1)+1], serializer, context) )
+							WRValue V( 0 );
+							WRValue K( 0 );
+							if ( !wr_deserializeEx(V, serializer, context)
+								 || !wr_deserializeEx(K, serializer, context) )
 							{
 								return false;
 							}
-							value.va->m_hashTable[i] = value.va->m_Vdata[(i<<1)+1].getHash();
+
+							WRValue* entry = (WRValue*)value.va->get( K.getHash() );
+							entry[0] = V;
+							entry[1] = K;
 						}
 					}
 					
@@ -15497,16 +20556,34 @@ void wr_formatGCObject( WRGCObject const& obj, WRstr& out )
 			out.appendFormat( "SV_CHAR : size[%d]", obj.m_size ); 
 			break;
 		}
+
+		case SV_INT32:
+		{
+			out.appendFormat( "SV_INT32 : size[%d]", obj.m_size ); 
+			break;
+		}
+
+		case SV_FLOAT32:
+		{
+			out.appendFormat( "SV_FLOAT32 : size[%d]", obj.m_size ); 
+			break;
+		}
+
+		case SV_UINT8:
+		{
+			out.appendFormat( "SV_UINT8 : size[%d]", obj.m_size ); 
+			break;
+		}
 		
 		case SV_HASH_TABLE:
 		{
-			out.appendFormat( "SV_HASH_TABLE : mod[%d] size[%d] ", obj.m_mod, obj.m_size ); 
+			out.appendFormat( "SV_HASH_TABLE : capacity[%d] size[%d] ", obj.m_capacity, obj.m_size ); 
 			break;
 		}
 		
 		case SV_VOID_HASH_TABLE:
 		{
-			out.appendFormat( "SV_VOID_HASH_TABLE : @[%p] mod[%d] ", obj.m_ROMHashTable, obj.m_mod ); 
+			out.appendFormat( "SV_VOID_HASH_TABLE : @[%p] capacity[%d] ", obj.m_ROMHashTable, obj.m_capacity ); 
 			break;
 		}
 	}
@@ -15546,7 +20623,7 @@ void wr_formatStackEntry( const WRValue* v, WRstr& out )
 
 		case WR_EX:
 		{
-			switch( v->xtype )
+			switch( v->xtype & EX_TYPE_MASK )
 			{
 				case WR_EX_RAW_ARRAY:
 				{
@@ -16254,6 +21331,59 @@ int wr_operandSizeForOpcode( const uint8_t* opPtr, const uint8_t* end, const uin
 			return 3 + (int)(count * 2U);
 		}
 
+		case O_Wide:
+		{
+			if ( opPtr + 1 > end )
+			{
+				return -1;
+			}
+			switch( READ_8_FROM_PC(opPtr) )
+			{
+				case W_LoadFromLocal:
+				case W_LoadFromGlobal:
+				case W_PopToLocal: return 3; // sub, idx16
+				case W_CallFunctionByIndex:
+				case W_CallFunctionByIndexSkip1: return 4; // sub, argc, fnIdx16
+				case W_TailCall: return 5; // sub, argc, fnIdx16, pad
+				case W_PushIterator: return 6; // sub, shape, idx16, iter16
+				case W_NextValueOrJump: return 8; // sub, shape, idx16, iter16, rel16
+				case W_NextKeyValueOrJump: return 10; // sub, shape, idx16, idx16, iter16, rel16
+				case W_IntLLCompareLTBZ:
+				case W_IntLLCompareLEBZ:
+				case W_IntLLCompareGTBZ:
+				case W_IntLLCompareGEBZ:
+				case W_IntLLCompareEQBZ:
+				case W_IntLLCompareNEBZ:
+				case W_IntLCountLTBZ:
+				case W_IncLocalLLCompareLT: return 5; // sub, idx8, idx8, rel16
+				case W_IntLICompareLTBZ:
+				case W_IntLICompareLEBZ:
+				case W_IntLICompareGTBZ:
+				case W_IntLICompareGEBZ:
+				case W_IntLICompareEQBZ:
+				case W_IntLICompareNEBZ: return 6; // sub, idx8, imm16, rel16
+				case W_IntLLAddition:
+				case W_IntLLSubtraction:
+				case W_IntLLMultiplication:
+				case W_FloatLLAddition:
+				case W_FloatLLSubtraction:
+				case W_FloatLLMultiplication:
+				case W_FloatLLDivision:
+				case W_LLIndex: return 3; // sub, idx8, idx8
+				case W_LLIndexHashPair: return 11; // sub, idx8, hash32, idx8, hash32
+				case W_SwitchDense:
+				{
+					if ( opPtr + 7 > end )
+					{
+						return -1;
+					}
+					uint16_t count = (uint16_t)READ_16_FROM_PC(opPtr + 5);
+					return 9 + (int)(count * 2U); // sub, base32, count16, default16, table
+				}
+			}
+			return -1;
+		}
+
 		default:
 		{
 			break;
@@ -16392,6 +21522,72 @@ void wr_decodeOperands( const uint8_t op,
 						  (unsigned int)opPtr[0], (unsigned int)opPtr[1], (unsigned int)opPtr[2] );
 		return;
 	}
+	if ( op == O_Wide )
+	{
+		uint8_t sub = opPtr[0];
+		ops.appendFormat( "%s", c_wideOpcodeName[sub] );
+		if ( sub == W_LoadFromLocal || sub == W_LoadFromGlobal || sub == W_PopToLocal )
+		{
+			ops.appendFormat( " %c[0x%04X]", (sub == W_LoadFromGlobal) ? 'g' : 'l', (unsigned int)(uint16_t)READ_16_FROM_PC(opPtr + 1) );
+		}
+		else if ( sub == W_CallFunctionByIndex || sub == W_CallFunctionByIndexSkip1 || sub == W_TailCall )
+		{
+			ops.appendFormat( " argc=0x%02X fnIdx=0x%04X", (unsigned int)opPtr[1], (unsigned int)(uint16_t)READ_16_FROM_PC(opPtr + 2) );
+		}
+		else if ( (sub >= W_IntLLCompareLTBZ && sub <= W_IntLLCompareNEBZ) || sub == W_IntLCountLTBZ || sub == W_IncLocalLLCompareLT )
+		{
+			int rel = (int)READ_16_FROM_PC(opPtr + 3);
+			ops.appendFormat( " l[0x%02X] l[0x%02X] rel=0x%04X ->0x%04X",
+							  (unsigned int)opPtr[1], (unsigned int)opPtr[2],
+							  (unsigned int)(uint16_t)rel, (unsigned int)(instOffset + 4 + rel) );
+		}
+		else if ( sub >= W_IntLICompareLTBZ && sub <= W_IntLICompareNEBZ )
+		{
+			int rel = (int)READ_16_FROM_PC(opPtr + 4);
+			ops.appendFormat( " l[0x%02X] imm=%d rel=0x%04X ->0x%04X",
+							  (unsigned int)opPtr[1], (int)READ_16_FROM_PC(opPtr + 2),
+							  (unsigned int)(uint16_t)rel, (unsigned int)(instOffset + 5 + rel) );
+		}
+		else if ( (sub >= W_IntLLAddition && sub <= W_FloatLLDivision) || sub == W_LLIndex )
+		{
+			ops.appendFormat( " l[0x%02X] l[0x%02X]", (unsigned int)opPtr[1], (unsigned int)opPtr[2] );
+		}
+		else if ( sub == W_LLIndexHashPair )
+		{
+			ops.appendFormat( " l[0x%02X] hash=0x%08X l[0x%02X] hash=0x%08X",
+							  (unsigned int)opPtr[1], (unsigned int)READ_32_FROM_PC(opPtr + 2),
+							  (unsigned int)opPtr[6], (unsigned int)READ_32_FROM_PC(opPtr + 7) );
+		}
+		else if ( sub == W_SwitchDense )
+		{
+			int16_t d = READ_16_FROM_PC(opPtr + 7);
+			ops.appendFormat( " base=%d count=0x%04X defaultRel=0x%04X ->0x%04X",
+							  (int)(int32_t)READ_32_FROM_PC(opPtr + 1),
+							  (unsigned int)(uint16_t)READ_16_FROM_PC(opPtr + 5),
+							  (unsigned int)(uint16_t)d,
+							  (unsigned int)(instOffset + 8 + d) );
+		}
+		else
+		{
+			int idx = 2;
+			ops.appendFormat( " %c[0x%04X]", (opPtr[1] & 1) ? 'l' : 'g', (unsigned int)(uint16_t)READ_16_FROM_PC(opPtr + idx) );
+			idx += 2;
+			if ( sub == W_NextKeyValueOrJump )
+			{
+				ops.appendFormat( " %c[0x%04X]", (opPtr[1] & 2) ? 'l' : 'g', (unsigned int)(uint16_t)READ_16_FROM_PC(opPtr + idx) );
+				idx += 2;
+			}
+			ops.appendFormat( " iter=g[0x%04X]", (unsigned int)(uint16_t)READ_16_FROM_PC(opPtr + idx) );
+			idx += 2;
+			if ( sub != W_PushIterator )
+			{
+				int rel = (int)READ_16_FROM_PC(opPtr + idx);
+				ops.appendFormat( " rel=0x%04X ->0x%04X", (unsigned int)(uint16_t)rel, (unsigned int)(instOffset + 1 + idx + rel) );
+			}
+		}
+		return;
+	}
+
 	if ( op == O_LoadLibConstant || op == O_AssignToObjectTableByHash || op == O_StackIndexHash )
 	{
 		ops.appendFormat( "hash=0x%08X", (unsigned int)READ_32_FROM_PC(opPtr) );
@@ -16699,7 +21895,7 @@ void wr_disassemble( const uint8_t* bytecode, const unsigned int len, WRstr& out
 	{
 		out += "Globals Table\n";
 		out += "-------------\n";
-		const uint8_t* gsym = context->bottom + 3 + (context->numLocalFunctions * WR_FUNCTION_CORE_SIZE);
+		const uint8_t* gsym = context->bottom + wr_functionTableEnd( context->bottom );
 		for( unsigned int g=0; g<context->globals; ++g, gsym += 4 )
 		{
 			out.appendFormat( "  g[0x%02X] hash=0x%08X\n", g, (unsigned int)READ_32_FROM_PC(gsym) );
@@ -16765,21 +21961,116 @@ void wr_disassemble( const uint8_t* bytecode, const unsigned int len, WRstr& out
 						  (unsigned int)f->frameBaseAdjustment,
 						  (unsigned int)(unitStart - context->bottom) );
 
-		wr_disassembleRange( out, context->bottom, unitStart, unitEnd, includeComments );
+		wr_disassembleRange( out, context->bottom, unitStart, unitEnd, includeComments );
+		out += "\n";
+	}
+
+	wr_destroyState( w );
+}
+
+//------------------------------------------------------------------------------
+void wr_disassemble( const uint8_t* bytecode, const unsigned int len, char** out, unsigned int* outLen )
+{
+	WRstr listing;
+	wr_disassemble( bytecode, len, listing, true );
+	listing.release( out, outLen );
+}
+
+#endif
+
+#ifdef WRENCH_OPCODE_PROFILE
+//------------------------------------------------------------------------------
+static void wr_appendProfileCode( WRstr& out, const uint32_t code )
+{
+#ifdef WRENCH_WITHOUT_COMPILER
+	out.appendFormat( (code < (uint32_t)O_LAST) ? " %u" : " Wide:%u", (unsigned int)((code < (uint32_t)O_LAST) ? code : code - O_LAST) );
+#else
+	if ( code < (uint32_t)O_LAST )
+	{
+		out.appendFormat( " %s", c_opcodeName[code] );
+	}
+	else
+	{
+		out.appendFormat( " Wide:%s", c_wideOpcodeName[code - O_LAST] );
+	}
+#endif
+}
+
+//------------------------------------------------------------------------------
+// next entry of 'count' in descending order after the one at 'index'
+// (-1 to start), ties go by index. -1 when there are no more non-zero
+static int wr_nextLargest( const uint64_t* count, const int size, const int index )
+{
+	const uint64_t below = (index >= 0) ? count[index] : ~(uint64_t)0;
+	int best = -1;
+	for( int i=0; i<size; ++i )
+	{
+		if ( count[i]
+			 && (count[i] < below || (count[i] == below && i > index))
+			 && (best == -1 || count[i] > count[best]) )
+		{
+			best = i;
+		}
+	}
+	return best;
+}
+
+//------------------------------------------------------------------------------
+static void wr_appendProfileLine( WRstr& out, const uint64_t count, const uint64_t total )
+{
+	out.appendFormat( "%14llu %6.2f%% ", (unsigned long long)count, total ? (100.0 * (double)count) / (double)total : 0.0 );
+}
+
+//------------------------------------------------------------------------------
+void wr_opcodeProfile( WRState* w, WRstr& out, const int top )
+{
+	const WROpcodeProfile* p = w->opcodeProfile;
+	out.clear();
+
+	out.appendFormat( "%llu instructions dispatched\n\ninstructions:\n", (unsigned long long)p->total );
+	int n = -1;
+	for( int i=0; i<top && (n = wr_nextLargest(p->single, WR_PROFILE_CODES, n)) != -1; ++i )
+	{
+		wr_appendProfileLine( out, p->single[n], p->total );
+		wr_appendProfileCode( out, n );
+		out += "\n";
+	}
+
+	out += "\npairs:\n";
+	n = -1;
+	for( int i=0; i<top && (n = wr_nextLargest(p->pair, WR_PROFILE_CODES*WR_PROFILE_CODES, n)) != -1; ++i )
+	{
+		wr_appendProfileLine( out, p->pair[n], p->total );
+		wr_appendProfileCode( out, n / WR_PROFILE_CODES );
+		wr_appendProfileCode( out, n % WR_PROFILE_CODES );
+		out += "\n";
+	}
+
+	uint64_t* triples = (uint64_t*)g_malloc( WR_PROFILE_TRIPLES * sizeof(uint64_t) );
+	for( int t=0; t<WR_PROFILE_TRIPLES; ++t )
+	{
+		triples[t] = p->triple[t].count;
+	}
+
+	out += "\ntriples:\n";
+	n = -1;
+	for( int i=0; i<top && (n = wr_nextLargest(triples, WR_PROFILE_TRIPLES, n)) != -1; ++i )
+	{
+		const uint32_t key = p->triple[n].key - 1;
+		wr_appendProfileLine( out, triples[n], p->total );
+		wr_appendProfileCode( out, key / (WR_PROFILE_CODES*WR_PROFILE_CODES) );
+		wr_appendProfileCode( out, (key / WR_PROFILE_CODES) % WR_PROFILE_CODES );
+		wr_appendProfileCode( out, key % WR_PROFILE_CODES );
 		out += "\n";
 	}
 
-	wr_destroyState( w );
-}
+	g_free( triples );
 
-//------------------------------------------------------------------------------
-void wr_disassemble( const uint8_t* bytecode, const unsigned int len, char** out, unsigned int* outLen )
-{
-	WRstr listing;
-	wr_disassemble( bytecode, len, listing, true );
-	listing.release( out, outLen );
+	if ( p->lostTriples )
+	{
+		out.appendFormat( "\n%llu triples not counted, the table is full\n", (unsigned long long)p->lostTriples );
+	}
 }
-
 #endif
 /*******************************************************************************
 Copyright (c) 2026 Curt Hartung -- curt.hartung@gmail.com
@@ -16975,12 +22266,10 @@ WRContext* WRDebugServerInterface::loadBytes( const uint8_t* bytes, const int le
 	I->m_stepOut = false;
 	I->m_halted = false;
  	
-	const uint8_t* code = bytes + 2;
-	
-	I->m_compilerFlags = READ_8_FROM_PC( code++ );
+	I->m_compilerFlags = READ_8_FROM_PC( bytes + 2 );
 
-	// skip over function signatures
-	code += I->m_context->numLocalFunctions * WR_FUNCTION_CORE_SIZE;
+	// skip over header and function signatures
+	const uint8_t* code = bytes + wr_functionTableEnd( bytes );
 
 	if ( I->m_compilerFlags & WR_INCLUDE_GLOBALS )
 	{
@@ -17750,82 +23039,365 @@ SOFTWARE.
 
 #ifdef WRENCH_TIME_SLICES
 
+#ifdef WRENCH_THREADED_SCHEDULER
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
 //------------------------------------------------------------------------------
 struct WrenchScheduledTask
 {
 	WRContext* context;
 	WrenchScheduledTask* next;
 	int id;
+	int priority;
+	int budget; // instructions per slice, 0 for tick()'s
+	int worker; // whose state the context lives in
+};
+
+//------------------------------------------------------------------------------
+struct WrenchSchedulerWorker
+{
+	WRState* w;
+
+	// this tick's tasks sorted by priority, the worker takes them from
+	// the front and thieves take them from the back
+	WrenchScheduledTask** queue;
+	int head;
+	int tail;
+	int capacity;
+
+	int owned; // tasks whose context lives in w
+
+	int lastErr;
+	int lastErrId;
+
+#ifdef WRENCH_THREADED_SCHEDULER
+	WrenchScheduler* scheduler;
+	pthread_mutex_t lock; // queue/head/tail
+	pthread_t thread;
+#endif
+};
+
+#ifdef WRENCH_THREADED_SCHEDULER
+//------------------------------------------------------------------------------
+struct WrenchSchedulerSync
+{
+	pthread_mutex_t lock;
+	pthread_cond_t start;
+	pthread_cond_t done;
+	pthread_mutex_t migrate; // contextList of every worker state
+	unsigned int generation; // bumped to start a tick
+	int running; // helper threads still inside the tick
+	bool quit;
 };
 
+#define QUEUE_LOCK( W ) pthread_mutex_lock( &(W)->lock )
+#define QUEUE_UNLOCK( W ) pthread_mutex_unlock( &(W)->lock )
+#else
+#define QUEUE_LOCK( W )
+#define QUEUE_UNLOCK( W )
+#endif
+
 //------------------------------------------------------------------------------
-WrenchScheduler::WrenchScheduler( const int stackSizePerThread )
+WrenchScheduler::WrenchScheduler( const int stackSizePerThread, const int workers )
 {
-	m_w = wr_newState( stackSizePerThread );
 	m_tasks = 0;
+	m_taskCount = 0;
+	m_instructionsPerSlice = 0;
 	m_lastErr = 0;
 	m_lastErrId = 0;
+	m_idGenerator = 0;
+
+#ifdef WRENCH_THREADED_SCHEDULER
+	m_workerCount = workers > 0 ? workers : (int)sysconf( _SC_NPROCESSORS_ONLN );
+	m_workerCount = m_workerCount > 0 ? m_workerCount : 1;
+#else
+	m_workerCount = 1;
+#endif
+
+	m_workers = (WrenchSchedulerWorker*)g_malloc( m_workerCount * sizeof(WrenchSchedulerWorker) );
+	memset( (char*)m_workers, 0, m_workerCount * sizeof(WrenchSchedulerWorker) );
+	for( int i=0; i<m_workerCount; ++i )
+	{
+		m_workers[i].w = wr_newState( stackSizePerThread );
+	}
+
+#ifdef WRENCH_THREADED_SCHEDULER
+	m_sync = (WrenchSchedulerSync*)g_malloc( sizeof(WrenchSchedulerSync) );
+	pthread_mutex_init( &m_sync->lock, 0 );
+	pthread_cond_init( &m_sync->start, 0 );
+	pthread_cond_init( &m_sync->done, 0 );
+	pthread_mutex_init( &m_sync->migrate, 0 );
+	m_sync->generation = 0;
+	m_sync->running = 0;
+	m_sync->quit = false;
+
+	// worker 0 is whoever calls tick()
+	for( int t=0; t<m_workerCount; ++t )
+	{
+		m_workers[t].scheduler = this;
+		pthread_mutex_init( &m_workers[t].lock, 0 );
+		if ( t )
+		{
+			pthread_create( &m_workers[t].thread, 0, workerThread, m_workers + t );
+		}
+	}
+#endif
 }
 
 //------------------------------------------------------------------------------
 WrenchScheduler::~WrenchScheduler()
 {
+#ifdef WRENCH_THREADED_SCHEDULER
+	pthread_mutex_lock( &m_sync->lock );
+	m_sync->quit = true;
+	pthread_cond_broadcast( &m_sync->start );
+	pthread_mutex_unlock( &m_sync->lock );
+
+	for( int t=0; t<m_workerCount; ++t )
+	{
+		if ( t )
+		{
+			pthread_join( m_workers[t].thread, 0 );
+		}
+		pthread_mutex_destroy( &m_workers[t].lock );
+	}
+
+	pthread_mutex_destroy( &m_sync->lock );
+	pthread_cond_destroy( &m_sync->start );
+	pthread_cond_destroy( &m_sync->done );
+	pthread_mutex_destroy( &m_sync->migrate );
+	g_free( m_sync );
+#endif
+
+	// contexts first, they may have migrated between states
 	while( m_tasks )
 	{
 		WrenchScheduledTask* next = m_tasks->next;
+		wr_destroyContext( m_tasks->context );
 		g_free( m_tasks );
 		m_tasks = next;
 	}
 
-	wr_destroyState( m_w );
+	for( int i=0; i<m_workerCount; ++i )
+	{
+		wr_destroyState( m_workers[i].w );
+		g_free( m_workers[i].queue );
+	}
+	g_free( m_workers );
 }
 
 //------------------------------------------------------------------------------
-void WrenchScheduler::tick( int instructionsPerSlice )
+WRState* WrenchScheduler::state( const int worker ) const
 {
-	wr_setInstructionsPerSlice( m_w, instructionsPerSlice );
-	WrenchScheduledTask** link = &m_tasks;
-	while( *link )
+	return (worker >= 0 && worker < m_workerCount) ? m_workers[worker].w : 0;
+}
+
+//------------------------------------------------------------------------------
+void WrenchScheduler::tick( const int instructionsPerSlice )
+{
+	m_instructionsPerSlice = instructionsPerSlice;
+
+	// deal the tasks out to the workers that own them
+	int i;
+	for( i=0; i<m_workerCount; ++i )
+	{
+		WrenchSchedulerWorker* worker = m_workers + i;
+		worker->head = 0;
+		worker->tail = 0;
+		if ( worker->capacity < worker->owned )
+		{
+			g_free( worker->queue );
+			worker->capacity = worker->owned + (worker->owned >> 1);
+			worker->queue = (WrenchScheduledTask**)g_malloc( worker->capacity * sizeof(WrenchScheduledTask*) );
+		}
+	}
+
+	WrenchScheduledTask* task;
+	for( task = m_tasks; task; task = task->next )
 	{
-		WrenchScheduledTask* task = *link;
+		WrenchSchedulerWorker* worker = m_workers + task->worker;
 
-		// If this task is complete, unlink it in-place.
-		if ( !task->context->yield_pc )
+		// stable, so equal priorities (the usual case) append in O(1)
+		int slot = worker->tail++;
+		for( ; slot && worker->queue[slot - 1]->priority < task->priority; --slot )
 		{
-			*link = task->next;
-			wr_destroyContext( task->context );
-			g_free( task );
-			continue;
+			worker->queue[slot] = worker->queue[slot - 1];
 		}
+		worker->queue[slot] = task;
+	}
+
+#ifdef WRENCH_THREADED_SCHEDULER
+	pthread_mutex_lock( &m_sync->lock );
+	m_sync->running = m_workerCount - 1;
+	++m_sync->generation;
+	pthread_cond_broadcast( &m_sync->start );
+	pthread_mutex_unlock( &m_sync->lock );
+#endif
+
+	runQueue( m_workers );
 
-		wr_callFunction( task->context, (WRFunction*)0, task->context->yield_argv, task->context->yield_argn );
+#ifdef WRENCH_THREADED_SCHEDULER
+	pthread_mutex_lock( &m_sync->lock );
+	while( m_sync->running )
+	{
+		pthread_cond_wait( &m_sync->done, &m_sync->lock );
+	}
+	pthread_mutex_unlock( &m_sync->lock );
+#endif
+
+	for( i=0; i<m_workerCount; ++i )
+	{
+		m_workers[i].owned = 0;
+		if ( m_workers[i].lastErr )
+		{
+			m_lastErr = m_workers[i].lastErr;
+			m_lastErrId = m_workers[i].lastErrId;
+			m_workers[i].lastErr = 0;
+		}
+	}
 
-		// A task can finish during this tick or may have faulted; remove it either way.
+	// tasks that finished or faulted are done, the rest may have moved
+	WrenchScheduledTask** link = &m_tasks;
+	while( (task = *link) )
+	{
 		if ( !task->context->yield_pc )
 		{
-			if ( m_w->err )
-			{
-				m_lastErr = m_w->err;
-				m_lastErrId = task->id;
-				m_w->err = 0;
-			}
 			*link = task->next;
 			wr_destroyContext( task->context );
 			g_free( task );
+			--m_taskCount;
 			continue;
 		}
 
+		++m_workers[task->worker].owned;
 		link = &task->next;
 	}
 }
 
-static int wr_idGenerator = 0;
+//------------------------------------------------------------------------------
+void WrenchScheduler::runQueue( WrenchSchedulerWorker* worker )
+{
+	const int index = (int)(worker - m_workers);
+	WRState* w = worker->w;
+
+	for(;;)
+	{
+		QUEUE_LOCK( worker );
+		WrenchScheduledTask* task = (worker->head < worker->tail) ? worker->queue[worker->head++] : 0;
+		QUEUE_UNLOCK( worker );
+
+		if ( !task && !(task = steal(worker)) )
+		{
+			return;
+		}
+
+		WRContext* context = task->context;
+		if ( task->worker != index )
+		{
+#ifdef WRENCH_THREADED_SCHEDULER
+			pthread_mutex_lock( &m_sync->migrate );
+			wr_migrateContext( context, w );
+			pthread_mutex_unlock( &m_sync->migrate );
+#endif
+			task->worker = index;
+		}
+
+		if ( !context->yield_pc )
+		{
+			continue; // completed when it was added
+		}
+
+		wr_setInstructionsPerSlice( w, task->budget ? task->budget : m_instructionsPerSlice );
+		wr_callFunction( context, (WRFunction*)0, context->yield_argv, context->yield_argn );
+
+		// A task can finish during this tick or may have faulted, tick() removes it either way.
+		if ( !context->yield_pc && w->err )
+		{
+			worker->lastErr = w->err;
+			worker->lastErrId = task->id;
+			w->err = 0;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+WrenchScheduledTask* WrenchScheduler::steal( WrenchSchedulerWorker* thief )
+{
+	const int index = (int)(thief - m_workers);
+	for( int i=1; i<m_workerCount; ++i )
+	{
+		WrenchSchedulerWorker* victim = m_workers + ((index + i) % m_workerCount);
+
+		QUEUE_LOCK( victim );
+		WrenchScheduledTask* task = (victim->head < victim->tail) ? victim->queue[--victim->tail] : 0;
+		QUEUE_UNLOCK( victim );
+
+		if ( task )
+		{
+			return task;
+		}
+	}
+
+	return 0;
+}
+
+#ifdef WRENCH_THREADED_SCHEDULER
+//------------------------------------------------------------------------------
+void* WrenchScheduler::workerThread( void* arg )
+{
+	WrenchSchedulerWorker* worker = (WrenchSchedulerWorker*)arg;
+	WrenchScheduler* S = worker->scheduler;
+	WrenchSchedulerSync* sync = S->m_sync;
+
+	unsigned int seen = 0;
+	pthread_mutex_lock( &sync->lock );
+	for(;;)
+	{
+		while( !sync->quit && sync->generation == seen )
+		{
+			pthread_cond_wait( &sync->start, &sync->lock );
+		}
+
+		if ( sync->quit )
+		{
+			break;
+		}
+
+		seen = sync->generation;
+		pthread_mutex_unlock( &sync->lock );
+
+		S->runQueue( worker );
+
+		pthread_mutex_lock( &sync->lock );
+		if ( !--sync->running )
+		{
+			pthread_cond_signal( &sync->done );
+		}
+	}
+	pthread_mutex_unlock( &sync->lock );
+
+	return 0;
+}
+#endif
+
 //------------------------------------------------------------------------------
 int WrenchScheduler::addThread( const uint8_t* byteCode, const int size, const int instructionsThisSlice, const bool takeOwnership )
 {
-	wr_setInstructionsPerSlice( m_w, instructionsThisSlice );
+	// new tasks start on whichever worker has the fewest
+	WrenchSchedulerWorker* worker = m_workers;
+	for( int i=1; i<m_workerCount; ++i )
+	{
+		if ( m_workers[i].owned < worker->owned )
+		{
+			worker = m_workers + i;
+		}
+	}
+
+	wr_setInstructionsPerSlice( worker->w, instructionsThisSlice );
 
-	WRContext* context = wr_run( m_w, byteCode, size, takeOwnership );
+	WRContext* context = wr_run( worker->w, byteCode, size, takeOwnership );
 	if ( !context )
 	{
 		return -1; // error running task
@@ -17841,15 +23413,21 @@ int WrenchScheduler::addThread( const uint8_t* byteCode, const int size, const i
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
 		g_mallocFailed = true;
 #endif
-		m_w->err = WR_ERR_malloc_failed;
+		worker->w->err = WR_ERR_malloc_failed;
 		wr_destroyContext( context );
 		return -1;
 	}
 	task->context = context;
 	task->next = m_tasks;
-	task->id = ++wr_idGenerator;
+	task->id = ++m_idGenerator;
+	task->priority = 0;
+	task->budget = 0;
+	task->worker = (int)(worker - m_workers);
 	m_tasks = task;
-			  	
+
+	++worker->owned;
+	++m_taskCount;
+
 	return task->id;
 }
 
@@ -17872,7 +23450,10 @@ bool WrenchScheduler::removeTask( const int taskId )
 			{
 				m_tasks = task->next;
 			}
-			
+
+			--m_workers[task->worker].owned;
+			--m_taskCount;
+
 			g_free( task );
 			return true;
 		}
@@ -17884,6 +23465,36 @@ bool WrenchScheduler::removeTask( const int taskId )
 	return false;
 }
 
+//------------------------------------------------------------------------------
+WrenchScheduledTask* WrenchScheduler::findTask( const int taskId ) const
+{
+	WrenchScheduledTask* task = m_tasks;
+	for( ; task && task->id != taskId; task = task->next );
+	return task;
+}
+
+//------------------------------------------------------------------------------
+bool WrenchScheduler::setTaskPriority( const int taskId, const int priority )
+{
+	WrenchScheduledTask* task = findTask( taskId );
+	if ( task )
+	{
+		task->priority = priority;
+	}
+	return task != 0;
+}
+
+//------------------------------------------------------------------------------
+bool WrenchScheduler::setTaskBudget( const int taskId, const int instructionsPerSlice )
+{
+	WrenchScheduledTask* task = findTask( taskId );
+	if ( task )
+	{
+		task->budget = instructionsPerSlice;
+	}
+	return task != 0;
+}
+
 #endif
 /*******************************************************************************
 Copyright (c) 2026 Curt Hartung -- curt.hartung@gmail.com
@@ -17981,15 +23592,60 @@ bool wr_concatStringCheck( WRValue* to, WRValue* from, WRValue* target )
 //------------------------------------------------------------------------------
 void wr_growValueArray( WRGCObject* va, int newMinIndex )
 {
-	int size_of = (va->m_type == SV_CHAR) ? 1 : sizeof(WRValue);
+	// size_t so byte counts for large arrays can't wrap
+	size_t size_of = WR_SIZEOF_ELEMENT( va->m_type );
 
 	// increase size to accommodate new element
-	int size_el = va->m_size * size_of;
+	size_t size_el = va->m_size * size_of;
+
+	if ( (uint32_t)newMinIndex >= va->m_capacity )
+	{
+		// grow by half again so appending is amortized O(1)
+		uint32_t capacity = va->m_capacity + (va->m_capacity >> 1);
+		if ( capacity <= (uint32_t)newMinIndex )
+		{
+			capacity = newMinIndex + 1;
+		}
+		
+		// create new array to hold the data, and g_free the existing one
+		uint8_t* old = va->m_Cdata;
+
+		va->m_Cdata = (uint8_t *)g_malloc( capacity * size_of );
+
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+		if ( !va->m_Cdata )
+		{
+			va->m_Cdata = old;
+			g_mallocFailed = true;
+			return;
+		}
+#endif
+
+		memcpy( va->m_Cdata, old, size_el );
+		va->freeData( old - va->m_head * size_of );
+
+		va->m_capacity = capacity;
+		va->m_head = 0;
+	}
 
-	// create new array to hold the data, and g_free the existing one
+	va->m_size = newMinIndex + 1;
+
+	// clear new entries, anything past the old size may be stale
+	memset( va->m_Cdata + size_el, 0, (va->m_size * size_of) - size_el );
+}
+
+//------------------------------------------------------------------------------
+void wr_reserveValueArray( WRGCObject* va, const uint32_t capacity )
+{
+	if ( capacity <= va->m_capacity )
+	{
+		return;
+	}
+
+	size_t size_of = WR_SIZEOF_ELEMENT( va->m_type );
 	uint8_t* old = va->m_Cdata;
 
-	va->m_Cdata = (uint8_t *)g_malloc( (newMinIndex + 1) * size_of );
+	va->m_Cdata = (uint8_t *)g_malloc( capacity * size_of );
 
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
 	if ( !va->m_Cdata )
@@ -17999,17 +23655,55 @@ void wr_growValueArray( WRGCObject* va, int newMinIndex )
 		return;
 	}
 #endif
-	
-	memcpy( va->m_Cdata, old, size_el );
-	g_free( old );
-	
-	va->m_size = newMinIndex + 1;
 
-	// clear new entries
-	memset( va->m_Cdata + size_el, 0, (va->m_size * size_of) - size_el );
+	memcpy( va->m_Cdata, old, va->m_size * size_of );
+	va->freeData( old - va->m_head * size_of );
+
+	va->m_capacity = capacity;
+	va->m_head = 0;
+}
+
+//------------------------------------------------------------------------------
+// open 'count' cleared entries at the front of an SV_VALUE array, room
+// is kept in front of m_Vdata (m_head) so this is amortized O(1)
+void wr_growValueArrayFront( WRGCObject* va, const uint32_t count )
+{
+	if ( count > va->m_head )
+	{
+		uint32_t head = count + (va->m_size >> 1);
+
+		WRValue* data = (WRValue*)g_malloc( (head + va->m_size) * sizeof(WRValue) );
+
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+		if ( !data )
+		{
+			g_mallocFailed = true;
+			return;
+		}
+#endif
+
+		memcpy( (char*)(data + head), (char*)va->m_Vdata, va->m_size * sizeof(WRValue) );
+		va->freeData( va->m_Vdata - va->m_head );
+
+		va->m_Vdata = data + head;
+		va->m_head = head;
+		va->m_capacity = va->m_size;
+	}
+
+	va->m_Vdata -= count;
+	va->m_head -= count;
+	va->m_capacity += count;
+	va->m_size += count;
+
+	memset( (char*)va->m_Vdata, 0, count * sizeof(WRValue) );
 }
 
-static WRValue s_temp1;
+// scratch results for singleValue()/deref(), one set per thread. Kept as
+// raw words since a thread-local can't have a constructor
+static WR_THREAD_LOCAL uintptr_t s_temp1Storage[ sizeof(WRValue) / sizeof(uintptr_t) ];
+static WR_THREAD_LOCAL uintptr_t s_temp2Storage[ sizeof(WRValue) / sizeof(uintptr_t) ];
+#define s_temp1 (*(WRValue*)s_temp1Storage)
+#define s_temp2 (*(WRValue*)s_temp2Storage)
 
 //------------------------------------------------------------------------------
 WRValue& WRValue::singleValue() const
@@ -18023,8 +23717,6 @@ WRValue& WRValue::singleValue() const
 	return s_temp1;
 }
 
-static WRValue s_temp2;
-
 //------------------------------------------------------------------------------
 WRValue& WRValue::deref() const
 {
@@ -18041,13 +23733,14 @@ WRValue& WRValue::deref() const
 	s_temp2.p2 = INIT_AS_INT;
 	unsigned int s = DECODE_ARRAY_ELEMENT_FROM_P2(p2);
 
-	if (IS_RAW_ARRAY(r->xtype))
+	if (vb->m_type == SV_HASH_TABLE)
 	{
-		s_temp2.ui = (s < (uint32_t)(EX_RAW_ARRAY_SIZE_FROM_P2(r->p2))) ? (uint32_t)(unsigned char)(r->c[s]) : 0;
+		// hash table members refer to the table, entries never move
+		return ((WRGCObject*)vb)->m_Vdata[s].deref();
 	}
-	else if (vb->m_type == SV_HASH_INTERNAL)
+	else if (IS_RAW_ARRAY(r->xtype))
 	{
-		return ((WRValue*)(vb + 1))[s].deref();
+		s_temp2.ui = (s < (uint32_t)(EX_RAW_ARRAY_SIZE_FROM_P2(r->p2))) ? (uint32_t)(unsigned char)(r->c[s]) : 0;
 	}
 	else if (s < r->va->m_size)
 	{
@@ -18057,13 +23750,16 @@ WRValue& WRValue::deref() const
 		}
 		else
 		{
-			s_temp2.ui = (uint32_t)(unsigned char)r->va->m_Cdata[s];
+			wr_unpackElement( r->va, s, &s_temp2 );
 		}
 	}
 
 	return s_temp2;
 }
 
+#undef s_temp1
+#undef s_temp2
+
 //------------------------------------------------------------------------------
 uint32_t WRValue::getHashEx() const
 {
@@ -18083,18 +23779,18 @@ uint32_t WRValue::getHashEx() const
 		{
 			return wr_hash(va->m_Cdata, va->m_size);
 		}
-		else if (va->m_type == SV_VALUE)
+		else if (va->m_type >= SV_VALUE)
 		{
-			return wr_hash(va->m_Vdata, va->m_size * sizeof(WRValue));
+			return wr_hash(va->m_Vdata, va->m_size * WR_SIZEOF_ELEMENT(va->m_type));
 		}
 	}
 	else if (xtype == WR_EX_HASH_TABLE)
 	{
 		// start with a hash of the key hashes
-		uint32_t hash = wr_hash(va->m_hashTable, va->m_mod * sizeof(uint32_t));
+		uint32_t hash = wr_hash(va->m_hashTable, va->m_capacity * sizeof(uint32_t));
 
 		// hash each element, positionally dependant
-		for (uint32_t e = 0; e < va->m_mod; ++e)
+		for (uint32_t e = 0; e < va->m_capacity; ++e)
 		{
 			if (va->m_hashTable[e] != WRENCH_NULL_HASH)
 			{
@@ -18120,8 +23816,45 @@ uint32_t WRValue::getHashEx() const
 
 		return hash;
 	}
-
-	return 0;
+
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+void wr_unpackElement( const WRGCObject* va, const uint32_t element, WRValue* value )
+{
+	if ( va->m_type == SV_INT32 )
+	{
+		value->p2 = INIT_AS_INT;
+		value->i = va->m_Idata[element];
+	}
+	else if ( va->m_type == SV_FLOAT32 )
+	{
+		value->p2 = INIT_AS_FLOAT;
+		value->f = va->m_Fdata[element];
+	}
+	else // SV_CHAR and SV_UINT8
+	{
+		value->p2 = INIT_AS_INT;
+		value->ui = va->m_Cdata[element];
+	}
+}
+
+//------------------------------------------------------------------------------
+void wr_packElement( WRGCObject* va, const uint32_t element, const WRValue* value )
+{
+	if ( va->m_type == SV_FLOAT32 )
+	{
+		va->m_Fdata[element] = value->asFloat();
+	}
+	else if ( va->m_type == SV_INT32 )
+	{
+		va->m_Idata[element] = value->asInt();
+	}
+	else
+	{
+		va->m_Cdata[element] = (unsigned char)value->asInt();
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -18146,12 +23879,12 @@ void wr_valueToEx( const WRValue* ex, WRValue* value )
 					return; // grow failed, don't write out of bounds
 				}
 #endif
-				ex->va->m_creatorContext->allocatedMemoryHint += s * ((ex->va->m_type == SV_CHAR) ? 1 : sizeof(WRValue));
+				ex->va->m_creatorContext->allocatedMemoryHint += s * WR_SIZEOF_ELEMENT( ex->va->m_type );
 			}
 
-			if ( ex->va->m_type == SV_CHAR )
+			if ( ex->va->m_type != SV_VALUE )
 			{
-				ex->va->m_Cdata[s] = value->ui;
+				wr_packElement( ex->va, s, value );
 			}
 			else
 			{
@@ -18159,10 +23892,22 @@ void wr_valueToEx( const WRValue* ex, WRValue* value )
 				wr_assign[(V->type<<2)+value->type](V, value);
 			}
 		}
-		else if ( IS_CONTAINER_MEMBER(ex->xtype) && IS_RAW_ARRAY(ex->r->xtype) )
+		else if ( IS_CONTAINER_MEMBER(ex->xtype) && ex->vb->m_type != SV_HASH_TABLE && IS_RAW_ARRAY(ex->r->xtype) )
 		{
 			ex->r->c[s] = value->ui;
 		}
+		else if ( IS_CONTAINER_MEMBER(ex->xtype)
+				  && ex->vb->m_type != SV_HASH_TABLE
+				  && IS_ARRAY(ex->r->xtype)
+				  && ex->r->va->m_type != SV_VALUE )
+		{
+			// chars and packed elements have no WRValue to write
+			// through, deref() would hand back a copy
+			if ( s < ex->r->va->m_size )
+			{
+				wr_packElement( ex->r->va, s, &value->deref() );
+			}
+		}
 		else
 		{
 			ex->deref() = value->deref();
@@ -18246,6 +23991,8 @@ void wr_assignToHashTable( WRContext* c, WRValue* index, WRValue* value, WRValue
 		table->p2 = INIT_AS_HASH_TABLE;
 	}
 
+	WR_GC_REMEMBER( c, table->vb );
+
 	WRValue *entry = (WRValue *)table->va->get( index->getHash() );
 
 	*entry++ = *value;
@@ -18638,11 +24385,6 @@ SOFTWARE.
 
 #ifndef WRENCH_COMPACT
 
-// Define 32-bit signed integer overflow behavior explicitly as two's-complement wrap.
-inline int32_t wr_iadd_wrap( const int32_t a, const int32_t b ) { return (int32_t)((uint32_t)a + (uint32_t)b); }
-inline int32_t wr_isub_wrap( const int32_t a, const int32_t b ) { return (int32_t)((uint32_t)a - (uint32_t)b); }
-inline int32_t wr_imul_wrap( const int32_t a, const int32_t b ) { return (int32_t)((uint32_t)a * (uint32_t)b); }
-
 void doVoidFuncBlank( WRValue* to, WRValue* from ) {}
 
 #define X_LOGIC_ASSIGN( NAME, OPERATION ) \
@@ -19517,7 +25259,7 @@ SOFTWARE.
 #include "wrench.h"
 
 //------------------------------------------------------------------------------
-void arrayElementToTarget( const uint32_t index, WRValue* target, WRValue* value )
+void arrayElementToTarget( WRContext* c, const uint32_t index, WRValue* target, WRValue* value )
 {
 	if ( target == value )
 	{
@@ -19530,10 +25272,9 @@ void arrayElementToTarget( const uint32_t index, WRValue* target, WRValue* value
 		{
 			*target = value->va->m_Vdata[ index ];
 		}
-		else if ( value->va->m_type == SV_CHAR )
+		else if ( value->va->m_type > SV_VALUE )
 		{
-			target->p2 = INIT_AS_INT;
-			target->ui = value->va->m_Cdata[ index ];
+			wr_unpackElement( value->va, index, target );
 		}
 		else // SV_HASH_TABLE, right?
 		{
@@ -19542,6 +25283,12 @@ void arrayElementToTarget( const uint32_t index, WRValue* target, WRValue* value
 	}
 	else
 	{
+#ifdef WRENCH_GENERATIONAL_GC
+		if ( !IS_RAW_ARRAY(value->xtype) )
+		{
+			WR_GC_REMEMBER( c, value->vb );
+		}
+#endif
 		target->r = value;
 		target->p2 = INIT_AS_CONTAINER_MEMBER | ENCODE_ARRAY_ELEMENT_TO_P2( index );
 	}
@@ -19556,10 +25303,12 @@ WRValue* wr_valueFromConfirmedStruct( WRValue* value, uint32_t hash )
 }
 
 //------------------------------------------------------------------------------
-void wr_doIndexHash( WRValue* index, WRValue* value, WRValue* target )
+void wr_doIndexHash( WRContext* c, WRValue* index, WRValue* value, WRValue* target )
 {
 	uint32_t hash = index->getHash();
 
+	WR_GC_REMEMBER( c, value->vb );
+
 	if ( value->xtype == WR_EX_HASH_TABLE ) 
 	{
 		int element;
@@ -19569,7 +25318,7 @@ void wr_doIndexHash( WRValue* index, WRValue* value, WRValue* target )
 		*(entry + 1) = *index; // might be the first time it was registered
 
 		target->p2 = INIT_AS_CONTAINER_MEMBER | ENCODE_ARRAY_ELEMENT_TO_P2( element );
-		target->vb = (WRGCBase*)(value->va->m_Vdata) - 1;
+		target->vb = value->vb;
 	}
 	else // naming an element of a struct "S.element"
 	{
@@ -19598,13 +25347,13 @@ void doIndex_I_X( WRContext* c, WRValue* index, WRValue* value, WRValue* target
 #endif
 	value->p2 = INIT_AS_ARRAY;
 	
-	arrayElementToTarget( index->ui, target, value );
+	arrayElementToTarget( c, index->ui, target, value );
 }
 
 //------------------------------------------------------------------------------
 void doIndex_I_E( WRContext* c, WRValue* index, WRValue* value, WRValue* target )
 {
-	if ( IS_CONTAINER_MEMBER(value->xtype) && IS_RAW_ARRAY(value->r->xtype) )
+	if ( IS_CONTAINER_MEMBER(value->xtype) && value->vb->m_type != SV_HASH_TABLE && IS_RAW_ARRAY(value->r->xtype) )
 	{
 		unsigned int s = DECODE_ARRAY_ELEMENT_FROM_P2(value->r->p2);
 
@@ -19617,7 +25366,7 @@ void doIndex_I_E( WRContext* c, WRValue* index, WRValue* value, WRValue* target
 
 		if (EXPECTS_HASH_INDEX(value->xtype))
 		{
-			wr_doIndexHash( index, value, target );
+			wr_doIndexHash( c, index, value, target );
 			return;
 		}
 
@@ -19660,7 +25409,7 @@ void doIndex_I_E( WRContext* c, WRValue* index, WRValue* value, WRValue* target
 #endif
 				value->p2 = INIT_AS_HASH_TABLE;
 
-				wr_doIndexHash( I, value, target );
+				wr_doIndexHash( c, I, value, target );
 				return;
 			}
 		}
@@ -19676,7 +25425,7 @@ boundsFailed:
 			wr_growValueArray( value->va, index->ui );
 		}
 
-		arrayElementToTarget( index->ui, target, value );
+		arrayElementToTarget( c, index->ui, target, value );
 	}
 }
 
@@ -19715,7 +25464,7 @@ void doIndex_E_E( WRContext* c, WRValue* index, WRValue* value, WRValue* target
 		}
 		else
 		{
-			wr_doIndexHash( I, V, target );
+			wr_doIndexHash( c, I, V, target );
 		}
 	}
 	else
@@ -19788,7 +25537,6 @@ SOFTWARE.
 
 // standard functions that sort of come up a lot
 
-int32_t wr_Seed = 0xA5EED;
 
 //------------------------------------------------------------------------------
 uint32_t wr_hash_read8( const void *dat, const int len )
@@ -19936,12 +25684,18 @@ int wr_ftoa( float f, char* string, size_t len )
 }
 
 //------------------------------------------------------------------------------
-const int32_t wr_randEx( const int32_t from, const int32_t to )
+void wr_setRandomSeed( WRState* w, const int32_t seed )
+{
+	w->randomSeed = seed;
+}
+
+//------------------------------------------------------------------------------
+const int32_t wr_randEx( WRState* w, const int32_t from, const int32_t to )
 {
-	const int32_t k = wr_Seed / 127773;
-	wr_Seed = 16807 * (wr_Seed - k * 127773) - 2836 * k;
+	const int32_t k = w->randomSeed / 127773;
+	w->randomSeed = 16807 * (w->randomSeed - k * 127773) - 2836 * k;
 
-	return (from >= to) ? from : ((uint32_t)wr_Seed % ((to - from) + 1)) + from;
+	return (from >= to) ? from : ((uint32_t)w->randomSeed % ((to - from) + 1)) + from;
 }
 
 //------------------------------------------------------------------------------
@@ -19952,8 +25706,8 @@ void wr_std_rand( WRValue* stackTop, const int argn, WRContext* c )
 		WRValue* args = stackTop - argn;
 
 		stackTop->i = argn > 1 ?
-					  wr_randEx(args[0].asInt(), args[1].asInt())
-							   : wr_randEx( 0, args[0].asInt() );
+					  wr_randEx(c->w, args[0].asInt(), args[1].asInt())
+							   : wr_randEx( c->w, 0, args[0].asInt() );
 	}
 }
 
@@ -19962,7 +25716,7 @@ void wr_std_srand( WRValue* stackTop, const int argn, WRContext* c )
 {
 	if ( argn == 1 )
 	{
-		wr_Seed = (uint32_t)((stackTop - 1)->asInt());
+		c->w->randomSeed = (uint32_t)((stackTop - 1)->asInt());
 	}
 }
 
@@ -20028,6 +25782,7 @@ void wr_loadAllLibs( WRState* w )
 	wr_loadDebugLib( w );
 	wr_loadTCPLib( w );
 	wr_loadContainerLib( w );
+	wr_loadVecLib( w );
 }
 /*******************************************************************************
 Copyright (c) 2026 Curt Hartung -- curt.hartung@gmail.com
@@ -21715,555 +27470,922 @@ unsigned int wr_doSprintf( WRValue& to, WRValue& fmt, WRValue* args, const int a
 		#ifdef WRENCH_HANDLE_MALLOC_FAIL
 		if ( !to.va )
 		{
-			to.p2 = WR_INT;
-			return 0;
+			to.p2 = WR_INT;
+			return 0;
+		}
+		#endif
+
+		memcpy( to.va->m_Cdata, tmpbuf, size );
+	}
+	else
+	{
+		size = wr_sprintfEx( outbuf, outbufSize, fmtbuffer, fmtBufferSize, args, argn );
+
+		if ( size > outbufSize )
+		{
+createNewBuffer:
+
+			to.va = c->getSVA( size, SV_CHAR, false );
+
+			#ifdef WRENCH_HANDLE_MALLOC_FAIL
+			if ( !to.va )
+			{
+				to.p2 = WR_INT;
+				return 0;
+			}
+			#endif
+			wr_sprintfEx( (char *)to.va->m_Cdata, size, fmtbuffer, fmtBufferSize, args, argn );
+			}
+			else
+			{
+				// Keep amortized behavior for normal growth/shrink patterns,
+				// but release oversized buffers when utilization gets very low.
+				// This avoids long-lived large allocations after temporary spikes.
+				if ( outbufSize > WR_FORMAT_TRY_SIZE
+					 && size > 0
+					 && outbufSize >= (size << 2) )
+				{
+					to.va = c->getSVA( size, SV_CHAR, false );
+
+					#ifdef WRENCH_HANDLE_MALLOC_FAIL
+					if ( !to.va )
+					{
+						to.p2 = WR_INT;
+						return 0;
+					}
+					#endif
+					wr_sprintfEx( (char *)to.va->m_Cdata, size, fmtbuffer, fmtBufferSize, args, argn );
+				}
+				else
+				{
+					to.va->m_size = size;
+				}
+			}
+		}
+
+	to.p2 = INIT_AS_ARRAY;
+
+	return size;
+
+}
+
+
+//------------------------------------------------------------------------------
+void wr_format( WRValue* stackTop, const int argn, WRContext* c )
+{
+	if( argn > 0 )
+	{
+		WRValue* args = stackTop - argn;
+		wr_doSprintf( *stackTop, args->deref(), args + 1, argn - 1, c );
+	}
+}
+
+//------------------------------------------------------------------------------
+void wr_sprintf( WRValue* stackTop, const int argn, WRContext* c )
+{
+	if( argn > 1 )
+	{
+		WRValue* args = stackTop - argn;
+		stackTop->i = wr_doSprintf( args->deref(), args[1].deref(), args + 2, argn - 2, c );
+	}
+}
+
+//------------------------------------------------------------------------------
+void wr_printf( WRValue* stackTop, const int argn, WRContext* c )
+{
+	unsigned int chars = 0;
+	if( argn > 0 )
+	{
+		WRValue* args = stackTop - argn;
+		if ( (chars = wr_doSprintf( *stackTop, args->deref(), args + 1, argn - 1, c )) )
+		{
+#if !defined(WRENCH_WIN32_FILE_IO) && !defined(WRENCH_LINUX_FILE_IO) && !defined(WRENCH_SPIFFS_FILE_IO) && !defined(WRENCH_LITTLEFS_FILE_IO)
+			printf( "%s", (const char*)stackTop->va->m_Cdata );
+#else
+			wr_stdout( (const char*)stackTop->va->m_Cdata, stackTop->va->m_size );
+#endif
+		}
+	}
+
+	stackTop->p2 = WR_INT;
+	stackTop->i = chars;
+}
+
+//------------------------------------------------------------------------------
+void wr_isspace( WRValue* stackTop, const int argn, WRContext* c )
+{
+	if ( argn == 1 )
+	{
+		stackTop->i = (int)isspace( (char)(stackTop - 1)->asInt() );
+	}
+}
+
+//------------------------------------------------------------------------------
+void wr_isalpha( WRValue* stackTop, const int argn, WRContext* c )
+{
+	if ( argn == 1 )
+	{
+		stackTop->i = (int)isalpha( (char)(stackTop - 1)->asInt() );
+	}
+}
+
+//------------------------------------------------------------------------------
+void wr_isdigit( WRValue* stackTop, const int argn, WRContext* c )
+{
+	if ( argn == 1 )
+	{
+		stackTop->i = (int)isdigit( (char)(stackTop - 1)->asInt() );
+	}
+}
+
+//------------------------------------------------------------------------------
+void wr_isalnum( WRValue* stackTop, const int argn, WRContext* c )
+{
+	if ( argn == 1 )
+	{
+		stackTop->i = (int)isalnum( (char)(stackTop - 1)->asInt() );
+	}
+}
+
+//------------------------------------------------------------------------------
+void wr_mid( WRValue* stackTop, const int argn, WRContext* c )
+{
+	if ( argn < 2 )
+	{
+		return;
+	}
+
+	WRValue* args = stackTop - argn;
+	unsigned int len;
+	const char* data = (char *)(args[0].array(&len));
+	
+	if( !data || len <= 0 )
+	{
+		return;
+	}
+	
+	unsigned int start = args[1].asInt();
+
+	unsigned int chars = 0;
+	if ( start < len )
+	{
+		chars = (argn > 2) ? args[2].asInt() : len;
+		if ( chars > (len - start) )
+		{
+			chars = len - start;
+		}
+	}
+	
+	stackTop->va = c->getSVA( chars, SV_CHAR, false );
+
+	#ifdef WRENCH_HANDLE_MALLOC_FAIL
+	if ( !stackTop->va )
+	{
+		return;
+	}
+	#endif
+	
+	stackTop->p2 = INIT_AS_ARRAY;
+	memcpy( stackTop->va->m_Cdata, data + start, chars );
+}
+
+//------------------------------------------------------------------------------
+void wr_strchr( WRValue* stackTop, const int argn, WRContext* c )
+{
+	stackTop->i = -1;
+
+	if ( argn < 2 )
+	{
+		return;
+	}
+
+	WRValue* args = stackTop - argn;
+
+	unsigned int len;
+	const char* str = (const char*)(args[0].array(&len));
+	if ( !str )
+	{
+		return;
+	}
+	
+	char ch = (char)args[1].asInt();
+	for( unsigned int i=0; i<len; ++i )
+	{
+		if ( str[i] == ch )
+		{
+			stackTop->i = i;
+			break;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+void wr_tolower( WRValue* stackTop, const int argn, WRContext* c )
+{
+	if ( argn == 1 )
+	{
+		WRValue& value = (stackTop - 1)->deref();
+		if ( value.xtype == WR_EX_ARRAY && value.va->m_type == SV_CHAR )
+		{
+			stackTop->va = c->getSVA( value.va->m_size, SV_CHAR, false );
+
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+			if ( !stackTop->va )
+			{
+				return;
+			}
+#endif
+			stackTop->p2 = INIT_AS_ARRAY;
+
+			for( uint32_t i=0; i<value.va->m_size; ++i )
+			{
+				stackTop->va->m_SCdata[i] = tolower(value.va->m_SCdata[i]);
+			}
+		}
+		else if ( value.type == WR_INT )
+		{
+			stackTop->i = (int)tolower( (stackTop - 1)->asInt() );
 		}
-		#endif
-
-		memcpy( to.va->m_Cdata, tmpbuf, size );
 	}
-	else
-	{
-		size = wr_sprintfEx( outbuf, outbufSize, fmtbuffer, fmtBufferSize, args, argn );
+}
 
-		if ( size > outbufSize )
+//------------------------------------------------------------------------------
+void wr_toupper( WRValue* stackTop, const int argn, WRContext* c )
+{
+	if ( argn == 1 )
+	{
+		WRValue& value = (stackTop - 1)->deref();
+		if ( value.xtype == WR_EX_ARRAY && value.va->m_type == SV_CHAR )
 		{
-createNewBuffer:
-
-			to.va = c->getSVA( size, SV_CHAR, false );
-
-			#ifdef WRENCH_HANDLE_MALLOC_FAIL
-			if ( !to.va )
+			stackTop->va = c->getSVA( value.va->m_size, SV_CHAR, false );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+			if ( !stackTop->va )
 			{
-				to.p2 = WR_INT;
-				return 0;
-			}
-			#endif
-			wr_sprintfEx( (char *)to.va->m_Cdata, size, fmtbuffer, fmtBufferSize, args, argn );
+				return;
 			}
-			else
-			{
-				// Keep amortized behavior for normal growth/shrink patterns,
-				// but release oversized buffers when utilization gets very low.
-				// This avoids long-lived large allocations after temporary spikes.
-				if ( outbufSize > WR_FORMAT_TRY_SIZE
-					 && size > 0
-					 && outbufSize >= (size << 2) )
-				{
-					to.va = c->getSVA( size, SV_CHAR, false );
+#endif
+			stackTop->p2 = INIT_AS_ARRAY;
 
-					#ifdef WRENCH_HANDLE_MALLOC_FAIL
-					if ( !to.va )
-					{
-						to.p2 = WR_INT;
-						return 0;
-					}
-					#endif
-					wr_sprintfEx( (char *)to.va->m_Cdata, size, fmtbuffer, fmtBufferSize, args, argn );
-				}
-				else
-				{
-					to.va->m_size = size;
-				}
+			for( uint32_t i=0; i<value.va->m_size; ++i )
+			{
+				stackTop->va->m_SCdata[i] = toupper(value.va->m_SCdata[i]);
 			}
 		}
+		else if ( value.type == WR_INT )
+		{
+			stackTop->i = (int)toupper( (stackTop - 1)->asInt() );
+		}
 
-	to.p2 = INIT_AS_ARRAY;
-
-	return size;
-
+	}
 }
 
-
 //------------------------------------------------------------------------------
-void wr_format( WRValue* stackTop, const int argn, WRContext* c )
+void wr_tol( WRValue* stackTop, const int argn, WRContext* c )
 {
-	if( argn > 0 )
+	char buf[21];
+	if ( argn == 2 )
 	{
-		WRValue* args = stackTop - argn;
-		wr_doSprintf( *stackTop, args->deref(), args + 1, argn - 1, c );
+		stackTop->i = (int)strtol( stackTop[-2].asString(buf, 20), 0, stackTop[-1].asInt() );
+	}
+	else if ( argn == 1 )
+	{
+		stackTop->i = (int)strtol( stackTop[-1].asString(buf, 20), 0, 10 );
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_sprintf( WRValue* stackTop, const int argn, WRContext* c )
+void wr_concat( WRValue* stackTop, const int argn, WRContext* c )
 {
-	if( argn > 1 )
+	if ( argn < 2 )
 	{
-		WRValue* args = stackTop - argn;
-		stackTop->i = wr_doSprintf( args->deref(), args[1].deref(), args + 2, argn - 2, c );
+		return;
+	}
+
+	WRValue* args = stackTop - argn;
+	unsigned int len1 = 0;
+	unsigned int len2 = 0;
+	const char* data1 = (const char*)args[0].array( &len1 );
+	const char* data2 = (const char*)args[1].array( &len2 );
+
+	if( !data1 || !data2 )
+	{
+		return;
+	}
+
+	stackTop->va = c->getSVA( len1 + len2, SV_CHAR, false );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+	if ( !stackTop->va )
+	{
+		return;
 	}
+#endif
+	stackTop->p2 = INIT_AS_ARRAY;
+	memcpy( stackTop->va->m_Cdata, data1, len1 );
+	memcpy( stackTop->va->m_Cdata + len1, data2, len2 );
 }
 
 //------------------------------------------------------------------------------
-void wr_printf( WRValue* stackTop, const int argn, WRContext* c )
+void wr_left( WRValue* stackTop, const int argn, WRContext* c )
 {
-	unsigned int chars = 0;
-	if( argn > 0 )
+	if ( argn < 2 )
 	{
-		WRValue* args = stackTop - argn;
-		if ( (chars = wr_doSprintf( *stackTop, args->deref(), args + 1, argn - 1, c )) )
-		{
-#if !defined(WRENCH_WIN32_FILE_IO) && !defined(WRENCH_LINUX_FILE_IO) && !defined(WRENCH_SPIFFS_FILE_IO) && !defined(WRENCH_LITTLEFS_FILE_IO)
-			printf( "%s", (const char*)stackTop->va->m_Cdata );
-#else
-			wr_stdout( (const char*)stackTop->va->m_Cdata, stackTop->va->m_size );
-#endif
-		}
+		return;
 	}
 
-	stackTop->p2 = WR_INT;
-	stackTop->i = chars;
+	WRValue* args = stackTop - argn;
+	unsigned int len = 0;
+	const char* data = (const char*)args[0].array(&len );
+	if ( !data )
+	{
+		return;
+	}
+	unsigned int chars = args[1].asInt();
+
+	if ( chars > len )
+	{
+		chars = len;
+	}
+	
+	stackTop->va = c->getSVA( chars, SV_CHAR, false );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+	if ( !stackTop->va )
+	{
+		return;
+	}
+#endif
+	stackTop->p2 = INIT_AS_ARRAY;
+
+	memcpy( stackTop->va->m_Cdata, data, chars );
 }
 
 //------------------------------------------------------------------------------
-void wr_isspace( WRValue* stackTop, const int argn, WRContext* c )
+void wr_right( WRValue* stackTop, const int argn, WRContext* c )
 {
-	if ( argn == 1 )
+	if ( argn < 2 )
 	{
-		stackTop->i = (int)isspace( (char)(stackTop - 1)->asInt() );
+		return;
+	}
+
+	WRValue* args = stackTop - argn;
+	unsigned int len = 0;
+	const char* data = (const char*)args[0].array(&len );
+	if ( !data )
+	{
+		return;
+	}
+	unsigned int chars = args[1].asInt();
+
+	if ( chars > len )
+	{
+		chars = len;
+	}
+
+	stackTop->va = c->getSVA( chars, SV_CHAR, false );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+	if ( !stackTop->va )
+	{
+		return;
 	}
+#endif
+	stackTop->p2 = INIT_AS_ARRAY;
+	memcpy( stackTop->va->m_Cdata, data + (len - chars), chars );
 }
 
 //------------------------------------------------------------------------------
-void wr_isalpha( WRValue* stackTop, const int argn, WRContext* c )
+void wr_trimright( WRValue* stackTop, const int argn, WRContext* c )
 {
-	if ( argn == 1 )
+	WRValue* args = stackTop - argn;
+	const char* data;
+	int len = 0;
+	
+	if ( argn < 1 || ((data = (const char*)args->array((unsigned int *)&len)) == 0) )
 	{
-		stackTop->i = (int)isalpha( (char)(stackTop - 1)->asInt() );
+		return;
+	}
+
+	while( --len >= 0 && isspace(data[len]) );
+
+	++len;
+
+	stackTop->va = c->getSVA( len, SV_CHAR, false );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+	if ( !stackTop->va )
+	{
+		return;
 	}
+#endif
+	stackTop->p2 = INIT_AS_ARRAY;
+
+	memcpy( stackTop->va->m_Cdata, data, len );
 }
 
 //------------------------------------------------------------------------------
-void wr_isdigit( WRValue* stackTop, const int argn, WRContext* c )
+void wr_trimleft( WRValue* stackTop, const int argn, WRContext* c )
 {
-	if ( argn == 1 )
+	WRValue* args = stackTop - argn;
+	const char* data;
+	unsigned int len = 0;
+	
+	if ( argn < 1 || ((data = (const char*)args->array(&len)) == 0) )
 	{
-		stackTop->i = (int)isdigit( (char)(stackTop - 1)->asInt() );
+		return;
+	}
+
+	unsigned int marker = 0;
+	while( marker < len && isspace(data[marker]) ) { ++marker; }
+
+	stackTop->va = c->getSVA( len - marker, SV_CHAR, false );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+	if ( !stackTop->va )
+	{
+		return;
 	}
+#endif
+	stackTop->p2 = INIT_AS_ARRAY;
+
+	memcpy( stackTop->va->m_Cdata, data + marker, len - marker );
 }
 
 //------------------------------------------------------------------------------
-void wr_isalnum( WRValue* stackTop, const int argn, WRContext* c )
+void wr_trim( WRValue* stackTop, const int argn, WRContext* c )
 {
-	if ( argn == 1 )
+	WRValue* args = stackTop - argn;
+	const char* data;
+	int len = 0;
+	if ( argn < 1 || ((data = (const char*)args->array((unsigned int*)&len)) == 0) )
 	{
-		stackTop->i = (int)isalnum( (char)(stackTop - 1)->asInt() );
+		return;
+	}
+
+	int marker = 0;
+	while( marker < len && isspace(data[marker]) ) { ++marker; }
+
+	while( --len >= marker && isspace(data[len]) );
+
+	++len;
+
+	stackTop->va = c->getSVA( len - marker, SV_CHAR, false );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+	if ( !stackTop->va )
+	{
+		return;
 	}
+#endif
+	stackTop->p2 = INIT_AS_ARRAY;
+
+	memcpy( stackTop->va->m_Cdata, data + marker, len - marker );
 }
 
 //------------------------------------------------------------------------------
-void wr_mid( WRValue* stackTop, const int argn, WRContext* c )
+void wr_insert( WRValue* stackTop, const int argn, WRContext* c )
 {
-	if ( argn < 2 )
+	if ( argn < 3 )
 	{
 		return;
 	}
 
 	WRValue* args = stackTop - argn;
-	unsigned int len;
-	const char* data = (char *)(args[0].array(&len));
-	
-	if( !data || len <= 0 )
+	unsigned int len1 = 0;
+	unsigned int len2 = 0;
+	const char* data1 = (const char*)args[0].array( &len1 );
+	const char* data2 = (const char*)args[1].array( &len2 );
+
+	if( !data1 || !data2 )
 	{
 		return;
 	}
 	
-	unsigned int start = args[1].asInt();
-
-	unsigned int chars = 0;
-	if ( start < len )
+	unsigned int pos = args[2].asInt();
+	if ( pos >= len1 )
 	{
-		chars = (argn > 2) ? args[2].asInt() : len;
-		if ( chars > (len - start) )
-		{
-			chars = len - start;
-		}
+		pos = len1;
 	}
-	
-	stackTop->va = c->getSVA( chars, SV_CHAR, false );
 
-	#ifdef WRENCH_HANDLE_MALLOC_FAIL
+	unsigned int newlen = len1 + len2;
+	stackTop->va = c->getSVA( newlen, SV_CHAR, false );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
 	if ( !stackTop->va )
 	{
 		return;
 	}
-	#endif
-	
+#endif
 	stackTop->p2 = INIT_AS_ARRAY;
-	memcpy( stackTop->va->m_Cdata, data + start, chars );
+
+	memcpy( stackTop->va->m_Cdata, data1, pos );
+	memcpy( stackTop->va->m_Cdata + pos, data2, len2 );
+	memcpy( stackTop->va->m_Cdata + pos + len2, data1 + pos, len1  - pos );
 }
 
 //------------------------------------------------------------------------------
-void wr_strchr( WRValue* stackTop, const int argn, WRContext* c )
+void wr_tprint( WRValue* stackTop, const int argn, WRContext* c )
 {
-	stackTop->i = -1;
-
-	if ( argn < 2 )
+	if ( argn )
 	{
-		return;
+		char buf[4096];
+		(stackTop - argn)->technicalAsString( buf, 4096, false );
+		printf( "\n%s\n",  buf );
+		(stackTop - argn)->technicalAsString( buf, 4096, true );
+		printf( "%s\n",  buf );
 	}
+}
 
-	WRValue* args = stackTop - argn;
 
-	unsigned int len;
-	const char* str = (const char*)(args[0].array(&len));
-	if ( !str )
-	{
-		return;
-	}
+//------------------------------------------------------------------------------
+void wr_loadStringLib( WRState* w )
+{
+	wr_registerLibraryFunction( w, "str::strlen", wr_strlen );
+
+	wr_registerLibraryFunction( w, "str::sprintf", wr_sprintf );
+	wr_registerLibraryFunction( w, "str::format", wr_format );
 	
-	char ch = (char)args[1].asInt();
-	for( unsigned int i=0; i<len; ++i )
+	wr_registerLibraryFunction( w, "str::printf", wr_printf );
+	wr_registerLibraryFunction( w, "str::isspace", wr_isspace );
+	wr_registerLibraryFunction( w, "str::isdigit", wr_isdigit );
+	wr_registerLibraryFunction( w, "str::isalpha", wr_isalpha );
+	wr_registerLibraryFunction( w, "str::mid", wr_mid );
+	wr_registerLibraryFunction( w, "str::chr", wr_strchr );
+	wr_registerLibraryFunction( w, "str::tolower", wr_tolower );
+	wr_registerLibraryFunction( w, "str::toupper", wr_toupper );
+	wr_registerLibraryFunction( w, "str::tol", wr_tol );
+	wr_registerLibraryFunction( w, "str::concat", wr_concat );
+	wr_registerLibraryFunction( w, "str::left", wr_left );
+	wr_registerLibraryFunction( w, "str::trunc", wr_left );
+	wr_registerLibraryFunction( w, "str::right", wr_right );
+	wr_registerLibraryFunction( w, "str::substr", wr_mid );
+	wr_registerLibraryFunction( w, "str::trimright", wr_trimright );
+	wr_registerLibraryFunction( w, "str::trimleft", wr_trimleft );
+	wr_registerLibraryFunction( w, "str::trim", wr_trim );
+	wr_registerLibraryFunction( w, "str::insert", wr_insert );
+
+	wr_registerLibraryFunction( w, "str::tprint", wr_tprint );
+
+}
+/*******************************************************************************
+Copyright (c) 2026 Curt Hartung -- curt.hartung@gmail.com
+
+MIT Licence
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#include "wrench.h"
+
+#include <math.h>
+
+//------------------------------------------------------------------------------
+void wr_math_sin( WRValue* stackTop, const int argn, WRContext* c )
+{
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 1 )
 	{
-		if ( str[i] == ch )
-		{
-			stackTop->i = i;
-			break;
-		}
+		stackTop->f = sinf( (stackTop - 1)->asFloat() );
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_tolower( WRValue* stackTop, const int argn, WRContext* c )
+void wr_math_cos( WRValue* stackTop, const int argn, WRContext* c )
 {
+	stackTop->p2 = INIT_AS_FLOAT;
 	if ( argn == 1 )
 	{
-		WRValue& value = (stackTop - 1)->deref();
-		if ( value.xtype == WR_EX_ARRAY && value.va->m_type == SV_CHAR )
-		{
-			stackTop->va = c->getSVA( value.va->m_size, SV_CHAR, false );
-
-#ifdef WRENCH_HANDLE_MALLOC_FAIL
-			if ( !stackTop->va )
-			{
-				return;
-			}
-#endif
-			stackTop->p2 = INIT_AS_ARRAY;
-
-			for( uint32_t i=0; i<value.va->m_size; ++i )
-			{
-				stackTop->va->m_SCdata[i] = tolower(value.va->m_SCdata[i]);
-			}
-		}
-		else if ( value.type == WR_INT )
-		{
-			stackTop->i = (int)tolower( (stackTop - 1)->asInt() );
-		}
+		stackTop->f = cosf( (stackTop - 1)->asFloat() );
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_toupper( WRValue* stackTop, const int argn, WRContext* c )
+void wr_math_tan( WRValue* stackTop, const int argn, WRContext* c )
 {
+	stackTop->p2 = INIT_AS_FLOAT;
 	if ( argn == 1 )
 	{
-		WRValue& value = (stackTop - 1)->deref();
-		if ( value.xtype == WR_EX_ARRAY && value.va->m_type == SV_CHAR )
-		{
-			stackTop->va = c->getSVA( value.va->m_size, SV_CHAR, false );
-#ifdef WRENCH_HANDLE_MALLOC_FAIL
-			if ( !stackTop->va )
-			{
-				return;
-			}
-#endif
-			stackTop->p2 = INIT_AS_ARRAY;
-
-			for( uint32_t i=0; i<value.va->m_size; ++i )
-			{
-				stackTop->va->m_SCdata[i] = toupper(value.va->m_SCdata[i]);
-			}
-		}
-		else if ( value.type == WR_INT )
-		{
-			stackTop->i = (int)toupper( (stackTop - 1)->asInt() );
-		}
-
+		stackTop->f = tanf( (stackTop - 1)->asFloat() );
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_tol( WRValue* stackTop, const int argn, WRContext* c )
+void wr_math_sinh( WRValue* stackTop, const int argn, WRContext* c )
 {
-	char buf[21];
-	if ( argn == 2 )
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 1 )
 	{
-		stackTop->i = (int)strtol( stackTop[-2].asString(buf, 20), 0, stackTop[-1].asInt() );
+		stackTop->f = sinhf( (stackTop - 1)->asFloat() );
 	}
-	else if ( argn == 1 )
+}
+
+//------------------------------------------------------------------------------
+void wr_math_cosh( WRValue* stackTop, const int argn, WRContext* c )
+{
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 1 )
 	{
-		stackTop->i = (int)strtol( stackTop[-1].asString(buf, 20), 0, 10 );
+		stackTop->f = coshf( (stackTop - 1)->asFloat() );
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_concat( WRValue* stackTop, const int argn, WRContext* c )
+void wr_math_tanh( WRValue* stackTop, const int argn, WRContext* c )
 {
-	if ( argn < 2 )
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 1 )
 	{
-		return;
+		stackTop->f = tanhf( (stackTop - 1)->asFloat() );
 	}
+}
 
-	WRValue* args = stackTop - argn;
-	unsigned int len1 = 0;
-	unsigned int len2 = 0;
-	const char* data1 = (const char*)args[0].array( &len1 );
-	const char* data2 = (const char*)args[1].array( &len2 );
-
-	if( !data1 || !data2 )
+//------------------------------------------------------------------------------
+void wr_math_asin( WRValue* stackTop, const int argn, WRContext* c )
+{
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 1 )
 	{
-		return;
+		stackTop->f = asinf( (stackTop - 1)->asFloat() );
 	}
+}
 
-	stackTop->va = c->getSVA( len1 + len2, SV_CHAR, false );
-#ifdef WRENCH_HANDLE_MALLOC_FAIL
-	if ( !stackTop->va )
+//------------------------------------------------------------------------------
+void wr_math_acos( WRValue* stackTop, const int argn, WRContext* c )
+{
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 1 )
 	{
-		return;
+		stackTop->f = acosf( (stackTop - 1)->asFloat() );
 	}
-#endif
-	stackTop->p2 = INIT_AS_ARRAY;
-	memcpy( stackTop->va->m_Cdata, data1, len1 );
-	memcpy( stackTop->va->m_Cdata + len1, data2, len2 );
 }
 
 //------------------------------------------------------------------------------
-void wr_left( WRValue* stackTop, const int argn, WRContext* c )
+void wr_math_atan( WRValue* stackTop, const int argn, WRContext* c )
 {
-	if ( argn < 2 )
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 1 )
 	{
-		return;
+		stackTop->f = atanf( (stackTop - 1)->asFloat() );
 	}
+}
 
-	WRValue* args = stackTop - argn;
-	unsigned int len = 0;
-	const char* data = (const char*)args[0].array(&len );
-	if ( !data )
+//------------------------------------------------------------------------------
+void wr_math_atan2( WRValue* stackTop, const int argn, WRContext* c )
+{
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 2 )
 	{
-		return;
+		stackTop->f = atan2f( (stackTop - 1)->asFloat(), (stackTop - 2)->asFloat() );
 	}
-	unsigned int chars = args[1].asInt();
+}
 
-	if ( chars > len )
+//------------------------------------------------------------------------------
+void wr_math_log( WRValue* stackTop, const int argn, WRContext* c )
+{
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 1 )
 	{
-		chars = len;
+		stackTop->f = logf( (stackTop - 1)->asFloat() );
 	}
-	
-	stackTop->va = c->getSVA( chars, SV_CHAR, false );
-#ifdef WRENCH_HANDLE_MALLOC_FAIL
-	if ( !stackTop->va )
+}
+
+//------------------------------------------------------------------------------
+void wr_math_log10( WRValue* stackTop, const int argn, WRContext* c )
+{
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 1 )
 	{
-		return;
+		stackTop->f = log10f( (stackTop - 1)->asFloat() );
 	}
-#endif
-	stackTop->p2 = INIT_AS_ARRAY;
-
-	memcpy( stackTop->va->m_Cdata, data, chars );
 }
 
 //------------------------------------------------------------------------------
-void wr_right( WRValue* stackTop, const int argn, WRContext* c )
+void wr_math_exp( WRValue* stackTop, const int argn, WRContext* c )
 {
-	if ( argn < 2 )
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 1 )
 	{
-		return;
+		stackTop->f = expf( (stackTop - 1)->asFloat() );
 	}
+}
 
-	WRValue* args = stackTop - argn;
-	unsigned int len = 0;
-	const char* data = (const char*)args[0].array(&len );
-	if ( !data )
+//------------------------------------------------------------------------------
+void wr_math_sqrt( WRValue* stackTop, const int argn, WRContext* c )
+{
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 1 )
 	{
-		return;
+		stackTop->f = sqrtf( (stackTop - 1)->asFloat() );
 	}
-	unsigned int chars = args[1].asInt();
+}
 
-	if ( chars > len )
+//------------------------------------------------------------------------------
+void wr_math_ceil( WRValue* stackTop, const int argn, WRContext* c )
+{
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 1 )
 	{
-		chars = len;
+		stackTop->f = ceilf( (stackTop - 1)->asFloat() );
 	}
+}
 
-	stackTop->va = c->getSVA( chars, SV_CHAR, false );
-#ifdef WRENCH_HANDLE_MALLOC_FAIL
-	if ( !stackTop->va )
+//------------------------------------------------------------------------------
+void wr_math_floor( WRValue* stackTop, const int argn, WRContext* c )
+{
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 1 )
 	{
-		return;
+		stackTop->f = floorf( (stackTop - 1)->asFloat() );
 	}
-#endif
-	stackTop->p2 = INIT_AS_ARRAY;
-	memcpy( stackTop->va->m_Cdata, data + (len - chars), chars );
 }
 
 //------------------------------------------------------------------------------
-void wr_trimright( WRValue* stackTop, const int argn, WRContext* c )
+void wr_math_abs( WRValue* stackTop, const int argn, WRContext* c )
 {
-	WRValue* args = stackTop - argn;
-	const char* data;
-	int len = 0;
-	
-	if ( argn < 1 || ((data = (const char*)args->array((unsigned int *)&len)) == 0) )
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 1 )
 	{
-		return;
+		stackTop->f = (float)fabs( (stackTop - 1)->asFloat() );
 	}
+}
 
-	while( --len >= 0 && isspace(data[len]) );
-
-	++len;
-
-	stackTop->va = c->getSVA( len, SV_CHAR, false );
-#ifdef WRENCH_HANDLE_MALLOC_FAIL
-	if ( !stackTop->va )
+//------------------------------------------------------------------------------
+void wr_math_pow( WRValue* stackTop, const int argn, WRContext* c )
+{
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 2 )
 	{
-		return;
+		stackTop->f = powf( (stackTop - 1)->asFloat(), (stackTop - 2)->asFloat() );
 	}
-#endif
-	stackTop->p2 = INIT_AS_ARRAY;
-
-	memcpy( stackTop->va->m_Cdata, data, len );
 }
 
 //------------------------------------------------------------------------------
-void wr_trimleft( WRValue* stackTop, const int argn, WRContext* c )
+void wr_math_fmod( WRValue* stackTop, const int argn, WRContext* c )
 {
-	WRValue* args = stackTop - argn;
-	const char* data;
-	unsigned int len = 0;
-	
-	if ( argn < 1 || ((data = (const char*)args->array(&len)) == 0) )
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 2 )
 	{
-		return;
+		stackTop->f = fmodf( (stackTop - 1)->asFloat(), (stackTop - 2)->asFloat() );
 	}
+}
 
-	unsigned int marker = 0;
-	while( marker < len && isspace(data[marker]) ) { ++marker; }
-
-	stackTop->va = c->getSVA( len - marker, SV_CHAR, false );
-#ifdef WRENCH_HANDLE_MALLOC_FAIL
-	if ( !stackTop->va )
+//------------------------------------------------------------------------------
+void wr_math_trunc( WRValue* stackTop, const int argn, WRContext* c )
+{
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 1 )
 	{
-		return;
+		stackTop->f = truncf( (stackTop - 1)->asFloat() );
 	}
-#endif
-	stackTop->p2 = INIT_AS_ARRAY;
-
-	memcpy( stackTop->va->m_Cdata, data + marker, len - marker );
 }
 
 //------------------------------------------------------------------------------
-void wr_trim( WRValue* stackTop, const int argn, WRContext* c )
+void wr_math_ldexp( WRValue* stackTop, const int argn, WRContext* c )
 {
-	WRValue* args = stackTop - argn;
-	const char* data;
-	int len = 0;
-	if ( argn < 1 || ((data = (const char*)args->array((unsigned int*)&len)) == 0) )
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 2 )
 	{
-		return;
+		stackTop->f = ldexpf( (stackTop - 1)->asFloat(), (stackTop - 2)->asInt() );
 	}
+}
 
-	int marker = 0;
-	while( marker < len && isspace(data[marker]) ) { ++marker; }
-
-	while( --len >= marker && isspace(data[len]) );
-
-	++len;
+//------------------------------------------------------------------------------
+const float wr_PI = 3.14159265358979323846f;
+const float wr_toDegrees = (180.f / wr_PI);
+const float wr_toRadians = (1.f / wr_toDegrees);
 
-	stackTop->va = c->getSVA( len - marker, SV_CHAR, false );
-#ifdef WRENCH_HANDLE_MALLOC_FAIL
-	if ( !stackTop->va )
+//------------------------------------------------------------------------------
+void wr_math_rad2deg( WRValue* stackTop, const int argn, WRContext* c )
+{
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 1 )
 	{
-		return;
+		stackTop->f = wr_toDegrees * (stackTop - 1)->asFloat();
 	}
-#endif
-	stackTop->p2 = INIT_AS_ARRAY;
-
-	memcpy( stackTop->va->m_Cdata, data + marker, len - marker );
 }
 
 //------------------------------------------------------------------------------
-void wr_insert( WRValue* stackTop, const int argn, WRContext* c )
+void wr_math_deg2rad( WRValue* stackTop, const int argn, WRContext* c )
 {
-	if ( argn < 3 )
+	stackTop->p2 = INIT_AS_FLOAT;
+	if ( argn == 1 )
 	{
-		return;
+		stackTop->f = wr_toRadians * (stackTop - 1)->asFloat();
 	}
+}
 
-	WRValue* args = stackTop - argn;
-	unsigned int len1 = 0;
-	unsigned int len2 = 0;
-	const char* data1 = (const char*)args[0].array( &len1 );
-	const char* data2 = (const char*)args[1].array( &len2 );
+//------------------------------------------------------------------------------
+void wr_intScale(WRValue* stackTop, const int argn, WRContext* c)
+{
+	int32_t res = 0;
 
-	if( !data1 || !data2 )
-	{
-		return;
-	}
-	
-	unsigned int pos = args[2].asInt();
-	if ( pos >= len1 )
+	if (argn > 2)
 	{
-		pos = len1;
-	}
+		WRValue* args = stackTop - argn;
+		int32_t dvsr = args[2].asInt();
 
-	unsigned int newlen = len1 + len2;
-	stackTop->va = c->getSVA( newlen, SV_CHAR, false );
-#ifdef WRENCH_HANDLE_MALLOC_FAIL
-	if ( !stackTop->va )
-	{
-		return;
+		if (dvsr != 0)
+		{
+			int32_t fac1 = args[0].asInt();
+			int32_t fac2 = args[1].asInt();
+
+			res = (int32_t) (((int64_t)fac1 * fac2) / dvsr);
+		}
 	}
-#endif
-	stackTop->p2 = INIT_AS_ARRAY;
 
-	memcpy( stackTop->va->m_Cdata, data1, pos );
-	memcpy( stackTop->va->m_Cdata + pos, data2, len2 );
-	memcpy( stackTop->va->m_Cdata + pos + len2, data1 + pos, len1  - pos );
+	stackTop->i = res;
 }
 
 //------------------------------------------------------------------------------
-void wr_tprint( WRValue* stackTop, const int argn, WRContext* c )
+struct WRPureMathFunction
 {
-	if ( argn )
-	{
-		char buf[4096];
-		(stackTop - argn)->technicalAsString( buf, 4096, false );
-		printf( "\n%s\n",  buf );
-		(stackTop - argn)->technicalAsString( buf, 4096, true );
-		printf( "%s\n",  buf );
-	}
-}
+	const char* name;
+	WR_LIB_CALLBACK function;
+};
 
+//------------------------------------------------------------------------------
+static const WRPureMathFunction c_pureMathFunctions[] =
+{
+	{ "math::sin", wr_math_sin },
+	{ "math::cos", wr_math_cos },
+	{ "math::tan", wr_math_tan },
+	{ "math::sinh", wr_math_sinh },
+	{ "math::cosh", wr_math_cosh },
+	{ "math::tanh", wr_math_tanh },
+	{ "math::asin", wr_math_asin },
+	{ "math::acos", wr_math_acos },
+	{ "math::atan", wr_math_atan },
+	{ "math::atan2", wr_math_atan2 },
+	{ "math::log", wr_math_log },
+	{ "math::ln", wr_math_log },
+	{ "math::log10", wr_math_log10 },
+	{ "math::exp", wr_math_exp },
+	{ "math::pow", wr_math_pow },
+	{ "math::fmod", wr_math_fmod },
+	{ "math::trunc", wr_math_trunc },
+	{ "math::sqrt", wr_math_sqrt },
+	{ "math::ceil", wr_math_ceil },
+	{ "math::floor", wr_math_floor },
+	{ "math::abs", wr_math_abs },
+	{ "math::ldexp", wr_math_ldexp },
+	{ "math::deg2rad", wr_math_deg2rad },
+	{ "math::rad2deg", wr_math_rad2deg },
+	{ 0, 0 },
+};
 
 //------------------------------------------------------------------------------
-void wr_loadStringLib( WRState* w )
+WR_LIB_CALLBACK wr_pureMathFunction( const uint32_t hash )
 {
-	wr_registerLibraryFunction( w, "str::strlen", wr_strlen );
-
-	wr_registerLibraryFunction( w, "str::sprintf", wr_sprintf );
-	wr_registerLibraryFunction( w, "str::format", wr_format );
-	
-	wr_registerLibraryFunction( w, "str::printf", wr_printf );
-	wr_registerLibraryFunction( w, "str::isspace", wr_isspace );
-	wr_registerLibraryFunction( w, "str::isdigit", wr_isdigit );
-	wr_registerLibraryFunction( w, "str::isalpha", wr_isalpha );
-	wr_registerLibraryFunction( w, "str::mid", wr_mid );
-	wr_registerLibraryFunction( w, "str::chr", wr_strchr );
-	wr_registerLibraryFunction( w, "str::tolower", wr_tolower );
-	wr_registerLibraryFunction( w, "str::toupper", wr_toupper );
-	wr_registerLibraryFunction( w, "str::tol", wr_tol );
-	wr_registerLibraryFunction( w, "str::concat", wr_concat );
-	wr_registerLibraryFunction( w, "str::left", wr_left );
-	wr_registerLibraryFunction( w, "str::trunc", wr_left );
-	wr_registerLibraryFunction( w, "str::right", wr_right );
-	wr_registerLibraryFunction( w, "str::substr", wr_mid );
-	wr_registerLibraryFunction( w, "str::trimright", wr_trimright );
-	wr_registerLibraryFunction( w, "str::trimleft", wr_trimleft );
-	wr_registerLibraryFunction( w, "str::trim", wr_trim );
-	wr_registerLibraryFunction( w, "str::insert", wr_insert );
+	for( int f=0; c_pureMathFunctions[f].name; ++f )
+	{
+		if ( wr_hashStr(c_pureMathFunctions[f].name) == hash )
+		{
+			return c_pureMathFunctions[f].function;
+		}
+	}
 
-	wr_registerLibraryFunction( w, "str::tprint", wr_tprint );
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+void wr_loadMathLib( WRState* w )
+{
+	wr_registerLibraryFunction( w, "math::sin", wr_math_sin );
+	wr_registerLibraryFunction( w, "math::cos", wr_math_cos );
+	wr_registerLibraryFunction( w, "math::tan", wr_math_tan );
+	wr_registerLibraryFunction( w, "math::sinh", wr_math_sinh );
+	wr_registerLibraryFunction( w, "math::cosh", wr_math_cosh );
+	wr_registerLibraryFunction( w, "math::tanh", wr_math_tanh );
+	wr_registerLibraryFunction( w, "math::asin", wr_math_asin );
+	wr_registerLibraryFunction( w, "math::acos", wr_math_acos );
+	wr_registerLibraryFunction( w, "math::atan", wr_math_atan );
+	wr_registerLibraryFunction( w, "math::atan2", wr_math_atan2 );
+	wr_registerLibraryFunction( w, "math::log", wr_math_log );
+	wr_registerLibraryFunction( w, "math::ln", wr_math_log );
+	wr_registerLibraryFunction( w, "math::log10", wr_math_log10 );
+	wr_registerLibraryFunction( w, "math::exp", wr_math_exp );
+	wr_registerLibraryFunction( w, "math::pow", wr_math_pow );
+	wr_registerLibraryFunction( w, "math::fmod", wr_math_fmod );
+	wr_registerLibraryFunction( w, "math::trunc", wr_math_trunc );
+	wr_registerLibraryFunction( w, "math::sqrt", wr_math_sqrt );
+	wr_registerLibraryFunction( w, "math::ceil", wr_math_ceil );
+	wr_registerLibraryFunction( w, "math::floor", wr_math_floor );
+	wr_registerLibraryFunction( w, "math::abs", wr_math_abs );
+	wr_registerLibraryFunction( w, "math::ldexp", wr_math_ldexp );
+
+	wr_registerLibraryFunction( w, "math::deg2rad", wr_math_deg2rad );
+	wr_registerLibraryFunction( w, "math::rad2deg", wr_math_rad2deg );
 
+	wr_registerLibraryFunction( w, "math::iscale", wr_intScale);
 }
 /*******************************************************************************
 Copyright (c) 2026 Curt Hartung -- curt.hartung@gmail.com
@@ -22291,499 +28413,724 @@ SOFTWARE.
 
 #include "wrench.h"
 
-#include <math.h>
-
 //------------------------------------------------------------------------------
-void wr_math_sin( WRValue* stackTop, const int argn, WRContext* c )
+// key   : anything hashable
+// clear : [OPTIONAL] default 0/'false' 
+//
+// returns : value if it was there
+void wr_mboxRead( WRValue* stackTop, const int argn, WRContext* c )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
+	if ( argn > 0 )
 	{
-		stackTop->f = sinf( (stackTop - 1)->asFloat() );
+		WRValue* args = stackTop - argn;
+		int clear = (argn > 1) ? args[1].asInt() : 0;
+
+		const uint32_t hash = args[0].getHash();
+		WRValue* msg = c->w->globalRegistry.exists( hash, false );
+
+		if ( msg )
+		{
+			*stackTop = *msg;
+			if ( clear )
+			{
+				c->w->globalRegistry.exists( hash, true );
+			}
+		}
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_math_cos( WRValue* stackTop, const int argn, WRContext* c )
+// key  : anything hashable
+// value: stores the "hash"
+void wr_mboxWrite( WRValue* stackTop, const int argn, WRContext* c )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
+	if ( argn > 1 )
 	{
-		stackTop->f = cosf( (stackTop - 1)->asFloat() );
+		WRValue* args = stackTop - argn;
+
+		WRValue* msg = c->w->globalRegistry.getAsRawValueHashTable( args[0].getHash() );
+		msg->ui = args[1].getHash();
+		msg->p2 = INIT_AS_INT;
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_math_tan( WRValue* stackTop, const int argn, WRContext* c )
+// key  : anything hashable
+void wr_mboxClear( WRValue* stackTop, const int argn, WRContext* c )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
+	if ( argn > 0 )
 	{
-		stackTop->f = tanf( (stackTop - 1)->asFloat() );
+		c->w->globalRegistry.exists((stackTop - argn)->getHash(), true );
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_math_sinh( WRValue* stackTop, const int argn, WRContext* c )
+// key  : anything hashable
+//
+// return : true/false
+void wr_mboxPeek( WRValue* stackTop, const int argn, WRContext* c )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
+	if ( argn > 0
+		 && c->w->globalRegistry.exists((stackTop - argn)->getHash(), false) )
 	{
-		stackTop->f = sinhf( (stackTop - 1)->asFloat() );
+		stackTop->i = 1;
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_math_cosh( WRValue* stackTop, const int argn, WRContext* c )
+void wr_loadMessageLib( WRState* w )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
-	{
-		stackTop->f = coshf( (stackTop - 1)->asFloat() );
-	}
+	wr_registerLibraryFunction( w, "msg::read", wr_mboxRead ); // read (true to clear, false to leave)
+	wr_registerLibraryFunction( w, "msg::write", wr_mboxWrite ); // write message
+	wr_registerLibraryFunction( w, "msg::clear", wr_mboxClear ); // remove if exists
+	wr_registerLibraryFunction( w, "msg::peek", wr_mboxPeek ); // does the message exist?
 }
+/*******************************************************************************
+Copyright (c) 2026 Curt Hartung -- curt.hartung@gmail.com
+
+MIT Licence
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#include "wrench.h"
 
 //------------------------------------------------------------------------------
-void wr_math_tanh( WRValue* stackTop, const int argn, WRContext* c )
+// returns : 0 - function  does not exist
+//         : 1 - function is native (callback)
+//         : 2 - function is in wrench (was in source code)
+void wr_isFunction( WRValue* stackTop, const int argn, WRContext* c )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
+	if ( argn > 0 )
 	{
-		stackTop->f = tanhf( (stackTop - 1)->asFloat() );
+		WRValue* arg = stackTop - argn;
+		uint32_t hash = arg->getHash();
+		if ( c->w->globalRegistry.exists(hash, false) )
+		{
+			stackTop->i = 1;
+		}
+		else if ( wr_registry(c).exists(hash, false) )
+		{
+			stackTop->i = 2;
+		}
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_math_asin( WRValue* stackTop, const int argn, WRContext* c )
+void wr_importByteCode( WRValue* stackTop, const int argn, WRContext* c )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
+	if ( argn > 0 )
 	{
-		stackTop->f = asinf( (stackTop - 1)->asFloat() );
+		unsigned int len;
+		char* data = (char *)((stackTop - argn)->array( &len, SV_CHAR ));
+		if ( data )
+		{
+			uint8_t* import = (uint8_t*)g_malloc( len );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+			if(!import) { g_mallocFailed = true; return; }
+#endif
+			memcpy( (char*)import, data, len );
+			wr_import( c, import, len, true );
+		}
+		else
+		{
+			stackTop->i = -1;
+		}
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_math_acos( WRValue* stackTop, const int argn, WRContext* c )
+void wr_importCompile( WRValue* stackTop, const int argn, WRContext* c )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
+	if ( argn > 0 )
 	{
-		stackTop->f = acosf( (stackTop - 1)->asFloat() );
+		unsigned int len;
+		char* data = (char *)((stackTop - argn)->array( &len, SV_CHAR ));
+		if ( data )
+		{
+			unsigned char* out;
+			int outlen;
+			if ( (stackTop->i = wr_compile(data, len, &out, &outlen)) == WR_ERR_None )
+			{
+				wr_import( c, out, outlen, true );
+			}
+		}
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_math_atan( WRValue* stackTop, const int argn, WRContext* c )
+void wr_halt( WRValue* stackTop, const int argn, WRContext* c )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
+	if ( argn > 0 )
 	{
-		stackTop->f = atanf( (stackTop - 1)->asFloat() );
+		unsigned int e = (stackTop - argn)->asInt();
+		c->w->err = (e <= (unsigned int)WR_USER || e > (unsigned int)WR_ERR_LAST)
+					? (unsigned int)WR_ERR_USER_err_out_of_range : e;
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_math_atan2( WRValue* stackTop, const int argn, WRContext* c )
+void wr_loadSysLib( WRState* w )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 2 )
+	wr_registerLibraryFunction( w, "sys::isFunction", wr_isFunction );
+	wr_registerLibraryFunction( w, "sys::importByteCode", wr_importByteCode );
+	wr_registerLibraryFunction( w, "sys::importCompile", wr_importCompile );
+	wr_registerLibraryFunction( w, "sys::halt", wr_halt ); // halts execution and sets w->err to whatever was passed                 
+														   // NOTE: value must be between WR_USER and WR_ERR_LAST
+
+}
+/*******************************************************************************
+Copyright (c) 2026 Curt Hartung -- curt.hartung@gmail.com
+
+MIT Licence
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#include "wrench.h"
+
+//------------------------------------------------------------------------------
+void wr_stdSerialize( WRValue* stackTop, const int argn, WRContext* c )
+{
+	if ( argn )
 	{
-		stackTop->f = atan2f( (stackTop - 1)->asFloat(), (stackTop - 2)->asFloat() );
+		char* buf;
+		int len;
+		if ( wr_serialize(&buf, &len, *(stackTop - argn) ) )
+		{
+			stackTop->va = c->getSVA( 0, SV_CHAR, false );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+			if ( !stackTop->va )
+			{
+				return;
+			}
+#endif
+			stackTop->p2 = INIT_AS_ARRAY;
+			stackTop->va->freeData( stackTop->va->m_Cdata );
+			stackTop->va->m_data = buf;
+			stackTop->va->m_capacity = stackTop->va->m_size = len;
+		}
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_math_log( WRValue* stackTop, const int argn, WRContext* c )
+void wr_stdDeserialize( WRValue* stackTop, const int argn, WRContext* c )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
+	if ( argn )
 	{
-		stackTop->f = logf( (stackTop - 1)->asFloat() );
+		WRValue& V = (stackTop - argn)->deref();
+		if ( IS_ARRAY(V.xtype) && V.va->m_type == SV_CHAR )
+		{
+			if ( !wr_deserialize( c, *stackTop, V.va->m_SCdata, V.va->m_size ) )
+			{
+				stackTop->init();
+			}
+
+			c->gc( stackTop + 1 );
+		}
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_math_log10( WRValue* stackTop, const int argn, WRContext* c )
+void wr_loadSerializeLib( WRState* w )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
-	{
-		stackTop->f = log10f( (stackTop - 1)->asFloat() );
-	}
+	wr_registerLibraryFunction( w, "std::serialize", wr_stdSerialize );
+	wr_registerLibraryFunction( w, "std::deserialize", wr_stdDeserialize );
 }
+/*******************************************************************************
+Copyright (c) 2026 Curt Hartung -- curt.hartung@gmail.com
+
+MIT Licence
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*******************************************************************************/
+
+#include "wrench.h"
 
 //------------------------------------------------------------------------------
-void wr_math_exp( WRValue* stackTop, const int argn, WRContext* c )
+WRValue* wr_ifValueArray( WRValue* val )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
-	{
-		stackTop->f = expf( (stackTop - 1)->asFloat() );
-	}
+	WRValue* ret = &(val->deref());
+	return (IS_ARRAY(ret->xtype) && ret->va->m_type == SV_VALUE) ? ret : 0;
 }
 
 //------------------------------------------------------------------------------
-void wr_math_sqrt( WRValue* stackTop, const int argn, WRContext* c )
+WRValue* wr_ifHash( WRValue* val )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
-	{
-		stackTop->f = sqrtf( (stackTop - 1)->asFloat() );
-	}
+	WRValue* ret = &(val->deref());
+	return IS_HASH_TABLE(ret->xtype) ? ret : 0;
 }
 
 //------------------------------------------------------------------------------
-void wr_math_ceil( WRValue* stackTop, const int argn, WRContext* c )
+void wr_arrayCount( WRValue* stackTop, const int argn, WRContext* c )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
+	WRValue* A;
+	if( argn == 0 || !(A = wr_ifValueArray(stackTop - argn)) )
 	{
-		stackTop->f = ceilf( (stackTop - 1)->asFloat() );
+		return;
 	}
+
+	stackTop->ui = A->va->m_size;
 }
 
 //------------------------------------------------------------------------------
-void wr_math_floor( WRValue* stackTop, const int argn, WRContext* c )
+void wr_arrayClear( WRValue* stackTop, const int argn, WRContext* c )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
+	if ( argn >= 1 )
 	{
-		stackTop->f = floorf( (stackTop - 1)->asFloat() );
+		WRValue* args = stackTop - argn;
+
+		WRValue* A = &(args->deref());
+
+		A->p2 = INIT_AS_ARRAY;
+
+		unsigned int count = 0;
+		if ( argn > 1 )
+		{
+			count = args[1].asInt();
+		}
+		
+		A->va = c->getSVA( count, SV_VALUE, false );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+		if ( !A->va )
+		{
+			A->p2 = INIT_AS_INT;
+			return;
+		}
+#endif
+
+		*stackTop = *A;
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_math_abs( WRValue* stackTop, const int argn, WRContext* c )
+void wr_arrayPeek( WRValue* stackTop, const int argn, WRContext* c )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
+	WRValue* A;
+	if( argn == 0 || !(A = wr_ifValueArray(stackTop - argn)) )
 	{
-		stackTop->f = (float)fabs( (stackTop - 1)->asFloat() );
+		return;
 	}
-}
 
-//------------------------------------------------------------------------------
-void wr_math_pow( WRValue* stackTop, const int argn, WRContext* c )
-{
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 2 )
+	if ( A->va->m_size > 0 )
 	{
-		stackTop->f = powf( (stackTop - 1)->asFloat(), (stackTop - 2)->asFloat() );
+		WR_GC_REMEMBER( c, A->vb );
+		stackTop->p2 = INIT_AS_CONTAINER_MEMBER;// | ENCODE_ARRAY_ELEMENT_TO_P2( 0 );
+		stackTop->r = A;
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_math_fmod( WRValue* stackTop, const int argn, WRContext* c )
+void wr_arrayPeekBack( WRValue* stackTop, const int argn, WRContext* c )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 2 )
+	WRValue* A;
+	if( argn == 0 || !(A = wr_ifValueArray(stackTop - argn)) )
 	{
-		stackTop->f = fmodf( (stackTop - 1)->asFloat(), (stackTop - 2)->asFloat() );
+		return;
 	}
-}
 
-//------------------------------------------------------------------------------
-void wr_math_trunc( WRValue* stackTop, const int argn, WRContext* c )
-{
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
+	if ( A->va->m_size > 0 )
 	{
-		stackTop->f = truncf( (stackTop - 1)->asFloat() );
+		WR_GC_REMEMBER( c, A->vb );
+		stackTop->p2 = INIT_AS_CONTAINER_MEMBER | ENCODE_ARRAY_ELEMENT_TO_P2( A->va->m_size - 1 );
+		stackTop->r = A;
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_math_ldexp( WRValue* stackTop, const int argn, WRContext* c )
+void wr_arrayRemoveEx( WRValue* A, const unsigned int where, const int count, WRValue* stackTop, WRContext* c )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 2 )
+	if ( where < A->va->m_size )
 	{
-		stackTop->f = ldexpf( (stackTop - 1)->asFloat(), (stackTop - 2)->asInt() );
+		unsigned int from = where + count;
+		if ( from >= A->va->m_size )
+		{
+			A->va->m_size = where; // simple truncation
+		}
+		else if ( where == 0 )
+		{
+			// just step the front forward, the room is reclaimed by the
+			// next push to the front or reallocation
+			A->va->m_Vdata += count;
+			A->va->m_head += count;
+			A->va->m_capacity -= count;
+			A->va->m_size -= count;
+		}
+		else
+		{
+			unsigned int elements = A->va->m_size - from;
+
+			memmove( (char*)(A->va->m_Vdata + where), // to here
+					 (char*)(A->va->m_Vdata + from),   // from here
+					 elements * sizeof(WRValue) ); // this many
+
+			A->va->m_size -= count;
+		}
+
+		c->gc( stackTop + 1 );
 	}
 }
 
 //------------------------------------------------------------------------------
-const float wr_PI = 3.14159265358979323846f;
-const float wr_toDegrees = (180.f / wr_PI);
-const float wr_toRadians = (1.f / wr_toDegrees);
-
-//------------------------------------------------------------------------------
-void wr_math_rad2deg( WRValue* stackTop, const int argn, WRContext* c )
+void wr_arrayRemove( WRValue* stackTop, const int argn, WRContext* c )
 {
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
+	WRValue* A;
+	WRValue* args = stackTop - argn;
+
+	if( (argn < 2) || !(A = wr_ifValueArray(args)) )
 	{
-		stackTop->f = wr_toDegrees * (stackTop - 1)->asFloat();
+		return;
 	}
-}
 
-//------------------------------------------------------------------------------
-void wr_math_deg2rad( WRValue* stackTop, const int argn, WRContext* c )
-{
-	stackTop->p2 = INIT_AS_FLOAT;
-	if ( argn == 1 )
+	unsigned int where = (unsigned int)(args[1].asInt());
+
+	int count = 1;
+	if ( argn > 2 )
 	{
-		stackTop->f = wr_toRadians * (stackTop - 1)->asFloat();
+		count = args[2].asInt();
 	}
+
+	wr_arrayRemoveEx( A, where, count, stackTop, c );
+
+	*stackTop = *A;
 }
 
 //------------------------------------------------------------------------------
-void wr_intScale(WRValue* stackTop, const int argn, WRContext* c)
+void wr_arrayTruncate( WRValue* stackTop, const int argn, WRContext* c )
 {
-	int32_t res = 0;
+	WRValue* A;
+	WRValue* args = stackTop - argn;
 
-	if (argn > 2)
+	if( (argn < 1) || !(A = wr_ifValueArray(args)) )
 	{
-		WRValue* args = stackTop - argn;
-		int32_t dvsr = args[2].asInt();
+		return;
+	}
 
-		if (dvsr != 0)
-		{
-			int32_t fac1 = args[0].asInt();
-			int32_t fac2 = args[1].asInt();
+	unsigned int size = (unsigned int)(args[1].asInt());
 
-			res = (int32_t) (((int64_t)fac1 * fac2) / dvsr);
-		}
+	if ( size < A->va->m_size )
+	{
+		A->va->m_size = size; // *snip*
+		c->gc( stackTop + 1 );
 	}
 
-	stackTop->i = res;
+	*stackTop = *A;
 }
 
 //------------------------------------------------------------------------------
-void wr_loadMathLib( WRState* w )
+void wr_arrayReserve( WRValue* stackTop, const int argn, WRContext* c )
 {
-	wr_registerLibraryFunction( w, "math::sin", wr_math_sin );
-	wr_registerLibraryFunction( w, "math::cos", wr_math_cos );
-	wr_registerLibraryFunction( w, "math::tan", wr_math_tan );
-	wr_registerLibraryFunction( w, "math::sinh", wr_math_sinh );
-	wr_registerLibraryFunction( w, "math::cosh", wr_math_cosh );
-	wr_registerLibraryFunction( w, "math::tanh", wr_math_tanh );
-	wr_registerLibraryFunction( w, "math::asin", wr_math_asin );
-	wr_registerLibraryFunction( w, "math::acos", wr_math_acos );
-	wr_registerLibraryFunction( w, "math::atan", wr_math_atan );
-	wr_registerLibraryFunction( w, "math::atan2", wr_math_atan2 );
-	wr_registerLibraryFunction( w, "math::log", wr_math_log );
-	wr_registerLibraryFunction( w, "math::ln", wr_math_log );
-	wr_registerLibraryFunction( w, "math::log10", wr_math_log10 );
-	wr_registerLibraryFunction( w, "math::exp", wr_math_exp );
-	wr_registerLibraryFunction( w, "math::pow", wr_math_pow );
-	wr_registerLibraryFunction( w, "math::fmod", wr_math_fmod );
-	wr_registerLibraryFunction( w, "math::trunc", wr_math_trunc );
-	wr_registerLibraryFunction( w, "math::sqrt", wr_math_sqrt );
-	wr_registerLibraryFunction( w, "math::ceil", wr_math_ceil );
-	wr_registerLibraryFunction( w, "math::floor", wr_math_floor );
-	wr_registerLibraryFunction( w, "math::abs", wr_math_abs );
-	wr_registerLibraryFunction( w, "math::ldexp", wr_math_ldexp );
-
-	wr_registerLibraryFunction( w, "math::deg2rad", wr_math_deg2rad );
-	wr_registerLibraryFunction( w, "math::rad2deg", wr_math_rad2deg );
-
-	wr_registerLibraryFunction( w, "math::iscale", wr_intScale);
-}
-/*******************************************************************************
-Copyright (c) 2026 Curt Hartung -- curt.hartung@gmail.com
-
-MIT Licence
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
+	WRValue* A;
+	WRValue* args = stackTop - argn;
 
-The above copyright notice and this permission notice shall be included in all
-copies or substantial portions of the Software.
+	if( (argn < 2) || !(A = wr_ifValueArray(args)) )
+	{
+		return;
+	}
 
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-SOFTWARE.
-*******************************************************************************/
+	int capacity = args[1].asInt();
+	if ( capacity > 0 && (uint32_t)capacity > A->va->m_capacity )
+	{
+		c->allocatedMemoryHint += (capacity - A->va->m_capacity) * sizeof(WRValue);
+		wr_reserveValueArray( A->va, capacity );
+	}
 
-#include "wrench.h"
+	*stackTop = *A;
+}
 
 //------------------------------------------------------------------------------
-// key   : anything hashable
-// clear : [OPTIONAL] default 0/'false' 
-//
-// returns : value if it was there
-void wr_mboxRead( WRValue* stackTop, const int argn, WRContext* c )
+void wr_arrayInsertEx( WRValue* A, const unsigned int where, const unsigned int count, WRValue* stackTop, WRContext* c )
 {
-	if ( argn > 0 )
+	WR_GC_REMEMBER( c, A->vb );
+
+	if ( where == 0 )
 	{
-		WRValue* args = stackTop - argn;
-		int clear = (argn > 1) ? args[1].asInt() : 0;
+		// inserting at the front (push/push_front) is a deque operation
+		wr_growValueArrayFront( A->va, count );
+		c->gc( stackTop + 1 );
+		return;
+	}
+
+	unsigned int originalSize = A->va->m_size;
+	// accommodate new size (passed value is expected to be the highest accessible index)
+	wr_growValueArray( A->va, originalSize + (count - 1) );
 
-		WRValue* msg = c->w->globalRegistry.exists( args[0].getHash(), clear != 0 );
+	// move tail of array UP "count" entries
+	unsigned int entries = originalSize - where;
+	if ( entries )
+	{
+		unsigned int to = where + count;
 
-		if ( msg )
-		{
-			*stackTop = *msg;
-			return;
-		}
+		memmove( (char*)(A->va->m_Vdata + to),
+				 (char*)(A->va->m_Vdata + where),
+				 entries * sizeof(WRValue) );
+
+		memset( (char*)(A->va->m_Vdata + where),
+				0,
+				count * sizeof(WRValue) );
 	}
+
+	c->gc( stackTop + 1 );
 }
 
 //------------------------------------------------------------------------------
-// key  : anything hashable
-// value: stores the "hash"
-void wr_mboxWrite( WRValue* stackTop, const int argn, WRContext* c )
+void wr_arrayInsert( WRValue* stackTop, const int argn, WRContext* c )
 {
-	if ( argn > 1 )
+	WRValue* A;
+	WRValue* args = stackTop - argn;
+
+	if( (argn < 2) || !(A = wr_ifValueArray(args)) )
 	{
-		WRValue* args = stackTop - argn;
+		return;
+	}
 
-		WRValue* msg = c->w->globalRegistry.getAsRawValueHashTable( args[0].getHash() );
-		msg->ui = args[1].getHash();
-		msg->p2 = INIT_AS_INT;
+	unsigned int where = (unsigned int)(args[1].asInt());
+
+	int count = 1;
+	if ( argn > 2 )
+	{
+		count = args[2].asInt();
 	}
+
+	wr_arrayInsertEx( A, where, count, stackTop, c );
+
+	*stackTop = *A;
 }
 
 //------------------------------------------------------------------------------
-// key  : anything hashable
-void wr_mboxClear( WRValue* stackTop, const int argn, WRContext* c )
+void wr_arrayPop( WRValue* stackTop, const int argn, WRContext* c )
 {
-	if ( argn > 0 )
+	WRValue* A;
+	WRValue* args = stackTop - argn;
+
+	if( (argn < 1) || !(A = wr_ifValueArray(args)) )
 	{
-		c->w->globalRegistry.exists((stackTop - argn)->getHash(), true );
+		return;
+	}
+
+	if ( A->va->m_size )
+	{
+		*stackTop = *A->va->m_Vdata;
+		wr_arrayRemoveEx( A, 0, 1, stackTop, c );
 	}
 }
 
 //------------------------------------------------------------------------------
-// key  : anything hashable
-//
-// return : true/false
-void wr_mboxPeek( WRValue* stackTop, const int argn, WRContext* c )
+void wr_arrayPopBack( WRValue* stackTop, const int argn, WRContext* c )
 {
-	if ( argn > 0
-		 && c->w->globalRegistry.exists((stackTop - argn)->getHash(), false) )
+	WRValue* A;
+	WRValue* args = stackTop - argn;
+
+	if( (argn < 1) || !(A = wr_ifValueArray(args)) )
 	{
-		stackTop->i = 1;
+		return;
+	}
+
+	if ( A->va->m_size )
+	{
+		--A->va->m_size;
+		*stackTop = A->va->m_Vdata[A->va->m_size];
+		c->gc( stackTop + 1 );
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_loadMessageLib( WRState* w )
+void wr_arrayPushBack( WRValue* stackTop, const int argn, WRContext* c )
 {
-	wr_registerLibraryFunction( w, "msg::read", wr_mboxRead ); // read (true to clear, false to leave)
-	wr_registerLibraryFunction( w, "msg::write", wr_mboxWrite ); // write message
-	wr_registerLibraryFunction( w, "msg::clear", wr_mboxClear ); // remove if exists
-	wr_registerLibraryFunction( w, "msg::peek", wr_mboxPeek ); // does the message exist?
-}
-/*******************************************************************************
-Copyright (c) 2026 Curt Hartung -- curt.hartung@gmail.com
+	WRValue* A;
+	WRValue* args = stackTop - argn;
 
-MIT Licence
+	if( (argn < 2) || !(A = wr_ifValueArray(args)) )
+	{
+		return;
+	}
 
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
+	const unsigned int where = A->va->m_size;
 
-The above copyright notice and this permission notice shall be included in all
-copies or substantial portions of the Software.
+	wr_arrayInsertEx( A, where, 1, stackTop, c );
+	A->va->m_Vdata[where] = args[1].deref();
+}
 
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-SOFTWARE.
-*******************************************************************************/
+//------------------------------------------------------------------------------
+void wr_arrayPush( WRValue* stackTop, const int argn, WRContext* c )
+{
+	WRValue* A;
+	WRValue* args = stackTop - argn;
 
-#include "wrench.h"
+	if( (argn < 2) || !(A = wr_ifValueArray(args)) )
+	{
+		return;
+	}
+
+	wr_arrayInsertEx( A, 0, 1, stackTop, c );
+	A->va->m_Vdata[0] = args[1].deref();
+}
 
 //------------------------------------------------------------------------------
-// returns : 0 - function  does not exist
-//         : 1 - function is native (callback)
-//         : 2 - function is in wrench (was in source code)
-void wr_isFunction( WRValue* stackTop, const int argn, WRContext* c )
+void wr_hashClear( WRValue* stackTop, const int argn, WRContext* c )
 {
-	if ( argn > 0 )
+	if ( argn >= 1 )
 	{
-		WRValue* arg = stackTop - argn;
-		uint32_t hash = arg->getHash();
-		if ( c->w->globalRegistry.exists(hash, false) )
-		{
-			stackTop->i = 1;
-		}
-		else if ( c->registry.exists(hash, false) )
+		WRValue* A = &((stackTop - argn)->deref());
+
+		A->p2 = INIT_AS_HASH_TABLE;
+		A->va = c->getSVA( 0, SV_HASH_TABLE, false );
+#ifdef WRENCH_HANDLE_MALLOC_FAIL
+		if ( !A->va )
 		{
-			stackTop->i = 2;
+			A->p2 = INIT_AS_INT;
+			return;
 		}
+#endif
+
+		*stackTop = *A;
+		
+		c->gc( stackTop + 1 );
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_importByteCode( WRValue* stackTop, const int argn, WRContext* c )
+void wr_hashCount( WRValue* stackTop, const int argn, WRContext* c )
 {
-	if ( argn > 0 )
+	WRValue* H;
+	if( argn == 0 || !(H = wr_ifHash(stackTop - argn)) )
 	{
-		unsigned int len;
-		char* data = (char *)((stackTop - argn)->array( &len, SV_CHAR ));
-		if ( data )
-		{
-			uint8_t* import = (uint8_t*)g_malloc( len );
-#ifdef WRENCH_HANDLE_MALLOC_FAIL
-			if(!import) { g_mallocFailed = true; return; }
-#endif
-			memcpy( (char*)import, data, len );
-			wr_import( c, import, len, true );
-		}
-		else
-		{
-			stackTop->i = -1;
-		}
+		return;
 	}
+
+	stackTop->ui = H->va->m_size;
 }
 
 //------------------------------------------------------------------------------
-void wr_importCompile( WRValue* stackTop, const int argn, WRContext* c )
+void wr_hashAdd( WRValue* stackTop, const int argn, WRContext* c )
 {
-	if ( argn > 0 )
+	WRValue* H;
+	WRValue* args = stackTop - argn;
+	if( argn < 3 || !(H = wr_ifHash(args)) )
 	{
-		unsigned int len;
-		char* data = (char *)((stackTop - argn)->array( &len, SV_CHAR ));
-		if ( data )
-		{
-			unsigned char* out;
-			int outlen;
-			if ( (stackTop->i = wr_compile(data, len, &out, &outlen)) == WR_ERR_None )
-			{
-				wr_import( c, out, outlen, true );
-			}
-		}
+		return;
 	}
+
+	uint32_t hash = args[2].getHash(); // key
+	int element;
+	WR_GC_REMEMBER( c, H->vb );
+	WRValue* entry = (WRValue*)( H->va->get(hash, &element) );
+
+	*entry = args[1].deref();
+	*(entry + 1) = args[2].deref();
+
+	stackTop->p2 = INIT_AS_CONTAINER_MEMBER | ENCODE_ARRAY_ELEMENT_TO_P2( element );
+	stackTop->vb = H->vb;
 }
 
 //------------------------------------------------------------------------------
-void wr_halt( WRValue* stackTop, const int argn, WRContext* c )
+void wr_hashExistEx( WRValue* stackTop, const int argn, bool remove )
 {
-	if ( argn > 0 )
+	WRValue* H;
+	WRValue* args = stackTop - argn;
+	if( (argn >= 2) && (H = wr_ifHash(args)) )
 	{
-		unsigned int e = (stackTop - argn)->asInt();
-		c->w->err = (e <= (unsigned int)WR_USER || e > (unsigned int)WR_ERR_LAST)
-					? (unsigned int)WR_ERR_USER_err_out_of_range : e;
+		stackTop->p = H->va->exists( args[1].getHash(), remove );
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_loadSysLib( WRState* w )
+void wr_hashRemove( WRValue* stackTop, const int argn, WRContext* c )
+{
+	wr_hashExistEx( stackTop, argn, true );
+}
+
+//------------------------------------------------------------------------------
+void wr_hashExists( WRValue* stackTop, const int argn, WRContext* c )
+{
+	wr_hashExistEx( stackTop, argn, false );
+}
+
+//------------------------------------------------------------------------------
+void wr_loadContainerLib( WRState* w )
 {
-	wr_registerLibraryFunction( w, "sys::isFunction", wr_isFunction );
-	wr_registerLibraryFunction( w, "sys::importByteCode", wr_importByteCode );
-	wr_registerLibraryFunction( w, "sys::importCompile", wr_importCompile );
-	wr_registerLibraryFunction( w, "sys::halt", wr_halt ); // halts execution and sets w->err to whatever was passed                 
-														   // NOTE: value must be between WR_USER and WR_ERR_LAST
+	wr_registerLibraryFunction( w, "array::clear", wr_arrayClear );       // ( array )
+	wr_registerLibraryFunction( w, "array::count", wr_arrayCount );       // ( array )
+	wr_registerLibraryFunction( w, "array::remove", wr_arrayRemove );     // ( array, where, [count == 1] )
+	wr_registerLibraryFunction( w, "array::insert", wr_arrayInsert );     // ( array, where, [count == 1] )
+	wr_registerLibraryFunction( w, "array::truncate", wr_arrayTruncate ); // ( array, newSize )
+	wr_registerLibraryFunction( w, "array::reserve", wr_arrayReserve );   // ( array, capacity )
+
+	wr_registerLibraryFunction( w, "hash::clear", wr_hashClear );   // ( hash )
+	wr_registerLibraryFunction( w, "hash::count", wr_hashCount );   // ( hash )
+	wr_registerLibraryFunction( w, "hash::add", wr_hashAdd );       // ( hash, item, key )
+	wr_registerLibraryFunction( w, "hash::remove", wr_hashRemove ); // ( hash, key )
+	wr_registerLibraryFunction( w, "hash::exists", wr_hashExists ); // ( hash, key )
+
+	wr_registerLibraryFunction( w, "list::clear", wr_arrayClear );        // ( list )
+	wr_registerLibraryFunction( w, "list::count", wr_arrayCount );        // ( list )
+	wr_registerLibraryFunction( w, "list::peek", wr_arrayPeek );          // ( list )
+	wr_registerLibraryFunction( w, "list::pop", wr_arrayPop );            // ( list )
+	wr_registerLibraryFunction( w, "list::pop_front", wr_arrayPop );      // ( list )
+	wr_registerLibraryFunction( w, "list::pop_back", wr_arrayPopBack );   // ( list )
+	wr_registerLibraryFunction( w, "list::push", wr_arrayPush );          // ( list, item )
+	wr_registerLibraryFunction( w, "list::push_front", wr_arrayPush );    // ( list, item )
+	wr_registerLibraryFunction( w, "list::push_back", wr_arrayPushBack ); // ( list )
 
+	wr_registerLibraryFunction( w, "queue::clear", wr_arrayClear );   // ( q )
+	wr_registerLibraryFunction( w, "queue::count", wr_arrayCount );   // ( q )
+	wr_registerLibraryFunction( w, "queue::push", wr_arrayPush );     // ( q, item )
+	wr_registerLibraryFunction( w, "queue::pop", wr_arrayPopBack );   // ( q )
+	wr_registerLibraryFunction( w, "queue::peek", wr_arrayPeekBack ); // ( q )
+
+	wr_registerLibraryFunction( w, "stack::clear", wr_arrayClear ); // ( stack )
+	wr_registerLibraryFunction( w, "stack::count", wr_arrayCount ); // ( stack )
+	wr_registerLibraryFunction( w, "stack::push", wr_arrayPush );   // ( stack, item )
+	wr_registerLibraryFunction( w, "stack::pop", wr_arrayPop );     // ( stack )
+	wr_registerLibraryFunction( w, "stack::peek", wr_arrayPeek );   // ( stack )
 }
 /*******************************************************************************
 Copyright (c) 2026 Curt Hartung -- curt.hartung@gmail.com
@@ -22811,472 +29158,698 @@ SOFTWARE.
 
 #include "wrench.h"
 
+// float kernels run WR_VEC_WIDTH lanes at a time where the target has
+// them. The integer loops are left plain, compilers vectorize those on
+// their own but can't reorder a float sum without being told to
+#ifndef WRENCH_VEC_SCALAR
+#if defined(__AVX__)
+
+#include <immintrin.h>
+#define WR_VEC_WIDTH 8
+typedef __m256 WRVecF;
+#define WR_VEC_LOAD(P) _mm256_loadu_ps(P)
+#define WR_VEC_STORE(P,V) _mm256_storeu_ps(P,V)
+#define WR_VEC_SET1(F) _mm256_set1_ps(F)
+#define WR_VEC_ADD(A,B) _mm256_add_ps(A,B)
+#define WR_VEC_MUL(A,B) _mm256_mul_ps(A,B)
+#define WR_VEC_MIN(A,B) _mm256_min_ps(A,B)
+#define WR_VEC_MAX(A,B) _mm256_max_ps(A,B)
+
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+
+#include <emmintrin.h>
+#define WR_VEC_WIDTH 4
+typedef __m128 WRVecF;
+#define WR_VEC_LOAD(P) _mm_loadu_ps(P)
+#define WR_VEC_STORE(P,V) _mm_storeu_ps(P,V)
+#define WR_VEC_SET1(F) _mm_set1_ps(F)
+#define WR_VEC_ADD(A,B) _mm_add_ps(A,B)
+#define WR_VEC_MUL(A,B) _mm_mul_ps(A,B)
+#define WR_VEC_MIN(A,B) _mm_min_ps(A,B)
+#define WR_VEC_MAX(A,B) _mm_max_ps(A,B)
+
+#endif
+#endif
+
+enum WRVecOp
+{
+	WRVec_Add,
+	WRVec_Mul,
+};
+
 //------------------------------------------------------------------------------
-void wr_stdSerialize( WRValue* stackTop, const int argn, WRContext* c )
+static void vecAddF( float* a, const float* b, const uint32_t n )
 {
-	if ( argn )
+	uint32_t i = 0;
+#ifdef WR_VEC_WIDTH
+	for( ; i + WR_VEC_WIDTH <= n; i += WR_VEC_WIDTH )
 	{
-		char* buf;
-		int len;
-		if ( wr_serialize(&buf, &len, *(stackTop - argn) ) )
-		{
-			stackTop->va = c->getSVA( 0, SV_CHAR, false );
-#ifdef WRENCH_HANDLE_MALLOC_FAIL
-			if ( !stackTop->va )
-			{
-				return;
-			}
+		WR_VEC_STORE( a + i, WR_VEC_ADD(WR_VEC_LOAD(a + i), WR_VEC_LOAD(b + i)) );
+	}
 #endif
-			stackTop->p2 = INIT_AS_ARRAY;
-			g_free( stackTop->va->m_Cdata );
-			stackTop->va->m_data = buf;
-			stackTop->va->m_size = len;
-		}
+	for( ; i<n; ++i )
+	{
+		a[i] += b[i];
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_stdDeserialize( WRValue* stackTop, const int argn, WRContext* c )
+static void vecMulF( float* a, const float* b, const uint32_t n )
 {
-	if ( argn )
+	uint32_t i = 0;
+#ifdef WR_VEC_WIDTH
+	for( ; i + WR_VEC_WIDTH <= n; i += WR_VEC_WIDTH )
 	{
-		WRValue& V = (stackTop - argn)->deref();
-		if ( IS_ARRAY(V.xtype) && V.va->m_type == SV_CHAR )
-		{
-			if ( !wr_deserialize( c, *stackTop, V.va->m_SCdata, V.va->m_size ) )
-			{
-				stackTop->init();
-			}
-
-			c->gc( stackTop + 1 );
-		}
+		WR_VEC_STORE( a + i, WR_VEC_MUL(WR_VEC_LOAD(a + i), WR_VEC_LOAD(b + i)) );
+	}
+#endif
+	for( ; i<n; ++i )
+	{
+		a[i] *= b[i];
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_loadSerializeLib( WRState* w )
+// a = a*scale + bias, add and mul by a constant are this too
+static void vecScaleF( float* a, const float scale, const float bias, const uint32_t n )
 {
-	wr_registerLibraryFunction( w, "std::serialize", wr_stdSerialize );
-	wr_registerLibraryFunction( w, "std::deserialize", wr_stdDeserialize );
+	uint32_t i = 0;
+#ifdef WR_VEC_WIDTH
+	const WRVecF S = WR_VEC_SET1( scale );
+	const WRVecF B = WR_VEC_SET1( bias );
+	for( ; i + WR_VEC_WIDTH <= n; i += WR_VEC_WIDTH )
+	{
+		WR_VEC_STORE( a + i, WR_VEC_ADD(WR_VEC_MUL(WR_VEC_LOAD(a + i), S), B) );
+	}
+#endif
+	for( ; i<n; ++i )
+	{
+		a[i] = a[i]*scale + bias;
+	}
 }
-/*******************************************************************************
-Copyright (c) 2026 Curt Hartung -- curt.hartung@gmail.com
-
-MIT Licence
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in all
-copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-SOFTWARE.
-*******************************************************************************/
-
-#include "wrench.h"
 
 //------------------------------------------------------------------------------
-WRValue* wr_ifValueArray( WRValue* val )
+static void vecClampF( float* a, const float lo, const float hi, const uint32_t n )
 {
-	WRValue* ret = &(val->deref());
-	return (IS_ARRAY(ret->xtype) && ret->va->m_type == SV_VALUE) ? ret : 0;
+	uint32_t i = 0;
+#ifdef WR_VEC_WIDTH
+	const WRVecF L = WR_VEC_SET1( lo );
+	const WRVecF H = WR_VEC_SET1( hi );
+	for( ; i + WR_VEC_WIDTH <= n; i += WR_VEC_WIDTH )
+	{
+		WR_VEC_STORE( a + i, WR_VEC_MIN(WR_VEC_MAX(WR_VEC_LOAD(a + i), L), H) );
+	}
+#endif
+	for( ; i<n; ++i )
+	{
+		a[i] = a[i] < lo ? lo : (a[i] > hi ? hi : a[i]);
+	}
 }
 
+#ifdef WR_VEC_WIDTH
 //------------------------------------------------------------------------------
-WRValue* wr_ifHash( WRValue* val )
+static float vecLanes( const WRVecF V, const int op )
 {
-	WRValue* ret = &(val->deref());
-	return IS_HASH_TABLE(ret->xtype) ? ret : 0;
+	float lane[WR_VEC_WIDTH];
+	WR_VEC_STORE( lane, V );
+
+	float ret = lane[0];
+	for( int l=1; l<WR_VEC_WIDTH; ++l )
+	{
+		if ( op == 0 )
+		{
+			ret += lane[l];
+		}
+		else if ( op < 0 )
+		{
+			ret = lane[l] < ret ? lane[l] : ret;
+		}
+		else
+		{
+			ret = lane[l] > ret ? lane[l] : ret;
+		}
+	}
+	return ret;
 }
+#endif
 
 //------------------------------------------------------------------------------
-void wr_arrayCount( WRValue* stackTop, const int argn, WRContext* c )
+// b null for a plain sum
+static float vecDotF( const float* a, const float* b, const uint32_t n )
 {
-	WRValue* A;
-	if( argn == 0 || !(A = wr_ifValueArray(stackTop - argn)) )
+	uint32_t i = 0;
+	float ret = 0;
+#ifdef WR_VEC_WIDTH
+	if ( n >= WR_VEC_WIDTH )
 	{
-		return;
+		WRVecF acc = WR_VEC_SET1( 0.f );
+		for( ; i + WR_VEC_WIDTH <= n; i += WR_VEC_WIDTH )
+		{
+			acc = WR_VEC_ADD( acc, b ? WR_VEC_MUL(WR_VEC_LOAD(a + i), WR_VEC_LOAD(b + i)) : WR_VEC_LOAD(a + i) );
+		}
+		ret = vecLanes( acc, 0 );
 	}
-
-	stackTop->ui = A->va->m_size;
+#endif
+	for( ; i<n; ++i )
+	{
+		ret += b ? a[i]*b[i] : a[i];
+	}
+	return ret;
 }
 
 //------------------------------------------------------------------------------
-void wr_arrayClear( WRValue* stackTop, const int argn, WRContext* c )
+// op < 0 for the minimum, > 0 for the maximum, n must not be zero
+static float vecExtremeF( const float* a, const uint32_t n, const int op )
 {
-	if ( argn >= 1 )
+	uint32_t i = 0;
+	float ret = a[0];
+#ifdef WR_VEC_WIDTH
+	if ( n >= WR_VEC_WIDTH )
 	{
-		WRValue* args = stackTop - argn;
-
-		WRValue* A = &(args->deref());
-
-		A->p2 = INIT_AS_ARRAY;
-
-		unsigned int count = 0;
-		if ( argn > 1 )
+		WRVecF acc = WR_VEC_LOAD( a );
+		for( i = WR_VEC_WIDTH; i + WR_VEC_WIDTH <= n; i += WR_VEC_WIDTH )
 		{
-			count = args[1].asInt();
+			acc = (op < 0) ? WR_VEC_MIN( acc, WR_VEC_LOAD(a + i) ) : WR_VEC_MAX( acc, WR_VEC_LOAD(a + i) );
 		}
-		
-		A->va = c->getSVA( count, SV_VALUE, false );
-#ifdef WRENCH_HANDLE_MALLOC_FAIL
-		if ( !A->va )
+		ret = vecLanes( acc, op );
+	}
+#endif
+	for( ; i<n; ++i )
+	{
+		if ( (op < 0) ? (a[i] < ret) : (a[i] > ret) )
 		{
-			A->p2 = INIT_AS_INT;
-			return;
+			ret = a[i];
 		}
-#endif
-
-		*stackTop = *A;
 	}
+	return ret;
 }
 
 //------------------------------------------------------------------------------
-void wr_arrayPeek( WRValue* stackTop, const int argn, WRContext* c )
+template<class T> static void vecBinaryI( T* a, const T* b, const uint32_t n, const int op )
 {
-	WRValue* A;
-	if( argn == 0 || !(A = wr_ifValueArray(stackTop - argn)) )
+	// unsigned so overflow wraps instead of being undefined
+	if ( op == WRVec_Add )
 	{
-		return;
+		for( uint32_t i=0; i<n; ++i ) { a[i] = (T)((uint32_t)a[i] + (uint32_t)b[i]); }
+	}
+	else
+	{
+		for( uint32_t i=0; i<n; ++i ) { a[i] = (T)((uint32_t)a[i] * (uint32_t)b[i]); }
 	}
+}
 
-	if ( A->va->m_size > 0 )
+//------------------------------------------------------------------------------
+template<class T> static void vecScaleI( T* a, const int32_t scale, const int32_t bias, const uint32_t n )
+{
+	for( uint32_t i=0; i<n; ++i )
 	{
-		stackTop->p2 = INIT_AS_CONTAINER_MEMBER;// | ENCODE_ARRAY_ELEMENT_TO_P2( 0 );
-		stackTop->r = A;
+		a[i] = (T)((uint32_t)a[i]*(uint32_t)scale + (uint32_t)bias);
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_arrayPeekBack( WRValue* stackTop, const int argn, WRContext* c )
+template<class T> static void vecClampI( T* a, const int32_t lo, const int32_t hi, const uint32_t n )
 {
-	WRValue* A;
-	if( argn == 0 || !(A = wr_ifValueArray(stackTop - argn)) )
+	for( uint32_t i=0; i<n; ++i )
 	{
-		return;
+		a[i] = (T)((a[i] < lo) ? lo : ((a[i] > hi) ? hi : a[i]));
 	}
+}
 
-	if ( A->va->m_size > 0 )
+//------------------------------------------------------------------------------
+template<class T> static int32_t vecDotI( const T* a, const T* b, const uint32_t n )
+{
+	uint32_t ret = 0;
+	for( uint32_t i=0; i<n; ++i )
 	{
-		stackTop->p2 = INIT_AS_CONTAINER_MEMBER | ENCODE_ARRAY_ELEMENT_TO_P2( A->va->m_size - 1 );
-		stackTop->r = A;
+		ret += b ? (uint32_t)a[i]*(uint32_t)b[i] : (uint32_t)a[i];
 	}
+	return (int32_t)ret;
 }
 
 //------------------------------------------------------------------------------
-void wr_arrayRemoveEx( WRValue* A, const unsigned int where, const int count, WRValue* stackTop, WRContext* c )
+template<class T> static int32_t vecExtremeI( const T* a, const uint32_t n, const int op )
 {
-	if ( where < A->va->m_size )
+	T ret = a[0];
+	for( uint32_t i=1; i<n; ++i )
 	{
-		unsigned int from = where + count;
-		if ( from >= A->va->m_size )
-		{
-			A->va->m_size = where; // simple truncation
-		}
-		else
+		if ( (op < 0) ? (a[i] < ret) : (a[i] > ret) )
 		{
-			unsigned int elements = A->va->m_size - from;
-
-			memmove( (char*)(A->va->m_Vdata + where), // to here
-					 (char*)(A->va->m_Vdata + from),   // from here
-					 elements * sizeof(WRValue) ); // this many
-
-			A->va->m_size -= count;
+			ret = a[i];
 		}
-
-		c->gc( stackTop + 1 );
 	}
+	return ret;
 }
 
 //------------------------------------------------------------------------------
-void wr_arrayRemove( WRValue* stackTop, const int argn, WRContext* c )
+// the array (if any) an argument refers to
+static WRGCObject* vecArray( const WRValue* arg )
 {
-	WRValue* A;
-	WRValue* args = stackTop - argn;
+	const WRValue& V = arg->deref();
+	return IS_ARRAY(V.xtype) ? V.va : 0;
+}
 
-	if( (argn < 2) || !(A = wr_ifValueArray(args)) )
+//------------------------------------------------------------------------------
+static void vecGet( const WRGCObject* va, const uint32_t i, WRValue* to )
+{
+	if ( va->m_type == SV_VALUE )
 	{
-		return;
+		*to = va->m_Vdata[i].deref();
+	}
+	else
+	{
+		wr_unpackElement( va, i, to );
 	}
+}
 
-	unsigned int where = (unsigned int)(args[1].asInt());
+//------------------------------------------------------------------------------
+static void vecSet( WRGCObject* va, const uint32_t i, const WRValue* from )
+{
+	if ( va->m_type == SV_VALUE )
+	{
+		va->m_Vdata[i] = *from;
+	}
+	else
+	{
+		wr_packElement( va, i, from );
+	}
+}
 
-	int count = 1;
-	if ( argn > 2 )
+//------------------------------------------------------------------------------
+// element by element for mixed types and plain wrench arrays, the result
+// is float if either side is
+static void vecBinaryAny( WRGCObject* a, const WRGCObject* b, const WRValue* scalar, const WRValue* bias, const uint32_t n, const int op )
+{
+	WRValue x;
+	WRValue y;
+	y.init();
+	if ( scalar )
 	{
-		count = args[2].asInt();
+		y = *scalar;
 	}
 
-	wr_arrayRemoveEx( A, where, count, stackTop, c );
+	for( uint32_t i=0; i<n; ++i )
+	{
+		vecGet( a, i, &x );
+		if ( b )
+		{
+			vecGet( b, i, &y );
+		}
 
-	*stackTop = *A;
+		if ( x.type == WR_FLOAT || y.type == WR_FLOAT || (bias && bias->type == WR_FLOAT) )
+		{
+			x.f = (op == WRVec_Add) ? x.asFloat() + y.asFloat() : x.asFloat() * y.asFloat();
+			if ( bias )
+			{
+				x.f += bias->asFloat();
+			}
+			x.p2 = INIT_AS_FLOAT;
+		}
+		else
+		{
+			x.i = (op == WRVec_Add) ? x.asInt() + y.asInt() : x.asInt() * y.asInt();
+			if ( bias )
+			{
+				x.i += bias->asInt();
+			}
+			x.p2 = INIT_AS_INT;
+		}
+
+		vecSet( a, i, &x );
+	}
 }
 
 //------------------------------------------------------------------------------
-void wr_arrayTruncate( WRValue* stackTop, const int argn, WRContext* c )
+// vec::add( a, b ) and vec::mul( a, b ): 'a' is updated in place with
+// the elementwise result and returned, 'b' is an array or a number
+static void vecBinary( WRValue* stackTop, const int argn, const int op )
 {
-	WRValue* A;
+	WRGCObject* a;
+	if ( argn < 2 || !(a = vecArray(stackTop - argn)) )
+	{
+		return;
+	}
+
 	WRValue* args = stackTop - argn;
+	*stackTop = args->deref();
 
-	if( (argn < 1) || !(A = wr_ifValueArray(args)) )
+	const WRGCObject* b = vecArray( args + 1 );
+	uint32_t n = a->m_size;
+
+	if ( !b )
 	{
+		WRValue S = args[1].deref();
+		if ( a->m_type == SV_FLOAT32 )
+		{
+			if ( op == WRVec_Add )
+			{
+				vecScaleF( a->m_Fdata, 1.f, S.asFloat(), n );
+			}
+			else
+			{
+				vecScaleF( a->m_Fdata, S.asFloat(), 0.f, n );
+			}
+		}
+		else if ( a->m_type == SV_INT32 && S.type == WR_INT )
+		{
+			vecScaleI( a->m_Idata, (op == WRVec_Add) ? 1 : S.i, (op == WRVec_Add) ? S.i : 0, n );
+		}
+		else if ( (a->m_type == SV_UINT8 || a->m_type == SV_CHAR) && S.type == WR_INT )
+		{
+			vecScaleI( a->m_Cdata, (op == WRVec_Add) ? 1 : S.i, (op == WRVec_Add) ? S.i : 0, n );
+		}
+		else
+		{
+			vecBinaryAny( a, 0, &S, 0, n, op );
+		}
 		return;
 	}
 
-	unsigned int size = (unsigned int)(args[1].asInt());
-
-	if ( size < A->va->m_size )
+	if ( b->m_size < n )
 	{
-		A->va->m_size = size; // *snip*
-		c->gc( stackTop + 1 );
+		n = b->m_size;
 	}
 
-	*stackTop = *A;
+	if ( a->m_type != b->m_type || a->m_type == SV_VALUE )
+	{
+		vecBinaryAny( a, b, 0, 0, n, op );
+	}
+	else if ( a->m_type == SV_FLOAT32 )
+	{
+		if ( op == WRVec_Add )
+		{
+			vecAddF( a->m_Fdata, b->m_Fdata, n );
+		}
+		else
+		{
+			vecMulF( a->m_Fdata, b->m_Fdata, n );
+		}
+	}
+	else if ( a->m_type == SV_INT32 )
+	{
+		vecBinaryI( a->m_Idata, b->m_Idata, n, op );
+	}
+	else
+	{
+		vecBinaryI( a->m_Cdata, b->m_Cdata, n, op );
+	}
 }
 
 //------------------------------------------------------------------------------
-void wr_arrayInsertEx( WRValue* A, const unsigned int where, const unsigned int count, WRValue* stackTop, WRContext* c )
+void wr_vecAdd( WRValue* stackTop, const int argn, WRContext* c )
 {
-	unsigned int originalSize = A->va->m_size;
-	// accommodate new size (passed value is expected to be the highest accessible index)
-	wr_growValueArray( A->va, originalSize + (count - 1) );
-
-	// move tail of array UP "count" entries
-	unsigned int entries = originalSize - where;
-	if ( entries )
-	{
-		unsigned int to = where + count;
-
-		memmove( (char*)(A->va->m_Vdata + to),
-				 (char*)(A->va->m_Vdata + where),
-				 entries * sizeof(WRValue) );
-
-		memset( (char*)(A->va->m_Vdata + where),
-				0,
-				count * sizeof(WRValue) );
-	}
-
-	c->gc( stackTop + 1 );
+	vecBinary( stackTop, argn, WRVec_Add );
 }
 
 //------------------------------------------------------------------------------
-void wr_arrayInsert( WRValue* stackTop, const int argn, WRContext* c )
+void wr_vecMul( WRValue* stackTop, const int argn, WRContext* c )
 {
-	WRValue* A;
-	WRValue* args = stackTop - argn;
+	vecBinary( stackTop, argn, WRVec_Mul );
+}
 
-	if( (argn < 2) || !(A = wr_ifValueArray(args)) )
+//------------------------------------------------------------------------------
+// vec::scale( a, s, [bias] ): a[i] = a[i]*s + bias in place, returns 'a'
+void wr_vecScale( WRValue* stackTop, const int argn, WRContext* c )
+{
+	WRGCObject* a;
+	if ( argn < 2 || !(a = vecArray(stackTop - argn)) )
 	{
 		return;
 	}
 
-	unsigned int where = (unsigned int)(args[1].asInt());
+	WRValue* args = stackTop - argn;
+	*stackTop = args->deref();
 
-	int count = 1;
+	WRValue S = args[1].deref();
+	WRValue B;
+	B.init();
 	if ( argn > 2 )
 	{
-		count = args[2].asInt();
+		B = args[2].deref();
 	}
 
-	wr_arrayInsertEx( A, where, count, stackTop, c );
-
-	*stackTop = *A;
+	if ( a->m_type == SV_FLOAT32 )
+	{
+		vecScaleF( a->m_Fdata, S.asFloat(), B.asFloat(), a->m_size );
+	}
+	else if ( a->m_type == SV_INT32 && S.type == WR_INT && B.type == WR_INT )
+	{
+		vecScaleI( a->m_Idata, S.i, B.i, a->m_size );
+	}
+	else if ( (a->m_type == SV_UINT8 || a->m_type == SV_CHAR) && S.type == WR_INT && B.type == WR_INT )
+	{
+		vecScaleI( a->m_Cdata, S.i, B.i, a->m_size );
+	}
+	else
+	{
+		vecBinaryAny( a, 0, &S, &B, a->m_size, WRVec_Mul );
+	}
 }
 
 //------------------------------------------------------------------------------
-void wr_arrayPop( WRValue* stackTop, const int argn, WRContext* c )
+// vec::clamp( a, lo, hi ) in place, returns 'a'
+void wr_vecClamp( WRValue* stackTop, const int argn, WRContext* c )
 {
-	WRValue* A;
-	WRValue* args = stackTop - argn;
-
-	if( (argn < 1) || !(A = wr_ifValueArray(args)) )
+	WRGCObject* a;
+	if ( argn < 3 || !(a = vecArray(stackTop - argn)) )
 	{
 		return;
 	}
 
-	if ( A->va->m_size )
+	WRValue* args = stackTop - argn;
+	*stackTop = args->deref();
+
+	// copies, deref() of an element can share storage
+	const WRValue L = args[1].deref();
+	const WRValue H = args[2].deref();
+
+	if ( a->m_type == SV_FLOAT32 )
 	{
-		*stackTop = *A->va->m_Vdata;
-		wr_arrayRemoveEx( A, 0, 1, stackTop, c );
+		vecClampF( a->m_Fdata, L.asFloat(), H.asFloat(), a->m_size );
+	}
+	else if ( a->m_type == SV_INT32 )
+	{
+		vecClampI( a->m_Idata, L.asInt(), H.asInt(), a->m_size );
+	}
+	else if ( a->m_type == SV_UINT8 || a->m_type == SV_CHAR )
+	{
+		vecClampI( a->m_Cdata, L.asInt(), H.asInt(), a->m_size );
+	}
+	else
+	{
+		const bool isFloat = L.type == WR_FLOAT || H.type == WR_FLOAT;
+		WRValue x;
+		for( uint32_t i=0; i<a->m_size; ++i )
+		{
+			vecGet( a, i, &x );
+			if ( isFloat || x.type == WR_FLOAT )
+			{
+				const float f = x.asFloat();
+				x.f = f < L.asFloat() ? L.asFloat() : (f > H.asFloat() ? H.asFloat() : f);
+				x.p2 = INIT_AS_FLOAT;
+			}
+			else
+			{
+				const int v = x.asInt();
+				x.i = v < L.asInt() ? L.asInt() : (v > H.asInt() ? H.asInt() : v);
+				x.p2 = INIT_AS_INT;
+			}
+			vecSet( a, i, &x );
+		}
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_arrayPopBack( WRValue* stackTop, const int argn, WRContext* c )
+// sum of a[i]*b[i], or of a[i] when b is null
+static void vecDot( WRValue* stackTop, const WRGCObject* a, const WRGCObject* b )
 {
-	WRValue* A;
-	WRValue* args = stackTop - argn;
-
-	if( (argn < 1) || !(A = wr_ifValueArray(args)) )
+	uint32_t n = a->m_size;
+	if ( b && b->m_size < n )
 	{
-		return;
+		n = b->m_size;
 	}
 
-	if ( A->va->m_size )
+	stackTop->p2 = INIT_AS_INT;
+	stackTop->i = 0;
+
+	if ( (!b || b->m_type == a->m_type) && a->m_type == SV_FLOAT32 )
 	{
-		--A->va->m_size;
-		*stackTop = A->va->m_Vdata[A->va->m_size];
-		c->gc( stackTop + 1 );
+		stackTop->p2 = INIT_AS_FLOAT;
+		stackTop->f = vecDotF( a->m_Fdata, b ? b->m_Fdata : 0, n );
+	}
+	else if ( (!b || b->m_type == a->m_type) && a->m_type == SV_INT32 )
+	{
+		stackTop->i = vecDotI( a->m_Idata, b ? b->m_Idata : 0, n );
+	}
+	else if ( (!b || b->m_type == a->m_type) && (a->m_type == SV_UINT8 || a->m_type == SV_CHAR) )
+	{
+		stackTop->i = vecDotI( a->m_Cdata, b ? b->m_Cdata : 0, n );
+	}
+	else
+	{
+		WRValue x;
+		WRValue y;
+		y.init( 1 );
+		for( uint32_t i=0; i<n; ++i )
+		{
+			vecGet( a, i, &x );
+			if ( b )
+			{
+				vecGet( b, i, &y );
+			}
+
+			if ( stackTop->type == WR_FLOAT || x.type == WR_FLOAT || y.type == WR_FLOAT )
+			{
+				stackTop->f = stackTop->asFloat() + x.asFloat()*y.asFloat();
+				stackTop->p2 = INIT_AS_FLOAT;
+			}
+			else
+			{
+				stackTop->i += x.asInt()*y.asInt();
+			}
+		}
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_arrayPushBack( WRValue* stackTop, const int argn, WRContext* c )
+// vec::dot( a, b )
+void wr_vecDot( WRValue* stackTop, const int argn, WRContext* c )
 {
-	WRValue* A;
-	WRValue* args = stackTop - argn;
-
-	if( (argn < 2) || !(A = wr_ifValueArray(args)) )
+	WRGCObject* a;
+	WRGCObject* b;
+	if ( argn >= 2 && (a = vecArray(stackTop - argn)) && (b = vecArray(stackTop - argn + 1)) )
 	{
-		return;
+		vecDot( stackTop, a, b );
 	}
-
-	const unsigned int where = A->va->m_size;
-
-	wr_arrayInsertEx( A, where, 1, stackTop, c );
-	A->va->m_Vdata[where] = args[1];
 }
 
 //------------------------------------------------------------------------------
-void wr_arrayPush( WRValue* stackTop, const int argn, WRContext* c )
+// vec::sum( a )
+void wr_vecSum( WRValue* stackTop, const int argn, WRContext* c )
 {
-	WRValue* A;
-	WRValue* args = stackTop - argn;
-
-	if( (argn < 2) || !(A = wr_ifValueArray(args)) )
+	WRGCObject* a;
+	if ( argn >= 1 && (a = vecArray(stackTop - argn)) )
 	{
-		return;
+		vecDot( stackTop, a, 0 );
 	}
-
-	wr_arrayInsertEx( A, 0, 1, stackTop, c );
-	A->va->m_Vdata[0] = args[1];
 }
 
 //------------------------------------------------------------------------------
-void wr_hashClear( WRValue* stackTop, const int argn, WRContext* c )
+static void vecExtreme( WRValue* stackTop, const int argn, const int op )
 {
-	if ( argn >= 1 )
+	WRGCObject* a;
+	if ( argn < 1 || !(a = vecArray(stackTop - argn)) || !a->m_size )
 	{
-		WRValue* A = &((stackTop - argn)->deref());
+		return;
+	}
 
-		A->p2 = INIT_AS_HASH_TABLE;
-		A->va = c->getSVA( 0, SV_HASH_TABLE, false );
-#ifdef WRENCH_HANDLE_MALLOC_FAIL
-		if ( !A->va )
+	if ( a->m_type == SV_FLOAT32 )
+	{
+		stackTop->p2 = INIT_AS_FLOAT;
+		stackTop->f = vecExtremeF( a->m_Fdata, a->m_size, op );
+	}
+	else if ( a->m_type == SV_INT32 )
+	{
+		stackTop->p2 = INIT_AS_INT;
+		stackTop->i = vecExtremeI( a->m_Idata, a->m_size, op );
+	}
+	else if ( a->m_type == SV_UINT8 || a->m_type == SV_CHAR )
+	{
+		stackTop->p2 = INIT_AS_INT;
+		stackTop->i = vecExtremeI( a->m_Cdata, a->m_size, op );
+	}
+	else
+	{
+		WRValue x;
+		vecGet( a, 0, stackTop );
+		for( uint32_t i=1; i<a->m_size; ++i )
 		{
-			A->p2 = INIT_AS_INT;
-			return;
+			vecGet( a, i, &x );
+			if ( (op < 0) ? (x.asFloat() < stackTop->asFloat()) : (x.asFloat() > stackTop->asFloat()) )
+			{
+				*stackTop = x;
+			}
 		}
-#endif
-
-		*stackTop = *A;
-		
-		c->gc( stackTop + 1 );
 	}
 }
 
 //------------------------------------------------------------------------------
-void wr_hashCount( WRValue* stackTop, const int argn, WRContext* c )
+// vec::min( a )
+void wr_vecMin( WRValue* stackTop, const int argn, WRContext* c )
 {
-	WRValue* H;
-	if( argn == 0 || !(H = wr_ifHash(stackTop - argn)) )
-	{
-		return;
-	}
+	vecExtreme( stackTop, argn, -1 );
+}
 
-	stackTop->ui = H->va->m_size;
+//------------------------------------------------------------------------------
+// vec::max( a )
+void wr_vecMax( WRValue* stackTop, const int argn, WRContext* c )
+{
+	vecExtreme( stackTop, argn, 1 );
 }
 
 //------------------------------------------------------------------------------
-void wr_hashAdd( WRValue* stackTop, const int argn, WRContext* c )
+// vec::float32( count ) or vec::float32( array ) to convert one, same
+// for int32 and uint8
+static void vecMake( WRValue* stackTop, const int argn, WRContext* c, const char type )
 {
-	WRValue* H;
-	WRValue* args = stackTop - argn;
-	if( argn < 3 || !(H = wr_ifHash(args)) )
+	const WRGCObject* from = 0;
+	int count = 0;
+	if ( argn >= 1 && !(from = vecArray(stackTop - argn)) )
 	{
-		return;
+		count = (stackTop - argn)->asInt();
 	}
 
-	uint32_t hash = args[2].getHash(); // key
-	int element;
-	WRValue* entry = (WRValue*)( H->va->get(hash, &element) );
+	if ( from )
+	{
+		count = from->m_size;
+	}
 
-	*entry = args[1].deref();
-	*(entry + 1) = args[2].deref();
+	wr_makeTypedArray( c, stackTop, count > 0 ? count : 0, type );
 
-	stackTop->p2 = INIT_AS_CONTAINER_MEMBER | ENCODE_ARRAY_ELEMENT_TO_P2( element );
-	stackTop->vb = (WRGCBase*)(H->va->m_Vdata) - 1;
+	if ( from && IS_ARRAY(stackTop->xtype) )
+	{
+		WRValue x;
+		for( uint32_t i=0; i<from->m_size; ++i )
+		{
+			vecGet( from, i, &x );
+			wr_packElement( stackTop->va, i, &x );
+		}
+	}
 }
 
 //------------------------------------------------------------------------------
-void wr_hashExistEx( WRValue* stackTop, const int argn, bool remove )
+void wr_vecInt32( WRValue* stackTop, const int argn, WRContext* c )
 {
-	WRValue* H;
-	WRValue* args = stackTop - argn;
-	if( (argn >= 2) && (H = wr_ifHash(args)) )
-	{
-		stackTop->p = H->va->exists( args[1].getHash(), remove );
-	}
+	vecMake( stackTop, argn, c, SV_INT32 );
 }
 
 //------------------------------------------------------------------------------
-void wr_hashRemove( WRValue* stackTop, const int argn, WRContext* c )
+void wr_vecFloat32( WRValue* stackTop, const int argn, WRContext* c )
 {
-	wr_hashExistEx( stackTop, argn, true );
+	vecMake( stackTop, argn, c, SV_FLOAT32 );
 }
 
 //------------------------------------------------------------------------------
-void wr_hashExists( WRValue* stackTop, const int argn, WRContext* c )
+void wr_vecUint8( WRValue* stackTop, const int argn, WRContext* c )
 {
-	wr_hashExistEx( stackTop, argn, false );
+	vecMake( stackTop, argn, c, SV_UINT8 );
 }
 
 //------------------------------------------------------------------------------
-void wr_loadContainerLib( WRState* w )
+void wr_loadVecLib( WRState* w )
 {
-	wr_registerLibraryFunction( w, "array::clear", wr_arrayClear );       // ( array )
-	wr_registerLibraryFunction( w, "array::count", wr_arrayCount );       // ( array )
-	wr_registerLibraryFunction( w, "array::remove", wr_arrayRemove );     // ( array, where, [count == 1] )
-	wr_registerLibraryFunction( w, "array::insert", wr_arrayInsert );     // ( array, where, [count == 1] )
-	wr_registerLibraryFunction( w, "array::truncate", wr_arrayTruncate ); // ( array, newSize )
-
-	wr_registerLibraryFunction( w, "hash::clear", wr_hashClear );   // ( hash )
-	wr_registerLibraryFunction( w, "hash::count", wr_hashCount );   // ( hash )
-	wr_registerLibraryFunction( w, "hash::add", wr_hashAdd );       // ( hash, item, key )
-	wr_registerLibraryFunction( w, "hash::remove", wr_hashRemove ); // ( hash, key )
-	wr_registerLibraryFunction( w, "hash::exists", wr_hashExists ); // ( hash, key )
-
-	wr_registerLibraryFunction( w, "list::clear", wr_arrayClear );        // ( list )
-	wr_registerLibraryFunction( w, "list::count", wr_arrayCount );        // ( list )
-	wr_registerLibraryFunction( w, "list::peek", wr_arrayPeek );          // ( list )
-	wr_registerLibraryFunction( w, "list::pop", wr_arrayPop );            // ( list )
-	wr_registerLibraryFunction( w, "list::pop_front", wr_arrayPop );      // ( list )
-	wr_registerLibraryFunction( w, "list::pop_back", wr_arrayPopBack );   // ( list )
-	wr_registerLibraryFunction( w, "list::push", wr_arrayPush );          // ( list, item )
-	wr_registerLibraryFunction( w, "list::push_front", wr_arrayPush );    // ( list, item )
-	wr_registerLibraryFunction( w, "list::push_back", wr_arrayPushBack ); // ( list )
-
-	wr_registerLibraryFunction( w, "queue::clear", wr_arrayClear );   // ( q )
-	wr_registerLibraryFunction( w, "queue::count", wr_arrayCount );   // ( q )
-	wr_registerLibraryFunction( w, "queue::push", wr_arrayPush );     // ( q, item )
-	wr_registerLibraryFunction( w, "queue::pop", wr_arrayPopBack );   // ( q )
-	wr_registerLibraryFunction( w, "queue::peek", wr_arrayPeekBack ); // ( q )
+	wr_registerLibraryFunction( w, "vec::int32", wr_vecInt32 );
+	wr_registerLibraryFunction( w, "vec::float32", wr_vecFloat32 );
+	wr_registerLibraryFunction( w, "vec::uint8", wr_vecUint8 );
 
-	wr_registerLibraryFunction( w, "stack::clear", wr_arrayClear ); // ( stack )
-	wr_registerLibraryFunction( w, "stack::count", wr_arrayCount ); // ( stack )
-	wr_registerLibraryFunction( w, "stack::push", wr_arrayPush );   // ( stack, item )
-	wr_registerLibraryFunction( w, "stack::pop", wr_arrayPop );     // ( stack )
-	wr_registerLibraryFunction( w, "stack::peek", wr_arrayPeek );   // ( stack )
+	wr_registerLibraryFunction( w, "vec::add", wr_vecAdd );
+	wr_registerLibraryFunction( w, "vec::mul", wr_vecMul );
+	wr_registerLibraryFunction( w, "vec::scale", wr_vecScale );
+	wr_registerLibraryFunction( w, "vec::clamp", wr_vecClamp );
+	wr_registerLibraryFunction( w, "vec::dot", wr_vecDot );
+	wr_registerLibraryFunction( w, "vec::sum", wr_vecSum );
+	wr_registerLibraryFunction( w, "vec::min", wr_vecMin );
+	wr_registerLibraryFunction( w, "vec::max", wr_vecMax );
 }
 
 /*******************************************************************************
@@ -68,6 +68,20 @@ allows it (x86/64, Mac, most *nix etc..) this is a decent optimization
 //#define WRENCH_UNALIGNED_READS
 
 
+/***********************************************************************
+Arithmetic and compare instructions normally look their operation up in
+a table indexed by both operand types. With this defined each context
+builds a table with a handler address for every byte of its bytecode the
+first time it runs (sizeof(void*) bytes of RAM per byte of bytecode) and
+an instruction that sees two ints (or two floats) points its own entry
+at a handler that does the operation inline, putting the original back
+the first time that guess is wrong. The bytecode itself is never
+written. Ignored by the WRENCH_COMPACT and switch() interpreters
+(WRENCH_REALLY_COMPACT, MSVC)
+*/
+//#define WRENCH_QUICKENING
+
+
 /***********************************************************************
 wrench automatically detects endian-ness and defines these three
 macros for reading data from the code stream, if you have special
@@ -110,6 +124,56 @@ depending on usage. (consumes 8 bytes per stack entry)
 //#define WRENCH_PROTECT_STACK_FROM_OVERFLOW
 
 
+/************************************************************************
+When compiling with WR_INLINE_FUNCTIONS, functions with no more than
+this many bytes of bytecode (and no calls, loops over iterators or
+other frame-sensitive code) are copied into their callers instead of
+being called. Larger values trade image size for fewer calls
+*/
+#ifndef WRENCH_INLINE_MAX_BYTES
+#define WRENCH_INLINE_MAX_BYTES 64
+#endif
+
+
+/************************************************************************
+Calls to native (wr_registerFunction) and imported functions are
+resolved by hash. Each context keeps a small direct-mapped cache of
+resolved call sites (keyed by bytecode offset) so repeated calls skip
+the lookup. Value is the number of entries and must be a power of 2,
+costs ~24 bytes per entry per context. set to 0 to remove it.
+Defaults to 16, or 0 when WRENCH_COMPACT is defined
+*/
+//#define WRENCH_CALL_SITE_CACHE 16
+
+
+/************************************************************************
+Struct members (S.member) are found by hashing into a small table in
+the bytecode. Each context also keeps a direct-mapped cache of member
+access sites (keyed by bytecode offset) remembering which struct
+layout was last seen there and where the member is, so a site that
+keeps seeing the same struct type indexes straight to the value.
+Value is the number of entries and must be a power of 2, costs ~16
+bytes per entry per context. set to 0 to remove it.
+Defaults to 16, or 0 when WRENCH_COMPACT is defined
+*/
+//#define WRENCH_MEMBER_CACHE 16
+
+
+/************************************************************************
+Compiles in a generational collector which can be selected per state
+with wr_setGCMode(). New objects live in a nursery that is collected on
+its own; survivors are promoted to an old generation which is only
+walked when enough has been promoted since the last full collection, or
+wr_setGCMode() sets WR_GC_FULL (the default). Containers written to
+after promotion are tracked in a per-context remembered set, this adds
+a small check whenever a container element is referenced.
+NOTE: host writes into container elements are only tracked when the
+element came from WrenchValue or WRValue::indexArray(), and only until
+the next call into wrench; re-fetch rather than hold on to it.
+*/
+//#define WRENCH_GENERATIONAL_GC
+
+
 /************************************************************************
 With this defined the VM will enforce a maximum number of instructions
 before a yield is forced, to prevent infinite loops, this adds a small check to each
@@ -125,6 +189,28 @@ void wr_forceYield( WRState* w );  // for the VM to yield right NOW
 int wr_slicesUsedLastCall( WRState* w );  // how many time slices did the last call to the VM use?
 #endif
 
+/************************************************************************
+Counts every instruction the interpreter dispatches, and every pair and
+triple of consecutive instructions, in a table kept by the WRState (see
+wr_opcodeProfile() below). This is for finding out which sequences are
+worth fusing into a single instruction, it costs about 700k of RAM per
+state and a lot of speed so never ship with it.
+"wrench prof [file]" runs a script and prints the report
+*/
+//#define WRENCH_OPCODE_PROFILE
+
+/************************************************************************
+Requires WRENCH_TIME_SLICES and pthreads. WrenchScheduler (below) runs
+its tasks on a pool of worker threads, each with its own WRState.
+Workers that run out of tasks during a tick steal them from busier
+workers, migrating the context to their own state.
+*/
+//#define WRENCH_THREADED_SCHEDULER
+
+#if defined(WRENCH_THREADED_SCHEDULER) && !defined(WRENCH_TIME_SLICES)
+#error "WRENCH_THREADED_SCHEDULER requires WRENCH_TIME_SLICES"
+#endif
+
 /************************************************************************
 if you WANT full sprintf support for floats (%f/%g) this adds it at
 the cost of using the standard c library for it (stdlib.h), which can incur a
@@ -133,6 +219,14 @@ decent code-size penalty. Without this %f/%g is ignored.
 //#define WRENCH_FLOAT_SPRINTF
 
 
+/************************************************************************
+the vec:: library (wr_loadVecLib) runs its float kernels on SSE or AVX
+when the compiler targets them. Define this to always use the plain
+loops, for instance to get bit-identical sums across machines
+*/
+//#define WRENCH_VEC_SCALAR
+
+
 /************************************************************************
 File operations: define ONE of these. If you use "Custom" then you
 need to link in a source file with the functions defined in:
@@ -189,11 +283,45 @@ typedef void* (*WR_ALLOC)(size_t size);
 typedef void (*WR_FREE)(void* ptr);
 void wr_setGlobalAllocator( WR_ALLOC wralloc, WR_FREE wrfree );
 
+/************************************************************************
+Threads:
+Separate WRStates, and the contexts created from them, may run at the
+same time on different threads; nothing a state does at runtime touches
+memory shared with another state. The global allocator above is the
+only process-wide setting and must be installed before any state is
+created. A single WRState must only be used by one thread at a time.
+The VM keeps a few per-thread scratch values, WR_THREAD_LOCAL is worked
+out below for msvc and gcc/clang on hosted platforms and is empty
+otherwise (single-threaded targets); define it to override.
+*/
+//#define WR_THREAD_LOCAL __thread
+
+/************************************************************************
+Pooled allocation for script objects:
+With this defined wr_setPoolAllocator() can turn on a per-state pool
+for strings, arrays and structs. The object header and a small payload
+are allocated together out of size-classed slabs (taken from the global
+allocator above, WRENCH_POOL_SLAB_SIZE bytes at a time) and the gc
+returns them to free lists instead of freeing them. Slabs are only
+released by wr_destroyState(). Larger payloads still use the global
+allocator.
+*/
+//#define WRENCH_POOL_ALLOCATOR
+
+#ifdef WRENCH_POOL_ALLOCATOR
+#ifndef WRENCH_POOL_SLAB_SIZE
+#define WRENCH_POOL_SLAB_SIZE 4096
+#endif
+void wr_setPoolAllocator( WRState* w, const bool enable );
+#endif
+
 //------------------------------------------------------------------------------
 
 struct WRValue;
 struct WRFunction;
 struct WRContext;
+struct WRMappedFile;
+struct WROpcodeProfile;
 class WRstr;
 
 //------------------------------------------------------------------------------
@@ -267,6 +395,8 @@ enum WRError
 	WR_ERR_USER_err_out_of_range,
 
 	WR_ERR_division_by_zero,
+
+	WR_ERR_context_cannot_be_cloned,
 	
 	WR_warning_enums_follow,
 
@@ -323,6 +453,17 @@ enum WrenchCompilerFlags
 	WR_EMBED_SOURCE_CODE = 1<<2, // include a copy of the source code
 	
 	WR_NON_STRICT_VAR    = 1<<3, // require 'var' to declare a variable (disabled by default)
+
+	WR_WIDE_BYTECODE     = 1<<4, // 16-bit global/function counts and 32-bit code offsets,
+								 // set automatically when a script needs more than 255
+								 // globals, functions or locals, or more than 64k of code
+
+	WR_INLINE_FUNCTIONS  = 1<<5, // copy small leaf functions into their callers instead
+								 // of calling them (disabled by default)
+
+	WR_OPTIMIZE          = 1<<6, // fold constant expressions and math:: calls, propagate
+								 // locals that are only ever assigned a constant and
+								 // drop branches that can never run (disabled by default)
 };
 
 WRError wr_compile( const char* source,
@@ -340,6 +481,13 @@ bool wr_isBytecodeValid( const uint8_t* bytecode, const unsigned int len, uint32
 void wr_disassemble( const uint8_t* bytecode, const unsigned int len, WRstr& out, const bool includeComments =true );
 void wr_disassemble( const uint8_t* bytecode, const unsigned int len, char** out, unsigned int* outLen =0 );
 
+#ifdef WRENCH_OPCODE_PROFILE
+// the 'top' most frequently dispatched instructions, pairs and triples
+// since the state was created or last reset
+void wr_opcodeProfile( WRState* w, WRstr& out, const int top =20 );
+void wr_resetOpcodeProfile( WRState* w );
+#endif
+
 // w:          state (see wr_newState)
 // block:      location of bytecode
 // blockSize:  number of bytes in the block
@@ -381,6 +529,19 @@ WRValue* wr_returnValueFromLastCall( WRContext* context );
 WRContext* wr_newContext( WRState* w, const unsigned char* block, const int blockSize, bool takeOwnership =false );
 WRValue* wr_executeContext( WRContext* context );
 
+#ifdef WRENCH_LINUX_FILE_IO
+// Same as wr_run()/wr_newContext() but the bytecode is mapped read-only
+// straight from a file. The mapping, its CRC check and the decoded
+// function table are cached by the state and shared by every context
+// made from that file until it changes (device/inode/size/mtime), and
+// the OS shares the pages with any other process mapping it. Replace
+// bytecode files rather than rewriting them in place.
+// returns 0 with WR_ERR_bad_bytecode_CRC if the file could not be
+// mapped or is not valid bytecode
+WRContext* wr_runMapped( WRState* w, const char* path );
+WRContext* wr_newContextMapped( WRState* w, const char* path );
+#endif
+
 // after wr_run() this allows any function in the script to be
 // called with the given arguments, returning a single value
 //
@@ -445,12 +606,38 @@ WRValue* wr_getGlobalRef( WRContext* context, const char* label );
 //       is called, it is NOT necessary to call this on each context
 void wr_destroyContext( WRContext* context );
 
+// Move a context (and anything it imported) to another state, for
+// instance to resume a yielded context on a different thread. The
+// target state must have the same functions and libraries registered.
+// With WRENCH_POOL_ALLOCATOR memory can end up recycled through the
+// other state's pool, so the two states should be destroyed together
+bool wr_migrateContext( WRContext* context, WRState* to );
+
+// Copy a context that has finished running its global code, so it can
+// be used without running that code again. Globals and everything they
+// reach are deep-copied into the new context, the bytecode is shared so
+// the copy must not outlive 'context' unless it came from
+// wr_newContextMapped(). Yielded contexts and contexts that imported
+// code can not be cloned (WR_ERR_context_cannot_be_cloned)
+WRContext* wr_cloneContext( WRContext* context );
+
 // how many bytes of memory must be allocated before the gc will run, default
 // set here, can be adjusted at runtime with the
 // wr_setAllocatedMemoryGCHint()
 #define WRENCH_DEFAULT_ALLOCATED_MEMORY_GC_HINT 4000
 void wr_setAllocatedMemoryGCHint( WRState* w, const uint32_t bytes );
 
+#ifdef WRENCH_GENERATIONAL_GC
+// select how contexts in this state collect garbage, see
+// WRENCH_GENERATIONAL_GC above
+enum WRGCMode
+{
+	WR_GC_FULL = 0, // every collection marks and sweeps everything (default)
+	WR_GC_GENERATIONAL, // collect the nursery, only occasionally the whole heap
+};
+void wr_setGCMode( WRState* w, const WRGCMode mode );
+#endif
+
 /***************************************************************/
 /***************************************************************/
 //                 Callbacks from wrench                         
@@ -542,6 +729,7 @@ void wr_loadSerializeLib( WRState* w ); // serialize WRValues to and from binary
 void wr_loadDebugLib( WRState* w ); // debugger interaction functions
 void wr_loadTCPLib( WRState* w ); // TCP/IP functions
 void wr_loadContainerLib( WRState* w ); // array/hash/queue/stack/list
+void wr_loadVecLib( WRState* w ); // packed int32/float32/uint8 arrays and math on them
 
 // arduino-specific functions, be sure to add arduino_lib.cpp to your
 // sketch. much thanks to Koepel for contributing
@@ -568,6 +756,11 @@ void wr_loadArduinoLCDLib( WRState* w );
 // a string has to exist in a context so it can be worked with
 // ALSO can use the WRValue methods 'set...' directly
 WRValue& wr_makeString( WRContext* context, WRValue* val, const char* data, const int len =0 );
+
+// a zeroed packed array of 'count' SV_INT32, SV_FLOAT32 or SV_UINT8
+// elements, script indexes it like any other array. Get at the data
+// with val->array( &len, arrayType )
+WRValue& wr_makeTypedArray( WRContext* context, WRValue* val, const uint32_t count, const char arrayType );
 inline WRValue& wr_makeInt( WRValue* val, int i );
 inline WRValue& wr_makeFloat( WRValue* val, float f );
 
@@ -597,8 +790,9 @@ WRValue* wr_getValueFromContainer( WRValue const& container, const char* name );
 /******************************************************************/
 //                    "standard" functions
 
-extern int32_t wr_Seed;
-extern const int32_t wr_randEx( const int32_t from, const int32_t to );
+// math::rand()/srand() state is kept per WRState
+void wr_setRandomSeed( WRState* w, const int32_t seed );
+const int32_t wr_randEx( WRState* w, const int32_t from, const int32_t to );
 
 
 // inside-baseball time. This has to be here so stuff that includes
@@ -654,8 +848,10 @@ The "extended" types are:
                               such that shifting them >>8 yields
                               the actual array size
                        This is done so the value is never garbage
-                       collected, or matched to the wrong type, but
-                       does limit the size of an array to 2megabytes
+                       collected, or matched to the wrong type. On
+                       64-bit targets any bits past those 21 go in
+                       the top 32 bits of p2, elsewhere the size is
+                       limited to 2megabytes
 
 0x40xxxxxx  debug break: stop execution and do debugging work
 
@@ -677,19 +873,24 @@ The "extended" types are:
                              the actual element
                              
 						     This is done so the value is never garbage
-							 collected, or matched to the wrong type, but
-							 does limit the size of an array to 2megabytes
+							 collected, or matched to the wrong type. On
+							 64-bit targets any bits past those 21 go in
+							 the top 32 bits of p2, elsewhere arrays are
+							 limited to 2 million elements
                               
 0xA0xxxxxx  array/utility hash:
                         va-> holds a pointer to the actual array object (gc_object)
                         which has been allocated and is subject to
                         garbage collection
 
-                        there are 4 kinds of "array" objects:
+                        the kinds of "array" objects are:
 
 						SV_VALUE            0x01 array of WRValues
 						SV_CHAR             0x02 array of chars (this
                          						 is how strings are represented)
+						SV_INT32/SV_FLOAT32/SV_UINT8
+						                         packed arrays of raw
+						                         machine values (no gc)
 						SV_VOID_HASH_TABLE  0x04 hash table of void*
 						                         (do not gc)
 						SV_HASH_TABLE       0x03 hash table of WRValues
@@ -749,6 +950,10 @@ enum WRGCFlags
 	GCFlag_NoContext = 1<<0,
 	GCFlag_Marked = 1<<1,
 	GCFlag_Perm = 1<<2,
+	GCFlag_Old = 1<<3, // promoted out of the nursery
+	GCFlag_Remembered = 1<<4, // in its context's remembered set
+	GCFlag_Pooled = 1<<5, // allocated from WRState::pool
+	GCFlag_InlineData = 1<<6, // payload shares the pool block
 };
 
 //------------------------------------------------------------------------------
@@ -757,10 +962,15 @@ enum WRGCObjectType
 	SV_VOID_HASH_TABLE = 0x0, // must be zero so memset(0) defaults to it
 	SV_HASH_TABLE = 0x01,
 	SV_HASH_ENTRY = 0x02,
-	SV_HASH_INTERNAL = 0x03,
+	SV_HASH_INTERNAL = 0x03, // unused, hash storage is not a gc object
 	
-	SV_VALUE = 0x04, // !!must ALWAYS be last two so >= works
+	SV_VALUE = 0x04, // !!flat arrays must ALWAYS be last so >= works
 	SV_CHAR = 0x05,  // !!
+
+	// packed numeric arrays, elements are stored unboxed
+	SV_INT32 = 0x06,
+	SV_FLOAT32 = 0x07,
+	SV_UINT8 = 0x08,
 };
 
 #ifdef ARDUINO
@@ -775,8 +985,18 @@ enum WRGCObjectType
   #error "Endian-ness not detected! Please contact curt.hartung@gmail.com so it can be added <01>"
 #endif
 
+#ifndef WR_THREAD_LOCAL
+#if defined(_MSC_VER)
+#define WR_THREAD_LOCAL __declspec(thread)
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__linux__) || defined(__APPLE__) || defined(_WIN32) || defined(__FreeBSD__))
+#define WR_THREAD_LOCAL __thread
+#else
+#define WR_THREAD_LOCAL
+#endif
+#endif
+
 #ifdef WRENCH_HANDLE_MALLOC_FAIL
-extern bool g_mallocFailed; // used as an internal global flag for when a malloc came back null
+extern WR_THREAD_LOCAL bool g_mallocFailed; // used as an internal per-thread flag for when a malloc came back null
 #endif
 
 extern WR_ALLOC g_malloc;
@@ -990,7 +1210,7 @@ public:
 
 	union
 	{
-		uint16_t m_mod;
+		uint16_t m_mod; // struct: size of its hash table in the bytecode
 		uint16_t m_hashItem;
 	};
 
@@ -999,19 +1219,16 @@ public:
 		void* m_data;
 		char* m_SCdata;
 		unsigned char* m_Cdata;
+		int32_t* m_Idata;
+		float* m_Fdata;
 		WRValue* m_Vdata;
 		WRGCBase* m_referencedTable;
 	};
 
 	WRGCBase* m_nextGC;
 
-	void clear()
-	{
-		if ( m_type >= SV_VALUE )
-		{
-			g_free( m_Cdata );
-		}
-	}
+	inline void clear();
+	inline void freeData( void* data );
 };
 
 //------------------------------------------------------------------------------
@@ -1056,30 +1273,59 @@ private:
 //------------------------------------------------------------------------------
 // Helper class to schedule and run tasks
 struct WrenchScheduledTask;
+struct WrenchSchedulerWorker;
+struct WrenchSchedulerSync;
 
 class WrenchScheduler
 {
 public:
-	WrenchScheduler( const int stackSizePerThread = WRENCH_DEFAULT_STACK_SIZE );
+	// workers: how many threads (each with its own state) to run tasks
+	// on, 0 for one per core. Always 1 without WRENCH_THREADED_SCHEDULER
+	WrenchScheduler( const int stackSizePerThread = WRENCH_DEFAULT_STACK_SIZE, const int workers =1 );
 	~WrenchScheduler();
 
-	WRState* state() const { return m_w; }
+	// functions and libraries must be registered on every worker's state
+	WRState* state( const int worker =0 ) const;
+	int workers() const { return m_workerCount; }
 
+	// give every task one slice, higher priority tasks go first
 	void tick( const int instructionsPerSlice =1000 );
 
 	// returns a task ID
 	int addThread( const uint8_t* byteCode, const int size, const int instructionsThisSlice =1000, const bool takeOwnership =false );
 	bool removeTask( const int taskId );
 
+	// higher priority tasks run first each tick, and are the last to be
+	// stolen by an idle worker (default 0)
+	bool setTaskPriority( const int taskId, const int priority );
+
+	// instructions this task gets per slice, overrides the value passed
+	// to tick(), 0 to go back to it
+	bool setTaskBudget( const int taskId, const int instructionsPerSlice );
+
+	int tasks() const { return m_taskCount; }
+
 	int lastErr() const { return m_lastErr; }       // WRError of last faulted task, 0 if none
 	int lastErrTaskId() const { return m_lastErrId; } // id of the task that faulted
 	void clearErr() { m_lastErr = 0; m_lastErrId = 0; }
 
 private:
-	WRState* m_w;
+	WrenchScheduledTask* findTask( const int taskId ) const;
+	void runQueue( WrenchSchedulerWorker* worker );
+	WrenchScheduledTask* steal( WrenchSchedulerWorker* thief );
+#ifdef WRENCH_THREADED_SCHEDULER
+	static void* workerThread( void* arg );
+	WrenchSchedulerSync* m_sync;
+#endif
+
+	WrenchSchedulerWorker* m_workers;
+	int m_workerCount;
 	WrenchScheduledTask* m_tasks;
+	int m_taskCount;
+	int m_instructionsPerSlice; // of the tick in progress
 	int m_lastErr;
 	int m_lastErrId;
+	int m_idGenerator;
 };
 #endif
 
@@ -1088,7 +1334,14 @@ class WRGCObject : public WRGCBase
 {
 public:
 
+	// hash tables: entries never move once added, so an entry index
+	// stays valid until its key is removed. m_Vdata holds [value, key]
+	// per entry (just the value for SV_VOID_HASH_TABLE), m_hashTable the
+	// key hash of each entry (WRENCH_NULL_HASH if free) followed by
+	// m_capacity*2 Robin Hood slots of [entry+1 (0 if empty), hash]
 	uint32_t m_size;
+	uint32_t m_capacity; // SV_VALUE/SV_CHAR: elements allocated from m_data, >= m_size
+	uint32_t m_head; // SV_VALUE: elements reserved in front of m_data (push/pop front), hash: first free entry+1
 	union
 	{
 		uint32_t* m_hashTable;
@@ -1104,15 +1357,101 @@ public:
 	
 	void* get( const uint32_t l, int* index =0 );
 	
-	uint32_t growHash( const uint32_t hash, const uint16_t sizeHint =0, int* sizeAllocated =0 );
-	uint32_t getIndexOfHit( const uint32_t hash, const bool inserting );
+	int growHash( const uint32_t capacity );
+	uint32_t getIndexOfHit( const uint32_t hash );
 
 private:
 
+	uint32_t* findSlot( const uint32_t hash );
+	void addSlot( uint32_t s, uint32_t distance, uint32_t carry, uint32_t hash );
+
 	WRGCObject& operator= ( WRGCObject& A );
 	WRGCObject(WRGCObject& A);
 };
 
+//------------------------------------------------------------------------------
+inline void WRGCBase::clear()
+{
+	if ( m_type >= SV_VALUE )
+	{
+		// value arrays may have room reserved in front of the data
+		freeData( ((WRGCObject*)this)->m_Vdata - ((WRGCObject*)this)->m_head );
+	}
+	else if ( m_type <= SV_HASH_TABLE && m_Vdata )
+	{
+		g_free( m_Vdata ); // values, hashes and slots are one block
+	}
+}
+
+//------------------------------------------------------------------------------
+// release an array payload that is being replaced or discarded
+inline void WRGCBase::freeData( void* data )
+{
+#ifdef WRENCH_POOL_ALLOCATOR
+	if ( m_flags & GCFlag_InlineData )
+	{
+		// lives in the header's pool block, which goes back with the header
+		m_flags &= ~GCFlag_InlineData;
+		return;
+	}
+#endif
+	g_free( data );
+}
+
+#ifdef WRENCH_GENERATIONAL_GC
+// anything that hands out a reference into container B (so it can be
+// written through) must call this first
+#define WR_GC_REMEMBER( C, B ) { if ( ((B)->m_flags & (GCFlag_Old | GCFlag_Remembered)) == GCFlag_Old ) { (C)->remember( (B) ); } }
+#else
+#define WR_GC_REMEMBER( C, B )
+#endif
+
+#ifndef WRENCH_CALL_SITE_CACHE
+#if defined(WRENCH_COMPACT) || defined(WRENCH_REALLY_COMPACT)
+#define WRENCH_CALL_SITE_CACHE 0
+#else
+#define WRENCH_CALL_SITE_CACHE 16
+#endif
+#endif
+
+#ifndef WRENCH_MEMBER_CACHE
+#if defined(WRENCH_COMPACT) || defined(WRENCH_REALLY_COMPACT)
+#define WRENCH_MEMBER_CACHE 0
+#else
+#define WRENCH_MEMBER_CACHE 16
+#endif
+#endif
+
+#if WRENCH_CALL_SITE_CACHE
+//------------------------------------------------------------------------------
+// resolved target of a CallFunctionByHash[AndPop], only valid while
+// 'generation' matches WRState::callSiteGeneration
+struct WRCallSiteCache
+{
+	uint32_t offset; // of the call site from context->bottom
+	uint32_t generation;
+	WR_C_CALLBACK ccb; // native target, or null for an imported function
+	union
+	{
+		void* usr;
+		WRContext* import;
+	};
+	WRFunction* wrf;
+};
+#endif
+
+#if WRENCH_MEMBER_CACHE
+//------------------------------------------------------------------------------
+// last struct layout seen by a LocalIndexHash/GlobalIndexHash/StackIndexHash,
+// identified by its hash table in the bytecode
+struct WRMemberCache
+{
+	const uint8_t* table;
+	uint32_t offset; // of the site from context->bottom
+	uint32_t member; // index into the struct's values
+};
+#endif
+
 //------------------------------------------------------------------------------
 struct WRContext
 {
@@ -1149,7 +1488,7 @@ struct WRContext
 	uint16_t stackOffset;
 
 	WRFunction* localFunctions;
-	uint8_t numLocalFunctions;
+	uint16_t numLocalFunctions;
 
 	uint8_t flags;
 
@@ -1157,15 +1496,62 @@ struct WRContext
 
 	WRContext* nextStateContextLink;
 
+#ifdef WRENCH_LINUX_FILE_IO
+	WRMappedFile* mapped; // 'bottom' is this mapping, see wr_newContextMapped()
+#endif
+
+#if WRENCH_CALL_SITE_CACHE
+	WRCallSiteCache callSiteCache[ WRENCH_CALL_SITE_CACHE ];
+#endif
+
+#if WRENCH_MEMBER_CACHE
+	WRMemberCache memberCache[ WRENCH_MEMBER_CACHE ];
+#endif
+
+#ifdef WRENCH_QUICKENING
+	const void** threaded; // handler address for each byte of 'bottom', built on first run
+#endif
+
+#ifdef WRENCH_GENERATIONAL_GC
+	WRGCBase* svOld; // promoted objects, svAllocated is the nursery
+	WRGCBase** remembered; // old containers that may point into the nursery
+	uint32_t rememberedCount;
+	uint32_t rememberedSize;
+	uint32_t gcOldObjects; // survivors of the last full collection
+	uint32_t gcPromoted; // promoted since then
+	int8_t gcSkipFlags; // mark() stops at these
+
+	void remember( WRGCBase* svb );
+	void markContents( WRGCBase* svb );
+	bool stackHoldsInteriorRefs( WRValue* stackTop );
+	void minorGC( WRValue* stackTop );
+#endif
+
 	void markBase( WRGCBase* svb );
 	void mark( WRValue* s );
 	void gc( WRValue* stackTop );
+	void freeObject( WRGCBase* svb );
 
 	WRGCObject* getSVA( int size, WRGCObjectType type, bool init );
 };
 
 struct WRLibraryCleanup;
 
+#ifdef WRENCH_POOL_ALLOCATOR
+#define WRENCH_POOL_CLASSES 6
+//------------------------------------------------------------------------------
+struct WRPool
+{
+	void* freeList[ WRENCH_POOL_CLASSES ];
+	void* slabs; // chained through their first word
+	bool enabled;
+};
+
+void* wr_poolAlloc( WRState* w, const unsigned int bytes );
+void wr_poolFree( WRState* w, void* mem );
+void wr_destroyPool( WRState* w );
+#endif
+
 //------------------------------------------------------------------------------
 struct WRState
 {
@@ -1184,9 +1570,29 @@ struct WRState
 
 	void* ctx; // state-wide context pointer, opaque to wrench
 
+#if WRENCH_CALL_SITE_CACHE
+	uint32_t callSiteGeneration; // bumped whenever the set of callable functions changes
+#endif
+
 	uint32_t allocatedMemoryLimit; // WRENCH_DEFAULT_ALLOCATED_MEMORY_GC_HINT by default
+	int32_t randomSeed; // math::rand() state
 	uint16_t stackSize; // how much stack to give each context
 	uint8_t err;
+#ifdef WRENCH_GENERATIONAL_GC
+	uint8_t gcMode; // WRGCMode
+#endif
+
+#ifdef WRENCH_LINUX_FILE_IO
+	WRMappedFile* mappedFiles; // see wr_newContextMapped()
+#endif
+
+#ifdef WRENCH_POOL_ALLOCATOR
+	WRPool pool;
+#endif
+
+#ifdef WRENCH_OPCODE_PROFILE
+	WROpcodeProfile* opcodeProfile;
+#endif
 
 };
 
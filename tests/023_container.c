@@ -59,3 +59,42 @@ if ( r[2] != 50 ) println("array14" + r[2] );
 array::remove( r, 0, 100 ); // remove it all
 if ( array::count(r) != 0 ) println("array15" + array::count(r) );
 
+
+var g[];
+array::reserve( g, 100 );
+if ( g._count != 0 ) println("array16 " + g._count );
+for( var n=0; n<1000; ++n ) { g[g._count] = n; }
+if ( g._count != 1000 ) println("array17 " + g._count );
+if ( g[999] != 999 || g[500] != 500 ) println("array18");
+array::truncate( g, 10 );
+g[12] = 1; // slots exposed again must not resurrect old values
+if ( g[10] != 0 || g[11] != 0 || g[12] != 1 ) println("array19");
+
+var s[];
+for( var n=0; n<100; ++n ) { list::push_back( s, n ); }
+if ( s._count != 100 || s[0] != 0 || s[99] != 99 ) println("array20");
+
+var q[];
+for( var n=0; n<1000; ++n ) { queue::push( q, n ); }
+for( var n=0; n<500; ++n ) { if ( queue::pop(q) != n ) println("queue1 " + n); }
+for( var n=1000; n<1500; ++n ) { queue::push( q, n ); }
+if ( queue::count(q) != 1000 ) println("queue2 " + queue::count(q) );
+if ( queue::peek(q) != 500 ) println("queue3");
+for( var n=500; n<1500; ++n ) { if ( queue::pop(q) != n ) println("queue4 " + n); }
+if ( queue::count(q) != 0 ) println("queue5");
+
+var st[];
+for( var n=0; n<300; ++n ) { stack::push( st, "s" + n ); }
+if ( stack::peek(st) != "s299" ) println("stack1");
+for( var n=299; n>=100; --n ) { if ( stack::pop(st) != "s" + n ) println("stack2 " + n); }
+stack::push( st, 7 );
+if ( st[0] != 7 || st[1] != "s99" || st._count != 101 ) println("stack3");
+var seen = 0;
+for( v : st ) { ++seen; }
+if ( seen != 101 ) println("stack4");
+
+var lf[];
+for( var n=0; n<200; ++n ) { list::push_back( lf, n ); list::push_front( lf, -n ); }
+if ( lf[0] != -199 || lf[199] != 0 || lf[200] != 0 || lf[399] != 199 ) println("list13");
+for( var n=0; n<150; ++n ) { list::pop_front( lf ); }
+if ( lf[0] != -49 || lf._count != 250 ) println("list14");
@@ -45,3 +45,9 @@ if ( f != -2.5 ) println("ac20");
 
 var m = (int)(-1.9) * 3 + (int)(2.9);
 if ( m != -1 ) println("ac21");
+
+// operands already on the stack that need both moved into place
+var ss[] = { -5, 0 };
+if ( ss[0] != -5 || ss[1] != 0 ) println("ac22");
+var sb = 3;
+if ( ss[0] - -sb + 4 * -sb != -14 ) println("ac23");
@@ -0,0 +1,82 @@
+/*~ ~*/
+
+// long lived containers written to with freshly allocated values, the
+// new values must survive every collection that comes after
+
+struct Node
+{
+	var name;
+	var next;
+};
+
+var rows[];
+var names = { "count":300 };
+var head = new Node;
+head.name = "head";
+
+for( var i=0; i<300; ++i )
+{
+	rows[i] = "row" + i;
+	names[i] = "name" + i;
+
+	var n = new Node;
+	n.name = "node" + i;
+	n.next = head.next;
+	head.next = n;
+}
+
+// overwrite half of them after they have all had a chance to be promoted
+for( var j=0; j<300; j += 2 )
+{
+	rows[j] = "again" + j;
+	names["k" + j] = "key" + j;
+}
+
+for( var k=0; k<300; ++k )
+{
+	if ( (k & 1) && rows[k] != ("row" + k) ) println("gen1 " + k);
+	if ( !(k & 1) && rows[k] != ("again" + k) ) println("gen2 " + k);
+	if ( names[k] != ("name" + k) ) println("gen3 " + k);
+	if ( !(k & 1) && names["k" + k] != ("key" + k) ) println("gen4 " + k);
+}
+
+var count = 0;
+var walk = head.next;
+while( walk )
+{
+	if ( walk.name != ("node" + (299 - count)) ) println("gen5 " + count);
+	walk = walk.next;
+	++count;
+}
+if ( count != 300 ) println("gen6 " + count);
+
+// writes through foreach refs into an old container
+var grid[];
+for( var g=0; g<50; ++g )
+{
+	grid[g][0] = g;
+}
+
+for( var cell : grid )
+{
+	cell[1] = "cell" + cell[0];
+}
+
+for( var c : grid )
+{
+	if ( c[1] != ("cell" + c[0]) ) println("gen7 " + c[0]);
+}
+
+// container library writes
+var q[];
+for( var p=0; p<100; ++p )
+{
+	list::push( q, "q" + p );
+	list::push_back( rows, "tail" + p );
+}
+
+for( var t=0; t<100; ++t )
+{
+	if ( q[99 - t] != ("q" + t) ) println("gen8 " + t);
+	if ( rows[300 + t] != ("tail" + t) ) println("gen9 " + t);
+}
@@ -0,0 +1,97 @@
+/*~ ~*/
+
+// tables that grow well past their first allocation, with keys removed
+// and put back along the way
+
+var h = {:};
+for( var i=0; i<5000; ++i )
+{
+	h[i] = "v" + i;
+}
+if ( hash::count(h) != 5000 ) println("h0 " + hash::count(h));
+
+for( var j=0; j<5000; ++j )
+{
+	if ( h[j] != ("v" + j) ) println("h1 " + j);
+}
+
+// int keys are their own hash, these all share their low bits
+var stride = {:};
+for( var s=0; s<2000; ++s )
+{
+	stride[s * 65536] = s;
+}
+for( var s2=0; s2<2000; ++s2 )
+{
+	if ( stride[s2 * 65536] != s2 ) println("h2 " + s2);
+}
+if ( hash::count(stride) != 2000 ) println("h3");
+
+// remove every other key, the rest must all still be found
+for( var r=0; r<5000; r += 2 )
+{
+	if ( !hash::exists(h, r) ) println("h4 " + r);
+	hash::remove( h, r );
+	if ( hash::exists(h, r) ) println("h5 " + r);
+}
+if ( hash::count(h) != 2500 ) println("h6 " + hash::count(h));
+for( var k=1; k<5000; k += 2 )
+{
+	if ( h[k] != ("v" + k) ) println("h7 " + k);
+}
+
+// removed keys come back empty, and reuse the freed entries
+for( var p=0; p<5000; p += 2 )
+{
+	if ( h[p] ) println("h8 " + p);
+	h[p] = p;
+}
+if ( hash::count(h) != 5000 ) println("h9 " + hash::count(h));
+
+var sum = 0;
+var seen = 0;
+var key;
+var val;
+for( key, val : h )
+{
+	if ( key & 1 )
+	{
+		if ( val != ("v" + key) ) println("h10 " + key);
+	}
+	else
+	{
+		sum += val;
+	}
+	++seen;
+}
+if ( seen != 5000 ) println("h11 " + seen);
+if ( sum != 6247500 ) println("h12 " + sum);
+
+// a member held while the table grows underneath it
+var g = {:};
+g["first"] = 1;
+g["a"] = ( g["b"] = ( g["c"] = ( g["d"] = 4 ) ) );
+if ( g["a"] != 4 || g["b"] != 4 || g["c"] != 4 || g["d"] != 4 ) println("h13");
+
+function fill( t, n )
+{
+	for( var f=0; f<n; ++f )
+	{
+		t["fill" + f] = f;
+	}
+	return n;
+}
+g["held"] = fill( g, 500 );
+if ( g["held"] != 500 || g["fill499"] != 499 ) println("h14");
+
+// churn, never more than a few live keys
+var q = {:};
+for( var c=0; c<20000; ++c )
+{
+	q[c] = c;
+	if ( c >= 4 )
+	{
+		hash::remove( q, c - 4 );
+	}
+}
+if ( hash::count(q) != 4 || q[19999] != 19999 || hash::exists(q, 19995) ) println("h15");
@@ -0,0 +1,96 @@
+/*~ ~*/
+
+// the same instructions run over and over with operands that change
+// type underneath them, results must not depend on what ran before
+
+function sum( a, b )
+{
+	var t = 0;
+	for( var i=0; i<10; ++i )
+	{
+		t = t + a * b - b / a;
+	}
+	return t;
+}
+
+function less( a, b )
+{
+	if ( a < b ) return 1;
+	if ( a == b ) return 2;
+	return 3;
+}
+
+function step( v )
+{
+	++v;
+	++v;
+	--v;
+	return v;
+}
+
+for( var r=0; r<3; ++r )
+{
+	if ( sum(2, 3) != 50 ) println("m1 " + r);
+	if ( sum(2.0, 3.0) != 45 ) println("m2 " + r);
+	if ( sum(2, 3.0) != 45 ) println("m3 " + r);
+	if ( sum(2.0, 3) != 45 ) println("m4 " + r);
+	if ( sum(4, 3) != 120 ) println("m5 " + r);
+
+	if ( less(1, 2) != 1 || less(2, 2) != 2 || less(3, 2) != 3 ) println("m6 " + r);
+	if ( less(1.5, 2.5) != 1 || less(2.5, 2.5) != 2 || less(3.5, 2.5) != 3 ) println("m7 " + r);
+	if ( less(1, 2.5) != 1 || less(2.5, 2) != 3 ) println("m8 " + r);
+
+	if ( step(1) != 2 || step(1.5) != 2.5 ) println("m10 " + r);
+}
+
+// division by zero in the middle of a run of good divisions
+function divide( n, scale )
+{
+	var q = 0;
+	for( var d=-3; d<=3; ++d )
+	{
+		var divisor = d * scale;
+		q += n / divisor;
+	}
+	return q;
+}
+if ( divide(12, 1) != 0 ) println("m11");
+if ( divide(3.0, 1.0) != 0 ) println("m12");
+
+// a local that starts as an int and becomes a float part way through
+function drift()
+{
+	var x = 0;
+	var hits = 0;
+	for( var k=0; k<20; ++k )
+	{
+		if ( k == 10 ) x = 10.5;
+		++x;
+		if ( x > 15 ) ++hits;
+	}
+	return x + hits;
+}
+if ( drift() != 26.5 ) println("m13");
+
+// array elements are references, never the int/float fast path
+function elements()
+{
+	var arr[] = { 1, 2, 3 };
+	var acc = 0;
+	for( var e=0; e<3; ++e )
+	{
+		acc += arr[e] % 2;
+		acc += arr[e] * 2;
+	}
+	return acc;
+}
+if ( elements() != 14 ) println("m14 " + elements());
+
+// string concatenation through the same addition that saw ints
+function cat( a, b ) { return a + b; }
+for( var c=0; c<4; ++c )
+{
+	if ( cat(1, 2) != 3 ) println("m15");
+	if ( cat("1", "2") != "12" ) println("m16");
+	if ( cat(1.5, 1.5) != 3 ) println("m17");
+}
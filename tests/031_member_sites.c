@@ -0,0 +1,52 @@
+/*~ ~*/
+
+// member access sites that see more than one struct layout
+
+struct A { var x; var y; var z; };
+struct B { var z; var extra; var y; var x; };
+struct Outer { var inner; var n; };
+
+function sum( p )
+{
+	return p.x * 100 + p.y * 10 + p.z;
+}
+
+function bump( p )
+{
+	p.x += 1;
+	p.z = p.x + p.y;
+}
+
+var a = new A { x = 1, y = 2, z = 3 };
+var b = new B { x = 4, y = 5, z = 6, extra = 9 };
+var h = { "x":7, "y":8, "z":9 };
+
+for( var r=0; r<3; ++r )
+{
+	if ( sum(a) != 123 ) println("s1 " + r);
+	if ( sum(b) != 456 ) println("s2 " + r);
+	if ( sum(h) != 789 ) println("s3 " + r);
+	if ( sum(a) != 123 ) println("s4 " + r);
+}
+
+bump( a );
+bump( b );
+bump( a );
+if ( a.x != 3 || a.y != 2 || a.z != 5 ) println("s5");
+if ( b.x != 5 || b.y != 5 || b.z != 10 || b.extra != 9 ) println("s6");
+
+// the same site reached through a global, and through another struct
+var o = new Outer { n = 2 };
+o.inner = new B { x = 1, y = 1, z = 1 };
+for( var i=0; i<4; ++i )
+{
+	o.inner.x += o.n;
+	if ( i == 1 ) o.inner = new A { x = 0, y = 0, z = 0 };
+}
+if ( o.inner.x != 4 || o.inner.z != 0 ) println("s7");
+
+// a member one struct has and the other does not
+function extra( p ) { return p.extra; }
+if ( extra(b) != 9 ) println("s8");
+if ( extra(a) != 0 ) println("s9");
+if ( extra(b) != 9 ) println("s10");
@@ -0,0 +1,67 @@
+/*~ ~*/
+
+// elements past the old 2M index limit and iteration past 64k
+
+var a[];
+a[5] = 3;
+a[3000000] = 9;
+if ( a._count != 3000001 ) println("l0 " + a._count);
+if ( a[3000000] != 9 ) println("l1");
+if ( a[3000000 - 2097152] != 0 ) println("l2"); // must not alias a lower slot
+if ( a[5] != 3 ) println("l3");
+
+var seen = 0;
+var sum = 0;
+var v;
+for( v : a )
+{
+	sum += v;
+	++seen;
+}
+if ( seen != 3000001 ) println("l4 " + seen);
+if ( sum != 12 ) println("l5 " + sum);
+
+var last = -1;
+for( var k, v : a )
+{
+	if ( v == 9 ) last = k;
+}
+if ( last != 3000000 ) println("l6 " + last);
+
+a = 0;
+
+// char arrays the same
+var c = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+while( c._count < 3000000 )
+{
+	c = c + c;
+}
+if ( c._count != 3407872 ) println("l7 " + c._count);
+if ( c[3407871] != 'Z' ) println("l8");
+if ( c[3000000] != 'A' + (3000000 % 26) ) println("l9");
+seen = 0;
+for( v : c )
+{
+	++seen;
+}
+if ( seen != c._count ) println("l10 " + seen);
+c = 0;
+
+// serialized sizes past 16 bits
+var b[];
+for( var i=0; i<70000; ++i )
+{
+	b[i] = i;
+}
+var b1 = std::deserialize( std::serialize(b) );
+if ( b1._count != 70000 ) println("l11 " + b1._count);
+if ( b1[69999] != 69999 || b1[65536] != 65536 ) println("l12");
+
+var s = "0123456789";
+while( s._count < 70000 )
+{
+	s = s + s;
+}
+var s1 = std::deserialize( std::serialize(s) );
+if ( s1._count != s._count ) println("l13 " + s1._count);
+if ( s1 != s ) println("l14");
@@ -0,0 +1,83 @@
+/*~ ~*/
+
+// packed arrays index, grow, iterate and operate like any other array
+
+var f = vec::float32( 10 );
+if ( f._count != 10 ) println("t0");
+for( var i=0; i<10; ++i )
+{
+	f[i] = i * 1.5;
+}
+if ( f[3] != 4.5 ) println("t1");
+f[12] = 2.5;
+if ( f._count != 13 || f[12] != 2.5 || f[11] != 0 ) println("t2");
+f[11] += 1.25;
+if ( f[11] != 1.25 ) println("t3");
+
+var t = 0;
+var v;
+for( v : f )
+{
+	t += v;
+}
+if ( t != 71.25 ) println("t4 " + t);
+if ( vec::sum(f) != 71.25 ) println("t5");
+if ( vec::max(f) != 13.5 || vec::min(f) != 0 ) println("t6");
+
+// ints stay ints, floats assigned in are truncated
+var g = vec::int32( { 1, 2, 3, 4, 5 } );
+if ( g._count != 5 || vec::sum(g) != 15 ) println("t7");
+g[0] = 7.9;
+if ( g[0] != 7 ) println("t8");
+++g[1];
+g[2] *= 3;
+if ( g[1] != 3 || g[2] != 9 || g[4]-- != 5 || g[4] != 4 ) println("t9");
+vec::add( g, 10 );
+if ( g[0] != 17 || g[4] != 14 ) println("t10");
+vec::mul( g, g );
+if ( g[1] != 169 ) println("t11");
+
+// uint8 wraps like the C type
+var u = vec::uint8( 4 );
+u[0] = 300;
+u[1] = -1;
+if ( u[0] != 44 || u[1] != 255 ) println("t12");
+vec::clamp( u, 10, 100 );
+if ( u[0] != 44 || u[1] != 100 || u[2] != 10 ) println("t13");
+
+// kernels across the vector width and its tail
+var a = vec::float32( 1003 );
+var b = vec::float32( 1003 );
+for( var i=0; i<1003; ++i )
+{
+	a[i] = i;
+	b[i] = 2;
+}
+if ( vec::sum(a) != 502503 ) println("t14");
+if ( vec::dot(a, b) != 1005006 ) println("t15");
+if ( vec::max(a) != 1002 || vec::min(a) != 0 ) println("t16");
+vec::scale( a, 0.5, 1 );
+if ( a[1002] != 502 || a[0] != 1 ) println("t17");
+vec::add( a, b );
+if ( a[1002] != 504 ) println("t18");
+vec::clamp( a, 10, 20 );
+if ( a[0] != 10 || a[1002] != 20 || a[30] != 18 ) println("t19");
+
+// mixed with plain arrays and other packed types
+var p[] = { 1, 2.5, 3 };
+vec::add( p, vec::int32({ 1, 1, 1 }) );
+if ( p[0] != 2 || p[1] != 3.5 || p[2] != 4 ) println("t20");
+if ( vec::dot(vec::float32({ 1, 2, 3 }), { 4, 5, 6 }) != 32 ) println("t21");
+var c = vec::float32( g );
+if ( c[1] != 169 ) println("t22");
+
+// round trip
+var s = std::deserialize( std::serialize(f) );
+if ( s._count != 13 || s[3] != 4.5 || s[11] != 1.25 ) println("t23");
+s = std::deserialize( std::serialize(g) );
+if ( s[1] != 169 ) println("t24");
+
+// strings are char arrays and can be written the same way
+var str = "abc";
+str[1] = 'X';
+if ( str != "aXc" ) println("t25");
@@ -0,0 +1,432 @@
+/*~ ~*/
+
+// switches whose cases are a tight run that does not start at 0
+// take a direct rebased table, anything else still hashes
+
+// 64 message ids starting at 1000, like a protocol dispatcher
+function message( id )
+{
+	switch( id )
+	{
+		case 1000: return 1;
+		case 1001: return 4;
+		case 1002: return 7;
+		case 1003: return 10;
+		case 1004: return 13;
+		case 1005: return 16;
+		case 1006: return 19;
+		case 1007: return 22;
+		case 1008: return 25;
+		case 1009: return 28;
+		case 1010: return 31;
+		case 1011: return 34;
+		case 1012: return 37;
+		case 1013: return 40;
+		case 1014: return 43;
+		case 1015: return 46;
+		case 1016: return 49;
+		case 1017: return 52;
+		case 1018: return 55;
+		case 1019: return 58;
+		case 1020: return 61;
+		case 1021: return 64;
+		case 1022: return 67;
+		case 1023: return 70;
+		case 1024: return 73;
+		case 1025: return 76;
+		case 1026: return 79;
+		case 1027: return 82;
+		case 1028: return 85;
+		case 1029: return 88;
+		case 1030: return 91;
+		case 1031: return 94;
+		case 1032: return 97;
+		case 1033: return 100;
+		case 1034: return 103;
+		case 1035: return 106;
+		case 1036: return 109;
+		case 1037: return 112;
+		case 1038: return 115;
+		case 1039: return 118;
+		case 1040: return 121;
+		case 1041: return 124;
+		case 1042: return 127;
+		case 1043: return 130;
+		case 1044: return 133;
+		case 1045: return 136;
+		case 1046: return 139;
+		case 1047: return 142;
+		case 1048: return 145;
+		case 1049: return 148;
+		case 1050: return 151;
+		case 1051: return 154;
+		case 1052: return 157;
+		case 1053: return 160;
+		case 1054: return 163;
+		case 1055: return 166;
+		case 1056: return 169;
+		case 1057: return 172;
+		case 1058: return 175;
+		case 1059: return 178;
+		case 1060: return 181;
+		case 1061: return 184;
+		case 1062: return 187;
+		case 1063: return 190;
+		default: return -1;
+	}
+}
+
+var total = 0;
+for( var i=1000; i<1064; ++i )
+{
+	if ( message(i) != (i - 1000)*3 + 1 ) println("d0 " + i);
+}
+if ( message(999) != -1 ) println("d1");
+if ( message(1064) != -1 ) println("d2");
+if ( message(0) != -1 ) println("d3");
+if ( message(-1000) != -1 ) println("d4");
+if ( message("x") != -1 ) println("d5");
+
+// negative labels with holes, fallthrough and no default
+function signs( v )
+{
+	var r = 0;
+	switch( v )
+	{
+		case -6: r += 100;
+		case -5: r += 10; break;
+		case -3: r = 3; break;
+		case -1:
+		case 0:
+		case 1: r = 7; break;
+		case 4: r = 44;
+	}
+	return r;
+}
+if ( signs(-6) != 110 ) println("d6");
+if ( signs(-5) != 10 ) println("d7");
+if ( signs(-4) != 0 ) println("d8");
+if ( signs(-3) != 3 ) println("d9");
+if ( signs(-1) != 7 || signs(0) != 7 || signs(1) != 7 ) println("d10");
+if ( signs(2) != 0 || signs(3) != 0 ) println("d11");
+if ( signs(4) != 44 ) println("d12");
+if ( signs(5) != 0 || signs(-7) != 0 || signs(1000000) != 0 ) println("d13");
+
+// more cases than the small linear table can hold
+function wide( v )
+{
+	switch( v )
+	{
+		case 0: return 1;
+		case 1: return 2;
+		case 2: return 3;
+		case 4: return 5;
+		case 5: return 6;
+		case 6: return 7;
+		case 7: return 8;
+		case 8: return 9;
+		case 9: return 10;
+		case 11: return 12;
+		case 12: return 13;
+		case 13: return 14;
+		case 14: return 15;
+		case 15: return 16;
+		case 16: return 17;
+		case 18: return 19;
+		case 19: return 20;
+		case 20: return 21;
+		case 21: return 22;
+		case 22: return 23;
+		case 23: return 24;
+		case 25: return 26;
+		case 26: return 27;
+		case 27: return 28;
+		case 28: return 29;
+		case 29: return 30;
+		case 30: return 31;
+		case 32: return 33;
+		case 33: return 34;
+		case 34: return 35;
+		case 35: return 36;
+		case 36: return 37;
+		case 37: return 38;
+		case 39: return 40;
+		case 40: return 41;
+		case 41: return 42;
+		case 42: return 43;
+		case 43: return 44;
+		case 44: return 45;
+		case 46: return 47;
+		case 47: return 48;
+		case 48: return 49;
+		case 49: return 50;
+		case 50: return 51;
+		case 51: return 52;
+		case 53: return 54;
+		case 54: return 55;
+		case 55: return 56;
+		case 56: return 57;
+		case 57: return 58;
+		case 58: return 59;
+		case 60: return 61;
+		case 61: return 62;
+		case 62: return 63;
+		case 63: return 64;
+		case 64: return 65;
+		case 65: return 66;
+		case 67: return 68;
+		case 68: return 69;
+		case 69: return 70;
+		case 70: return 71;
+		case 71: return 72;
+		case 72: return 73;
+		case 74: return 75;
+		case 75: return 76;
+		case 76: return 77;
+		case 77: return 78;
+		case 78: return 79;
+		case 79: return 80;
+		case 81: return 82;
+		case 82: return 83;
+		case 83: return 84;
+		case 84: return 85;
+		case 85: return 86;
+		case 86: return 87;
+		case 88: return 89;
+		case 89: return 90;
+		case 90: return 91;
+		case 91: return 92;
+		case 92: return 93;
+		case 93: return 94;
+		case 95: return 96;
+		case 96: return 97;
+		case 97: return 98;
+		case 98: return 99;
+		case 99: return 100;
+		case 100: return 101;
+		case 102: return 103;
+		case 103: return 104;
+		case 104: return 105;
+		case 105: return 106;
+		case 106: return 107;
+		case 107: return 108;
+		case 109: return 110;
+		case 110: return 111;
+		case 111: return 112;
+		case 112: return 113;
+		case 113: return 114;
+		case 114: return 115;
+		case 116: return 117;
+		case 117: return 118;
+		case 118: return 119;
+		case 119: return 120;
+		case 120: return 121;
+		case 121: return 122;
+		case 123: return 124;
+		case 124: return 125;
+		case 125: return 126;
+		case 126: return 127;
+		case 127: return 128;
+		case 128: return 129;
+		case 130: return 131;
+		case 131: return 132;
+		case 132: return 133;
+		case 133: return 134;
+		case 134: return 135;
+		case 135: return 136;
+		case 137: return 138;
+		case 138: return 139;
+		case 139: return 140;
+		case 140: return 141;
+		case 141: return 142;
+		case 142: return 143;
+		case 144: return 145;
+		case 145: return 146;
+		case 146: return 147;
+		case 147: return 148;
+		case 148: return 149;
+		case 149: return 150;
+		case 151: return 152;
+		case 152: return 153;
+		case 153: return 154;
+		case 154: return 155;
+		case 155: return 156;
+		case 156: return 157;
+		case 158: return 159;
+		case 159: return 160;
+		case 160: return 161;
+		case 161: return 162;
+		case 162: return 163;
+		case 163: return 164;
+		case 165: return 166;
+		case 166: return 167;
+		case 167: return 168;
+		case 168: return 169;
+		case 169: return 170;
+		case 170: return 171;
+		case 172: return 173;
+		case 173: return 174;
+		case 174: return 175;
+		case 175: return 176;
+		case 176: return 177;
+		case 177: return 178;
+		case 179: return 180;
+		case 180: return 181;
+		case 181: return 182;
+		case 182: return 183;
+		case 183: return 184;
+		case 184: return 185;
+		case 186: return 187;
+		case 187: return 188;
+		case 188: return 189;
+		case 189: return 190;
+		case 190: return 191;
+		case 191: return 192;
+		case 193: return 194;
+		case 194: return 195;
+		case 195: return 196;
+		case 196: return 197;
+		case 197: return 198;
+		case 198: return 199;
+		case 200: return 201;
+		case 201: return 202;
+		case 202: return 203;
+		case 203: return 204;
+		case 204: return 205;
+		case 205: return 206;
+		case 207: return 208;
+		case 208: return 209;
+		case 209: return 210;
+		case 210: return 211;
+		case 211: return 212;
+		case 212: return 213;
+		case 214: return 215;
+		case 215: return 216;
+		case 216: return 217;
+		case 217: return 218;
+		case 218: return 219;
+		case 219: return 220;
+		case 221: return 222;
+		case 222: return 223;
+		case 223: return 224;
+		case 224: return 225;
+		case 225: return 226;
+		case 226: return 227;
+		case 228: return 229;
+		case 229: return 230;
+		case 230: return 231;
+		case 231: return 232;
+		case 232: return 233;
+		case 233: return 234;
+		case 235: return 236;
+		case 236: return 237;
+		case 237: return 238;
+		case 238: return 239;
+		case 239: return 240;
+		case 240: return 241;
+		case 242: return 243;
+		case 243: return 244;
+		case 244: return 245;
+		case 245: return 246;
+		case 246: return 247;
+		case 247: return 248;
+		case 249: return 250;
+		case 250: return 251;
+		case 251: return 252;
+		case 252: return 253;
+		case 253: return 254;
+		case 254: return 255;
+		case 256: return 257;
+		case 257: return 258;
+		case 258: return 259;
+		case 259: return 260;
+		case 260: return 261;
+		case 261: return 262;
+		case 263: return 264;
+		case 264: return 265;
+		case 265: return 266;
+		case 266: return 267;
+		case 267: return 268;
+		case 268: return 269;
+		case 270: return 271;
+		case 271: return 272;
+		case 272: return 273;
+		case 273: return 274;
+		case 274: return 275;
+		case 275: return 276;
+		case 277: return 278;
+		case 278: return 279;
+		case 279: return 280;
+		case 280: return 281;
+		case 281: return 282;
+		case 282: return 283;
+		case 284: return 285;
+		case 285: return 286;
+		case 286: return 287;
+		case 287: return 288;
+		case 288: return 289;
+		case 289: return 290;
+		case 291: return 292;
+		case 292: return 293;
+		case 293: return 294;
+		case 294: return 295;
+		case 295: return 296;
+		case 296: return 297;
+		case 298: return 299;
+		case 299: return 300;
+	}
+	return 0;
+}
+var misses = 0;
+for( var i=-2; i<302; ++i )
+{
+	var expect = i + 1;
+	if ( i < 0 || i >= 300 || (i % 7) == 3 ) expect = 0;
+	if ( wide(i) != expect ) ++misses;
+}
+if ( misses ) println("d14 " + misses);
+
+// a run at the very top of the int range, selectors below the base
+// must not wrap around into the table
+function top( v )
+{
+	switch( v )
+	{
+		case 2147483645: return 1;
+		case 2147483646: return 2;
+		case 2147483647: return 3;
+		default: return 0;
+	}
+}
+if ( top(2147483645) != 1 || top(2147483646) != 2 || top(2147483647) != 3 ) println("d15");
+if ( top(-2147483648) != 0 || top(2147483644) != 0 || top(0) != 0 ) println("d16");
+
+// spread out cases stay hashed
+function sparse( v )
+{
+	switch( v )
+	{
+		case 1: return 1;
+		case 5000: return 2;
+		case 123456: return 3;
+		case -77: return 4;
+		default: return 0;
+	}
+}
+if ( sparse(1) != 1 || sparse(5000) != 2 || sparse(123456) != 3 || sparse(-77) != 4 ) println("d17");
+if ( sparse(2) != 0 || sparse(5001) != 0 ) println("d18");
+
+// default in the middle of a dense run, falls into the next case
+function middle( v )
+{
+	var r = 0;
+	switch( v )
+	{
+		case 500: r = 1; break;
+		default: r = 10;
+		case 502: r += 2; break;
+		case 503: r = 3; break;
+	}
+	return r;
+}
+if ( middle(500) != 1 || middle(501) != 12 || middle(502) != 2 || middle(503) != 3 || middle(9) != 12 ) println("d19");
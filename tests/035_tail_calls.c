@@ -0,0 +1,128 @@
+/*~ ~*/
+
+// return f(...) in tail position reuses the caller's frame, these all
+// recurse far deeper than the test stack (128 entries) could hold
+
+function sum( n, acc )
+{
+	if ( n == 0 )
+	{
+		return acc;
+	}
+	return sum( n - 1, acc + n );
+}
+if ( sum(50000, 0) != 1250025000 ) println("t0");
+
+// mutual recursion
+function isEven( n )
+{
+	if ( n == 0 ) return 1;
+	return isOdd( n - 1 );
+}
+function isOdd( n )
+{
+	if ( n == 0 ) return 0;
+	return isEven( n - 1 );
+}
+if ( isEven(20001) != 0 || isOdd(20001) != 1 ) println("t1");
+
+// arguments that are this frame's own locals, or refer to them, are
+// resolved before the frame is overwritten
+function shuffle( n, a, b )
+{
+	var t = a + b;
+	var list[] = { a, b, t };
+	if ( n == 0 )
+	{
+		return list[2];
+	}
+	return shuffle( n - 1, b, list[0] );
+}
+if ( shuffle(3, 1, 2) != 3 ) println("t2 " + shuffle(3, 1, 2));
+if ( shuffle(1000, 7, 7) != 14 ) println("t3");
+
+function rotate( n, arr )
+{
+	if ( n == 0 )
+	{
+		return arr[0] * 100 + arr[1] * 10 + arr[2];
+	}
+	var next[] = { arr[1], arr[2], arr[0] };
+	return rotate( n - 1, next );
+}
+var digits[] = { 1, 2, 3 };
+if ( rotate(4, digits) != 231 ) println("t4 " + rotate(4, digits));
+if ( rotate(3000, digits) != 123 ) println("t5");
+if ( digits[0] != 1 ) println("t6");
+
+// a global passed through stays a reference
+var g = 5;
+function readLater( n, v )
+{
+	if ( n == 0 ) return v;
+	return readLater( n - 1, v );
+}
+if ( readLater(500, g) != 5 ) println("t7");
+
+// callee needs more locals, and takes different argument counts
+function wideFrame( a, b, c )
+{
+	var x = a + 1;
+	var y = b + 2;
+	var z = c + 3;
+	var w = x + y + z;
+	return w;
+}
+function narrow( n )
+{
+	if ( n > 0 ) return narrow( n - 1, 99, 99 ); // extra args dropped
+	return wideFrame( 1 ); // missing ones are zero
+}
+if ( narrow(400) != 7 ) println("t8 " + narrow(400));
+
+// tail calls from inside loops and switches
+function loopy( n )
+{
+	for( var i=0; i<10; ++i )
+	{
+		if ( i == 3 )
+		{
+			switch( n )
+			{
+				case 0: return 42;
+				default: return loopy( n - 1 );
+			}
+		}
+	}
+	return -1;
+}
+if ( loopy(1000) != 42 ) println("t9");
+
+// a state machine written as continuation style calls
+function close( str, i, depth, maxDepth )
+{
+	return scan( str, i + 1, depth - 1, maxDepth );
+}
+function scan( str, i, depth, maxDepth )
+{
+	if ( i >= str._count ) return maxDepth * 1000 + depth;
+	if ( str[i] == '(' )
+	{
+		if ( depth + 1 > maxDepth ) maxDepth = depth + 1;
+		return scan( str, i + 1, depth + 1, maxDepth );
+	}
+	if ( str[i] == ')' ) return close( str, i, depth, maxDepth );
+	return scan( str, i + 1, depth, maxDepth );
+}
+var text = "";
+for( var p=0; p<200; ++p ) text += "(a";
+for( var p=0; p<200; ++p ) text += ")";
+if ( scan(text, 0, 0, 0) != 200000 ) println("t10 " + scan(text, 0, 0, 0));
+
+// a value used after the call is not a tail call and still works
+function depthCount( n )
+{
+	if ( n == 0 ) return 0;
+	return 1 + depthCount( n - 1 );
+}
+if ( depthCount(10) != 10 ) println("t11");
@@ -0,0 +1,69 @@
+function ints(n)
+{
+	var a[];
+	for( var i=0; i<n; ++i )
+	{
+		a[i] = i;
+	}
+
+	var sum = 0;
+	for( var i=0; i<n; ++i )
+	{
+		sum += a[i];
+	}
+
+	var v;
+	var seen = 0;
+	for( v : a )
+	{
+		sum -= v;
+		++seen;
+	}
+
+	if ( seen != a._count )
+	{
+		return -1;
+	}
+
+	return sum + a[n - 1];
+}
+
+function chars(n)
+{
+	var c = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+	while( c._count < n )
+	{
+		c = c + c;
+	}
+
+	var sum = 0;
+	for( var i=0; i<c._count; ++i )
+	{
+		sum += c[i];
+	}
+
+	var v;
+	var seen = 0;
+	for( v : c )
+	{
+		sum -= v;
+		++seen;
+	}
+
+	if ( seen != c._count )
+	{
+		return -1;
+	}
+
+	return sum + c[c._count - 1];
+}
+
+if ( ints(10000000) != 9999999 )
+{
+	println( "ints failed" );
+}
+
+if ( chars(10000000) != 90 )
+{
+	println( "chars failed" );
+}
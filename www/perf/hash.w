@@ -0,0 +1,45 @@
+function churn(n)
+{
+	var h = {:};
+	for( var i=0; i<n; ++i )
+	{
+		h[i] = i;
+	}
+
+	var found = 0;
+	for( var i=0; i<n; ++i )
+	{
+		if ( h[i] == i )
+		{
+			++found;
+		}
+	}
+
+	for( var i=0; i<n; i += 2 )
+	{
+		hash::remove( h, i );
+	}
+
+	for( var i=0; i<n; ++i )
+	{
+		if ( hash::exists(h, i) )
+		{
+			++found;
+		}
+	}
+
+	return found;
+}
+
+
+for( var i=0; i<200; ++i )
+{
+	churn(1000);
+}
+
+for( var i=0; i<10; ++i )
+{
+	churn(100000);
+}
+
+churn(1000000);
@@ -0,0 +1,101 @@
+// a 64 opcode interpreter, the shape of a protocol state machine or a
+// tiny vm written in wrench. Opcodes are numbered from 0x100 so the
+// switch lowers to the rebased dense table rather than the 0-253
+// linear one, or a hashed switch before it existed
+
+var OP = 0x100;
+
+function run( code, steps )
+{
+	var acc = 0;
+	var pc = 0;
+	var len = code._count;
+	for( var s=0; s<steps; ++s )
+	{
+		switch( code[pc] )
+		{
+			case 0x100: acc += 1; break;
+			case 0x101: acc -= 2; break;
+			case 0x102: acc ^= 7; break;
+			case 0x103: acc = (acc * 3) & 0xFFFF; break;
+			case 0x104: acc = acc >> 1; break;
+			case 0x105: acc = acc + (acc & 5); break;
+			case 0x106: acc |= 64; break;
+			case 0x107: acc &= 0x3FFFF; break;
+			case 0x108: acc += 9; break;
+			case 0x109: acc -= 5; break;
+			case 0x10A: acc ^= 31; break;
+			case 0x10B: acc = (acc * 3) & 0xFFFF; break;
+			case 0x10C: acc = acc >> 1; break;
+			case 0x10D: acc = acc + (acc & 13); break;
+			case 0x10E: acc |= 4; break;
+			case 0x10F: acc &= 0x3FFFF; break;
+			case 0x110: acc += 17; break;
+			case 0x111: acc -= 3; break;
+			case 0x112: acc ^= 55; break;
+			case 0x113: acc = (acc * 3) & 0xFFFF; break;
+			case 0x114: acc = acc >> 1; break;
+			case 0x115: acc = acc + (acc & 21); break;
+			case 0x116: acc |= 1024; break;
+			case 0x117: acc &= 0x3FFFF; break;
+			case 0x118: acc += 25; break;
+			case 0x119: acc -= 1; break;
+			case 0x11A: acc ^= 79; break;
+			case 0x11B: acc = (acc * 3) & 0xFFFF; break;
+			case 0x11C: acc = acc >> 1; break;
+			case 0x11D: acc = acc + (acc & 29); break;
+			case 0x11E: acc |= 64; break;
+			case 0x11F: acc &= 0x3FFFF; break;
+			case 0x120: acc += 33; break;
+			case 0x121: acc -= 4; break;
+			case 0x122: acc ^= 103; break;
+			case 0x123: acc = (acc * 3) & 0xFFFF; break;
+			case 0x124: acc = acc >> 1; break;
+			case 0x125: acc = acc + (acc & 37); break;
+			case 0x126: acc |= 4; break;
+			case 0x127: acc &= 0x3FFFF; break;
+			case 0x128: acc += 41; break;
+			case 0x129: acc -= 2; break;
+			case 0x12A: acc ^= 127; break;
+			case 0x12B: acc = (acc * 3) & 0xFFFF; break;
+			case 0x12C: acc = acc >> 1; break;
+			case 0x12D: acc = acc + (acc & 45); break;
+			case 0x12E: acc |= 1024; break;
+			case 0x12F: acc &= 0x3FFFF; break;
+			case 0x130: acc += 49; break;
+			case 0x131: acc -= 5; break;
+			case 0x132: acc ^= 151; break;
+			case 0x133: acc = (acc * 3) & 0xFFFF; break;
+			case 0x134: acc = acc >> 1; break;
+			case 0x135: acc = acc + (acc & 53); break;
+			case 0x136: acc |= 64; break;
+			case 0x137: acc &= 0x3FFFF; break;
+			case 0x138: acc += 57; break;
+			case 0x139: acc -= 3; break;
+			case 0x13A: acc ^= 175; break;
+			case 0x13B: acc = (acc * 3) & 0xFFFF; break;
+			case 0x13C: acc = acc >> 1; break;
+			case 0x13D: acc = acc + (acc & 61); break;
+			case 0x13E: acc |= 4; break;
+			case 0x13F: acc &= 0x3FFFF; break;
+			default: acc = 0; break;
+		}
+
+		if ( ++pc >= len )
+		{
+			pc = 0;
+		}
+	}
+	return acc;
+}
+
+var code[256];
+var seed = 12345;
+for( var i=0; i<256; ++i )
+{
+	seed = (seed * 1103515245 + 12345) & 0x7FFFFFFF;
+	code[i] = OP + ((seed >> 16) % 64);
+}
+
+var result = run( code, 5000000 );
+println( "acc: " + result );
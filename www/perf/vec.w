@@ -0,0 +1,53 @@
+// calibrate and reduce a block of samples, boxed values against the
+// packed vec:: path. Run with 'boxed' or 'packed' commented out to
+// time them separately
+
+function boxed( n, passes )
+{
+	var s[];
+	for( var i=0; i<n; ++i )
+	{
+		s[i] = (i % 100) * 0.01;
+	}
+
+	var total = 0;
+	for( var p=0; p<passes; ++p )
+	{
+		for( var i=0; i<n; ++i )
+		{
+			s[i] = s[i] * 0.5 + 0.25;
+		}
+
+		var sum = 0;
+		var energy = 0;
+		for( var i=0; i<n; ++i )
+		{
+			sum += s[i];
+			energy += s[i] * s[i];
+		}
+		total += sum + energy;
+	}
+
+	return total;
+}
+
+function packed( n, passes )
+{
+	var s = vec::float32( n );
+	for( var i=0; i<n; ++i )
+	{
+		s[i] = (i % 100) * 0.01;
+	}
+
+	var total = 0;
+	for( var p=0; p<passes; ++p )
+	{
+		vec::scale( s, 0.5, 0.25 );
+		total += vec::sum( s ) + vec::dot( s, s );
+	}
+
+	return total;
+}
+
+boxed( 100000, 20 );
+packed( 100000, 20 );